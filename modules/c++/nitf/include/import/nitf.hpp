@@ -41,6 +41,7 @@
 #include "nitf/FileSecurity.hpp"
 #include "nitf/GraphicSegment.hpp"
 #include "nitf/GraphicSubheader.hpp"
+#include "nitf/GrowableMemoryIO.hpp"
 #include "nitf/Handle.hpp"
 #include "nitf/HandleManager.hpp"
 #include "nitf/HashTable.hpp"
@@ -52,6 +53,7 @@
 #include "nitf/ImageSource.hpp"
 #include "nitf/ImageSubheader.hpp"
 #include "nitf/ImageWriter.hpp"
+#include "nitf/InstrumentedIO.hpp"
 #include "nitf/LabelSegment.hpp"
 #include "nitf/LabelSubheader.hpp"
 #include "nitf/List.hpp"
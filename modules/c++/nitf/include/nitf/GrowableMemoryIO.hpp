@@ -0,0 +1,66 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_GROWABLE_MEMORY_IO_HPP__
+#define __NITF_GROWABLE_MEMORY_IO_HPP__
+
+#include "nitf/NITFException.hpp"
+#include "nitf/System.hpp"
+#include "nitf/IOInterface.hpp"
+
+/*!
+ * \file GrowableMemoryIO.hpp
+ * \brief Contains wrapper implementation for GrowableBufferAdapter
+ */
+
+namespace nitf
+{
+
+/*!
+ *  \class GrowableMemoryIO
+ *  \brief The C++ wrapper of the nitf_GrowableBufferAdapter
+ *
+ *  An in-memory output that grows as it is written, for when the size of
+ *  the file is not known up front.
+ */
+class GrowableMemoryIO : public IOInterface
+{
+public:
+    // The allocation starts at capacity bytes (or a small default if it is
+    // 0) and doubles as it fills.
+    GrowableMemoryIO(size_t capacity = 0) throw(nitf::NITFException);
+
+    // Returns the bytes written so far and their count in size.  They still
+    // belong to this object and move on the next write.
+    const char* getBuffer(size_t& size) const throw(nitf::NITFException);
+
+    // Hands the bytes written so far over to the caller without copying
+    // them, leaving this object empty.  They must be freed via NRT_FREE().
+    char* release(size_t& size) throw(nitf::NITFException);
+
+private:
+    static
+    nitf_IOInterface* create(size_t capacity) throw(nitf::NITFException);
+};
+
+}
+#endif
@@ -26,6 +26,7 @@
 #include "nitf/ImageWriter.h"
 #include "nitf/Object.hpp"
 #include "nitf/WriteHandler.hpp"
+#include "nitf/IOInterface.hpp"
 #include "nitf/ImageSource.hpp"
 #include "nitf/ImageSubheader.hpp"
 #include <string>
@@ -71,6 +72,9 @@ public:
     //! Enable/disable direct block writes (if you don't know what this means, don't use it)
     void setDirectBlockWrite(int enable);
 
+    //! Enable/disable sparse writes (see nitf_ImageWriter_setSparseWrites)
+    void setSparseWrites(int enable);
+
     /*!
      *  Function allows the user access to the product's pad pixels.
      *  For example, if you wanted transparent pixels for fill, you would
@@ -78,6 +82,45 @@ public:
      */
     void setPadPixel(nitf::Uint8* value, nitf::Uint32 length);
 
+    /*!
+     *  Start pushing image data, rather than having the Writer pull it
+     *  from an attached source.  The data is written from the current
+     *  position of the output, which should be just past the image
+     *  subheader (see Writer::writeImageSubheader).  At most one block
+     *  row is held in memory.
+     *
+     *  \param output  The output to write to; it must outlive the write
+     */
+    void open(nitf::IOInterface& output) throw (nitf::NITFException);
+
+    /*!
+     *  Write the next rows of the image.
+     *
+     *  \param numRows  The number of rows in each buffer
+     *  \param buffers  One buffer per band, in band order, each holding
+     *                  numRows rows of that band
+     */
+    void writeRows(nitf::Uint32 numRows, nitf::Uint8** buffers)
+            throw (nitf::NITFException);
+
+    /*!
+     *  Write one block exactly as it is laid out in the file.  Blocks of
+     *  an uncompressed image may come in any order; those of a compressed
+     *  image must come in order.  Only single band images are supported,
+     *  and rows and blocks cannot be mixed within one write.
+     *
+     *  \param blockNumber  The block to write
+     *  \param buffer       The block data
+     */
+    void writeBlock(nitf::Uint32 blockNumber, const void* buffer)
+            throw (nitf::NITFException);
+
+    /*!
+     *  Complete the write, flushing any cached blocks.  The output is
+     *  left positioned at its end, ready for the next segment.
+     */
+    void finish() throw (nitf::NITFException);
+
 private:
     nitf_Error error;
 //    bool mAdopt;
@@ -0,0 +1,79 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_INSTRUMENTED_IO_HPP__
+#define __NITF_INSTRUMENTED_IO_HPP__
+
+#include <string>
+#include <vector>
+#include "nitf/NITFException.hpp"
+#include "nitf/System.hpp"
+#include "nitf/IOInterface.hpp"
+
+/*!
+ * \file InstrumentedIO.hpp
+ * \brief Contains wrapper implementation for IOStatsAdapter
+ */
+
+namespace nitf
+{
+
+/*!
+ *  \class InstrumentedIO
+ *  \brief The C++ wrapper of the nitf_IOStatsAdapter
+ *
+ *  Passes everything on to another IOInterface and measures it.  Reads
+ *  made by the Reader while parsing are tagged "header", and those made by
+ *  image readers "image[N]".
+ */
+class InstrumentedIO : public IOInterface
+{
+public:
+    // The wrapped interface is kept alive for as long as this one
+    InstrumentedIO(nitf::IOInterface& io) throw(nitf::NITFException);
+
+    // The totals, or the counters for one tag
+    nitf_IOStats getStats() const throw(nitf::NITFException);
+    nitf_IOStats getStats(const std::string& tag) const
+        throw(nitf::NITFException);
+
+    // Every tag used so far, in the order they were first set
+    std::vector<std::string> getTags() const;
+
+    // Files the accesses that follow under tag, until clearTag()
+    void setTag(const std::string& tag);
+    void clearTag();
+
+    void reset() throw(nitf::NITFException);
+
+    std::string toJSON() const throw(nitf::NITFException);
+
+private:
+    static
+    nitf_IOInterface* create(nitf::IOInterface& io)
+        throw(nitf::NITFException);
+
+    nitf::IOInterface mWrapped;
+};
+
+}
+#endif
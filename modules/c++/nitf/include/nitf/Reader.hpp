@@ -76,6 +76,13 @@ public:
      */
     static nitf::Version getNITFVersion(const std::string& fileName);
 
+    /*!
+     *  Parse TREs only when they are first used, rather than as the
+     *  file is read (see nitf_Reader_setLazyTREs)
+     *  \param enable  Parse TREs lazily if true
+     */
+    void setLazyTREs(bool enable);
+
     /*!
      *  This is the preferred method for reading a NITF 2.1 file.
      *  \param io  The IO handle
@@ -29,6 +29,7 @@
 #include "nitf/Pair.hpp"
 #include "nitf/Object.hpp"
 #include <string>
+#include <vector>
 
 /*!
  *  \file TRE.hpp
@@ -230,6 +231,16 @@ typedef nitf::TREFieldIterator Iterator;
      */
     nitf::List find(const std::string& pattern);
 
+    /*!
+     *  Reads every value of a field that repeats in a loop, in description
+     *  order, straight from the TRE's fields.
+     *  \param tag  The field name without loop indexes, e.g. "RNPCF"
+     */
+    std::vector<double> getReal64Array(const std::string& tag);
+
+    //! Like getReal64Array, for integer fields
+    std::vector<nitf::Int64> getInt64Array(const std::string& tag);
+
 	/*!
 	 * Sets the field with the given value. The input value
 	 * is converted to a std::string, and the string-ized value
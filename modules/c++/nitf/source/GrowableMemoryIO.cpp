@@ -0,0 +1,71 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <nitf/GrowableMemoryIO.hpp>
+
+namespace nitf
+{
+nitf_IOInterface* GrowableMemoryIO::create(size_t capacity)
+        throw(nitf::NITFException)
+{
+    nitf_Error error;
+    nitf_IOInterface* const ioInterface =
+            nitf_GrowableBufferAdapter_construct(capacity, &error);
+
+    if (!ioInterface)
+    {
+        throw nitf::NITFException(&error);
+    }
+
+    return ioInterface;
+}
+
+GrowableMemoryIO::GrowableMemoryIO(size_t capacity)
+        throw(nitf::NITFException) :
+    IOInterface(create(capacity))
+{
+    setManaged(false);
+}
+
+const char* GrowableMemoryIO::getBuffer(size_t& size) const
+        throw(nitf::NITFException)
+{
+    const char* const buffer = nitf_GrowableBufferAdapter_getBuffer(
+            getNativeOrThrow(), &size, &error);
+    if (!buffer)
+    {
+        throw nitf::NITFException(&error);
+    }
+    return buffer;
+}
+
+char* GrowableMemoryIO::release(size_t& size) throw(nitf::NITFException)
+{
+    char* const buffer = nitf_GrowableBufferAdapter_release(
+            getNativeOrThrow(), &size, &error);
+    if (!buffer)
+    {
+        throw nitf::NITFException(&error);
+    }
+    return buffer;
+}
+}
@@ -61,8 +61,42 @@ void ImageWriter::setDirectBlockWrite(int enable)
     nitf_ImageWriter_setDirectBlockWrite(getNativeOrThrow(), enable);
 }
 
+void ImageWriter::setSparseWrites(int enable)
+{
+    nitf_ImageWriter_setSparseWrites(getNativeOrThrow(), enable);
+}
+
 void ImageWriter::setPadPixel(nitf::Uint8* value, nitf::Uint32 length)
 {
     if (!nitf_ImageWriter_setPadPixel(getNativeOrThrow(), value, length, &error))
         throw nitf::NITFException(&error);
 }
+
+void ImageWriter::open(nitf::IOInterface& output) throw (nitf::NITFException)
+{
+    if (!nitf_ImageWriter_open(getNativeOrThrow(), output.getNativeOrThrow(),
+                               &error))
+        throw nitf::NITFException(&error);
+}
+
+void ImageWriter::writeRows(nitf::Uint32 numRows, nitf::Uint8** buffers)
+        throw (nitf::NITFException)
+{
+    if (!nitf_ImageWriter_writeRows(getNativeOrThrow(), numRows, buffers,
+                                    &error))
+        throw nitf::NITFException(&error);
+}
+
+void ImageWriter::writeBlock(nitf::Uint32 blockNumber, const void* buffer)
+        throw (nitf::NITFException)
+{
+    if (!nitf_ImageWriter_writeBlock(getNativeOrThrow(), blockNumber, buffer,
+                                     &error))
+        throw nitf::NITFException(&error);
+}
+
+void ImageWriter::finish() throw (nitf::NITFException)
+{
+    if (!nitf_ImageWriter_finish(getNativeOrThrow(), &error))
+        throw nitf::NITFException(&error);
+}
@@ -0,0 +1,115 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <nitf/InstrumentedIO.hpp>
+
+namespace nitf
+{
+nitf_IOInterface* InstrumentedIO::create(nitf::IOInterface& io)
+        throw(nitf::NITFException)
+{
+    nitf_Error error;
+    nitf_IOInterface* const ioInterface =
+            nitf_IOStatsAdapter_construct(io.getNativeOrThrow(), 0, &error);
+
+    if (!ioInterface)
+    {
+        throw nitf::NITFException(&error);
+    }
+
+    return ioInterface;
+}
+
+InstrumentedIO::InstrumentedIO(nitf::IOInterface& io)
+        throw(nitf::NITFException) :
+    IOInterface(create(io)),
+    mWrapped(io)
+{
+    setManaged(false);
+}
+
+nitf_IOStats InstrumentedIO::getStats() const throw(nitf::NITFException)
+{
+    nitf_IOStats stats;
+    if (!nitf_IOStatsAdapter_getStats(getNativeOrThrow(), NULL, &stats,
+                                      &error))
+    {
+        throw nitf::NITFException(&error);
+    }
+    return stats;
+}
+
+nitf_IOStats InstrumentedIO::getStats(const std::string& tag) const
+        throw(nitf::NITFException)
+{
+    nitf_IOStats stats;
+    if (!nitf_IOStatsAdapter_getStats(getNativeOrThrow(), tag.c_str(),
+                                      &stats, &error))
+    {
+        throw nitf::NITFException(&error);
+    }
+    return stats;
+}
+
+std::vector<std::string> InstrumentedIO::getTags() const
+{
+    std::vector<std::string> tags;
+    const char* tag;
+    for (size_t ii = 0;
+         (tag = nitf_IOStatsAdapter_getTag(getNativeOrThrow(), ii)) != NULL;
+         ++ii)
+    {
+        tags.push_back(tag);
+    }
+    return tags;
+}
+
+void InstrumentedIO::setTag(const std::string& tag)
+{
+    nitf_IOStatsAdapter_setTag(getNativeOrThrow(), tag.c_str());
+}
+
+void InstrumentedIO::clearTag()
+{
+    nitf_IOStatsAdapter_setTag(getNativeOrThrow(), NULL);
+}
+
+void InstrumentedIO::reset() throw(nitf::NITFException)
+{
+    if (!nitf_IOStatsAdapter_reset(getNativeOrThrow(), &error))
+    {
+        throw nitf::NITFException(&error);
+    }
+}
+
+std::string InstrumentedIO::toJSON() const throw(nitf::NITFException)
+{
+    char* const json = nitf_IOStatsAdapter_toJSON(getNativeOrThrow(), &error);
+    if (!json)
+    {
+        throw nitf::NITFException(&error);
+    }
+    const std::string result(json);
+    NRT_FREE(json);
+    return result;
+}
+}
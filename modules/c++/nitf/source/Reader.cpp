@@ -78,6 +78,11 @@ nitf::Version Reader::getNITFVersion(const std::string& fileName)
     return nitf_Reader_getNITFVersion(fileName.c_str());
 }
 
+void Reader::setLazyTREs(bool enable)
+{
+    nitf_Reader_setLazyTREs(getNativeOrThrow(), enable ? 1 : 0);
+}
+
 nitf::Record Reader::read(nitf::IOHandle & io) throw (nitf::NITFException)
 {
     return readIO(io);
@@ -22,6 +22,7 @@
 
 #include <string.h>
 #include "nitf/TRE.hpp"
+#include "nitf/TREUtils.h"
 
 using namespace nitf;
 
@@ -157,6 +158,36 @@ nitf::List TRE::find(const std::string& pattern)
     return nitf::List(list);
 }
 
+std::vector<double> TRE::getReal64Array(const std::string& tag)
+{
+    size_t count;
+    if (!nitf_TREUtils_getReal64Array(getNativeOrThrow(), tag.c_str(),
+                                      NULL, 0, &count, &error))
+        throw nitf::NITFException(&error);
+
+    std::vector<double> values(count);
+    if (count && !nitf_TREUtils_getReal64Array(getNative(), tag.c_str(),
+                                               &values[0], count, &count,
+                                               &error))
+        throw nitf::NITFException(&error);
+    return values;
+}
+
+std::vector<nitf::Int64> TRE::getInt64Array(const std::string& tag)
+{
+    size_t count;
+    if (!nitf_TREUtils_getInt64Array(getNativeOrThrow(), tag.c_str(),
+                                     NULL, 0, &count, &error))
+        throw nitf::NITFException(&error);
+
+    std::vector<nitf::Int64> values(count);
+    if (count && !nitf_TREUtils_getInt64Array(getNative(), tag.c_str(),
+                                              &values[0], count, &count,
+                                              &error))
+        throw nitf::NITFException(&error);
+    return values;
+}
+
 std::string TRE::getID() const
 {
     const char* id = nitf_TRE_getID(getNativeOrThrow());
@@ -98,10 +98,26 @@ TEST_CASE(testCastOperator)
     const std::string valStr = field;
     TEST_ASSERT_EQ(valStr, "ABCxyz              ");
 }
+
+TEST_CASE(testRawDataWrites)
+{
+    nitf_Error error;
+    nitf::Field field(nitf_Field_construct(2, NITF_BCS_N, &error));
+
+    field.set(5);
+    const nitf::Uint32 before = field;
+    TEST_ASSERT_EQ(before, 5);
+
+    // Writes through the raw data are seen by the next read
+    field.getRawData()[0] = '4';
+    const nitf::Uint32 after = field;
+    TEST_ASSERT_EQ(after, 45);
+}
 }
 
 int main(int , char** )
 {
     TEST_CHECK(testCastOperator);
+    TEST_CHECK(testRawDataWrites);
     return 0;
 }
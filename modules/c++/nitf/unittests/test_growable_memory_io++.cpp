@@ -0,0 +1,81 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+#include <import/nitf.hpp>
+#include "TestCase.h"
+
+namespace
+{
+const size_t TEXT_SIZE = 100000;
+
+// Writes a record holding one text segment
+void writeRecord(nitf::IOInterface& io, const std::string& text)
+{
+    nitf::Record record;
+    record.newTextSegment();
+
+    nitf::Writer writer;
+    writer.prepareIO(io, record);
+    nitf::SegmentWriter textWriter = writer.newTextWriter(0);
+    nitf::SegmentMemorySource source(text.data(), text.size(), 0, 0, false);
+    textWriter.attachSource(source);
+    writer.write();
+}
+
+TEST_CASE(testWriteRecord)
+{
+    std::string text(TEXT_SIZE, ' ');
+    for (size_t ii = 0; ii < text.size(); ++ii)
+    {
+        text[ii] = static_cast<char>('A' + ii % 26);
+    }
+
+    nitf::MemoryIO expected(2 * TEXT_SIZE);
+    writeRecord(expected, text);
+    const size_t expectedSize = static_cast<size_t>(expected.getSize());
+    std::string expectedBytes(expectedSize, ' ');
+    expected.seek(0, NITF_SEEK_SET);
+    expected.read(&expectedBytes[0], expectedSize);
+
+    // Starting small, so the file header is patched after a few regrowths
+    nitf::GrowableMemoryIO io(64);
+    writeRecord(io, text);
+    TEST_ASSERT_EQ(static_cast<size_t>(io.getSize()), expectedSize);
+
+    size_t size = 0;
+    const char* buffer = io.getBuffer(size);
+    TEST_ASSERT_EQ(size, expectedSize);
+    TEST_ASSERT(std::string(buffer, size) == expectedBytes);
+
+    char* released = io.release(size);
+    TEST_ASSERT_EQ(size, expectedSize);
+    TEST_ASSERT(std::string(released, size) == expectedBytes);
+    NRT_FREE(released);
+    TEST_ASSERT_EQ(io.getSize(), 0);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testWriteRecord);
+    return 0;
+}
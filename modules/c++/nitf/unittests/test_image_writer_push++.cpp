@@ -0,0 +1,257 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+#include <import/nitf.hpp>
+#include "TestCase.h"
+
+namespace
+{
+const nitf::Uint32 NUM_ROWS = 32;
+const nitf::Uint32 NUM_COLS = 48;
+const nitf::Uint32 BLOCK_SIZE = 16;
+
+nitf::ImageSubheader makeSubheader(nitf::Record& record, size_t numBands,
+                                   const std::string& imode)
+{
+    nitf::ImageSubheader subheader = record.newImageSegment().getSubheader();
+    std::vector<nitf::BandInfo> bands;
+    for (size_t ii = 0; ii < numBands; ++ii)
+    {
+        nitf::BandInfo band;
+        band.init("M", " ", "N", "   ");
+        bands.push_back(band);
+    }
+    subheader.setPixelInformation("INT", 8, 8, "R", "MULTI", "MS", bands);
+    subheader.setBlocking(NUM_ROWS, NUM_COLS, BLOCK_SIZE, BLOCK_SIZE, imode);
+    return subheader;
+}
+
+std::vector<nitf::Uint8> makePixels(size_t numBands)
+{
+    std::vector<nitf::Uint8> pixels(numBands * NUM_ROWS * NUM_COLS);
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+    {
+        pixels[ii] = static_cast<nitf::Uint8>(ii * 13);
+    }
+    return pixels;
+}
+
+std::vector<nitf::Uint8> contents(nitf::MemoryIO& io)
+{
+    std::vector<nitf::Uint8> written(static_cast<size_t>(io.getSize()));
+    io.seek(0, NITF_SEEK_SET);
+    io.read(&written[0], written.size());
+    return written;
+}
+
+// Writes the image the usual way, with the writer pulling from a source
+std::vector<nitf::Uint8> pullWrite(nitf::ImageSubheader& subheader,
+                                   std::vector<nitf::Uint8>& pixels,
+                                   size_t numBands)
+{
+    const size_t bandSize = NUM_ROWS * NUM_COLS;
+    nitf::ImageWriter imageWriter(subheader);
+    nitf::ImageSource source;
+    for (size_t ii = 0; ii < numBands; ++ii)
+    {
+        nitf::MemorySource band(&pixels[ii * bandSize], bandSize, 0, 1, 0);
+        source.addBand(band);
+    }
+    imageWriter.attachSource(source);
+
+    nitf::MemoryIO io(2 * pixels.size());
+    imageWriter.write(io);
+    return contents(io);
+}
+
+void testPushedRows(const std::string& testName, const std::string& imode)
+{
+    const size_t numBands = 3;
+    const size_t bandSize = NUM_ROWS * NUM_COLS;
+    nitf::Record record;
+    nitf::ImageSubheader subheader = makeSubheader(record, numBands, imode);
+    std::vector<nitf::Uint8> pixels = makePixels(numBands);
+
+    // Rows go in five at a time, which doesn't line up with the blocks
+    nitf::ImageWriter imageWriter(subheader);
+    nitf::MemoryIO io(2 * pixels.size());
+    imageWriter.open(io);
+    for (nitf::Uint32 row = 0; row < NUM_ROWS; row += 5)
+    {
+        const nitf::Uint32 numRows = std::min<nitf::Uint32>(5, NUM_ROWS - row);
+        std::vector<nitf::Uint8*> buffers(numBands);
+        for (size_t band = 0; band < numBands; ++band)
+        {
+            buffers[band] = &pixels[band * bandSize + row * NUM_COLS];
+        }
+        imageWriter.writeRows(numRows, &buffers[0]);
+    }
+    imageWriter.finish();
+
+    TEST_ASSERT(contents(io) == pullWrite(subheader, pixels, numBands));
+    TEST_ASSERT_EQ(io.tell(), io.getSize());
+}
+
+TEST_CASE(testPushedRowsBandInterleavedByBlock)
+{
+    testPushedRows(testName, "B");
+}
+
+TEST_CASE(testPushedRowsBandSequential)
+{
+    testPushedRows(testName, "S");
+}
+
+// Pushes the blocks of a one band image backwards
+void pushBlocks(nitf::ImageWriter& imageWriter,
+                const std::vector<nitf::Uint8>& pixels)
+{
+    const nitf::Uint32 blocksPerRow = NUM_COLS / BLOCK_SIZE;
+    const nitf::Uint32 numBlocks = blocksPerRow * (NUM_ROWS / BLOCK_SIZE);
+    std::vector<nitf::Uint8> block(BLOCK_SIZE * BLOCK_SIZE);
+    for (nitf::Uint32 ii = numBlocks; ii-- > 0; )
+    {
+        const nitf::Uint32 row0 = (ii / blocksPerRow) * BLOCK_SIZE;
+        const nitf::Uint32 col0 = (ii % blocksPerRow) * BLOCK_SIZE;
+        for (nitf::Uint32 row = 0; row < BLOCK_SIZE; ++row)
+        {
+            std::copy(&pixels[(row0 + row) * NUM_COLS + col0],
+                      &pixels[(row0 + row) * NUM_COLS + col0] + BLOCK_SIZE,
+                      &block[row * BLOCK_SIZE]);
+        }
+        imageWriter.writeBlock(ii, &block[0]);
+    }
+}
+
+void testPushedBlocks(const std::string& testName,
+                      const std::string& compression)
+{
+    nitf::Record record;
+    nitf::ImageSubheader subheader = makeSubheader(record, 1, "B");
+    subheader.getImageCompression().set(compression);
+    std::vector<nitf::Uint8> pixels = makePixels(1);
+
+    // Direct block writes are not scanned for pad, so leave none to find
+    std::replace(pixels.begin(), pixels.end(), nitf::Uint8(0), nitf::Uint8(1));
+
+    nitf::ImageWriter imageWriter(subheader);
+    nitf::MemoryIO io(2 * pixels.size());
+    imageWriter.open(io);
+    pushBlocks(imageWriter, pixels);
+    imageWriter.finish();
+
+    TEST_ASSERT(contents(io) == pullWrite(subheader, pixels, 1));
+}
+
+TEST_CASE(testPushedBlocks)
+{
+    testPushedBlocks(testName, "NC");
+}
+
+TEST_CASE(testPushedBlocksMasked)
+{
+    // each block goes to its place in the mask, whatever the order
+    testPushedBlocks(testName, "NM");
+}
+
+TEST_CASE(testPushedBlocksIntoLongerOutput)
+{
+    nitf::Record record;
+    nitf::ImageSubheader subheader = makeSubheader(record, 1, "B");
+    std::vector<nitf::Uint8> pixels = makePixels(1);
+    const std::string trailer = "already here";
+
+    // The output already runs past where the image will end
+    nitf::MemoryIO io(2 * pixels.size());
+    io.seek(pixels.size() + 100, NITF_SEEK_SET);
+    io.write(trailer.c_str(), trailer.size());
+    io.seek(0, NITF_SEEK_SET);
+
+    nitf::ImageWriter imageWriter(subheader);
+    imageWriter.open(io);
+    pushBlocks(imageWriter, pixels);
+    imageWriter.finish();
+
+    // finish leaves the output at the end of the image, not of the output
+    TEST_ASSERT_EQ(io.tell(), static_cast<nitf::Off>(pixels.size()));
+    std::vector<nitf::Uint8> written = contents(io);
+    std::vector<nitf::Uint8> pulled = pullWrite(subheader, pixels, 1);
+    TEST_ASSERT(std::equal(pulled.begin(), pulled.end(), written.begin()));
+}
+
+TEST_CASE(testPushedBlockOutOfRange)
+{
+    nitf::Record record;
+    nitf::ImageSubheader subheader = makeSubheader(record, 1, "B");
+    const nitf::Uint32 numBlocks =
+        (NUM_ROWS / BLOCK_SIZE) * (NUM_COLS / BLOCK_SIZE);
+    std::vector<nitf::Uint8> block(BLOCK_SIZE * BLOCK_SIZE);
+
+    nitf::ImageWriter imageWriter(subheader);
+    nitf::MemoryIO io(2 * NUM_ROWS * NUM_COLS);
+    imageWriter.open(io);
+    bool threw = false;
+    try
+    {
+        imageWriter.writeBlock(numBlocks, &block[0]);
+    }
+    catch (const nitf::NITFException&)
+    {
+        threw = true;
+    }
+    TEST_ASSERT(threw);
+
+    // nothing was written for it
+    TEST_ASSERT_EQ(io.tell(), static_cast<nitf::Off>(0));
+}
+
+TEST_CASE(testPushWithoutOpen)
+{
+    nitf::Record record;
+    nitf::ImageSubheader subheader = makeSubheader(record, 1, "B");
+    nitf::ImageWriter imageWriter(subheader);
+    bool threw = false;
+    try
+    {
+        imageWriter.finish();
+    }
+    catch (const nitf::NITFException&)
+    {
+        threw = true;
+    }
+    TEST_ASSERT(threw);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testPushedRowsBandInterleavedByBlock);
+    TEST_CHECK(testPushedRowsBandSequential);
+    TEST_CHECK(testPushedBlocks);
+    TEST_CHECK(testPushedBlocksMasked);
+    TEST_CHECK(testPushedBlocksIntoLongerOutput);
+    TEST_CHECK(testPushedBlockOutOfRange);
+    TEST_CHECK(testPushWithoutOpen);
+    return 0;
+}
@@ -1117,14 +1117,14 @@ NITFPRIV(int) readCGM(cgm_MetafileReader* reader,
             /*printParseContext(&parseContext);*/
 
             if (bytes)
-                free(bytes);
+                NITF_FREE(bytes);
             return 1;
         }
     }
 
     END_OF_FUNCTION:
     if (bytes)
-        free(bytes);
+        NITF_FREE(bytes);
     return 0;
 
 }
@@ -258,6 +258,35 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
  */
 NITFPRIV(void) implClose(nitf_DecompressionControl** control);
 
+/*!
+ *  Hands back the offset of each block's SOI marker, as found by the scan
+ *  in implStart(), so that it can be kept and given to a later open.
+ *  Blocks that are not in the file have NITF_IMAGE_IO_NO_BLOCK.
+ *
+ *  \param control The started control object
+ *  \param count Set to the number of blocks in the table
+ *  \param error An error which will be populated on failure
+ *  \return The table, which the control object owns, or NULL on failure
+ */
+NITFPRIV(nitf_Uint64*) implGetBlockOffsets(nitf_DecompressionControl* control,
+                                           nitf_Uint32* count,
+                                           nitf_Error* error);
+
+/*!
+ *  Takes a table from implGetBlockOffsets() before implStart(), which then
+ *  uses it rather than scanning the whole image for markers.
+ *
+ *  \param control The control object
+ *  \param offsets The SOI offset of each block
+ *  \param count The number of blocks in the table
+ *  \param error An error which will be populated on failure
+ *  \return One on success, zero on failure
+ */
+NITFPRIV(NITF_BOOL) implSetBlockOffsets(nitf_DecompressionControl* control,
+                                        const nitf_Uint64* offsets,
+                                        nitf_Uint32 count,
+                                        nitf_Error* error);
+
 
 
 /*!
@@ -312,6 +341,7 @@ typedef nitf_Uint8* DATA_BUFFER;
  *  of order
  *  \ar quantTable  Quantization table (currently not used)
  *  \ar length  The length of the block in bytes
+ *  \ar offsets  The SOI offsets handed to or built for a block offset cache
  *
  *  The length value is needed to generate the zero block for decompresion
  *  error recovery. If enabled, blocks that can not be decompressed are
@@ -323,6 +353,8 @@ typedef struct _JPEGImplControl
     nitf_List*        markerList;
     int*              quantTable;
     nitf_Uint32       length;       /* Total length of the block in bytes */
+    nitf_Uint64*      offsets;      /* SOI offset of each block, if known */
+    nitf_Uint32       numOffsets;   /* Number of entries in offsets */
 }
 JPEGImplControl;
 
@@ -476,7 +508,9 @@ static nitf_DecompressionInterface interfaceTable =
     implReadBlock,
     implFreeBlock,
     implClose,
-    NULL
+    NULL,
+    implGetBlockOffsets,
+    implSetBlockOffsets
 };
 
 NITFPRIV(int) implFreeBlock(nitf_DecompressionControl* control,
@@ -976,6 +1010,7 @@ NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
                 NITF_ERR_DECOMPRESSION);
         return NULL;
     }
+    memset(implControl, 0, sizeof(JPEGImplControl));
 
     return (nitf_DecompressionControl*)implControl;
 }
@@ -1030,12 +1065,33 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
         return NITF_FAILURE;
     }
 
+    /*  A table from an earlier scan saves doing this one  */
+    if (implControl->offsets)
+    {
+        nitf_Uint32 block;
+        for (block = 0; block < implControl->numOffsets; block++)
+        {
+            JPEGMarkerItem* item;
+            if (implControl->offsets[block] == NITF_IMAGE_IO_NO_BLOCK)
+                continue;
+            item = JPEGMarkerItem_construct(error);
+            if (!item)
+                return NITF_FAILURE;
+            strcpy(item->name, "SOI");
+            item->off = (nitf_Off)implControl->offsets[block];
+            item->block = block;
+            if (!nitf_List_pushBack(implControl->markerList, item, error))
+                return NITF_FAILURE;
+        }
+    }
+
     /*  Find all marker offsets!!!!  */
-    if (!scanOffsets(io, implControl->markerList, fileLength, error))
+    else if (!scanOffsets(io, implControl->markerList, fileLength, error))
     {
         return NITF_FAILURE;
     }
 
+    else
     {
         nitf_Uint32 nextBlock = 0;
         nitf_ListIterator x = nitf_List_begin((implControl->markerList));
@@ -1470,6 +1526,86 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
 }
 
 
+NITFPRIV(nitf_Uint64*) implGetBlockOffsets(nitf_DecompressionControl* control,
+                                           nitf_Uint32* count,
+                                           nitf_Error* error)
+{
+    JPEGImplControl* implControl = (JPEGImplControl*) control;
+    nitf_ListIterator x;
+    nitf_ListIterator end;
+    nitf_Uint32 numBlocks = 0;
+    nitf_Uint32 i;
+
+    if (implControl->offsets)
+    {
+        *count = implControl->numOffsets;
+        return implControl->offsets;
+    }
+    if (!implControl->markerList)
+    {
+        nitf_Error_init(error, "Decompression has not been started",
+                        NITF_CTXT, NITF_ERR_DECOMPRESSION);
+        return NULL;
+    }
+
+    end = nitf_List_end(implControl->markerList);
+    for (x = nitf_List_begin(implControl->markerList);
+            nitf_ListIterator_notEqualTo(&x, &end);
+            nitf_ListIterator_increment(&x))
+    {
+        JPEGMarkerItem* item = (JPEGMarkerItem*)nitf_ListIterator_get(&x);
+        if (item->block != NITF_IMAGE_IO_NO_BLOCK && item->block >= numBlocks)
+            numBlocks = item->block + 1;
+    }
+
+    implControl->offsets =
+        (nitf_Uint64*)NITF_MALLOC((numBlocks + 1) * sizeof(nitf_Uint64));
+    if (!implControl->offsets)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                NITF_CTXT, NITF_ERR_DECOMPRESSION);
+        return NULL;
+    }
+    for (i = 0; i < numBlocks; i++)
+        implControl->offsets[i] = NITF_IMAGE_IO_NO_BLOCK;
+
+    for (x = nitf_List_begin(implControl->markerList);
+            nitf_ListIterator_notEqualTo(&x, &end);
+            nitf_ListIterator_increment(&x))
+    {
+        JPEGMarkerItem* item = (JPEGMarkerItem*)nitf_ListIterator_get(&x);
+        if (item->block != NITF_IMAGE_IO_NO_BLOCK)
+            implControl->offsets[item->block] = (nitf_Uint64)item->off;
+    }
+    implControl->numOffsets = numBlocks;
+    *count = numBlocks;
+    return implControl->offsets;
+}
+
+NITFPRIV(NITF_BOOL) implSetBlockOffsets(nitf_DecompressionControl* control,
+                                        const nitf_Uint64* offsets,
+                                        nitf_Uint32 count,
+                                        nitf_Error* error)
+{
+    JPEGImplControl* implControl = (JPEGImplControl*) control;
+    nitf_Uint64* copy;
+
+    copy = (nitf_Uint64*)NITF_MALLOC((count + 1) * sizeof(nitf_Uint64));
+    if (!copy)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                NITF_CTXT, NITF_ERR_DECOMPRESSION);
+        return NITF_FAILURE;
+    }
+    memcpy(copy, offsets, count * sizeof(nitf_Uint64));
+
+    if (implControl->offsets)
+        NITF_FREE(implControl->offsets);
+    implControl->offsets = copy;
+    implControl->numOffsets = count;
+    return NITF_SUCCESS;
+}
+
 NITFPRIV(void) implClose(nitf_DecompressionControl** control)
 {
     JPEGImplControl* implControl;
@@ -1481,6 +1617,10 @@ NITFPRIV(void) implClose(nitf_DecompressionControl** control)
     {
         nitf_List_destruct(&implControl->markerList);
     }
+    if (implControl && implControl->offsets)
+    {
+        NITF_FREE(implControl->offsets);
+    }
     if (implControl)
     {
         NITF_FREE(implControl);
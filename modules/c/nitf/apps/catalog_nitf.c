@@ -0,0 +1,125 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+
+/*
+ *  Indexes every image segment of every NITF under a directory.  The index
+ *  is written as JSON lines, or with -b in the columnar form described in
+ *  nitf/Catalog.h.
+ */
+
+static void usage(const char* program)
+{
+    fprintf(stdout,
+            "Usage: %s [-j threads] [-b] [-t TRE]... [-s suffix]... "
+            "<root> <output>\n"
+            "  -j  number of threads parsing files (default 4)\n"
+            "  -b  write the binary index rather than JSON lines\n"
+            "  -t  index the raw bytes of a TRE, may be repeated\n"
+            "  -s  only look at files ending in suffix, may be repeated\n",
+            program);
+    exit(EXIT_FAILURE);
+}
+
+static void showError(NITF_DATA* user, const char* path,
+                      const nitf_Error* error)
+{
+    (void)user;
+    fprintf(stderr, "%s: %s\n", path, error->message);
+}
+
+int main(int argc, char** argv)
+{
+    nitf_CatalogOptions options;
+    nitf_CatalogSummary summary;
+    nitf_Error error;
+    nitf_IOInterface* output;
+    const char** tags;
+    const char** suffixes;
+    int numTags = 0;
+    int numSuffixes = 0;
+    int i;
+    NITF_BOOL ok;
+
+    /* no more of either than there are arguments */
+    tags = (const char**)NITF_MALLOC(sizeof(char*) * argc);
+    suffixes = (const char**)NITF_MALLOC(sizeof(char*) * argc);
+    if (!tags || !suffixes)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    nitf_CatalogOptions_init(&options);
+    options.onError = showError;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; ++i)
+    {
+        if (strcmp(argv[i], "-b") == 0)
+            options.format = NITF_CATALOG_BINARY;
+        else if (i + 1 == argc)
+            usage(argv[0]);
+        else if (strcmp(argv[i], "-j") == 0)
+            options.numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0)
+            tags[numTags++] = argv[++i];
+        else if (strcmp(argv[i], "-s") == 0)
+            suffixes[numSuffixes++] = argv[++i];
+        else
+            usage(argv[0]);
+    }
+    if (argc - i != 2)
+        usage(argv[0]);
+
+    tags[numTags] = NULL;
+    suffixes[numSuffixes] = NULL;
+    options.treTags = tags;
+    if (numSuffixes > 0)
+        options.suffixes = suffixes;
+
+    output = nitf_IOHandleAdapter_open(argv[i + 1], NITF_ACCESS_WRITEONLY,
+                                       NITF_CREATE | NITF_TRUNCATE, &error);
+    if (!output)
+    {
+        nitf_Error_print(&error, stderr, "Exiting...");
+        exit(EXIT_FAILURE);
+    }
+
+    ok = nitf_Catalog_scan(argv[i], &options, output, &summary, &error);
+    nitf_IOInterface_close(output, &error);
+    nitf_IOInterface_destruct(&output);
+    NITF_FREE(tags);
+    NITF_FREE(suffixes);
+
+    if (!ok)
+    {
+        nitf_Error_print(&error, stderr, "Exiting...");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(stdout, "%lu files, %lu images, %lu failures\n",
+            (unsigned long)summary.files, (unsigned long)summary.images,
+            (unsigned long)summary.failures);
+    return summary.failures > 0 ? EXIT_FAILURE : 0;
+}
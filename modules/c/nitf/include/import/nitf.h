@@ -25,10 +25,13 @@
 
 #include "nitf/BandInfo.h"
 #include "nitf/BandSource.h"
+#include "nitf/Catalog.h"
 #include "nitf/ComponentInfo.h"
 #include "nitf/DESegment.h"
 #include "nitf/DESubheader.h"
 #include "nitf/DefaultTRE.h"
+#include "nitf/LazyTRE.h"
+#include "nitf/SharedTRE.h"
 #include "nitf/DownSampler.h"
 #include "nitf/Extensions.h"
 #include "nitf/Field.h"
@@ -53,6 +56,7 @@
 #include "nitf/RowSource.h"
 #include "nitf/Reader.h"
 #include "nitf/Record.h"
+#include "nitf/RecordIndex.h"
 #include "nitf/SegmentReader.h"
 #include "nitf/SegmentSource.h"
 #include "nitf/StreamIOWriteHandler.h"
@@ -0,0 +1,128 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __NITF_CATALOG_H__
+#define __NITF_CATALOG_H__
+
+#include "nitf/System.h"
+#include "nitf/Reader.h"
+
+NITF_CXX_GUARD
+
+/* Values for nitf_CatalogOptions.format */
+#define NITF_CATALOG_JSON   0   /*!< One JSON object per line */
+#define NITF_CATALOG_BINARY 1   /*!< Blocks of columns, see below */
+
+/* Rows per block of the binary index */
+#define NITF_CATALOG_BLOCK_ROWS 1024
+
+/* How deep below the root directory the scan goes */
+#define NITF_CATALOG_MAX_DEPTH 64
+
+/*!
+ *  Called for each file that looked like a NITF but could not be read.
+ *  It may be called from any of the scanning threads, but never from two
+ *  at once.
+ */
+typedef void (*NITF_CATALOG_ERROR)(NITF_DATA * user, const char *path,
+                                   const nitf_Error * error);
+
+/*!
+ *  \struct nitf_CatalogOptions
+ *  \brief  Controls a nitf_Catalog_scan
+ */
+typedef struct _nitf_CatalogOptions
+{
+    int format;                 /*!< NITF_CATALOG_JSON or _BINARY */
+    int numThreads;             /*!< Threads parsing files; 1 scans inline */
+    const char **suffixes;      /*!< NULL terminated file name endings to
+                                     look at, ignoring case; NULL for all */
+    const char **treTags;       /*!< NULL terminated TREs to index */
+    NITF_CATALOG_ERROR onError; /*!< Optional; told about bad files */
+    NITF_DATA *user;            /*!< Handed to onError */
+} nitf_CatalogOptions;
+
+/*!
+ *  \struct nitf_CatalogSummary
+ *  \brief  What a nitf_Catalog_scan found
+ */
+typedef struct _nitf_CatalogSummary
+{
+    nitf_Uint64 files;          /*!< NITF files indexed */
+    nitf_Uint64 images;         /*!< Image segments indexed */
+    nitf_Uint64 failures;       /*!< NITF files that could not be read */
+} nitf_CatalogSummary;
+
+/*!
+ *  Fills in the defaults: JSON lines, four threads, every file, no TREs.
+ */
+NITFAPI(void) nitf_CatalogOptions_init(nitf_CatalogOptions * options);
+
+/*!
+ *  Walks the directory tree under root, or just root if it is a file,
+ *  and writes a row to output for each image segment of each NITF file
+ *  found.  Files that do not start with a NITF or NSIF header are passed
+ *  over quietly.  Only the file header, the image subheaders and the
+ *  requested TREs are parsed, on a pool of threads, so rows come out in
+ *  no particular order.  Links to directories below root are not
+ *  followed, so a link back up the tree is not walked round and round.
+ *
+ *  Each row has the file path, the segment index, IID1, NROWS, NCOLS,
+ *  the band count, IC, IMODE, NBPP, ICORDS, IGEOLO, the corners as
+ *  decimal degrees when ICORDS is G or D, and the raw bytes of the first
+ *  instance of each requested TRE in the image subheader.
+ *
+ *  JSON lines look like
+ *
+ *  {"file":"a.ntf","segment":0,"iid1":"...","nrows":1024,"ncols":1024,
+ *   "nbands":1,"ic":"NC","imode":"B","nbpp":8,"icords":"G",
+ *   "igeolo":"...","corners":[[lat,lon],...] or null,
+ *   "tres":{"TAG":"raw bytes" or null,...}}
+ *
+ *  The binary index is big endian.  It starts with the magic "NITFCAT1",
+ *  a uint32 TRE count and each TRE tag as a uint32 length and its bytes.
+ *  Blocks of up to NITF_CATALOG_BLOCK_ROWS rows follow, and a block of 0
+ *  rows ends the index.  A block is a uint32 row count and then a column
+ *  at a time: file, segment, iid1, nrows, ncols, nbands, ic, imode, nbpp,
+ *  icords, igeolo, the eight corner values (lat then lon for each corner)
+ *  and a column for each TRE.  A string column is a uint32 length for
+ *  each row followed by the bytes of every row, a number column is a
+ *  uint32 or an IEEE double (NaN where unknown) for each row.
+ *
+ *  \param root     A directory or a file
+ *  \param options  The options, or NULL for the defaults
+ *  \param output   Where the index goes
+ *  \param summary  Optional; filled in with what was found
+ *  \param error    Populated on failure
+ *  \return NITF_SUCCESS, unless the tree could not be walked or the index
+ *  could not be written; unreadable NITF files are only counted
+ */
+NITFAPI(NITF_BOOL) nitf_Catalog_scan(const char *root,
+                                     const nitf_CatalogOptions * options,
+                                     nitf_IOInterface * output,
+                                     nitf_CatalogSummary * summary,
+                                     nitf_Error * error);
+
+NITF_CXX_ENDGUARD
+
+#endif
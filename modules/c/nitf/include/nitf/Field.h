@@ -100,6 +100,23 @@ NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
                                            nitf_FieldType type,
                                            nitf_Error * error);
 
+/*!
+ *  Construct a new field, as nitf_Field_construct does, but take the field
+ *  and its data from arena.  The field is destructed as usual, and works
+ *  until the arena is destroyed.  If it is resized, the new data comes
+ *  from the heap.
+ *
+ *  \param arena The arena, or NULL to construct on the heap
+ *  \param length The length of the field.
+ *  \param type The type of field we have (BCS-A, BCS-N, or binary)
+ *  \param error The error to populate on failure
+ *  \return The newly created field, or NULL on failure.
+ */
+NITFAPI(nitf_Field *) nitf_Field_constructInArena(nitf_Arena * arena,
+                                                  size_t length,
+                                                  nitf_FieldType type,
+                                                  nitf_Error * error);
+
 
 /*!
  *  \fn nitf_Field_setRawData
@@ -319,9 +336,11 @@ NITFAPI(nitf_Field *) nitf_Field_clone(nitf_Field * source,
  *      - If the user is requesting a 16 bit integer
  *                   * Hurt them and then return 16 bit value
  *      - If the user is requesting a 32 bit integer
- *                   * Give them back a 32 bit integer, converted using NITF_ATO32()
+ *                   * Give them back a 32 bit integer, converted as NITF_ATO32()
+ *                     would, but without copying the field or using the locale
  *      - If the user is requesting a 64 bit integer
- *                   * Give them back a 64 bit integer, converted using NITF_ATO64()
+ *                   * Give them back a 64 bit integer, converted as NITF_ATO64()
+ *                     would
  *  = If the data is a binary integer
  *      - If the user is requesting an integer
  *                   * Hurt them (just kidding).  Make sure the internal and external sizes are same
@@ -358,6 +377,31 @@ NITFPROT(NITF_BOOL) nitf_Field_resetLength(nitf_Field * field,
  */
 NITFPROT(void) nitf_Field_print(nitf_Field * field);
 
+/*!
+ *  Read BCS text as a 64 bit integer, the way nitf_Field_get does with
+ *  NITF_CONV_INT: white space and a sign, then digits up to the first
+ *  character that isn't one.  Runs of digits are converted eight at a time.
+ *
+ *  \param str The text, which need not be null terminated
+ *  \param length The number of bytes of text
+ *  \return The number, held at the nearest limit if it doesn't fit
+ */
+NITFPROT(nitf_Int64) nitf_Field_parseInt64(const char *str, size_t length);
+
+/*!
+ *  Read BCS text as a double, giving the same result as atof on a null
+ *  terminated copy of it.  Plain decimals that fit a double's mantissa are
+ *  converted without a copy.
+ *
+ *  \param str The text, which need not be null terminated
+ *  \param length The number of bytes of text
+ *  \param value Set to the number
+ *  \param error The error to populate if memory runs out
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFPROT(NITF_BOOL) nitf_Field_parseReal64(const char *str, size_t length,
+                                           double *value, nitf_Error * error);
+
 
 /*!
  * Resizes the field, if it is allowed to be resized. It returns false if the
@@ -551,6 +551,51 @@ typedef NITF_BOOL(*NITF_DECOMPRESSION_INTERFACE_FREE_BLOCK_FUNCTION)
 typedef void (*NITF_DECOMPRESSION_CONTROL_DESTROY_FUNCTION)
 (nitf_DecompressionControl ** object);
 
+/*!
+    \brief NITF_DECOMPRESSION_INTERFACE_GET_OFFSETS_FUNCTION - Image
+  decompression interface get block offsets function
+
+  This function pointer type is the type for the getBlockOffsets field in
+  the decompression offsets interface object. After start, it returns the
+  table the decompressor built to find its blocks, so that the table can be
+  cached and handed back through setBlockOffsets on a later open.
+
+  \ar object      - The started decompression object
+  \ar count       - Set to the number of entries in the table
+  \ar error       - Error object
+
+  \return The table, still owned by the object, or NULL on error
+
+  On error, the error object is set
+*/
+
+typedef nitf_Uint64 *(*NITF_DECOMPRESSION_INTERFACE_GET_OFFSETS_FUNCTION)
+(nitf_DecompressionControl * object,
+ nitf_Uint32 * count, nitf_Error * error);
+
+/*!
+    \brief NITF_DECOMPRESSION_INTERFACE_SET_OFFSETS_FUNCTION - Image
+  decompression interface set block offsets function
+
+  This function pointer type is the type for the setBlockOffsets field in
+  the decompression offsets interface object. It is called before start
+  with a table from an earlier getBlockOffsets on the same data, which the
+  object copies, so that start need not scan the data to build it.
+
+  \ar object      - The decompression object
+  \ar offsets     - The table
+  \ar count       - The number of entries in the table
+  \ar error       - Error object
+
+  \return On error, FALSE is returned
+
+  On error, the error object is set
+*/
+
+typedef NITF_BOOL(*NITF_DECOMPRESSION_INTERFACE_SET_OFFSETS_FUNCTION)
+(nitf_DecompressionControl * object,
+ const nitf_Uint64 * offsets, nitf_Uint32 count, nitf_Error * error);
+
 /*!
   \brief nitf_CompressionInterface - Interface object for compression
 
@@ -599,6 +644,26 @@ typedef struct _nitf_DecompressionInterface
 }
 nitf_DecompressionInterface;
 
+/*!
+  \brief nitf_DecompressionOffsetsInterface - Block offset table entry points
+
+  A decompressor that has to scan its data to find its blocks may let that
+  table be kept and reused. Its plugin does so by exporting, next to the
+  constructor of its nitf_DecompressionInterface, a function named with
+  NITF_PLUGIN_OFFSETS_SUFFIX that returns one of these objects. The object
+  is separate so that nitf_DecompressionInterface keeps the layout existing
+  plugins were built against. Both functions work on the decompression
+  control object of the decompressor from the same plugin.
+
+*/
+
+typedef struct _nitf_DecompressionOffsetsInterface
+{
+    NITF_DECOMPRESSION_INTERFACE_GET_OFFSETS_FUNCTION getBlockOffsets; /*!< Table built by start */
+    NITF_DECOMPRESSION_INTERFACE_SET_OFFSETS_FUNCTION setBlockOffsets; /*!< Table for start to use */
+}
+nitf_DecompressionOffsetsInterface;
+
 /*!
   \brief NITF_DOWN_SAMPLE_FUNCTION - Function pointer for down-sample
   function
@@ -838,6 +903,92 @@ NITFPROT(nitf_BlockingInfo *) nitf_ImageIO_getBlockingInfo(nitf_ImageIO * image,
                                                            nitf_Error * error
                                                           );
 
+/*!
+  \brief nitf_ImageLayout - What an ImageIO works out before its first read
+
+  Preparing an image for reading means reading the mask header and the
+  block and pad masks of masked images, and letting the decompressor of a
+  compressed image find its blocks, which may mean scanning all of the
+  data. A layout holds the results, so that they can be kept somewhere
+  cheaper to get at and given to the next ImageIO that reads the same
+  image.
+*/
+
+typedef struct _nitf_ImageLayout
+{
+    nitf_Uint32 numBlocks;           /*!< Number of blocks in the image */
+    nitf_Uint32 imageDataOffset;     /*!< From the mask header */
+    nitf_Uint16 blockRecordLength;   /*!< From the mask header */
+    nitf_Uint16 padRecordLength;     /*!< From the mask header */
+    nitf_Uint16 padPixelValueLength; /*!< Bytes in padValue */
+    nitf_Uint8 padValue[16];         /*!< The pad pixel value */
+    nitf_Uint64 *blockMask;          /*!< numBlocks + 1 block offsets */
+    nitf_Uint64 *padMask;            /*!< numBlocks pad mask entries */
+    nitf_Uint32 numOffsets;          /*!< Entries in offsets */
+    nitf_Uint64 *offsets;            /*!< The decompressor's table, if any */
+}
+nitf_ImageLayout;
+
+/*!
+  \brief nitf_ImageLayout_construct - Allocate an empty layout
+
+  \return The layout, or NULL on error
+*/
+
+NITFPROT(nitf_ImageLayout *) nitf_ImageLayout_construct(nitf_Error * error);
+
+/*!
+  \brief nitf_ImageLayout_destruct - Free a layout and its tables
+*/
+
+NITFPROT(void) nitf_ImageLayout_destruct(nitf_ImageLayout ** layout);
+
+/*!
+  \brief nitf_ImageIO_getLayout - Get the layout of an image being read
+
+  Prepares the image for reading if that has not happened yet, and returns
+  a copy of what was worked out, to be freed by the caller.
+
+  \param image The associated ImageIO object
+  \param io IO interface for read
+  \param offsets The offsets interface of the image's decompressor, or NULL
+  \param error Error object
+  \return The layout, or NULL on error
+*/
+
+NITFPROT(nitf_ImageLayout *)
+nitf_ImageIO_getLayout(nitf_ImageIO * image,
+                       nitf_IOInterface * io,
+                       const nitf_DecompressionOffsetsInterface * offsets,
+                       nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_setLayout - Give an image the layout of an earlier read
+
+  The layout must come from nitf_ImageIO_getLayout on the same image data,
+  and has to be set before the first read. The masks are then not read
+  from the file, and the decompressor is handed its table rather than
+  building it. The layout is copied.
+
+  \param image The associated ImageIO object
+  \param layout The layout to use
+  \param offsets The offsets interface of the image's decompressor, or NULL
+  \param error Error object
+  \return FALSE on error, which leaves the image to work out its own
+  layout as usual
+
+  Possible errors include:
+
+    The layout does not fit the image
+    The image has already been read
+*/
+
+NITFPROT(NITF_BOOL)
+nitf_ImageIO_setLayout(nitf_ImageIO * image,
+                       const nitf_ImageLayout * layout,
+                       const nitf_DecompressionOffsetsInterface * offsets,
+                       nitf_Error * error);
+
 /*!
   \brief nitf_ImageIO_setWriteCaching - Enable/disable cached writes
 
@@ -852,6 +1003,33 @@ NITFPROT(int) nitf_ImageIO_setWriteCaching
     int enable               /*!< Enable cached writes if true */
 );
 
+/*!
+  \brief nitf_ImageIO_setSparseWrites - Enable/disable sparse writes
+
+  See the documentation for nitf_ImageWriter_setSparseWrites
+
+  \return Returns the current enable/disable state
+*/
+
+NITFPROT(int) nitf_ImageIO_setSparseWrites
+(
+    nitf_ImageIO * nitf,      /*!< Object to modify */
+    int enable               /*!< Enable sparse writes if true */
+);
+
+/*!
+  \brief nitf_ImageIO_getWrittenEnd - Get the end of the written pixels
+
+  Returns the file offset just past the furthest uncompressed pixel data of
+  the current or last write, whatever order the blocks went out in.  Data
+  left out by a sparse write counts once nitf_ImageIO_writeDone has
+  completed it.
+
+  \return The offset, or zero if no uncompressed pixels were written
+*/
+
+NITFPROT(nitf_Uint64) nitf_ImageIO_getWrittenEnd(nitf_ImageIO * nitf);
+
 /*!
   \brief nitf_ImageIO_setReadCaching - Enable cached reads
 
@@ -917,6 +1095,10 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
   formatted exactly as it needs to be and we want to avoid the performance hits of
   multiple small mem copies to get the data formatted properly.  Only use this if you
   know what you're doing!
+
+  Uncompressed blocks go to their own place in the image and may be written in
+  any order.  Compressed blocks must be written in order, starting from block 0.
+  A block number past the last block is an error.
  */
 NITFPROT(NRT_BOOL) nitf_ImageIO_writeBlockDirect(nitf_ImageIO* object,
                                                  nitf_IOInterface* io,
@@ -36,6 +36,7 @@ typedef struct _nitf_ImageReader
     nitf_IOInterface* input;
     nitf_ImageIO *imageDeblocker;
     int directBlockRead;
+    int segmentNumber;
 }
 nitf_ImageReader;
 
@@ -92,6 +92,29 @@ NITFAPI(void) nitf_ImageWriter_setDirectBlockWrite
     int enable                      /*!< Enable cached writes if true */
 );
 
+/*!
+ * \brief nitf_ImageWriter_setSparseWrites - Enable/disable sparse writes
+ *
+ * nitf_ImageWriter_setSparseWrites enables/disables sparse writes. When
+ * enabled, uncompressed pixel data that is all zero, such as blocks that
+ * are entirely pad with a zero pad pixel, is seeked over rather than
+ * written. On a file system that supports them this leaves holes in the
+ * output, so large mostly empty images take little disk space and write
+ * faster. The file length and contents are the same as without sparse
+ * writes.
+ *
+ * The output must read back zeros where it was never written, as a newly
+ * created file or a growable memory buffer does. Do not enable this when
+ * writing over existing data. Compressed images are not affected.
+ *
+ * \return Returns the current enable/disable state
+ */
+NITFAPI(int) nitf_ImageWriter_setSparseWrites
+(
+    nitf_ImageWriter * iWriter,     /*!< Object to modify */
+    int enable                      /*!< Enable sparse writes if true */
+);
+
 /*!
  *  Function allows the user access to the product's pad pixels.
  *  For example, if you wanted transparent pixels for fill, you would
@@ -109,6 +132,72 @@ NITFAPI(NITF_BOOL) nitf_ImageWriter_setPadPixel(nitf_ImageWriter* imageWriter,
                                                 nitf_Uint32 length,
                                                 nitf_Error* error);
 
+/*!
+ * \brief nitf_ImageWriter_open - Start a pushed write
+ *
+ * The image writer normally pulls its pixels from an attached image source
+ * while nitf_Writer_write runs.  The open, writeRows / writeBlock and finish
+ * functions let the caller push the pixels instead, as they are produced.
+ * The image data is written starting at the current position of the output,
+ * so the image subheader should already have been written (see
+ * nitf_Writer_writeImageSubheader).
+ *
+ * Write caching is enabled, so at most one block row is held in memory.
+ *
+ * \param imageWriter The image writer
+ * \param output The output to write to; it must stay valid until finish
+ * \param error An error to populate on failure
+ * \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_ImageWriter_open(nitf_ImageWriter* imageWriter,
+                                         nitf_IOInterface* output,
+                                         nitf_Error* error);
+
+/*!
+ * Writes the next numRows rows of a pushed write.  There is one buffer per
+ * band, in band order, each holding numRows rows of that band.
+ *
+ * \param imageWriter The opened image writer
+ * \param numRows The number of rows in each buffer
+ * \param data The row buffers, one per band
+ * \param error An error to populate on failure
+ * \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_ImageWriter_writeRows(nitf_ImageWriter* imageWriter,
+                                              nitf_Uint32 numRows,
+                                              nitf_Uint8** data,
+                                              nitf_Error* error);
+
+/*!
+ * Writes one block of a pushed write exactly as it will appear in the file,
+ * bypassing any reorganization of the data.  The blocks of an uncompressed
+ * image may be written in any order; those of a compressed image must be
+ * written in order, starting from block 0.  A block number past the last
+ * block is an error.  Only single band images are supported, and rows and
+ * blocks can not be mixed within one write.
+ *
+ * \param imageWriter The opened image writer
+ * \param blockNumber The block to write
+ * \param buffer The block data
+ * \param error An error to populate on failure
+ * \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_ImageWriter_writeBlock(nitf_ImageWriter* imageWriter,
+                                               nitf_Uint32 blockNumber,
+                                               const void* buffer,
+                                               nitf_Error* error);
+
+/*!
+ * Completes a pushed write, flushing any cached blocks and the block mask.
+ * The output is left positioned at its end, ready for the next segment.
+ *
+ * \param imageWriter The opened image writer
+ * \param error An error to populate on failure
+ * \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_ImageWriter_finish(nitf_ImageWriter* imageWriter,
+                                           nitf_Error* error);
+
 NITF_CXX_ENDGUARD
 
 #endif
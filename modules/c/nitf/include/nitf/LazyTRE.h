@@ -0,0 +1,74 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __NITF_LAZY_TRE_H__
+#define __NITF_LAZY_TRE_H__
+
+#include "nitf/System.h"
+#include "nitf/TRE.h"
+
+NITF_CXX_GUARD
+
+/*!
+ *  \fn nitf_LazyTRE_handler
+ *  \brief The handler the Reader gives TREs in lazy mode
+ *
+ *  Its read method only copies the raw TRE bytes and remembers where
+ *  they came from.  The first getField, setField, find, begin or getID
+ *  call parses the bytes with nitf_TRE_parse, which installs the real
+ *  handler on the TRE, and is then forwarded to it.  Writing or sizing a
+ *  TRE that was never parsed uses the raw bytes as they are, so an
+ *  untouched TRE is copied through unchanged.
+ *
+ *  A clone of an unparsed TRE is unparsed as well; it is not tied to the
+ *  source record, so its plug-in is handed a NULL record when it parses.
+ *
+ *  \param error The structure to populate if an error occurs
+ *  \return The handler
+ */
+NITFAPI(nitf_TREHandler*) nitf_LazyTRE_handler(nitf_Error * error);
+
+/*!
+ *  Parses a TRE that is still waiting on the lazy handler.  Does nothing
+ *  if the TRE has already been parsed.
+ *
+ *  \param tre The TRE
+ *  \param error The structure to populate if an error occurs
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_LazyTRE_resolve(nitf_TRE * tre, nitf_Error * error);
+
+/*!
+ *  Returns true if the TRE has not been parsed yet.
+ */
+NITFAPI(NITF_BOOL) nitf_LazyTRE_isPending(nitf_TRE * tre);
+
+/*!
+ *  Returns the offset in the input the bytes of an unparsed TRE were read
+ *  from, or -1 if the TRE has been parsed or did not come from a lazy read.
+ */
+NITFAPI(nitf_Off) nitf_LazyTRE_getOffset(nitf_TRE * tre);
+
+NITF_CXX_ENDGUARD
+
+#endif
@@ -29,6 +29,7 @@
 #define NITF_PLUGIN_HOOK_SUFFIX "_handler"
 #define NITF_PLUGIN_CONSTRUCT_SUFFIX "_construct"
 #define NITF_PLUGIN_DESTRUCT_SUFFIX "_destruct"
+#define NITF_PLUGIN_OFFSETS_SUFFIX "_offsets"
 
 #include "nitf/System.h"
 #include "nitf/TRE.h"
@@ -114,6 +115,28 @@ typedef void * (*NITF_PLUGIN_DECOMPRESSION_CONSTRUCT_FUNCTION)
     nitf_Error* error
 );
 
+/*
+  \brief NITF_PLUGIN_DECOMPRESSION_OFFSETS_FUNCTION - Function pointer for
+  the optional decompression offsets interface.
+
+  A decompression plugin may export this next to its constructor. The
+  return type is void * for the same reason as the constructor's. The type
+  is actually nitf_DecompressionOffsetsInterface *, and the object belongs
+  to the plugin.
+
+  \ar compressionType - Compression type code
+  \ar error           - Error object
+
+  \return Returns the object or NULL on error.
+
+  On error, the error object is initialized.
+*/
+typedef void * (*NITF_PLUGIN_DECOMPRESSION_OFFSETS_FUNCTION)
+(
+    const char *compressionType,
+    nitf_Error* error
+);
+
 
 typedef void * (*NITF_PLUGIN_COMPRESSION_CONSTRUCT_FUNCTION)
 (
@@ -32,6 +32,7 @@
 
 #   define NITF_COMPRESSION_HASH_SIZE 2
 #   define NITF_DECOMPRESSION_HASH_SIZE 2
+#   define NITF_TRE_HANDLER_CACHE_HASH_SIZE 64
 
 /*  The environment variable for the plugin path  */
 #   define NITF_PLUGIN_PATH "NITF_PLUGIN_PATH"
@@ -59,6 +60,13 @@ typedef struct _protected_nitf_PluginRegistry
     nitf_HashTable *compressionHandlers;
     nitf_HashTable *decompressionHandlers;
 
+    /*  The optional offsets functions of decompression plugins  */
+    nitf_HashTable *decompressionOffsets;
+
+    /*  Resolved TRE handlers by tag, with NULL for tags that have  */
+    /*  no plugin                                                   */
+    nitf_HashTable *treHandlerCache;
+
     nitf_List* dsos;
 
 }
@@ -170,6 +178,11 @@ nitf_PluginRegistry_unload(nitf_PluginRegistry * reg, nitf_Error * error);
  *  will return it, unless an error occurred, in which case, it sets
  *  had_error to 1.
  *
+ *  The result for each tag, found or not, is remembered, so the plugin
+ *  is only asked for its handler the first time the tag is seen.
+ *  Registering a handler for the tag later on forgets what was
+ *  remembered.
+ *
  *  \param reg This is the registry
  *  \param ident  This is the ID of the tre (the plugin will have same name)
  *  \param had_error If an error occured, this will be 1, otherwise it is 0
@@ -204,7 +217,18 @@ nitf_PluginRegistry_retrieveDecompConstructor(nitf_PluginRegistry * reg,
                                               int *hadError,
                                               nitf_Error * error);
 
-
+/*!
+ *  Retrieve the function that returns the offsets interface of a
+ *  decompression plugin.  Plugins need not provide one, so NULL is
+ *  returned without an error when there is none.
+ *
+ *  \param reg This is the registry
+ *  \param ident  This is the ID (e.g., C8)
+ *  \return The function, or NULL
+ */
+NITFPROT(NITF_PLUGIN_DECOMPRESSION_OFFSETS_FUNCTION)
+nitf_PluginRegistry_retrieveDecompOffsets(nitf_PluginRegistry * reg,
+                                          const char *ident);
 
 
 NITFPROT(NITF_PLUGIN_COMPRESSION_CONSTRUCT_FUNCTION)
@@ -26,6 +26,8 @@
 #include "nitf/System.h"
 #include "nitf/PluginRegistry.h"
 #include "nitf/DefaultTRE.h"
+#include "nitf/LazyTRE.h"
+#include "nitf/RecordIndex.h"
 #include "nitf/Record.h"
 #include "nitf/FieldWarning.h"
 #include "nitf/ImageReader.h"
@@ -33,6 +35,71 @@
 
 NITF_CXX_GUARD
 
+/* Segment types for nitf_ParseOptions.segments */
+#define NITF_PARSE_IMAGES   0x01
+#define NITF_PARSE_GRAPHICS 0x02
+#define NITF_PARSE_LABELS   0x04
+#define NITF_PARSE_TEXTS    0x08
+#define NITF_PARSE_DES      0x10
+#define NITF_PARSE_RES      0x20
+#define NITF_PARSE_ALL      0x3f
+
+/* Values for nitf_ParseOptions.treFilter */
+#define NITF_PARSE_TRES_ALL   0 /*!< Parse every TRE */
+#define NITF_PARSE_TRES_ALLOW 1 /*!< Parse only the TREs in treTags */
+#define NITF_PARSE_TRES_DENY  2 /*!< Parse all but the TREs in treTags */
+
+/*!
+ *  \struct nitf_ParseOptions
+ *  \brief  Limits what nitf_Reader_readIO parses
+ *
+ *  The file header is always parsed.  Each segment still appears in the
+ *  record with its data offsets set, but the subheader of a segment whose
+ *  type is not in segments is left unparsed.  Everything that is skipped
+ *  is recorded in the reader's skipped list, and can be parsed later with
+ *  nitf_Reader_parseSkipped.
+ *
+ *  A record read with filters is meant for inspection; parse what was
+ *  skipped before writing it back out.
+ */
+typedef struct _nitf_ParseOptions
+{
+    int segments;                 /*!< NITF_PARSE_* bits for the segments */
+    int treFilter;                /*!< NITF_PARSE_TRES_* */
+    const char **treTags;         /*!< NULL terminated tags for treFilter */
+    NITF_BOOL skipDEUserHeaders;  /*!< Leave DES user headers unparsed */
+} nitf_ParseOptions;
+
+/*!
+ *  What a skipped item was
+ */
+typedef enum _nitf_SkippedType
+{
+    NITF_SKIPPED_IMAGE = 0,       /*!< An image subheader */
+    NITF_SKIPPED_GRAPHIC,         /*!< A graphic subheader */
+    NITF_SKIPPED_LABEL,           /*!< A label subheader */
+    NITF_SKIPPED_TEXT,            /*!< A text subheader */
+    NITF_SKIPPED_DE,              /*!< A DE subheader */
+    NITF_SKIPPED_RE,              /*!< A RE subheader */
+    NITF_SKIPPED_TRE,             /*!< A TRE */
+    NITF_SKIPPED_DE_USER_HEADER   /*!< A DE subheader's user header */
+} nitf_SkippedType;
+
+/*!
+ *  \struct nitf_SkippedItem
+ *  \brief  Where something the reader did not parse is in the file
+ */
+typedef struct _nitf_SkippedItem
+{
+    nitf_SkippedType type;
+    int index;                    /*!< Segment index, or -1 for a TRE */
+    char tag[NITF_MAX_TAG + 1];   /*!< The tag of a skipped TRE */
+    nitf_Off offset;              /*!< Offset of the bytes in the input */
+    nitf_Uint32 length;           /*!< Number of bytes */
+    nitf_Extensions *extensions;  /*!< Where a skipped TRE belongs */
+    nitf_Uint32 ordinal;          /*!< How many TREs came before it there */
+} nitf_SkippedItem;
+
 /*!
  *  \struct nitf_Reader
  *  \brief  This object represents the 2.1 file reader
@@ -46,6 +113,11 @@ typedef struct _nitf_Reader
     nitf_IOInterface* input;
     nitf_Record *record;
     NITF_BOOL ownInput;
+    NITF_BOOL lazyTREs;
+    NITF_BOOL useArena;           /*!< Give each record an arena */
+    nitf_ParseOptions parseOptions;
+    nitf_List *skipped;           /*!< nitf_SkippedItem* from the last read */
+    nitf_RecordIndex *index;      /*!< Image layouts to use and fill in */
 
 }
 nitf_Reader;
@@ -84,6 +156,81 @@ NITFAPI(nitf_Record *) nitf_Reader_read(nitf_Reader * reader,
                                         nitf_IOHandle inputHandle,
                                         nitf_Error * error);
 
+/*!
+ *  Turns lazy TRE parsing on or off for the reads that follow.  In lazy
+ *  mode the reader keeps the raw bytes of each TRE and runs its plug-in
+ *  only when a field is first asked for or the TRE is enumerated, so
+ *  opening a file with many TREs costs little more than reading its
+ *  headers.  See nitf_LazyTRE_handler.
+ *
+ *  \param reader The reader object
+ *  \param enable Parse TREs lazily if true
+ */
+NITFAPI(void) nitf_Reader_setLazyTREs(nitf_Reader * reader,
+                                      NITF_BOOL enable);
+
+/*!
+ *  Turns record arenas on or off for the reads that follow.  With them
+ *  on, each record is given an nitf_Arena, and the TREs parsed for the
+ *  record, which make up most of its small allocations, are kept in it.
+ *  Parsing then makes far fewer trips to the allocator, and destroying
+ *  the record gives the memory back in one step.  The record can still
+ *  be changed and added to as usual.
+ *
+ *  TREs parsed lazily go into the arena when they are first used, so a
+ *  record with an arena must not be used from two threads at once.
+ *
+ *  \param reader The reader object
+ *  \param enable Give each record an arena if true
+ */
+NITFAPI(void) nitf_Reader_setUseArena(nitf_Reader * reader,
+                                      NITF_BOOL enable);
+
+/*!
+ *  Gives the reader an index of the file it reads, which image readers
+ *  take their layout from.  Images the index does not know yet are laid
+ *  out when their image reader is made, rather than on the first read,
+ *  and added to it.  The reader does not own the index.
+ *
+ *  \param reader The reader object
+ *  \param index The index, or NULL to stop using one
+ */
+NITFAPI(void) nitf_Reader_setIndex(nitf_Reader * reader,
+                                   nitf_RecordIndex * index);
+
+/*!
+ *  Fills in options so that everything is parsed, which is the default.
+ */
+NITFAPI(void) nitf_ParseOptions_init(nitf_ParseOptions * options);
+
+/*!
+ *  Sets what the reads that follow parse.  The options are copied, but
+ *  the treTags strings are not, and must outlive the reads.
+ *
+ *  \param reader The reader object
+ *  \param options The options, or NULL to parse everything again
+ */
+NITFAPI(void) nitf_Reader_setParseOptions(nitf_Reader * reader,
+                                          const nitf_ParseOptions * options);
+
+/*!
+ *  Parses an item that the last read skipped, from the reader's skipped
+ *  list, into the record, as if it had been parsed in the first place: a
+ *  segment subheader is filled in, a TRE goes back into its extensions
+ *  where it was in the file, and a DES user header is attached to its
+ *  subheader.  A TRE's place is counted from the TREs that were parsed, so
+ *  the extensions should not be changed until the skipped TREs are in.  On success the item
+ *  is removed from the list and freed.
+ *
+ *  \param reader The reader object, still holding the input it read from
+ *  \param item An item from reader->skipped
+ *  \param error A populated error on failure
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_Reader_parseSkipped(nitf_Reader * reader,
+                                            nitf_SkippedItem * item,
+                                            nitf_Error * error);
+
 /*!
  *  Same as the read function, except this method allows you to change
  *  the underlying interface.  The read method calls this one using an
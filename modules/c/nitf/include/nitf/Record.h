@@ -34,6 +34,28 @@
 
 NITF_CXX_GUARD
 
+/*!
+ *  \struct nitf_SegmentIndex
+ *  \brief The segments of one of a record's lists by position
+ *
+ *  The nitf_Record functions that add, remove and move segments keep the
+ *  index in step with its list, so that looking a segment up neither walks
+ *  the list nor changes anything, and any number of threads may do it at
+ *  once.
+ */
+typedef struct _nitf_SegmentIndex
+{
+    /* The segments, in the order of the list */
+    NITF_DATA **segments;
+
+    /* The number of segments indexed */
+    nitf_Uint32 size;
+
+    /* The number of segments there is room for */
+    nitf_Uint32 capacity;
+}
+nitf_SegmentIndex;
+
 /*!
  *  \struct nitf_Record
  *  \brief This is a record of the file
@@ -66,6 +88,17 @@ typedef struct _nitf_Record
 
     /* List of reserved segments (RES) */
     nitf_List *reservedExtensions;
+
+    /* The arena its TREs were parsed into, if any (see nitf_Reader) */
+    nitf_Arena *arena;
+
+    /* The segment lists by position, one index for each list above */
+    nitf_SegmentIndex imageIndex;
+    nitf_SegmentIndex graphicIndex;
+    nitf_SegmentIndex labelIndex;
+    nitf_SegmentIndex textIndex;
+    nitf_SegmentIndex dataExtensionIndex;
+    nitf_SegmentIndex reservedExtensionIndex;
 }
 nitf_Record;
 
@@ -91,7 +124,12 @@ NITFAPI(nitf_Record *) nitf_Record_construct(nitf_Version version,
 
 
 /*!
- *  Clone this object.  This is a deep copy operation.
+ *  Clone this object.  This is a deep copy operation, except that the
+ *  TREs are cloned with nitf_TRE_clone and so share their fields with the
+ *  source's until either side changes them.  Sharing moves the source's
+ *  TREs onto nitf_SharedTRE_handler, so a record must not be in use by
+ *  another thread while it is being cloned, though several threads may
+ *  clone it at once.
  *
  *  \param source The source object
  *  \param error  An error to populate upon failure
@@ -101,7 +139,8 @@ NITFAPI(nitf_Record *) nitf_Record_clone(const nitf_Record * source,
                                          nitf_Error * error);
 
 /*!
- *  Destroy a record and NULL-set it
+ *  Destroy a record and NULL-set it.  If the record has an arena, the
+ *  arena goes with it, releasing everything allocated in it at once.
  *  \param record A record to destroy
  */
 NITFAPI(void) nitf_Record_destruct(nitf_Record ** record);
@@ -228,6 +267,84 @@ NITFAPI(nitf_DESegment*)
 nitf_Record_newDataExtensionSegment(nitf_Record * record,
                                     nitf_Error * error);
 
+/*!
+ *  Appends a segment to one of the record's segment lists, and to the
+ *  record's index of that list.  This is how the reader adds the segments
+ *  it reads; applications add segments with the nitf_Record_new*Segment
+ *  functions, which also set up the file header.
+ *
+ *  \param record The record
+ *  \param segments One of the record's segment lists
+ *  \param segment The segment, which the record takes ownership of
+ *  \param error An error to populate on failure
+ *  \return NITF_SUCCESS, or NITF_FAILURE with the segment not added
+ */
+NITFPROT(NITF_BOOL) nitf_Record_appendSegment(nitf_Record* record,
+                                              nitf_List* segments,
+                                              NITF_DATA* segment,
+                                              nitf_Error* error);
+
+/*!
+ *  Returns the segment at the given index of the record's segment list.
+ *  The record keeps an index of each list, so this takes constant time
+ *  however many segments the record holds.  A list that was changed other
+ *  than through the nitf_Record functions is walked instead, as by
+ *  nitf_List_get.  The record keeps ownership of the segment.
+ *
+ *  \param record The record
+ *  \param index The zero-based segment index
+ *  \param error An error to populate if there is no such segment
+ *  \return The segment, or NULL on failure
+ */
+NITFAPI(nitf_ImageSegment*)
+nitf_Record_getImageSegment(const nitf_Record* record,
+                            nitf_Uint32 index,
+                            nitf_Error* error);
+
+/*!
+ *  Returns the graphic segment at the given index, like
+ *  nitf_Record_getImageSegment.
+ */
+NITFAPI(nitf_GraphicSegment*)
+nitf_Record_getGraphicSegment(const nitf_Record* record,
+                              nitf_Uint32 index,
+                              nitf_Error* error);
+
+/*!
+ *  Returns the label segment at the given index, like
+ *  nitf_Record_getImageSegment.
+ */
+NITFAPI(nitf_LabelSegment*)
+nitf_Record_getLabelSegment(const nitf_Record* record,
+                            nitf_Uint32 index,
+                            nitf_Error* error);
+
+/*!
+ *  Returns the text segment at the given index, like
+ *  nitf_Record_getImageSegment.
+ */
+NITFAPI(nitf_TextSegment*) nitf_Record_getTextSegment(const nitf_Record* record,
+                                                      nitf_Uint32 index,
+                                                      nitf_Error* error);
+
+/*!
+ *  Returns the data extension segment at the given index, like
+ *  nitf_Record_getImageSegment.
+ */
+NITFAPI(nitf_DESegment*)
+nitf_Record_getDataExtensionSegment(const nitf_Record* record,
+                                    nitf_Uint32 index,
+                                    nitf_Error* error);
+
+/*!
+ *  Returns the reserved extension segment at the given index, like
+ *  nitf_Record_getImageSegment.
+ */
+NITFAPI(nitf_RESegment*)
+nitf_Record_getReservedExtensionSegment(const nitf_Record* record,
+                                        nitf_Uint32 index,
+                                        nitf_Error* error);
+
 
 /*!
  * This removes the segment at the given offset. The segment is
@@ -0,0 +1,130 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __NITF_RECORD_INDEX_H__
+#define __NITF_RECORD_INDEX_H__
+
+#include "nitf/System.h"
+#include "nitf/ImageIO.h"
+
+NITF_CXX_GUARD
+
+/* How much of the start of a file goes into its header hash */
+#define NITF_RECORD_INDEX_HASH_LENGTH 4096
+
+/*!
+ *  \struct nitf_ImageIndex
+ *  \brief  The cached layout of one image segment
+ */
+typedef struct _nitf_ImageIndex
+{
+    nitf_Uint64 offset;         /*!< Where the image data starts */
+    nitf_Uint64 length;         /*!< How long the image data is */
+    nitf_ImageLayout *layout;   /*!< NULL until the image has been read */
+} nitf_ImageIndex;
+
+/*!
+ *  \struct nitf_RecordIndex
+ *  \brief  A sidecar of what opening a file's images works out
+ *
+ *  Getting an image ready to read means reading its mask header and
+ *  masks, and for compressed images letting the decompressor find its
+ *  blocks, which for JPEG means scanning every byte.  A record index keeps
+ *  the results in a sidecar file, so that a process opening the same file
+ *  later skips that work.
+ *
+ *  The sidecar belongs to one version of one file, which it records as
+ *  the file size, its stamp (device, inode, and modification and status
+ *  change times to the nanosecond) and a hash of its first
+ *  NITF_RECORD_INDEX_HASH_LENGTH bytes.  A sidecar that does not match the
+ *  file, or that cannot be read, is ignored and starts over empty.
+ *
+ *  A reader given an index with nitf_Reader_setIndex takes the layout of
+ *  each image from it in nitf_Reader_newImageReader, or works the layout
+ *  out there and then and adds it.  Save the index afterwards to keep
+ *  what was added.
+ */
+typedef struct _nitf_RecordIndex
+{
+    nitf_Uint64 fileSize;       /*!< Size of the file */
+    nitf_FileStamp stamp;       /*!< Where the file is and when it changed */
+    nitf_Uint64 headerHash;     /*!< Hash of the start of the file */
+    nitf_Uint32 numImages;      /*!< Entries in images */
+    nitf_ImageIndex *images;    /*!< Indexed by image segment */
+    NITF_BOOL changed;          /*!< Something was added since the load */
+} nitf_RecordIndex;
+
+/*!
+ *  Loads the sidecar at path for the file open on handle, or starts an
+ *  empty index for the file if the sidecar is missing, unreadable or made
+ *  for a different version of it.  The handle is left where it was.
+ *
+ *  \param path     The sidecar
+ *  \param handle   The NITF file
+ *  \param error    Populated on failure
+ *  \return The index, or NULL if the file itself could not be examined
+ */
+NITFAPI(nitf_RecordIndex *) nitf_RecordIndex_load(const char *path,
+                                                  nitf_IOHandle handle,
+                                                  nitf_Error * error);
+
+/*!
+ *  Writes the index to the sidecar at path if anything was added to it.
+ *  The sidecar is replaced whole, by writing a temporary file next to it
+ *  and renaming that, so that other processes never load half of it.
+ *
+ *  \return NITF_SUCCESS, or NITF_FAILURE with error populated
+ */
+NITFAPI(NITF_BOOL) nitf_RecordIndex_save(nitf_RecordIndex * index,
+                                         const char *path,
+                                         nitf_Error * error);
+
+/*!
+ *  Destroys the index and sets *index to NULL
+ */
+NITFAPI(void) nitf_RecordIndex_destruct(nitf_RecordIndex ** index);
+
+/*!
+ *  Gets the layout kept for an image segment, if the data of the segment
+ *  is where it was when the layout was added.
+ *
+ *  \return The layout, which the index owns, or NULL
+ */
+NITFPROT(const nitf_ImageLayout *)
+nitf_RecordIndex_getImage(nitf_RecordIndex * index, nitf_Uint32 segment,
+                          nitf_Uint64 offset, nitf_Uint64 length);
+
+/*!
+ *  Keeps the layout of an image segment, replacing any it had.  The index
+ *  takes ownership of the layout, even on failure.
+ */
+NITFPROT(NITF_BOOL) nitf_RecordIndex_setImage(nitf_RecordIndex * index,
+                                              nitf_Uint32 segment,
+                                              nitf_Uint64 offset,
+                                              nitf_Uint64 length,
+                                              nitf_ImageLayout * layout,
+                                              nitf_Error * error);
+
+NITF_CXX_ENDGUARD
+
+#endif
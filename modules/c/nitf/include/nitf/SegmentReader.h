@@ -86,6 +86,26 @@ NITFAPI(NITF_BOOL) nitf_SegmentReader_read
     nitf_Error *error                     /*!< For error returns */
 );
 
+/*!
+  \brief nitf_SegmentReader_copy - Copy segment data to an output
+
+  The nitf_SegmentReader_copy function is nitf_SegmentReader_read with the
+  data going straight to an output instead of a buffer, so it never passes
+  through user space when both the input and the output are files (see
+  nitf_IOInterface_copy).
+
+  \return TRUE is returned on success. On error, the error object
+  is set.
+*/
+
+NITFAPI(NITF_BOOL) nitf_SegmentReader_copy
+(
+    nitf_SegmentReader *segmentReader,    /*!< Associated SegmentReader */
+    nitf_IOInterface *output,             /*!< Where the data goes */
+    size_t count,                         /*!< Amount of data to copy */
+    nitf_Error *error                     /*!< For error returns */
+);
+
 /*!
   \brief nitf_SegmentReader_seek - Seek in segment data
 
@@ -113,6 +113,28 @@ NITFAPI(nitf_SegmentSource *) nitf_SegmentReaderSource_construct
     nitf_Error * error
 );
 
+/*!
+ *  Copy the next size bytes of a source straight to an output, if the
+ *  source is a plain view of an IO interface (a SegmentReader source, or a
+ *  file source without a byte skip).  Nothing is copied and *copied is set
+ *  to false for any other kind of source, which then has to be read.
+ *
+ *  \param source The source to copy from
+ *  \param output The output to copy to
+ *  \param size The number of bytes to copy
+ *  \param copied Set to whether the copy was done
+ *  \param error Populated on failure
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFPROT(NITF_BOOL) nitf_SegmentSource_copy
+(
+    nitf_SegmentSource * source,
+    nitf_IOInterface * output,
+    nitf_Off size,
+    NITF_BOOL * copied,
+    nitf_Error * error
+);
+
 
 NITF_CXX_ENDGUARD
 
@@ -0,0 +1,105 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_SHARED_TRE_H__
+#define __NITF_SHARED_TRE_H__
+
+#include "nitf/System.h"
+#include "nitf/TRE.h"
+
+NITF_CXX_GUARD
+
+/*!
+ *  \fn nitf_SharedTRE_handler
+ *  \brief The handler nitf_TRE_clone gives TREs that share their contents
+ *
+ *  Cloning a parsed TRE does not copy its fields, unless nitf_TRE_getField,
+ *  nitf_TRE_find or nitf_TRE_begin has handed them out, since the caller
+ *  may still change them through what it was given.  Otherwise the
+ *  source's handler and private data move into a reference counted body
+ *  that the source and every clone of it point to.  Sizing, writing and getID read the body;
+ *  the first getField, setField, find or begin call on one of the TREs
+ *  gives that TRE a copy of its own (or the body itself, if no other TRE
+ *  still uses it) and is then forwarded to the real handler, so a change
+ *  made through one TRE is never seen through another.
+ *
+ *  The reference counts are locked, so clones of one TRE may be made and
+ *  used from different threads, and several threads may clone the same
+ *  TRE at once.  Otherwise, like any TRE, a single nitf_TRE still must not
+ *  be used from two threads at once.
+ *
+ *  \param error The structure to populate if an error occurs
+ *  \return The handler
+ */
+NITFAPI(nitf_TREHandler*) nitf_SharedTRE_handler(nitf_Error * error);
+
+/*!
+ *  Makes a new TRE share the contents of source, first moving the
+ *  source's handler and private data into a shared body if they are not
+ *  there yet.  Sources that are still waiting on the lazy handler, held
+ *  in a record arena, whose fields have been handed out, or whose handler
+ *  cannot clone are left alone; tre just gets their handler, and *shared
+ *  is left 0 so that the caller copies the contents instead.
+ *
+ *  The source is read and changed over under one lock, so any number of
+ *  threads may clone the same TRE at once.
+ *
+ *  \param source The TRE to clone
+ *  \param tre The new TRE, with its tag already set
+ *  \param shared Set to 1 if tre now shares the source's contents
+ *  \param error The structure to populate if an error occurs
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFPROT(NITF_BOOL) nitf_SharedTRE_share(nitf_TRE * source,
+                                         nitf_TRE * tre,
+                                         NITF_BOOL * shared,
+                                         nitf_Error * error);
+
+/*!
+ *  Gives a shared TRE contents of its own and puts its real handler back.
+ *  Does nothing if the TRE is not shared.
+ *
+ *  \param tre The TRE
+ *  \param error The structure to populate if an error occurs
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_SharedTRE_unshare(nitf_TRE * tre, nitf_Error * error);
+
+/*!
+ *  Returns true if the TRE still shares its contents with another TRE
+ *  (or did, until the others were destroyed).
+ */
+NITFAPI(NITF_BOOL) nitf_SharedTRE_isShared(nitf_TRE * tre);
+
+/*!
+ *  Returns the TRE that holds a shared TRE's real handler and private
+ *  data, or the TRE itself if it is not shared.  The contents may be
+ *  read from any of the TREs sharing them, but must not be changed.
+ *
+ *  \param tre The TRE
+ *  \return The TRE holding the contents
+ */
+NITFPROT(nitf_TRE*) nitf_SharedTRE_getContents(nitf_TRE * tre);
+
+NITF_CXX_ENDGUARD
+
+#endif
@@ -81,6 +81,9 @@
 #define NITF_MALLOC NRT_MALLOC
 #define NITF_REALLOC NRT_REALLOC
 #define NITF_FREE NRT_FREE
+typedef nrt_Allocator               nitf_Allocator;
+#define nitf_Memory_setAllocator    nrt_Memory_setAllocator
+#define nitf_Memory_getAllocator    nrt_Memory_getAllocator
 
 
 /******************************************************************************/
@@ -205,6 +208,10 @@ typedef nrt_DLL             nitf_DLL;
 #define nitf_Mutex_unlock   nrt_Mutex_unlock
 #define nitf_Mutex_init     nrt_Mutex_init
 #define nitf_Mutex_delete   nrt_Mutex_delete
+#define nitf_Thread         nrt_Thread
+#define NITF_THREAD_RUN     NRT_THREAD_RUN
+#define nitf_Thread_start   nrt_Thread_start
+#define nitf_Thread_join    nrt_Thread_join
 
 
 /******************************************************************************/
@@ -232,6 +239,10 @@ typedef nrt_Directory                   nitf_Directory;
 #define nitf_IOHandle_seek      nrt_IOHandle_seek
 #define nitf_IOHandle_tell      nrt_IOHandle_tell
 #define nitf_IOHandle_getSize   nrt_IOHandle_getSize
+#define nitf_IOHandle_getStamp  nrt_IOHandle_getStamp
+#define nitf_IOHandle_copy      nrt_IOHandle_copy
+#define nitf_IOHandle_truncate  nrt_IOHandle_truncate
+#define nitf_IOHandle_readBatch nrt_IOHandle_readBatch
 #define nitf_IOHandle_close     nrt_IOHandle_close
 
 
@@ -252,6 +263,8 @@ typedef NRT_IO_INTERFACE_DESTRUCT       NITF_IO_INTERFACE_DESTRUCT;
 
 typedef nrt_IIOInterface                nitf_IIOInterface;
 typedef nrt_IOInterface                 nitf_IOInterface;
+typedef nrt_IORequest                   nitf_IORequest;
+typedef nrt_FileStamp                   nitf_FileStamp;
 
 #define nitf_IOInterface_read           nrt_IOInterface_read
 #define nitf_IOInterface_write          nrt_IOInterface_write
@@ -262,9 +275,41 @@ typedef nrt_IOInterface                 nitf_IOInterface;
 #define nitf_IOInterface_getMode        nrt_IOInterface_getMode
 #define nitf_IOInterface_close          nrt_IOInterface_close
 #define nitf_IOInterface_destruct       nrt_IOInterface_destruct
+#define nitf_IOInterface_copy           nrt_IOInterface_copy
+#define nitf_IOInterface_truncate       nrt_IOInterface_truncate
+#define nitf_IOInterface_readBatch      nrt_IOInterface_readBatch
 #define nitf_IOHandleAdapter_construct  nrt_IOHandleAdapter_construct
 #define nitf_IOHandleAdapter_open       nrt_IOHandleAdapter_open
 #define nitf_BufferAdapter_construct    nrt_BufferAdapter_construct
+#define nitf_BufferedAdapter_construct  nrt_BufferedAdapter_construct
+#define nitf_GrowableBufferAdapter_construct \
+                                 nrt_GrowableBufferAdapter_construct
+#define nitf_GrowableBufferAdapter_getBuffer \
+                                 nrt_GrowableBufferAdapter_getBuffer
+#define nitf_GrowableBufferAdapter_release \
+                                 nrt_GrowableBufferAdapter_release
+
+#include "nrt/IOStats.h"
+#define NITF_IO_STATS_BUCKETS           NRT_IO_STATS_BUCKETS
+#define NITF_IO_STATS_READ              NRT_IO_STATS_READ
+#define NITF_IO_STATS_WRITE             NRT_IO_STATS_WRITE
+#define NITF_IO_STATS_SEEK              NRT_IO_STATS_SEEK
+#define NITF_IO_STATS_BATCH             NRT_IO_STATS_BATCH
+#define NITF_IO_STATS_NUM_OPS           NRT_IO_STATS_NUM_OPS
+typedef nrt_IOStatsOp                   nitf_IOStatsOp;
+typedef nrt_IOOpStats                   nitf_IOOpStats;
+typedef nrt_IOStats                     nitf_IOStats;
+typedef nrt_IOAccess                    nitf_IOAccess;
+typedef NRT_IO_STATS_TRACE              NITF_IO_STATS_TRACE;
+#define nitf_IOStatsAdapter_construct   nrt_IOStatsAdapter_construct
+#define nitf_IOStatsAdapter_getWrapped  nrt_IOStatsAdapter_getWrapped
+#define nitf_IOStatsAdapter_setTag      nrt_IOStatsAdapter_setTag
+#define nitf_IOStatsAdapter_setBlock    nrt_IOStatsAdapter_setBlock
+#define nitf_IOStatsAdapter_setTrace    nrt_IOStatsAdapter_setTrace
+#define nitf_IOStatsAdapter_getStats    nrt_IOStatsAdapter_getStats
+#define nitf_IOStatsAdapter_getTag      nrt_IOStatsAdapter_getTag
+#define nitf_IOStatsAdapter_reset       nrt_IOStatsAdapter_reset
+#define nitf_IOStatsAdapter_toJSON      nrt_IOStatsAdapter_toJSON
 
 
 /******************************************************************************/
@@ -304,6 +349,14 @@ typedef nrt_Pair        nitf_Pair;
 /******************************************************************************/
 /* LIST                                                                       */
 /******************************************************************************/
+#include "nrt/Arena.h"
+typedef nrt_Arena                       nitf_Arena;
+#define nitf_Arena_construct            nrt_Arena_construct
+#define nitf_Arena_destruct             nrt_Arena_destruct
+#define nitf_Arena_malloc               nrt_Arena_malloc
+#define nitf_Arena_find                 nrt_Arena_find
+#define nitf_Arena_getSize              nrt_Arena_getSize
+
 #include "nrt/List.h"
 typedef nrt_ListNode                    nitf_ListNode;
 typedef NRT_DATA_ITEM_CLONE             NITF_DATA_ITEM_CLONE;
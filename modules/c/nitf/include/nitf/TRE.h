@@ -90,6 +90,7 @@ typedef struct _nitf_TRE
     struct _nitf_TREHandler* handler;  /*! The plug-in handler */
     NITF_DATA* priv;                   /*! Private data the plug-in knows about */
     char tag[NITF_MAX_TAG + 1];        /* the TRE tag */
+    NITF_BOOL exposed;                 /* Fields of it have been handed out */
 } nitf_TRE;
 
 
@@ -316,6 +317,24 @@ typedef struct _nitf_TREHandler
 NITFPROT(nitf_TRE *) nitf_TRE_createSkeleton(const char* tag,
         nitf_Error * error);
 
+/*!
+ *  Parses a TRE from length bytes of io.  The handler registered for the
+ *  tag is tried first; if there is none, or it fails to parse the data, io
+ *  is moved back and the default handler keeps the bytes raw.  This is
+ *  how the Reader parses each TRE it finds.
+ *  \param tre     A skeleton TRE, with its tag set
+ *  \param io      The IO interface, positioned at the TRE data
+ *  \param length  The length of the TRE data
+ *  \param record  The record the TRE belongs to, handed to the plug-in
+ *  \param error   The error to populate on failure
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFPROT(NITF_BOOL) nitf_TRE_parse(nitf_TRE * tre,
+                                   nitf_IOInterface * io,
+                                   nitf_Uint32 length,
+                                   struct _nitf_Record *record,
+                                   nitf_Error * error);
+
 /*!
  *  Construct an actual TRE (for users of the library)
  *  \param tag      Name of TRE
@@ -331,11 +350,9 @@ NITFAPI(nitf_TRE *) nitf_TRE_construct(const char* tag,
 
 
 /*!
- *  Clone this object.  This is a deep copy operation.
- *  This is a serious problem since this is the first thing
- *  people will want to do.  Possible solution: put desc inside
- *  of the TRE.  Alternate possibility: call TRE plugin
- *  handler explicitly
+ *  Clone this object.  This behaves as a deep copy, but the fields of a
+ *  parsed TRE are only copied once the source or the clone is changed;
+ *  until then both share them through nitf_SharedTRE_handler.
  *  \param source The source object
  *  \param error  An error to populate upon failure
  *  \return A new object that is identical to the old
@@ -25,6 +25,7 @@
 
 #include "nitf/TRE.h"
 #include "nitf/TREDescription.h"
+#include "nitf/TREPlan.h"
 
 NITF_CXX_GUARD
 /*!
@@ -46,6 +47,8 @@ typedef struct _nitf_TRECursor
     nitf_IntStack *loop_rtn;    /* holds the endloop bookmark for each level of loops */
     nitf_TRE *tre;              /* the TRE associated with this cursor */
     nitf_TREDescription *end_ptr; /* holds a pointer to the end description */
+    const nitf_TREPlan *plan;   /* the compiled form of the description */
+    nitf_TREPlan *ownPlan;      /* the plan, if no handler registered one */
 
     /* YOU CAN REFER TO THE MEMBERS BELOW IN YOUR CODE */
     nitf_TREDescription *prev_ptr; /* holds the previous description */
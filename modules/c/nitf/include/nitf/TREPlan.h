@@ -0,0 +1,174 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_TRE_PLAN_H__
+#define __NITF_TRE_PLAN_H__
+
+#include "nitf/System.h"
+#include "nitf/TRE.h"
+#include "nitf/TREDescription.h"
+
+NITF_CXX_GUARD
+
+/*
+ *  Where a loop gets its count from
+ */
+#define NITF_TRE_PLAN_FIELD     0   /* a field, optionally adjusted by op */
+#define NITF_TRE_PLAN_CONSTANT  1   /* NITF_CONST_N, kept in operand */
+#define NITF_TRE_PLAN_FUNCTION  2   /* NITF_FUNCTION, called each time */
+
+/*
+ *  The comparison an if makes.  NITF_TRE_PLAN_INVALID marks a label
+ *  that could not be understood; like a bad loop operator, it is only
+ *  reported once the cursor reaches it.
+ */
+enum
+{
+    NITF_TRE_PLAN_INVALID = -1,
+    NITF_TRE_PLAN_EQ = 1,   /* eq */
+    NITF_TRE_PLAN_NE,       /* ne */
+    NITF_TRE_PLAN_LT,       /* < */
+    NITF_TRE_PLAN_GT,       /* > */
+    NITF_TRE_PLAN_LE,       /* <= */
+    NITF_TRE_PLAN_GE,       /* >= */
+    NITF_TRE_PLAN_EQUAL,    /* == */
+    NITF_TRE_PLAN_UNEQUAL,  /* != */
+    NITF_TRE_PLAN_AND       /* & */
+};
+
+/*
+ *  The deepest a conditional length's expression may take its stack
+ */
+#define NITF_TRE_PLAN_DEPTH 32
+
+/*!
+ *  A tag as the cursor looks it up, once the loop indexes are added on.
+ */
+typedef struct _nitf_TREPlanRef
+{
+    char *tag;          /* the tag */
+    size_t length;      /* strlen of the tag */
+    size_t baseLength;  /* the tag, up to any '[' */
+    int brackets;       /* how many "[]" the tag carries itself */
+} nitf_TREPlanRef;
+
+/*!
+ *  One term of a conditional length's postfix expression.
+ */
+typedef struct _nitf_TREPlanTerm
+{
+    int op;             /* '+', '-', '*', '/', '%', or 0 for a value */
+    int value;          /* the value, if it is a constant */
+    nitf_TREPlanRef ref;  /* the field holding the value, if ref.tag */
+} nitf_TREPlanTerm;
+
+/*!
+ *  One nitf_TREDescription entry, with everything about it that does not
+ *  depend on the data worked out in advance.
+ */
+typedef struct _nitf_TREPlanStep
+{
+    int kind;           /* the data_type of the entry */
+    int end;            /* loops and ifs: the matching end (or numItems) */
+    nitf_TREPlanRef ref;  /* the entry's tag */
+    int source;         /* loops: NITF_TRE_PLAN_FIELD, _CONSTANT, ... */
+    int op;             /* loops: '+', '-', ..., 0 or -1; ifs: the test */
+    int operand;        /* the number the op or test works with */
+    nitf_Uint32 bits;   /* ifs: the mask for '&' */
+    char *text;         /* ifs: what eq and ne compare against */
+    nitf_TREPlanTerm *terms;  /* conditional lengths: the expression */
+    int numTerms;       /* how many terms there are */
+    int depth;          /* the most values the expression stacks up */
+} nitf_TREPlanStep;
+
+/*!
+ *  \struct nitf_TREPlan
+ *  \brief A nitf_TREDescription compiled for the nitf_TRECursor
+ *
+ *  Loop counts, conditions, conditional lengths and tags are worked out
+ *  once, rather than re-read out of the description strings for every
+ *  TRE.  The plans for a handler's descriptions are built when the handler
+ *  is created and kept until the plugins are unloaded; a description no
+ *  handler registered gets a plan of its own for each walk.  A plan is
+ *  never changed once it has been handed out.
+ */
+typedef struct _nitf_TREPlan
+{
+    nitf_TREHandler *handler;           /* the handler it was built for */
+    nitf_TREDescription *description;   /* what the plan was built from */
+    nitf_TREDescription *entries;       /* a copy, to notice reuse */
+    int numItems;                       /* entries before NITF_END */
+    nitf_TREPlanStep *steps;            /* one per entry */
+    struct _nitf_TREPlan *next;         /* for plans that were replaced */
+} nitf_TREPlan;
+
+/*!
+ *  Builds the plans for each description in a handler's set and publishes
+ *  them, so that nitf_TREPlan_get finds them.  Registering the same set
+ *  again only rebuilds plans whose description has changed.
+ *
+ *  \param handler The handler using the set
+ *  \param set The handler's descriptions
+ *  \param error The structure to populate if an error occurs
+ *  \return FALSE on failure
+ */
+NITFPROT(NITF_BOOL) nitf_TREPlan_register(nitf_TREHandler * handler,
+                                          nitf_TREDescriptionSet * set,
+                                          nitf_Error * error);
+
+/*!
+ *  Returns the plan registered for the description with the handler.
+ *  Nothing is locked, so this may be called from any thread once the
+ *  registration is over.
+ *
+ *  \param handler The handler of the TRE being walked
+ *  \param description The description, ending in NITF_END
+ *  \return The plan, or NULL if none was registered
+ */
+NITFPROT(const nitf_TREPlan *) nitf_TREPlan_get(
+        nitf_TREHandler * handler, nitf_TREDescription * description);
+
+/*!
+ *  Builds a plan that is not registered, for a description that has none,
+ *  to be freed with nitf_TREPlan_destruct.
+ *
+ *  \param description The description, ending in NITF_END
+ *  \param error The structure to populate if an error occurs
+ *  \return The plan, or NULL on failure
+ */
+NITFPROT(nitf_TREPlan *) nitf_TREPlan_construct(
+        nitf_TREDescription * description, nitf_Error * error);
+
+/*!
+ *  Frees a plan from nitf_TREPlan_construct.
+ */
+NITFPROT(void) nitf_TREPlan_destruct(nitf_TREPlan ** plan);
+
+/*!
+ *  Frees every registered plan, and those they replaced.  Called when the
+ *  plugins are unloaded, so no TRE may be walked at the same time.
+ */
+NITFPROT(void) nitf_TREPlan_unload(void);
+
+NITF_CXX_ENDGUARD
+
+#endif
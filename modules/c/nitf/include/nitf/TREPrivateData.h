@@ -29,9 +29,24 @@
 NITF_CXX_GUARD
 
 
+/*!
+ *  Number of fields held by each block of the flat field store.  Blocks
+ *  are never moved once allocated, so a nitf_Pair handed out by find or
+ *  an enumerator stays valid until the TRE is flushed.
+ */
+#define NITF_TRE_FIELD_BLOCK 64
+
+struct _nitf_TREKeyBlock;
+
 /*!
  * A structure meant to be used for the private data of the TRE structure.
  * It keeps track of the length (if given) as well as the Description
+ *
+ * The fields are kept in a flat store, in the order they were added (which
+ * for a parsed TRE is description order), together with an open-addressed
+ * index from the field name to its slot.  The hash member is only a view
+ * of that store: it is NULL until nitf_TREPrivateData_getHash is called,
+ * and its pairs are the ones owned by the store.
  */
 typedef struct _nitf_TREPrivateData
 {
@@ -40,12 +55,33 @@ typedef struct _nitf_TREPrivateData
     nitf_TREDescription* description;
     nitf_HashTable *hash;
     NITF_DATA *userData;    /*! user-defined - meant for extending this */
+
+    /* DO NOT TOUCH -- use the functions below */
+    nitf_Pair **blocks;     /*! the fields, NITF_TRE_FIELD_BLOCK per block */
+    nitf_Uint32 numFields;
+    nitf_Uint32 numBlocks;
+    nitf_Uint32 *index;     /*! 1 + the slot of each name, 0 if empty */
+    nitf_Uint32 indexSize;
+    struct _nitf_TREKeyBlock *keys; /*! storage for the field names */
+    NITF_BOOL duplicates;   /*! true if a name was added more than once */
+    nitf_Arena *arena;      /*! where parsed fields go, or NULL for the heap */
 } nitf_TREPrivateData;
 
 
 NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_construct(
         nitf_Error * error);
 
+/*!
+ *  Constructs private data that is kept in arena, along with the names and
+ *  the fields that parsing adds to it.  It is destructed as usual, and
+ *  must not outlive the arena.
+ *
+ *  \param arena The arena, or NULL to construct on the heap
+ *  \param error The error to populate on failure
+ */
+NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_constructInArena(
+        nitf_Arena * arena, nitf_Error * error);
+
 NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_clone(
         nitf_TREPrivateData *source, nitf_Error * error);
 
@@ -57,6 +93,70 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_flush(nitf_TREPrivateData *priv,
 NITFPROT(NITF_BOOL) nitf_TREPrivateData_setDescriptionName(
         nitf_TREPrivateData *priv, const char* name, nitf_Error * error);
 
+/*!
+ *  Append a field to the store.  The store adopts the field.  If the name
+ *  is already present, lookups keep returning the first one, just as the
+ *  hash table did.
+ *
+ *  \param priv  The private data
+ *  \param key  The field name, which is copied
+ *  \param field  The field to adopt
+ *  \param error  The error to populate on failure
+ *  \return NITF_SUCCESS on success, NITF_FAILURE otherwise
+ */
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_insert(nitf_TREPrivateData *priv,
+                                               const char *key,
+                                               nitf_Field *field,
+                                               nitf_Error * error);
+
+/*!
+ *  Look up a field by name.
+ *
+ *  \param priv  The private data
+ *  \param key  The field name
+ *  \return The pair for the field, or NULL if it isn't there
+ */
+NITFPROT(nitf_Pair *) nitf_TREPrivateData_find(nitf_TREPrivateData *priv,
+                                              const char *key);
+
+/*!
+ *  Look up a field by name, expecting it in the given slot.  Walking a
+ *  TRECursor over a parsed TRE visits the fields in slot order, so callers
+ *  that count the fields as they go skip the index entirely.
+ *
+ *  \param priv  The private data
+ *  \param slot  The slot the field is expected to be in
+ *  \param key  The field name
+ *  \return The pair for the field, or NULL if it isn't there
+ */
+NITFPROT(nitf_Pair *) nitf_TREPrivateData_findAt(nitf_TREPrivateData *priv,
+                                                nitf_Uint32 slot,
+                                                const char *key);
+
+/*!
+ *  Get the number of fields in the store.
+ */
+NITFPROT(nitf_Uint32) nitf_TREPrivateData_getNumFields(
+        nitf_TREPrivateData *priv);
+
+/*!
+ *  Get the pair in the given slot, or NULL if the slot is out of range.
+ */
+NITFPROT(nitf_Pair *) nitf_TREPrivateData_getPair(nitf_TREPrivateData *priv,
+                                                 nitf_Uint32 slot);
+
+/*!
+ *  Get a hash table view of the fields, building it on first use.  The
+ *  view shares its pairs with the store and is kept up to date by insert.
+ *  It does not own the fields, and must not be modified directly.
+ *
+ *  \param priv  The private data
+ *  \param error  The error to populate on failure
+ *  \return The view, or NULL on failure
+ */
+NITFAPI(nitf_HashTable *) nitf_TREPrivateData_getHash(
+        nitf_TREPrivateData *priv, nitf_Error * error);
+
 
 
 NITF_CXX_ENDGUARD
@@ -70,6 +70,41 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
                                  char *bufptr,
                                  nitf_Error * error);
 
+/*!
+ *  Read every value of a field that repeats in a loop into an array of
+ *  doubles, in the order the description gives them.  The values are
+ *  read from the TRE's fields in place: nothing is allocated for each one
+ *  and no field is changed, so a TRE shared by clones is not copied.
+ *  BCS values read as nitf_Field_get would read them.  A TRE still
+ *  waiting on the lazy handler is parsed first.
+ *
+ *  \param tre The TRE
+ *  \param tag The field name without loop indexes, e.g. "RNPCF"
+ *  \param values The array to fill, which may be NULL if capacity is 0
+ *  \param capacity The number of values there is room for
+ *  \param count Set to the number of values in the TRE, which may be
+ *  more than capacity
+ *  \param error The error to populate on failure
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_TREUtils_getReal64Array(nitf_TRE * tre,
+                                                const char *tag,
+                                                double *values,
+                                                size_t capacity,
+                                                size_t *count,
+                                                nitf_Error * error);
+
+/*!
+ *  Read every value of a field that repeats in a loop into an array of
+ *  64 bit integers.  Works like nitf_TREUtils_getReal64Array.
+ */
+NITFAPI(NITF_BOOL) nitf_TREUtils_getInt64Array(nitf_TRE * tre,
+                                               const char *tag,
+                                               nitf_Int64 *values,
+                                               size_t capacity,
+                                               size_t *count,
+                                               nitf_Error * error);
+
 NITFAPI(nitf_TREHandler*)
     nitf_TREUtils_createBasicHandler(nitf_TREDescriptionSet* set,
                                      nitf_TREHandler *handler,
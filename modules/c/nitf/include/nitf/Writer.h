@@ -177,6 +177,60 @@ NITFAPI(nitf_SegmentWriter*) nitf_Writer_newDEWriter(nitf_Writer *writer,
  */
 NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer, nitf_Error * error);
 
+/*!
+ * The most uncompressed image data, in bytes, that
+ * nitf_Writer_writeSinglePass will hold in memory while it waits for the
+ * bytes in front of it.
+ */
+#ifndef NITF_SINGLE_PASS_MAX_HELD
+#define NITF_SINGLE_PASS_MAX_HELD ((nitf_Off) 64 * 1024 * 1024)
+#endif
+
+/*!
+ * Performs the write operation without ever seeking the output, so that
+ * the file can go to a pipe or a socket.  Every byte is written exactly
+ * once, in file order.
+ *
+ * The file header has to carry the length of every segment, so those are
+ * worked out before anything is written.  Subheaders, compressed or masked
+ * image data and the text, graphic and DE segments are staged in memory
+ * first; uncompressed image data has a known length and is streamed
+ * straight to the output as the image writer produces it.
+ *
+ * Image data produced ahead of file order is held until the bytes before
+ * it have gone out.  That is at most one row of blocks, except in band
+ * sequential (S) mode with several bands, where it is nearly the whole
+ * image.  An uncompressed image that could hold back more than
+ * NITF_SINGLE_PASS_MAX_HELD bytes is rejected before anything is written;
+ * use nitf_Writer_write, or a layout that holds less, for such images.
+ *
+ * \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_Writer_writeSinglePass(nitf_Writer * writer,
+                                               nitf_Error * error);
+
+/*!
+ * Rewrites the metadata of an existing file in place, without copying the
+ * segment data that is already there.  The writer must have been prepared
+ * on the file the record was read from, opened for reading and writing,
+ * and the record must still describe the same segments in the same order.
+ *
+ * Header, subheader and TRE changes are written over the old bytes.  When
+ * they change length, only the data that follows them is shifted, and the
+ * file is truncated if it got shorter.  Segments may be appended to the
+ * record; their data comes from write handlers set as usual, while
+ * handlers set for the segments already in the file are ignored.  Segments
+ * cannot be removed or reordered, and TRE_OVERFLOW segments are rebuilt
+ * from their TREs.  The patch fails, leaving the file as it was, if a
+ * segment whose data is kept no longer has the identifier it had in the
+ * file (IID1, SID, TEXTID or DESID and DESVER), or if an image's size,
+ * pixel layout, blocking or compression fields have changed.
+ *
+ * \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_Writer_patch(nitf_Writer * writer,
+                                     nitf_Error * error);
+
 // NOTE: In general the following functions are not needed.  Only use these
 //       if you know what you're doing and are trying to write out a NITF
 //       piecemeal rather than through the normal Writer object interface.
@@ -90,7 +90,7 @@ NITFPRIV(int) ENGRDA_parse(nitf_TRE * tre,
 
     privData = (nitf_TREPrivateData*)tre->priv;
 
-    /* flush the hash first, to protect from duplicate entries */
+    /* flush the fields first, to protect from duplicate entries */
     if (privData)
     {
         nitf_TREPrivateData_flush(privData, error);
@@ -110,7 +110,7 @@ NITFPRIV(int) ENGRDA_parse(nitf_TRE * tre,
             }
 
             /* no need to call setValue, because we already know
-             * it is OK for this one to be in the hash
+             * it is OK for this one to be in the fields
              */
 
             /* for engineering data, the TREDescription specifies the type as
@@ -177,9 +177,14 @@ NITFPRIV(int) ENGRDA_parse(nitf_TRE * tre,
             }
 #endif
 
-            /* add to the hash */
-            nitf_HashTable_insert(((nitf_TREPrivateData*)tre->priv)->hash,
-                    cursor.tag_str, field, error);
+            /* add to the fields */
+            if (!nitf_TREPrivateData_insert(privData, cursor.tag_str,
+                                            field, error))
+            {
+                nitf_Field_destruct(&field);
+                nitf_TRECursor_cleanup(&cursor);
+                goto CATCH_ERROR;
+            }
 
             offset += length;
         }
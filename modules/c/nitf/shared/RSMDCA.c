@@ -27,7 +27,7 @@ NITF_CXX_GUARD
 static int count(nitf_TRE* tre, char idx[10][10], int depth, nitf_Error* error)
 {
     int npart;
-    nitf_Field* field = nitf_TRE_getField(tre, "NPART");
+    nitf_Field* field = tre->handler->getField(tre, "NPART");
     nitf_Field_get(field, &npart, NITF_CONV_INT, sizeof(npart), error);
     return ( ((npart + 1) * npart) / 2 );
 
@@ -34,7 +34,7 @@ static int numopg(nitf_TRE* tre, char idx[10][10], int depth, nitf_Error* error)
 
     strcat(fname, idx[0]);
 
-    field = nitf_TRE_getField(tre, fname);
+    field = tre->handler->getField(tre, fname);
     nitf_Field_get(field, &numopg, NITF_CONV_INT, sizeof(numopg), error);
     return ( ((numopg + 1) * numopg) / 2 );
 
@@ -44,10 +44,10 @@ static int numopg(nitf_TRE* tre, char idx[10][10], int depth, nitf_Error* error)
 static int mapped(nitf_TRE* tre, char idx[10][10], int depth, nitf_Error* error)
 {
     int npar, npar0;
-    nitf_Field* field = nitf_TRE_getField(tre, "NPAR");
+    nitf_Field* field = tre->handler->getField(tre, "NPAR");
     nitf_Field_get(field, &npar, NITF_CONV_INT, sizeof(npar), error);
 
-    field = nitf_TRE_getField(tre, "NPAR0");
+    field = tre->handler->getField(tre, "NPAR0");
     nitf_Field_get(field, &npar0, NITF_CONV_INT, sizeof(npar0), error);
     return ( npar * npar0 );
 
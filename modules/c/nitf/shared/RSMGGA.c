@@ -31,12 +31,12 @@ static int nxptsXnypts(nitf_TRE* tre, char idx[10][10], int depth, nitf_Error* e
     nitf_Field* field;
     strcpy(fname, "NXPTS");
     strcat(fname, idx[0]);
-    field = nitf_TRE_getField(tre, fname);
+    field = tre->handler->getField(tre, fname);
     nitf_Field_get(field, &nxpts, NITF_CONV_INT, sizeof(nxpts), error);
 
     strcpy(fname, "NYPTS");
     strcat(fname, idx[0]);
-    field = nitf_TRE_getField(tre, fname);
+    field = tre->handler->getField(tre, fname);
     nitf_Field_get(field, &nypts, NITF_CONV_INT, sizeof(nypts), error);
 
     return nxpts * nypts;
@@ -0,0 +1,981 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "nitf/Catalog.h"
+
+#ifndef WIN32
+#   include <sys/stat.h>
+#endif
+
+/* How much of a file is read at a time while its headers are parsed */
+#define CATALOG_READ_SIZE 65536
+
+/*
+ *  One image segment's worth of the index
+ */
+typedef struct _CatalogRow
+{
+    char *file;
+    nitf_Uint32 segment;
+    nitf_Uint32 nrows;
+    nitf_Uint32 ncols;
+    nitf_Uint32 nbands;
+    nitf_Uint32 nbpp;
+    char iid1[NITF_IID1_SZ + 1];
+    char ic[NITF_IC_SZ + 1];
+    char imode[NITF_IMODE_SZ + 1];
+    char icords[NITF_ICORDS_SZ + 1];
+    char igeolo[NITF_IGEOLO_SZ + 1];
+    NITF_BOOL hasCorners;
+    double corners[4][2];
+    char **tres;                /* Raw bytes of each TRE asked for, or NULL */
+    nitf_Uint32 *treLengths;
+} CatalogRow;
+
+/*
+ *  A directory part way through being walked
+ */
+typedef struct _CatalogDir
+{
+    nitf_Directory *dir;
+    char *path;
+    NITF_BOOL started;
+} CatalogDir;
+
+typedef struct _CatalogScan
+{
+    const nitf_CatalogOptions *options;
+    int numTags;
+    nitf_IOInterface *output;
+    nitf_Mutex walkLock;        /* Guards the walk, summary and error */
+    nitf_Mutex outputLock;      /* Guards the output */
+    CatalogDir dirs[NITF_CATALOG_MAX_DEPTH + 1];
+    int depth;                  /* The innermost directory, -1 when done */
+    char *file;                 /* The root, if it is not a directory */
+    NITF_BOOL failed;
+    nitf_Error error;
+    nitf_CatalogSummary summary;
+} CatalogScan;
+
+/*
+ *  Each thread batches up rows and writes them a block at a time
+ */
+typedef struct _CatalogWorker
+{
+    CatalogScan *scan;
+    CatalogRow *rows;
+    int numRows;
+    nitf_Thread thread;
+} CatalogWorker;
+
+
+NITFPRIV(void) failScan(CatalogScan * scan, nitf_Error * error)
+{
+    nitf_Mutex_lock(&scan->walkLock);
+    if (!scan->failed)
+    {
+        scan->failed = 1;
+        memcpy(&scan->error, error, sizeof(nitf_Error));
+    }
+    nitf_Mutex_unlock(&scan->walkLock);
+}
+
+
+NITFPRIV(char *) joinPath(const char *dir, const char *name,
+                          nitf_Error * error)
+{
+    size_t dirLength = strlen(dir);
+    char *path = (char *) NITF_MALLOC(dirLength + strlen(name) + 2);
+    if (!path)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+    strcpy(path, dir);
+    if (dirLength > 0 && dir[dirLength - 1] != '/' &&
+        dir[dirLength - 1] != '\\')
+        strcat(path, "/");
+    strcat(path, name);
+    return path;
+}
+
+
+NITFPRIV(NITF_BOOL) hasSuffix(const char *name, const char **suffixes)
+{
+    size_t nameLength = strlen(name);
+
+    if (!suffixes)
+        return 1;
+
+    for (; *suffixes; ++suffixes)
+    {
+        size_t length = strlen(*suffixes);
+        size_t i;
+
+        if (length > nameLength)
+            continue;
+        for (i = 0; i < length; ++i)
+            if (tolower((unsigned char) name[nameLength - length + i]) !=
+                tolower((unsigned char) (*suffixes)[i]))
+                break;
+        if (i == length)
+            return 1;
+    }
+    return 0;
+}
+
+
+/*
+ *  Is the path a symbolic link (or on Windows, a junction)?  Such links
+ *  to directories are passed over, since one pointing back up the tree
+ *  would otherwise be walked until the depth limit.
+ */
+NITFPRIV(NITF_BOOL) isLink(const char *path)
+{
+#ifdef WIN32
+    DWORD attributes = GetFileAttributesA(path);
+    return attributes != INVALID_FILE_ATTRIBUTES &&
+        (attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+#else
+    struct stat info;
+    return lstat(path, &info) == 0 && S_ISLNK(info.st_mode);
+#endif
+}
+
+
+NITFPRIV(NITF_BOOL) pushDir(CatalogScan * scan, char *path,
+                            nitf_Error * error)
+{
+    nitf_Directory *dir = nitf_Directory_construct(error);
+    if (!dir)
+        return NITF_FAILURE;
+
+    ++scan->depth;
+    scan->dirs[scan->depth].dir = dir;
+    scan->dirs[scan->depth].path = path;
+    scan->dirs[scan->depth].started = 0;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(void) popDir(CatalogScan * scan)
+{
+    CatalogDir *top = &scan->dirs[scan->depth];
+    nitf_Directory_destruct(&top->dir);
+    NITF_FREE(top->path);
+    top->path = NULL;
+    --scan->depth;
+}
+
+
+/*
+ *  Hands out the next file to look at, or NULL once the walk is over.
+ *  The caller owns the path.
+ */
+NITFPRIV(char *) nextFile(CatalogScan * scan)
+{
+    char *next = NULL;
+    nitf_Error error;
+
+    nitf_Mutex_lock(&scan->walkLock);
+    if (scan->file)
+    {
+        next = scan->file;
+        scan->file = NULL;
+    }
+    while (!next && !scan->failed && scan->depth >= 0)
+    {
+        CatalogDir *top = &scan->dirs[scan->depth];
+        const char *name = top->started ?
+            nitf_Directory_findNextFile(top->dir) :
+            nitf_Directory_findFirstFile(top->dir, top->path);
+        char *path;
+
+        top->started = 1;
+        if (!name)
+        {
+            popDir(scan);
+            continue;
+        }
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+            continue;
+
+        path = joinPath(top->path, name, &error);
+        if (!path)
+        {
+            scan->failed = 1;
+            memcpy(&scan->error, &error, sizeof(nitf_Error));
+        }
+        else if (nitf_Directory_exists(path))
+        {
+            if (isLink(path) || scan->depth == NITF_CATALOG_MAX_DEPTH)
+                NITF_FREE(path);
+            else if (!pushDir(scan, path, &error))
+            {
+                NITF_FREE(path);
+                scan->failed = 1;
+                memcpy(&scan->error, &error, sizeof(nitf_Error));
+            }
+        }
+        else if (hasSuffix(name, scan->options->suffixes))
+            next = path;
+        else
+            NITF_FREE(path);
+    }
+    nitf_Mutex_unlock(&scan->walkLock);
+    return next;
+}
+
+
+NITFPRIV(void) freeRow(CatalogRow * row, int numTags)
+{
+    int i;
+
+    if (row->file)
+        NITF_FREE(row->file);
+    if (row->tres)
+    {
+        for (i = 0; i < numTags; ++i)
+            if (row->tres[i])
+                NITF_FREE(row->tres[i]);
+        NITF_FREE(row->tres);
+    }
+    if (row->treLengths)
+        NITF_FREE(row->treLengths);
+    memset(row, 0, sizeof(CatalogRow));
+}
+
+
+/*
+ *  Copies a string field into the row, dropping the trailing blanks
+ */
+NITFPRIV(void) copyString(char *dest, size_t size, nitf_Field * field)
+{
+    size_t length = field->length < size - 1 ? field->length : size - 1;
+
+    memcpy(dest, field->raw, length);
+    while (length > 0 && dest[length - 1] == ' ')
+        --length;
+    dest[length] = '\0';
+}
+
+
+NITFPRIV(NITF_BOOL) getUint(nitf_Field * field, nitf_Uint32 * value,
+                            nitf_Error * error)
+{
+    return nitf_Field_get(field, value, NITF_CONV_UINT, sizeof(nitf_Uint32),
+                          error);
+}
+
+
+/*
+ *  Gets the raw bytes of the first TRE called tag in the subheader, or
+ *  leaves *data NULL if there is none
+ */
+NITFPRIV(NITF_BOOL) getTRE(nitf_ImageSubheader * subheader,
+                           nitf_Record * record, const char *tag,
+                           char **data, nitf_Uint32 * length,
+                           nitf_Error * error)
+{
+    nitf_List *found;
+    nitf_TRE *tre;
+    nitf_IOInterface *io;
+    size_t size;
+
+    *data = NULL;
+    *length = 0;
+
+    found = nitf_Extensions_getTREsByName(subheader->extendedSection, tag);
+    if (!found || nitf_List_isEmpty(found))
+        found = nitf_Extensions_getTREsByName(subheader->userDefinedSection,
+                                              tag);
+    if (!found || nitf_List_isEmpty(found))
+        return NITF_SUCCESS;
+
+    tre = (nitf_TRE *) nitf_List_get(found, 0, error);
+    if (!tre)
+        return NITF_FAILURE;
+
+    io = nitf_GrowableBufferAdapter_construct(0, error);
+    if (!io)
+        return NITF_FAILURE;
+    if (!tre->handler->write(io, tre, record, error))
+    {
+        nitf_IOInterface_destruct(&io);
+        return NITF_FAILURE;
+    }
+    *data = nitf_GrowableBufferAdapter_release(io, &size, error);
+    nitf_IOInterface_destruct(&io);
+    if (!*data)
+        return NITF_FAILURE;
+    *length = (nitf_Uint32) size;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) fillRow(CatalogRow * row, CatalogScan * scan,
+                            const char *path, nitf_Uint32 segment,
+                            nitf_ImageSubheader * subheader,
+                            nitf_Record * record, nitf_Error * error)
+{
+    nitf_CornersType cornersType;
+    nitf_Error cornersError;
+    int i;
+
+    memset(row, 0, sizeof(CatalogRow));
+    row->segment = segment;
+    copyString(row->iid1, sizeof(row->iid1), subheader->NITF_IID1);
+    copyString(row->ic, sizeof(row->ic), subheader->NITF_IC);
+    copyString(row->imode, sizeof(row->imode), subheader->NITF_IMODE);
+    copyString(row->icords, sizeof(row->icords), subheader->NITF_ICORDS);
+    copyString(row->igeolo, sizeof(row->igeolo), subheader->NITF_IGEOLO);
+
+    if (!getUint(subheader->NITF_NROWS, &row->nrows, error) ||
+        !getUint(subheader->NITF_NCOLS, &row->ncols, error) ||
+        !getUint(subheader->NITF_NBPP, &row->nbpp, error))
+        return NITF_FAILURE;
+
+    row->nbands = nitf_ImageSubheader_getBandCount(subheader, error);
+    if (row->nbands == NITF_INVALID_BAND_COUNT)
+        return NITF_FAILURE;
+
+    /* corners that do not parse are left unknown, not treated as fatal */
+    cornersType = nitf_ImageSubheader_getCornersType(subheader);
+    if (cornersType == NITF_CORNERS_GEO || cornersType == NITF_CORNERS_DECIMAL)
+        row->hasCorners =
+            nitf_ImageSubheader_getCornersAsLatLons(subheader, row->corners,
+                                                    &cornersError);
+
+    row->file = (char *) NITF_MALLOC(strlen(path) + 1);
+    if (!row->file)
+        goto CATCH_MEMORY;
+    strcpy(row->file, path);
+
+    if (scan->numTags > 0)
+    {
+        row->tres = (char **) NITF_MALLOC(sizeof(char *) * scan->numTags);
+        row->treLengths = (nitf_Uint32 *)
+            NITF_MALLOC(sizeof(nitf_Uint32) * scan->numTags);
+        if (!row->tres || !row->treLengths)
+            goto CATCH_MEMORY;
+        memset(row->tres, 0, sizeof(char *) * scan->numTags);
+
+        for (i = 0; i < scan->numTags; ++i)
+            if (!getTRE(subheader, record, scan->options->treTags[i],
+                        &row->tres[i], &row->treLengths[i], error))
+                return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+
+CATCH_MEMORY:
+    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                    NITF_ERR_MEMORY);
+    return NITF_FAILURE;
+}
+
+
+/* ------------------------------------------------------------------ */
+/*                          JSON LINES                                */
+/* ------------------------------------------------------------------ */
+
+NITFPRIV(NITF_BOOL) writeText(nitf_IOInterface * io, const char *text,
+                              nitf_Error * error)
+{
+    return nitf_IOInterface_write(io, text, strlen(text), error);
+}
+
+
+/*
+ *  Writes bytes as a JSON string.  Anything outside printable ASCII is
+ *  escaped, so binary TREs come through as one character per byte.
+ */
+NITFPRIV(NITF_BOOL) writeJSONString(nitf_IOInterface * io, const char *data,
+                                    size_t length, nitf_Error * error)
+{
+    char escaped[8];
+    size_t start = 0;
+    size_t i;
+
+    if (!writeText(io, "\"", error))
+        return NITF_FAILURE;
+
+    for (i = 0; i < length; ++i)
+    {
+        unsigned char c = (unsigned char) data[i];
+        if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\')
+            continue;
+
+        if (c == '"' || c == '\\')
+            sprintf(escaped, "\\%c", c);
+        else
+            sprintf(escaped, "\\u%04x", c);
+        if (!nitf_IOInterface_write(io, data + start, i - start, error) ||
+            !writeText(io, escaped, error))
+            return NITF_FAILURE;
+        start = i + 1;
+    }
+    return nitf_IOInterface_write(io, data + start, length - start, error) &&
+        writeText(io, "\"", error);
+}
+
+
+NITFPRIV(NITF_BOOL) writeJSONRow(CatalogScan * scan, CatalogRow * row,
+                                 nitf_IOInterface * io, nitf_Error * error)
+{
+    char number[64];
+    int i;
+
+#define CATALOG_JSON_STRING(NAME, VALUE) \
+    if (!writeText(io, NAME, error) || \
+        !writeJSONString(io, VALUE, strlen(VALUE), error)) \
+        return NITF_FAILURE
+
+#define CATALOG_JSON_UINT(NAME, VALUE) \
+    sprintf(number, "%lu", (unsigned long) (VALUE)); \
+    if (!writeText(io, NAME, error) || !writeText(io, number, error)) \
+        return NITF_FAILURE
+
+    CATALOG_JSON_STRING("{\"file\":", row->file);
+    CATALOG_JSON_UINT(",\"segment\":", row->segment);
+    CATALOG_JSON_STRING(",\"iid1\":", row->iid1);
+    CATALOG_JSON_UINT(",\"nrows\":", row->nrows);
+    CATALOG_JSON_UINT(",\"ncols\":", row->ncols);
+    CATALOG_JSON_UINT(",\"nbands\":", row->nbands);
+    CATALOG_JSON_STRING(",\"ic\":", row->ic);
+    CATALOG_JSON_STRING(",\"imode\":", row->imode);
+    CATALOG_JSON_UINT(",\"nbpp\":", row->nbpp);
+    CATALOG_JSON_STRING(",\"icords\":", row->icords);
+    CATALOG_JSON_STRING(",\"igeolo\":", row->igeolo);
+
+#undef CATALOG_JSON_STRING
+#undef CATALOG_JSON_UINT
+
+    if (!writeText(io, ",\"corners\":", error))
+        return NITF_FAILURE;
+    if (!row->hasCorners)
+    {
+        if (!writeText(io, "null", error))
+            return NITF_FAILURE;
+    }
+    else
+    {
+        for (i = 0; i < 4; ++i)
+        {
+            sprintf(number, "%s[%.10g,%.10g]", i == 0 ? "[" : ",",
+                    row->corners[i][0], row->corners[i][1]);
+            if (!writeText(io, number, error))
+                return NITF_FAILURE;
+        }
+        if (!writeText(io, "]", error))
+            return NITF_FAILURE;
+    }
+
+    if (!writeText(io, ",\"tres\":{", error))
+        return NITF_FAILURE;
+    for (i = 0; i < scan->numTags; ++i)
+    {
+        const char *tag = scan->options->treTags[i];
+        if ((i > 0 && !writeText(io, ",", error)) ||
+            !writeJSONString(io, tag, strlen(tag), error) ||
+            !writeText(io, ":", error))
+            return NITF_FAILURE;
+        if (!(row->tres[i] ?
+              writeJSONString(io, row->tres[i], row->treLengths[i], error) :
+              writeText(io, "null", error)))
+            return NITF_FAILURE;
+    }
+    return writeText(io, "}}\n", error);
+}
+
+
+/* ------------------------------------------------------------------ */
+/*                            BINARY                                  */
+/* ------------------------------------------------------------------ */
+
+NITFPRIV(NITF_BOOL) writeUint32(nitf_IOInterface * io, nitf_Uint32 value,
+                                nitf_Error * error)
+{
+    value = NITF_HTONL(value);
+    return nitf_IOInterface_write(io, &value, sizeof(value), error);
+}
+
+
+NITFPRIV(NITF_BOOL) writeDouble(nitf_IOInterface * io, NITF_BOOL known,
+                                double value, nitf_Error * error)
+{
+    nitf_Uint64 bits;
+
+    if (known)
+        memcpy(&bits, &value, sizeof(bits));
+    else
+        bits = ((nitf_Uint64) 0x7ff80000 << 32);    /* a quiet NaN */
+    bits = NITF_HTONLL(bits);
+    return nitf_IOInterface_write(io, &bits, sizeof(bits), error);
+}
+
+
+/*
+ *  The string columns of a row, in file order
+ */
+NITFPRIV(const char *) stringColumn(CatalogRow * row, int column,
+                                    nitf_Uint32 * length)
+{
+    const char *value = NULL;
+    switch (column)
+    {
+    case 0:
+        value = row->file;
+        break;
+    case 1:
+        value = row->iid1;
+        break;
+    case 2:
+        value = row->ic;
+        break;
+    case 3:
+        value = row->imode;
+        break;
+    case 4:
+        value = row->icords;
+        break;
+    default:
+        value = row->igeolo;
+        break;
+    }
+    *length = (nitf_Uint32) strlen(value);
+    return value;
+}
+
+
+NITFPRIV(NITF_BOOL) writeStringColumn(CatalogRow * rows, int numRows,
+                                      int column, int tre,
+                                      nitf_IOInterface * io,
+                                      nitf_Error * error)
+{
+    nitf_Uint32 length;
+    int i;
+
+    for (i = 0; i < numRows; ++i)
+    {
+        if (tre < 0)
+            stringColumn(&rows[i], column, &length);
+        else
+            length = rows[i].tres[tre] ? rows[i].treLengths[tre] : 0;
+        if (!writeUint32(io, length, error))
+            return NITF_FAILURE;
+    }
+    for (i = 0; i < numRows; ++i)
+    {
+        const char *value;
+        if (tre < 0)
+            value = stringColumn(&rows[i], column, &length);
+        else
+        {
+            value = rows[i].tres[tre];
+            length = value ? rows[i].treLengths[tre] : 0;
+        }
+        if (length > 0 && !nitf_IOInterface_write(io, value, length, error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+
+/*
+ *  Columns go file, segment, iid1, nrows, ncols, nbands, ic, imode,
+ *  nbpp, icords, igeolo, corners and TREs, as Catalog.h lays out
+ */
+NITFPRIV(NITF_BOOL) writeBlock(CatalogScan * scan, CatalogRow * rows,
+                               int numRows, nitf_IOInterface * io,
+                               nitf_Error * error)
+{
+    int i;
+    int j;
+
+#define CATALOG_UINT_COLUMN(FIELD) \
+    for (i = 0; i < numRows; ++i) \
+        if (!writeUint32(io, rows[i].FIELD, error)) \
+            return NITF_FAILURE
+
+    if (!writeUint32(io, (nitf_Uint32) numRows, error) ||
+        !writeStringColumn(rows, numRows, 0, -1, io, error))
+        return NITF_FAILURE;
+    CATALOG_UINT_COLUMN(segment);
+    if (!writeStringColumn(rows, numRows, 1, -1, io, error))
+        return NITF_FAILURE;
+    CATALOG_UINT_COLUMN(nrows);
+    CATALOG_UINT_COLUMN(ncols);
+    CATALOG_UINT_COLUMN(nbands);
+    if (!writeStringColumn(rows, numRows, 2, -1, io, error) ||
+        !writeStringColumn(rows, numRows, 3, -1, io, error))
+        return NITF_FAILURE;
+    CATALOG_UINT_COLUMN(nbpp);
+    if (!writeStringColumn(rows, numRows, 4, -1, io, error) ||
+        !writeStringColumn(rows, numRows, 5, -1, io, error))
+        return NITF_FAILURE;
+
+#undef CATALOG_UINT_COLUMN
+
+    for (j = 0; j < 8; ++j)
+        for (i = 0; i < numRows; ++i)
+            if (!writeDouble(io, rows[i].hasCorners,
+                             rows[i].corners[j / 2][j % 2], error))
+                return NITF_FAILURE;
+
+    for (j = 0; j < scan->numTags; ++j)
+        if (!writeStringColumn(rows, numRows, 0, j, io, error))
+            return NITF_FAILURE;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) writeHeader(CatalogScan * scan, nitf_Error * error)
+{
+    int i;
+
+    if (scan->options->format != NITF_CATALOG_BINARY)
+        return NITF_SUCCESS;
+
+    if (!nitf_IOInterface_write(scan->output, "NITFCAT1", 8, error) ||
+        !writeUint32(scan->output, (nitf_Uint32) scan->numTags, error))
+        return NITF_FAILURE;
+    for (i = 0; i < scan->numTags; ++i)
+    {
+        const char *tag = scan->options->treTags[i];
+        if (!writeUint32(scan->output, (nitf_Uint32) strlen(tag), error) ||
+            !nitf_IOInterface_write(scan->output, tag, strlen(tag), error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+
+/*
+ *  Formats the rows a worker has gathered and writes them out in one go
+ */
+NITFPRIV(NITF_BOOL) flushRows(CatalogWorker * worker, nitf_Error * error)
+{
+    CatalogScan *scan = worker->scan;
+    nitf_IOInterface *io;
+    NITF_BOOL ok = NITF_SUCCESS;
+    char *data;
+    size_t size;
+    int i;
+
+    if (worker->numRows == 0)
+        return NITF_SUCCESS;
+
+    io = nitf_GrowableBufferAdapter_construct(0, error);
+    if (!io)
+        return NITF_FAILURE;
+
+    if (scan->options->format == NITF_CATALOG_BINARY)
+        ok = writeBlock(scan, worker->rows, worker->numRows, io, error);
+    else
+        for (i = 0; ok && i < worker->numRows; ++i)
+            ok = writeJSONRow(scan, &worker->rows[i], io, error);
+
+    for (i = 0; i < worker->numRows; ++i)
+        freeRow(&worker->rows[i], scan->numTags);
+    worker->numRows = 0;
+
+    if (ok)
+    {
+        data = nitf_GrowableBufferAdapter_getBuffer(io, &size, error);
+        nitf_Mutex_lock(&scan->outputLock);
+        ok = data && nitf_IOInterface_write(scan->output, data, size, error);
+        nitf_Mutex_unlock(&scan->outputLock);
+    }
+    nitf_IOInterface_destruct(&io);
+    return ok;
+}
+
+
+NITFPRIV(void) closeInput(nitf_IOInterface ** io)
+{
+    nitf_Error error;
+    nitf_IOInterface_close(*io, &error);
+    nitf_IOInterface_destruct(io);
+}
+
+
+/*
+ *  Adds a row for each image segment of a file, if it is a NITF
+ */
+NITFPRIV(void) catalogFile(CatalogWorker * worker, const char *path)
+{
+    CatalogScan *scan = worker->scan;
+    nitf_Error error;
+    nitf_IOInterface *file;
+    nitf_IOInterface *io = NULL;
+    nitf_Reader *reader = NULL;
+    nitf_Record *record = NULL;
+    nitf_ParseOptions parse;
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    char magic[4];
+    int firstRow = worker->numRows;
+    nitf_Uint32 numImages = 0;
+
+    file = nitf_IOHandleAdapter_open(path, NITF_ACCESS_READONLY,
+                                     NITF_OPEN_EXISTING, &error);
+    if (!file)
+        goto CATCH_ERROR;
+    io = nitf_BufferedAdapter_construct(file, CATALOG_READ_SIZE, 1, &error);
+    if (!io)
+    {
+        closeInput(&file);
+        goto CATCH_ERROR;
+    }
+
+    /* anything that does not start like a NITF is none of our business */
+    if (!nitf_IOInterface_read(io, magic, sizeof(magic), &error) ||
+        (memcmp(magic, "NITF", 4) != 0 && memcmp(magic, "NSIF", 4) != 0))
+    {
+        closeInput(&io);
+        return;
+    }
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                               &error)))
+        goto CATCH_ERROR;
+
+    reader = nitf_Reader_construct(&error);
+    if (!reader)
+        goto CATCH_ERROR;
+    nitf_ParseOptions_init(&parse);
+    parse.segments = NITF_PARSE_IMAGES;
+    parse.treFilter = NITF_PARSE_TRES_ALLOW;
+    parse.treTags = scan->options->treTags;
+    parse.skipDEUserHeaders = 1;
+    nitf_Reader_setParseOptions(reader, &parse);
+    nitf_Reader_setLazyTREs(reader, 1);
+
+    record = nitf_Reader_readIO(reader, io, &error);
+    if (!record)
+        goto CATCH_ERROR;
+
+    /* a file never has more than 999 images, so it fits in one block */
+    if (worker->numRows + (int) nitf_List_size(record->images) >
+        NITF_CATALOG_BLOCK_ROWS)
+    {
+        if (!flushRows(worker, &error))
+        {
+            failScan(scan, &error);
+            goto CLEANUP;
+        }
+        firstRow = 0;
+    }
+
+    iter = nitf_List_begin(record->images);
+    end = nitf_List_end(record->images);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+        if (!fillRow(&worker->rows[worker->numRows], scan, path, numImages,
+                     segment->subheader, record, &error))
+        {
+            freeRow(&worker->rows[worker->numRows], scan->numTags);
+            goto CATCH_ERROR;
+        }
+        ++worker->numRows;
+        ++numImages;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    nitf_Mutex_lock(&scan->walkLock);
+    scan->summary.files++;
+    scan->summary.images += numImages;
+    nitf_Mutex_unlock(&scan->walkLock);
+    goto CLEANUP;
+
+CATCH_ERROR:
+    /* nothing from a file that could not be read makes it into the index */
+    while (worker->numRows > firstRow)
+        freeRow(&worker->rows[--worker->numRows], scan->numTags);
+
+    nitf_Mutex_lock(&scan->walkLock);
+    scan->summary.failures++;
+    if (scan->options->onError)
+        scan->options->onError(scan->options->user, path, &error);
+    nitf_Mutex_unlock(&scan->walkLock);
+
+CLEANUP:
+    if (record)
+        nitf_Record_destruct(&record);
+    if (reader)
+        nitf_Reader_destruct(&reader);
+    if (io)
+        closeInput(&io);
+}
+
+
+NITFPRIV(void) runWorker(NITF_DATA * data)
+{
+    CatalogWorker *worker = (CatalogWorker *) data;
+    nitf_Error error;
+    char *path;
+
+    while ((path = nextFile(worker->scan)) != NULL)
+    {
+        catalogFile(worker, path);
+        NITF_FREE(path);
+    }
+    if (!flushRows(worker, &error))
+        failScan(worker->scan, &error);
+}
+
+
+NITFAPI(void) nitf_CatalogOptions_init(nitf_CatalogOptions * options)
+{
+    memset(options, 0, sizeof(nitf_CatalogOptions));
+    options->format = NITF_CATALOG_JSON;
+    options->numThreads = 4;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_Catalog_scan(const char *root,
+                                     const nitf_CatalogOptions * options,
+                                     nitf_IOInterface * output,
+                                     nitf_CatalogSummary * summary,
+                                     nitf_Error * error)
+{
+    nitf_CatalogOptions defaults;
+    CatalogScan *scan;
+    CatalogWorker *workers = NULL;
+    char *path;
+    int numThreads;
+    int started = 0;
+    int i;
+    NITF_BOOL ok = NITF_FAILURE;
+
+    if (!options)
+    {
+        nitf_CatalogOptions_init(&defaults);
+        options = &defaults;
+    }
+    numThreads = options->numThreads > 1 ? options->numThreads : 1;
+
+    /* the registry has to be loaded before the threads go looking in it */
+    if (!nitf_PluginRegistry_getInstance(error))
+        return NITF_FAILURE;
+
+    scan = (CatalogScan *) NITF_MALLOC(sizeof(CatalogScan));
+    if (!scan)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memset(scan, 0, sizeof(CatalogScan));
+    scan->options = options;
+    scan->output = output;
+    scan->depth = -1;
+    nitf_Mutex_init(&scan->walkLock);
+    nitf_Mutex_init(&scan->outputLock);
+    for (; options->treTags && options->treTags[scan->numTags];
+         ++scan->numTags);
+
+    path = (char *) NITF_MALLOC(strlen(root) + 1);
+    if (!path)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        goto CLEANUP;
+    }
+    strcpy(path, root);
+    if (!nitf_Directory_exists(root))
+        scan->file = path;
+    else if (!pushDir(scan, path, error))
+    {
+        NITF_FREE(path);
+        goto CLEANUP;
+    }
+
+    workers = (CatalogWorker *) NITF_MALLOC(sizeof(CatalogWorker) *
+                                            numThreads);
+    if (!workers)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        goto CLEANUP;
+    }
+    memset(workers, 0, sizeof(CatalogWorker) * numThreads);
+    for (i = 0; i < numThreads; ++i)
+    {
+        workers[i].scan = scan;
+        workers[i].rows = (CatalogRow *)
+            NITF_MALLOC(sizeof(CatalogRow) * NITF_CATALOG_BLOCK_ROWS);
+        if (!workers[i].rows)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            goto CLEANUP;
+        }
+    }
+
+    if (!writeHeader(scan, error))
+        goto CLEANUP;
+
+    /* a thread that will not start just leaves more for the others */
+    if (numThreads > 1)
+        for (i = 0; i < numThreads; ++i)
+            if (nitf_Thread_start(&workers[started].thread, runWorker,
+                                  &workers[started], error))
+                ++started;
+    if (started == 0)
+        runWorker(&workers[0]);
+    for (i = 0; i < started; ++i)
+        nitf_Thread_join(&workers[i].thread);
+
+    if (scan->failed)
+    {
+        memcpy(error, &scan->error, sizeof(nitf_Error));
+        goto CLEANUP;
+    }
+    if (scan->options->format == NITF_CATALOG_BINARY &&
+        !writeUint32(output, 0, error))
+        goto CLEANUP;
+
+    if (summary)
+        memcpy(summary, &scan->summary, sizeof(nitf_CatalogSummary));
+    ok = NITF_SUCCESS;
+
+CLEANUP:
+    while (scan->depth >= 0)
+        popDir(scan);
+    if (scan->file)
+        NITF_FREE(scan->file);
+    if (workers)
+    {
+        for (i = 0; i < numThreads; ++i)
+            if (workers[i].rows)
+                NITF_FREE(workers[i].rows);
+        NITF_FREE(workers);
+    }
+    nitf_Mutex_delete(&scan->walkLock);
+    nitf_Mutex_delete(&scan->outputLock);
+    NITF_FREE(scan);
+    return ok;
+}
@@ -22,6 +22,7 @@
 
 #include "nitf/DefaultTRE.h"
 #include "nitf/TREPrivateData.h"
+#include "nitf/Record.h"
 
 #define _NITF_DEFAULT_TRE_LABEL "Unknown raw data"
 
@@ -114,7 +115,9 @@ NITFPRIV(NITF_BOOL) defaultRead(nitf_IOInterface *io,
     descr[1].label = NULL;
     descr[1].tag = NULL;
 
-    tre->priv = nitf_TREPrivateData_construct(error);
+    /* what is read for a record goes into the record's arena, if any */
+    tre->priv = nitf_TREPrivateData_constructInArena(
+            record ? record->arena : NULL, error);
     if (!tre->priv)
         goto CATCH_ERROR;
 
@@ -126,7 +129,9 @@ NITFPRIV(NITF_BOOL) defaultRead(nitf_IOInterface *io,
     if (!success)
         goto CATCH_ERROR;
 
-    field = nitf_Field_construct(length, NITF_BINARY, error);
+    field = nitf_Field_constructInArena(
+            ((nitf_TREPrivateData*)tre->priv)->arena, length, NITF_BINARY,
+            error);
     if (field == NULL)
     {
         goto CATCH_ERROR;
@@ -137,8 +142,12 @@ NITFPRIV(NITF_BOOL) defaultRead(nitf_IOInterface *io,
     {
         goto CATCH_ERROR;
     }
-    nitf_HashTable_insert(((nitf_TREPrivateData*)tre->priv)->hash,
-            NITF_TRE_RAW, field, error);
+    if (!nitf_TREPrivateData_insert((nitf_TREPrivateData*)tre->priv,
+                                    NITF_TRE_RAW, field, error))
+    {
+        nitf_Field_destruct(&field);
+        goto CATCH_ERROR;
+    }
 
     NITF_FREE(data);
 
@@ -169,8 +178,8 @@ NITFPRIV(NITF_BOOL) defaultWrite(nitf_IOInterface* io,
 				 nitf_Error* error)
 {
     nitf_Field* field;
-    nitf_Pair* pair = nitf_HashTable_find(
-            ((nitf_TREPrivateData*)tre->priv)->hash, NITF_TRE_RAW);
+    nitf_Pair* pair = nitf_TREPrivateData_find(
+            (nitf_TREPrivateData*)tre->priv, NITF_TRE_RAW);
     if (pair == NULL)
     {
         nitf_Error_init(error, "No raw_data in default!", NITF_CTXT, NITF_ERR_INVALID_OBJECT);
@@ -187,8 +196,8 @@ NITFPRIV(nitf_Pair*) defaultIncrement(nitf_TREEnumerator* it, nitf_Error* error)
 {
     if (it && it->data)
     {
-        nitf_Pair* data = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)it->data)->hash, NITF_TRE_RAW);
+        nitf_Pair* data = nitf_TREPrivateData_find(
+                (nitf_TREPrivateData*)it->data, NITF_TRE_RAW);
         if (data)
         {
             it->data = NULL; /* set to NULL, since we only have one value */
@@ -244,8 +253,8 @@ NITFPRIV(nitf_TREEnumerator*) defaultBegin(nitf_TRE* tre, nitf_Error* error)
 	it->getFieldDescription = defaultGetFieldDescription;
 	it->data = tre->priv;
 
-	if (!it->data || !nitf_HashTable_find(
-	        ((nitf_TREPrivateData*)it->data)->hash, NITF_TRE_RAW))
+	if (!it->data || !nitf_TREPrivateData_find(
+	        (nitf_TREPrivateData*)it->data, NITF_TRE_RAW))
 	{
 		nitf_Error_init(error, "No raw_data in default!", NITF_CTXT, NITF_ERR_INVALID_OBJECT);
 		return NITF_FAILURE;
@@ -259,25 +268,22 @@ NITFPRIV(nitf_List*) defaultFind(nitf_TRE* tre,
 				 nitf_Error* error)
 {
     nitf_List* list;
-
-    nitf_HashTableIterator it = nitf_HashTable_begin(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
-    nitf_HashTableIterator end = nitf_HashTable_end(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
+    nitf_TREPrivateData* priv = (nitf_TREPrivateData*)tre->priv;
+    nitf_Uint32 numFields = nitf_TREPrivateData_getNumFields(priv);
+    nitf_Uint32 slot;
 
     list = nitf_List_construct(error);
     if (!list) return NULL;
 
-    while (nitf_HashTableIterator_notEqualTo(&it, &end))
+    for (slot = 0; slot < numFields; ++slot)
     {
-        nitf_Pair* pair = nitf_HashTableIterator_get(&it);
+        nitf_Pair* pair = nitf_TREPrivateData_getPair(priv, slot);
 
     	if (strstr(pair->key, pattern))
     	{
     	    /* Should check this, I suppose */
     	    nitf_List_pushBack(list, pair, error);
     	}
-    	nitf_HashTableIterator_increment(&it);
     }
 
     return list;
@@ -289,6 +295,7 @@ NITFPRIV(NITF_BOOL) defaultSetField(nitf_TRE * tre,
                                     size_t dataLength, nitf_Error * error)
 {
 	nitf_Field* field = NULL;
+	nitf_Pair* pair = NULL;
 
 	if (strcmp(tag, NITF_TRE_RAW))
 	{
@@ -304,11 +311,10 @@ NITFPRIV(NITF_BOOL) defaultSetField(nitf_TRE * tre,
     if (!nitf_Field_setRawData(field, (NITF_DATA *) data, dataLength, error))
         return NITF_FAILURE;
 
-	if (nitf_HashTable_exists(((nitf_TREPrivateData*)tre->priv)->hash, tag))
+	pair = nitf_TREPrivateData_find((nitf_TREPrivateData*)tre->priv, tag);
+	if (pair)
 	{
         nitf_Field* oldValue;
-        nitf_Pair* pair = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)tre->priv)->hash, tag);
         oldValue = (nitf_Field*)pair->data;
         nitf_Field_destruct(&oldValue);
         pair->data = field;
@@ -319,14 +325,19 @@ NITFPRIV(NITF_BOOL) defaultSetField(nitf_TRE * tre,
 	((nitf_TREPrivateData*)tre->priv)->length = dataLength;
 	((nitf_TREPrivateData*)tre->priv)->description[0].data_count = dataLength;
 
-	return nitf_HashTable_insert(((nitf_TREPrivateData*)tre->priv)->hash,
-	        tag, field, error);
+	if (!nitf_TREPrivateData_insert((nitf_TREPrivateData*)tre->priv,
+	                                tag, field, error))
+	{
+	    nitf_Field_destruct(&field);
+	    return NITF_FAILURE;
+	}
+	return NITF_SUCCESS;
 }
 
 NITFPRIV(nitf_Field*) defaultGetField(nitf_TRE* tre, const char* tag)
 {
-    nitf_Pair* pair = nitf_HashTable_find(
-            ((nitf_TREPrivateData*)tre->priv)->hash, tag);
+    nitf_Pair* pair = nitf_TREPrivateData_find(
+            (nitf_TREPrivateData*)tre->priv, tag);
     if (!pair) return NULL;
     return (nitf_Field*)pair->data;
 }
@@ -351,7 +362,7 @@ NITFPRIV(NITF_BOOL) defaultClone(nitf_TRE *source,
 
     sourcePriv = (nitf_TREPrivateData*)source->priv;
 
-    /* this clones the hash */
+    /* this clones the fields */
     if (!(trePriv = nitf_TREPrivateData_clone(sourcePriv, error)))
         return NITF_FAILURE;
 
@@ -28,6 +28,9 @@ NITFPRIV(int) eraseIt(nitf_HashTable * ht,
 
 NITFPRIV(NITF_BOOL) insertToHash( nitf_HashTable* hash, const char* name,
                                   nitf_TRE* tre, nitf_Error* error);
+NITFPRIV(NITF_BOOL) insertToHashAt(nitf_HashTable* hash, const char* name,
+                                   nitf_TRE* tre, nitf_Uint32 index,
+                                   nitf_Error* error);
 
 NITFAPI(nitf_Extensions *) nitf_Extensions_construct(nitf_Error * error)
 {
@@ -301,11 +304,24 @@ NITFAPI(NITF_BOOL) nitf_Extensions_insert(nitf_Extensions* ext,
         nitf_TRE* tre,
         nitf_Error* error)
 {
+    nitf_ListIterator it = nitf_List_begin(ext->ref);
+    nitf_Uint32 before = 0;
+
+    /* Count the TREs with the same tag ahead of it, so that the hash */
+    /* lists them in the same order as the list does                 */
+    while (it.current && it.current != extIt->iter.current)
+    {
+        nitf_TRE* other = (nitf_TRE*)nitf_ListIterator_get(&it);
+        if (strcmp(other->tag, tre->tag) == 0)
+            before++;
+        nitf_ListIterator_increment(&it);
+    }
+
     /* The easy part, put in list */
     if (!nitf_List_insert(ext->ref, extIt->iter, tre, error))
         return NITF_FAILURE;
     /* Now insert to hash */
-    return insertToHash( ext->hash, tre->tag, tre, error);
+    return insertToHashAt(ext->hash, tre->tag, tre, before, error);
 }
 
 NITFAPI(nitf_TRE *) nitf_Extensions_remove(nitf_Extensions* ext,
@@ -449,6 +465,24 @@ NITFPRIV(NITF_BOOL) insertToHash( nitf_HashTable* hash, const char* name,
 
 }
 
+NITFPRIV(NITF_BOOL) insertToHashAt(nitf_HashTable* hash, const char* name,
+                                   nitf_TRE* tre, nitf_Uint32 index,
+                                   nitf_Error* error)
+{
+    nitf_List* tres;
+    nitf_Uint32 size;
+
+    if (!insertToHash(hash, name, tre, error))
+        return NITF_FAILURE;
+
+    /* It went on the back, so move it up if that is not its place */
+    tres = (nitf_List*)nitf_HashTable_find(hash, name)->data;
+    size = nitf_List_size(tres);
+    if (index + 1 >= size)
+        return NITF_SUCCESS;
+    return nitf_List_move(tres, size - 1, index, error);
+}
+
 NITFPRIV(int) eraseIt(nitf_HashTable * ht,
                       nitf_Pair * pair, NITF_DATA* userData, nitf_Error * error)
 {
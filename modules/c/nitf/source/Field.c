@@ -20,6 +20,8 @@
  *
  */
 
+#include <float.h>
+
 #include "nitf/Field.h"
 
 /*  Spaces are added to the right  */
@@ -52,6 +54,287 @@ NITF_BOOL copyAndFillZeros(nitf_Field * field,
     return NITF_SUCCESS;
 }
 
+/*  Room for any 64 bit integer, with its sign  */
+#define NITF_DECIMAL_BUF_SZ 21
+
+/*
+ *  Writes a number in decimal to a buffer of NITF_DECIMAL_BUF_SZ bytes,
+ *  without a null byte, and returns how many bytes were written.
+ */
+NITFPRIV(size_t) formatDecimal(char *buffer, NITF_BOOL negative,
+                               nitf_Uint64 magnitude)
+{
+    char digits[NITF_DECIMAL_BUF_SZ];
+    size_t numDigits = 0;
+    size_t length = 0;
+
+    do
+    {
+        digits[numDigits++] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    while (magnitude);
+
+    if (negative)
+        buffer[length++] = '-';
+    while (numDigits)
+        buffer[length++] = digits[--numDigits];
+    return length;
+}
+
+/*
+ *  Eight digits are checked and converted as one 64 bit word.  The word is
+ *  loaded with its first byte lowest, so this needs a little endian host.
+ */
+#if defined(__LITTLE_ENDIAN__) || !defined(WORDS_BIGENDIAN)
+#define NITF_FIELD_EIGHT_DIGITS 1
+#endif
+
+/*
+ *  If the eight bytes at str are all digits, sets value to the number they
+ *  spell and returns true.
+ */
+NITFPRIV(NITF_BOOL) eightDigits(const char *str, nitf_Uint32 *value)
+{
+#ifdef NITF_FIELD_EIGHT_DIGITS
+    const nitf_Uint64 ones = ((nitf_Uint64) 0x01010101 << 32) | 0x01010101;
+    const nitf_Uint64 high = ones * 0xF0;
+    const nitf_Uint64 low = ((nitf_Uint64) 0xFF << 32) | 0xFF;
+    nitf_Uint64 word;
+
+    memcpy(&word, str, 8);
+
+    /*  A byte is a digit if it is 0x3_, and still is with 6 added  */
+    if ((word & high) != ones * 0x30 ||
+        ((word + ones * 0x06) & high) != ones * 0x30)
+        return 0;
+
+    /*  Combine neighbouring digits, then pairs, then the two halves  */
+    word -= ones * 0x30;
+    word = word * 10 + (word >> 8);
+    word = ((word & low) * (100 + ((nitf_Uint64) 1000000 << 32)) +
+            ((word >> 16) & low) * (1 + ((nitf_Uint64) 10000 << 32))) >> 32;
+    *value = (nitf_Uint32) word;
+    return 1;
+#else
+    (void) str;
+    (void) value;
+    return 0;
+#endif
+}
+
+/*
+ *  Reads a number in decimal the way strtol does: after any white space and
+ *  a sign, up to the first character that isn't a digit.  A magnitude that
+ *  doesn't fit is held at the largest one there is.
+ */
+NITFPRIV(void) parseDecimal(const char *str, size_t length,
+                            NITF_BOOL *negative, nitf_Uint64 *magnitude)
+{
+    const nitf_Uint64 max = ~(nitf_Uint64) 0;
+    nitf_Uint64 value = 0;
+    nitf_Uint32 eight;
+    size_t i = 0;
+
+    while (i < length && (str[i] == ' ' || (str[i] >= '\t' && str[i] <= '\r')))
+        ++i;
+
+    *negative = 0;
+    if (i < length && (str[i] == '+' || str[i] == '-'))
+        *negative = str[i++] == '-';
+
+    while (length - i >= 8 && value <= (max - 99999999) / 100000000 &&
+           eightDigits(str + i, &eight))
+    {
+        value = value * 100000000 + eight;
+        i += 8;
+    }
+
+    for (; i < length && str[i] >= '0' && str[i] <= '9'; ++i)
+    {
+        const unsigned int digit = (unsigned int) (str[i] - '0');
+        if (value > (max - digit) / 10)
+            value = max;
+        else
+            value = value * 10 + digit;
+    }
+    *magnitude = value;
+}
+
+/*  Every integer below this is exact in a double  */
+#define NITF_EXACT_MANTISSA ((nitf_Uint64) 1 << 53)
+
+/*  The powers of ten that are exact in a double  */
+static const double exactPowersOfTen[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*
+ *  Adds a run of digits to the mantissa.  Returns false if the mantissa
+ *  would no longer be exact in a double.
+ */
+NITFPRIV(NITF_BOOL) readMantissa(const char *str, size_t length, size_t *i,
+                                 nitf_Uint64 *mantissa, int *count)
+{
+    nitf_Uint32 eight;
+
+    while (length - *i >= 8 &&
+           *mantissa < (NITF_EXACT_MANTISSA - 99999999) / 100000000 &&
+           eightDigits(str + *i, &eight))
+    {
+        *mantissa = *mantissa * 100000000 + eight;
+        *i += 8;
+        *count += 8;
+    }
+    for (; *i < length && str[*i] >= '0' && str[*i] <= '9'; ++*i)
+    {
+        if (*mantissa >= (NITF_EXACT_MANTISSA - 9) / 10)
+            return 0;
+        *mantissa = *mantissa * 10 + (nitf_Uint64) (str[*i] - '0');
+        ++*count;
+    }
+    return 1;
+}
+
+/*
+ *  Reads a real number the way atof does.  When the digits fit in a
+ *  double's mantissa and the power of ten is exact too, one multiply or
+ *  divide gives the correctly rounded result, which is what strtod returns.
+ *  Anything else -- long mantissas, big exponents, hex, infinities, text
+ *  after the number -- goes to atof.
+ */
+NITFPRIV(NITF_BOOL) parseReal(const char *str, size_t length, double *value,
+                              nitf_Error * error)
+{
+    char stackBuf[64];
+    char *tmpBuf;
+
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+    nitf_Uint64 mantissa = 0;
+    NITF_BOOL negative = 0;
+    int exponent = 0;
+    int digits = 0;
+    int fraction = 0;
+    size_t i = 0;
+
+    while (i < length && (str[i] == ' ' || (str[i] >= '\t' && str[i] <= '\r')))
+        ++i;
+    if (i < length && (str[i] == '+' || str[i] == '-'))
+        negative = str[i++] == '-';
+
+    if (!readMantissa(str, length, &i, &mantissa, &digits))
+        goto SLOW_PATH;
+    if (i < length && str[i] == '.')
+    {
+        ++i;
+        if (!readMantissa(str, length, &i, &mantissa, &fraction))
+            goto SLOW_PATH;
+    }
+    if (digits + fraction == 0)
+        goto SLOW_PATH;
+
+    if (i < length && (str[i] == 'e' || str[i] == 'E'))
+    {
+        NITF_BOOL negativeExponent = 0;
+        int expDigits = 0;
+
+        ++i;
+        if (i < length && (str[i] == '+' || str[i] == '-'))
+            negativeExponent = str[i++] == '-';
+        for (; i < length && str[i] >= '0' && str[i] <= '9'; ++i)
+        {
+            if (exponent > 1000)
+                goto SLOW_PATH;
+            exponent = exponent * 10 + (str[i] - '0');
+            ++expDigits;
+        }
+        if (!expDigits)
+            goto SLOW_PATH;
+        if (negativeExponent)
+            exponent = -exponent;
+    }
+    while (i < length && str[i] == ' ')
+        ++i;
+    if (i != length)
+        goto SLOW_PATH;
+
+    exponent -= fraction;
+    if (mantissa == 0)
+        *value = 0.0;
+    else if (exponent >= 0 && exponent <= 22)
+        *value = (double) mantissa * exactPowersOfTen[exponent];
+    else if (exponent < 0 && exponent >= -22)
+        *value = (double) mantissa / exactPowersOfTen[-exponent];
+    else
+        goto SLOW_PATH;
+    if (negative)
+        *value = -*value;
+    return NITF_SUCCESS;
+
+  SLOW_PATH:
+#endif
+    tmpBuf = length < sizeof(stackBuf) ? stackBuf :
+             (char* )NITF_MALLOC(length + 1);
+    if (!tmpBuf)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memcpy(tmpBuf, str, length);
+    tmpBuf[length] = 0;
+    *value = atof(tmpBuf);
+    if (tmpBuf != stackBuf)
+        NITF_FREE(tmpBuf);
+    return NITF_SUCCESS;
+}
+
+/*  Sets a BCS field to a number, padded for its type  */
+NITFPRIV(NITF_BOOL) setDecimal(nitf_Field * field, NITF_BOOL negative,
+                               nitf_Uint64 magnitude, nitf_Error * error)
+{
+    char numberBuffer[NITF_DECIMAL_BUF_SZ];     /* Holds converted number */
+    size_t numberLen;           /* Length of converted number string */
+
+    /*  Check the field type */
+
+    if (field->type == NITF_BINARY)
+    {
+        nitf_Error_init(error, "Integer set for binary field ",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return (NITF_FAILURE);
+    }
+
+    /*  Convert the number to a string */
+
+    numberLen = formatDecimal(numberBuffer, negative, magnitude);
+
+    /* if it's resizable and a different length, we resize */
+    if (field->resizable && numberLen != field->length)
+    {
+        if (!nitf_Field_resizeField(field, numberLen, error))
+            return NITF_FAILURE;
+    }
+
+    if (numberLen > field->length)
+    {
+        nitf_Error_init(error, "Value for field is too long",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return (NITF_FAILURE);
+    }
+
+    /*  Transfer and pad result */
+
+    if (field->type == NITF_BCS_N)
+        copyAndFillZeros(field, numberBuffer, numberLen, error);
+    else
+        copyAndFillSpaces(field, numberBuffer, numberLen, error);
+
+    return (NITF_SUCCESS);
+}
+
 NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
         nitf_FieldType type,
         nitf_Error * error)
@@ -91,6 +374,61 @@ NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
 }
 
 
+NITFAPI(nitf_Field *) nitf_Field_constructInArena(nitf_Arena * arena,
+                                                  size_t length,
+                                                  nitf_FieldType type,
+                                                  nitf_Error * error)
+{
+    nitf_Field *field;
+    char fill;
+
+    if (!arena)
+        return nitf_Field_construct(length, type, error);
+
+    switch (type)
+    {
+        case NITF_BCS_A:
+            fill = ' ';
+            break;
+        case NITF_BCS_N:
+            fill = '0';
+            break;
+        case NITF_BINARY:
+            fill = 0;
+            break;
+        default:
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                             "Invalid type [%d]", type);
+            return NULL;
+    }
+
+    if (length == 0)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Cannot create field of size 0");
+        return NULL;
+    }
+
+    /* the data follows the field, so it is one allocation */
+    field = (nitf_Field *) nitf_Arena_malloc(arena,
+                                             sizeof(nitf_Field) + length + 1);
+    if (!field)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+
+    field->type = type;
+    field->raw = (char *) (field + 1);
+    field->length = length;
+    field->resizable = 0;
+    memset(field->raw, fill, length);
+    field->raw[length] = 0;
+    return field;
+}
+
+
 NITFAPI(NITF_BOOL) nitf_Field_setRawData(nitf_Field * field,
         NITF_DATA * data,
         size_t dataLength,
@@ -157,45 +495,7 @@ NITFAPI(NITF_BOOL) nitf_Field_setUint32(nitf_Field * field,
                                         nitf_Uint32 number,
                                         nitf_Error * error)
 {
-    char numberBuffer[20];      /* Holds converted number */
-    nitf_Uint32 numberLen;      /* Length of converted number string */
-
-    /*  Check the field type */
-
-    if (field->type == NITF_BINARY)
-    {
-        nitf_Error_init(error, "Integer set for binary field ",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (NITF_FAILURE);
-    }
-
-    /*  Convert the number to a string */
-
-    NITF_SNPRINTF(numberBuffer, 20, "%lu", (unsigned long) number);
-    numberLen = strlen(numberBuffer);
-
-    /* if it's resizable and a different length, we resize */
-    if (field->resizable && numberLen != field->length)
-    {
-        if (!nitf_Field_resizeField(field, numberLen, error))
-            return NITF_FAILURE;
-    }
-
-    if (numberLen > field->length)
-    {
-        nitf_Error_init(error, "Value for field is too long",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (NITF_FAILURE);
-    }
-
-    /*  Transfer and pad result */
-
-    if (field->type == NITF_BCS_N)
-        copyAndFillZeros(field, numberBuffer, numberLen, error);
-    else
-        copyAndFillSpaces(field, numberBuffer, numberLen, error);
-
-    return (NITF_SUCCESS);
+    return setDecimal(field, 0, number, error);
 }
 
 
@@ -205,45 +505,7 @@ NITFAPI(NITF_BOOL) nitf_Field_setUint64(nitf_Field * field,
                                         nitf_Uint64 number,
                                         nitf_Error * error)
 {
-    char numberBuffer[20];      /* Holds converted number */
-    nitf_Uint32 numberLen;      /* Length of converted number string */
-
-    /*  Check the field type */
-
-    if (field->type == NITF_BINARY)
-    {
-        nitf_Error_init(error, "Integer set for binary field ",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (NITF_FAILURE);
-    }
-
-    /*  Convert thte number to a string */
-
-    NITF_SNPRINTF(numberBuffer, 20, "%llu", (unsigned long long)number);
-    numberLen = strlen(numberBuffer);
-
-    /* if it's resizable and a different length, we resize */
-    if (field->resizable && numberLen != field->length)
-    {
-        if (!nitf_Field_resizeField(field, numberLen, error))
-            return NITF_FAILURE;
-    }
-
-    if (numberLen > field->length)
-    {
-        nitf_Error_init(error, "Value for BCS_N field is too long",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (NITF_FAILURE);
-    }
-
-    /*  Transfer and pad result */
-
-    if (field->type == NITF_BCS_N)
-        copyAndFillZeros(field, numberBuffer, numberLen, error);
-    else
-        copyAndFillSpaces(field, numberBuffer, numberLen, error);
-
-    return (NITF_SUCCESS);
+    return setDecimal(field, 0, number, error);
 }
 
 /*  Set a number field from a int32 */
@@ -252,45 +514,7 @@ NITFAPI(NITF_BOOL) nitf_Field_setInt32(nitf_Field * field,
                                        nitf_Int32 number,
                                        nitf_Error * error)
 {
-    char numberBuffer[20];      /* Holds converted number */
-    nitf_Uint32 numberLen;      /* Length of converted number string */
-
-    /*  Check the field type */
-
-    if (field->type == NITF_BINARY)
-    {
-        nitf_Error_init(error, "Integer set for binary field ",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (NITF_FAILURE);
-    }
-
-    /*  Convert the number to a string */
-
-    NITF_SNPRINTF(numberBuffer, 20, "%ld", (long) number);
-    numberLen = strlen(numberBuffer);
-
-    /* if it's resizable and a different length, we resize */
-    if (field->resizable && numberLen != field->length)
-    {
-        if (!nitf_Field_resizeField(field, numberLen, error))
-            return NITF_FAILURE;
-    }
-
-    if (numberLen > field->length)
-    {
-        nitf_Error_init(error, "Value for field is too long",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (NITF_FAILURE);
-    }
-
-    /*  Transfer and pad result */
-
-    if (field->type == NITF_BCS_N)
-        copyAndFillZeros(field, numberBuffer, numberLen, error);
-    else
-        copyAndFillSpaces(field, numberBuffer, numberLen, error);
-
-    return (NITF_SUCCESS);
+    return nitf_Field_setInt64(field, number, error);
 }
 
 /*  Set a number field from a int64 */
@@ -299,45 +523,11 @@ NITFAPI(NITF_BOOL) nitf_Field_setInt64(nitf_Field * field,
                                        nitf_Int64 number,
                                        nitf_Error * error)
 {
-    char numberBuffer[20];      /* Holds converted number */
-    nitf_Uint32 numberLen;      /* Length of converted number string */
-
-    /*  Check the field type */
-
-    if (field->type == NITF_BINARY)
-    {
-        nitf_Error_init(error, "Integer set for binary field ",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (NITF_FAILURE);
-    }
-
-    /*  Convert the number to a string */
-
-    NITF_SNPRINTF(numberBuffer, 20, "%lld", (long long)number);
-    numberLen = strlen(numberBuffer);
-
-    /* if it's resizable and a different length, we resize */
-    if (field->resizable && numberLen != field->length)
-    {
-        if (!nitf_Field_resizeField(field, numberLen, error))
-            return NITF_FAILURE;
-    }
-
-    if (numberLen > field->length)
-    {
-        nitf_Error_init(error, "Value for BCS_N field is too long",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (NITF_FAILURE);
-    }
-
-    /*  Transfer and pad result */
-
-    if (field->type == NITF_BCS_N)
-        copyAndFillZeros(field, numberBuffer, numberLen, error);
-    else
-        copyAndFillSpaces(field, numberBuffer, numberLen, error);
-
-    return (NITF_SUCCESS);
+    /*  Negating in unsigned arithmetic also works for the smallest one  */
+    if (number < 0)
+        return setDecimal(field, 1, (nitf_Uint64) 0 - (nitf_Uint64) number,
+                          error);
+    return setDecimal(field, 0, (nitf_Uint64) number, error);
 }
 
 /*  Set a string field */
@@ -439,6 +629,7 @@ NITFAPI(NITF_BOOL) nitf_Field_setReal(nitf_Field * field,
 {
     nitf_Uint32 precision;     /* Format precision */
     nitf_Uint32 bufferLen;     /* Length of buffer */
+    char stackBuffer[256];     /* Holds the results of most fields */
     char *buffer;              /* Holds intermediate and final results */
     char fmt[64];              /* Format used */
 
@@ -458,7 +649,8 @@ NITFAPI(NITF_BOOL) nitf_Field_setReal(nitf_Field * field,
 
     /* The 64 covers the puncuation and exponent and is overkill */
     bufferLen = field->length * 2 + 64;
-    buffer = (char* )NITF_MALLOC(bufferLen + 1);
+    buffer = bufferLen < sizeof(stackBuffer) ? stackBuffer :
+             (char* )NITF_MALLOC(bufferLen + 1);
     if (buffer == NULL)
     {
         nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
@@ -486,7 +678,11 @@ NITFAPI(NITF_BOOL) nitf_Field_setReal(nitf_Field * field,
     if (field->resizable && bufferLen != field->length)
     {
         if (!nitf_Field_resizeField(field, bufferLen, error))
+        {
+            if (buffer != stackBuffer)
+                NITF_FREE(buffer);
             return NITF_FAILURE;
+        }
     }
 
     if (bufferLen > field->length)
@@ -505,11 +701,13 @@ NITFAPI(NITF_BOOL) nitf_Field_setReal(nitf_Field * field,
 
     if (!nitf_Field_setRawData(field, buffer, field->length, error))
     {
-        NITF_FREE(buffer);
+        if (buffer != stackBuffer)
+            NITF_FREE(buffer);
         return(NITF_FAILURE);
     }
 
-    NITF_FREE(buffer);
+    if (buffer != stackBuffer)
+        NITF_FREE(buffer);
     return(NITF_SUCCESS);
 }
 
@@ -705,33 +903,24 @@ NITFPRIV(NITF_BOOL) toReal(nitf_Field * field, NITF_DATA * outData,
                            size_t length, nitf_Error * error)
 {
     NITF_BOOL status = NITF_SUCCESS;
-    char* tmpBuf = NULL;
+    double value;
 
     switch (field->type)
     {
         case NITF_BCS_A:
         case NITF_BCS_N:
-            tmpBuf = (char* )NITF_MALLOC(field->length + 1);
-            if (!tmpBuf)
-            {
-                nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                                NITF_CTXT, NITF_ERR_MEMORY);
-                status = NITF_FAILURE;
-                break;
-            }
-            memcpy(tmpBuf, field->raw, field->length);
-            tmpBuf[field->length] = 0;
-            if (length == sizeof(float))
-                *((float *) outData) = (float) atof(tmpBuf);
-            else if (length == sizeof(double))
-                *((double *) outData) = (double) atof(tmpBuf);
-            else
+            if (length != sizeof(float) && length != sizeof(double))
             {
                 nitf_Error_init(error, "toReal -> incorrect length", NITF_CTXT,
                                 NITF_ERR_INVALID_PARAMETER);
                 status = NITF_FAILURE;
             }
-            NITF_FREE(tmpBuf);
+            else if (!parseReal(field->raw, field->length, &value, error))
+                status = NITF_FAILURE;
+            else if (length == sizeof(float))
+                *((float *) outData) = (float) value;
+            else
+                *((double *) outData) = value;
             break;
         case NITF_BINARY:
             memcpy(outData, field->raw, length);
@@ -795,53 +984,56 @@ NITFPRIV(NITF_BOOL) toUint64(nitf_Field * field, nitf_Uint64 * int64,
 }
 
 
+/*  The number as strtol and atoll would give it, held within 64 bits  */
+NITFPRIV(nitf_Int64) toSigned(NITF_BOOL negative, nitf_Uint64 magnitude)
+{
+    const nitf_Uint64 max = ~(nitf_Uint64) 0 >> 1;
+    if (negative)
+        return magnitude > max ? -(nitf_Int64) max - 1 :
+                                 -(nitf_Int64) magnitude;
+    return magnitude > max ? (nitf_Int64) max : (nitf_Int64) magnitude;
+}
+
+
 NITFPRIV(NITF_BOOL) fromStringToInt(nitf_Field * field,
                                     NITF_DATA * outData, size_t length,
                                     nitf_Error * error)
 {
-    char buffer[256];
-    if (field->length > 256)
-    {
-        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
-                         "Field length too long for string conversion [%d]",
-                         field->length);
-        return NITF_FAILURE;
-    }
-    memcpy(buffer, field->raw, field->length);
-    buffer[field->length] = 0;
+    NITF_BOOL negative;
+    nitf_Uint64 magnitude;
+    nitf_Int64 value;
+
+    parseDecimal(field->raw, field->length, &negative, &magnitude);
+    value = toSigned(negative, magnitude);
     switch (length)
     {
         case 1:
         {
             nitf_Int8 *int8 = (nitf_Int8 *) outData;
-            *int8 = (nitf_Int8) NITF_ATO32(buffer);
+            *int8 = (nitf_Int8) value;
         }
         break;
         case 2:
         {
             nitf_Int16 *int16 = (nitf_Int16 *) outData;
-            *int16 = (nitf_Int16) NITF_ATO32(buffer);
+            *int16 = (nitf_Int16) value;
         }
         break;
         case 4:
         {
             nitf_Int32 *int32 = (nitf_Int32 *) outData;
-            *int32 = NITF_ATO32(buffer);
+            *int32 = (nitf_Int32) value;
         }
         break;
         case 8:
         {
             nitf_Int64 *int64 = (nitf_Int64 *) outData;
-#if defined(__aix__)
-            sscanf(buffer, "%lld", int64);
-#else
-            *int64 = NITF_ATO64(buffer);
-#endif
+            *int64 = value;
         }
         break;
         default:
             nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
-                             NITF_CTXT, "Unsupported length [%d]", length);
+                             "Unsupported length [%d]", length);
             return NITF_FAILURE;
     }
     return NITF_SUCCESS;
@@ -852,44 +1044,36 @@ NITFPRIV(NITF_BOOL) fromStringToUint(nitf_Field * field,
                                      NITF_DATA * outData, size_t length,
                                      nitf_Error * error)
 {
-    char buffer[256];
-    if (field->length > 256)
-    {
-        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
-                         "Field length too long for string conversion [%d]",
-                         field->length);
-        return NITF_FAILURE;
-    }
-    memcpy(buffer, field->raw, field->length);
-    buffer[field->length] = 0;
+    NITF_BOOL negative;
+    nitf_Uint64 magnitude;
+
+    parseDecimal(field->raw, field->length, &negative, &magnitude);
     switch (length)
     {
         case 1:
         {
             nitf_Uint8 *int8 = (nitf_Uint8 *) outData;
-            *int8 = (nitf_Uint8) NITF_ATO32(buffer);
+            *int8 = (nitf_Uint8) toSigned(negative, magnitude);
         }
         break;
         case 2:
         {
             nitf_Uint16 *int16 = (nitf_Uint16 *) outData;
-            *int16 = (nitf_Uint16) NITF_ATO32(buffer);
+            *int16 = (nitf_Uint16) toSigned(negative, magnitude);
         }
         break;
         case 4:
         {
+            /*  Like strtoul, a negative number wraps around  */
             nitf_Uint32 *int32 = (nitf_Uint32 *) outData;
-            *int32 = (nitf_Uint32) NITF_ATOU32(buffer);
+            *int32 = (nitf_Uint32) (negative ? (nitf_Uint64) 0 - magnitude :
+                                               magnitude);
         }
         break;
         case 8:
         {
             nitf_Uint64 *int64 = (nitf_Uint64 *) outData;
-#if defined(__aix__)
-            sscanf(buffer, "%lld", int64);
-#else
-            *int64 = (nitf_Uint64) NITF_ATO64(buffer);
-#endif
+            *int64 = (nitf_Uint64) toSigned(negative, magnitude);
         }
         break;
         default:
@@ -1155,6 +1339,34 @@ NITFAPI(NITF_BOOL) nitf_Field_resizeField(nitf_Field *field,
 }
 
 
+/*
+ *  What each character may be part of: 1 for BCS_A, which is 0x20 to 0x7E,
+ *  and 2 for BCS_N, which is digits, '-', '/' and '.' (a leading sign is
+ *  checked for separately).
+ */
+#define NITF_CHAR_BCSA 1
+#define NITF_CHAR_BCSN 2
+
+static const nitf_Uint8 CHAR_CLASS[256] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0x00 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0x10 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3,   /* 0x20 */
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 1, 1, 1, 1, 1,   /* 0x30 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,   /* 0x40 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,   /* 0x50 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,   /* 0x60 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,   /* 0x70 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0x80 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0x90 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0xA0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0xB0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0xC0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0xD0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* 0xE0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0    /* 0xF0 */
+};
+
 /*
  *  Private function to check that a string is BCS_N.
  *
@@ -1180,7 +1392,14 @@ NITFPRIV(NITF_BOOL) isBCSN(const char *str, size_t len, nitf_Error * error)
          *       string
          */
         const char ch = str[ii];
-        if (ch == '.')
+        if (!(CHAR_CLASS[(nitf_Uint8) ch] & NITF_CHAR_BCSN))
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                             "Invalid character %c in BCS_N string",
+                             ch);
+            return NITF_FAILURE;
+        }
+        else if (ch == '.')
         {
             if (foundDecimalPoint)
             {
@@ -1190,17 +1409,7 @@ NITFPRIV(NITF_BOOL) isBCSN(const char *str, size_t len, nitf_Error * error)
                                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
                 return NITF_FAILURE;
             }
-            else
-            {
-                foundDecimalPoint = 1;
-            }
-        }
-        else if (!isdigit(ch) && ch != '-' && ch != '/')
-        {
-            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
-                             "Invalid character %c in BCS_N string",
-                             ch);
-            return NITF_FAILURE;
+            foundDecimalPoint = 1;
         }
     }
 
@@ -1211,18 +1420,33 @@ NITFPRIV(NITF_BOOL) isBCSN(const char *str, size_t len, nitf_Error * error)
 /*
  *  Private function to check that a string is BCS_A.
  *
- *  A zero length string passes
+ *  A zero length string passes.  Long strings are checked eight bytes at a
+ *  time: a word holds a byte below 0x20 or above 0x7E exactly when one of
+ *  the two tests below leaves a high bit set, and the offending character
+ *  is then found one byte at a time.
  */
 
+#define NITF_BYTES(N) (((nitf_Uint64) ~0 / 255) * (N))
+
 NITFPRIV(NITF_BOOL) isBCSA(const char *str, size_t len, nitf_Error * error)
 {
-    size_t ii;
+    size_t ii = 0;
+
+    for (; ii + 8 <= len; ii += 8)
+    {
+        nitf_Uint64 word;
+        memcpy(&word, str + ii, sizeof(word));
+        if (((word - NITF_BYTES(0x20)) & ~word) & NITF_BYTES(0x80))
+            break;
+        if (((word + NITF_BYTES(0x7F - 0x7E)) | word) & NITF_BYTES(0x80))
+            break;
+    }
 
-    for (ii = 0; ii < len; ++ii)
+    for (; ii < len; ++ii)
     {
         const nitf_Uint8 ch = (nitf_Uint8)str[ii];
 
-        if (ch < 0x20 || ch > 0x7e)
+        if (!(CHAR_CLASS[ch] & NITF_CHAR_BCSA))
         {
             nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
                              "Invalid character %c in BCS_A string",
@@ -1233,3 +1457,20 @@ NITFPRIV(NITF_BOOL) isBCSA(const char *str, size_t len, nitf_Error * error)
 
     return NITF_SUCCESS;
 }
+
+
+NITFPROT(nitf_Int64) nitf_Field_parseInt64(const char *str, size_t length)
+{
+    NITF_BOOL negative;
+    nitf_Uint64 magnitude;
+
+    parseDecimal(str, length, &negative, &magnitude);
+    return toSigned(negative, magnitude);
+}
+
+
+NITFPROT(NITF_BOOL) nitf_Field_parseReal64(const char *str, size_t length,
+                                           double *value, nitf_Error * error)
+{
+    return parseReal(str, length, value, error);
+}
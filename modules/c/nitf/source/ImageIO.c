@@ -135,6 +135,10 @@ compression of a one byte unsigned image.\n
    in bytes */
 #define NITF_IMAGE_IO_PAD_MAX_LENGTH (16)
 
+/*! \def NITF_IMAGE_IO_READ_BATCH - Maximum number of row reads gathered
+   into one batch when reading uncompressed data */
+#define NITF_IMAGE_IO_READ_BATCH (256)
+
 /*!
   \def NITF_IMAGE_IO_PAD_SCANNER - Macro to a create pad scan function
 
@@ -149,6 +153,9 @@ compression of a one byte unsigned image.\n
       block in the block column
 
   The pad value and data have already been byte swapped if needed,
+
+  Each row is counted with a branch free loop that the compiler can
+  vectorize, and the scan stops as soon as both pad and data have been seen.
  */
 
 #define NITF_IMAGE_IO_PAD_SCANNER(name,type) \
@@ -156,13 +163,14 @@ compression of a one byte unsigned image.\n
     (struct _nitf_ImageIOBlock_s *blockIO, \
      NITF_BOOL *padFound,NITF_BOOL *dataFound) \
     { \
-        type *pixels = (type *) (blockIO->blockControl.block); \
+        const type *pixels = (const type *) (blockIO->blockControl.block); \
         type padValue = *((type *) (blockIO->cntl->nitf->pixel.pad)); \
         nitf_Uint32 row; \
         nitf_Uint32 col; \
         nitf_Uint32 rowEndIncr; \
         nitf_Uint32 colLimit; \
         nitf_Uint32 rowLimit; \
+        nitf_Uint32 padCount; \
         _nitf_ImageIO *nitf = blockIO->cntl->nitf; \
         NITF_BOOL pFound = 0; \
         NITF_BOOL dFound = 0; \
@@ -171,16 +179,16 @@ compression of a one byte unsigned image.\n
         rowLimit = blockIO->cntl->nitf->numRowsPerBlock;\
         if(blockIO->currentRow >= (nitf->numRows - 1)) \
             rowLimit -= blockIO->padRowCount; \
-        for(row=0;row<rowLimit;row++) \
+        for(row=0;row<rowLimit && !(pFound && dFound);row++) \
         { \
+            padCount = 0; \
             for(col=0;col<colLimit;col++) \
-            { \
-                if(*(pixels++) == padValue) \
-                    pFound = 1; \
-                else \
-                    dFound = 1; \
-            } \
-            pixels += rowEndIncr; \
+                padCount += (pixels[col] == padValue); \
+            if(padCount != 0) \
+                pFound = 1; \
+            if(padCount != colLimit) \
+                dFound = 1; \
+            pixels += colLimit + rowEndIncr; \
         } \
         *padFound = pFound; \
         *dataFound = dFound; \
@@ -521,6 +529,14 @@ typedef struct
     /*!< Control structure for current read */
     struct _nitf_ImageIOReadControl_s *readControl;
     _NITF_IMAGE_IO_PAD_SCAN_FUNC padScanner; /*! Scans for pad pixels in write */
+    nitf_Uint64 skippedBlockBytes; /*!< Bytes of pad only blocks not written */
+    nitf_Uint64 maskBlockBytes; /*!< Bytes in one block of a masked image */
+    nitf_Uint32 skippedBlockEnd; /*!< One past the last block not written */
+    nitf_Uint32 writtenBlockEnd; /*!< One past the last masked block written */
+    int sparseWriteFlag;        /*!< Skip all zero pixel writes if TRUE */
+    nitf_Uint64 sparseEnd;      /*!< End of the furthest skipped write */
+    nitf_Uint64 writtenEnd;     /*!< End of the furthest real write */
+    nitf_Uint64 lastWriteEnd;   /*!< End of the latest write, skipped or not */
 }
 _nitf_ImageIO;
 
@@ -862,6 +878,7 @@ typedef struct _nitf_ImageIOWriteControl_s
     _nitf_ImageIO_writeMethod method;
     _nitf_ImageIOControl *cntl; /*!< Associated control structure */
     nitf_Uint32 nextRow;        /*!< Next row to write (sequential) */
+    nitf_Uint32 nextBlock;      /*!< Next compressed block to write (direct) */
 }
 _nitf_ImageIOWriteControl;
 
@@ -1841,6 +1858,33 @@ I/O error
 NITFPRIV(int) nitf_ImageIO_readRequest(_nitf_ImageIOControl * cntl, nitf_IOInterface* io, nitf_Error * error    /*!< Error object */
                                       );
 
+/*!
+  \brief nitf_ImageIO_flushReads - Issue a batch of gathered reads
+
+  nitf_ImageIO_flushReads issues the reads gathered by
+  nitf_ImageIO_readRequest as one batch per block, so that many of them are
+  in flight at once and each batch is traced against its block, and then
+  unformats the rows they (and any pad reads) filled in.  Both counts are
+  reset to zero.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called
+directly by the user.
+
+On error, FALSE is returned and error is set.
+*/
+
+NITFPRIV(int) nitf_ImageIO_flushReads(_nitf_ImageIO * nitf,
+                                      nitf_IOInterface* io,
+                                      nitf_IORequest * requests,
+                                      nitf_Uint32 * requestBlocks,
+                                      size_t *numRequests,
+                                      nitf_Uint8 ** unformatBuffers,
+                                      size_t *unformatCounts,
+                                      size_t *numUnformats,
+                                      nitf_Error * error);
+
 /*!
   \brief nitf_ImageIO_readRequestDownSample - Do the read request with
   down-smapling
@@ -1964,6 +2008,64 @@ NITFPRIV(int) nitf_ImageIO_writeToFile(nitf_IOInterface* io,
                                        nitf_Error * errorBuffer /*!< Error object */
                                       );
 
+/*!
+  \brief nitf_ImageIO_writePixels - Write pixel data to a file
+
+  nitf_ImageIO_writePixels writes uncompressed pixel data to a file at a
+  specified offset. If sparse writes are enabled and the data is all zero,
+  nothing is written and the region is left for the file system to fill
+  with zeros; nitf_ImageIO_finishSparse makes sure the file is long enough
+  afterwards.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called
+  directly by the user.
+
+\return Returns FALSE on error
+
+On error, the supplied error object is set. Possible errors include:
+
+I/O error
+*/
+
+NITFPRIV(int) nitf_ImageIO_writePixels
+(
+    _nitf_ImageIO * nitf,         /*!< Associated ImageIO object */
+    nitf_IOInterface* io,         /*!< IO handle for write */
+    nitf_Uint64 fileOffset,       /*!< File offset for write */
+    const nitf_Uint8 * buffer,    /*!< Data buffer to write from */
+    size_t count,                 /*!< Number of bytes to write */
+    nitf_Error * error            /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_finishSparse - Complete a sparse write
+
+  If the last bytes of the image data were skipped by a sparse write, the
+  file does not reach the end of the image yet. nitf_ImageIO_finishSparse
+  writes the final zero byte so that it does, and leaves the file
+  positioned where a write of every byte would have left it.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called
+  directly by the user.
+
+\return Returns FALSE on error
+
+On error, the supplied error object is set. Possible errors include:
+
+I/O error
+*/
+
+NITFPRIV(int) nitf_ImageIO_finishSparse
+(
+    _nitf_ImageIO * nitf,         /*!< Associated ImageIO object */
+    nitf_IOInterface* io,         /*!< IO handle for write */
+    nitf_Error * error            /*!< Error object */
+);
+
 /*!
   \brief nitf_ImageIO_writeToBlock - Write data to a block
 
@@ -1988,6 +2090,10 @@ NITFPRIV(int) nitf_ImageIO_writeToFile(nitf_IOInterface* io,
   pad block might require the moving of a previously written block from a
   higher numbered band.
 
+  Should a pad only block complete after a later block has been written, it
+  is written as a block with pad rather than left out, so the offsets stay
+  right whatever order the blocks complete in.
+
 
   \b Note:
 
@@ -3513,6 +3619,11 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeDone(nitf_ImageIO * object,
         }
     }
 
+    /*      Make sure skipped data at the end still reaches the file */
+
+    if (!nitf_ImageIO_finishSparse(nitfI, io, error))
+        return NITF_FAILURE;
+
     /*      Flush the object */
 
     ret = nitf_ImageIO_flush(object, io, error);
@@ -3754,6 +3865,9 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_setPadPixel(nitf_ImageIO * object,
 
     switch (length)
     {
+    case 1:
+        break;
+
     case 2:
     {
         nitf_Uint16* int16 =
@@ -3789,7 +3903,7 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_setPadPixel(nitf_ImageIO * object,
         /* The 16 byte complex pixel is not actually possible */
     default:
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
-                         "Invalid format size [%s]", length);
+                         "Invalid format size [%d]", (int) length);
         return NITF_FAILURE;
     }
 
@@ -3932,6 +4046,192 @@ nitf_ImageIO_getBlockingInfo(nitf_ImageIO * image,
     return result;
 }
 
+/*========================= nitf_ImageLayout =================================*/
+
+NITFPROT(nitf_ImageLayout *) nitf_ImageLayout_construct(nitf_Error * error)
+{
+    nitf_ImageLayout *layout;
+
+    layout = (nitf_ImageLayout *) NITF_MALLOC(sizeof(nitf_ImageLayout));
+    if (layout == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        return NULL;
+    }
+    memset(layout, 0, sizeof(nitf_ImageLayout));
+    return layout;
+}
+
+
+NITFPROT(void) nitf_ImageLayout_destruct(nitf_ImageLayout ** layout)
+{
+    if (*layout == NULL)
+        return;
+
+    if ((*layout)->blockMask != NULL)
+        NITF_FREE((*layout)->blockMask);
+    if ((*layout)->padMask != NULL)
+        NITF_FREE((*layout)->padMask);
+    if ((*layout)->offsets != NULL)
+        NITF_FREE((*layout)->offsets);
+    NITF_FREE(*layout);
+    *layout = NULL;
+}
+
+
+NITFPRIV(nitf_Uint64 *) nitf_ImageIO_copyTable(const nitf_Uint64 * table,
+                                               nitf_Uint32 count,
+                                               nitf_Error * error)
+{
+    nitf_Uint64 *copy;
+
+    copy = (nitf_Uint64 *) NITF_MALLOC((count + 1) * sizeof(nitf_Uint64));
+    if (copy == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        return NULL;
+    }
+    if (count > 0)
+        memcpy(copy, table, count * sizeof(nitf_Uint64));
+    return copy;
+}
+
+
+NITFPROT(nitf_ImageLayout *)
+nitf_ImageIO_getLayout(nitf_ImageIO * image,
+                       nitf_IOInterface * io,
+                       const nitf_DecompressionOffsetsInterface * offsets,
+                       nitf_Error * error)
+{
+    _nitf_ImageIO *img;         /* Internal representation of object */
+    nitf_BlockingInfo *info;    /* Only wanted for its side effects */
+    nitf_ImageLayout *layout;   /* The result */
+    nitf_Uint64 *table;         /* The decompressor's table */
+
+    img = (_nitf_ImageIO *) image;
+
+    /* Reading the masks and starting the decompressor happen here */
+    info = nitf_ImageIO_getBlockingInfo(image, io, error);
+    if (info == NULL)
+        return NULL;
+    nitf_BlockingInfo_destruct(&info);
+
+    layout = nitf_ImageLayout_construct(error);
+    if (layout == NULL)
+        return NULL;
+
+    layout->numBlocks = img->nBlocksTotal;
+    layout->imageDataOffset = img->maskHeader.imageDataOffset;
+    layout->blockRecordLength = img->maskHeader.blockRecordLength;
+    layout->padRecordLength = img->maskHeader.padRecordLength;
+    layout->padPixelValueLength = img->maskHeader.padPixelValueLength;
+    memcpy(layout->padValue, img->pixel.pad, NITF_IMAGE_IO_PAD_MAX_LENGTH);
+
+    layout->blockMask = nitf_ImageIO_copyTable(img->blockMask,
+                                               img->nBlocksTotal + 1, error);
+    layout->padMask = nitf_ImageIO_copyTable(img->padMask,
+                                             img->nBlocksTotal, error);
+    if (layout->blockMask == NULL || layout->padMask == NULL)
+    {
+        nitf_ImageLayout_destruct(&layout);
+        return NULL;
+    }
+
+    if (img->decompressionControl != NULL && offsets != NULL
+        && offsets->getBlockOffsets)
+    {
+        table = (*(offsets->getBlockOffsets))
+            (img->decompressionControl, &(layout->numOffsets), error);
+        if (table == NULL)
+        {
+            nitf_ImageLayout_destruct(&layout);
+            return NULL;
+        }
+        layout->offsets = nitf_ImageIO_copyTable(table,
+                                                 layout->numOffsets, error);
+        if (layout->offsets == NULL)
+        {
+            nitf_ImageLayout_destruct(&layout);
+            return NULL;
+        }
+    }
+    return layout;
+}
+
+
+NITFPROT(NITF_BOOL)
+nitf_ImageIO_setLayout(nitf_ImageIO * image,
+                       const nitf_ImageLayout * layout,
+                       const nitf_DecompressionOffsetsInterface * offsets,
+                       nitf_Error * error)
+{
+    _nitf_ImageIO *img;         /* Internal representation of object */
+    nitf_Uint64 *blockMask;     /* Copy of the block mask */
+    nitf_Uint64 *padMask;       /* Copy of the pad mask */
+
+    img = (_nitf_ImageIO *) image;
+
+    if (img->blockMask != NULL || img->blockInfoFlag)
+    {
+        nitf_Error_init(error, "Image has already been prepared for reading",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    if (layout->numBlocks != img->nBlocksTotal
+        || layout->padPixelValueLength > NITF_IMAGE_IO_PAD_MAX_LENGTH)
+    {
+        nitf_Error_init(error, "Layout does not fit the image",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+
+    blockMask = nitf_ImageIO_copyTable(layout->blockMask,
+                                       layout->numBlocks + 1, error);
+    if (blockMask == NULL)
+        return NITF_FAILURE;
+    padMask = nitf_ImageIO_copyTable(layout->padMask,
+                                     layout->numBlocks, error);
+    if (padMask == NULL)
+    {
+        NITF_FREE(blockMask);
+        return NITF_FAILURE;
+    }
+
+    if (layout->numOffsets > 0 && img->decompressionControl != NULL
+        && offsets != NULL && offsets->setBlockOffsets
+        && !(*(offsets->setBlockOffsets))
+               (img->decompressionControl, layout->offsets,
+                layout->numOffsets, error))
+    {
+        NITF_FREE(blockMask);
+        NITF_FREE(padMask);
+        return NITF_FAILURE;
+    }
+
+    /* The same state nitf_ImageIO_mkMasks leaves behind for a read */
+    img->maskHeader.imageDataOffset = layout->imageDataOffset;
+    img->maskHeader.blockRecordLength = layout->blockRecordLength;
+    img->maskHeader.padRecordLength = layout->padRecordLength;
+    img->maskHeader.padPixelValueLength = layout->padPixelValueLength;
+    img->maskHeader.ready = 1;
+    memcpy(img->pixel.pad, layout->padValue, NITF_IMAGE_IO_PAD_MAX_LENGTH);
+    img->pixelBase += layout->imageDataOffset;
+    img->blockMask = blockMask;
+    img->padMask = padMask;
+    img->skippedBlockBytes = 0;
+    img->maskBlockBytes = 0;
+    img->skippedBlockEnd = 0;
+    img->writtenBlockEnd = 0;
+    img->sparseEnd = 0;
+    img->writtenEnd = 0;
+    img->lastWriteEnd = 0;
+    return NITF_SUCCESS;
+}
+
 NITFPROT(int) nitf_ImageIO_setWriteCaching(nitf_ImageIO * nitf, int enable)
 {
     _nitf_ImageIO *initf;   /* Internal representation of object */
@@ -3953,6 +4253,22 @@ NITFPROT(int) nitf_ImageIO_setWriteCaching(nitf_ImageIO * nitf, int enable)
     return saved;
 }
 
+NITFPROT(int) nitf_ImageIO_setSparseWrites(nitf_ImageIO * nitf, int enable)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+    int saved;              /* Saved result */
+
+    initf = (_nitf_ImageIO *) nitf;
+    saved = initf->sparseWriteFlag;
+    initf->sparseWriteFlag = enable ? 1 : 0;
+    return saved;
+}
+
+NITFPROT(nitf_Uint64) nitf_ImageIO_getWrittenEnd(nitf_ImageIO * nitf)
+{
+    return ((_nitf_ImageIO *) nitf)->writtenEnd;
+}
+
 NITFPROT(void) nitf_ImageIO_setReadCaching(nitf_ImageIO * nitf)
 {
     _nitf_ImageIO *initf;   /* Internal representation of object */
@@ -5907,6 +6223,7 @@ nitf_ImageIOWriteControl_construct(_nitf_ImageIOControl * cntl,
     result->cntl = cntl;
     result->method = method;
     result->nextRow = 0;
+    result->nextBlock = 0;
     return result;
 }
 
@@ -6215,6 +6532,13 @@ NITFPRIV(int) nitf_ImageIO_mkMasks(nitf_ImageIO * img,
                          "Memory allocation error: %s", NITF_STRERROR(NITF_ERRNO));
         return NITF_FAILURE;
     }
+    nitf->skippedBlockBytes = 0;
+    nitf->maskBlockBytes = bytesPerBlock;
+    nitf->skippedBlockEnd = 0;
+    nitf->writtenBlockEnd = 0;
+    nitf->sparseEnd = 0;
+    nitf->writtenEnd = 0;
+    nitf->lastWriteEnd = 0;
 
     if ((nitf->maskHeader.blockRecordLength == 0) || !reading)
     {                           /* No mask */
@@ -6726,6 +7050,60 @@ NITFPRIV(int) nitf_ImageIO_oneRead(_nitf_ImageIOControl * cntl,
 
 /* This function is used when FR == DR (no down-Sampling) */
 
+NITFPRIV(int) nitf_ImageIO_flushReads(_nitf_ImageIO * nitf,
+                                      nitf_IOInterface* io,
+                                      nitf_IORequest * requests,
+                                      nitf_Uint32 * requestBlocks,
+                                      size_t *numRequests,
+                                      nitf_Uint8 ** unformatBuffers,
+                                      size_t *unformatCounts,
+                                      size_t *numUnformats,
+                                      nitf_Error * error)
+{
+    size_t i;
+    size_t j;
+    size_t first;
+
+    /*
+     * The reads can complete in any order, so they are grouped by block
+     * and each group is read as its own batch, traced against its block.
+     * Rows come in block order already unless bands or block columns
+     * interleave, so this is usually no work.
+     */
+    for (i = 1; i < *numRequests; i++)
+    {
+        nitf_IORequest request = requests[i];
+        nitf_Uint32 block = requestBlocks[i];
+
+        for (j = i; j > 0 && requestBlocks[j - 1] > block; j--)
+        {
+            requests[j] = requests[j - 1];
+            requestBlocks[j] = requestBlocks[j - 1];
+        }
+        requests[j] = request;
+        requestBlocks[j] = block;
+    }
+
+    for (first = 0; first < *numRequests; first = i)
+    {
+        for (i = first + 1; i < *numRequests; i++)
+            if (requestBlocks[i] != requestBlocks[first])
+                break;
+
+        nitf_IOStatsAdapter_setBlock(io, requestBlocks[first]);
+        if (!nitf_IOInterface_readBatch(io, requests + first, i - first,
+                                        error))
+            return NITF_FAILURE;
+    }
+    *numRequests = 0;
+
+    for (i = 0; i < *numUnformats; i++)
+        (*(nitf->vtbl.unformat)) (unformatBuffers[i], unformatCounts[i],
+                                  nitf->pixel.shift);
+    *numUnformats = 0;
+    return NITF_SUCCESS;
+}
+
 NITFPRIV(int) nitf_ImageIO_readRequest(_nitf_ImageIOControl * cntl,
                                        nitf_IOInterface* io,
                                        nitf_Error * error)
@@ -6738,12 +7116,33 @@ NITFPRIV(int) nitf_ImageIO_readRequest(_nitf_ImageIOControl * cntl,
     nitf_Uint32 row;           /* Current row in sub-window */
     nitf_Uint32 band;          /* Current band in sub-window */
     _nitf_ImageIOBlock *blockIO; /* The current  block IO structure */
+    int batched;               /* Gather the reads into batches if TRUE */
+    nitf_IORequest requests[NITF_IMAGE_IO_READ_BATCH]; /* Gathered reads */
+    /* The block each gathered read is from */
+    nitf_Uint32 requestBlocks[NITF_IMAGE_IO_READ_BATCH];
+    size_t numRequests = 0;    /* Number of gathered reads */
+    /* Rows to unformat once their batch is in */
+    nitf_Uint8 *unformatBuffers[NITF_IMAGE_IO_READ_BATCH];
+    size_t unformatCounts[NITF_IMAGE_IO_READ_BATCH];
+    size_t numUnformats = 0;   /* Number of rows to unformat */
 
     nitf = cntl->nitf;
     numRows = cntl->numRows;
     numBands = cntl->numBandSubset;
     nBlockCols = cntl->nBlockIO / numBands;
 
+    /*
+     * Uncompressed data read straight into the user's buffer can have many
+     * rows in flight at once, since nothing has to be done with one row
+     * before the next is read except the in-place unformat.
+     */
+    batched = nitf->vtbl.reader == nitf_ImageIO_uncachedReader &&
+        nitf->vtbl.unpack == NULL;
+    for (col = 0; col < nBlockCols && batched; col++)
+        for (band = 0; band < numBands; band++)
+            if (!cntl->blockIO[col][band].userEqBuffer)
+                batched = 0;
+
     for (col = 0; col < nBlockCols; col++)
     {
         for (row = 0; row < numRows; row++)
@@ -6751,18 +7150,67 @@ NITFPRIV(int) nitf_ImageIO_readRequest(_nitf_ImageIOControl * cntl,
             for (band = 0; band < numBands; band++)
             {
                 blockIO = &(cntl->blockIO[col][band]);
-                if (blockIO->doIO)
-                    if (!(*(nitf->vtbl.reader)) (blockIO, io, error))
-                        return NITF_FAILURE;
+                if (!batched)
+                {
+                    if (blockIO->doIO)
+                        if (!(*(nitf->vtbl.reader)) (blockIO, io, error))
+                            return NITF_FAILURE;
+
+                    if (nitf->vtbl.unpack != NULL)
+                        (*(nitf->vtbl.unpack)) (blockIO, error);
+
+                    if (nitf->vtbl.unformat != NULL)
+                        (*(nitf->vtbl.unformat)) (blockIO->user.buffer +
+                                                  blockIO->user.offset.mark,
+                                                  blockIO->pixelCountDR,
+                                                  nitf->pixel.shift);
+                }
+                else
+                {
+                    if (!blockIO->doIO)
+                        ;
+                    else if (blockIO->imageDataOffset ==
+                             NITF_IMAGE_IO_NO_OFFSET)
+                    {
+                        /* Same as the uncached reader, minus the read */
+                        if (!nitf_ImageIO_readPad(blockIO, error))
+                            return NITF_FAILURE;
+                        cntl->padded = 1;
+                    }
+                    else
+                    {
+                        nitf_IORequest *request = &requests[numRequests];
+                        requestBlocks[numRequests++] = blockIO->number;
+                        request->offset = (nitf_Off) (nitf->pixelBase +
+                            blockIO->imageDataOffset +
+                            blockIO->blockOffset.mark);
+                        request->buf = blockIO->rwBuffer.buffer +
+                            blockIO->rwBuffer.offset.mark;
+                        request->size = blockIO->readCount;
+
+                        if (blockIO->padMask[blockIO->number] !=
+                            NITF_IMAGE_IO_NO_OFFSET)
+                            cntl->padded = 1;
+                    }
 
-                if (nitf->vtbl.unpack != NULL)
-                    (*(nitf->vtbl.unpack)) (blockIO, error);
+                    if (nitf->vtbl.unformat != NULL)
+                    {
+                        unformatBuffers[numUnformats] =
+                            blockIO->user.buffer + blockIO->user.offset.mark;
+                        unformatCounts[numUnformats++] =
+                            blockIO->pixelCountDR;
+                    }
 
-                if (nitf->vtbl.unformat != NULL)
-                    (*(nitf->vtbl.unformat)) (blockIO->user.buffer +
-                                              blockIO->user.offset.mark,
-                                              blockIO->pixelCountDR,
-                                              nitf->pixel.shift);
+                    if (numRequests == NITF_IMAGE_IO_READ_BATCH ||
+                        numUnformats == NITF_IMAGE_IO_READ_BATCH)
+                        if (!nitf_ImageIO_flushReads(nitf, io, requests,
+                                                     requestBlocks,
+                                                     &numRequests,
+                                                     unformatBuffers,
+                                                     unformatCounts,
+                                                     &numUnformats, error))
+                            return NITF_FAILURE;
+                }
                 /*
                  * You have to check for last row and not call
                  * nitf_ImageIO_nextRow because if the last row is the
@@ -6786,6 +7234,12 @@ NITFPRIV(int) nitf_ImageIO_readRequest(_nitf_ImageIOControl * cntl,
         }
     }
 
+    if (batched && !nitf_ImageIO_flushReads(nitf, io, requests, requestBlocks,
+                                            &numRequests, unformatBuffers,
+                                            unformatCounts, &numUnformats,
+                                            error))
+        return NITF_FAILURE;
+
     return 1;
 }
 
@@ -7131,6 +7585,78 @@ NITFPRIV(int) nitf_ImageIO_writeToFile(nitf_IOInterface* io,
     return NITF_SUCCESS;
 }
 
+NITFPRIV(int) nitf_ImageIO_writePixels(_nitf_ImageIO * nitf,
+                                       nitf_IOInterface* io,
+                                       nitf_Uint64 fileOffset,
+                                       const nitf_Uint8 * buffer,
+                                       size_t count,
+                                       nitf_Error * error)
+{
+    nitf_Uint64 end = fileOffset + count;
+
+    if (nitf->sparseWriteFlag && count > 0 && buffer[0] == 0 &&
+        memcmp(buffer, buffer + 1, count - 1) == 0)
+    {
+        if (end > nitf->sparseEnd)
+            nitf->sparseEnd = end;
+        nitf->lastWriteEnd = end;
+        return NITF_SUCCESS;
+    }
+
+    if (end > nitf->writtenEnd)
+        nitf->writtenEnd = end;
+    nitf->lastWriteEnd = end;
+    return nitf_ImageIO_writeToFile(io, fileOffset, buffer, count, error);
+}
+
+NITFPRIV(int) nitf_ImageIO_finishSparse(_nitf_ImageIO * nitf,
+                                        nitf_IOInterface* io,
+                                        nitf_Error * error)
+{
+    nitf_Uint8 zero = 0;
+
+    if (nitf->sparseEnd == 0)
+        return NITF_SUCCESS;
+
+    if (nitf->sparseEnd > nitf->writtenEnd)
+    {
+        if (!nitf_ImageIO_writeToFile(io, nitf->sparseEnd - 1, &zero, 1,
+                                      error))
+            return NITF_FAILURE;
+        nitf->writtenEnd = nitf->sparseEnd;
+    }
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
+                                               (nitf_Off) nitf->lastWriteEnd,
+                                               NITF_SEEK_SET, error)))
+        return NITF_FAILURE;
+
+    nitf->sparseEnd = 0;
+    return NITF_SUCCESS;
+}
+
+
+/*
+ * Returns where a masked block goes once the pad only blocks before it are
+ * left out. Every block left out so far is normally before this one, so
+ * the running total will do; otherwise the mask is counted up to it.
+ */
+NITFPRIV(nitf_Uint64) nitf_ImageIO_compactedOffset(_nitf_ImageIO * nitf,
+                                                   nitf_Uint32 maskIndex)
+{
+    nitf_Uint64 skipped = nitf->skippedBlockBytes;
+    nitf_Uint32 i;
+
+    if (maskIndex < nitf->skippedBlockEnd)
+    {
+        skipped = 0;
+        for (i = 0; i < maskIndex; i++)
+            if (nitf->blockMask[i] == NITF_IMAGE_IO_NO_BLOCK)
+                skipped += nitf->maskBlockBytes;
+    }
+    return nitf->blockMask[maskIndex] - skipped;
+}
+
 
 NITFPRIV(int) nitf_ImageIO_writeToBlock(_nitf_ImageIOBlock * blockIO,
                                         nitf_IOInterface* io,
@@ -7185,19 +7711,34 @@ NITFPRIV(int) nitf_ImageIO_writeToBlock(_nitf_ImageIOBlock * blockIO,
 
         if (scanner != NULL)
         {
+            /* Index of this block in the whole mask */
+            nitf_Uint32 maskIndex = (nitf_Uint32)
+                (blockIO->blockMask - nitf->blockMask) + blockIO->number;
+
             (*scanner)(blockIO, &padPresent, &dataPresent);
+
+            /*
+             * Blocks after this one that are already out were placed
+             * counting it in, so it can no longer be left out. It is
+             * written as a block with pad instead.
+             */
+            if (!dataPresent && maskIndex < nitf->writtenBlockEnd)
+            {
+                padPresent = 1;
+                dataPresent = 1;
+            }
+
             if (!dataPresent)                  /* Pad only do not write */
             {
                 /*
-                 * Copy down all of the offsets since with the missing block
-                 * this gives the correct offset for the following blocks. Copy
-                 * one less offset than the remaining blocks. The block count is
-                 * gotten by multiplying blocks per row by blocks
-                 * per column except
-                 * for (band sequential) which has seperate
-                 * masks for each band and
-                 * is not currently supported as explained in this functions
-                 * documentation.
+                 * Every following block moves down by the size of the
+                 * missing one. Rather than copying down all of the
+                 * remaining offsets here, the total is kept and taken
+                 * off each block's offset as it is written (see
+                 * nitf_ImageIO_compactedOffset). Band sequential, which
+                 * has seperate masks
+                 * for each band, is not currently supported as explained
+                 * in this functions documentation.
                  *
                  * The pad mask is set to the no block value correct
                  * for a missing block
@@ -7246,16 +7787,20 @@ NITFPRIV(int) nitf_ImageIO_writeToBlock(_nitf_ImageIOBlock * blockIO,
                             (nitf->nBlocksPerRow * nitf->nBlocksPerColumn -
                              blockIO->number) * sizeof(nitf_Uint64));
 #endif
-                memmove(&(blockIO->blockMask[blockIO->number+1]),
-                        &(blockIO->blockMask[blockIO->number]),
-                        (nitf->nBlocksPerRow * nitf->nBlocksPerColumn -
-                         blockIO->number) * sizeof(nitf_Uint64));
+                nitf->skippedBlockBytes += nitf->maskBlockBytes;
+                if (maskIndex >= nitf->skippedBlockEnd)
+                    nitf->skippedBlockEnd = maskIndex + 1;
 
                 blockIO->blockMask[blockIO->number] = NITF_IMAGE_IO_NO_BLOCK;
                 blockIO->padMask[blockIO->number] = NITF_IMAGE_IO_NO_BLOCK;
                 return NITF_SUCCESS;  /* Don't write */
             }
 
+            blockIO->blockMask[blockIO->number] =
+                nitf_ImageIO_compactedOffset(nitf, maskIndex);
+            if (maskIndex >= nitf->writtenBlockEnd)
+                nitf->writtenBlockEnd = maskIndex + 1;
+
             if (padPresent)     /* Real block with pad */
                 blockIO->padMask[blockIO->number] =
                     blockIO->blockMask[blockIO->number];
@@ -7278,17 +7823,10 @@ NITFPRIV(int) nitf_ImageIO_writeToBlock(_nitf_ImageIOBlock * blockIO,
         }
         else
         {
-            /* Seek to the offset */
-            if (!NITF_IO_SUCCESS
-                    (nitf_IOInterface_seek
-                            (io, (nitf_Off) fileOffset, NITF_SEEK_SET, error)))
-            return NITF_FAILURE;
-
-            /* Write the data */
-            if (!nitf_IOInterface_write(io,
-                            (char *) (blockCntl->block),
-                            nitf->blockSize, error) )
-            return NITF_FAILURE;
+            if (!nitf_ImageIO_writePixels(nitf, io, fileOffset,
+                                          blockCntl->block,
+                                          nitf->blockSize, error))
+                return NITF_FAILURE;
         }
     }
     return NITF_SUCCESS;
@@ -7334,6 +7872,7 @@ int nitf_ImageIO_uncachedReader(_nitf_ImageIOBlock * blockIO,
     }
     else
     {
+        nitf_IOStatsAdapter_setBlock(io, blockIO->number);
         if (!nitf_ImageIO_readFromFile(io,
                                        blockIO->cntl->nitf->pixelBase +
                                        blockIO->imageDataOffset +
@@ -7376,6 +7915,7 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
     }
     else
     {
+        nitf_IOStatsAdapter_setBlock(io, blockIO->number);
         if (nitf->blockControl.number != blockIO->number)
         {
             if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
@@ -7498,6 +8038,7 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
 
     if (nitfI->blockControl.number != blockNumber)
     {
+        nitf_IOStatsAdapter_setBlock(io, blockNumber);
         if ((nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
             && (nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
             && (nitfI->compression & NITF_IMAGE_IO_NO_COMPRESSION))
@@ -7590,6 +8131,28 @@ NITFPROT(NRT_BOOL) nitf_ImageIO_writeBlockDirect(nitf_ImageIO* object,
     ioCntl = cntl->cntl;
     nitf = ioCntl->nitf;
 
+    if (blockNumber >= nitf->nBlocksTotal)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Block %u is out of range, the image has %u blocks",
+                         blockNumber, nitf->nBlocksTotal);
+        return NITF_FAILURE;
+    }
+
+    /*
+     * The compressor appends each block to what it has written so far, so
+     * compressed blocks can only go out in order
+     */
+    if (nitf->compressor != NULL && blockNumber != cntl->nextBlock)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Compressed blocks must be written in order, "
+                         "expected block %u but got %u",
+                         cntl->nextBlock, blockNumber);
+        return NITF_FAILURE;
+    }
+    cntl->nextBlock = blockNumber + 1;
+
     //blockIO = &(ioCntl->blockIO[blockNumber][0]);
 
     {
@@ -7614,17 +8177,9 @@ NITFPROT(NRT_BOOL) nitf_ImageIO_writeBlockDirect(nitf_ImageIO* object,
         }
         else
         {
-            /* Seek to the offset */
-            if (!NITF_IO_SUCCESS
-                (nitf_IOInterface_seek
-                 (io, (nitf_Off) fileOffset, NITF_SEEK_SET, error)))
-                return NITF_FAILURE;
-
-            /* Write the data */
-
-            if (!nitf_IOInterface_write(io,
-                                        buffer,
-                                        nitf->blockSize, error) )
+            if (!nitf_ImageIO_writePixels(nitf, io, fileOffset,
+                                          (const nitf_Uint8 *) buffer,
+                                          nitf->blockSize, error))
                 return NITF_FAILURE;
         }
 
@@ -7645,7 +8200,7 @@ int nitf_ImageIO_uncachedWriter(_nitf_ImageIOBlock * blockIO,
     cntl = blockIO->cntl;
     nitf = cntl->nitf;
 
-    if (!nitf_ImageIO_writeToFile(io,
+    if (!nitf_ImageIO_writePixels(nitf, io,
                                   nitf->pixelBase + blockIO->imageDataOffset
                                   + blockIO->blockOffset.mark,
                                   blockIO->rwBuffer.buffer +
@@ -7661,7 +8216,7 @@ int nitf_ImageIO_uncachedWriter(_nitf_ImageIOBlock * blockIO,
             if (!nitf_ImageIO_allocatePad(cntl, error))
                 return NITF_FAILURE;
 
-        if (!nitf_ImageIO_writeToFile(io,
+        if (!nitf_ImageIO_writePixels(nitf, io,
                                       nitf->pixelBase +
                                       blockIO->imageDataOffset +
                                       blockIO->blockOffset.mark +
@@ -7692,7 +8247,7 @@ int nitf_ImageIO_uncachedWriter(_nitf_ImageIOBlock * blockIO,
 
         for (rowIdx = 0; rowIdx < blockIO->padRowCount; rowIdx++)
         {
-            if (!nitf_ImageIO_writeToFile(io,
+            if (!nitf_ImageIO_writePixels(nitf, io,
                                           offset, cntl->padBuffer,
                                           writeCount, error))
                 return NITF_FAILURE;
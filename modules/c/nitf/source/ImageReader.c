@@ -22,6 +22,23 @@
 
 #include "nitf/ImageReader.h"
 
+/* Files the reads that follow under this segment, if the IO is measured */
+NITFPRIV(void) tagInput(nitf_ImageReader * imageReader)
+{
+    char tag[32];
+    if (!nitf_IOStatsAdapter_getWrapped(imageReader->input))
+        return;
+    NITF_SNPRINTF(tag, sizeof(tag), "image[%d]", imageReader->segmentNumber);
+    nitf_IOStatsAdapter_setTag(imageReader->input, tag);
+}
+
+/* Stops filing reads under the segment */
+NITFPRIV(void) untagInput(nitf_ImageReader * imageReader)
+{
+    nitf_IOStatsAdapter_setTag(imageReader->input, NULL);
+    nitf_IOStatsAdapter_setBlock(imageReader->input, -1);
+}
+
 NITFAPI(nitf_BlockingInfo *)
 nitf_ImageReader_getBlockingInfo(nitf_ImageReader * imageReader,
                                  nitf_Error * error)
@@ -36,9 +53,14 @@ NITFAPI(NITF_BOOL) nitf_ImageReader_read(nitf_ImageReader * imageReader,
                                          nitf_Uint8 ** user,
                                          int *padded, nitf_Error * error)
 {
-    return (NITF_BOOL) nitf_ImageIO_read(imageReader->imageDeblocker,
-                                         imageReader->input,
-                                         subWindow, user, padded, error);
+    NITF_BOOL ok;
+
+    tagInput(imageReader);
+    ok = (NITF_BOOL) nitf_ImageIO_read(imageReader->imageDeblocker,
+                                       imageReader->input,
+                                       subWindow, user, padded, error);
+    untagInput(imageReader);
+    return ok;
 }
 
 NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
@@ -46,6 +68,8 @@ NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
                                                 nitf_Uint64* blockSize,
                                                 nitf_Error * error)
 {
+    nitf_Uint8 *block;
+
     if(!imageReader->directBlockRead)
     {
         if(!nitf_ImageIO_setupDirectBlockRead(imageReader->imageDeblocker,
@@ -57,11 +81,14 @@ NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
         imageReader->directBlockRead = 1;
     }
 
-    return nitf_ImageIO_readBlockDirect(imageReader->imageDeblocker,
-                                        imageReader->input,
-                                        blockNumber,
-                                        blockSize,
-                                        error);
+    tagInput(imageReader);
+    block = nitf_ImageIO_readBlockDirect(imageReader->imageDeblocker,
+                                         imageReader->input,
+                                         blockNumber,
+                                         blockSize,
+                                         error);
+    untagInput(imageReader);
+    return block;
 }
 
 NITFAPI(void) nitf_ImageReader_destruct(nitf_ImageReader ** imageReader)
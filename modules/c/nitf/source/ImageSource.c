@@ -76,8 +76,6 @@ NITFAPI(nitf_BandSource *)
 nitf_ImageSource_getBand(nitf_ImageSource * imageSource,
                          int n, nitf_Error * error)
 {
-    int i = 1;
-    nitf_ListIterator it;
     if (n < 0 || n >= imageSource->size)
     {
         nitf_Error_init(error,
@@ -85,9 +83,6 @@ nitf_ImageSource_getBand(nitf_ImageSource * imageSource,
                         NITF_CTXT, NITF_ERR_INVALID_OBJECT);
         return NULL;
     }
-    it = nitf_List_begin(imageSource->bandSources);
-
-    for (; i <= n; i++)
-        nitf_ListIterator_increment(&it);
-    return (nitf_BandSource *) nitf_ListIterator_get(&it);
+    return (nitf_BandSource *) nitf_List_get(imageSource->bandSources, n,
+                                             error);
 }
@@ -37,9 +37,18 @@ typedef struct _ImageWriterImpl
     nitf_ImageSource *imageSource;
     nitf_ImageIO *imageBlocker;
     NRT_BOOL directBlockWrite;
+    nitf_IOInterface *pushOutput;   /* Set while a pushed write is open */
+    int pushMode;
 
 } ImageWriterImpl;
 
+/* States of a pushed (caller driven) write */
+#define IMAGE_WRITER_PUSH_IDLE   0
+#define IMAGE_WRITER_PUSH_OPEN   1
+#define IMAGE_WRITER_PUSH_ROWS   2
+#define IMAGE_WRITER_PUSH_BLOCKS 3
+
+
 
 
 NITFPRIV(void) ImageWriter_destruct(NITF_DATA * data)
@@ -57,6 +66,25 @@ NITFPRIV(void) ImageWriter_destruct(NITF_DATA * data)
 }
 
 
+/*
+ *  Sets up the image blocker for a sequential write starting at the
+ *  current position of the output
+ */
+NITFPRIV(NITF_BOOL) ImageWriter_begin(ImageWriterImpl * impl,
+                                      nitf_IOInterface* output,
+                                      nitf_Error * error)
+{
+    nitf_Off offset = nitf_IOInterface_tell(output, error);
+    if (!NITF_IO_SUCCESS(offset))
+        return NITF_FAILURE;
+
+    if (!nitf_ImageIO_setFileOffset(impl->imageBlocker, offset, error))
+        return NITF_FAILURE;
+
+    return nitf_ImageIO_writeSequential(impl->imageBlocker, output, error);
+}
+
+
 NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
                                       nitf_IOInterface* output,
                                       nitf_Error * error)
@@ -66,7 +94,6 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
     nitf_Uint32 row, band, block;
     size_t rowSize, blockSize, numBlocks;
     nitf_Uint32 numImageBands = 0;
-    nitf_Off offset;
     nitf_BandSource *bandSrc = NULL;
     nitf_BlockingInfo* blockInfo = NULL;
     nitf_ImageIO* imageIO = NULL;
@@ -77,14 +104,14 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
     rowSize = impl->numCols * NITF_NBPP_TO_BYTES(impl->numBitsPerPixel);
 
 
-    offset = nitf_IOInterface_tell(output, error);
-    if (!NITF_IO_SUCCESS(offset))
-        goto CATCH_ERROR;
-
-    if (!nitf_ImageIO_setFileOffset(impl->imageBlocker, offset, error))
-        goto CATCH_ERROR;
+    if (impl->pushMode != IMAGE_WRITER_PUSH_IDLE)
+    {
+        nitf_Error_init(error, "A pushed write is already open",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
 
-    if (!nitf_ImageIO_writeSequential(impl->imageBlocker, output, error))
+    if (!ImageWriter_begin(impl, output, error))
         goto CATCH_ERROR;
 
     /* Direct block write mode only supported for a single band currently */
@@ -310,6 +337,13 @@ NITFAPI(void) nitf_ImageWriter_setDirectBlockWrite(nitf_ImageWriter *imageWriter
     impl->directBlockWrite = enable;
 }
 
+NITFAPI(int) nitf_ImageWriter_setSparseWrites(nitf_ImageWriter *imageWriter,
+        int enable)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
+    return(nitf_ImageIO_setSparseWrites(impl->imageBlocker, enable));
+}
+
 NITFAPI(NITF_BOOL) nitf_ImageWriter_setPadPixel(nitf_ImageWriter* imageWriter,
                                                 nitf_Uint8* value,
                                                 nitf_Uint32 length,
@@ -318,3 +352,120 @@ NITFAPI(NITF_BOOL) nitf_ImageWriter_setPadPixel(nitf_ImageWriter* imageWriter,
     ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
     return nitf_ImageIO_setPadPixel(impl->imageBlocker, value, length, error);
 }
+
+
+NITFAPI(NITF_BOOL) nitf_ImageWriter_open(nitf_ImageWriter* imageWriter,
+                                         nitf_IOInterface* output,
+                                         nitf_Error* error)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
+
+    if (impl->pushMode != IMAGE_WRITER_PUSH_IDLE)
+    {
+        nitf_Error_init(error, "A pushed write is already open",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+
+    /* Accumulate whole blocks so each one goes out in a single write */
+    nitf_ImageIO_setWriteCaching(impl->imageBlocker, 1);
+
+    if (!ImageWriter_begin(impl, output, error))
+        return NITF_FAILURE;
+
+    impl->pushOutput = output;
+    impl->pushMode = IMAGE_WRITER_PUSH_OPEN;
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_ImageWriter_writeRows(nitf_ImageWriter* imageWriter,
+                                              nitf_Uint32 numRows,
+                                              nitf_Uint8** data,
+                                              nitf_Error* error)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
+
+    if (impl->pushMode != IMAGE_WRITER_PUSH_OPEN &&
+        impl->pushMode != IMAGE_WRITER_PUSH_ROWS)
+    {
+        nitf_Error_init(error,
+                        impl->pushMode == IMAGE_WRITER_PUSH_IDLE ?
+                        "The image writer has not been opened" :
+                        "Rows cannot be mixed with direct block writes",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    impl->pushMode = IMAGE_WRITER_PUSH_ROWS;
+
+    return nitf_ImageIO_writeRows(impl->imageBlocker, impl->pushOutput,
+                                  numRows, data, error);
+}
+
+
+NITFAPI(NITF_BOOL) nitf_ImageWriter_writeBlock(nitf_ImageWriter* imageWriter,
+                                               nitf_Uint32 blockNumber,
+                                               const void* buffer,
+                                               nitf_Error* error)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
+
+    if (impl->pushMode != IMAGE_WRITER_PUSH_OPEN &&
+        impl->pushMode != IMAGE_WRITER_PUSH_BLOCKS)
+    {
+        nitf_Error_init(error,
+                        impl->pushMode == IMAGE_WRITER_PUSH_IDLE ?
+                        "The image writer has not been opened" :
+                        "Direct block writes cannot be mixed with rows",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    if (impl->numImageBands + impl->numMultispectralImageBands != 1)
+    {
+        nitf_Error_init(error,
+                        "Direct block writes are only supported for one band",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    impl->pushMode = IMAGE_WRITER_PUSH_BLOCKS;
+
+    return nitf_ImageIO_writeBlockDirect(impl->imageBlocker, impl->pushOutput,
+                                         buffer, blockNumber, error);
+}
+
+
+NITFAPI(NITF_BOOL) nitf_ImageWriter_finish(nitf_ImageWriter* imageWriter,
+                                           nitf_Error* error)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
+    nitf_IOInterface* output = impl->pushOutput;
+    nitf_Off end;
+    nitf_Off written;
+
+    if (impl->pushMode == IMAGE_WRITER_PUSH_IDLE)
+    {
+        nitf_Error_init(error, "The image writer has not been opened",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+
+    impl->pushOutput = NULL;
+    impl->pushMode = IMAGE_WRITER_PUSH_IDLE;
+    if (!nitf_ImageIO_writeDone(impl->imageBlocker, output, error))
+        return NITF_FAILURE;
+
+    /*
+     * Blocks can go out of order, so leave the output after the furthest
+     * one.  The output may already run past the image, so its size is no
+     * guide.  Compressed data goes out in order and ends where it leaves
+     * the output.
+     */
+    end = nitf_IOInterface_tell(output, error);
+    if (!NITF_IO_SUCCESS(end))
+        return NITF_FAILURE;
+    written = (nitf_Off) nitf_ImageIO_getWrittenEnd(impl->imageBlocker);
+    if (written <= end)
+        return NITF_SUCCESS;
+    return NITF_IO_SUCCESS(nitf_IOInterface_seek(output, written,
+                                                 NITF_SEEK_SET, error));
+}
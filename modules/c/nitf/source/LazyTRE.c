@@ -0,0 +1,263 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "nitf/LazyTRE.h"
+#include "nitf/TREUtils.h"
+#include "nitf/Record.h"
+
+/*
+ *  What a TRE holds until it is parsed
+ */
+typedef struct _LazyTREData
+{
+    char *data;                   /* The raw TRE bytes */
+    nitf_Uint32 length;           /* Number of raw bytes */
+    nitf_Off offset;              /* Where they were read from */
+    struct _nitf_Record *record;  /* Handed to the plug-in on parse */
+} LazyTREData;
+
+
+NITFPRIV(void) lazyDestruct(nitf_TRE *tre)
+{
+    if (tre && tre->priv)
+    {
+        LazyTREData *lazy = (LazyTREData*)tre->priv;
+        if (lazy->data)
+            NITF_FREE(lazy->data);
+        NITF_FREE(lazy);
+        tre->priv = NULL;
+    }
+}
+
+
+NITFAPI(NITF_BOOL) nitf_LazyTRE_resolve(nitf_TRE * tre, nitf_Error * error)
+{
+    LazyTREData *lazy;
+    nitf_IOInterface *io;
+    NITF_BOOL ok;
+
+    if (!nitf_LazyTRE_isPending(tre))
+        return NITF_SUCCESS;
+
+    lazy = (LazyTREData*)tre->priv;
+    io = nitf_BufferAdapter_construct(lazy->data, lazy->length + 1, 0, error);
+    if (!io)
+        return NITF_FAILURE;
+
+    /* parse as the Reader would have, then drop the raw bytes */
+    tre->priv = NULL;
+    ok = nitf_TRE_parse(tre, io, lazy->length, lazy->record, error);
+    nitf_IOInterface_destruct(&io);
+
+    if (!ok)
+    {
+        tre->handler = nitf_LazyTRE_handler(error);
+        tre->priv = lazy;
+        return NITF_FAILURE;
+    }
+
+    NITF_FREE(lazy->data);
+    NITF_FREE(lazy);
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_LazyTRE_isPending(nitf_TRE * tre)
+{
+    return tre && tre->priv &&
+        tre->handler == nitf_LazyTRE_handler(NULL);
+}
+
+
+NITFAPI(nitf_Off) nitf_LazyTRE_getOffset(nitf_TRE * tre)
+{
+    if (!nitf_LazyTRE_isPending(tre))
+        return -1;
+    return ((LazyTREData*)tre->priv)->offset;
+}
+
+
+NITFPRIV(const char*) lazyGetID(nitf_TRE *tre)
+{
+    nitf_Error error;
+    if (!nitf_LazyTRE_resolve(tre, &error))
+        return NULL;
+    return tre->handler->getID(tre);
+}
+
+
+NITFPRIV(NITF_BOOL) lazyRead(nitf_IOInterface *io,
+                             nitf_Uint32 length,
+                             nitf_TRE * tre,
+                             struct _nitf_Record* record,
+                             nitf_Error * error)
+{
+    LazyTREData *lazy = (LazyTREData*)NITF_MALLOC(sizeof(LazyTREData));
+    if (!lazy)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    lazy->length = length;
+    lazy->record = record;
+
+    /* one spare byte, so even an empty TRE has a buffer to parse from */
+    lazy->data = (char*)(record && record->arena ?
+            nitf_Arena_malloc(record->arena, length + 1) :
+            NITF_MALLOC(length + 1));
+    if (!lazy->data)
+    {
+        NITF_FREE(lazy);
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    lazy->data[length] = 0;
+    tre->priv = lazy;
+
+    lazy->offset = nitf_IOInterface_tell(io, error);
+    if (!NITF_IO_SUCCESS(lazy->offset) ||
+        !nitf_TREUtils_readField(io, lazy->data, (int) length, error))
+    {
+        lazyDestruct(tre);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) lazySetField(nitf_TRE * tre,
+                                 const char *tag,
+                                 NITF_DATA * data,
+                                 size_t dataLength,
+                                 nitf_Error * error)
+{
+    if (!nitf_LazyTRE_resolve(tre, error))
+        return NITF_FAILURE;
+    return tre->handler->setField(tre, tag, data, dataLength, error);
+}
+
+
+NITFPRIV(nitf_Field*) lazyGetField(nitf_TRE * tre, const char *tag)
+{
+    nitf_Error error;
+    if (!nitf_LazyTRE_resolve(tre, &error))
+        return NULL;
+    return tre->handler->getField(tre, tag);
+}
+
+
+NITFPRIV(nitf_List*) lazyFind(nitf_TRE * tre,
+                              const char *pattern,
+                              nitf_Error * error)
+{
+    if (!nitf_LazyTRE_resolve(tre, error))
+        return NULL;
+    return tre->handler->find(tre, pattern, error);
+}
+
+
+NITFPRIV(NITF_BOOL) lazyWrite(nitf_IOInterface* io,
+                              nitf_TRE* tre,
+                              struct _nitf_Record* record,
+                              nitf_Error* error)
+{
+    LazyTREData *lazy = (LazyTREData*)tre->priv;
+    (void)record;
+    return nitf_IOInterface_write(io, lazy->data, lazy->length, error);
+}
+
+
+NITFPRIV(nitf_TREEnumerator*) lazyBegin(nitf_TRE * tre, nitf_Error * error)
+{
+    if (!nitf_LazyTRE_resolve(tre, error))
+        return NULL;
+    return tre->handler->begin(tre, error);
+}
+
+
+NITFPRIV(int) lazyGetCurrentSize(nitf_TRE * tre, nitf_Error * error)
+{
+    (void)error;
+    return (int)((LazyTREData*)tre->priv)->length;
+}
+
+
+NITFPRIV(NITF_BOOL) lazyClone(nitf_TRE *source,
+                              nitf_TRE *tre,
+                              nitf_Error* error)
+{
+    LazyTREData *sourceLazy;
+    LazyTREData *lazy;
+
+    if (!tre || !source || !source->priv)
+        return NITF_FAILURE;
+    sourceLazy = (LazyTREData*)source->priv;
+
+    lazy = (LazyTREData*)NITF_MALLOC(sizeof(LazyTREData));
+    if (!lazy)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    lazy->data = (char*)NITF_MALLOC(sourceLazy->length + 1);
+    if (!lazy->data)
+    {
+        NITF_FREE(lazy);
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memcpy(lazy->data, sourceLazy->data, sourceLazy->length + 1);
+    lazy->length = sourceLazy->length;
+    lazy->offset = sourceLazy->offset;
+    lazy->record = NULL;
+
+    tre->priv = lazy;
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(nitf_TREHandler*) nitf_LazyTRE_handler(nitf_Error * error)
+{
+    static nitf_TREHandler handler =
+    {
+        NULL,   /* init - lazy TREs only come from the Reader */
+        lazyGetID,
+        lazyRead,
+        lazySetField,
+        lazyGetField,
+        lazyFind,
+        lazyWrite,
+        lazyBegin,
+        lazyGetCurrentSize,
+        lazyClone,
+        lazyDestruct,
+        NULL    /* data - We don't need this! */
+    };
+
+    (void)error;
+    return &handler;
+}
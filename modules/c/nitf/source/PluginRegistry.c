@@ -21,6 +21,7 @@
  */
 
 #include "nitf/PluginRegistry.h"
+#include "nitf/TREPlan.h"
 
 NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error);
 NITFPRIV(void) implicitDestruct(nitf_PluginRegistry ** reg);
@@ -33,10 +34,13 @@ NITFPRIV(NITF_BOOL) insertCreator(nitf_DLL* dso,
 
 #ifndef WIN32
     static nitf_Mutex  __PluginRegistryLock = NITF_MUTEX_INIT;
+    static nitf_Mutex  __TREHandlerCacheLock = NITF_MUTEX_INIT;
     static const char DIR_DELIMITER = '/';
 #else
     static nitf_Mutex __PluginRegistryLock = NULL;
     static long __PluginRegistryInitLock = 0;
+    static nitf_Mutex __TREHandlerCacheLock = NULL;
+    static long __TREHandlerCacheInitLock = 0;
     static const char DIR_DELIMITER = '\\';
 #endif
 /*
@@ -59,6 +63,23 @@ NITFPRIV(nitf_Mutex*) GET_MUTEX()
     return &__PluginRegistryLock;
 }
 
+/*
+ *  The handler cache has its own lock, since plugins may be loaded
+ *  while the registry lock is already held.
+ */
+NITFPRIV(nitf_Mutex*) GET_CACHE_MUTEX()
+{
+    if (__TREHandlerCacheLock == NULL)
+    {
+        while (InterlockedExchange(&__TREHandlerCacheInitLock, 1) == 1)
+            /* loop, another thread own the lock */ ;
+        if (__TREHandlerCacheLock == NULL)
+            nitf_Mutex_init(&__TREHandlerCacheLock);
+        InterlockedExchange(&__TREHandlerCacheInitLock, 0);
+    }
+    return &__TREHandlerCacheLock;
+}
+
 static
 NITF_BOOL isDelimiter(char ch)
 {
@@ -67,6 +88,7 @@ NITF_BOOL isDelimiter(char ch)
 }
 #else
 #define GET_MUTEX() &__PluginRegistryLock
+#define GET_CACHE_MUTEX() &__TREHandlerCacheLock
 
 static
 NITF_BOOL isDelimiter(char ch)
@@ -125,6 +147,42 @@ NITFPROT(nitf_PluginRegistry *)
     return theInstance;
 }
 
+/*
+ *  Forget any handler remembered for these TREs, so that the next
+ *  retrieval goes back to the handler table.
+ */
+NITFPRIV(void) forgetTREHandlers(nitf_PluginRegistry * reg,
+                                 const char **ident)
+{
+    int i;
+
+    nitf_Mutex_lock(GET_CACHE_MUTEX());
+    for (i = 1; ident[i] != NULL; ++i)
+        nitf_HashTable_remove(reg->treHandlerCache, ident[i]);
+    nitf_Mutex_unlock(GET_CACHE_MUTEX());
+}
+
+/*
+ *  Forget every handler remembered, for when plugins come or go in bulk.
+ */
+NITFPRIV(void) forgetAllTREHandlers(nitf_PluginRegistry * reg)
+{
+    int i;
+
+    nitf_Mutex_lock(GET_CACHE_MUTEX());
+    for (i = 0; i < reg->treHandlerCache->nbuckets; ++i)
+    {
+        nitf_List *bucket = reg->treHandlerCache->buckets[i];
+        while (!nitf_List_isEmpty(bucket))
+        {
+            nitf_Pair *pair = (nitf_Pair *) nitf_List_popFront(bucket);
+            NITF_FREE(pair->key);
+            NITF_FREE(pair);
+        }
+    }
+    nitf_Mutex_unlock(GET_CACHE_MUTEX());
+}
+
 NITFPRIV(NITF_BOOL) insertPlugin(nitf_PluginRegistry * reg,
                                  const char **ident,
                                  nitf_DLL * dll,
@@ -134,6 +192,7 @@ NITFPRIV(NITF_BOOL) insertPlugin(nitf_PluginRegistry * reg,
     int i;
     int ok;
     const char* suffix = NULL;
+    nitf_Error ignored;
 
     /* Load the DLL */
     if (!nitf_List_pushBack(reg->dsos, dll, error))
@@ -177,11 +236,25 @@ NITFPRIV(NITF_BOOL) insertPlugin(nitf_PluginRegistry * reg,
         ok = insertCreator(dll, hash, key, suffix, error);
         if (!ok)
         {
-            return NITF_FAILURE;
+            break;
+        }
+
+        /*  The offsets go with the decompressor, so a plugin without  */
+        /*  them must not be paired with an earlier plugin's           */
+        if (hash == reg->decompressionHandlers)
+        {
+            nitf_HashTable_remove(reg->decompressionOffsets, key);
+            insertCreator(dll, reg->decompressionOffsets, key,
+                          NITF_PLUGIN_OFFSETS_SUFFIX, &ignored);
         }
 
     }
-    return NITF_SUCCESS;
+
+    /*  Even a partial insertion may have replaced some handlers  */
+    if (hash == reg->treHandlers)
+        forgetTREHandlers(reg, ident);
+
+    return ok ? NITF_SUCCESS : NITF_FAILURE;
 }
 
 
@@ -207,6 +280,8 @@ NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error)
     reg->compressionHandlers = NULL;
     reg->treHandlers = NULL;
     reg->decompressionHandlers = NULL;
+    reg->decompressionOffsets = NULL;
+    reg->treHandlerCache = NULL;
     reg->dsos = NULL;
 
     reg->dsos = nitf_List_construct(error);
@@ -230,6 +305,19 @@ NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error)
     /* do not adopt the data - we will clean it up ourselves */
     nitf_HashTable_setPolicy(reg->treHandlers, NITF_DATA_RETAIN_OWNER);
 
+    reg->treHandlerCache =
+        nitf_HashTable_construct(NITF_TRE_HANDLER_CACHE_HASH_SIZE, error);
+
+    /*  If we have a problem, get rid of this object and return  */
+    if (!reg->treHandlerCache)
+    {
+        implicitDestruct(&reg);
+        return NULL;
+    }
+
+    /* the handlers belong to the plugins */
+    nitf_HashTable_setPolicy(reg->treHandlerCache, NITF_DATA_RETAIN_OWNER);
+
     reg->compressionHandlers =
         nitf_HashTable_construct(NITF_COMPRESSION_HASH_SIZE, error);
 
@@ -258,6 +346,19 @@ NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error)
     nitf_HashTable_setPolicy(reg->decompressionHandlers,
                              NITF_DATA_RETAIN_OWNER);
 
+    reg->decompressionOffsets =
+        nitf_HashTable_construct(NITF_DECOMPRESSION_HASH_SIZE, error);
+
+    /*  If we have a problem, get rid of this object and return  */
+    if (!reg->decompressionOffsets)
+    {
+        implicitDestruct(&reg);
+        return NULL;
+    }
+
+    nitf_HashTable_setPolicy(reg->decompressionOffsets,
+                             NITF_DATA_RETAIN_OWNER);
+
     /*  Start with a clean slate  */
     memset(reg->path, 0, NITF_MAX_PATH);
 
@@ -314,6 +415,7 @@ NITFPRIV(void) exitListener(void)
         }
     }
     nitf_Mutex_delete(mutex);
+    nitf_Mutex_delete(GET_CACHE_MUTEX());
 }
 
 NITFPRIV(void) implicitDestruct(nitf_PluginRegistry ** reg)
@@ -327,10 +429,14 @@ NITFPRIV(void) implicitDestruct(nitf_PluginRegistry ** reg)
 
         if ((*reg)->treHandlers)
             nitf_HashTable_destruct(&(*reg)->treHandlers);
+        if ((*reg)->treHandlerCache)
+            nitf_HashTable_destruct(&(*reg)->treHandlerCache);
         if ((*reg)->compressionHandlers)
             nitf_HashTable_destruct(&(*reg)->compressionHandlers);
         if ((*reg)->decompressionHandlers)
             nitf_HashTable_destruct(&(*reg)->decompressionHandlers);
+        if ((*reg)->decompressionOffsets)
+            nitf_HashTable_destruct(&(*reg)->decompressionOffsets);
         NITF_FREE(*reg);
         *reg = NULL;
     }
@@ -445,6 +551,12 @@ NITFPROT(NITF_BOOL) nitf_PluginRegistry_unload(nitf_PluginRegistry * reg,
     /*  Pop the front off, until the list is empty  */
     nitf_List* l = reg->dsos;
     NITF_BOOL success = NITF_SUCCESS;
+
+    /*  The handlers remembered may live in the DLLs going away, and  */
+    /*  so may the descriptions the plans were built from             */
+    forgetAllTREHandlers(reg);
+    nitf_TREPlan_unload();
+
     while ( ! nitf_List_isEmpty(l) )
     {
         nitf_DLL* dso = (nitf_DLL*)nitf_List_popFront(l);
@@ -549,6 +661,8 @@ nitf_PluginRegistry_registerTREHandler(NITF_PLUGIN_INIT_FUNCTION init,
         ok &= nitf_HashTable_insert(reg->treHandlers, ident[i], (NITF_DATA*)handle, error);
     }
 
+    forgetTREHandlers(reg, ident);
+
     return ok;
 
 }
@@ -726,6 +840,15 @@ nitf_PluginRegistry_retrieveDecompConstructor(nitf_PluginRegistry * reg,
     return (NITF_PLUGIN_DECOMPRESSION_CONSTRUCT_FUNCTION) pair->data;
 }
 
+NITFPROT(NITF_PLUGIN_DECOMPRESSION_OFFSETS_FUNCTION)
+nitf_PluginRegistry_retrieveDecompOffsets(nitf_PluginRegistry * reg,
+                                          const char *ident)
+{
+    nitf_Pair *pair = nitf_HashTable_find(reg->decompressionOffsets, ident);
+    return pair ? (NITF_PLUGIN_DECOMPRESSION_OFFSETS_FUNCTION) pair->data
+                : NULL;
+}
+
 NITFPROT(NITF_PLUGIN_COMPRESSION_CONSTRUCT_FUNCTION)
 nitf_PluginRegistry_retrieveCompConstructor(nitf_PluginRegistry * reg,
                                             const char *ident,
@@ -818,6 +941,10 @@ NITFPRIV(NITF_BOOL) insertCreator(nitf_DLL* dso,
  *  the hash table.  If they are there, we are good, if not fail
  *
  *  No more talking to the DSOs directly
+ *
+ *  Plugins hand back the same handler every time, so the answer for each
+ *  tag is kept in the cache, NULL included, and treMain is called only
+ *  the first time a tag is seen.  Errors are not kept.
  */
 NITFPROT(nitf_TREHandler*)
 nitf_PluginRegistry_retrieveTREHandler(nitf_PluginRegistry * reg,
@@ -825,7 +952,7 @@ nitf_PluginRegistry_retrieveTREHandler(nitf_PluginRegistry * reg,
                                        int *hadError,
                                        nitf_Error * error)
 {
-    nitf_TREHandler* theHandler;
+    nitf_TREHandler* theHandler = NULL;
     /*  We get back a pair from the hash table  */
     nitf_Pair *pair;
     /*  We are trying to find tre_main  */
@@ -834,25 +961,39 @@ nitf_PluginRegistry_retrieveTREHandler(nitf_PluginRegistry * reg,
     /*  No error has occurred (yet)  */
     *hadError = 0;
 
-    if (!nitf_HashTable_exists(reg->treHandlers, treIdent))
+    nitf_Mutex_lock(GET_CACHE_MUTEX());
+
+    pair = nitf_HashTable_find(reg->treHandlerCache, treIdent);
+    if (pair)
     {
-        return NULL;
+        theHandler = (nitf_TREHandler*) pair->data;
+        nitf_Mutex_unlock(GET_CACHE_MUTEX());
+        return theHandler;
     }
+
     /*  Lookup the pair from the hash table, by the tre_id  */
     pair = nitf_HashTable_find(reg->treHandlers, treIdent);
 
-    /*  If nothing is there, we dont have a handler, plain and simple  */
-    if (!pair)
-        return NULL;
-
-    /*  If something is, get its DLL part  */
-    treMain = (NITF_PLUGIN_TRE_HANDLER_FUNCTION) pair->data;
+    /*  If something is there, get its DLL part  */
+    if (pair)
+    {
+        treMain = (NITF_PLUGIN_TRE_HANDLER_FUNCTION) pair->data;
+        theHandler = (*treMain)(error);
+        if (!theHandler)
+        {
+            *hadError = 1;
+        }
+    }
 
-    theHandler = (*treMain)(error);
-    if (!theHandler)
+    /*  If we can't remember it, we will just look it up again  */
+    if (!*hadError)
     {
-        *hadError = 1;
+        nitf_Error cacheError;
+        nitf_HashTable_insert(reg->treHandlerCache, treIdent,
+                              (NITF_DATA*) theHandler, &cacheError);
     }
+
+    nitf_Mutex_unlock(GET_CACHE_MUTEX());
     return theHandler;
 }
 
@@ -20,8 +20,15 @@
  *
  */
 
+#include <stddef.h>
 #include "nitf/Reader.h"
 
+/*  Size of the read buffer used while parsing the headers  */
+#define NITF_READER_BUFFER_SIZE (64 * 1024)
+
+/*  Size of the stack buffer that runs of fields are read into  */
+#define NITF_READER_RUN_SIZE 1024
+
 /****************************
  *** NOTE ABOUT THE MACROS ***
  *****************************
@@ -126,27 +133,284 @@ NITF_TRY_GET_UINT32|64() -- these are public macros found in nitf/Value.h
     if (!readValue(reader_, OWNER->ID, ID##_SZ, error)) goto CATCH_ERROR;
 
 #define TRY_READ_COMPONENT(reader_, infoPtrPtr_, numValue_, \
-                           subHdrSz_,  dataSz_) \
+                           subHdrSz_,  dataSz_, nextValue_) \
 if (!readComponentInfo(reader_, \
                        infoPtrPtr_, \
                        numValue_, \
                        subHdrSz_, \
                        dataSz_, \
+                       nextValue_, \
                        error) ) goto CATCH_ERROR;
 
 /*  This is the size of each num* (numi, numx, nums, numdes, numres)  */
 #define NITF_IVAL_SZ 3
 
+/*  Most of a header is a run of fixed-length fields, laid out the same   */
+/*  way in every file.  The runs are described by the tables below, and   */
+/*  each is read with one call and cut up in memory.  Only where a        */
+/*  field's presence or length depends on one before it (the number of   */
+/*  bands, LUTs, comments, extension lengths) does a run end.             */
+
+/*  A field in a run: where the nitf_Field* is in the object that holds  */
+/*  it, and how many bytes it takes in the file                           */
+typedef struct _FieldSlot
+{
+    size_t offset;
+    int length;
+} FieldSlot;
+
+/*  A run of fields in one object  */
+typedef struct _FieldRun
+{
+    void *owner;
+    const FieldSlot *slots;
+    int numSlots;
+} FieldRun;
+
+#define FIELD_SLOT(TYPE_, ID_) { offsetof(TYPE_, ID_), ID_##_SZ }
+#define FIELD_SLOT_SZ(TYPE_, ID_, SZ_) { offsetof(TYPE_, ID_), SZ_ }
+#define NUM_SLOTS(SLOTS_) ((int) (sizeof(SLOTS_) / sizeof(FieldSlot)))
+
+#define TRY_READ_RUN(reader_, owner_, slots_, numSlots_) \
+    if (!readFieldRun(reader_, owner_, slots_, numSlots_, error)) \
+        goto CATCH_ERROR;
+
+static const FieldSlot SECURITY_21[] =
+{
+    FIELD_SLOT(nitf_FileSecurity, NITF_CLSY),
+    FIELD_SLOT(nitf_FileSecurity, NITF_CODE),
+    FIELD_SLOT(nitf_FileSecurity, NITF_CTLH),
+    FIELD_SLOT(nitf_FileSecurity, NITF_REL),
+    FIELD_SLOT(nitf_FileSecurity, NITF_DCTP),
+    FIELD_SLOT(nitf_FileSecurity, NITF_DCDT),
+    FIELD_SLOT(nitf_FileSecurity, NITF_DCXM),
+    FIELD_SLOT(nitf_FileSecurity, NITF_DG),
+    FIELD_SLOT(nitf_FileSecurity, NITF_DGDT),
+    FIELD_SLOT(nitf_FileSecurity, NITF_CLTX),
+    FIELD_SLOT(nitf_FileSecurity, NITF_CATP),
+    FIELD_SLOT(nitf_FileSecurity, NITF_CAUT),
+    FIELD_SLOT(nitf_FileSecurity, NITF_CRSN),
+    FIELD_SLOT(nitf_FileSecurity, NITF_RDT),
+    FIELD_SLOT(nitf_FileSecurity, NITF_CTLN)
+};
+
+/*  NOTE: The sizes are different from those of 2.1, and a CLTX only  */
+/*  follows some DGDT values                                           */
+static const FieldSlot SECURITY_20[] =
+{
+    FIELD_SLOT_SZ(nitf_FileSecurity, NITF_CODE, NITF_CODE_20_SZ),
+    FIELD_SLOT_SZ(nitf_FileSecurity, NITF_CTLH, NITF_CTLH_20_SZ),
+    FIELD_SLOT_SZ(nitf_FileSecurity, NITF_REL, NITF_REL_20_SZ),
+    FIELD_SLOT_SZ(nitf_FileSecurity, NITF_CAUT, NITF_CAUT_20_SZ),
+    FIELD_SLOT_SZ(nitf_FileSecurity, NITF_CTLN, NITF_CTLN_20_SZ),
+    FIELD_SLOT_SZ(nitf_FileSecurity, NITF_DGDT, NITF_DGDT_20_SZ)
+};
+
+static const FieldSlot HEADER_ID[] =
+{
+    FIELD_SLOT(nitf_FileHeader, NITF_FHDR),
+    FIELD_SLOT(nitf_FileHeader, NITF_FVER)
+};
+
+static const FieldSlot HEADER_BEFORE_SECURITY[] =
+{
+    FIELD_SLOT(nitf_FileHeader, NITF_CLEVEL),
+    FIELD_SLOT(nitf_FileHeader, NITF_STYPE),
+    FIELD_SLOT(nitf_FileHeader, NITF_OSTAID),
+    FIELD_SLOT(nitf_FileHeader, NITF_FDT),
+    FIELD_SLOT(nitf_FileHeader, NITF_FTITLE),
+    FIELD_SLOT(nitf_FileHeader, NITF_FSCLAS)
+};
+
+static const FieldSlot HEADER_AFTER_SECURITY_21[] =
+{
+    FIELD_SLOT(nitf_FileHeader, NITF_FSCOP),
+    FIELD_SLOT(nitf_FileHeader, NITF_FSCPYS),
+    FIELD_SLOT(nitf_FileHeader, NITF_ENCRYP),
+    FIELD_SLOT(nitf_FileHeader, NITF_FBKGC),
+    FIELD_SLOT(nitf_FileHeader, NITF_ONAME),
+    FIELD_SLOT(nitf_FileHeader, NITF_OPHONE),
+    FIELD_SLOT(nitf_FileHeader, NITF_FL),
+    FIELD_SLOT(nitf_FileHeader, NITF_HL),
+    FIELD_SLOT_SZ(nitf_FileHeader, NITF_NUMI, NITF_IVAL_SZ)
+};
+
+/*  In 2.0 there wasn't a FBKGC field, so ONAME takes its place too  */
+static const FieldSlot HEADER_AFTER_SECURITY_20[] =
+{
+    FIELD_SLOT(nitf_FileHeader, NITF_FSCOP),
+    FIELD_SLOT(nitf_FileHeader, NITF_FSCPYS),
+    FIELD_SLOT(nitf_FileHeader, NITF_ENCRYP),
+    FIELD_SLOT_SZ(nitf_FileHeader, NITF_ONAME,
+                  NITF_FBKGC_SZ + NITF_ONAME_SZ),
+    FIELD_SLOT(nitf_FileHeader, NITF_OPHONE),
+    FIELD_SLOT(nitf_FileHeader, NITF_FL),
+    FIELD_SLOT(nitf_FileHeader, NITF_HL),
+    FIELD_SLOT_SZ(nitf_FileHeader, NITF_NUMI, NITF_IVAL_SZ)
+};
+
+static const FieldSlot IMAGE_BEFORE_SECURITY[] =
+{
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IM),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IID1),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IDATIM),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_TGTID),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IID2),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_ISCLAS)
+};
+
+static const FieldSlot IMAGE_AFTER_SECURITY[] =
+{
+    FIELD_SLOT(nitf_ImageSubheader, NITF_ENCRYP),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_ISORCE),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NROWS),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NCOLS),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_PVTYPE),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IREP),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_ICAT),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_ABPP),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_PJUST),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_ICORDS)
+};
+
+/*  IGEOLO is only there for some ICORDS; NICOM alone starts one in  */
+static const FieldSlot IMAGE_CORNERS[] =
+{
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IGEOLO),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NICOM)
+};
+
+/*  COMRAT is only there for compressed images; NBANDS alone starts one  */
+/*  in                                                                   */
+static const FieldSlot IMAGE_COMPRESSION[] =
+{
+    FIELD_SLOT(nitf_ImageSubheader, NITF_COMRAT),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NBANDS)
+};
+
+static const FieldSlot IMAGE_BLOCKING[] =
+{
+    FIELD_SLOT(nitf_ImageSubheader, NITF_ISYNC),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IMODE),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NBPR),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NBPC),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NPPBH),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NPPBV),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_NBPP),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IDLVL),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IALVL),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_ILOC),
+    FIELD_SLOT(nitf_ImageSubheader, NITF_IMAG)
+};
+
+static const FieldSlot BAND[] =
+{
+    FIELD_SLOT(nitf_BandInfo, NITF_IREPBAND),
+    FIELD_SLOT(nitf_BandInfo, NITF_ISUBCAT),
+    FIELD_SLOT(nitf_BandInfo, NITF_IFC),
+    FIELD_SLOT(nitf_BandInfo, NITF_IMFLT),
+    FIELD_SLOT(nitf_BandInfo, NITF_NLUTS)
+};
+
+static const FieldSlot GRAPHIC_BEFORE_SECURITY[] =
+{
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SY),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SID),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SNAME),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SSCLAS)
+};
+
+static const FieldSlot GRAPHIC_AFTER_SECURITY[] =
+{
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_ENCRYP),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SFMT),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SSTRUCT),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SDLVL),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SALVL),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SLOC),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SBND1),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SCOLOR),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SBND2),
+    FIELD_SLOT(nitf_GraphicSubheader, NITF_SRES2)
+};
+
+static const FieldSlot LABEL_BEFORE_SECURITY[] =
+{
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LA),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LID),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LSCLAS)
+};
+
+static const FieldSlot LABEL_AFTER_SECURITY[] =
+{
+    FIELD_SLOT(nitf_LabelSubheader, NITF_ENCRYP),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LFS),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LCW),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LCH),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LDLVL),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LALVL),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LLOCR),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LLOCC),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LTC),
+    FIELD_SLOT(nitf_LabelSubheader, NITF_LBC)
+};
+
+static const FieldSlot TEXT_BEFORE_SECURITY[] =
+{
+    FIELD_SLOT(nitf_TextSubheader, NITF_TE),
+    FIELD_SLOT(nitf_TextSubheader, NITF_TEXTID),
+    FIELD_SLOT(nitf_TextSubheader, NITF_TXTALVL),
+    FIELD_SLOT(nitf_TextSubheader, NITF_TXTDT),
+    FIELD_SLOT(nitf_TextSubheader, NITF_TXTITL),
+    FIELD_SLOT(nitf_TextSubheader, NITF_TSCLAS)
+};
+
+static const FieldSlot TEXT_AFTER_SECURITY[] =
+{
+    FIELD_SLOT(nitf_TextSubheader, NITF_ENCRYP),
+    FIELD_SLOT(nitf_TextSubheader, NITF_TXTFMT)
+};
+
+static const FieldSlot DE_BEFORE_SECURITY[] =
+{
+    FIELD_SLOT(nitf_DESubheader, NITF_DE),
+    FIELD_SLOT(nitf_DESubheader, NITF_DESTAG),
+    FIELD_SLOT(nitf_DESubheader, NITF_DESVER),
+    FIELD_SLOT(nitf_DESubheader, NITF_DESCLAS)
+};
+
+/*  DESOFLW and DESITEM are only there for overflow DESs; DESSHL alone  */
+/*  starts one in                                                       */
+static const FieldSlot DE_OVERFLOW[] =
+{
+    FIELD_SLOT(nitf_DESubheader, NITF_DESOFLW),
+    FIELD_SLOT(nitf_DESubheader, NITF_DESITEM),
+    FIELD_SLOT(nitf_DESubheader, NITF_DESSHL)
+};
+
+static const FieldSlot RE_BEFORE_SECURITY[] =
+{
+    FIELD_SLOT(nitf_RESubheader, NITF_RE),
+    FIELD_SLOT(nitf_RESubheader, NITF_RESTAG),
+    FIELD_SLOT(nitf_RESubheader, NITF_RESVER),
+    FIELD_SLOT(nitf_RESubheader, NITF_RESCLAS)
+};
+
+static const FieldSlot RE_AFTER_SECURITY[] =
+{
+    FIELD_SLOT(nitf_RESubheader, NITF_RESSHL)
+};
+
 NITFPRIV(nitf_BandInfo **) readBandInfo(nitf_Reader * reader,
                                         unsigned int nbands,
                                         nitf_Error * error);
 
-NITFPRIV(NITF_BOOL) readCorners(nitf_Reader * reader,
-                                nitf_ImageSubheader * subhdr,
-                                nitf_Version fver, nitf_Error * error);
+NITFPRIV(NITF_BOOL) hasCorners(const nitf_ImageSubheader * subhdr,
+                               nitf_Version fver);
 
 NITFPRIV(NITF_BOOL) readTRE(nitf_Reader * reader,
-                            nitf_Extensions * ext, nitf_Error * error);
+                            nitf_Extensions * ext, nitf_Uint32 * count,
+                            nitf_Error * error);
 
 NITFPRIV(NITF_BOOL) readField(nitf_Reader * reader,
                               char *fld, int length, nitf_Error * error);
@@ -154,6 +418,13 @@ NITFPRIV(NITF_BOOL) readField(nitf_Reader * reader,
 NITFPRIV(NITF_BOOL) readValue(nitf_Reader * reader,
                               nitf_Field * field,
                               int length, nitf_Error * error);
+
+NITFPRIV(NITF_BOOL) setValue(nitf_Field * field, const char *buf,
+                             int length, nitf_Error * error);
+
+NITFPRIV(char *) readBytes(nitf_Reader * reader, char *buf, size_t bufSize,
+                           size_t length, nitf_Error * error);
+
 NITFPRIV(NITF_BOOL) handleTRE(nitf_Reader * reader, nitf_Uint32 length,
                               nitf_TRE * tre, nitf_Error * error);
 
@@ -168,71 +439,93 @@ NITFPRIV(NITF_BOOL) readExtras(nitf_Reader * reader,
 /*  Reading the component info sections is not a big deal, but it does      */
 /*  suit us that we are interested in reuse.  This method may be            */
 /*  used for all component info sections, however, we must be handed the    */
-/*  offset size, which will require a front-end macro.  They are listed:    */
-/*  NITF_READ_IMAGE_INFO()                                                  */
-/*  NITF_READ_GRAPHICS_INFO()                                               */
-/*  NITF_READ_TEXT_INFO()                                                   */
-/*  NITF_READ_LABEL_INFO()                                                  */
-/*  NITF_READ_DATA_EXT_INFO()                                               */
-/*  NITF_READ_RESERVED_EXT_INFO()                                           */
+/*  offset size, which will require a front-end macro.  The number of       */
+/*  components has been read already, and the number that starts the next   */
+/*  section, if there is one, is read along with the lengths.               */
 /*                                                                          */
 /*  \param reader The reader object                                         */
-/*  \param ioHandle The IO handle                                           */
 /*  \param infoPtr A pointer to the componentInfo object to be populated    */
 /*  \param num A value representing the number of components that existed   */
 /*  \param subHdrSz Size of the field describing subheader length           */
 /*  \param dataSz Size of the field describing the data length              */
+/*  \param nextValue The number of components of the next section, or NULL */
 /*  \param error An error object to be populated on failure                 */
 /*  \return NITF_SUCCESS on success and 0 otherwise                         */
 NITFPRIV(NITF_BOOL) readComponentInfo(nitf_Reader * reader,
                                       nitf_ComponentInfo *** infoPtrPtr,
                                       nitf_Field * numValue,
                                       const int subHdrSz,
-                                      const int dataSz, nitf_Error * error)
+                                      const int dataSz,
+                                      nitf_Field * nextValue,
+                                      nitf_Error * error)
 {
     int i;
     int numComponents;          /* Total number of components */
-
-    /* Read the number of components */
-    TRY_READ_VALUE(reader, numValue, NITF_IVAL_SZ);
+    char stackBuf[NITF_READER_RUN_SIZE];
+    char *buf = NULL;
+    const char *p;
+    size_t length;
 
     /* Make sure it is a positive integer */
     NITF_TRY_GET_UINT32(numValue, &numComponents, error);
 
+    /*  The lengths, and the next count, in one read  */
+    length = (size_t) numComponents * (subHdrSz + dataSz) +
+        (nextValue ? NITF_IVAL_SZ : 0);
+    buf = readBytes(reader, stackBuf, sizeof(stackBuf), length, error);
+    if (!buf)
+        goto CATCH_ERROR;
+    p = buf;
+
     /*  Save ourselves some time if there is nothing in this section  */
     /*  NOTE: this should be the case for the label segment if NITF 2.1 */
     if (!numComponents)
     {
         *infoPtrPtr = NULL;
-        return NITF_SUCCESS;
     }
+    else
+    {
+        /*  Malloc enough space for N image info nodes  */
+        *infoPtrPtr = (nitf_ComponentInfo **)
+                      NITF_MALLOC(sizeof(nitf_ComponentInfo *) *
+                                  numComponents);
 
-    /*  Malloc enough space for N image info nodes  */
-    *infoPtrPtr = (nitf_ComponentInfo **)
-                  NITF_MALLOC(sizeof(nitf_ComponentInfo *) * numComponents);
+        if (!*infoPtrPtr)
+        {
+            nitf_Error_init(error,
+                            NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
 
-    if (!*infoPtrPtr)
-    {
-        nitf_Error_init(error,
-                        NITF_STRERROR(NITF_ERRNO),
-                        NITF_CTXT, NITF_ERR_MEMORY);
-        return NITF_FAILURE;
+        /*  Read the image info  */
+        for (i = 0; i < numComponents; i++)
+        {
+            (*infoPtrPtr)[i] = nitf_ComponentInfo_construct(subHdrSz,
+                               dataSz, error);
+            if (!(*infoPtrPtr)[i] ||
+                !setValue((*infoPtrPtr)[i]->lengthSubheader, p, subHdrSz,
+                          error) ||
+                !setValue((*infoPtrPtr)[i]->lengthData, p + subHdrSz, dataSz,
+                          error))
+            {
+                *infoPtrPtr = NULL;
+                goto CATCH_ERROR;
+            }
+            p += subHdrSz + dataSz;
+        }
     }
 
-    /*  Read the image info  */
-    for (i = 0; i < numComponents; i++)
-    {
-        (*infoPtrPtr)[i] = nitf_ComponentInfo_construct(subHdrSz,
-                           dataSz, error);
-        TRY_READ_VALUE(reader,
-                       (*infoPtrPtr)[i]->lengthSubheader, subHdrSz);
+    if (nextValue && !setValue(nextValue, p, NITF_IVAL_SZ, error))
+        goto CATCH_ERROR;
 
-        TRY_READ_VALUE(reader, (*infoPtrPtr)[i]->lengthData, dataSz);
-    }
+    if (buf != stackBuf)
+        NITF_FREE(buf);
     return NITF_SUCCESS;
 
 CATCH_ERROR:
-    *infoPtrPtr = NULL;
+    if (buf && buf != stackBuf)
+        NITF_FREE(buf);
     return NITF_FAILURE;
 }
 
@@ -261,155 +554,264 @@ CATCH_ERROR:
 }
 
 
-NITFPRIV(NITF_BOOL) readValue(nitf_Reader * reader,
-                              nitf_Field * field,
-                              int length, nitf_Error * error)
+/*  Reads length bytes into buf if they fit, or else into memory it  */
+/*  allocates, which the caller frees                                 */
+NITFPRIV(char *) readBytes(nitf_Reader * reader, char *buf, size_t bufSize,
+                           size_t length, nitf_Error * error)
 {
-    char *buf = (char *) NITF_MALLOC(length);
-    if (!buf)
+    char *bytes = buf;
+    if (length > bufSize)
     {
-        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                NITF_CTXT, NITF_ERR_MEMORY);
-        goto CATCH_ERROR;
+        bytes = (char *) NITF_MALLOC(length);
+        if (!bytes)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NULL;
+        }
     }
 
-    if (!readField(reader, buf, length, error))
-        goto CATCH_ERROR;
+    if (length > 0 && !readField(reader, bytes, (int) length, error))
+    {
+        if (bytes != buf)
+            NITF_FREE(bytes);
+        return NULL;
+    }
+    return bytes;
+}
+
 
+/*  Sets a field from the length bytes at buf, as they are in the file  */
+NITFPRIV(NITF_BOOL) setValue(nitf_Field * field, const char *buf,
+                             int length, nitf_Error * error)
+{
     /* first, check to see if we need to swap bytes */
-    if (field->type == NITF_BINARY)
+    if (field->type == NITF_BINARY && length == NITF_INT16_SZ)
     {
-        if (length == NITF_INT16_SZ)
-        {
-            nitf_Int16 int16 =
-                (nitf_Int16)NITF_NTOHS(*((nitf_Int16 *) buf));
-            if (!nitf_Field_setRawData(field,
-                    (NITF_DATA *) & int16, length, error))
-                goto CATCH_ERROR;
-        }
-        else if (length == NITF_INT32_SZ)
-        {
-            nitf_Int32 int32 =
-                (nitf_Int32)NITF_NTOHL(*((nitf_Int32 *) buf));
-            if (!nitf_Field_setRawData(field,
-                    (NITF_DATA *) & int32, length, error))
-                goto CATCH_ERROR;
-        }
-        else
-        {
-            /* TODO what to do??? 8 bit is ok, but what about 64? */
-            if (!nitf_Field_setRawData(field, (NITF_DATA *) buf, length, error))
-                goto CATCH_ERROR;
-        }
+        nitf_Int16 int16;
+        memcpy(&int16, buf, sizeof(int16));
+        int16 = (nitf_Int16)NITF_NTOHS(int16);
+        return nitf_Field_setRawData(field, (NITF_DATA *) & int16, length,
+                                     error);
     }
-    else
+    if (field->type == NITF_BINARY && length == NITF_INT32_SZ)
     {
-        if (!nitf_Field_setRawData(field, (NITF_DATA *) buf, length, error))
-            goto CATCH_ERROR;
+        nitf_Int32 int32;
+        memcpy(&int32, buf, sizeof(int32));
+        int32 = (nitf_Int32)NITF_NTOHL(int32);
+        return nitf_Field_setRawData(field, (NITF_DATA *) & int32, length,
+                                     error);
     }
 
-    NITF_FREE(buf);
-    return NITF_SUCCESS;
+    /* TODO what to do??? 8 bit is ok, but what about 64? */
+    return nitf_Field_setRawData(field, (NITF_DATA *) buf, length, error);
+}
 
-CATCH_ERROR:
-    if (buf) NITF_FREE(buf);
-    return NITF_FAILURE;
+
+NITFPRIV(NITF_BOOL) readValue(nitf_Reader * reader,
+                              nitf_Field * field,
+                              int length, nitf_Error * error)
+{
+    char stackBuf[NITF_READER_RUN_SIZE];
+    char *buf = readBytes(reader, stackBuf, sizeof(stackBuf),
+                          (size_t) length, error);
+    NITF_BOOL ok;
+
+    if (!buf)
+        return NITF_FAILURE;
+    ok = setValue(field, buf, length, error);
+    if (buf != stackBuf)
+        NITF_FREE(buf);
+    return ok;
 }
 
 
-/* This function reads the whole security section from a v2.0 (sub)header */
-NITFPRIV(NITF_BOOL) read20FileSecurity(nitf_Reader * reader,
-                                       nitf_FileSecurity * securityGroup,
-                                       nitf_Error * error)
+/*  Reads one run of fields after another, with a single read  */
+NITFPRIV(NITF_BOOL) readFieldRuns(nitf_Reader * reader,
+                                  const FieldRun * runs, int numRuns,
+                                  nitf_Error * error)
 {
-    /* NOTE: The sizes are different from those of 2.1 */
-    nitf_FileSecurity_resizeForVersion(securityGroup, NITF_VER_20, error);
+    char stackBuf[NITF_READER_RUN_SIZE];
+    char *buf;
+    const char *p;
+    size_t length = 0;
+    int i, j;
+
+    for (i = 0; i < numRuns; i++)
+        for (j = 0; j < runs[i].numSlots; j++)
+            length += runs[i].slots[j].length;
 
-    TRY_READ_VALUE(reader, securityGroup->NITF_CODE, NITF_CODE_20_SZ);
-    TRY_READ_VALUE(reader, securityGroup->NITF_CTLH, NITF_CTLH_20_SZ);
-    TRY_READ_VALUE(reader, securityGroup->NITF_REL, NITF_REL_20_SZ);
-    TRY_READ_VALUE(reader, securityGroup->NITF_CAUT, NITF_CAUT_20_SZ);
-    TRY_READ_VALUE(reader, securityGroup->NITF_CTLN, NITF_CTLN_20_SZ);
-    TRY_READ_VALUE(reader, securityGroup->NITF_DGDT, NITF_DGDT_20_SZ);
-    /* !!! fix century on date? */
+    buf = readBytes(reader, stackBuf, sizeof(stackBuf), length, error);
+    if (!buf)
+        return NITF_FAILURE;
 
-    if (!strncmp(securityGroup->NITF_DGDT->raw, "999998", 6))
+    p = buf;
+    for (i = 0; i < numRuns; i++)
     {
-        TRY_READ_VALUE(reader, securityGroup->NITF_CLTX, NITF_CLTX_20_SZ);
-        /* !!! fix century on date? */
+        for (j = 0; j < runs[i].numSlots; j++)
+        {
+            const FieldSlot *slot = &runs[i].slots[j];
+            nitf_Field *field = *(nitf_Field **)
+                ((char *) runs[i].owner + slot->offset);
+            if (!setValue(field, p, slot->length, error))
+            {
+                if (buf != stackBuf)
+                    NITF_FREE(buf);
+                return NITF_FAILURE;
+            }
+            p += slot->length;
+        }
     }
 
+    if (buf != stackBuf)
+        NITF_FREE(buf);
     return NITF_SUCCESS;
+}
 
-CATCH_ERROR:
-    return NITF_FAILURE;
+
+NITFPRIV(NITF_BOOL) readFieldRun(nitf_Reader * reader, void *owner,
+                                 const FieldSlot * slots, int numSlots,
+                                 nitf_Error * error)
+{
+    FieldRun run;
+    run.owner = owner;
+    run.slots = slots;
+    run.numSlots = numSlots;
+    return readFieldRuns(reader, &run, 1, error);
 }
 
 
-/*  This function reads the whole file security section     */
-/*  using the NITF_READ_FIELD() macro.  The macro takes  */
-/*  advantage of the naming conventions to read the         */
-/*  data with very little effort in calling.  If you        */
-/*  dont like this kind of abstraction, you are welcome     */
-/*  to be more rigorous and expand out the macro.           */
-NITFPRIV(NITF_BOOL) read21FileSecurity(nitf_Reader * reader,
-                                       nitf_FileSecurity * securityGroup,
-                                       nitf_Error * error)
+/*  This function reads the fields of a (sub)header that come before  */
+/*  its security section, the section, and the fields after it.  In   */
+/*  2.1 all of these have fixed lengths, so they are a single read;   */
+/*  in 2.0 the section ends with a field that only some DGDT values   */
+/*  have, so it takes up to three.                                    */
+NITFPRIV(NITF_BOOL) readSecuredRun(nitf_Reader * reader,
+                                   nitf_Version fver,
+                                   void *owner,
+                                   const FieldSlot * before, int numBefore,
+                                   nitf_FileSecurity * securityGroup,
+                                   const FieldSlot * after, int numAfter,
+                                   nitf_Error * error)
 {
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_CLSY);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_CODE);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_CTLH);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_REL);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_DCTP);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_DCDT);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_DCXM);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_DG);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_DGDT);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_CLTX);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_CATP);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_CAUT);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_CRSN);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_RDT);
-    TRY_READ_MEMBER_VALUE(reader, securityGroup, NITF_CTLN);
+    FieldRun runs[3];
 
-    return NITF_SUCCESS;
+    runs[0].owner = owner;
+    runs[0].slots = before;
+    runs[0].numSlots = numBefore;
+    runs[1].owner = securityGroup;
+    runs[2].owner = owner;
+    runs[2].slots = after;
+    runs[2].numSlots = numAfter;
 
-CATCH_ERROR:
+    if (IS_NITF21(fver))
+    {
+        runs[1].slots = SECURITY_21;
+        runs[1].numSlots = NUM_SLOTS(SECURITY_21);
+        return readFieldRuns(reader, runs, 3, error);
+    }
+
+    if (IS_NITF20(fver))
+    {
+        nitf_FileSecurity_resizeForVersion(securityGroup, NITF_VER_20, error);
+        runs[1].slots = SECURITY_20;
+        runs[1].numSlots = NUM_SLOTS(SECURITY_20);
+        if (!readFieldRuns(reader, runs, 2, error))
+            return NITF_FAILURE;
+
+        /* !!! fix century on date? */
+        if (!strncmp(securityGroup->NITF_DGDT->raw, "999998", 6) &&
+            !readValue(reader, securityGroup->NITF_CLTX, NITF_CLTX_20_SZ,
+                       error))
+            return NITF_FAILURE;
+
+        return readFieldRuns(reader, &runs[2], 1, error);
+    }
+
+    /* Invalid NITF Version (We had better never get here) */
+    nitf_Error_init(error, "Invalid NITF Version",
+                    NITF_CTXT, NITF_ERR_INVALID_FILE);
     return NITF_FAILURE;
 }
 
 
-/* This function reads a security section */
-NITFPRIV(NITF_BOOL) readFileSecurity(nitf_Reader * reader,
-                                     nitf_Version fver,
-                                     nitf_FileSecurity * securityGroup,
-                                     nitf_Error * error)
+NITFPRIV(void) clearSkipped(nitf_Reader * reader)
 {
-    if (IS_NITF20(fver))
+    while (!nitf_List_isEmpty(reader->skipped))
     {
-        if (!read20FileSecurity(reader, securityGroup, error))
-            goto CATCH_ERROR;
+        nitf_SkippedItem *item =
+            (nitf_SkippedItem *) nitf_List_popFront(reader->skipped);
+        NITF_FREE(item);
     }
-    else if (IS_NITF21(fver))
+}
+
+
+/*  Notes where length bytes start and steps over them  */
+NITFPRIV(NITF_BOOL) skipItem(nitf_Reader * reader, nitf_SkippedType type,
+                             int index, nitf_Uint32 length,
+                             nitf_SkippedItem ** item, nitf_Error * error)
+{
+    nitf_SkippedItem *skipped =
+        (nitf_SkippedItem *) NITF_MALLOC(sizeof(nitf_SkippedItem));
+    if (!skipped)
     {
-        if (!read21FileSecurity(reader, securityGroup, error))
-            goto CATCH_ERROR;
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
     }
-    else
+    memset(skipped, 0, sizeof(nitf_SkippedItem));
+    skipped->type = type;
+    skipped->index = index;
+    skipped->length = length;
+
+    skipped->offset = nitf_IOInterface_tell(reader->input, error);
+    if (!NITF_IO_SUCCESS(skipped->offset) ||
+        !nitf_List_pushBack(reader->skipped, skipped, error))
     {
-        /* Invalid NITF Version (We had better never get here) */
-        nitf_Error_init(error, "Invalid NITF Version",
-                        NITF_CTXT, NITF_ERR_INVALID_FILE);
-        goto CATCH_ERROR;
+        NITF_FREE(skipped);
+        return NITF_FAILURE;
     }
+    if (item)
+        *item = skipped;
 
-    return NITF_SUCCESS;
+    return NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input,
+                                                 skipped->offset + length,
+                                                 NITF_SEEK_SET, error));
+}
+
+
+/*  Steps over a segment subheader the parse options leave out  */
+NITFPRIV(NITF_BOOL) skipSubheader(nitf_Reader * reader,
+                                  nitf_SkippedType type, int index,
+                                  nitf_Field * lengthField,
+                                  nitf_Error * error)
+{
+    nitf_Uint32 length;
+
+    NITF_TRY_GET_UINT32(lengthField, &length, error);
+    return skipItem(reader, type, index, length, NULL, error);
 
 CATCH_ERROR:
     return NITF_FAILURE;
 }
 
 
+NITFPRIV(NITF_BOOL) wantTRE(nitf_Reader * reader, const char *tag)
+{
+    const char **tags = reader->parseOptions.treTags;
+    NITF_BOOL listed = 0;
+
+    if (reader->parseOptions.treFilter == NITF_PARSE_TRES_ALL)
+        return 1;
+
+    for (; tags && *tags && !listed; ++tags)
+        listed = strcmp(*tags, tag) == 0;
+
+    return reader->parseOptions.treFilter == NITF_PARSE_TRES_ALLOW ?
+        listed : !listed;
+}
+
+
 NITFPRIV(void) resetIOInterface(nitf_Reader * reader)
 {
     if (reader->input && reader->ownInput)
@@ -433,6 +835,7 @@ NITFAPI(nitf_Reader *) nitf_Reader_construct(nitf_Error * error)
         return NULL;
     }
 
+    reader->skipped = NULL;
     reader->warningList = nitf_List_construct(error);
     if (!reader->warningList)
     {
@@ -440,9 +843,20 @@ NITFAPI(nitf_Reader *) nitf_Reader_construct(nitf_Error * error)
         return NULL;
     }
 
+    reader->skipped = nitf_List_construct(error);
+    if (!reader->skipped)
+    {
+        nitf_Reader_destruct(&reader);
+        return NULL;
+    }
+
     reader->record = NULL;
     reader->input = NULL;
     reader->ownInput = 0;
+    reader->lazyTREs = 0;
+    reader->useArena = 0;
+    reader->index = NULL;
+    nitf_ParseOptions_init(&reader->parseOptions);
     resetIOInterface(reader);
 
     /*  Return our results  */
@@ -472,6 +886,11 @@ NITFAPI(void) nitf_Reader_destruct(nitf_Reader ** reader)
             }
             nitf_List_destruct(&(*reader)->warningList);
         }
+        if ((*reader)->skipped)
+        {
+            clearSkipped(*reader);
+            nitf_List_destruct(&(*reader)->skipped);
+        }
         /*
            if ((*reader)->imageReaderPool)
            {
@@ -510,69 +929,78 @@ NITFPRIV(NITF_BOOL) readImageSubheader(nitf_Reader * reader,
                                        nitf_Error * error)
 {
     unsigned int i;
+    nitf_ImageSegment *segment;
     nitf_ImageSubheader *subhdr;
-    /* List iterator pointing to the image segment */
-    nitf_ListIterator listIter = nitf_List_begin(reader->record->images);
 
     nitf_Uint32 numComments;    /* Number of comment fields */
     nitf_Uint32 nbands;         /* An integer representing the \nbands field */
     nitf_Uint32 xbands;         /* An integer representing the xbands field */
-
-    for (i = 0; i < imageIndex; i++)
-        nitf_ListIterator_increment(&listIter);
+    char comments[NITF_ICOM_SZ * 9 + NITF_IC_SZ];
 
     /* image sub-header object */
-    subhdr =
-        ((nitf_ImageSegment *) nitf_ListIterator_get(&listIter))->
-        subheader;
+    segment = nitf_Record_getImageSegment(reader->record, imageIndex, error);
+    if (!segment)
+        goto CATCH_ERROR;
+    subhdr = segment->subheader;
 
     /* If this isn't IM, is there something we can do? */
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IM);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IID1);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IDATIM);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_TGTID);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IID2);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ISCLAS);
-
-    /* Read the security group */
-    if (!readFileSecurity(reader, fver, subhdr->securityGroup, error))
+    /* Everything up to and including ICORDS */
+    if (!readSecuredRun(reader, fver, subhdr,
+                        IMAGE_BEFORE_SECURITY,
+                        NUM_SLOTS(IMAGE_BEFORE_SECURITY),
+                        subhdr->securityGroup,
+                        IMAGE_AFTER_SECURITY,
+                        NUM_SLOTS(IMAGE_AFTER_SECURITY), error))
         goto CATCH_ERROR;
 
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ENCRYP);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ISORCE);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NROWS);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NCOLS);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_PVTYPE);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IREP);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ICAT);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ABPP);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_PJUST);
-
-    /* Read the ICORDS and IGEOLO segments  */
-    if (!readCorners(reader, subhdr, fver, error))
-        goto CATCH_ERROR;
+    /* The IGEOLO segment, if ICORDS says there is one, and NICOM */
+    if (hasCorners(subhdr, fver))
+    {
+        TRY_READ_RUN(reader, subhdr, IMAGE_CORNERS, 2);
+    }
+    else
+    {
+        TRY_READ_RUN(reader, subhdr, &IMAGE_CORNERS[1], 1);
+    }
 
-    /*  Figure out how many comments we have  */
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NICOM);
+    /*  Figure out how many comments we have, and read them with IC  */
     NITF_TRY_GET_UINT32(subhdr->numImageComments, &numComments, error);
+    if (numComments > 9)
+    {
+        nitf_Error_init(error, "Invalid number of image comments",
+                        NITF_CTXT, NITF_ERR_PARSING_FILE);
+        goto CATCH_ERROR;
+    }
+    if (!readField(reader, comments, numComments * NITF_ICOM_SZ + NITF_IC_SZ,
+                   error))
+        goto CATCH_ERROR;
     for (i = 0; i < numComments; i++)
     {
         nitf_Field* commentField = nitf_Field_construct(
                                        NITF_ICOM_SZ, NITF_BCS_A, error);
         if (!commentField) goto CATCH_ERROR;
-        TRY_READ_VALUE(reader, commentField, NITF_ICOM_SZ);
+        if (!setValue(commentField, comments + i * NITF_ICOM_SZ,
+                      NITF_ICOM_SZ, error))
+        {
+            nitf_Field_destruct(&commentField);
+            goto CATCH_ERROR;
+        }
         nitf_List_pushBack(subhdr->imageComments, commentField, error);
     }
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IC);
+    if (!setValue(subhdr->NITF_IC, comments + numComments * NITF_ICOM_SZ,
+                  NITF_IC_SZ, error))
+        goto CATCH_ERROR;
 
+    /*  COMRAT, if the image is compressed, and how many bands  */
     if (strncmp(subhdr->NITF_IC->raw, "NC", 2) != 0 &&
             strncmp(subhdr->NITF_IC->raw, "NM", 2) != 0)
     {
-
-        TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_COMRAT);
+        TRY_READ_RUN(reader, subhdr, IMAGE_COMPRESSION, 2);
+    }
+    else
+    {
+        TRY_READ_RUN(reader, subhdr, &IMAGE_COMPRESSION[1], 1);
     }
-    /*  Figure out how many bands  */
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NBANDS);
     xbands = 0;
 
     /*  In NITF versions before 2.1, the number of bands was a single
@@ -602,17 +1030,7 @@ NITFPRIV(NITF_BOOL) readImageSubheader(nitf_Reader * reader,
     }
 
     /*  Afer we have read the band info, things are cool again for a bit  */
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ISYNC);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IMODE);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NBPR);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NBPC);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NPPBH);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NPPBV);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_NBPP);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IDLVL);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IALVL);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ILOC);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IMAG);
+    TRY_READ_RUN(reader, subhdr, IMAGE_BLOCKING, NUM_SLOTS(IMAGE_BLOCKING));
 
     /* Read the userd efined image data */
     TRY_READ_UDID(reader, imageIndex, subhdr);
@@ -632,37 +1050,24 @@ NITFPRIV(NITF_BOOL) readGraphicSubheader(nitf_Reader * reader,
         nitf_Version fver,
         nitf_Error * error)
 {
-    int i;
+    nitf_GraphicSegment *segment;
     nitf_GraphicSubheader *subhdr;
 
-    /* List iterator pointing to the graphics segment */
-    nitf_ListIterator listIter = nitf_List_begin(reader->record->graphics);
-    for (i = 0; i < graphicIndex; i++)
-        nitf_ListIterator_increment(&listIter);
-
     /* graphics sub-header object */
-    subhdr = ((nitf_GraphicSegment *)
-              nitf_ListIterator_get(&listIter))->subheader;
-
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SY);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SID);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SNAME);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SSCLAS);
-
-    /* Read the security section */
-    if (!readFileSecurity(reader, fver, subhdr->securityGroup, error))
+    segment = nitf_Record_getGraphicSegment(reader->record, graphicIndex,
+                                            error);
+    if (!segment)
         goto CATCH_ERROR;
+    subhdr = segment->subheader;
 
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ENCRYP);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SFMT);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SSTRUCT);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SDLVL);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SALVL);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SLOC);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SBND1);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SCOLOR);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SBND2);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_SRES2);
+    /* Everything up to the extended header section */
+    if (!readSecuredRun(reader, fver, subhdr,
+                        GRAPHIC_BEFORE_SECURITY,
+                        NUM_SLOTS(GRAPHIC_BEFORE_SECURITY),
+                        subhdr->securityGroup,
+                        GRAPHIC_AFTER_SECURITY,
+                        NUM_SLOTS(GRAPHIC_AFTER_SECURITY), error))
+        goto CATCH_ERROR;
 
     /* Read the extended header info section */
     TRY_READ_SXSHD(reader, graphicIndex, subhdr);
@@ -680,38 +1085,23 @@ NITFPRIV(NITF_BOOL) readLabelSubheader(nitf_Reader * reader,
                                        nitf_Version fver,
                                        nitf_Error * error)
 {
-    int i;
+    nitf_LabelSegment *segment;
     nitf_LabelSubheader *subhdr;
 
-    /* List iterator pointing to the label segment */
-    nitf_ListIterator listIter = nitf_List_begin(reader->record->labels);
-    for (i = 0; i < labelIndex; i++)
-        nitf_ListIterator_increment(&listIter);
-
     /* label sub-header object */
-    subhdr =
-        ((nitf_LabelSegment *) nitf_ListIterator_get(&listIter))->
-        subheader;
-
-    /* nitf_Uint32 lxshdl, lxsofl; */
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LA);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LID);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LSCLAS);
-
-    /* Read the security group */
-    if (!readFileSecurity(reader, fver, subhdr->securityGroup, error))
+    segment = nitf_Record_getLabelSegment(reader->record, labelIndex, error);
+    if (!segment)
         goto CATCH_ERROR;
+    subhdr = segment->subheader;
 
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ENCRYP);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LFS);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LCW);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LCH);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LDLVL);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LALVL);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LLOCR);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LLOCC);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LTC);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_LBC);
+    /* Everything up to the extended header section */
+    if (!readSecuredRun(reader, fver, subhdr,
+                        LABEL_BEFORE_SECURITY,
+                        NUM_SLOTS(LABEL_BEFORE_SECURITY),
+                        subhdr->securityGroup,
+                        LABEL_AFTER_SECURITY,
+                        NUM_SLOTS(LABEL_AFTER_SECURITY), error))
+        goto CATCH_ERROR;
 
     /* Read the extended header info section */
     TRY_READ_LXSHD(reader, labelIndex, subhdr);
@@ -729,31 +1119,23 @@ NITFPRIV(NITF_BOOL) readTextSubheader(nitf_Reader * reader,
                                       nitf_Version fver,
                                       nitf_Error * error)
 {
-    int i;
+    nitf_TextSegment *segment;
     nitf_TextSubheader *subhdr;
 
-    /* List iterator pointing to the text segment */
-    nitf_ListIterator listIter = nitf_List_begin(reader->record->texts);
-    for (i = 0; i < textIndex; i++)
-        nitf_ListIterator_increment(&listIter);
-
     /* text sub-header object */
-    subhdr =
-        ((nitf_TextSegment *) nitf_ListIterator_get(&listIter))->subheader;
-
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_TE);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_TEXTID);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_TXTALVL);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_TXTDT);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_TXTITL);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_TSCLAS);
-
-    /* Read the security group */
-    if (!readFileSecurity(reader, fver, subhdr->securityGroup, error))
+    segment = nitf_Record_getTextSegment(reader->record, textIndex, error);
+    if (!segment)
         goto CATCH_ERROR;
+    subhdr = segment->subheader;
 
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ENCRYP);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_TXTFMT);
+    /* Everything up to the extended header section */
+    if (!readSecuredRun(reader, fver, subhdr,
+                        TEXT_BEFORE_SECURITY,
+                        NUM_SLOTS(TEXT_BEFORE_SECURITY),
+                        subhdr->securityGroup,
+                        TEXT_AFTER_SECURITY,
+                        NUM_SLOTS(TEXT_AFTER_SECURITY), error))
+        goto CATCH_ERROR;
 
     /* Read the extended header info section */
     TRY_READ_TXSHD(reader, textIndex, subhdr);
@@ -770,31 +1152,25 @@ NITFPRIV(NITF_BOOL) readDESubheader(nitf_Reader * reader,
                                     int desIndex,
                                     nitf_Version fver, nitf_Error * error)
 {
-    int i;
     nitf_DESegment *segment;
     nitf_DESubheader *subhdr;
     /* Length of the sub-header */
     nitf_Uint32 subLen;
     nitf_Off currentOffset;
     char desID[NITF_DESTAG_SZ + 1];     /* DES ID string */
-
-    nitf_ListIterator listIter =
-        nitf_List_begin(reader->record->dataExtensions);
-
-    for (i = 0; i < desIndex; i++)
-        nitf_ListIterator_increment(&listIter);
+    nitf_Uint32 treCount = 0;           /* TREs read into the section */
 
     /* get the correct objects */
-    segment = (nitf_DESegment *) nitf_ListIterator_get(&listIter);
+    segment = nitf_Record_getDataExtensionSegment(reader->record, desIndex,
+                                                  error);
+    if (!segment)
+        goto CATCH_ERROR;
     subhdr = segment->subheader;
 
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_DE);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_DESTAG);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_DESVER);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_DESCLAS);
-
-    /* Read the security group */
-    if (!readFileSecurity(reader, fver, subhdr->securityGroup, error))
+    /* Everything up to the end of the security group */
+    if (!readSecuredRun(reader, fver, subhdr,
+                        DE_BEFORE_SECURITY, NUM_SLOTS(DE_BEFORE_SECURITY),
+                        subhdr->securityGroup, NULL, 0, error))
         goto CATCH_ERROR;
 
     /* get the DESID and trim it */
@@ -802,21 +1178,28 @@ NITFPRIV(NITF_BOOL) readDESubheader(nitf_Reader * reader,
                    desID, NITF_CONV_STRING, NITF_DESTAG_SZ + 1, error);
     nitf_Field_trimString(desID);
 
-    /* read the two conditional fields if TRE_OVERFLOW */
+    /* read the two conditional fields if TRE_OVERFLOW, and the */
+    /* subheaderfields length */
     if ((IS_NITF20(fver) && ((strcmp(desID, "Registered Extensions") == 0) ||
                             (strcmp(desID, "Controlled Extensions") == 0))) ||
             (IS_NITF21(fver) && strcmp(desID, "TRE_OVERFLOW") == 0))
     {
-        TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_DESOFLW);
-        TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_DESITEM);
+        TRY_READ_RUN(reader, subhdr, DE_OVERFLOW, 3);
+    }
+    else
+    {
+        TRY_READ_RUN(reader, subhdr, &DE_OVERFLOW[2], 1);
     }
-
-    /* get the subheaderfields length */
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_DESSHL);
 
     /* Verify that it is a UINT */
     NITF_TRY_GET_UINT32(subhdr->NITF_DESSHL, &subLen, error);
-    if (subLen > 0)
+    if (subLen > 0 && reader->parseOptions.skipDEUserHeaders)
+    {
+        if (!skipItem(reader, NITF_SKIPPED_DE_USER_HEADER, desIndex, subLen,
+                      NULL, error))
+            goto CATCH_ERROR;
+    }
+    else if (subLen > 0)
     {
         /*  We know our constraints, so build up the tre object  */
         subhdr->subheaderFields = nitf_TRE_createSkeleton(desID, error);
@@ -848,7 +1231,8 @@ NITFPRIV(NITF_BOOL) readDESubheader(nitf_Reader * reader,
         while (currentOffset < segment->end)
         {
             /* read a TRE */
-            if (!readTRE(reader, subhdr->userDefinedSection, error))
+            if (!readTRE(reader, subhdr->userDefinedSection, &treCount,
+                         error))
                 goto CATCH_ERROR;
 
             /* update the offset */
@@ -879,32 +1263,24 @@ NITFPRIV(NITF_BOOL) readRESubheader(nitf_Reader * reader,
                                     int resIndex,
                                     nitf_Version fver, nitf_Error * error)
 {
-    int i;
     nitf_RESegment *segment;
     nitf_RESubheader *subhdr;
     nitf_Uint32 subLen;
-    /* List iterator pointing to the reserved extension segment */
-    nitf_ListIterator listIter =
-        nitf_List_begin(reader->record->reservedExtensions);
-
-    for (i = 0; i < resIndex; i++)
-        nitf_ListIterator_increment(&listIter);
 
     /* RE  objects */
-    segment = (nitf_RESegment *) nitf_ListIterator_get(&listIter);
+    segment = nitf_Record_getReservedExtensionSegment(reader->record,
+                                                      resIndex, error);
+    if (!segment)
+        goto CATCH_ERROR;
     subhdr = segment->subheader;
 
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_RE);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_RESTAG);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_RESVER);
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_RESCLAS);
-
-    /* Read the security group */
-    if (!readFileSecurity(reader, fver, subhdr->securityGroup, error))
+    /* Everything up to the subheader fields length */
+    if (!readSecuredRun(reader, fver, subhdr,
+                        RE_BEFORE_SECURITY, NUM_SLOTS(RE_BEFORE_SECURITY),
+                        subhdr->securityGroup,
+                        RE_AFTER_SECURITY, NUM_SLOTS(RE_AFTER_SECURITY),
+                        error))
         goto CATCH_ERROR;
-
-    /* get the subheader fields length */
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_RESSHL);
     NITF_TRY_GET_UINT32(subhdr->subheaderFieldsLength, &subLen, error);
     if (subLen > 0)
     {
@@ -955,8 +1331,8 @@ NITFPRIV(NITF_BOOL) readHeader(nitf_Reader * reader, nitf_Error * error)
     char fileLenBuf[NITF_FL_SZ + 1];    /* File length buffer */
     char streamingBuf[NITF_FL_SZ];
 
-    /* FHDR */
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FHDR);
+    /* FHDR and FVER */
+    TRY_READ_RUN(reader, fileHeader, HEADER_ID, NUM_SLOTS(HEADER_ID));
     if ((strncmp(fileHeader->NITF_FHDR->raw, "NITF", 4) != 0)
             && (strncmp(fileHeader->NITF_FHDR->raw, "NSIF", 4) != 0))
     {
@@ -966,9 +1342,6 @@ NITFPRIV(NITF_BOOL) readHeader(nitf_Reader * reader, nitf_Error * error)
         goto CATCH_ERROR;
     }
 
-    /* FVER */
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FVER);
-
     fver = nitf_Record_getVersion(reader->record);
     if (!IS_NITF20(fver) && !IS_NITF21(fver))
     {
@@ -978,40 +1351,33 @@ NITFPRIV(NITF_BOOL) readHeader(nitf_Reader * reader, nitf_Error * error)
         goto CATCH_ERROR;
     }
 
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_CLEVEL);
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_STYPE);
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_OSTAID);
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FDT);
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FTITLE);
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FSCLAS);
-
-    if (!readFileSecurity(reader, fver, fileHeader->securityGroup, error))
-        goto CATCH_ERROR;
-
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FSCOP);
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FSCPYS);
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_ENCRYP);
-
-    /* In 2.0 there wasn't a FBKGC field, so we resize ONAME and read */
+    /* Everything from CLEVEL up to NUMI */
     if (IS_NITF20(fver))
     {
+        /* In 2.0 there wasn't a FBKGC field, so we resize ONAME */
         if (!nitf_Field_resetLength(fileHeader->NITF_ONAME,
                                     NITF_FBKGC_SZ + NITF_ONAME_SZ, 0, error))
             goto CATCH_ERROR;
 
-        if (!readValue(reader, fileHeader->NITF_ONAME,
-                       NITF_FBKGC_SZ + NITF_ONAME_SZ, error))
+        if (!readSecuredRun(reader, fver, fileHeader,
+                            HEADER_BEFORE_SECURITY,
+                            NUM_SLOTS(HEADER_BEFORE_SECURITY),
+                            fileHeader->securityGroup,
+                            HEADER_AFTER_SECURITY_20,
+                            NUM_SLOTS(HEADER_AFTER_SECURITY_20), error))
             goto CATCH_ERROR;
     }
     else
     {
-        TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FBKGC);
-        TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_ONAME);
+        if (!readSecuredRun(reader, fver, fileHeader,
+                            HEADER_BEFORE_SECURITY,
+                            NUM_SLOTS(HEADER_BEFORE_SECURITY),
+                            fileHeader->securityGroup,
+                            HEADER_AFTER_SECURITY_21,
+                            NUM_SLOTS(HEADER_AFTER_SECURITY_21), error))
+            goto CATCH_ERROR;
     }
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_OPHONE);
 
-    /* FL */
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FL);
     /* Check for streaming header (Length is all 9's) */
     memset(streamingBuf, '9', NITF_FL_SZ);
 
@@ -1025,39 +1391,43 @@ NITFPRIV(NITF_BOOL) readHeader(nitf_Reader * reader, nitf_Error * error)
     }
 
     /* HL */
-    TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_HL);
     NITF_TRY_GET_UINT32(fileHeader->NITF_HL, &num32, error);
 
     /* Read the image info section */
     TRY_READ_COMPONENT(reader,
                        &fileHeader->imageInfo,
-                       fileHeader->NITF_NUMI, NITF_LISH_SZ, NITF_LI_SZ);
+                       fileHeader->NITF_NUMI, NITF_LISH_SZ, NITF_LI_SZ,
+                       fileHeader->NITF_NUMS);
 
     /* Read the graphic info section */
     TRY_READ_COMPONENT(reader,
                        &fileHeader->graphicInfo,
-                       fileHeader->NITF_NUMS, NITF_LSSH_SZ, NITF_LS_SZ);
+                       fileHeader->NITF_NUMS, NITF_LSSH_SZ, NITF_LS_SZ,
+                       fileHeader->NITF_NUMX);
 
     /* Read the label info section */
     TRY_READ_COMPONENT(reader,
                        &fileHeader->labelInfo,
-                       fileHeader->NITF_NUMX, NITF_LLSH_SZ, NITF_LL_SZ);
+                       fileHeader->NITF_NUMX, NITF_LLSH_SZ, NITF_LL_SZ,
+                       fileHeader->NITF_NUMT);
 
     /* Read the text info section */
     TRY_READ_COMPONENT(reader,
                        &fileHeader->textInfo,
-                       fileHeader->NITF_NUMT, NITF_LTSH_SZ, NITF_LT_SZ);
+                       fileHeader->NITF_NUMT, NITF_LTSH_SZ, NITF_LT_SZ,
+                       fileHeader->NITF_NUMDES);
 
     /* Read the data extension info section */
     TRY_READ_COMPONENT(reader,
                        &fileHeader->dataExtensionInfo,
-                       fileHeader->NITF_NUMDES, NITF_LDSH_SZ, NITF_LD_SZ);
+                       fileHeader->NITF_NUMDES, NITF_LDSH_SZ, NITF_LD_SZ,
+                       fileHeader->NITF_NUMRES);
 
     /* Read the reserved extension info section */
     TRY_READ_COMPONENT(reader,
                        &fileHeader->reservedExtensionInfo,
                        fileHeader->NITF_NUMRES,
-                       NITF_LRESH_SZ, NITF_LRE_SZ);
+                       NITF_LRESH_SZ, NITF_LRE_SZ, NULL);
 
     /* Read the user header info section */
     TRY_READ_UDHD(reader);
@@ -1089,6 +1459,8 @@ NITFPRIV(NITF_BOOL) readExtras(nitf_Reader * reader,
     nitf_Off sectionEndOffset;
     /* The current io offset */
     nitf_Off currentOffset;
+    /* TREs read into ext */
+    nitf_Uint32 treCount = 0;
 
     /* Read the total length of the "extras" section */
     TRY_READ_VALUE(reader, totalLengthValue, 5);
@@ -1109,9 +1481,10 @@ NITFPRIV(NITF_BOOL) readExtras(nitf_Reader * reader,
 
         while (currentOffset < sectionEndOffset)
         {
-            if (!readTRE(reader, ext, error))
+            if (!readTRE(reader, ext, &treCount, error))
             {
                 nitf_FieldWarning *fieldWarning;
+                NITF_BOOL warned;
                 /* Get the current offset */
                 currentOffset = nitf_IOInterface_tell(reader->input,
                                                       error);
@@ -1126,15 +1499,15 @@ NITFPRIV(NITF_BOOL) readExtras(nitf_Reader * reader,
                                                 NULL,
                                                 "Not properly formed",
                                                 error);
-                if (fieldWarning == NULL)
-                    goto CATCH_ERROR;
 
                 /* Append the warning to the list */
-                if (!nitf_List_pushBack
-                        (reader->warningList, fieldWarning, error))
-                {
+                warned = fieldWarning &&
+                    nitf_List_pushBack(reader->warningList, fieldWarning,
+                                       error);
+                if (fieldWarning && !warned)
+                    nitf_FieldWarning_destruct(&fieldWarning);
+                if (!warned)
                     goto CATCH_ERROR;
-                }
 
                 /* Skip the remaining TRE's */
                 currentOffset =
@@ -1160,8 +1533,14 @@ CATCH_ERROR:
 }
 
 
+/*
+ *  Reads a TRE into ext, or notes where it is if it is filtered out.
+ *  count is how many TREs ext has had so far, skipped ones included, and
+ *  goes up by one unless there is an error.
+ */
 NITFPRIV(NITF_BOOL) readTRE(nitf_Reader * reader,
                             nitf_Extensions * ext,
+                            nitf_Uint32 * count,
                             nitf_Error * error)
 {
     /* character array for the tag */
@@ -1192,6 +1571,19 @@ NITFPRIV(NITF_BOOL) readTRE(nitf_Reader * reader,
     TRY_READ_VALUE(reader, lengthValue, NITF_EL_SZ);
     NITF_TRY_GET_UINT32(lengthValue, &length, error);
 
+    /*  Filtered out TREs are only noted  */
+    if (!wantTRE(reader, etag))
+    {
+        nitf_SkippedItem *item;
+        nitf_Field_destruct(&lengthValue);
+        if (!skipItem(reader, NITF_SKIPPED_TRE, -1, length, &item, error))
+            return NITF_FAILURE;
+        strcpy(item->tag, etag);
+        item->extensions = ext;
+        item->ordinal = (*count)++;
+        return NITF_SUCCESS;
+    }
+
     /*  We know our constraints, so build up the tre object  */
     tre = nitf_TRE_createSkeleton(etag, error);
     if (!tre)
@@ -1208,6 +1600,7 @@ NITFPRIV(NITF_BOOL) readTRE(nitf_Reader * reader,
     nitf_Field_destruct(&lengthValue);
     lengthValue = NULL;
 
+    (*count)++;
     return NITF_SUCCESS;
 
 CATCH_ERROR:
@@ -1221,86 +1614,33 @@ CATCH_ERROR:
 NITFPRIV(NITF_BOOL) handleTRE(nitf_Reader * reader, nitf_Uint32 length,
                               nitf_TRE * tre, nitf_Error * error)
 {
-    int ok = 0;
-    int bad = 0;
-    nitf_Off off;
-
-    nitf_TREHandler* handler = NULL;
-
-    nitf_PluginRegistry *reg = nitf_PluginRegistry_getInstance(error);
-    if (reg)
-    {
-        handler = nitf_PluginRegistry_retrieveTREHandler(reg, tre->tag,
-                                                         &bad, error);
-        if (bad)
-            goto CATCH_ERROR;
-        if (handler)
-        {
-            tre->handler = handler;
-            off = nitf_IOInterface_tell(reader->input, error);
-
-    	    ok = handler->read(reader->input, length, tre,
-    	            reader->record, error);
-            if (!ok)
-            {
-                /* move the IO back the size of the TRE */
-                nitf_IOInterface_seek(reader->input, off, NITF_SEEK_SET, error);
-            }
-        }
-    }
-
-    /* if we couldn't parse it with the plug-in OR if no plug-in is found,
-     * then, we use the default TRE handler */
-    if (!ok || handler == NULL)
+    /* in lazy mode just keep the bytes; the plug-in runs on first use */
+    if (reader->lazyTREs)
     {
-        tre->handler = nitf_DefaultTRE_handler(error);
-		ok = tre->handler->read(reader->input, length, tre,
-                                        reader->record, error);
+        tre->handler = nitf_LazyTRE_handler(error);
+        return tre->handler->read(reader->input, length, tre,
+                                  reader->record, error);
     }
 
-    if (!ok)
-        goto CATCH_ERROR;
-
-    /* no problems */
-    return NITF_SUCCESS;
-
-CATCH_ERROR:
-    return NITF_FAILURE;
+    return nitf_TRE_parse(tre, reader->input, length, reader->record, error);
 }
 
 
-NITFPRIV(NITF_BOOL) readCorners(nitf_Reader * reader,
-                                nitf_ImageSubheader * subhdr,
-                                nitf_Version fver, nitf_Error * error)
+/*  Whether ICORDS says that an IGEOLO follows  */
+NITFPRIV(NITF_BOOL) hasCorners(const nitf_ImageSubheader * subhdr,
+                               nitf_Version fver)
 {
-
-    TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_ICORDS);
-
-    if ((IS_NITF20(fver) &&
+    return (IS_NITF20(fver) &&
             (subhdr->NITF_ICORDS->raw[0] == 'U' ||
              subhdr->NITF_ICORDS->raw[0] == 'G' ||
              subhdr->NITF_ICORDS->raw[0] == 'C'))
-            ||
-            ((IS_NITF21(fver) &&
-              (subhdr->NITF_ICORDS->raw[0] == 'U' ||
-               subhdr->NITF_ICORDS->raw[0] == 'G' ||
-               subhdr->NITF_ICORDS->raw[0] == 'N' ||
-               subhdr->NITF_ICORDS->raw[0] == 'S' ||
-               subhdr->NITF_ICORDS->raw[0] == 'D'))))
-    {
-        TRY_READ_MEMBER_VALUE(reader, subhdr, NITF_IGEOLO);
-    }
-    else
-    {
-        /*printf("Note to programmer: there was no IGEOLO place in the file\n"); */
-    }
-
-    return NITF_SUCCESS;
-
-CATCH_ERROR:
-
-    return NITF_FAILURE;
-
+           ||
+           (IS_NITF21(fver) &&
+            (subhdr->NITF_ICORDS->raw[0] == 'U' ||
+             subhdr->NITF_ICORDS->raw[0] == 'G' ||
+             subhdr->NITF_ICORDS->raw[0] == 'N' ||
+             subhdr->NITF_ICORDS->raw[0] == 'S' ||
+             subhdr->NITF_ICORDS->raw[0] == 'D'));
 }
 
 
@@ -1331,12 +1671,7 @@ NITFPRIV(nitf_BandInfo **) readBandInfo(nitf_Reader * reader,
     /*  Now pick up our precious band info  */
     for (i = 0; i < nbands; i++)
     {
-        TRY_READ_MEMBER_VALUE(reader, bandInfo[i], NITF_IREPBAND);
-        TRY_READ_MEMBER_VALUE(reader, bandInfo[i], NITF_ISUBCAT);
-        TRY_READ_MEMBER_VALUE(reader, bandInfo[i], NITF_IFC);
-        TRY_READ_MEMBER_VALUE(reader, bandInfo[i], NITF_IMFLT);
-
-        TRY_READ_MEMBER_VALUE(reader, bandInfo[i], NITF_NLUTS);
+        TRY_READ_RUN(reader, bandInfo[i], BAND, NUM_SLOTS(BAND));
         NITF_TRY_GET_UINT32(bandInfo[i]->NITF_NLUTS, &numLuts, error);
         if (numLuts > 0)
         {
@@ -1365,6 +1700,165 @@ CATCH_ERROR:
 }
 
 
+NITFAPI(void) nitf_Reader_setLazyTREs(nitf_Reader * reader,
+                                      NITF_BOOL enable)
+{
+    reader->lazyTREs = enable ? 1 : 0;
+}
+
+
+NITFAPI(void) nitf_Reader_setUseArena(nitf_Reader * reader,
+                                      NITF_BOOL enable)
+{
+    reader->useArena = enable ? 1 : 0;
+}
+
+
+NITFAPI(void) nitf_Reader_setIndex(nitf_Reader * reader,
+                                   nitf_RecordIndex * index)
+{
+    reader->index = index;
+}
+
+
+NITFAPI(void) nitf_ParseOptions_init(nitf_ParseOptions * options)
+{
+    options->segments = NITF_PARSE_ALL;
+    options->treFilter = NITF_PARSE_TRES_ALL;
+    options->treTags = NULL;
+    options->skipDEUserHeaders = 0;
+}
+
+
+NITFAPI(void) nitf_Reader_setParseOptions(nitf_Reader * reader,
+                                          const nitf_ParseOptions * options)
+{
+    if (options)
+        reader->parseOptions = *options;
+    else
+        nitf_ParseOptions_init(&reader->parseOptions);
+}
+
+
+/*
+ *  Puts a TRE that was skipped back where it was read from: after as
+ *  many TREs as went before it, less those still skipped.
+ */
+NITFPRIV(NITF_BOOL) insertSkippedTRE(nitf_Reader * reader,
+                                     nitf_SkippedItem * item,
+                                     nitf_TRE * tre,
+                                     nitf_Error * error)
+{
+    nitf_ListIterator iter = nitf_List_begin(reader->skipped);
+    nitf_ListIterator end = nitf_List_end(reader->skipped);
+    nitf_ExtensionsIterator at = nitf_Extensions_begin(item->extensions);
+    nitf_ExtensionsIterator last = nitf_Extensions_end(item->extensions);
+    nitf_Uint32 position = item->ordinal;
+
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_SkippedItem *other =
+            (nitf_SkippedItem *) nitf_ListIterator_get(&iter);
+        if (other->type == NITF_SKIPPED_TRE &&
+            other->extensions == item->extensions &&
+            other->ordinal < item->ordinal)
+            position--;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    while (position-- > 0 && nitf_ExtensionsIterator_notEqualTo(&at, &last))
+        nitf_ExtensionsIterator_increment(&at);
+    return nitf_Extensions_insert(item->extensions, &at, tre, error);
+}
+
+
+NITFAPI(NITF_BOOL) nitf_Reader_parseSkipped(nitf_Reader * reader,
+                                            nitf_SkippedItem * item,
+                                            nitf_Error * error)
+{
+    nitf_ParseOptions saved = reader->parseOptions;
+    nitf_ListIterator iter = nitf_List_begin(reader->skipped);
+    nitf_ListIterator end = nitf_List_end(reader->skipped);
+    nitf_Version fver;
+    nitf_DESegment *deSegment;
+    nitf_TRE *tre = NULL;
+    char desID[NITF_DESTAG_SZ + 1];
+    NITF_BOOL ok = NITF_FAILURE;
+
+    while (nitf_ListIterator_notEqualTo(&iter, &end) &&
+           nitf_ListIterator_get(&iter) != item)
+        nitf_ListIterator_increment(&iter);
+
+    if (!nitf_ListIterator_notEqualTo(&iter, &end) || !reader->record ||
+        !reader->input)
+    {
+        nitf_Error_init(error, "Not an item skipped by the last read",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input, item->offset,
+                                               NITF_SEEK_SET, error)))
+        return NITF_FAILURE;
+
+    /*  Whatever it is, parse all of it this time  */
+    nitf_ParseOptions_init(&reader->parseOptions);
+    fver = nitf_Record_getVersion(reader->record);
+
+    switch (item->type)
+    {
+    case NITF_SKIPPED_IMAGE:
+        ok = readImageSubheader(reader, item->index, fver, error);
+        break;
+    case NITF_SKIPPED_GRAPHIC:
+        ok = readGraphicSubheader(reader, item->index, fver, error);
+        break;
+    case NITF_SKIPPED_LABEL:
+        ok = readLabelSubheader(reader, item->index, fver, error);
+        break;
+    case NITF_SKIPPED_TEXT:
+        ok = readTextSubheader(reader, item->index, fver, error);
+        break;
+    case NITF_SKIPPED_DE:
+        ok = readDESubheader(reader, item->index, fver, error);
+        break;
+    case NITF_SKIPPED_RE:
+        ok = readRESubheader(reader, item->index, fver, error);
+        break;
+    case NITF_SKIPPED_TRE:
+        tre = nitf_TRE_createSkeleton(item->tag, error);
+        ok = tre && handleTRE(reader, item->length, tre, error) &&
+             insertSkippedTRE(reader, item, tre, error);
+        if (!ok && tre)
+            nitf_TRE_destruct(&tre);
+        break;
+    case NITF_SKIPPED_DE_USER_HEADER:
+        deSegment = (nitf_DESegment *)
+            nitf_List_get(reader->record->dataExtensions, item->index, error);
+        if (!deSegment)
+            break;
+        nitf_Field_get(deSegment->subheader->NITF_DESTAG, desID,
+                       NITF_CONV_STRING, NITF_DESTAG_SZ + 1, error);
+        nitf_Field_trimString(desID);
+        tre = nitf_TRE_createSkeleton(desID, error);
+        ok = tre && handleTRE(reader, item->length, tre, error);
+        if (ok)
+            deSegment->subheader->subheaderFields = tre;
+        else if (tre)
+            nitf_TRE_destruct(&tre);
+        break;
+    }
+
+    reader->parseOptions = saved;
+    if (!ok)
+        return NITF_FAILURE;
+
+    nitf_List_remove(reader->skipped, &iter);
+    NITF_FREE(item);
+    return NITF_SUCCESS;
+}
+
+
 NITFAPI(nitf_Record *) nitf_Reader_read(nitf_Reader * reader,
                                         nitf_IOHandle ioHandle,
                                         nitf_Error * error)
@@ -1391,6 +1885,10 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
     nitf_Uint32 length32;
     nitf_Uint64 length;
     nitf_Version fver;
+    nitf_IOInterface* buffered = NULL;
+    nitf_Off offset;
+
+    clearSkipped(reader);
 
     reader->record = nitf_Record_construct(NITF_VER_21, error);
     if (!reader->record)
@@ -1399,11 +1897,33 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
         return NULL;
     }
 
+    /*  The TREs the record holds are parsed into its own arena  */
+    if (reader->useArena)
+    {
+        reader->record->arena = nitf_Arena_construct(0, error);
+        if (!reader->record->arena)
+        {
+            nitf_Record_destruct(&reader->record);
+            return NULL;
+        }
+    }
+
     resetIOInterface(reader);
     reader->input = io;
     if (!reader->input)
         goto CATCH_ERROR;
 
+    /*  If the IO is being measured, file the parse under header   */
+    nitf_IOStatsAdapter_setTag(io, "header");
+
+    /*  Parse through a read buffer, so that the many small field  */
+    /*  reads cost a memcpy each rather than a system call         */
+    buffered = nitf_BufferedAdapter_construct(io, NITF_READER_BUFFER_SIZE,
+                                              0, error);
+    if (!buffered)
+        goto CATCH_ERROR;
+    reader->input = buffered;
+
     /*  This part is trivial thanks to our readHeader accessor  */
     if (!readHeader(reader, error))
         goto CATCH_ERROR;
@@ -1421,15 +1941,22 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
 
         /* Push it onto the back of the list of segments */
-        if (!nitf_List_pushBack(reader->record->images,
-                                (NITF_DATA *) imageSegment, error))
+        if (!nitf_Record_appendSegment(reader->record,
+                                       reader->record->images,
+                                       (NITF_DATA *) imageSegment, error))
         {
             nitf_ImageSegment_destruct(&imageSegment);
             goto CATCH_ERROR;
         }
 
-        /* Read the sub-header */
-        if (!readImageSubheader(reader, i, fver, error))
+        /* Read the sub-header, or just step over it */
+        if (reader->parseOptions.segments & NITF_PARSE_IMAGES)
+        {
+            if (!readImageSubheader(reader, i, fver, error))
+                goto CATCH_ERROR;
+        }
+        else if (!skipSubheader(reader, NITF_SKIPPED_IMAGE, i,
+                                reader->record->header->NITF_LISH(i), error))
             goto CATCH_ERROR;
 
         /* Allocate an IO object */
@@ -1465,14 +1992,21 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
 
         /* Push it onto the back of the list of segments */
-        if (!nitf_List_pushBack(reader->record->graphics,
-                                (NITF_DATA *) graphicSegment, error))
+        if (!nitf_Record_appendSegment(reader->record,
+                                       reader->record->graphics,
+                                       (NITF_DATA *) graphicSegment, error))
         {
             nitf_GraphicSegment_destruct(&graphicSegment);
             goto CATCH_ERROR;
         }
 
-        if (!readGraphicSubheader(reader, i, fver, error))
+        if (reader->parseOptions.segments & NITF_PARSE_GRAPHICS)
+        {
+            if (!readGraphicSubheader(reader, i, fver, error))
+                goto CATCH_ERROR;
+        }
+        else if (!skipSubheader(reader, NITF_SKIPPED_GRAPHIC, i,
+                                reader->record->header->NITF_LSSH(i), error))
             goto CATCH_ERROR;
         graphicSegment->offset = nitf_IOInterface_tell(reader->input,
                                                        error);
@@ -1503,14 +2037,21 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
 
         /* Push it onto the back of the list of segments */
-        if (!nitf_List_pushBack(reader->record->labels,
-                                (NITF_DATA *) labelSegment, error))
+        if (!nitf_Record_appendSegment(reader->record,
+                                       reader->record->labels,
+                                       (NITF_DATA *) labelSegment, error))
         {
             nitf_LabelSegment_destruct(&labelSegment);
             goto CATCH_ERROR;
         }
 
-        if (!readLabelSubheader(reader, i, fver, error))
+        if (reader->parseOptions.segments & NITF_PARSE_LABELS)
+        {
+            if (!readLabelSubheader(reader, i, fver, error))
+                goto CATCH_ERROR;
+        }
+        else if (!skipSubheader(reader, NITF_SKIPPED_LABEL, i,
+                                reader->record->header->NITF_LLSH(i), error))
             goto CATCH_ERROR;
         labelSegment->offset = nitf_IOInterface_tell(reader->input,
                                                      error);
@@ -1539,14 +2080,21 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
 
         /* Push it onto the back of the list of segments */
-        if (!nitf_List_pushBack(reader->record->texts,
-                                (NITF_DATA *) textSegment, error))
+        if (!nitf_Record_appendSegment(reader->record,
+                                       reader->record->texts,
+                                       (NITF_DATA *) textSegment, error))
         {
             nitf_TextSegment_destruct(&textSegment);
             goto CATCH_ERROR;
         }
 
-        if (!readTextSubheader(reader, i, fver, error))
+        if (reader->parseOptions.segments & NITF_PARSE_TEXTS)
+        {
+            if (!readTextSubheader(reader, i, fver, error))
+                goto CATCH_ERROR;
+        }
+        else if (!skipSubheader(reader, NITF_SKIPPED_TEXT, i,
+                                reader->record->header->NITF_LTSH(i), error))
             goto CATCH_ERROR;
         textSegment->offset = nitf_IOInterface_tell(reader->input,
                                                     error);
@@ -1577,15 +2125,36 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
 
         /* Push it onto the back of the list of segments */
-        if (!nitf_List_pushBack(reader->record->dataExtensions,
-                                (NITF_DATA *) deSegment, error))
+        if (!nitf_Record_appendSegment(reader->record,
+                                       reader->record->dataExtensions,
+                                       (NITF_DATA *) deSegment, error))
         {
             nitf_DESegment_destruct(&deSegment);
             goto CATCH_ERROR;
         }
 
-        if (!readDESubheader(reader, i, fver, error))
-            goto CATCH_ERROR;
+        if (reader->parseOptions.segments & NITF_PARSE_DES)
+        {
+            if (!readDESubheader(reader, i, fver, error))
+                goto CATCH_ERROR;
+        }
+        else
+        {
+            if (!skipSubheader(reader, NITF_SKIPPED_DE, i,
+                               reader->record->header->NITF_LDSH(i), error))
+                goto CATCH_ERROR;
+
+            NITF_TRY_GET_UINT64(reader->record->header->NITF_LD(i),
+                                &deSegment->subheader->dataLength, error);
+            deSegment->offset = nitf_IOInterface_tell(reader->input, error);
+            deSegment->end = deSegment->offset +
+                deSegment->subheader->dataLength;
+            if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input,
+                                                       deSegment->end,
+                                                       NITF_SEEK_SET,
+                                                       error)))
+                goto CATCH_ERROR;
+        }
 
         /* readDESubheader takes care of zooming/reading the DES Data */
         /* if it is a TRE_OVERFLOW, it reads it, so we can't always skip it */
@@ -1601,15 +2170,31 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
 
         /* Push it onto the back of the list of segments */
-        if (!nitf_List_pushBack(reader->record->reservedExtensions,
-                                (NITF_DATA *) reSegment, error))
+        if (!nitf_Record_appendSegment(reader->record,
+                                       reader->record->reservedExtensions,
+                                       (NITF_DATA *) reSegment, error))
         {
             nitf_RESegment_destruct(&reSegment);
             goto CATCH_ERROR;
         }
 
-        if (!readRESubheader(reader, i, fver, error))
-            goto CATCH_ERROR;
+        if (reader->parseOptions.segments & NITF_PARSE_RES)
+        {
+            if (!readRESubheader(reader, i, fver, error))
+                goto CATCH_ERROR;
+        }
+        else
+        {
+            if (!skipSubheader(reader, NITF_SKIPPED_RE, i,
+                               reader->record->header->NITF_LRESH(i), error))
+                goto CATCH_ERROR;
+
+            NITF_TRY_GET_UINT64(reader->record->header->NITF_LRE(i),
+                                &reSegment->subheader->dataLength, error);
+            reSegment->offset = nitf_IOInterface_tell(reader->input, error);
+            reSegment->end = reSegment->offset +
+                reSegment->subheader->dataLength;
+        }
 
         /*  Now, we zoom to the end of the RES, so we can pick up  */
         /*  afterward.                                               */
@@ -1622,9 +2207,24 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
         }
     }
 
+    /*  Hand back the real interface, where the parse left off  */
+    offset = nitf_IOInterface_tell(buffered, error);
+    reader->input = io;
+    nitf_IOInterface_destruct(&buffered);
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io, offset, NITF_SEEK_SET,
+                                               error)))
+        goto CATCH_ERROR;
+    nitf_IOStatsAdapter_setTag(io, NULL);
+
     return reader->record;
 
 CATCH_ERROR:
+    if (buffered)
+    {
+        reader->input = io;
+        nitf_IOInterface_destruct(&buffered);
+    }
+    nitf_IOStatsAdapter_setTag(io, NULL);
     nitf_Record_destruct(&reader->record);
     resetIOInterface(reader);
     return NULL;
@@ -1732,18 +2332,82 @@ NITFPRIV(nitf_ImageIO *) allocIO(nitf_ImageSegment * segment,
 }
 
 
+/*
+ *  The offsets interface of the plugin that decompresses a segment, or
+ *  NULL if it has none
+ */
+NITFPRIV(const nitf_DecompressionOffsetsInterface *)
+getDecompOffsets(nitf_ImageSegment * segment)
+{
+    char compBuf[NITF_IC_SZ + 1];
+    nitf_PluginRegistry *reg;
+    NITF_PLUGIN_DECOMPRESSION_OFFSETS_FUNCTION offsets;
+    nitf_Error error;
+
+    if (!nitf_Field_get(segment->subheader->NITF_IC, compBuf,
+                        NITF_CONV_STRING, NITF_IC_SZ + 1, &error))
+        return NULL;
+    reg = nitf_PluginRegistry_getInstance(&error);
+    if (!reg)
+        return NULL;
+    offsets = nitf_PluginRegistry_retrieveDecompOffsets(reg, compBuf);
+    if (offsets == NULL)
+        return NULL;
+    return (const nitf_DecompressionOffsetsInterface *)
+        (*offsets) (compBuf, &error);
+}
+
+
+/*
+ *  Lays out an image from the reader's index, or lays it out now and adds
+ *  it to the index.  A layout that will not fit is replaced.
+ */
+NITFPRIV(NITF_BOOL) useIndex(nitf_Reader * reader,
+                             nitf_ImageReader * imageReader,
+                             nitf_ImageSegment * segment,
+                             nitf_Error * error)
+{
+    nitf_Uint32 number = (nitf_Uint32) imageReader->segmentNumber;
+    nitf_Uint64 length = segment->imageEnd - segment->imageOffset;
+    const nitf_DecompressionOffsetsInterface *offsets;
+    const nitf_ImageLayout *cached;
+    nitf_ImageLayout *layout;
+    nitf_Error ignored;
+
+    offsets = getDecompOffsets(segment);
+    cached = nitf_RecordIndex_getImage(reader->index, number,
+                                       segment->imageOffset, length);
+    if (cached && nitf_ImageIO_setLayout(imageReader->imageDeblocker,
+                                         cached, offsets, &ignored))
+        return NITF_SUCCESS;
+
+    layout = nitf_ImageIO_getLayout(imageReader->imageDeblocker,
+                                    reader->input, offsets, error);
+    if (!layout)
+        return NITF_FAILURE;
+    return nitf_RecordIndex_setImage(reader->index, number,
+                                     segment->imageOffset, length, layout,
+                                     error);
+}
+
+
 NITFAPI(nitf_ImageReader *) nitf_Reader_newImageReader(
         nitf_Reader * reader,
         int imageSegmentNumber,
         nrt_HashTable * options,
         nitf_Error * error)
 {
-    int i;
-    nitf_ListIterator iter;
-    nitf_ListIterator end;
-    nitf_ImageSegment *segment = NULL;
-    nitf_ImageReader *imageReader =
-        (nitf_ImageReader *) NITF_MALLOC(sizeof(nitf_ImageReader));
+    nitf_ImageSegment *segment;
+    nitf_ImageReader *imageReader;
+
+    /*  Important, this is starting at zero  */
+    segment = nitf_Record_getImageSegment(reader->record,
+                                          (nitf_Uint32) imageSegmentNumber,
+                                          error);
+    if (!segment)
+        return NULL;
+
+    imageReader = (nitf_ImageReader *) NITF_MALLOC(sizeof(nitf_ImageReader));
     if (!imageReader)
     {
         nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
@@ -1751,28 +2415,6 @@ NITFAPI(nitf_ImageReader *) nitf_Reader_newImageReader(
         return NULL;
     }
 
-    iter = nitf_List_begin(reader->record->images);
-    end = nitf_List_end(reader->record->images);
-
-    /*  Important, this is starting at zero  */
-    for (i = 0; i <= imageSegmentNumber; i++)
-    {
-        segment = (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
-        /*  We have expired without finding the segment  */
-        /*  they are talking about, so throw something at them  */
-        if (nitf_ListIterator_equals(&iter, &end))
-        {
-            nitf_Error_initf(error,
-                             NITF_CTXT,
-                             NITF_ERR_INVALID_OBJECT,
-                             "Index [%d] is not a valid image segment",
-                             imageSegmentNumber);
-            nitf_ImageReader_destruct(&imageReader);
-            return NULL;
-        }
-        nitf_ListIterator_increment(&iter);
-    }
-
     imageReader->input = reader->input;
     imageReader->imageDeblocker = allocIO(segment, options, error);
     if (!imageReader->imageDeblocker)
@@ -1780,17 +2422,14 @@ NITFAPI(nitf_ImageReader *) nitf_Reader_newImageReader(
         nitf_ImageReader_destruct(&imageReader);
         return NULL;
     }
-    if (segment == NULL)
+    imageReader->directBlockRead = 0;
+    imageReader->segmentNumber = imageSegmentNumber;
+
+    if (reader->index && !useIndex(reader, imageReader, segment, error))
     {
-        nitf_Error_initf(error,
-                         NITF_CTXT,
-                         NITF_ERR_INVALID_OBJECT,
-                         "Index [%d] is not a valid image segment",
-                         imageSegmentNumber);
         nitf_ImageReader_destruct(&imageReader);
         return NULL;
     }
-    imageReader->directBlockRead = 0;
     return imageReader;
 }
 
@@ -1799,27 +2438,13 @@ NITFAPI(nitf_SegmentReader *) nitf_Reader_newTextReader
 (nitf_Reader * reader, int textSegmentNumber, nitf_Error * error)
 {
     nitf_SegmentReader *textReader;     /* The result */
-    nitf_ListIterator iter;     /* Iterators to used find segment in list */
-    nitf_ListIterator end;
     nitf_TextSegment *text;     /* Associated DE segment */
-    int i;
 
     /*    Find the associated segment */
-    text = NULL;
-    iter = nitf_List_begin(reader->record->texts);
-    end = nitf_List_end(reader->record->texts);
-    for (i = 0; i <= textSegmentNumber; i++)
-    {
-        text = (nitf_TextSegment *) nitf_ListIterator_get(&iter);
-        if (nitf_ListIterator_equals(&iter, &end))
-        {
-            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
-                             "Index [%d] is not a valid Text segment",
-                             textSegmentNumber);
-            return NULL;
-        }
-        nitf_ListIterator_increment(&iter);
-    }
+    text = nitf_Record_getTextSegment(reader->record,
+                                      (nitf_Uint32) textSegmentNumber, error);
+    if (!text)
+        return NULL;
 
     /*    Allocate the object */
     textReader =
@@ -1845,21 +2470,13 @@ NITFAPI(nitf_SegmentReader *) nitf_Reader_newGraphicReader
 (nitf_Reader * reader, int index, nitf_Error * error)
 {
     nitf_SegmentReader *segmentReader;
-    nitf_ListIterator iter;
-    nitf_ListIterator end;
-    nitf_GraphicSegment *segment = NULL;
+    nitf_GraphicSegment *segment;
 
     /*    Find the associated segment */
-    iter = nitf_List_at(reader->record->graphics, index);
-    end = nitf_List_end(reader->record->graphics);
-    if (nitf_ListIterator_equals(&iter, &end))
-    {
-        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
-                         "Index [%d] is not a valid Graphic segment",
-                         index);
+    segment = nitf_Record_getGraphicSegment(reader->record,
+                                            (nitf_Uint32) index, error);
+    if (!segment)
         return NULL;
-    }
-    segment = (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
 
     /*    Allocate the object */
     segmentReader =
@@ -1886,21 +2503,13 @@ NITFAPI(nitf_SegmentReader *) nitf_Reader_newDEReader(nitf_Reader *reader,
                                                       nitf_Error * error)
 {
     nitf_SegmentReader *segmentReader;
-    nitf_ListIterator iter;
-    nitf_ListIterator end;
-    nitf_DESegment *segment = NULL;
+    nitf_DESegment *segment;
 
     /*    Find the associated segment */
-    iter = nitf_List_at(reader->record->dataExtensions, index);
-    end = nitf_List_end(reader->record->dataExtensions);
-    if (nitf_ListIterator_equals(&iter, &end))
-    {
-        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
-                         "Index [%d] is not a valid Graphic segment",
-                         index);
+    segment = nitf_Record_getDataExtensionSegment(reader->record,
+                                                  (nitf_Uint32) index, error);
+    if (!segment)
         return NULL;
-    }
-    segment = (nitf_DESegment *) nitf_ListIterator_get(&iter);
 
     /*    Allocate the object */
     segmentReader =
@@ -144,6 +144,281 @@ NITFAPI(nitf_Uint32) nitf_Record_getNumImages(const nitf_Record* record,
 }
 
 
+/*
+ *  Starts an index off empty.
+ */
+NITFPRIV(void) initIndex(nitf_SegmentIndex* index)
+{
+    index->segments = NULL;
+    index->size = 0;
+    index->capacity = 0;
+}
+
+
+/*
+ *  Releases an index's memory.
+ */
+NITFPRIV(void) freeIndex(nitf_SegmentIndex* index)
+{
+    if (index->segments)
+        NITF_FREE(index->segments);
+    initIndex(index);
+}
+
+
+/*
+ *  Returns the record's index of the given segment list, or NULL if the
+ *  list is not one of the record's.
+ */
+NITFPRIV(nitf_SegmentIndex*) indexOf(nitf_Record* record, nitf_List* segments)
+{
+    if (segments == record->images)
+        return &record->imageIndex;
+    if (segments == record->graphics)
+        return &record->graphicIndex;
+    if (segments == record->labels)
+        return &record->labelIndex;
+    if (segments == record->texts)
+        return &record->textIndex;
+    if (segments == record->dataExtensions)
+        return &record->dataExtensionIndex;
+    if (segments == record->reservedExtensions)
+        return &record->reservedExtensionIndex;
+    return NULL;
+}
+
+
+/*
+ *  Makes room in an index for one more segment.
+ */
+NITFPRIV(NITF_BOOL) growIndex(nitf_SegmentIndex* index, nitf_Error* error)
+{
+    NITF_DATA** segments;
+    nitf_Uint32 capacity;
+
+    if (index->size < index->capacity)
+        return NITF_SUCCESS;
+
+    capacity = index->capacity ? index->capacity * 2 : 8;
+    segments = (NITF_DATA**) NITF_REALLOC(index->segments,
+                                          sizeof(NITF_DATA*) * capacity);
+    if (!segments)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    index->segments = segments;
+    index->capacity = capacity;
+    return NITF_SUCCESS;
+}
+
+
+/*
+ *  Takes the segment at the given position out of an index, moving the
+ *  ones after it down, as nitf_List_remove does with the list.
+ */
+NITFPRIV(void) unindexSegment(nitf_SegmentIndex* index, nitf_Uint32 position)
+{
+    if (position >= index->size)
+        return;
+    memmove(index->segments + position, index->segments + position + 1,
+            sizeof(NITF_DATA*) * (index->size - position - 1));
+    --index->size;
+}
+
+
+/*
+ *  Moves the segment at oldIndex of an index to newIndex, shifting the ones
+ *  in between, as nitf_List_move does with the list.
+ */
+NITFPRIV(void) moveIndexed(nitf_SegmentIndex* index,
+                           nitf_Uint32 oldIndex,
+                           nitf_Uint32 newIndex)
+{
+    NITF_DATA* moved;
+
+    if (oldIndex >= index->size || newIndex >= index->size)
+        return;
+    moved = index->segments[oldIndex];
+    if (oldIndex < newIndex)
+        memmove(index->segments + oldIndex, index->segments + oldIndex + 1,
+                sizeof(NITF_DATA*) * (newIndex - oldIndex));
+    else
+        memmove(index->segments + newIndex + 1, index->segments + newIndex,
+                sizeof(NITF_DATA*) * (oldIndex - newIndex));
+    index->segments[newIndex] = moved;
+}
+
+
+/*
+ *  Indexes every segment list of the record from scratch, as after the
+ *  lists have been cloned.
+ */
+NITFPRIV(NITF_BOOL) indexSegments(nitf_Record* record, nitf_Error* error)
+{
+    nitf_List* lists[6];
+    int i;
+
+    lists[0] = record->images;
+    lists[1] = record->graphics;
+    lists[2] = record->labels;
+    lists[3] = record->texts;
+    lists[4] = record->dataExtensions;
+    lists[5] = record->reservedExtensions;
+
+    for (i = 0; i < 6; ++i)
+    {
+        nitf_SegmentIndex* index = indexOf(record, lists[i]);
+        nitf_ListIterator iter = nitf_List_begin(lists[i]);
+        nitf_ListIterator end = nitf_List_end(lists[i]);
+
+        index->size = 0;
+        while (nitf_ListIterator_notEqualTo(&iter, &end))
+        {
+            if (!growIndex(index, error))
+                return NITF_FAILURE;
+            index->segments[index->size++] = nitf_ListIterator_get(&iter);
+            nitf_ListIterator_increment(&iter);
+        }
+    }
+    return NITF_SUCCESS;
+}
+
+
+/*
+ *  An index is only trusted while its ends match the list's, so that a
+ *  list pushed onto or popped from directly is walked rather than read
+ *  wrongly.
+ */
+NITFPRIV(NITF_BOOL) isIndexCurrent(const nitf_List* segments,
+                                   const nitf_SegmentIndex* index)
+{
+    if (!segments)
+        return 0;
+    if (index->size == 0)
+        return segments->first == NULL;
+    return segments->first && segments->last &&
+           segments->first->data == index->segments[0] &&
+           segments->last->data == index->segments[index->size - 1];
+}
+
+
+NITFPROT(NITF_BOOL) nitf_Record_appendSegment(nitf_Record* record,
+                                              nitf_List* segments,
+                                              NITF_DATA* segment,
+                                              nitf_Error* error)
+{
+    nitf_SegmentIndex* index = indexOf(record, segments);
+
+    if (!index)
+    {
+        nitf_Error_init(error, "Not one of the record's segment lists",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+    if (!growIndex(index, error))
+        return NITF_FAILURE;
+    if (!nitf_List_pushBack(segments, segment, error))
+        return NITF_FAILURE;
+    index->segments[index->size++] = segment;
+    return NITF_SUCCESS;
+}
+
+
+/*
+ *  Looks a segment up by index, without walking the list if the record's
+ *  index of it is current.
+ */
+NITFPRIV(NITF_DATA*) getSegment(nitf_List* segments,
+                                const nitf_SegmentIndex* index,
+                                nitf_Uint32 position,
+                                const char* type,
+                                nitf_Error* error)
+{
+    NITF_DATA* segment = NULL;
+
+    if (isIndexCurrent(segments, index))
+    {
+        if (position < index->size)
+            segment = index->segments[position];
+    }
+    else if ((int) position >= 0)
+        segment = nitf_List_get(segments, (int) position, error);
+
+    if (!segment)
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                         "Index [%u] is not a valid %s segment",
+                         position, type);
+    return segment;
+}
+
+
+NITFAPI(nitf_ImageSegment*)
+nitf_Record_getImageSegment(const nitf_Record* record,
+                            nitf_Uint32 index,
+                            nitf_Error* error)
+{
+    return (nitf_ImageSegment*) getSegment(record->images,
+                                           &record->imageIndex, index,
+                                           "image", error);
+}
+
+
+NITFAPI(nitf_GraphicSegment*)
+nitf_Record_getGraphicSegment(const nitf_Record* record,
+                              nitf_Uint32 index,
+                              nitf_Error* error)
+{
+    return (nitf_GraphicSegment*) getSegment(record->graphics,
+                                             &record->graphicIndex, index,
+                                             "graphic", error);
+}
+
+
+NITFAPI(nitf_LabelSegment*)
+nitf_Record_getLabelSegment(const nitf_Record* record,
+                            nitf_Uint32 index,
+                            nitf_Error* error)
+{
+    return (nitf_LabelSegment*) getSegment(record->labels,
+                                           &record->labelIndex, index,
+                                           "label", error);
+}
+
+
+NITFAPI(nitf_TextSegment*) nitf_Record_getTextSegment(const nitf_Record* record,
+                                                      nitf_Uint32 index,
+                                                      nitf_Error* error)
+{
+    return (nitf_TextSegment*) getSegment(record->texts,
+                                          &record->textIndex, index,
+                                          "text", error);
+}
+
+
+NITFAPI(nitf_DESegment*)
+nitf_Record_getDataExtensionSegment(const nitf_Record* record,
+                                    nitf_Uint32 index,
+                                    nitf_Error* error)
+{
+    return (nitf_DESegment*) getSegment(record->dataExtensions,
+                                        &record->dataExtensionIndex, index,
+                                        "data extension", error);
+}
+
+
+NITFAPI(nitf_RESegment*)
+nitf_Record_getReservedExtensionSegment(const nitf_Record* record,
+                                        nitf_Uint32 index,
+                                        nitf_Error* error)
+{
+    return (nitf_RESegment*) getSegment(record->reservedExtensions,
+                                        &record->reservedExtensionIndex,
+                                        index, "reserved extension", error);
+}
+
+
 /*
  * addOverflowSegment adds a (DE) overflow section
  *
@@ -597,6 +872,13 @@ NITFAPI(nitf_Record *) nitf_Record_construct(nitf_Version version,
     record->texts = NULL;
     record->dataExtensions = NULL;
     record->reservedExtensions = NULL;
+    record->arena = NULL;
+    initIndex(&record->imageIndex);
+    initIndex(&record->graphicIndex);
+    initIndex(&record->labelIndex);
+    initIndex(&record->textIndex);
+    initIndex(&record->dataExtensionIndex);
+    initIndex(&record->reservedExtensionIndex);
 
     /*
      * This block does the children creations
@@ -678,6 +960,13 @@ NITFAPI(nitf_Record *) nitf_Record_clone(const nitf_Record * source,
     record->texts = NULL;
     record->dataExtensions = NULL;
     record->reservedExtensions = NULL;
+    record->arena = NULL;
+    initIndex(&record->imageIndex);
+    initIndex(&record->graphicIndex);
+    initIndex(&record->labelIndex);
+    initIndex(&record->textIndex);
+    initIndex(&record->dataExtensionIndex);
+    initIndex(&record->reservedExtensionIndex);
 
     /* Right now, we are only doing the header and image setup  */
     record->header = nitf_FileHeader_clone(source->header, error);
@@ -754,6 +1043,12 @@ NITFAPI(nitf_Record *) nitf_Record_clone(const nitf_Record * source,
         return NULL;
     }
 
+    if (!indexSegments(record, error))
+    {
+        nitf_Record_destruct(&record);
+        return NULL;
+    }
+
     return record;
 
 }
@@ -763,6 +1058,10 @@ NITFAPI(void) nitf_Record_destruct(nitf_Record ** record)
 {
     if (*record)
     {
+        /*  The record is walked as usual, since only some of it is in  */
+        /*  its arena, and the arena goes once nothing can reach it     */
+        nitf_Arena *arena = (*record)->arena;
+
         if ((*record)->header)
         {
             nitf_FileHeader_destruct(&(*record)->header);
@@ -821,8 +1120,18 @@ NITFAPI(void) nitf_Record_destruct(nitf_Record ** record)
             nitf_List_destruct(&(*record)->reservedExtensions);
         }
 
+        freeIndex(&(*record)->imageIndex);
+        freeIndex(&(*record)->graphicIndex);
+        freeIndex(&(*record)->labelIndex);
+        freeIndex(&(*record)->textIndex);
+        freeIndex(&(*record)->dataExtensionIndex);
+        freeIndex(&(*record)->reservedExtensionIndex);
+
         NITF_FREE(*record);
         *record = NULL;
+
+        if (arena)
+            nitf_Arena_destruct(&arena);
     }
 }
 
@@ -887,7 +1196,8 @@ NITFAPI(nitf_ImageSegment *) nitf_Record_newImageSegment(nitf_Record* record,
 
 
     /* Add to the list */
-    if (!nitf_List_pushBack(record->images, (NITF_DATA *) segment, error))
+    if (!nitf_Record_appendSegment(record, record->images,
+                                   (NITF_DATA *) segment, error))
         goto CATCH_ERROR;
 
 
@@ -995,7 +1305,8 @@ nitf_Record_newGraphicSegment(nitf_Record* record,
     }
 
     /* Add to the list */
-    if (!nitf_List_pushBack(record->graphics, (NITF_DATA *) segment, error))
+    if (!nitf_Record_appendSegment(record, record->graphics,
+                                   (NITF_DATA *) segment, error))
         goto CATCH_ERROR;
 
     /* Make new array, one bigger */
@@ -1099,7 +1410,8 @@ NITFAPI(nitf_TextSegment *) nitf_Record_newTextSegment(nitf_Record* record,
     }
 
     /* Add to the list */
-    if (!nitf_List_pushBack(record->texts, (NITF_DATA *) segment, error))
+    if (!nitf_Record_appendSegment(record, record->texts,
+                                   (NITF_DATA *) segment, error))
     {
         goto CATCH_ERROR;
     }
@@ -1204,7 +1516,8 @@ nitf_Record_newDataExtensionSegment(nitf_Record * record,
     }
 
     /* Add to the list */
-    if (!nitf_List_pushBack(record->dataExtensions,(NITF_DATA *)segment, error))
+    if (!nitf_Record_appendSegment(record, record->dataExtensions,
+                                   (NITF_DATA *) segment, error))
         goto CATCH_ERROR;
 
 
@@ -1278,6 +1591,7 @@ NITFAPI(NITF_BOOL) nitf_Record_removeImageSegment(nitf_Record * record,
 
     /* Remove from the list */
     segment = (nitf_ImageSegment*)nitf_List_remove(record->images, &iter);
+    unindexSegment(&record->imageIndex, segmentNumber);
     /* Destroy it */
     nitf_ImageSegment_destruct(&segment);
 
@@ -1354,6 +1668,7 @@ NITFAPI(NITF_BOOL) nitf_Record_removeGraphicSegment(nitf_Record * record,
 
     /* Remove from the list */
     segment = (nitf_GraphicSegment*)nitf_List_remove(record->graphics, &iter);
+    unindexSegment(&record->graphicIndex, segmentNumber);
     /* Destroy it */
     nitf_GraphicSegment_destruct(&segment);
 
@@ -1429,6 +1744,7 @@ NITFAPI(NITF_BOOL) nitf_Record_removeLabelSegment(nitf_Record * record,
 
     /* Remove from the list */
     segment = (nitf_LabelSegment*)nitf_List_remove(record->labels, &iter);
+    unindexSegment(&record->labelIndex, segmentNumber);
 
     /* Destroy it */
     nitf_LabelSegment_destruct(&segment);
@@ -1503,6 +1819,7 @@ NITFAPI(NITF_BOOL) nitf_Record_removeTextSegment(nitf_Record * record,
 
     /* Remove from the list */
     segment = (nitf_TextSegment*)nitf_List_remove(record->texts, &iter);
+    unindexSegment(&record->textIndex, segmentNumber);
     /* Destroy it */
     nitf_TextSegment_destruct(&segment);
 
@@ -1573,6 +1890,7 @@ nitf_Record_removeDataExtensionSegment(nitf_Record * record,
 
     /* Remove from the list */
     segment = (nitf_DESegment*)nitf_List_remove(record->dataExtensions, &iter);
+    unindexSegment(&record->dataExtensionIndex, segmentNumber);
 
     /* Destroy it */
     nitf_DESegment_destruct(&segment);
@@ -1648,6 +1966,7 @@ nitf_Record_removeReservedExtensionSegment(nitf_Record * record,
     /* Remove from the list */
     segment =
         (nitf_RESegment*)nitf_List_remove(record->reservedExtensions, &iter);
+    unindexSegment(&record->reservedExtensionIndex, segmentNumber);
 
     /* Destroy it */
     nitf_RESegment_destruct(&segment);
@@ -1699,13 +2018,32 @@ CATCH_ERROR:
     return NITF_FAILURE;
 }
 
+/*
+ *  Moves the component info at oldIndex to newIndex, shifting the ones in
+ *  between, as nitf_List_move does with the segments.
+ */
+NITFPRIV(void) moveComponentInfo(nitf_ComponentInfo** infos,
+                                 nitf_Uint32 oldIndex,
+                                 nitf_Uint32 newIndex)
+{
+    nitf_ComponentInfo* moved = infos[oldIndex];
+
+    if (oldIndex < newIndex)
+        memmove(infos + oldIndex, infos + oldIndex + 1,
+                sizeof(nitf_ComponentInfo*) * (newIndex - oldIndex));
+    else
+        memmove(infos + newIndex + 1, infos + newIndex,
+                sizeof(nitf_ComponentInfo*) * (oldIndex - newIndex));
+    infos[newIndex] = moved;
+}
+
+
 NITFAPI(NITF_BOOL) nitf_Record_moveImageSegment(nitf_Record * record,
                                                 nitf_Uint32 oldIndex,
                                                 nitf_Uint32 newIndex,
                                                 nitf_Error * error)
 {
     nitf_Uint32 num;
-    nitf_ComponentInfo *tempInfo = NULL;
 
     NITF_TRY_GET_UINT32(record->header->numImages, &num, error);
 
@@ -1723,13 +2061,12 @@ NITFAPI(NITF_BOOL) nitf_Record_moveImageSegment(nitf_Record * record,
         return NITF_SUCCESS;
 
     /* Do the list move */
-    if (nitf_List_move(record->images, oldIndex, newIndex, error))
+    if (!nitf_List_move(record->images, oldIndex, newIndex, error))
         goto CATCH_ERROR;
+    moveIndexed(&record->imageIndex, oldIndex, newIndex);
 
-    /* Now, need to move the component info - just move pointers */
-    tempInfo = record->header->imageInfo[oldIndex];
-    record->header->imageInfo[oldIndex] = record->header->imageInfo[newIndex];
-    record->header->imageInfo[newIndex] = tempInfo;
+    /* Now, need to move the component info the same way */
+    moveComponentInfo(record->header->imageInfo, oldIndex, newIndex);
 
     return NITF_SUCCESS;
 
@@ -1744,7 +2081,6 @@ NITFAPI(NITF_BOOL) nitf_Record_moveGraphicSegment(nitf_Record * record,
                                                   nitf_Error * error)
 {
     nitf_Uint32 num;
-    nitf_ComponentInfo *tempInfo = NULL;
 
     NITF_TRY_GET_UINT32(record->header->numGraphics, &num, error);
 
@@ -1762,16 +2098,12 @@ NITFAPI(NITF_BOOL) nitf_Record_moveGraphicSegment(nitf_Record * record,
         return NITF_SUCCESS;
 
     /* Do the list move */
-    if (nitf_List_move(record->graphics, oldIndex, newIndex, error))
+    if (!nitf_List_move(record->graphics, oldIndex, newIndex, error))
         goto CATCH_ERROR;
+    moveIndexed(&record->graphicIndex, oldIndex, newIndex);
 
-    /* Now, need to move the component info - just move pointers */
-    tempInfo = record->header->graphicInfo[oldIndex];
-
-    record->header->graphicInfo[oldIndex] =
-        record->header->graphicInfo[newIndex];
-
-    record->header->graphicInfo[newIndex] = tempInfo;
+    /* Now, need to move the component info the same way */
+    moveComponentInfo(record->header->graphicInfo, oldIndex, newIndex);
 
     return NITF_SUCCESS;
 
@@ -1786,7 +2118,6 @@ NITFAPI(NITF_BOOL) nitf_Record_moveLabelSegment(nitf_Record * record,
                                                 nitf_Error * error)
 {
     nitf_Uint32 num;
-    nitf_ComponentInfo *tempInfo = NULL;
 
     NITF_TRY_GET_UINT32(record->header->numLabels, &num, error);
 
@@ -1804,13 +2135,12 @@ NITFAPI(NITF_BOOL) nitf_Record_moveLabelSegment(nitf_Record * record,
         return NITF_SUCCESS;
 
     /* Do the list move */
-    if (nitf_List_move(record->labels, oldIndex, newIndex, error))
+    if (!nitf_List_move(record->labels, oldIndex, newIndex, error))
         goto CATCH_ERROR;
+    moveIndexed(&record->labelIndex, oldIndex, newIndex);
 
-    /* Now, need to move the component info - just move pointers */
-    tempInfo = record->header->labelInfo[oldIndex];
-    record->header->labelInfo[oldIndex] = record->header->labelInfo[newIndex];
-    record->header->labelInfo[newIndex] = tempInfo;
+    /* Now, need to move the component info the same way */
+    moveComponentInfo(record->header->labelInfo, oldIndex, newIndex);
 
     return NITF_SUCCESS;
 
@@ -1825,7 +2155,6 @@ NITFAPI(NITF_BOOL) nitf_Record_moveTextSegment(nitf_Record * record,
                                                nitf_Error * error)
 {
     nitf_Uint32 num;
-    nitf_ComponentInfo *tempInfo = NULL;
 
     NITF_TRY_GET_UINT32(record->header->numTexts, &num, error);
 
@@ -1843,13 +2172,12 @@ NITFAPI(NITF_BOOL) nitf_Record_moveTextSegment(nitf_Record * record,
         return NITF_SUCCESS;
 
     /* Do the list move */
-    if (nitf_List_move(record->texts, oldIndex, newIndex, error))
+    if (!nitf_List_move(record->texts, oldIndex, newIndex, error))
         goto CATCH_ERROR;
+    moveIndexed(&record->textIndex, oldIndex, newIndex);
 
-    /* Now, need to move the component info - just move pointers */
-    tempInfo = record->header->textInfo[oldIndex];
-    record->header->textInfo[oldIndex] = record->header->textInfo[newIndex];
-    record->header->textInfo[newIndex] = tempInfo;
+    /* Now, need to move the component info the same way */
+    moveComponentInfo(record->header->textInfo, oldIndex, newIndex);
 
     return NITF_SUCCESS;
 
@@ -1865,7 +2193,6 @@ nitf_Record_moveDataExtensionSegment(nitf_Record * record,
                                      nitf_Error * error)
 {
     nitf_Uint32 num;
-    nitf_ComponentInfo *tempInfo = NULL;
 
     NITF_TRY_GET_UINT32(record->header->numDataExtensions, &num, error);
 
@@ -1883,13 +2210,12 @@ nitf_Record_moveDataExtensionSegment(nitf_Record * record,
         return NITF_SUCCESS;
 
     /* Do the list move */
-    if (nitf_List_move(record->dataExtensions, oldIndex, newIndex, error))
+    if (!nitf_List_move(record->dataExtensions, oldIndex, newIndex, error))
         goto CATCH_ERROR;
+    moveIndexed(&record->dataExtensionIndex, oldIndex, newIndex);
 
-    /* Now, need to move the component info - just move pointers */
-    tempInfo = record->header->dataExtensionInfo[oldIndex];
-    record->header->dataExtensionInfo[oldIndex] = record->header->dataExtensionInfo[newIndex];
-    record->header->dataExtensionInfo[newIndex] = tempInfo;
+    /* Now, need to move the component info the same way */
+    moveComponentInfo(record->header->dataExtensionInfo, oldIndex, newIndex);
 
     return NITF_SUCCESS;
 
@@ -1905,7 +2231,6 @@ nitf_Record_moveReservedExtensionSegment(nitf_Record * record,
                                          nitf_Error * error)
 {
     nitf_Uint32 num;
-    nitf_ComponentInfo *tempInfo = NULL;
 
     NITF_TRY_GET_UINT32(record->header->numReservedExtensions, &num, error);
 
@@ -1923,16 +2248,12 @@ nitf_Record_moveReservedExtensionSegment(nitf_Record * record,
         return NITF_SUCCESS;
 
     /* Do the list move */
-    if (nitf_List_move(record->reservedExtensions, oldIndex, newIndex, error))
+    if (!nitf_List_move(record->reservedExtensions, oldIndex, newIndex, error))
         goto CATCH_ERROR;
+    moveIndexed(&record->reservedExtensionIndex, oldIndex, newIndex);
 
-    /* Now, need to move the component info - just move pointers */
-    tempInfo = record->header->reservedExtensionInfo[oldIndex];
-
-    record->header->reservedExtensionInfo[oldIndex] =
-        record->header->reservedExtensionInfo[newIndex];
-
-    record->header->reservedExtensionInfo[newIndex] = tempInfo;
+    /* Now, need to move the component info the same way */
+    moveComponentInfo(record->header->reservedExtensionInfo, oldIndex, newIndex);
 
     return NITF_SUCCESS;
 
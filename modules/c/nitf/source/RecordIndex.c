@@ -0,0 +1,514 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "nitf/RecordIndex.h"
+
+/*
+ *  The sidecar is big endian:
+ *
+ *    "NITFIDX2", uint64 file size, uint64 device, uint64 inode, int64
+ *    modified, int64 changed, uint64 header hash, uint32 image count,
+ *    then for each image a uint8 that is 1 if it has a layout, followed by
+ *
+ *    uint64 offset, uint64 length, uint32 blocks, uint32 image data
+ *    offset, uint16 block record length, uint16 pad record length,
+ *    uint16 pad value length, 16 bytes of pad value, uint64 block mask
+ *    [blocks + 1], uint64 pad mask [blocks], uint32 offset count and
+ *    uint64 offsets [count]
+ */
+#define RECORD_INDEX_MAGIC "NITFIDX2"
+#define RECORD_INDEX_MAGIC_LENGTH 8
+
+/*
+ *  Walks the bytes of a sidecar, never past the end
+ */
+typedef struct _IndexCursor
+{
+    const nitf_Uint8 *data;
+    size_t left;
+} IndexCursor;
+
+
+NITFPRIV(NITF_BOOL) getBytes(IndexCursor * cursor, void *dest, size_t size)
+{
+    if (size > cursor->left)
+        return NITF_FAILURE;
+    memcpy(dest, cursor->data, size);
+    cursor->data += size;
+    cursor->left -= size;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) getUint16(IndexCursor * cursor, nitf_Uint16 * value)
+{
+    if (!getBytes(cursor, value, sizeof(nitf_Uint16)))
+        return NITF_FAILURE;
+    *value = NITF_NTOHS(*value);
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) getUint32(IndexCursor * cursor, nitf_Uint32 * value)
+{
+    if (!getBytes(cursor, value, sizeof(nitf_Uint32)))
+        return NITF_FAILURE;
+    *value = NITF_NTOHL(*value);
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) getUint64(IndexCursor * cursor, nitf_Uint64 * value)
+{
+    if (!getBytes(cursor, value, sizeof(nitf_Uint64)))
+        return NITF_FAILURE;
+    *value = NITF_NTOHLL(*value);
+    return NITF_SUCCESS;
+}
+
+
+/*
+ *  Reads count uint64s into a new table, after checking they are there
+ */
+NITFPRIV(nitf_Uint64 *) getTable(IndexCursor * cursor, nitf_Uint32 count)
+{
+    nitf_Uint64 *table;
+    nitf_Uint32 i;
+
+    if ((nitf_Uint64) count * sizeof(nitf_Uint64) > cursor->left)
+        return NULL;
+    table = (nitf_Uint64 *) NITF_MALLOC((count + 1) * sizeof(nitf_Uint64));
+    if (!table)
+        return NULL;
+    for (i = 0; i < count; ++i)
+        getUint64(cursor, &table[i]);
+    return table;
+}
+
+
+NITFPRIV(nitf_ImageLayout *) getLayout(IndexCursor * cursor,
+                                       nitf_Error * error)
+{
+    nitf_ImageLayout *layout = nitf_ImageLayout_construct(error);
+    if (!layout)
+        return NULL;
+
+    if (!getUint32(cursor, &layout->numBlocks) ||
+        !getUint32(cursor, &layout->imageDataOffset) ||
+        !getUint16(cursor, &layout->blockRecordLength) ||
+        !getUint16(cursor, &layout->padRecordLength) ||
+        !getUint16(cursor, &layout->padPixelValueLength) ||
+        !getBytes(cursor, layout->padValue, sizeof(layout->padValue)) ||
+        layout->numBlocks == 0xffffffff ||
+        !(layout->blockMask = getTable(cursor, layout->numBlocks + 1)) ||
+        !(layout->padMask = getTable(cursor, layout->numBlocks)) ||
+        !getUint32(cursor, &layout->numOffsets) ||
+        !(layout->offsets = getTable(cursor, layout->numOffsets)))
+    {
+        nitf_ImageLayout_destruct(&layout);
+        return NULL;
+    }
+    return layout;
+}
+
+
+NITFPRIV(void) clearImages(nitf_RecordIndex * index)
+{
+    nitf_Uint32 i;
+
+    for (i = 0; i < index->numImages; ++i)
+        nitf_ImageLayout_destruct(&index->images[i].layout);
+    if (index->images)
+        NITF_FREE(index->images);
+    index->images = NULL;
+    index->numImages = 0;
+}
+
+
+/*
+ *  Takes the images from a sidecar that was made for this version of the
+ *  file.  Anything wrong with it leaves the index empty.
+ */
+NITFPRIV(void) readSidecar(nitf_RecordIndex * index, const char *path)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Off size;
+    char *data = NULL;
+    char magic[RECORD_INDEX_MAGIC_LENGTH];
+    IndexCursor cursor;
+    nitf_Uint64 fileSize;
+    nitf_Uint64 device;
+    nitf_Uint64 inode;
+    nitf_Uint64 modified;
+    nitf_Uint64 changed;
+    nitf_Uint64 headerHash;
+    nitf_Uint32 numImages;
+    nitf_Uint32 i;
+
+    io = nitf_IOHandleAdapter_open(path, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    if (!io)
+        return;
+
+    size = nitf_IOInterface_getSize(io, &error);
+    if (NITF_IO_SUCCESS(size) && size > 0)
+        data = (char *) NITF_MALLOC((size_t) size);
+    if (data && !nitf_IOInterface_read(io, data, (size_t) size, &error))
+    {
+        NITF_FREE(data);
+        data = NULL;
+    }
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+    if (!data)
+        return;
+
+    cursor.data = (const nitf_Uint8 *) data;
+    cursor.left = (size_t) size;
+    if (!getBytes(&cursor, magic, sizeof(magic)) ||
+        memcmp(magic, RECORD_INDEX_MAGIC, RECORD_INDEX_MAGIC_LENGTH) != 0 ||
+        !getUint64(&cursor, &fileSize) || fileSize != index->fileSize ||
+        !getUint64(&cursor, &device) || device != index->stamp.device ||
+        !getUint64(&cursor, &inode) || inode != index->stamp.inode ||
+        !getUint64(&cursor, &modified) ||
+        (nitf_Int64) modified != index->stamp.modified ||
+        !getUint64(&cursor, &changed) ||
+        (nitf_Int64) changed != index->stamp.changed ||
+        !getUint64(&cursor, &headerHash) || headerHash != index->headerHash ||
+        !getUint32(&cursor, &numImages) || numImages > cursor.left)
+        goto CLEANUP;
+
+    index->images = (nitf_ImageIndex *)
+        NITF_MALLOC((numImages + 1) * sizeof(nitf_ImageIndex));
+    if (!index->images)
+        goto CLEANUP;
+    memset(index->images, 0, (numImages + 1) * sizeof(nitf_ImageIndex));
+    index->numImages = numImages;
+
+    for (i = 0; i < numImages; ++i)
+    {
+        nitf_Uint8 present;
+        nitf_ImageIndex *image = &index->images[i];
+
+        if (!getBytes(&cursor, &present, 1))
+            break;
+        if (!present)
+            continue;
+        if (!getUint64(&cursor, &image->offset) ||
+            !getUint64(&cursor, &image->length) ||
+            !(image->layout = getLayout(&cursor, &error)))
+            break;
+    }
+    if (i < numImages)
+        clearImages(index);
+
+CLEANUP:
+    NITF_FREE(data);
+}
+
+
+/*
+ *  64 bit FNV-1a
+ */
+NITFPRIV(nitf_Uint64) hashBytes(const nitf_Uint8 * data, size_t size)
+{
+    nitf_Uint64 hash = ((nitf_Uint64) 0xcbf29ce4 << 32) | 0x84222325;
+    const nitf_Uint64 prime = ((nitf_Uint64) 0x100 << 32) | 0x1b3;
+    size_t i;
+
+    for (i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= prime;
+    }
+    return hash;
+}
+
+
+NITFPRIV(NITF_BOOL) identifyFile(nitf_RecordIndex * index,
+                                 nitf_IOHandle handle, nitf_Error * error)
+{
+    nitf_Uint8 start[NITF_RECORD_INDEX_HASH_LENGTH];
+    nitf_Off size;
+    nitf_Off position;
+    size_t length;
+
+    size = nitf_IOHandle_getSize(handle, error);
+    if (!NITF_IO_SUCCESS(size))
+        return NITF_FAILURE;
+    index->fileSize = (nitf_Uint64) size;
+    if (!nitf_IOHandle_getStamp(handle, &index->stamp, error))
+        return NITF_FAILURE;
+
+    length = index->fileSize < NITF_RECORD_INDEX_HASH_LENGTH ?
+        (size_t) index->fileSize : NITF_RECORD_INDEX_HASH_LENGTH;
+    position = nitf_IOHandle_tell(handle, error);
+    if (!NITF_IO_SUCCESS(position) ||
+        !NITF_IO_SUCCESS(nitf_IOHandle_seek(handle, 0, NITF_SEEK_SET,
+                                            error)) ||
+        !nitf_IOHandle_read(handle, start, length, error) ||
+        !NITF_IO_SUCCESS(nitf_IOHandle_seek(handle, position, NITF_SEEK_SET,
+                                            error)))
+        return NITF_FAILURE;
+
+    index->headerHash = hashBytes(start, length);
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(nitf_RecordIndex *) nitf_RecordIndex_load(const char *path,
+                                                  nitf_IOHandle handle,
+                                                  nitf_Error * error)
+{
+    nitf_RecordIndex *index =
+        (nitf_RecordIndex *) NITF_MALLOC(sizeof(nitf_RecordIndex));
+    if (!index)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(index, 0, sizeof(nitf_RecordIndex));
+
+    if (!identifyFile(index, handle, error))
+    {
+        nitf_RecordIndex_destruct(&index);
+        return NULL;
+    }
+    readSidecar(index, path);
+    return index;
+}
+
+
+NITFPRIV(NITF_BOOL) putBytes(nitf_IOInterface * io, const void *data,
+                             size_t size, nitf_Error * error)
+{
+    return nitf_IOInterface_write(io, data, size, error);
+}
+
+
+NITFPRIV(NITF_BOOL) putUint16(nitf_IOInterface * io, nitf_Uint16 value,
+                              nitf_Error * error)
+{
+    value = NITF_HTONS(value);
+    return putBytes(io, &value, sizeof(value), error);
+}
+
+
+NITFPRIV(NITF_BOOL) putUint32(nitf_IOInterface * io, nitf_Uint32 value,
+                              nitf_Error * error)
+{
+    value = NITF_HTONL(value);
+    return putBytes(io, &value, sizeof(value), error);
+}
+
+
+NITFPRIV(NITF_BOOL) putUint64(nitf_IOInterface * io, nitf_Uint64 value,
+                              nitf_Error * error)
+{
+    value = NITF_HTONLL(value);
+    return putBytes(io, &value, sizeof(value), error);
+}
+
+
+NITFPRIV(NITF_BOOL) putTable(nitf_IOInterface * io, const nitf_Uint64 * table,
+                             nitf_Uint32 count, nitf_Error * error)
+{
+    nitf_Uint32 i;
+
+    for (i = 0; i < count; ++i)
+        if (!putUint64(io, table[i], error))
+            return NITF_FAILURE;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) putImage(nitf_IOInterface * io,
+                             const nitf_ImageIndex * image,
+                             nitf_Error * error)
+{
+    const nitf_ImageLayout *layout = image->layout;
+    nitf_Uint8 present = layout ? 1 : 0;
+
+    if (!putBytes(io, &present, 1, error))
+        return NITF_FAILURE;
+    if (!present)
+        return NITF_SUCCESS;
+
+    return putUint64(io, image->offset, error) &&
+        putUint64(io, image->length, error) &&
+        putUint32(io, layout->numBlocks, error) &&
+        putUint32(io, layout->imageDataOffset, error) &&
+        putUint16(io, layout->blockRecordLength, error) &&
+        putUint16(io, layout->padRecordLength, error) &&
+        putUint16(io, layout->padPixelValueLength, error) &&
+        putBytes(io, layout->padValue, sizeof(layout->padValue), error) &&
+        putTable(io, layout->blockMask, layout->numBlocks + 1, error) &&
+        putTable(io, layout->padMask, layout->numBlocks, error) &&
+        putUint32(io, layout->numOffsets, error) &&
+        putTable(io, layout->offsets, layout->numOffsets, error);
+}
+
+
+NITFAPI(NITF_BOOL) nitf_RecordIndex_save(nitf_RecordIndex * index,
+                                         const char *path,
+                                         nitf_Error * error)
+{
+    nitf_IOInterface *buffer;
+    nitf_IOInterface *file = NULL;
+    char *temp = NULL;
+    char *data;
+    size_t size;
+    nitf_Uint32 i;
+    NITF_BOOL ok = NITF_FAILURE;
+
+    if (!index->changed)
+        return NITF_SUCCESS;
+
+    buffer = nitf_GrowableBufferAdapter_construct(0, error);
+    if (!buffer)
+        return NITF_FAILURE;
+
+    if (!putBytes(buffer, RECORD_INDEX_MAGIC, RECORD_INDEX_MAGIC_LENGTH,
+                  error) ||
+        !putUint64(buffer, index->fileSize, error) ||
+        !putUint64(buffer, index->stamp.device, error) ||
+        !putUint64(buffer, index->stamp.inode, error) ||
+        !putUint64(buffer, (nitf_Uint64) index->stamp.modified, error) ||
+        !putUint64(buffer, (nitf_Uint64) index->stamp.changed, error) ||
+        !putUint64(buffer, index->headerHash, error) ||
+        !putUint32(buffer, index->numImages, error))
+        goto CLEANUP;
+    for (i = 0; i < index->numImages; ++i)
+        if (!putImage(buffer, &index->images[i], error))
+            goto CLEANUP;
+
+    data = nitf_GrowableBufferAdapter_getBuffer(buffer, &size, error);
+    if (!data)
+        goto CLEANUP;
+
+    temp = (char *) NITF_MALLOC(strlen(path) + 5);
+    if (!temp)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        goto CLEANUP;
+    }
+    strcpy(temp, path);
+    strcat(temp, ".tmp");
+
+    file = nitf_IOHandleAdapter_open(temp, NITF_ACCESS_WRITEONLY,
+                                     NITF_CREATE | NITF_TRUNCATE, error);
+    if (!file)
+        goto CLEANUP;
+    ok = nitf_IOInterface_write(file, data, size, error);
+    nitf_IOInterface_close(file, error);
+    nitf_IOInterface_destruct(&file);
+    if (!ok)
+    {
+        remove(temp);
+        goto CLEANUP;
+    }
+
+    /* some platforms will not rename over an existing file */
+    if (rename(temp, path) != 0 && (remove(path), rename(temp, path) != 0))
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_OPENING_FILE,
+                         "Unable to replace %s: %s", path,
+                         NITF_STRERROR(NITF_ERRNO));
+        remove(temp);
+        ok = NITF_FAILURE;
+        goto CLEANUP;
+    }
+    index->changed = 0;
+
+CLEANUP:
+    if (temp)
+        NITF_FREE(temp);
+    nitf_IOInterface_destruct(&buffer);
+    return ok;
+}
+
+
+NITFAPI(void) nitf_RecordIndex_destruct(nitf_RecordIndex ** index)
+{
+    if (*index)
+    {
+        clearImages(*index);
+        NITF_FREE(*index);
+        *index = NULL;
+    }
+}
+
+
+NITFPROT(const nitf_ImageLayout *)
+nitf_RecordIndex_getImage(nitf_RecordIndex * index, nitf_Uint32 segment,
+                          nitf_Uint64 offset, nitf_Uint64 length)
+{
+    nitf_ImageIndex *image;
+
+    if (segment >= index->numImages)
+        return NULL;
+    image = &index->images[segment];
+    if (image->offset != offset || image->length != length)
+        return NULL;
+    return image->layout;
+}
+
+
+NITFPROT(NITF_BOOL) nitf_RecordIndex_setImage(nitf_RecordIndex * index,
+                                              nitf_Uint32 segment,
+                                              nitf_Uint64 offset,
+                                              nitf_Uint64 length,
+                                              nitf_ImageLayout * layout,
+                                              nitf_Error * error)
+{
+    nitf_ImageIndex *image;
+
+    if (segment >= index->numImages)
+    {
+        nitf_ImageIndex *images = (nitf_ImageIndex *)
+            NITF_REALLOC(index->images,
+                         (segment + 1) * sizeof(nitf_ImageIndex));
+        if (!images)
+        {
+            nitf_ImageLayout_destruct(&layout);
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        memset(images + index->numImages, 0,
+               (segment + 1 - index->numImages) * sizeof(nitf_ImageIndex));
+        index->images = images;
+        index->numImages = segment + 1;
+    }
+
+    image = &index->images[segment];
+    nitf_ImageLayout_destruct(&image->layout);
+    image->offset = offset;
+    image->length = length;
+    image->layout = layout;
+    index->changed = 1;
+    return NITF_SUCCESS;
+}
@@ -57,6 +57,33 @@ NITFAPI(NITF_BOOL) nitf_SegmentReader_read(nitf_SegmentReader *
 }
 
 
+NITFAPI(NITF_BOOL) nitf_SegmentReader_copy(nitf_SegmentReader *
+        segmentReader,
+        nitf_IOInterface * output,
+        size_t count,
+        nitf_Error * error)
+{
+    /*   Check for request out of bounds */
+    if (count + segmentReader->virtualOffset > segmentReader->dataLength)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Seek offset out of bounds");
+        return (NITF_FAILURE);
+    }
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(segmentReader->input,
+                                               segmentReader->baseOffset +
+                                               segmentReader->virtualOffset,
+                                               NITF_SEEK_SET, error)))
+        return (NITF_FAILURE);
+
+    if (!nitf_IOInterface_copy(segmentReader->input, output, count, error))
+        return (NITF_FAILURE);
+    segmentReader->virtualOffset += count;
+    return (NITF_SUCCESS);
+}
+
+
 NITFAPI(nitf_Off) nitf_SegmentReader_seek(nitf_SegmentReader * segmentReader,
                                        nitf_Off offset,
                                        int whence, nitf_Error * error)
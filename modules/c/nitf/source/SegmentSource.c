@@ -530,3 +530,35 @@ NITFAPI(nitf_SegmentSource *) nitf_SegmentReaderSource_construct
     segmentSource->iface = &iSource;
     return segmentSource;
 }
+
+
+NITFPROT(NITF_BOOL) nitf_SegmentSource_copy(nitf_SegmentSource * source,
+                                            nitf_IOInterface * output,
+                                            nitf_Off size,
+                                            NITF_BOOL * copied,
+                                            nitf_Error * error)
+{
+    *copied = 0;
+
+    if (source->iface->read == &SegmentReader_read)
+    {
+        if (!nitf_SegmentReader_copy((nitf_SegmentReader *) source->data,
+                                     output, (size_t) size, error))
+            return NITF_FAILURE;
+        *copied = 1;
+    }
+    else if (source->iface->read == &FileSource_read &&
+             ((FileSourceImpl *) source->data)->byteSkip == 0)
+    {
+        FileSourceImpl *fileSource = (FileSourceImpl *) source->data;
+        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(fileSource->io,
+                                                   fileSource->mark,
+                                                   NITF_SEEK_SET, error)))
+            return NITF_FAILURE;
+        if (!nitf_IOInterface_copy(fileSource->io, output, size, error))
+            return NITF_FAILURE;
+        fileSource->mark += size;
+        *copied = 1;
+    }
+    return NITF_SUCCESS;
+}
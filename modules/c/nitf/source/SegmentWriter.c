@@ -57,6 +57,7 @@ NITFPRIV(NITF_BOOL) SegmentWriter_write(NITF_DATA * data,
     size_t readSize = READ_SIZE;
     size_t bytesToRead = READ_SIZE;
     char* buf = NULL;
+    NITF_BOOL copied;
     SegmentWriterImpl *impl = (SegmentWriterImpl *) data;
     if (impl->segmentSource == NULL)
     {
@@ -67,6 +68,13 @@ NITFPRIV(NITF_BOOL) SegmentWriter_write(NITF_DATA * data,
     size = (*impl->segmentSource->iface->getSize)(impl->segmentSource->data, error);
     bytesLeft = size;
 
+    /* Pass-through sources go straight to the output */
+    if (!nitf_SegmentSource_copy(impl->segmentSource, io, (nitf_Off)size,
+                                 &copied, error))
+        goto CATCH_ERROR;
+    if (copied)
+        return NITF_SUCCESS;
+
     buf = (char*) NITF_MALLOC(readSize);
     if (!buf)
     {
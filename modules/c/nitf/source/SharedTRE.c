@@ -0,0 +1,348 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/SharedTRE.h"
+#include "nitf/LazyTRE.h"
+
+/*
+ *  What shared TREs point to.  The TRE inside holds the real handler and
+ *  private data and is never changed while more than one TRE refers to it.
+ */
+typedef struct _SharedTREBody
+{
+    nitf_TRE *tre;      /* The shared contents */
+    int refs;           /* Number of TREs pointing here */
+} SharedTREBody;
+
+/*
+ *  Guards the reference counts, and a source while it is being shared.
+ */
+#ifndef WIN32
+    static nitf_Mutex  __SharedTRELock = NITF_MUTEX_INIT;
+#   define GET_MUTEX() &__SharedTRELock
+#else
+    static nitf_Mutex __SharedTRELock = NULL;
+    static long __SharedTREInitLock = 0;
+
+NITFPRIV(nitf_Mutex*) GET_MUTEX()
+{
+    if (__SharedTRELock == NULL)
+    {
+        while (InterlockedExchange(&__SharedTREInitLock, 1) == 1)
+            /* loop, another thread own the lock */ ;
+        if (__SharedTRELock == NULL)
+            nitf_Mutex_init(&__SharedTRELock);
+        InterlockedExchange(&__SharedTREInitLock, 0);
+    }
+    return &__SharedTRELock;
+}
+#endif
+
+
+/*
+ *  Drops one reference to the body, and destroys it with the last one.
+ */
+NITFPRIV(void) releaseBody(SharedTREBody *body)
+{
+    int refs;
+
+    nitf_Mutex_lock(GET_MUTEX());
+    refs = --body->refs;
+    nitf_Mutex_unlock(GET_MUTEX());
+
+    if (refs == 0)
+    {
+        nitf_TRE_destruct(&body->tre);
+        NITF_FREE(body);
+    }
+}
+
+
+NITFAPI(NITF_BOOL) nitf_SharedTRE_isShared(nitf_TRE * tre)
+{
+    return tre && tre->priv &&
+        tre->handler == nitf_SharedTRE_handler(NULL);
+}
+
+
+NITFPROT(nitf_TRE*) nitf_SharedTRE_getContents(nitf_TRE * tre)
+{
+    return nitf_SharedTRE_isShared(tre) ?
+        ((SharedTREBody*)tre->priv)->tre : tre;
+}
+
+
+/*
+ *  Whether a TRE that is not shared yet may be.  Contents in a record
+ *  arena go when the record does, and fields that were handed out may
+ *  still be changed, so those are copied instead.
+ */
+NITFPRIV(NITF_BOOL) canShare(nitf_TRE * tre)
+{
+    return tre->handler && tre->handler->clone && tre->priv &&
+        !tre->exposed && !nitf_LazyTRE_isPending(tre) &&
+        !nitf_Arena_find(tre->priv);
+}
+
+
+NITFPROT(NITF_BOOL) nitf_SharedTRE_share(nitf_TRE * source,
+                                         nitf_TRE * tre,
+                                         NITF_BOOL * shared,
+                                         nitf_Error * error)
+{
+    SharedTREBody *body;
+
+    *shared = 0;
+
+    /*
+     *  The source is read, and may be changed over to a shared body,
+     *  under the lock, so clones taken at the same time from other threads
+     *  never see a handler and private data that do not belong together
+     */
+    nitf_Mutex_lock(GET_MUTEX());
+
+    if (!nitf_SharedTRE_isShared(source))
+    {
+        nitf_TRE *contents;
+
+        if (!canShare(source))
+        {
+            tre->handler = source->handler;
+            nitf_Mutex_unlock(GET_MUTEX());
+            return NITF_SUCCESS;
+        }
+
+        body = (SharedTREBody*)NITF_MALLOC(sizeof(SharedTREBody));
+        contents = (nitf_TRE*)NITF_MALLOC(sizeof(nitf_TRE));
+        if (!body || !contents)
+        {
+            nitf_Mutex_unlock(GET_MUTEX());
+            if (body)
+                NITF_FREE(body);
+            if (contents)
+                NITF_FREE(contents);
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+
+        contents->handler = source->handler;
+        contents->priv = source->priv;
+        contents->exposed = 0;
+        memcpy(contents->tag, source->tag, sizeof(contents->tag));
+        body->tre = contents;
+        body->refs = 1;
+
+        source->handler = nitf_SharedTRE_handler(error);
+        source->priv = body;
+    }
+
+    body = (SharedTREBody*)source->priv;
+    ++body->refs;
+    tre->handler = source->handler;
+    tre->priv = body;
+
+    nitf_Mutex_unlock(GET_MUTEX());
+    *shared = 1;
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_SharedTRE_unshare(nitf_TRE * tre, nitf_Error * error)
+{
+    SharedTREBody *body;
+    nitf_TRE copy;
+
+    if (!nitf_SharedTRE_isShared(tre))
+        return NITF_SUCCESS;
+    body = (SharedTREBody*)tre->priv;
+
+    /* the last user takes the body over */
+    nitf_Mutex_lock(GET_MUTEX());
+    if (body->refs == 1)
+    {
+        nitf_Mutex_unlock(GET_MUTEX());
+        tre->handler = body->tre->handler;
+        tre->priv = body->tre->priv;
+        NITF_FREE(body->tre);
+        NITF_FREE(body);
+        return NITF_SUCCESS;
+    }
+    nitf_Mutex_unlock(GET_MUTEX());
+
+    /*
+     *  Our reference keeps the body from being taken over while it is
+     *  copied, so the copy can be made without the lock
+     */
+    copy.handler = body->tre->handler;
+    copy.priv = NULL;
+    copy.exposed = 0;
+    memcpy(copy.tag, body->tre->tag, sizeof(copy.tag));
+    if (!copy.handler->clone(body->tre, &copy, error))
+    {
+        if (copy.priv && copy.handler->destruct)
+            copy.handler->destruct(&copy);
+        return NITF_FAILURE;
+    }
+
+    releaseBody(body);
+    tre->handler = copy.handler;
+    tre->priv = copy.priv;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(nitf_TRE*) sharedContents(nitf_TRE *tre)
+{
+    return ((SharedTREBody*)tre->priv)->tre;
+}
+
+
+NITFPRIV(void) sharedDestruct(nitf_TRE *tre)
+{
+    if (tre && tre->priv)
+    {
+        releaseBody((SharedTREBody*)tre->priv);
+        tre->priv = NULL;
+    }
+}
+
+
+NITFPRIV(const char*) sharedGetID(nitf_TRE *tre)
+{
+    nitf_TRE *contents = sharedContents(tre);
+    return contents->handler->getID ? contents->handler->getID(contents) :
+        NULL;
+}
+
+
+NITFPRIV(NITF_BOOL) sharedRead(nitf_IOInterface *io,
+                               nitf_Uint32 length,
+                               nitf_TRE * tre,
+                               struct _nitf_Record* record,
+                               nitf_Error * error)
+{
+    if (!nitf_SharedTRE_unshare(tre, error))
+        return NITF_FAILURE;
+    return tre->handler->read(io, length, tre, record, error);
+}
+
+
+NITFPRIV(NITF_BOOL) sharedSetField(nitf_TRE * tre,
+                                   const char *tag,
+                                   NITF_DATA * data,
+                                   size_t dataLength,
+                                   nitf_Error * error)
+{
+    if (!nitf_SharedTRE_unshare(tre, error))
+        return NITF_FAILURE;
+    return tre->handler->setField(tre, tag, data, dataLength, error);
+}
+
+
+NITFPRIV(nitf_Field*) sharedGetField(nitf_TRE * tre, const char *tag)
+{
+    nitf_Error error;
+
+    /* the field handed out may be changed, so it has to be our own */
+    if (!nitf_SharedTRE_unshare(tre, &error))
+        return NULL;
+    return tre->handler->getField(tre, tag);
+}
+
+
+NITFPRIV(nitf_List*) sharedFind(nitf_TRE * tre,
+                                const char *pattern,
+                                nitf_Error * error)
+{
+    if (!nitf_SharedTRE_unshare(tre, error))
+        return NULL;
+    return tre->handler->find(tre, pattern, error);
+}
+
+
+NITFPRIV(NITF_BOOL) sharedWrite(nitf_IOInterface* io,
+                                nitf_TRE* tre,
+                                struct _nitf_Record* record,
+                                nitf_Error* error)
+{
+    nitf_TRE *contents = sharedContents(tre);
+    return contents->handler->write(io, contents, record, error);
+}
+
+
+NITFPRIV(nitf_TREEnumerator*) sharedBegin(nitf_TRE * tre, nitf_Error * error)
+{
+    if (!nitf_SharedTRE_unshare(tre, error))
+        return NULL;
+    return tre->handler->begin(tre, error);
+}
+
+
+NITFPRIV(int) sharedGetCurrentSize(nitf_TRE * tre, nitf_Error * error)
+{
+    nitf_TRE *contents = sharedContents(tre);
+    return contents->handler->getCurrentSize(contents, error);
+}
+
+
+NITFPRIV(NITF_BOOL) sharedClone(nitf_TRE *source,
+                                nitf_TRE *tre,
+                                nitf_Error* error)
+{
+    SharedTREBody *body;
+    (void)error;
+
+    if (!tre || !source || !source->priv)
+        return NITF_FAILURE;
+
+    nitf_Mutex_lock(GET_MUTEX());
+    body = (SharedTREBody*)source->priv;
+    ++body->refs;
+    nitf_Mutex_unlock(GET_MUTEX());
+
+    tre->priv = body;
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(nitf_TREHandler*) nitf_SharedTRE_handler(nitf_Error * error)
+{
+    static nitf_TREHandler handler =
+    {
+        NULL,   /* init - shared TREs only come from nitf_TRE_clone */
+        sharedGetID,
+        sharedRead,
+        sharedSetField,
+        sharedGetField,
+        sharedFind,
+        sharedWrite,
+        sharedBegin,
+        sharedGetCurrentSize,
+        sharedClone,
+        sharedDestruct,
+        NULL    /* data - We don't need this! */
+    };
+
+    (void)error;
+    return &handler;
+}
@@ -31,31 +31,14 @@ typedef struct _WriteHandlerImpl
 } WriteHandlerImpl;
 
 
-#define _STREAM_CHUNK_SIZE 8192
-
 /*
  *  Private read implementation for file source.
  */
 NITFPRIV(NITF_BOOL) WriteHandler_write
     (NITF_DATA * data, nitf_IOInterface* output, nitf_Error * error)
 {
-    WriteHandlerImpl *impl = NULL;
-    nitf_Uint64 toWrite;
-    nitf_Uint32 bytesThisPass;
-    char *buf = NULL;
-
     /* cast it to the structure we know about */
-    impl = (WriteHandlerImpl *) data;
-
-    buf = (char*)NITF_MALLOC(_STREAM_CHUNK_SIZE);
-    if (!buf)
-    {
-        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
-                NITF_CTXT, NITF_ERR_MEMORY);
-        return NITF_FAILURE;
-    }
-
-    /* stream the input to the output in chunks */
+    WriteHandlerImpl *impl = (WriteHandlerImpl *) data;
 
     /* first, seek to the right spot of the input handle */
     if (!NITF_IO_SUCCESS(
@@ -64,34 +47,10 @@ NITFPRIV(NITF_BOOL) WriteHandler_write
                 )
             )
         )
-        goto CATCH_ERROR;
-
-    toWrite = impl->bytes;
-    while (toWrite > 0)
-    {
-        bytesThisPass = toWrite >= _STREAM_CHUNK_SIZE ? _STREAM_CHUNK_SIZE :
-                (nitf_Uint32) toWrite;
-
-        /* read */
-        if (!nitf_IOInterface_read(impl->ioHandle, buf, bytesThisPass, error))
-            goto CATCH_ERROR;
-
-        /* write */
-        if (!nitf_IOInterface_write(output, buf, bytesThisPass, error))
-            goto CATCH_ERROR;
-
-        /* update count */
-        toWrite -= bytesThisPass;
-    }
-
-    NITF_FREE(buf);
-
-    return NITF_SUCCESS;
+        return NITF_FAILURE;
 
-  CATCH_ERROR:
-    if (buf)
-        NITF_FREE(buf);
-    return NITF_FAILURE;
+    /* stream the input to the output, in the kernel if both are files */
+    return nitf_IOInterface_copy(impl->ioHandle, output, impl->bytes, error);
 }
 
 
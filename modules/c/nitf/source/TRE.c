@@ -21,6 +21,7 @@
  */
 
 #include "nitf/TRE.h"
+#include "nitf/SharedTRE.h"
 #include "nitf/PluginRegistry.h"
 
 
@@ -41,6 +42,7 @@ NITFAPI(nitf_TRE *) nitf_TRE_createSkeleton(const char* tag,
     /*  Just in case the first malloc fails  */
     tre->handler = NULL;
     tre->priv = NULL;
+    tre->exposed = 0;
 
     /* This happens with things like "DES" */
     if (strlen(tag) < NITF_MAX_TAG )
@@ -57,6 +59,7 @@ NITFAPI(nitf_TRE *) nitf_TRE_createSkeleton(const char* tag,
 NITFAPI(nitf_TRE *) nitf_TRE_clone(nitf_TRE* source, nitf_Error* error)
 {
     nitf_TRE *tre = NULL;
+    NITF_BOOL shared;
 
     if (source)
     {
@@ -67,13 +70,20 @@ NITFAPI(nitf_TRE *) nitf_TRE_clone(nitf_TRE* source, nitf_Error* error)
                             NITF_CTXT, NITF_ERR_MEMORY);
             return NULL;
         }
-
-        /* share the handler */
-        tre->handler = source->handler;
+        tre->handler = NULL;
+        tre->priv = NULL;
+        tre->exposed = 0;
         memcpy(tre->tag, source->tag, sizeof(tre->tag));
 
-        /* call the handler clone method, if one is defined */
-        if (tre->handler && tre->handler->clone)
+        /* clones share the contents until one of them is changed */
+        if (!nitf_SharedTRE_share(source, tre, &shared, error))
+        {
+            NITF_FREE(tre);
+            return NULL;
+        }
+
+        /* otherwise call the handler clone method, if one is defined */
+        if (!shared && tre->handler && tre->handler->clone)
         {
             if (!tre->handler->clone(source, tre, error))
             {
@@ -149,15 +159,67 @@ NITFAPI(nitf_TRE *) nitf_TRE_construct(const char* tag,
     return tre;
 }
 
+NITFPROT(NITF_BOOL) nitf_TRE_parse(nitf_TRE * tre,
+                                   nitf_IOInterface * io,
+                                   nitf_Uint32 length,
+                                   struct _nitf_Record *record,
+                                   nitf_Error * error)
+{
+    int ok = 0;
+    int bad = 0;
+    nitf_Off off;
+
+    nitf_TREHandler* handler = NULL;
+
+    nitf_PluginRegistry *reg = nitf_PluginRegistry_getInstance(error);
+    if (reg)
+    {
+        handler = nitf_PluginRegistry_retrieveTREHandler(reg, tre->tag,
+                                                         &bad, error);
+        if (bad)
+            return NITF_FAILURE;
+        if (handler)
+        {
+            tre->handler = handler;
+            off = nitf_IOInterface_tell(io, error);
+
+            ok = handler->read(io, length, tre, record, error);
+            if (!ok)
+            {
+                /* move the IO back the size of the TRE */
+                nitf_IOInterface_seek(io, off, NITF_SEEK_SET, error);
+            }
+        }
+    }
+
+    /* if we couldn't parse it with the plug-in OR if no plug-in is found,
+     * then, we use the default TRE handler */
+    if (!ok || handler == NULL)
+    {
+        tre->handler = nitf_DefaultTRE_handler(error);
+        ok = tre->handler->read(io, length, tre, record, error);
+    }
+
+    return ok ? NITF_SUCCESS : NITF_FAILURE;
+}
+
+/*
+ *  The fields that begin, find and getField hand out may be changed or
+ *  kept, so from then on the TRE's contents are copied rather than shared
+ *  when it is cloned.
+ */
 NITFAPI(nitf_TREEnumerator*) nitf_TRE_begin(nitf_TRE* tre, nitf_Error* error)
 {
+    tre->exposed = 1;
     return tre->handler->begin(tre, error);
 }
 
 NITFAPI(NITF_BOOL) nitf_TRE_exists(nitf_TRE * tre, const char *tag)
 {
+    /* only looks, so the field is not handed out */
     return (!tre) ? NITF_FAILURE :
-        (nitf_TRE_getField(tre, tag) != NULL ? NITF_SUCCESS : NITF_FAILURE);
+        (tre->handler->getField(tre, tag) != NULL ?
+         NITF_SUCCESS : NITF_FAILURE);
 }
 
 
@@ -165,6 +227,7 @@ NITFAPI(nitf_List*) nitf_TRE_find(nitf_TRE* tre,
 				  const char* pattern,
 				  nitf_Error* error)
 {
+    tre->exposed = 1;
     return tre->handler->find(tre, pattern, error);
 }
 
@@ -179,6 +242,7 @@ NITFAPI(NITF_BOOL) nitf_TRE_setField(nitf_TRE * tre,
 
 NITFAPI(nitf_Field*) nitf_TRE_getField(nitf_TRE* tre, const char* tag)
 {
+    tre->exposed = 1;
     return tre->handler->getField(tre, tag);
 }
 
@@ -22,21 +22,18 @@
 
 #include "nitf/TRECursor.h"
 #include "nitf/TREPrivateData.h"
+#include "nitf/SharedTRE.h"
 
 
 #define TAG_BUF_LEN 256
 
 
 
-NITFPRIV(nitf_Pair *) nitf_TRECursor_getTREPair(nitf_TRE * tre,
-                                               char *descTag,
-                                               char idx_str[10][10],
-                                               int looping,
-                                               nitf_Error * error);
-
 NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE * tre,
+                                   const nitf_TREPlanStep * step,
                                    nitf_TREDescription * desc_ptr,
                                    char idx_str[10][10],
+                                   int idx_len[10],
                                    int looping,
                                    nitf_Error * error);
 
@@ -45,34 +42,31 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE * tre,
  * Returns the number of loops that will be processed
  */
 NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE * tre,
+                                      const nitf_TREPlanStep * step,
                                       nitf_TREDescription * desc_ptr,
                                       char idx_str[10][10],
+                                      int idx_len[10],
                                       int looping,
                                       nitf_Error * error);
 
 
-NITFPRIV(int) nitf_TRECursor_evalCondLength(nitf_TRE * tre,
-                                           nitf_TREDescription * desc_ptr,
-                                           char idx_str[10][10],
-                                           int looping,
-                                           nitf_Error * error);
-
-
 /*!
- *  Evaluates the given postfix expression, looking up fields in the TRE, or
+ *  Evaluates the step's postfix expression, looking up fields in the TRE, or
  *  using constant integers.
  *
  *  \param tre      The TRE to use
+ *  \param step     The step, with the expression compiled into terms
  *  \param idx      The loop index/values
+ *  \param idx_len  The length of each of those
  *  \param looping  The current loop level
- *  \param expression The postfix expression
  *  \param error The error to populate on failure
- *  \return NITF_SUCCESS on sucess or NITF_FAILURE otherwise
+ *  \return The value of the expression, or -1 on failure
  */
 NITFPRIV(int) nitf_TRECursor_evaluatePostfix(nitf_TRE *tre,
+                                             const nitf_TREPlanStep *step,
                                              char idx[10][10],
+                                             int idx_len[10],
                                              int looping,
-                                             char *expression,
                                              nitf_Error *error);
 
 typedef unsigned int (*NITF_TRE_CURSOR_COUNT_FUNCTION) (nitf_TRE *,
@@ -88,12 +82,17 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_begin(nitf_TRE * tre)
     nitf_TRECursor tre_cursor;
     nitf_TREDescription *dptr;
 
+    /* the cursor reads the fields straight out of the private data */
+    nitf_SharedTRE_unshare(tre, &error);
+
     tre_cursor.loop = nitf_IntStack_construct(&error);
     tre_cursor.loop_idx = nitf_IntStack_construct(&error);
     tre_cursor.loop_rtn = nitf_IntStack_construct(&error);
     tre_cursor.numItems = 0;
     tre_cursor.index = 0;
     tre_cursor.looping = 0;
+    tre_cursor.plan = NULL;
+    tre_cursor.ownPlan = NULL;
     /* init the pointers */
     tre_cursor.end_ptr = NULL;
     tre_cursor.prev_ptr = NULL;
@@ -103,13 +102,28 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_begin(nitf_TRE * tre)
     {
         /* set the start index */
         tre_cursor.index = -1;
-        /* count how many descriptions there are */
 		dptr = ((nitf_TREPrivateData*)tre->priv)->description;
 
-        while (dptr && (dptr->data_type != NITF_END))
+        /* the plan knows how many descriptions there are */
+        tre_cursor.plan = nitf_TREPlan_get(tre->handler, dptr);
+        if (!tre_cursor.plan && dptr)
         {
-            tre_cursor.numItems++;
-            dptr++;
+            tre_cursor.ownPlan = nitf_TREPlan_construct(dptr, &error);
+            tre_cursor.plan = tre_cursor.ownPlan;
+        }
+        if (tre_cursor.plan)
+        {
+            tre_cursor.numItems = tre_cursor.plan->numItems;
+            dptr += tre_cursor.numItems;
+        }
+        else
+        {
+            /* iterate will fail, but not before isDone says there is more */
+            while (dptr && (dptr->data_type != NITF_END))
+            {
+                tre_cursor.numItems++;
+                dptr++;
+            }
         }
         tre_cursor.end_ptr = dptr;
         memset(tre_cursor.tag_str, 0, TAG_BUF_LEN);
@@ -133,6 +147,7 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_clone(nitf_TRECursor *tre_cursor,
     cursor.loop_rtn = nitf_IntStack_clone(tre_cursor->loop_rtn, error);
     cursor.tre = tre_cursor->tre;
     cursor.end_ptr = tre_cursor->end_ptr;
+    cursor.plan = tre_cursor->plan;
 
     cursor.prev_ptr = tre_cursor->prev_ptr;
     cursor.desc_ptr = tre_cursor->desc_ptr;
@@ -142,75 +157,95 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_clone(nitf_TRECursor *tre_cursor,
 }
 
 
+
+
 /*!
- * Normalizes the tag, which could be in a loop, and returns the nitf_Pair* from
- * the TRE hash that corresponds to the current normalized tag.
+ * Writes a loop index as "[N]", returning how many characters that took.
  */
-NITFPRIV(nitf_Pair *) nitf_TRECursor_getTREPair(nitf_TRE * tre,
-                                                char *descTag,
-                                                char idx_str[10][10],
-                                                int looping, nitf_Error * error)
+NITFPRIV(int) nitf_TRECursor_formatIndex(char *buf, int value)
 {
-    /* temp buf used for storing the qualified tag */
-    char tag_str[TAG_BUF_LEN];
+    char digits[12];
+    int numDigits = 0;
+    int length = 0;
+    unsigned int magnitude = value < 0 ?
+            0U - (unsigned int) value : (unsigned int) value;
 
-    /* pointer for brace position */
-    char *bracePtr;
+    do
+    {
+        digits[numDigits++] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    while (magnitude);
+
+    buf[length++] = '[';
+    if (value < 0)
+        buf[length++] = '-';
+    while (numDigits)
+        buf[length++] = digits[--numDigits];
+    buf[length++] = ']';
+    buf[length] = 0;
+    return length;
+}
 
-    /* used as in iterator */
-    int index = 0;
 
-    /* temp used for looping */
+/*!
+ * Qualifies the tag, which could be in a loop, and returns the nitf_Pair*
+ * from the TRE fields that corresponds to it.  The tag was measured when the
+ * description was planned, and the indexes are already formatted.
+ */
+NITFPRIV(nitf_Pair *) nitf_TRECursor_findPair(nitf_TRE * tre,
+                                              const nitf_TREPlanRef *ref,
+                                              char idx_str[10][10],
+                                              int idx_len[10],
+                                              int looping)
+{
+    nitf_TREPrivateData *priv = (nitf_TREPrivateData*)tre->priv;
+    char tag_str[TAG_BUF_LEN];
+    size_t length;
+    nitf_Pair *pair;
     int i;
 
-    /* the pair to return */
-    nitf_Pair *pair = NULL;
-
-    strncpy(tag_str, descTag, sizeof(tag_str));
-
-    /* deal with braces */
-    if (strchr(descTag, '['))
+    if (ref->brackets)
     {
-        index = 0;
-        bracePtr = descTag;
-        /* split the string */
-        *(strchr(tag_str, '[')) = 0;
-        bracePtr--;
-        while ((bracePtr = strchr(bracePtr + 1, '[')) != NULL)
+        /* the tag says which loops it is in */
+        length = ref->baseLength < TAG_BUF_LEN ?
+                ref->baseLength : TAG_BUF_LEN - 1;
+        memcpy(tag_str, ref->tag, length);
+        for (i = 0; i < ref->brackets && i < looping &&
+                length + idx_len[i] < TAG_BUF_LEN; ++i)
         {
-            /* tack on the depth */
-            strcat(tag_str, idx_str[index++]);
+            memcpy(tag_str + length, idx_str[i], idx_len[i]);
+            length += idx_len[i];
         }
+        tag_str[length] = 0;
+        return nitf_TREPrivateData_find(priv, tag_str);
     }
-    else
+
+    /* it is dependent on something in another loop,
+     * so, we need to figure out what level.
+     * since tags are unique, we are ok checking like this
+     */
+    length = ref->length < TAG_BUF_LEN ? ref->length : TAG_BUF_LEN - 1;
+    memcpy(tag_str, ref->tag, length);
+    tag_str[length] = 0;
+    pair = nitf_TREPrivateData_find(priv, tag_str);
+    for (i = 0; i < looping && !pair &&
+            length + idx_len[i] < TAG_BUF_LEN; ++i)
     {
-        /* it is dependent on something in another loop,
-         * so, we need to figure out what level.
-         * since tags are unique, we are ok checking like this
-         */
-        pair = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)tre->priv)->hash, tag_str);
-        for (i = 0; i < looping && !pair; ++i)
-        {
-            strcat(tag_str, idx_str[i]);
-            pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, tag_str);
-        }
+        memcpy(tag_str + length, idx_str[i], idx_len[i] + 1);
+        length += idx_len[i];
+        pair = nitf_TREPrivateData_find(priv, tag_str);
     }
-
-    /* pull the data from the hash about the dependent loop value */
-    pair = nitf_HashTable_find(((nitf_TREPrivateData*)tre->priv)->hash,
-                               tag_str);
     return pair;
 }
 
 
-
 NITFAPI(void) nitf_TRECursor_cleanup(nitf_TRECursor * tre_cursor)
 {
     nitf_IntStack_destruct(&tre_cursor->loop);
     nitf_IntStack_destruct(&tre_cursor->loop_idx);
     nitf_IntStack_destruct(&tre_cursor->loop_rtn);
+    nitf_TREPlan_destruct(&tre_cursor->ownPlan);
 }
 
 
@@ -222,11 +257,36 @@ NITFAPI(NITF_BOOL) nitf_TRECursor_isDone(nitf_TRECursor * tre_cursor)
     /* check if the passed in cursor is not at the beginning */
     if (!isDone && tre_cursor->index >= 0)
     {
-        nitf_TRECursor dolly = nitf_TRECursor_clone(tre_cursor, &error);
+        const nitf_TREPlan *plan = tre_cursor->plan;
+        int next = tre_cursor->index + 1;
+        nitf_IntStack loop, loop_idx, loop_rtn;
+        nitf_TRECursor dolly;
+
+        if (!plan || !tre_cursor->loop || !tre_cursor->loop_idx
+            || !tre_cursor->loop_rtn)
+            return 1;
+
+        /* a field of known length is next, whatever the data says */
+        if (next < plan->numItems &&
+                (plan->steps[next].kind == NITF_BCS_A ||
+                 plan->steps[next].kind == NITF_BCS_N ||
+                 plan->steps[next].kind == NITF_BINARY) &&
+                plan->description[next].data_count !=
+                    NITF_TRE_CONDITIONAL_LENGTH)
+            return 0;
+
+        /* otherwise, see if iterate finds one, on a copy of the stacks */
+        loop = *tre_cursor->loop;
+        loop_idx = *tre_cursor->loop_idx;
+        loop_rtn = *tre_cursor->loop_rtn;
+        dolly = *tre_cursor;
+        dolly.loop = &loop;
+        dolly.loop_idx = &loop_idx;
+        dolly.loop_rtn = &loop_rtn;
+
         /* if iterate returns 0, we are done */
         isDone = !nitf_TRECursor_iterate(&dolly, &error);
         isDone = isDone || (dolly.desc_ptr == dolly.end_ptr);
-        nitf_TRECursor_cleanup(&dolly);
     }
     return isDone;
 }
@@ -235,19 +295,20 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                                     nitf_Error * error)
 {
     nitf_TREDescription *dptr;
+    const nitf_TREPlanStep *step;
 
     int *stack;                 /* used for in conjuction with the stacks */
     int index;                  /* used for in conjuction with the stacks */
+    size_t tagLength;           /* how much of tag_str is filled in */
 
     int loopCount = 0;          /* tells how many times to loop */
     int loop_rtni = 0;          /* used for temp storage */
     int loop_idxi = 0;          /* used for temp storage */
 
-    int numIfs = 0;             /* used to keep track of nested Ifs */
-    int numLoops = 0;           /* used to keep track of nested Loops */
     int done = 0;               /* flag used for special cases */
 
     char idx_str[10][10];       /* used for keeping track of indexes */
+    int idx_len[10];            /* the length of each of those */
 
     if (!tre_cursor->loop || !tre_cursor->loop_idx
         || !tre_cursor->loop_rtn)
@@ -257,10 +318,14 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                         NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
         return NITF_FAILURE;
     }
+    if (!tre_cursor->plan)
+    {
+        nitf_Error_init(error, "Unable to plan the TRE description",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
 
-    /* count how many descriptions there are */
-
-	dptr = ((nitf_TREPrivateData*)tre_cursor->tre->priv)->description;
+	dptr = tre_cursor->plan->description;
 
     while (!done)
     {
@@ -271,10 +336,11 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
 
         if (tre_cursor->index < tre_cursor->numItems)
         {
-            memset(tre_cursor->tag_str, 0, TAG_BUF_LEN);
+            tre_cursor->tag_str[0] = 0;
 
             tre_cursor->prev_ptr = tre_cursor->desc_ptr;
             tre_cursor->desc_ptr = &dptr[tre_cursor->index];
+            step = &tre_cursor->plan->steps[tre_cursor->index];
 
             /* if already in a loop, prepare the array of values */
             if (tre_cursor->looping)
@@ -285,32 +351,32 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
 
                 for (index = 0; index < tre_cursor->looping; index++)
                 {
-                    NITF_SNPRINTF(idx_str[index], TAG_BUF_LEN,
-                                  "[%d]", stack[index]);
+                    idx_len[index] = nitf_TRECursor_formatIndex(
+                            idx_str[index], stack[index]);
                 }
             }
 
             /* check if it is an actual item now */
             /* ASCII string */
-            if ((tre_cursor->desc_ptr->data_type == NITF_BCS_A) ||
+            if ((step->kind == NITF_BCS_A) ||
                     /* ASCII number */
-                    (tre_cursor->desc_ptr->data_type == NITF_BCS_N) ||
+                    (step->kind == NITF_BCS_N) ||
                     /* raw bytes */
-                    (tre_cursor->desc_ptr->data_type == NITF_BINARY))
+                    (step->kind == NITF_BINARY))
             {
-                NITF_SNPRINTF(tre_cursor->tag_str, TAG_BUF_LEN, "%s",
-                        tre_cursor->desc_ptr->tag);
+                tagLength = step->ref.length < TAG_BUF_LEN ?
+                        step->ref.length : TAG_BUF_LEN - 1;
+                memcpy(tre_cursor->tag_str, tre_cursor->desc_ptr->tag,
+                       tagLength);
                 /* check if data is part of an array */
-                if (tre_cursor->looping)
+                for (index = 0; index < tre_cursor->looping &&
+                        tagLength + idx_len[index] < TAG_BUF_LEN; index++)
                 {
-                    stack = tre_cursor->loop_idx->st;
-                    for (index = 0; index < tre_cursor->looping; index++)
-                    {
-                        char entry[64];
-                        NITF_SNPRINTF(entry, 64, "[%d]", stack[index]);
-                        strcat(tre_cursor->tag_str, entry);
-                    }
+                    memcpy(tre_cursor->tag_str + tagLength, idx_str[index],
+                           idx_len[index]);
+                    tagLength += idx_len[index];
                 }
+                tre_cursor->tag_str[tagLength] = 0;
 
                 /* check to see if we don't know the length */
                 if (tre_cursor->desc_ptr->data_count ==
@@ -323,9 +389,10 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                         tre_cursor->length =
                             nitf_TRECursor_evaluatePostfix(
                                 tre_cursor->tre,
+                                step,
                                 idx_str,
+                                idx_len,
                                 tre_cursor->looping,
-                                tre_cursor->desc_ptr->special,
                                 error);
 
                         if (tre_cursor->length < 0)
@@ -355,18 +422,16 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                 }
             }
             /* NITF_LOOP, NITF_IF, etc. */
-            else if ((tre_cursor->desc_ptr->data_type >=
-                      NITF_LOOP)
-                     && (tre_cursor->desc_ptr->data_type < NITF_END))
+            else if ((step->kind >= NITF_LOOP) && (step->kind < NITF_END))
             {
                 done = 0;       /* set the flag */
 
                 /* start of a loop */
-                if (tre_cursor->desc_ptr->data_type == NITF_LOOP)
+                if (step->kind == NITF_LOOP)
                 {
                     loopCount =
-                        nitf_TRECursor_evalLoops(tre_cursor->tre,
-                                       tre_cursor->desc_ptr, idx_str,
+                        nitf_TRECursor_evalLoops(tre_cursor->tre, step,
+                                       tre_cursor->desc_ptr, idx_str, idx_len,
                                        tre_cursor->looping, error);
                     if (loopCount > 0)
                     {
@@ -382,25 +447,15 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                     }
                     else
                     {
-                        numLoops = 1;
-                        /* skip until we see the matching ENDLOOP */
-                        while (numLoops
-                                && (++tre_cursor->index <
-                                    tre_cursor->numItems))
-                        {
-                            tre_cursor->desc_ptr =
-                                &dptr[tre_cursor->index];
-                            if (tre_cursor->desc_ptr->data_type ==
-                                    NITF_LOOP)
-                                numLoops++;
-                            else if (tre_cursor->desc_ptr->data_type ==
-                                     NITF_ENDLOOP)
-                                numLoops--;
-                        }
+                        /* skip to the matching ENDLOOP */
+                        tre_cursor->index = step->end;
+                        tre_cursor->desc_ptr = &dptr[
+                            step->end < tre_cursor->numItems ?
+                                step->end : tre_cursor->numItems - 1];
                     }
                 }
                 /* end of a loop */
-                else if (tre_cursor->desc_ptr->data_type == NITF_ENDLOOP)
+                else if (step->kind == NITF_ENDLOOP)
                 {
                     /* retrieve loopcount from @loop stack */
                     loopCount = nitf_IntStack_pop(tre_cursor->loop, error);
@@ -431,28 +486,19 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                     }
                 }
                 /* an if clause */
-                else if (tre_cursor->desc_ptr->data_type == NITF_IF)
+                else if (step->kind == NITF_IF)
                 {
                     if (!nitf_TRECursor_evalIf
-                            (tre_cursor->tre,
+                            (tre_cursor->tre, step,
                              tre_cursor->desc_ptr,
-                             idx_str,
+                             idx_str, idx_len,
                              tre_cursor->looping, error))
                     {
-                        numIfs = 1;
-                        /* skip until we see the matching ENDIF */
-                        while (numIfs
-                                && (++tre_cursor->index <
-                                    tre_cursor->numItems))
-                        {
-                            tre_cursor->desc_ptr =
-                                &dptr[tre_cursor->index];
-                            if (tre_cursor->desc_ptr->data_type == NITF_IF)
-                                numIfs++;
-                            else if (tre_cursor->desc_ptr->data_type ==
-                                     NITF_ENDIF)
-                                numIfs--;
-                        }
+                        /* skip to the matching ENDIF */
+                        tre_cursor->index = step->end;
+                        tre_cursor->desc_ptr = &dptr[
+                            step->end < tre_cursor->numItems ?
+                                step->end : tre_cursor->numItems - 1];
                     }
                 }
             }
@@ -478,31 +524,24 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
  * Returns the number of loops that will be processed
  */
 NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE* tre,
+                                      const nitf_TREPlanStep* step,
                                       nitf_TREDescription* desc_ptr,
                                       char idx_str[10][10],
+                                      int idx_len[10],
                                       int looping, nitf_Error* error)
 {
     int loops;
 
-    /* temp buf used for manipulating the loop label */
-    char str[TAG_BUF_LEN];
-
     nitf_Pair *pair;
     nitf_Field *field;
 
-    char *op;
-    char *valPtr;
-
-    /* used for the possible data in the loop label */
-    int loopVal;
-
     /* if the user wants a constant value */
-    if (desc_ptr->label && strcmp(desc_ptr->label, NITF_CONST_N) == 0)
+    if (step->source == NITF_TRE_PLAN_CONSTANT)
     {
-        loops = NITF_ATO32(desc_ptr->tag);
+        loops = step->operand;
     }
 
-    else if (desc_ptr->label && strcmp(desc_ptr->label, NITF_FUNCTION) == 0)
+    else if (step->source == NITF_TRE_PLAN_FUNCTION)
     {
         NITF_TRE_CURSOR_COUNT_FUNCTION fn =
             (NITF_TRE_CURSOR_COUNT_FUNCTION)desc_ptr->tag;
@@ -516,8 +555,8 @@ NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE* tre,
 
     else
     {
-        pair = nitf_TRECursor_getTREPair(tre, desc_ptr->tag,
-                                         idx_str, looping, error);
+        pair = nitf_TRECursor_findPair(tre, &step->ref,
+                                       idx_str, idx_len, looping);
         if (!pair)
         {
             nitf_Error_init(error,
@@ -534,62 +573,39 @@ NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE* tre,
             return NITF_FAILURE;
         }
 
-        /* if the label is not empty, then apply some functionality */
-        if (desc_ptr->label && strlen(desc_ptr->label) != 0)
+        /* if the label had an operator, apply it */
+        switch (step->op)
         {
-            assert(strlen(desc_ptr->label) < sizeof(str));
-
-            strcpy(str, desc_ptr->label);
-            op = str;
-            while (isspace(*op))
-                op++;
-
-            if ((*op == '+') ||
-                    (*op == '-') ||
-                    (*op == '*') || (*op == '/') || (*op == '%'))
-            {
-                valPtr = op + 1;
-                while (isspace(*valPtr))
-                    valPtr++;
-
-                loopVal = NITF_ATO32(valPtr);
-
-                switch (*op)
+            case 0:
+                break;
+            case '+':
+                loops += step->operand;
+                break;
+            case '-':
+                loops -= step->operand;
+                break;
+            case '*':
+                loops *= step->operand;
+                break;
+            case '/':
+                /* check for divide by zero */
+                if (step->operand == 0)
                 {
-                    case '+':
-                        loops += loopVal;
-                        break;
-                    case '-':
-                        loops -= loopVal;
-                        break;
-                    case '*':
-                        loops *= loopVal;
-                        break;
-                    case '/':
-                        /* check for divide by zero */
-                        if (loopVal == 0)
-                        {
-                            nitf_Error_init(error,
-                                            "nitf_TRECursor_evalLoops: attempt to divide by zero",
-                                            NITF_CTXT,
-                                            NITF_ERR_INVALID_PARAMETER);
-                            return NITF_FAILURE;
-                        }
-                        loops /= loopVal;
-                        break;
-                    case '%':
-                        loops %= loopVal;
-                        break;
-                    default:
-                        break;
+                    nitf_Error_init(error,
+                                    "nitf_TRECursor_evalLoops: attempt to divide by zero",
+                                    NITF_CTXT,
+                                    NITF_ERR_INVALID_PARAMETER);
+                    return NITF_FAILURE;
                 }
-            }
-            else
-            {
+                loops /= step->operand;
+                break;
+            case '%':
+                loops %= step->operand;
+                break;
+            default:
                 nitf_Error_init(error, "nitf_TRECursor_evalLoops: invalid operator",
                                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
                 return NITF_FAILURE;
-            }
         }
     }
     return loops < 0 ? 0 : loops;
@@ -597,38 +613,28 @@ NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE* tre,
 
 
 NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
+                                   const nitf_TREPlanStep* step,
                                    nitf_TREDescription* desc_ptr,
                                    char idx_str[10][10],
+                                   int idx_len[10],
                                    int looping,
                                    nitf_Error* error)
 {
     nitf_Field *field;
     nitf_Pair *pair;
 
-    /* temp buf for the label */
-    char str[TAG_BUF_LEN];
-    char *emptyPtr;
-    char *op;
-    char *valPtr;
-
     /* the return status */
     int status = 0;
 
     /* used as the value for comparing */
     int fieldData;
 
-    /* the value defined int the TRE descrip */
-    int treData;
-
     /* the bit-field for comparing */
     unsigned int bitFieldData;
 
-    /* the bit-field defined in the TRE descrip */
-    unsigned int treBitField;
-
-    /* get the data out of the hashtable */
-    pair = nitf_TRECursor_getTREPair(tre, desc_ptr->tag, idx_str,
-                                     looping, error);
+    /* get the data out of the TRE */
+    pair = nitf_TRECursor_findPair(tre, &step->ref, idx_str,
+                                   idx_len, looping);
     if (!pair)
     {
         nitf_Error_init(error, "Unable to find tag in TRE hash",
@@ -636,340 +642,196 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
         return NITF_FAILURE;
     }
     field = (nitf_Field *) pair->data;
-    assert(strlen(desc_ptr->label) < sizeof(str));
-
-    strcpy(str, desc_ptr->label);
-    op = str;
 
-    while (isspace(*op))
-        op++;
+    switch (step->op)
+    {
+        /* a string comparison of either 'eq' or 'ne' */
+        case NITF_TRE_PLAN_EQ:
+        case NITF_TRE_PLAN_NE:
+            /* must be a string */
+            if (field->type == NITF_BCS_N)
+            {
+                nitf_Error_init(error,
+                                "evaluate: can't use eq/ne to compare a number",
+                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return NITF_FAILURE;
+            }
+            status = strncmp(field->raw, step->text, field->length);
+            status = step->op == NITF_TRE_PLAN_EQ ? !status : status;
+            break;
+
+        /* a bit-wise operator */
+        case NITF_TRE_PLAN_AND:
+            /* make sure it is a binary field */
+            if (field->type != NITF_BINARY)
+            {
+                nitf_Error_init(error,
+                                "evaluate: must use binary data for bit-wise expressions",
+                                NITF_CTXT,
+                                NITF_ERR_INVALID_PARAMETER);
+                return NITF_FAILURE;
+            }
 
-    /* split the string at the space */
-    emptyPtr = strchr(op, ' ');
-    *emptyPtr = 0;
+            if (!nitf_Field_get(field,
+                                (char *)&bitFieldData,
+                                NITF_CONV_UINT,
+                                sizeof(bitFieldData),
+                                error))
+            {
+                return NITF_FAILURE;
+            }
 
-    /* remember where the operand is */
-    valPtr = emptyPtr + 1;
+            /* check this bit field */
+            status = ((step->bits & bitFieldData) != 0);
+            break;
 
-    /* check if it is a string comparison of either 'eq' or 'ne' */
-    if ((strcmp(op, "eq") == 0) || (strcmp(op, "ne") == 0))
-    {
-        /* must be a string */
-        if (field->type == NITF_BCS_N)
-        {
-            nitf_Error_init(error,
-                            "evaluate: can't use eq/ne to compare a number",
-                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-            return NITF_FAILURE;
-        }
-        status = strncmp(field->raw, valPtr, field->length);
-        status = strcmp(op, "eq") == 0 ? !status : status;
-    }
-    /* check if it is a logical operator for ints */
-    else if ((strcmp(op, "<") == 0) ||
-             (strcmp(op, ">") == 0) ||
-             (strcmp(op, ">=") == 0) ||
-             (strcmp(op, "<=") == 0) ||
-             (strcmp(op, "==") == 0) || (strcmp(op, "!=") == 0))
-    {
-        /* make sure it is a number */
-        if (field->type != NITF_BCS_N)
-        {
-            nitf_Error_init(error,
-                            "evaluate: can't use strings for logical expressions",
+        /* otherwise, they used a bad operator */
+        case NITF_TRE_PLAN_INVALID:
+            nitf_Error_init(error, "evaluate: invalid comparison operator",
                             NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
             return NITF_FAILURE;
-        }
 
-        treData = NITF_ATO32(valPtr);
-        if (!nitf_Field_get
-                (field, (char *) &fieldData, NITF_CONV_INT, sizeof(fieldData),
-                 error))
-        {
-            return NITF_FAILURE;
-        }
-
-        /* 0 -> equal, <0 -> less true, >0 greater true */
-        status = fieldData - treData;
-
-        if (strcmp(op, ">") == 0)
-            status = (status > 0);
-        else if (strcmp(op, "<") == 0)
-            status = (status < 0);
-        else if (strcmp(op, ">=") == 0)
-            status = (status >= 0);
-        else if (strcmp(op, "<=") == 0)
-            status = (status <= 0);
-        else if (strcmp(op, "==") == 0)
-            status = (status == 0);
-        else if (strcmp(op, "!=") == 0)
-            status = (status != 0);
-    }
-    /* check if it is a bit-wise operator */
-    else if (strcmp(op, "&") == 0)
-    {
-        /* make sure it is a binary field */
-        if (field->type != NITF_BINARY)
-        {
-            nitf_Error_init(error,
-                            "evaluate: must use binary data for bit-wise expressions",
-                            NITF_CTXT,
-                            NITF_ERR_INVALID_PARAMETER);
-            return NITF_FAILURE;
-        }
+        /* a logical operator for ints */
+        default:
+            /* make sure it is a number */
+            if (field->type != NITF_BCS_N)
+            {
+                nitf_Error_init(error,
+                                "evaluate: can't use strings for logical expressions",
+                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return NITF_FAILURE;
+            }
 
-        treBitField = NITF_ATOU32_BASE(valPtr, 0);
-        if (!nitf_Field_get(field,
-                            (char *)&bitFieldData,
-                            NITF_CONV_UINT,
-                            sizeof(bitFieldData),
-                            error))
-        {
-            return NITF_FAILURE;
-        }
+            if (!nitf_Field_get
+                    (field, (char *) &fieldData, NITF_CONV_INT,
+                     sizeof(fieldData), error))
+            {
+                return NITF_FAILURE;
+            }
 
-        /* check this bit field */
-        status = ((treBitField & bitFieldData) != 0);
-    }
-    /* otherwise, they used a bad operator */
-    else
-    {
-        nitf_Error_init(error, "evaluate: invalid comparison operator",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return NITF_FAILURE;
+            /* 0 -> equal, <0 -> less true, >0 greater true */
+            status = fieldData - step->operand;
+
+            if (step->op == NITF_TRE_PLAN_GT)
+                status = (status > 0);
+            else if (step->op == NITF_TRE_PLAN_LT)
+                status = (status < 0);
+            else if (step->op == NITF_TRE_PLAN_GE)
+                status = (status >= 0);
+            else if (step->op == NITF_TRE_PLAN_LE)
+                status = (status <= 0);
+            else if (step->op == NITF_TRE_PLAN_EQUAL)
+                status = (status == 0);
+            else if (step->op == NITF_TRE_PLAN_UNEQUAL)
+                status = (status != 0);
+            break;
     }
     return status;
 }
 
 
 
-/**
- * Helper function for evaluating loops
- * Returns the number of loops that will be processed
- */
-NITFPRIV(int) nitf_TRECursor_evalCondLength(nitf_TRE* tre,
-                                           nitf_TREDescription* desc_ptr,
-                                           char idx_str[10][10],
-                                           int looping,
-                                           nitf_Error* error)
-{
-    int computedLength;
-    /* temp buf used for manipulating the loop label */
-    char str[TAG_BUF_LEN];
-    nitf_Pair *pair;
-    nitf_Field *field;
-
-    char *op;
-    char *valPtr;
-
-    /* used for the possible data in the description label */
-    int funcVal;
-
-    pair = nitf_TRECursor_getTREPair(tre, desc_ptr->tag,
-                                     idx_str, looping, error);
-    if (!pair)
-    {
-        nitf_Error_init(error,
-                        "nitf_TRECursor_evalCondLength: invalid TRE reference",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return NITF_FAILURE;
-    }
-    field = (nitf_Field *) pair->data;
-
-    /* get the int value */
-    if (!nitf_Field_get
-            (field, (char *) &computedLength, NITF_CONV_INT,
-             sizeof(computedLength), error))
-    {
-        return NITF_FAILURE;
-    }
-
-    /* if the label is not empty, then apply some functionality */
-    if (desc_ptr->label && strlen(desc_ptr->label) != 0)
-    {
-        assert(strlen(desc_ptr->label) < sizeof(str));
-
-        strcpy(str, desc_ptr->label);
-        op = str;
-        while (isspace(*op))
-            op++;
-        if ((*op == '+') ||
-                (*op == '-') || (*op == '*') || (*op == '/') || (*op == '%'))
-        {
-            valPtr = op + 1;
-            while (isspace(*valPtr))
-                valPtr++;
-
-            funcVal = NITF_ATO32(valPtr);
-
-            switch (*op)
-            {
-                case '+':
-                    computedLength += funcVal;
-                    break;
-                case '-':
-                    computedLength -= funcVal;
-                    break;
-                case '*':
-                    computedLength *= funcVal;
-                    break;
-                case '/':
-                    /* check for divide by zero */
-                    if (funcVal == 0)
-                    {
-                        nitf_Error_init(error,
-                                        "nitf_TRECursor_evalCondLength: attempt to divide by zero",
-                                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                        return NITF_FAILURE;
-                    }
-                    computedLength /= funcVal;
-                    break;
-                case '%':
-                    computedLength %= funcVal;
-                    break;
-                default:
-                    break;
-            }
-        }
-        else
-        {
-            nitf_Error_init(error,
-                            "nitf_TRECursor_evalCondLength: invalid operator",
-                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-            return NITF_FAILURE;
-        }
-    }
-    return computedLength < 0 ? 0 : computedLength;
-}
-
 NITFPRIV(int) nitf_TRECursor_evaluatePostfix(nitf_TRE *tre,
+                                             const nitf_TREPlanStep *step,
                                              char idx[10][10],
+                                             int idx_len[10],
                                              int looping,
-                                             char *expression,
                                              nitf_Error *error)
 {
-    nitf_List *parts = NULL;
-    nitf_IntStack *stack = NULL;
-    int expressionValue;
-
-    /* create the postfix stack */
-    stack = nitf_IntStack_construct(error);
-    if (!stack)
-        goto CATCH_ERROR;
+    int stack[NITF_TRE_PLAN_DEPTH];
+    int depth = 0;
+    int i;
 
-    /* split the expression by spaces */
-    parts = nitf_Utils_splitString(expression, 0, error);
-    if (!parts)
-        goto CATCH_ERROR;
+    if (step->depth > NITF_TRE_PLAN_DEPTH)
+    {
+        nitf_Error_init(error,
+                "nitf_TRECursor_evaluatePostfix: expression is too deep",
+                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return -1;
+    }
 
-    while(!nitf_List_isEmpty(parts))
+    for (i = 0; i < step->numTerms; ++i)
     {
-        char* expr = (char*) nitf_List_popFront(parts);
-        if (strlen(expr) == 1 &&
-                (expr[0] == '+' || expr[0] == '-' || expr[0] == '*' ||
-                        expr[0] == '/' || expr[0] == '%'))
+        const nitf_TREPlanTerm *term = &step->terms[i];
+        if (term->op)
         {
-            int op1, op2, stackSize;
-            stackSize = nitf_IntStack_depth(stack, error) + 1;
+            int op1, op2;
 
-            if (stackSize == 0)
+            if (depth == 0)
             {
                 /* error for postfix... */
                 nitf_Error_init(error,
                         "nitf_TRECursor_evaluatePostfix: invalid expression",
                         NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                goto CATCH_ERROR;
+                return -1;
             }
 
-            op2 = nitf_IntStack_pop(stack, error);
-            if (stackSize == 1)
-                op1 = 0; /* assume 0 for the first operand of a unary op */
-            else
-                op1 = nitf_IntStack_pop(stack, error);
+            op2 = stack[--depth];
+            /* assume 0 for the first operand of a unary op */
+            op1 = depth ? stack[--depth] : 0;
 
-            switch(expr[0])
+            switch(term->op)
             {
             case '+':
-                nitf_IntStack_push(stack, (op1 + op2), error);
+                stack[depth++] = op1 + op2;
                 break;
             case '-':
-                nitf_IntStack_push(stack, (op1 - op2), error);
+                stack[depth++] = op1 - op2;
                 break;
             case '*':
-                nitf_IntStack_push(stack, (op1 * op2), error);
+                stack[depth++] = op1 * op2;
                 break;
             case '/':
+            case '%':
                 /* check for divide by zero */
                 if (op2 == 0)
                 {
                     nitf_Error_init(error,
                             "nitf_TRECursor_evaluatePostfix: attempt to divide by zero",
                             NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                    goto CATCH_ERROR;
+                    return -1;
                 }
-                nitf_IntStack_push(stack, (op1 / op2), error);
-                break;
-            case '%':
-                nitf_IntStack_push(stack, (op1 % op2), error);
+                stack[depth++] = term->op == '/' ? op1 / op2 : op1 % op2;
                 break;
             }
         }
-        else
+        else if (term->ref.tag)
         {
-            /* evaluate as an integer and push onto the stack */
-            if (nitf_Utils_isNumeric(expr))
+            /* must be a dependent field */
+            int intVal;
+            nitf_Field *field = NULL;
+            nitf_Pair *pair = nitf_TRECursor_findPair(tre, &term->ref, idx,
+                    idx_len, looping);
+
+            if (!pair)
             {
-                nitf_IntStack_push(stack, NITF_ATO32(expr), error);
+                nitf_Error_init(error,
+                        "nitf_TRECursor_evaluatePostfix: invalid TRE field reference",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return -1;
             }
-            else
-            {
-                /* must be a dependent field */
-                int intVal;
-                nitf_Field *field = NULL;
-                nitf_Pair *pair = nitf_TRECursor_getTREPair(tre, expr, idx,
-                        looping, error);
-
-                if (!pair)
-                {
-                    nitf_Error_init(error,
-                            "nitf_TRECursor_evaluatePostfix: invalid TRE field reference",
-                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                    goto CATCH_ERROR;
-                }
-                field = (nitf_Field *) pair->data;
+            field = (nitf_Field *) pair->data;
 
-                /* get the int value */
-                if (!nitf_Field_get(field, (char*) &intVal, NITF_CONV_INT,
-                         sizeof(intVal), error))
-                {
-                    goto CATCH_ERROR;
-                }
-                nitf_IntStack_push(stack, intVal, error);
+            /* get the int value */
+            if (!nitf_Field_get(field, (char*) &intVal, NITF_CONV_INT,
+                     sizeof(intVal), error))
+            {
+                return -1;
             }
+            stack[depth++] = intVal;
+        }
+        else
+        {
+            stack[depth++] = term->value;
         }
-
-        /* must cleanup after ourselves */
-        if (expr)
-            NITF_FREE(expr);
     }
 
     /* if all is well, the postfix stack should have one value */
-    if (nitf_IntStack_depth(stack, error) != 0)
+    if (depth != 1)
     {
         nitf_Error_init(error, "Invalid postfix expression",
                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        goto CATCH_ERROR;
+        return -1;
     }
-
-    expressionValue = nitf_IntStack_pop(stack, error);
-
-    nitf_IntStack_destruct(&stack);
-    nitf_List_destruct(&parts);
-
-    return expressionValue;
-
-  CATCH_ERROR:
-    if (stack) nitf_IntStack_destruct(&stack);
-    if (parts) nitf_List_destruct(&parts);
-    return -1;
+    return stack[0];
 }
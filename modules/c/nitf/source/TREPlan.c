@@ -0,0 +1,590 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/TREPlan.h"
+#include "nitf/TRE.h"
+
+/*
+ *  Registered plans, by handler and description.  The table is open
+ *  addressed and read without the lock: slots are filled with release
+ *  stores, and a table that outgrows itself is copied and the copy
+ *  published.  Neither the old tables nor plans that are replaced can be
+ *  freed while a cursor may still be using them, so they are kept until
+ *  nitf_TREPlan_unload.
+ */
+typedef struct _TREPlanTable
+{
+    size_t slots;
+    nitf_TREPlan * volatile *plans;
+    struct _TREPlanTable *older;        /* the table this one replaced */
+} TREPlanTable;
+
+static TREPlanTable * volatile __TREPlanTable = NULL;
+static size_t __TREPlanCount = 0;
+static nitf_TREPlan *__TREPlansReplaced = NULL;
+
+#if defined(__GNUC__)
+#   define PLAN_LOAD(X) __atomic_load_n(&(X), __ATOMIC_ACQUIRE)
+#   define PLAN_STORE(X, V) __atomic_store_n(&(X), (V), __ATOMIC_RELEASE)
+#else
+#   define PLAN_LOAD(X) (X)
+#   define PLAN_STORE(X, V) ((X) = (V))
+#endif
+
+#ifndef WIN32
+    static nitf_Mutex  __TREPlanLock = NITF_MUTEX_INIT;
+#   define GET_MUTEX() &__TREPlanLock
+#else
+    static nitf_Mutex __TREPlanLock = NULL;
+    static long __TREPlanInitLock = 0;
+
+NITFPRIV(nitf_Mutex*) GET_MUTEX()
+{
+    if (__TREPlanLock == NULL)
+    {
+        while (InterlockedExchange(&__TREPlanInitLock, 1) == 1)
+            /* loop, another thread own the lock */ ;
+        if (__TREPlanLock == NULL)
+            nitf_Mutex_init(&__TREPlanLock);
+        InterlockedExchange(&__TREPlanInitLock, 0);
+    }
+    return &__TREPlanLock;
+}
+#endif
+
+
+NITFPRIV(void) destructStep(nitf_TREPlanStep *step)
+{
+    int i;
+    if (step->text)
+        NITF_FREE(step->text);
+    if (step->terms)
+    {
+        for (i = 0; i < step->numTerms; ++i)
+        {
+            if (step->terms[i].ref.tag)
+                NITF_FREE(step->terms[i].ref.tag);
+        }
+        NITF_FREE(step->terms);
+    }
+}
+
+NITFPRIV(void) destructPlan(nitf_TREPlan **plan)
+{
+    int i;
+    if (*plan)
+    {
+        if ((*plan)->steps)
+        {
+            for (i = 0; i < (*plan)->numItems; ++i)
+                destructStep(&(*plan)->steps[i]);
+            NITF_FREE((*plan)->steps);
+        }
+        if ((*plan)->entries)
+            NITF_FREE((*plan)->entries);
+        NITF_FREE(*plan);
+        *plan = NULL;
+    }
+}
+
+/*
+ *  Finds where the block opened at index is closed, counting only the
+ *  same kind of block, as the cursor does when it skips one.
+ */
+NITFPRIV(int) findEnd(nitf_TREDescription *description, int numItems,
+                      int index, int open, int close)
+{
+    int depth = 1;
+    while (depth && ++index < numItems)
+    {
+        if (description[index].data_type == open)
+            depth++;
+        else if (description[index].data_type == close)
+            depth--;
+    }
+    return index;
+}
+
+/*
+ *  Measures a tag for the cursor's lookups.  The ref takes the tag as
+ *  given; it does not copy it.
+ */
+NITFPRIV(void) compileRef(char *tag, nitf_TREPlanRef *ref)
+{
+    const char *bracket = strchr(tag, '[');
+
+    ref->tag = tag;
+    ref->length = strlen(tag);
+    ref->baseLength = bracket ? (size_t)(bracket - tag) : ref->length;
+    for (; bracket; bracket = strchr(bracket + 1, '['))
+        ref->brackets++;
+}
+
+/*
+ *  Splits a conditional length's postfix expression into terms, in the
+ *  way the cursor used to split it each time: on white space, with
+ *  operators and numbers told apart from field names.
+ */
+NITFPRIV(NITF_BOOL) compileExpression(const char *expression,
+                                      nitf_TREPlanStep *step,
+                                      nitf_Error *error)
+{
+    const char *cur = expression;
+    const char *start;
+    nitf_TREPlanTerm *term;
+    size_t length;
+    size_t i;
+    int depth = 0;
+    int numTerms = 0;
+
+    /* count the terms first, so they can go in one array */
+    while (*cur)
+    {
+        while (isspace(*cur))
+            cur++;
+        if (!*cur)
+            break;
+        numTerms++;
+        while (*cur && !isspace(*cur))
+            cur++;
+    }
+
+    step->terms = (nitf_TREPlanTerm *) NITF_MALLOC(
+            sizeof(nitf_TREPlanTerm) * (numTerms ? numTerms : 1));
+    if (!step->terms)
+        goto CATCH_ERROR;
+    memset(step->terms, 0, sizeof(nitf_TREPlanTerm) * (numTerms ? numTerms : 1));
+
+    for (cur = expression; step->numTerms < numTerms; )
+    {
+        while (isspace(*cur))
+            cur++;
+        start = cur;
+        while (*cur && !isspace(*cur))
+            cur++;
+        length = cur - start;
+        term = &step->terms[step->numTerms++];
+
+        if (length == 1 && strchr("+-*/%", *start))
+        {
+            /* pops one or two values and pushes one */
+            term->op = *start;
+            if (depth > 1)
+                depth--;
+            continue;
+        }
+
+        for (i = 0; i < length && isdigit(start[i]); ++i)
+            ;
+        if (i == length)
+        {
+            term->value = NITF_ATO32(start);
+        }
+        else
+        {
+            char *tag = (char *) NITF_MALLOC(length + 1);
+            if (!tag)
+                goto CATCH_ERROR;
+            memcpy(tag, start, length);
+            tag[length] = 0;
+            compileRef(tag, &term->ref);
+        }
+        if (++depth > step->depth)
+            step->depth = depth;
+    }
+    return NITF_SUCCESS;
+
+  CATCH_ERROR:
+    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                    NITF_CTXT, NITF_ERR_MEMORY);
+    return NITF_FAILURE;
+}
+
+NITFPRIV(void) compileLoop(nitf_TREDescription *entry, nitf_TREPlanStep *step)
+{
+    const char *op;
+
+    if (entry->label && strcmp(entry->label, NITF_CONST_N) == 0)
+    {
+        step->source = NITF_TRE_PLAN_CONSTANT;
+        step->operand = NITF_ATO32(entry->tag);
+        return;
+    }
+    if (entry->label && strcmp(entry->label, NITF_FUNCTION) == 0)
+    {
+        step->source = NITF_TRE_PLAN_FUNCTION;
+        return;
+    }
+
+    step->source = NITF_TRE_PLAN_FIELD;
+    if (entry->label && strlen(entry->label) != 0)
+    {
+        op = entry->label;
+        while (isspace(*op))
+            op++;
+
+        if (*op && strchr("+-*/%", *op))
+        {
+            step->op = *op++;
+            while (isspace(*op))
+                op++;
+            step->operand = NITF_ATO32(op);
+        }
+        else
+        {
+            step->op = -1;
+        }
+    }
+}
+
+NITFPRIV(NITF_BOOL) compileIf(nitf_TREDescription *entry,
+                              nitf_TREPlanStep *step,
+                              nitf_Error *error)
+{
+    static const struct
+    {
+        const char *name;
+        int test;
+    } tests[] =
+    {
+        { "eq", NITF_TRE_PLAN_EQ },
+        { "ne", NITF_TRE_PLAN_NE },
+        { "<", NITF_TRE_PLAN_LT },
+        { ">", NITF_TRE_PLAN_GT },
+        { "<=", NITF_TRE_PLAN_LE },
+        { ">=", NITF_TRE_PLAN_GE },
+        { "==", NITF_TRE_PLAN_EQUAL },
+        { "!=", NITF_TRE_PLAN_UNEQUAL },
+        { "&", NITF_TRE_PLAN_AND }
+    };
+    const char *op;
+    const char *space;
+    const char *value;
+    size_t i;
+
+    step->op = NITF_TRE_PLAN_INVALID;
+    if (!entry->label)
+        return NITF_SUCCESS;
+
+    op = entry->label;
+    while (isspace(*op))
+        op++;
+
+    /* the operator runs up to the first space, the operand follows it */
+    space = strchr(op, ' ');
+    if (!space)
+        return NITF_SUCCESS;
+    value = space + 1;
+
+    for (i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i)
+    {
+        if (strlen(tests[i].name) == (size_t)(space - op) &&
+                strncmp(op, tests[i].name, space - op) == 0)
+        {
+            step->op = tests[i].test;
+            break;
+        }
+    }
+
+    switch (step->op)
+    {
+        case NITF_TRE_PLAN_EQ:
+        case NITF_TRE_PLAN_NE:
+            step->text = (char *) NITF_MALLOC(strlen(value) + 1);
+            if (!step->text)
+            {
+                nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                                NITF_CTXT, NITF_ERR_MEMORY);
+                return NITF_FAILURE;
+            }
+            strcpy(step->text, value);
+            break;
+        case NITF_TRE_PLAN_AND:
+            step->bits = NITF_ATOU32_BASE(value, 0);
+            break;
+        case NITF_TRE_PLAN_INVALID:
+            break;
+        default:
+            step->operand = NITF_ATO32(value);
+            break;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_TREPlan *) compilePlan(nitf_TREDescription *description,
+                                     nitf_Error *error)
+{
+    nitf_TREPlan *plan = NULL;
+    nitf_TREDescription *entry;
+    nitf_TREPlanStep *step;
+    int numItems = 0;
+    int i;
+
+    while (description[numItems].data_type != NITF_END)
+        numItems++;
+
+    plan = (nitf_TREPlan *) NITF_MALLOC(sizeof(nitf_TREPlan));
+    if (!plan)
+        goto CATCH_ERROR;
+    memset(plan, 0, sizeof(nitf_TREPlan));
+    plan->description = description;
+    plan->numItems = numItems;
+
+    plan->entries = (nitf_TREDescription *) NITF_MALLOC(
+            sizeof(nitf_TREDescription) * (numItems + 1));
+    plan->steps = (nitf_TREPlanStep *) NITF_MALLOC(
+            sizeof(nitf_TREPlanStep) * (numItems + 1));
+    if (!plan->entries || !plan->steps)
+        goto CATCH_ERROR;
+    memcpy(plan->entries, description,
+           sizeof(nitf_TREDescription) * (numItems + 1));
+    memset(plan->steps, 0, sizeof(nitf_TREPlanStep) * (numItems + 1));
+
+    for (i = 0; i < numItems; ++i)
+    {
+        entry = &description[i];
+        step = &plan->steps[i];
+        step->kind = entry->data_type;
+
+        if (entry->data_type == NITF_LOOP)
+        {
+            step->end = findEnd(description, numItems, i,
+                                NITF_LOOP, NITF_ENDLOOP);
+            compileLoop(entry, step);
+            if (step->source != NITF_TRE_PLAN_FIELD)
+                continue;
+        }
+        else if (entry->data_type == NITF_IF)
+        {
+            step->end = findEnd(description, numItems, i,
+                                NITF_IF, NITF_ENDIF);
+            if (!compileIf(entry, step, error))
+            {
+                destructPlan(&plan);
+                return NULL;
+            }
+        }
+        else if (entry->data_count == NITF_TRE_CONDITIONAL_LENGTH &&
+                 entry->special)
+        {
+            if (!compileExpression(entry->special, step, error))
+            {
+                destructPlan(&plan);
+                return NULL;
+            }
+        }
+
+        if (entry->tag)
+            compileRef(entry->tag, &step->ref);
+    }
+    return plan;
+
+  CATCH_ERROR:
+    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                    NITF_CTXT, NITF_ERR_MEMORY);
+    destructPlan(&plan);
+    return NULL;
+}
+
+/*
+ *  True if the description still holds what the plan was built from.
+ */
+NITFPRIV(NITF_BOOL) planMatches(const nitf_TREPlan *plan,
+                                nitf_TREDescription *description)
+{
+    int i;
+    for (i = 0; i <= plan->numItems; ++i)
+    {
+        nitf_TREDescription *was = &plan->entries[i];
+        if (description[i].data_type != was->data_type ||
+                description[i].data_count != was->data_count ||
+                description[i].label != was->label ||
+                description[i].tag != was->tag ||
+                description[i].special != was->special)
+        {
+            return NITF_FAILURE;
+        }
+    }
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(size_t) findSlot(TREPlanTable *table, nitf_TREHandler *handler,
+                          nitf_TREDescription *description)
+{
+    size_t mask = table->slots - 1;
+    size_t slot = (((size_t) description >> 4) * 2654435761U) & mask;
+    nitf_TREPlan *plan;
+
+    while ((plan = PLAN_LOAD(table->plans[slot])) != NULL &&
+            (plan->handler != handler || plan->description != description))
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+NITFPRIV(NITF_BOOL) growPlans(nitf_Error *error)
+{
+    TREPlanTable *old = __TREPlanTable;
+    TREPlanTable *table;
+    size_t slots = old ? old->slots * 2 : 64;
+    size_t i;
+
+    table = (TREPlanTable *) NITF_MALLOC(sizeof(TREPlanTable));
+    if (!table)
+        goto CATCH_ERROR;
+    table->plans = (nitf_TREPlan * volatile *)
+        NITF_MALLOC(sizeof(nitf_TREPlan *) * slots);
+    if (!table->plans)
+    {
+        NITF_FREE(table);
+        goto CATCH_ERROR;
+    }
+    memset((void *) table->plans, 0, sizeof(nitf_TREPlan *) * slots);
+    table->slots = slots;
+    table->older = old;
+
+    for (i = 0; old && i < old->slots; ++i)
+    {
+        nitf_TREPlan *plan = old->plans[i];
+        if (plan)
+            table->plans[findSlot(table, plan->handler,
+                                  plan->description)] = plan;
+    }
+    PLAN_STORE(__TREPlanTable, table);
+    return NITF_SUCCESS;
+
+  CATCH_ERROR:
+    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                    NITF_CTXT, NITF_ERR_MEMORY);
+    return NITF_FAILURE;
+}
+
+NITFPROT(NITF_BOOL) nitf_TREPlan_register(nitf_TREHandler * handler,
+                                          nitf_TREDescriptionSet * set,
+                                          nitf_Error * error)
+{
+    nitf_TREDescriptionInfo *info;
+    NITF_BOOL ok = NITF_SUCCESS;
+
+    nitf_Mutex_lock(GET_MUTEX());
+
+    for (info = set->descriptions; ok && info && info->description; ++info)
+    {
+        TREPlanTable *table = __TREPlanTable;
+        nitf_TREPlan *plan;
+        nitf_TREPlan *fresh;
+        size_t slot;
+
+        if (!table || (__TREPlanCount + 1) * 2 > table->slots)
+        {
+            ok = growPlans(error);
+            if (!ok)
+                break;
+            table = __TREPlanTable;
+        }
+
+        slot = findSlot(table, handler, info->description);
+        plan = table->plans[slot];
+        if (plan && planMatches(plan, info->description))
+            continue;
+
+        fresh = compilePlan(info->description, error);
+        if (!fresh)
+        {
+            ok = NITF_FAILURE;
+            break;
+        }
+        fresh->handler = handler;
+        if (plan)
+        {
+            plan->next = __TREPlansReplaced;
+            __TREPlansReplaced = plan;
+        }
+        else
+        {
+            __TREPlanCount++;
+        }
+        PLAN_STORE(table->plans[slot], fresh);
+    }
+
+    nitf_Mutex_unlock(GET_MUTEX());
+    return ok;
+}
+
+NITFPROT(const nitf_TREPlan *) nitf_TREPlan_get(
+        nitf_TREHandler * handler, nitf_TREDescription * description)
+{
+    TREPlanTable *table = PLAN_LOAD(__TREPlanTable);
+
+    if (!table || !description)
+        return NULL;
+    return PLAN_LOAD(table->plans[findSlot(table, handler, description)]);
+}
+
+NITFPROT(nitf_TREPlan *) nitf_TREPlan_construct(
+        nitf_TREDescription * description, nitf_Error * error)
+{
+    if (!description)
+    {
+        nitf_Error_init(error, "No TRE description to plan",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NULL;
+    }
+    return compilePlan(description, error);
+}
+
+NITFPROT(void) nitf_TREPlan_destruct(nitf_TREPlan ** plan)
+{
+    destructPlan(plan);
+}
+
+NITFPROT(void) nitf_TREPlan_unload(void)
+{
+    TREPlanTable *table;
+    nitf_TREPlan *plan;
+    size_t i;
+
+    nitf_Mutex_lock(GET_MUTEX());
+
+    table = __TREPlanTable;
+    for (i = 0; table && i < table->slots; ++i)
+    {
+        plan = table->plans[i];
+        destructPlan(&plan);
+    }
+    while (table)
+    {
+        TREPlanTable *older = table->older;
+        NITF_FREE((void *) table->plans);
+        NITF_FREE(table);
+        table = older;
+    }
+    while (__TREPlansReplaced)
+    {
+        plan = __TREPlansReplaced;
+        __TREPlansReplaced = plan->next;
+        destructPlan(&plan);
+    }
+    PLAN_STORE(__TREPlanTable, (TREPlanTable *) NULL);
+    __TREPlanCount = 0;
+
+    nitf_Mutex_unlock(GET_MUTEX());
+}
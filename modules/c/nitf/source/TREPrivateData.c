@@ -22,12 +22,201 @@
 
 #include "nitf/TREPrivateData.h"
 
+/* The field names are copied into blocks of this size, so a TRE with a
+ * few thousand fields makes a handful of allocations instead of one for
+ * every name.
+ */
+#define NITF_TRE_KEY_BLOCK_SIZE 4096
+
+typedef struct _nitf_TREKeyBlock
+{
+    struct _nitf_TREKeyBlock *next;
+    size_t used;
+    size_t size;
+} nitf_TREKeyBlock;
+
+
+/*  Memory that goes with the fields, from the arena if there is one  */
+NITFPRIV(void *) allocate(nitf_TREPrivateData *priv, size_t size)
+{
+    return priv->arena ? nitf_Arena_malloc(priv->arena, size) :
+        NITF_MALLOC(size);
+}
+
+
+NITFPRIV(nitf_Uint32) hashKey(const char *key)
+{
+    /* FNV-1a */
+    nitf_Uint32 hash = 2166136261U;
+    while (*key)
+    {
+        hash ^= (unsigned char) *key++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+
+NITFPRIV(char *) copyKey(nitf_TREPrivateData *priv, const char *key,
+                         nitf_Error * error)
+{
+    size_t len = strlen(key) + 1;
+    nitf_TREKeyBlock *block = priv->keys;
+    char *copy;
+
+    if (!block || block->size - block->used < len)
+    {
+        size_t size = len > NITF_TRE_KEY_BLOCK_SIZE ?
+            len : NITF_TRE_KEY_BLOCK_SIZE;
+        block = (nitf_TREKeyBlock *) allocate(priv,
+                sizeof(nitf_TREKeyBlock) + size);
+        if (!block)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NULL;
+        }
+        block->next = priv->keys;
+        block->used = 0;
+        block->size = size;
+        priv->keys = block;
+    }
+
+    copy = (char *) (block + 1) + block->used;
+    memcpy(copy, key, len);
+    block->used += len;
+    return copy;
+}
+
+
+/*
+ *  Returns the index position holding the key, or the empty position
+ *  where it would go.  The index is never full.
+ */
+NITFPRIV(nitf_Uint32) findPosition(nitf_TREPrivateData *priv,
+                                   const char *key)
+{
+    nitf_Uint32 mask = priv->indexSize - 1;
+    nitf_Uint32 pos = hashKey(key) & mask;
+
+    while (priv->index[pos])
+    {
+        nitf_Uint32 slot = priv->index[pos] - 1;
+        nitf_Pair *pair = priv->blocks[slot / NITF_TRE_FIELD_BLOCK]
+            + slot % NITF_TRE_FIELD_BLOCK;
+        if (strcmp(pair->key, key) == 0)
+            break;
+        pos = (pos + 1) & mask;
+    }
+    return pos;
+}
+
+
+NITFPRIV(NITF_BOOL) growIndex(nitf_TREPrivateData *priv, nitf_Error * error)
+{
+    nitf_Uint32 size = priv->indexSize ? priv->indexSize * 2 : 16;
+    nitf_Uint32 slot;
+    nitf_Uint32 *index = (nitf_Uint32 *) allocate(priv,
+            size * sizeof(nitf_Uint32));
+    if (!index)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memset(index, 0, size * sizeof(nitf_Uint32));
+
+    if (priv->index)
+        NITF_FREE(priv->index);
+    priv->index = index;
+    priv->indexSize = size;
+
+    /* re-index in slot order, so the first of any duplicates wins */
+    for (slot = 0; slot < priv->numFields; ++slot)
+    {
+        nitf_Pair *pair = priv->blocks[slot / NITF_TRE_FIELD_BLOCK]
+            + slot % NITF_TRE_FIELD_BLOCK;
+        nitf_Uint32 pos = findPosition(priv, pair->key);
+        if (!priv->index[pos])
+            priv->index[pos] = slot + 1;
+    }
+    return NITF_SUCCESS;
+}
+
+
+/*
+ *  Detaches the view from the store and destroys it.  The pairs belong
+ *  to the store, so they are popped off the chains rather than freed.
+ */
+NITFPRIV(void) releaseHash(nitf_TREPrivateData *priv)
+{
+    int i;
+
+    if (!priv->hash)
+        return;
+
+    for (i = 0; i < priv->hash->nbuckets; i++)
+    {
+        while (!nitf_List_isEmpty(priv->hash->buckets[i]))
+            nitf_List_popFront(priv->hash->buckets[i]);
+    }
+    nitf_HashTable_destruct(&priv->hash);
+}
+
+
+/*
+ *  Destroys the fields and everything that indexes them, leaving an
+ *  empty store.
+ */
+NITFPRIV(void) clearFields(nitf_TREPrivateData *priv)
+{
+    nitf_Uint32 slot;
+    nitf_Uint32 i;
+
+    releaseHash(priv);
+
+    for (slot = 0; slot < priv->numFields; ++slot)
+    {
+        nitf_Pair *pair = priv->blocks[slot / NITF_TRE_FIELD_BLOCK]
+            + slot % NITF_TRE_FIELD_BLOCK;
+        if (pair->data)
+            nitf_Field_destruct((nitf_Field **) & pair->data);
+    }
+    for (i = 0; i < priv->numBlocks; ++i)
+        NITF_FREE(priv->blocks[i]);
+    if (priv->blocks)
+        NITF_FREE(priv->blocks);
+    if (priv->index)
+        NITF_FREE(priv->index);
+    while (priv->keys)
+    {
+        nitf_TREKeyBlock *next = priv->keys->next;
+        NITF_FREE(priv->keys);
+        priv->keys = next;
+    }
+
+    priv->blocks = NULL;
+    priv->numFields = 0;
+    priv->numBlocks = 0;
+    priv->index = NULL;
+    priv->indexSize = 0;
+    priv->duplicates = 0;
+}
+
 
 NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_construct(
         nitf_Error * error)
 {
-    nitf_TREPrivateData *priv = (nitf_TREPrivateData*) NITF_MALLOC(
-            sizeof(nitf_TREPrivateData));
+    return nitf_TREPrivateData_constructInArena(NULL, error);
+}
+
+
+NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_constructInArena(
+        nitf_Arena * arena, nitf_Error * error)
+{
+    nitf_TREPrivateData *priv = (nitf_TREPrivateData*) (arena ?
+            nitf_Arena_malloc(arena, sizeof(nitf_TREPrivateData)) :
+            NITF_MALLOC(sizeof(nitf_TREPrivateData)));
     if (!priv)
     {
         nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
@@ -40,17 +229,17 @@ NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_construct(
     priv->description = NULL;
     priv->userData = NULL;
 
-    /* create the hashtable for the fields */
-    priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
-
-    if (!priv->hash)
-    {
-        nitf_TREPrivateData_destruct(&priv);
-        return NULL;
-    }
+    /* the hash is a view of the fields, built when asked for */
+    priv->hash = NULL;
 
-    /* ??? change policy? */
-    nitf_HashTable_setPolicy(priv->hash, NITF_DATA_ADOPT);
+    priv->blocks = NULL;
+    priv->numFields = 0;
+    priv->numBlocks = 0;
+    priv->index = NULL;
+    priv->indexSize = 0;
+    priv->keys = NULL;
+    priv->duplicates = 0;
+    priv->arena = arena;
 
     return priv;
 }
@@ -61,23 +250,14 @@ nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
 {
     nitf_TREPrivateData *priv = NULL;
 
-    /* temporary nitf_List pointer */
-    nitf_List *lPtr;
-
     /* temporary nitf_Field pointer */
     nitf_Field *field;
 
     /* temporary nitf_Pair pointer */
     nitf_Pair *pair;
 
-    /* iterator to front of list */
-    nitf_ListIterator iter;
-
-    /* iterator to back of list */
-    nitf_ListIterator end;
-
     /* used for iterating */
-    int i;
+    nitf_Uint32 slot;
 
     if (source)
     {
@@ -91,37 +271,22 @@ nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
             goto CATCH_ERROR;
         }
 
-        /*  Copy the entire contents of the hash  */
-        for (i = 0; i < source->hash->nbuckets; i++)
+        /*  Copy the fields, keeping their order  */
+        for (slot = 0; slot < source->numFields; ++slot)
         {
-            /*  Foreach chain in the hash table...  */
-            lPtr = source->hash->buckets[i];
-            iter = nitf_List_begin(lPtr);
-            end = nitf_List_end(lPtr);
+            pair = nitf_TREPrivateData_getPair(source, slot);
+
+            /* clone the field */
+            field = nitf_Field_clone((nitf_Field *) pair->data, error);
+
+            /*  If that failed, we need to destruct  */
+            if (!field)
+                goto CATCH_ERROR;
 
-            /*  And while they are different...  */
-            while (nitf_ListIterator_notEqualTo(&iter, &end))
+            if (!nitf_TREPrivateData_insert(priv, pair->key, field, error))
             {
-                /*  Retrieve the field at the iterator...  */
-                pair = (nitf_Pair *) nitf_ListIterator_get(&iter);
-
-                /*  Cast it back to a field...  */
-                field = (nitf_Field *) pair->data;
-
-                /* clone the field */
-                field = nitf_Field_clone(field, error);
-
-                /*  If that failed, we need to destruct  */
-                if (!field)
-                    goto CATCH_ERROR;
-
-                /*  Yes, now we can insert the new field!  */
-                if (!nitf_HashTable_insert(priv->hash,
-                                           pair->key, field, error))
-                {
-                    goto CATCH_ERROR;
-                }
-                nitf_ListIterator_increment(&iter);
+                nitf_Field_destruct(&field);
+                goto CATCH_ERROR;
             }
         }
     }
@@ -141,24 +306,8 @@ nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
 }
 
 
-/**
- * Helper function for destructing the HashTable pairs
- */
-NITFPRIV(int) destructHashValue(nitf_HashTable * ht,
-                                nitf_Pair * pair,
-                                NITF_DATA* userData,
-                                nitf_Error * error)
-{
-    if (pair)
-        if (pair->data)
-            nitf_Field_destruct((nitf_Field **) & pair->data);
-    return NITF_SUCCESS;
-}
-
-
 NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
 {
-    nitf_Error e;
     if (*priv)
     {
         if ((*priv)->descriptionName)
@@ -166,16 +315,7 @@ NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
             NITF_FREE((*priv)->descriptionName);
             (*priv)->descriptionName = NULL;
         }
-        if ((*priv)->hash)
-        {
-            /* destruct each field in the hash */
-            nitf_HashTable_foreach((*priv)->hash,
-                                   (NITF_HASH_FUNCTOR) destructHashValue,
-                                   NULL, &e);
-            /* destruct the hash */
-            nitf_HashTable_destruct(&((*priv)->hash));
-
-        }
+        clearFields(*priv);
         NITF_FREE(*priv);
         *priv = NULL;
     }
@@ -185,28 +325,8 @@ NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
 NITFPROT(NITF_BOOL) nitf_TREPrivateData_flush(nitf_TREPrivateData *priv,
                                          nitf_Error * error)
 {
-    if (priv && priv->hash)
-    {
-        /* destruct each field in the hash */
-        nitf_HashTable_foreach(priv->hash,
-                               (NITF_HASH_FUNCTOR) destructHashValue,
-                               NULL, error);
-        /* destruct the hash */
-        nitf_HashTable_destruct(&(priv->hash));
-
-    }
-
-    /* create the hashtable for the fields */
-    priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
-
-    if (!priv->hash)
-    {
-        nitf_TREPrivateData_destruct(&priv);
-        return NITF_FAILURE;
-    }
-
-    nitf_HashTable_setPolicy(priv->hash, NITF_DATA_ADOPT);
-
+    if (priv)
+        clearFields(priv);
     return NITF_SUCCESS;
 }
 
@@ -224,7 +344,7 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_setDescriptionName(
     /* copy the description id */
     if (name)
     {
-        priv->descriptionName = (char*)NITF_MALLOC(strlen(name) + 1);
+        priv->descriptionName = (char*)allocate(priv, strlen(name) + 1);
         if (!priv->descriptionName)
         {
             nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
@@ -235,3 +355,149 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_setDescriptionName(
     }
     return NITF_SUCCESS;
 }
+
+
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_insert(nitf_TREPrivateData *priv,
+                                               const char *key,
+                                               nitf_Field *field,
+                                               nitf_Error * error)
+{
+    nitf_Uint32 slot = priv->numFields;
+    nitf_Uint32 pos;
+    nitf_Pair *pair;
+    char *copy;
+
+    /* keep the index at most half full */
+    if ((slot + 1) * 2 > priv->indexSize && !growIndex(priv, error))
+        return NITF_FAILURE;
+
+    if (slot == priv->numBlocks * NITF_TRE_FIELD_BLOCK)
+    {
+        nitf_Pair **blocks = (nitf_Pair **) NITF_REALLOC(priv->blocks,
+                (priv->numBlocks + 1) * sizeof(nitf_Pair *));
+        if (!blocks)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        priv->blocks = blocks;
+
+        blocks[priv->numBlocks] = (nitf_Pair *) allocate(priv,
+                NITF_TRE_FIELD_BLOCK * sizeof(nitf_Pair));
+        if (!blocks[priv->numBlocks])
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        priv->numBlocks++;
+    }
+
+    copy = copyKey(priv, key, error);
+    if (!copy)
+        return NITF_FAILURE;
+
+    pair = priv->blocks[slot / NITF_TRE_FIELD_BLOCK]
+        + slot % NITF_TRE_FIELD_BLOCK;
+
+    /* keep the view in step, before anything is committed */
+    if (priv->hash && !nitf_List_pushBack(
+            priv->hash->buckets[priv->hash->hash(priv->hash, copy)],
+            pair, error))
+    {
+        return NITF_FAILURE;
+    }
+
+    pair->key = copy;
+    pair->data = (NITF_DATA *) field;
+
+    pos = findPosition(priv, copy);
+    if (priv->index[pos])
+        priv->duplicates = 1;
+    else
+        priv->index[pos] = slot + 1;
+
+    priv->numFields++;
+    return NITF_SUCCESS;
+}
+
+
+NITFPROT(nitf_Pair *) nitf_TREPrivateData_find(nitf_TREPrivateData *priv,
+                                              const char *key)
+{
+    nitf_Uint32 pos;
+
+    if (!priv || !priv->indexSize)
+        return NULL;
+
+    pos = findPosition(priv, key);
+    if (!priv->index[pos])
+        return NULL;
+    return nitf_TREPrivateData_getPair(priv, priv->index[pos] - 1);
+}
+
+
+NITFPROT(nitf_Pair *) nitf_TREPrivateData_findAt(nitf_TREPrivateData *priv,
+                                                nitf_Uint32 slot,
+                                                const char *key)
+{
+    /* with duplicates the slot may hold a later copy of the name */
+    if (priv && slot < priv->numFields && !priv->duplicates)
+    {
+        nitf_Pair *pair = priv->blocks[slot / NITF_TRE_FIELD_BLOCK]
+            + slot % NITF_TRE_FIELD_BLOCK;
+        if (strcmp(pair->key, key) == 0)
+            return pair;
+    }
+    return nitf_TREPrivateData_find(priv, key);
+}
+
+
+NITFPROT(nitf_Uint32) nitf_TREPrivateData_getNumFields(
+        nitf_TREPrivateData *priv)
+{
+    return priv ? priv->numFields : 0;
+}
+
+
+NITFPROT(nitf_Pair *) nitf_TREPrivateData_getPair(nitf_TREPrivateData *priv,
+                                                 nitf_Uint32 slot)
+{
+    if (!priv || slot >= priv->numFields)
+        return NULL;
+    return priv->blocks[slot / NITF_TRE_FIELD_BLOCK]
+        + slot % NITF_TRE_FIELD_BLOCK;
+}
+
+
+NITFAPI(nitf_HashTable *) nitf_TREPrivateData_getHash(
+        nitf_TREPrivateData *priv, nitf_Error * error)
+{
+    nitf_HashTable *hash;
+    nitf_Uint32 slot;
+
+    if (priv->hash)
+        return priv->hash;
+
+    hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
+    if (!hash)
+        return NULL;
+
+    /* the store owns the fields */
+    nitf_HashTable_setPolicy(hash, NITF_DATA_RETAIN_OWNER);
+    priv->hash = hash;
+
+    /* chain the pairs in slot order, so find still returns the first */
+    for (slot = 0; slot < priv->numFields; ++slot)
+    {
+        nitf_Pair *pair = nitf_TREPrivateData_getPair(priv, slot);
+        if (!nitf_List_pushBack(hash->buckets[hash->hash(hash, pair->key)],
+                                pair, error))
+        {
+            releaseHash(priv);
+            return NULL;
+        }
+    }
+    return hash;
+}
@@ -22,6 +22,9 @@
 
 #include "nitf/TREUtils.h"
 #include "nitf/TREPrivateData.h"
+#include "nitf/SharedTRE.h"
+#include "nitf/LazyTRE.h"
+#include "nitf/Record.h"
 
 
 NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
@@ -46,7 +49,7 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
 
     privData = (nitf_TREPrivateData*)tre->priv;
 
-    /* flush the hash first, to protect from duplicate entries */
+    /* flush the fields first, to protect from duplicate entries */
     if (privData)
     {
         nitf_TREPrivateData_flush(privData, error);
@@ -65,11 +68,11 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
             }
 
             /* no need to call setValue, because we already know
-             * it is OK for this one to be in the hash
+             * it is OK for this one to be in the fields
              */
 
             /* construct the field */
-            field = nitf_Field_construct(length,
+            field = nitf_Field_constructInArena(privData->arena, length,
                     cursor.desc_ptr->data_type, error);
             if (!field)
                 goto CATCH_ERROR;
@@ -114,9 +117,14 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
             }
 #endif
 
-            /* add to the hash */
-            nitf_HashTable_insert(((nitf_TREPrivateData*)tre->priv)->hash,
-                    cursor.tag_str, field, error);
+            /* add to the fields */
+            if (!nitf_TREPrivateData_insert(privData, cursor.tag_str,
+                                            field, error))
+            {
+                nitf_Field_destruct(&field);
+                nitf_TRECursor_cleanup(&cursor);
+                goto CATCH_ERROR;
+            }
 
             offset += length;
         }
@@ -164,6 +172,9 @@ NITFAPI(char *) nitf_TREUtils_getRawData(nitf_TRE * tre, nitf_Uint32* treLength,
     /* the cursor */
     nitf_TRECursor cursor;
 
+    /* the slot the next field is expected in */
+    nitf_Uint32 slot = 0;
+
     /* get actual length of TRE */
     length = nitf_TREUtils_computeLength(tre);
     *treLength = length;
@@ -190,8 +201,8 @@ NITFAPI(char *) nitf_TREUtils_getRawData(nitf_TRE * tre, nitf_Uint32* treLength,
     {
         if (nitf_TRECursor_iterate(&cursor, error) == NITF_SUCCESS)
         {
-            pair = nitf_HashTable_find(((nitf_TREPrivateData*)tre->priv)->hash,
-                    cursor.tag_str);
+            pair = nitf_TREPrivateData_findAt(
+                    (nitf_TREPrivateData*)tre->priv, slot++, cursor.tag_str);
             if (pair && pair->data)
             {
                 tempLength = cursor.length;
@@ -304,12 +315,13 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
         return NITF_FAILURE;
     }
+    if (!nitf_SharedTRE_unshare(tre, error))
+        return NITF_FAILURE;
 
     /* If the field already exists, get it and modify it */
-    if (nitf_HashTable_exists(((nitf_TREPrivateData*)tre->priv)->hash, tag))
+    pair = nitf_TREPrivateData_find((nitf_TREPrivateData*)tre->priv, tag);
+    if (pair)
     {
-        pair = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)tre->priv)->hash, tag);
         field = (nitf_Field *) pair->data;
 
         if (!field)
@@ -344,7 +356,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
             return NITF_FAILURE;
 
     }
-    /* it doesn't exist in the hash yet, so we need to find it */
+    /* it doesn't exist in the fields yet, so we need to find it */
     else
     {
 
@@ -397,10 +409,15 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
                             cursor.tag_str, tre->tag);
 #endif
 
-                    /* add to the hash */
-                    nitf_HashTable_insert(
-                            ((nitf_TREPrivateData*)tre->priv)->hash,
-                            cursor.tag_str, field, error);
+                    /* add to the fields */
+                    if (!nitf_TREPrivateData_insert(
+                            (nitf_TREPrivateData*)tre->priv,
+                            cursor.tag_str, field, error))
+                    {
+                        nitf_Field_destruct(&field);
+                        nitf_TRECursor_cleanup(&cursor);
+                        return NITF_FAILURE;
+                    }
 
 
                     /* Now we need to fill our data */
@@ -497,6 +514,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
         nitf_Error * error)
 {
     nitf_TRECursor cursor;
+    nitf_Uint32 slot = 0;
 
     /* set the description so the cursor can use it */
     ((nitf_TREPrivateData*)tre->priv)->description =
@@ -511,8 +529,8 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
     {
         if (nitf_TRECursor_iterate(&cursor, error))
         {
-            nitf_Pair* pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
+            nitf_Pair* pair = nitf_TREPrivateData_findAt(
+                    (nitf_TREPrivateData*)tre->priv, slot++, cursor.tag_str);
 
             if (!pair || !pair->data)
             {
@@ -563,12 +581,17 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
                     nitf_Field_setString(field, " ", error);
                 }
 
-                /* add to hash if there wasn't an entry yet */
+                /* add to the fields if there wasn't an entry yet */
                 if (!pair)
                 {
-                    nitf_HashTable_insert(
-                            ((nitf_TREPrivateData*)tre->priv)->hash,
-                            cursor.tag_str, field, error);
+                    if (!nitf_TREPrivateData_insert(
+                            (nitf_TREPrivateData*)tre->priv,
+                            cursor.tag_str, field, error))
+                    {
+                        nitf_Field_destruct(&field);
+                        nitf_TRECursor_cleanup(&cursor);
+                        goto CATCH_ERROR;
+                    }
                 }
                 /* otherwise, just set the data pointer */
                 else
@@ -593,6 +616,7 @@ NITFAPI(int) nitf_TREUtils_print(nitf_TRE * tre, nitf_Error * error)
     nitf_Pair *pair; /* temp pair */
     int status = NITF_SUCCESS;
     nitf_TRECursor cursor;
+    nitf_Uint32 slot = 0;
 
     /* get out if TRE is null */
     if (!tre)
@@ -607,8 +631,8 @@ NITFAPI(int) nitf_TREUtils_print(nitf_TRE * tre, nitf_Error * error)
     {
         if ((status = nitf_TRECursor_iterate(&cursor, error)) == NITF_SUCCESS)
         {
-            pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
+            pair = nitf_TREPrivateData_findAt(
+                    (nitf_TREPrivateData*)tre->priv, slot++, cursor.tag_str);
             if (!pair || !pair->data)
             {
                 nitf_Error_initf(error, NITF_CTXT, NITF_ERR_UNK,
@@ -636,6 +660,7 @@ NITFAPI(int) nitf_TREUtils_computeLength(nitf_TRE * tre)
     nitf_Pair *pair; /* temp nitf_Pair */
     nitf_Field *field; /* temp nitf_Field */
     nitf_TRECursor cursor;
+    nitf_Uint32 slot = 0;
 
     /* get out if TRE is null */
     if (!tre)
@@ -650,13 +675,13 @@ NITFAPI(int) nitf_TREUtils_computeLength(nitf_TRE * tre)
             if (tempLength == NITF_TRE_GOBBLE)
             {
                 /* we don't have any other way to know the length of this
-                 * field, other than to see if the field is in the hash
+                 * field, other than to see if the field is in the TRE
                  * and use the length defined when it was created.
                  * Otherwise, we don't add any length.
                  */
                 tempLength = 0;
-                pair = nitf_HashTable_find(
-                        ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
+                pair = nitf_TREPrivateData_findAt(
+                        (nitf_TREPrivateData*)tre->priv, slot, cursor.tag_str);
                 if (pair)
                 {
                     field = (nitf_Field *) pair->data;
@@ -665,6 +690,7 @@ NITFAPI(int) nitf_TREUtils_computeLength(nitf_TRE * tre)
                 }
             }
             length += tempLength;
+            slot++;
         }
     }
     nitf_TRECursor_cleanup(&cursor);
@@ -736,8 +762,12 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
 
     tre->priv = NULL;
     infoPtr = descriptions->descriptions;
-    tre->priv = nitf_TREPrivateData_construct(error);
-    ((nitf_TREPrivateData*)tre->priv)->length = length;
+
+    /* what is parsed for a record goes into the record's arena, if any */
+    tre->priv = nitf_TREPrivateData_constructInArena(
+            record ? record->arena : NULL, error);
+    if (tre->priv)
+        ((nitf_TREPrivateData*)tre->priv)->length = length;
 
     ok = NITF_FAILURE;
     while (infoPtr && (infoPtr->description != NULL))
@@ -766,7 +796,6 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
                 return NITF_FAILURE;
             }
 
-            /*nitf_HashTable_print( ((nitf_TREPrivateData*)tre->priv)->hash );*/
             break;
         }
 
@@ -895,7 +924,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicClone(nitf_TRE *source,
 
     sourcePriv = (nitf_TREPrivateData*)source->priv;
 
-    /* this clones the hash */
+    /* this clones the fields */
     if (!(trePriv = nitf_TREPrivateData_clone(sourcePriv, error)))
         return NITF_FAILURE;
 
@@ -924,18 +953,17 @@ NITFAPI(nitf_List*) nitf_TREUtils_basicFind(nitf_TRE* tre,
                                             nitf_Error* error)
 {
     nitf_List* list;
-
-    nitf_HashTableIterator it = nitf_HashTable_begin(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
-    nitf_HashTableIterator end = nitf_HashTable_end(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
+    nitf_TREPrivateData* priv = (nitf_TREPrivateData*)tre->priv;
+    nitf_Uint32 numFields = nitf_TREPrivateData_getNumFields(priv);
+    nitf_Uint32 slot;
 
     list = nitf_List_construct(error);
     if (!list) return NULL;
 
-    while (nitf_HashTableIterator_notEqualTo(&it, &end))
+    /* the matches come back in the order the fields were added */
+    for (slot = 0; slot < numFields; ++slot)
     {
-        nitf_Pair* pair = nitf_HashTableIterator_get(&it);
+        nitf_Pair* pair = nitf_TREPrivateData_getPair(priv, slot);
 
         if (strstr(pair->key, pattern))
         {
@@ -943,7 +971,6 @@ NITFAPI(nitf_List*) nitf_TREUtils_basicFind(nitf_TRE* tre,
             nitf_List_pushBack(list, pair, error);
 
         }
-        nitf_HashTableIterator_increment(&it);
     }
 
     return list;
@@ -961,8 +988,8 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicSetField(nitf_TRE* tre,
 NITFAPI(nitf_Field*) nitf_TREUtils_basicGetField(nitf_TRE* tre,
                                                  const char* tag)
 {
-    nitf_Pair* pair = nitf_HashTable_find(
-            ((nitf_TREPrivateData*)tre->priv)->hash, tag);
+    nitf_Pair* pair = nitf_TREPrivateData_find(
+            (nitf_TREPrivateData*)tre->priv, tag);
     if (!pair) return NULL;
     return (nitf_Field*)pair->data;
 }
@@ -983,8 +1010,8 @@ NITFPRIV(nitf_Pair*) basicIncrement(nitf_TREEnumerator* it, nitf_Error* error)
     if (!nitf_TRE_exists(cursor->tre, cursor->tag_str))
         goto CATCH_ERROR;
 
-    data = nitf_HashTable_find(((nitf_TREPrivateData*)cursor->tre->priv)->hash,
-            cursor->tag_str);
+    data = nitf_TREPrivateData_find(
+            (nitf_TREPrivateData*)cursor->tre->priv, cursor->tag_str);
     if (!data)
         goto CATCH_ERROR;
 
@@ -1058,5 +1085,171 @@ nitf_TREUtils_createBasicHandler(nitf_TREDescriptionSet* set,
     handler->destruct = nitf_TREUtils_basicDestruct;
 
     handler->data = set;
+    if (!nitf_TREPlan_register(handler, set, error))
+        return NULL;
     return handler;
 }
+
+
+/*  Puts one field's value in slot index of an array  */
+typedef NITF_BOOL (*NITF_TRE_ARRAY_DECODER)(nitf_Field * field,
+                                            NITF_DATA * values,
+                                            size_t index,
+                                            nitf_Error * error);
+
+NITFPRIV(NITF_BOOL) decodeReal64(nitf_Field * field, NITF_DATA * values,
+                                 size_t index, nitf_Error * error)
+{
+    double *value = (double *) values + index;
+
+    if (field->type != NITF_BINARY)
+        return nitf_Field_parseReal64(field->raw, field->length, value,
+                                      error);
+
+    if (field->length == sizeof(double))
+        memcpy(value, field->raw, sizeof(double));
+    else if (field->length == sizeof(float))
+    {
+        float real;
+        memcpy(&real, field->raw, sizeof(float));
+        *value = real;
+    }
+    else
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Unexpected field size for real [%d]",
+                         field->length);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) decodeInt64(nitf_Field * field, NITF_DATA * values,
+                                size_t index, nitf_Error * error)
+{
+    nitf_Int64 *value = (nitf_Int64 *) values + index;
+
+    if (field->type != NITF_BINARY)
+    {
+        *value = nitf_Field_parseInt64(field->raw, field->length);
+        return NITF_SUCCESS;
+    }
+
+    switch (field->length)
+    {
+        case NITF_INT16_SZ:
+        {
+            nitf_Int16 int16;
+            memcpy(&int16, field->raw, NITF_INT16_SZ);
+            *value = int16;
+        }
+        break;
+        case NITF_INT32_SZ:
+        {
+            nitf_Int32 int32;
+            memcpy(&int32, field->raw, NITF_INT32_SZ);
+            *value = int32;
+        }
+        break;
+        case NITF_INT64_SZ:
+            memcpy(value, field->raw, NITF_INT64_SZ);
+            break;
+        default:
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                             "Unexpected field size for int [%d]",
+                             field->length);
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Walks the TRE in description order and decodes each field the
+ *  description calls tag.  The cursor visits the fields of a parsed TRE
+ *  in slot order, so each one is found without a lookup by name.
+ */
+NITFPRIV(NITF_BOOL) getArray(nitf_TRE * tre, const char *tag,
+                             NITF_DATA * values, size_t capacity,
+                             size_t *count, NITF_TRE_ARRAY_DECODER decode,
+                             nitf_Error * error)
+{
+    nitf_TREPrivateData *priv;
+    nitf_TRECursor cursor;
+    nitf_Uint32 slot = 0;
+    NITF_BOOL status = NITF_SUCCESS;
+
+    *count = 0;
+    if (!tre || !tag)
+    {
+        nitf_Error_init(error, "getArray -> invalid tre object",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+    if (!nitf_LazyTRE_resolve(tre, error))
+        return NITF_FAILURE;
+
+    /* only read from here on, so the contents can stay shared */
+    tre = nitf_SharedTRE_getContents(tre);
+    if (tre->handler->getField != nitf_TREUtils_basicGetField)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                         "TRE [%s] was not read from a description",
+                         tre->tag);
+        return NITF_FAILURE;
+    }
+    priv = (nitf_TREPrivateData*)tre->priv;
+
+    cursor = nitf_TRECursor_begin(tre);
+    while (status && !nitf_TRECursor_isDone(&cursor))
+    {
+        if (!nitf_TRECursor_iterate(&cursor, error))
+        {
+            status = NITF_FAILURE;
+            break;
+        }
+        if (strcmp(cursor.desc_ptr->tag, tag) == 0)
+        {
+            nitf_Pair *pair = nitf_TREPrivateData_findAt(priv, slot,
+                                                         cursor.tag_str);
+            if (!pair || !pair->data)
+            {
+                nitf_Error_initf(error, NITF_CTXT, NITF_ERR_UNK,
+                        "Unable to find tag, '%s', in TRE hash for TRE '%s'",
+                        cursor.tag_str, tre->tag);
+                status = NITF_FAILURE;
+            }
+            else if (*count < capacity)
+            {
+                status = decode((nitf_Field *) pair->data, values, *count,
+                                error);
+            }
+            if (status)
+                ++*count;
+        }
+        ++slot;
+    }
+    nitf_TRECursor_cleanup(&cursor);
+    return status;
+}
+
+NITFAPI(NITF_BOOL) nitf_TREUtils_getReal64Array(nitf_TRE * tre,
+                                                const char *tag,
+                                                double *values,
+                                                size_t capacity,
+                                                size_t *count,
+                                                nitf_Error * error)
+{
+    return getArray(tre, tag, (NITF_DATA *) values, capacity, count,
+                    decodeReal64, error);
+}
+
+NITFAPI(NITF_BOOL) nitf_TREUtils_getInt64Array(nitf_TRE * tre,
+                                               const char *tag,
+                                               nitf_Int64 *values,
+                                               size_t capacity,
+                                               size_t *count,
+                                               nitf_Error * error)
+{
+    return getArray(tre, tag, (NITF_DATA *) values, capacity, count,
+                    decodeInt64, error);
+}
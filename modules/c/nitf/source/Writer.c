@@ -21,6 +21,7 @@
  */
 
 #include "nitf/Writer.h"
+#include "nitf/Reader.h"
 
 /*  This writer basically allows exceptions. It uses the  */
 /*  error object of the given Writer, thus simplifying the*/
@@ -1588,6 +1589,175 @@ NITFPRIV(NITF_BOOL) writeDE(nitf_Writer* writer,
     return NITF_FAILURE;
 }
 
+/*
+ *  Fills in the file and header lengths, the segment counts and the
+ *  subheader/data lengths of each segment, along with the CLEVEL and FDT
+ *  fields when they were left for the writer to compute.  The output must
+ *  hold the file header written by nitf_Writer_writeHeader; fileLenOff is
+ *  the offset of the FL field within it.
+ */
+NITFPRIV(NITF_BOOL) writeHeaderLengths(nitf_Writer * writer,
+                                       nitf_Off fileLenOff,
+                                       nitf_Off fileLen,
+                                       nitf_Uint32 hdrLen,
+                                       nitf_Uint32 numImgs,
+                                       const nitf_Off *imageSubLens,
+                                       const nitf_Off *imageDataLens,
+                                       nitf_Uint32 numGraphics,
+                                       const nitf_Off *graphicSubLens,
+                                       const nitf_Off *graphicDataLens,
+                                       nitf_Uint32 numTexts,
+                                       const nitf_Off *textSubLens,
+                                       const nitf_Off *textDataLens,
+                                       nitf_Uint32 numDEs,
+                                       const nitf_Off *deSubLens,
+                                       const nitf_Off *deDataLens,
+                                       nitf_Error * error)
+{
+    nitf_FileHeader* header = writer->record->header;
+    nitf_Uint32 i;
+    int skipBytes = 0;
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
+                                               fileLenOff,
+                                               NITF_SEEK_SET,
+                                               error)))
+        goto CATCH_ERROR;
+
+    NITF_WRITE_INT64_FIELD(fileLen, NITF_FL, ZERO, FILL_LEFT);
+    if (!nitf_Field_setUint64(header->NITF_FL, fileLen, error))
+        goto CATCH_ERROR;
+
+    NITF_WRITE_INT64_FIELD(hdrLen, NITF_HL, ZERO, FILL_LEFT);
+    if (!nitf_Field_setUint64(header->NITF_HL, hdrLen, error))
+        goto CATCH_ERROR;
+
+
+
+    /*    Fix the image subheader and data lengths */
+    NITF_WRITE_INT_FIELD(numImgs, NITF_NUMI, ZERO, FILL_LEFT);
+    if (!nitf_Field_setUint32(header->NITF_NUMI, numImgs, error))
+        goto CATCH_ERROR;
+    for (i = 0; i < numImgs; i++)
+    {
+        NITF_WRITE_INT64_FIELD(imageSubLens[i], NITF_LISH, ZERO, FILL_LEFT);
+        if (!nitf_Field_setUint64(header->NITF_LISH(i), imageSubLens[i], error))
+            goto CATCH_ERROR;
+
+        NITF_WRITE_INT64_FIELD(imageDataLens[i], NITF_LI, ZERO, FILL_LEFT);
+        if (!nitf_Field_setUint64(header->NITF_LI(i), imageDataLens[i], error))
+            goto CATCH_ERROR;
+    }
+
+    /*    Fix the graphic subheader and data lengths */
+    NITF_WRITE_INT_FIELD(numGraphics, NITF_NUMS, ZERO, FILL_LEFT);
+    if (!nitf_Field_setUint32(header->NITF_NUMS, numGraphics, error))
+        goto CATCH_ERROR;
+
+    for (i = 0; i < numGraphics; i++)
+    {
+        NITF_WRITE_INT64_FIELD(graphicSubLens[i], NITF_LSSH, ZERO, FILL_LEFT);
+        if (!nitf_Field_setUint64(header->NITF_LSSH(i), graphicSubLens[i], error))
+            goto CATCH_ERROR;
+
+        NITF_WRITE_INT64_FIELD(graphicDataLens[i], NITF_LS, ZERO, FILL_LEFT);
+        if (!nitf_Field_setUint64(header->NITF_LS(i), graphicDataLens[i], error))
+            goto CATCH_ERROR;
+
+    }
+
+    /* NOW, we need to seek past the other count */
+    skipBytes = NITF_NUMX_SZ;
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
+                                               skipBytes,
+                                               NITF_SEEK_CUR,
+                                               error)))
+        goto CATCH_ERROR;
+
+    /*    Fix the text subheader and data lengths */
+    NITF_WRITE_INT_FIELD(numTexts, NITF_NUMT, ZERO, FILL_LEFT);
+    if (!nitf_Field_setUint32(header->NITF_NUMT, numTexts, error))
+        goto CATCH_ERROR;
+
+    for (i = 0; i < numTexts; i++)
+    {
+        NITF_WRITE_INT64_FIELD(textSubLens[i], NITF_LTSH, ZERO, FILL_LEFT);
+        if (!nitf_Field_setUint64(header->NITF_LTSH(i), textSubLens[i], error))
+            goto CATCH_ERROR;
+
+
+        NITF_WRITE_INT64_FIELD(textDataLens[i], NITF_LT, ZERO, FILL_LEFT);
+        if (!nitf_Field_setUint64(header->NITF_LT(i), textSubLens[i], error))
+            goto CATCH_ERROR;
+
+    }
+
+    /*    Fix the data extension subheader and data lengths */
+    NITF_WRITE_INT_FIELD(numDEs, NITF_NUMDES, ZERO, FILL_LEFT);
+    if (!nitf_Field_setUint32(header->NITF_NUMDES, numDEs, error))
+        goto CATCH_ERROR;
+
+    for (i = 0; i < numDEs; i++)
+    {
+        NITF_WRITE_INT64_FIELD(deSubLens[i], NITF_LDSH, ZERO, FILL_LEFT);
+        if (!nitf_Field_setUint64(header->NITF_LDSH(i), deSubLens[i], error))
+            goto CATCH_ERROR;
+
+
+        NITF_WRITE_INT64_FIELD(deDataLens[i], NITF_LD, ZERO, FILL_LEFT);
+        if (!nitf_Field_setUint64(header->NITF_LD(i), deDataLens[i], error))
+            goto CATCH_ERROR;
+
+
+    }
+
+    /* Now its time to check if we should be measuring the CLEVEL */
+    if (strncmp(header->NITF_CLEVEL->raw, "00", 2) == 0)
+    {
+        NITF_CLEVEL clevel =
+            nitf_ComplexityLevel_measure(writer->record, error);
+
+        if (clevel == NITF_CLEVEL_CHECK_FAILED)
+            goto CATCH_ERROR;
+
+        nitf_ComplexityLevel_toString(clevel,
+                                      header->NITF_CLEVEL->raw);
+
+        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
+                                                   NITF_FHDR_SZ + NITF_FVER_SZ,
+                                                   NITF_SEEK_SET,
+                                                   error)))
+            goto CATCH_ERROR;
+
+
+        if (!writeField(writer, header->NITF_CLEVEL->raw, 2, error))
+            goto CATCH_ERROR;
+    }
+
+    /* if there wasn't a file datetime set, let's set one automatically */
+    if (nitf_Utils_isBlank(header->NITF_FDT->raw))
+    {
+        char *dateFormat = (nitf_Record_getVersion(writer->record) == NITF_VER_20 ?
+                NITF_DATE_FORMAT_20 : NITF_DATE_FORMAT_21);
+
+        if (!nitf_Field_setDateTime(header->NITF_FDT, NULL, dateFormat, error))
+            goto CATCH_ERROR;
+
+        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
+                NITF_FHDR_SZ + NITF_FVER_SZ + NITF_CLEVEL_SZ + NITF_STYPE_SZ + NITF_OSTAID_SZ,
+                NITF_SEEK_SET, error)))
+            goto CATCH_ERROR;
+
+        if (!writeField(writer, header->NITF_FDT->raw, NITF_FDT_SZ, error))
+            goto CATCH_ERROR;
+    }
+
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    return NITF_FAILURE;
+}
+
 NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer,
                                      nitf_Error * error)
 {
@@ -1603,7 +1773,6 @@ NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer,
     /* Length of teh file header */
     nitf_Uint32 hdrLen;
     nitf_Uint32 i = 0;
-    int skipBytes = 0;
     nitf_Version fver;
 
     /* Number of images */
@@ -2045,112 +2214,57 @@ NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer,
     if (!NITF_IO_SUCCESS(fileLen))
         goto CATCH_ERROR;
 
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
-                                               fileLenOff,
-                                               NITF_SEEK_SET,
-                                               error)))
-        goto CATCH_ERROR;
-
-    NITF_WRITE_INT64_FIELD(fileLen, NITF_FL, ZERO, FILL_LEFT);
-    if (!nitf_Field_setUint64(header->NITF_FL, fileLen, error))
-        goto CATCH_ERROR;
-
-    NITF_WRITE_INT64_FIELD(hdrLen, NITF_HL, ZERO, FILL_LEFT);
-    if (!nitf_Field_setUint64(header->NITF_HL, hdrLen, error))
-        goto CATCH_ERROR;
-
-
-
-    /*    Fix the image subheader and data lengths */
-    NITF_WRITE_INT_FIELD(numImgs, NITF_NUMI, ZERO, FILL_LEFT);
-    if (!nitf_Field_setUint32(header->NITF_NUMI, numImgs, error))
+    if (!writeHeaderLengths(writer, fileLenOff, fileLen, hdrLen,
+                            numImgs, imageSubLens, imageDataLens,
+                            numGraphics, graphicSubLens, graphicDataLens,
+                            numTexts, textSubLens, textDataLens,
+                            numDEs, deSubLens, deDataLens, error))
         goto CATCH_ERROR;
-    for (i = 0; i < numImgs; i++)
-    {
-        NITF_WRITE_INT64_FIELD(imageSubLens[i], NITF_LISH, ZERO, FILL_LEFT);
-        if (!nitf_Field_setUint64(header->NITF_LISH(i), imageSubLens[i], error))
-            goto CATCH_ERROR;
 
-        NITF_WRITE_INT64_FIELD(imageDataLens[i], NITF_LI, ZERO, FILL_LEFT);
-        if (!nitf_Field_setUint64(header->NITF_LI(i), imageDataLens[i], error))
-            goto CATCH_ERROR;
-    }
     if (numImgs != 0)
     {
         NITF_FREE(imageSubLens);
         NITF_FREE(imageDataLens);
     }
-
-    /*    Fix the graphic subheader and data lengths */
-    NITF_WRITE_INT_FIELD(numGraphics, NITF_NUMS, ZERO, FILL_LEFT);
-    if (!nitf_Field_setUint32(header->NITF_NUMS, numGraphics, error))
-        goto CATCH_ERROR;
-
-    for (i = 0; i < numGraphics; i++)
-    {
-        NITF_WRITE_INT64_FIELD(graphicSubLens[i], NITF_LSSH, ZERO, FILL_LEFT);
-        if (!nitf_Field_setUint64(header->NITF_LSSH(i), graphicSubLens[i], error))
-            goto CATCH_ERROR;
-
-        NITF_WRITE_INT64_FIELD(graphicDataLens[i], NITF_LS, ZERO, FILL_LEFT);
-        if (!nitf_Field_setUint64(header->NITF_LS(i), graphicDataLens[i], error))
-            goto CATCH_ERROR;
-
-    }
     if (numGraphics != 0)
     {
         NITF_FREE(graphicSubLens);
         NITF_FREE(graphicDataLens);
     }
-
-    /* NOW, we need to seek past the other count */
-    skipBytes = NITF_NUMX_SZ;
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
-                                               skipBytes,
-                                               NITF_SEEK_CUR,
-                                               error)))
-        goto CATCH_ERROR;
-
-    /*    Fix the text subheader and data lengths */
-    NITF_WRITE_INT_FIELD(numTexts, NITF_NUMT, ZERO, FILL_LEFT);
-    if (!nitf_Field_setUint32(header->NITF_NUMT, numTexts, error))
-        goto CATCH_ERROR;
-
-    for (i = 0; i < numTexts; i++)
-    {
-        NITF_WRITE_INT64_FIELD(textSubLens[i], NITF_LTSH, ZERO, FILL_LEFT);
-        if (!nitf_Field_setUint64(header->NITF_LTSH(i), textSubLens[i], error))
-            goto CATCH_ERROR;
-
-
-        NITF_WRITE_INT64_FIELD(textDataLens[i], NITF_LT, ZERO, FILL_LEFT);
-        if (!nitf_Field_setUint64(header->NITF_LT(i), textSubLens[i], error))
-            goto CATCH_ERROR;
-
-    }
     if (numTexts != 0)
     {
         NITF_FREE(textSubLens);
         NITF_FREE(textDataLens);
     }
-
-    /*    Fix the data extension subheader and data lengths */
-    NITF_WRITE_INT_FIELD(numDEs, NITF_NUMDES, ZERO, FILL_LEFT);
-    if (!nitf_Field_setUint32(header->NITF_NUMDES, numDEs, error))
-        goto CATCH_ERROR;
-
-    for (i = 0; i < numDEs; i++)
+    if (numDEs != 0)
     {
-        NITF_WRITE_INT64_FIELD(deSubLens[i], NITF_LDSH, ZERO, FILL_LEFT);
-        if (!nitf_Field_setUint64(header->NITF_LDSH(i), deSubLens[i], error))
-            goto CATCH_ERROR;
+        NITF_FREE(deSubLens);
+        NITF_FREE(deDataLens);
+    }
 
+    nitf_Writer_destructWriters(writer);
 
-        NITF_WRITE_INT64_FIELD(deDataLens[i], NITF_LD, ZERO, FILL_LEFT);
-        if (!nitf_Field_setUint64(header->NITF_LD(i), deDataLens[i], error))
-            goto CATCH_ERROR;
+    /*  We dont handle anything cool yet  */
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
 
+    nitf_Writer_destructWriters(writer);
 
+    if (numImgs != 0)
+    {
+        NITF_FREE(imageSubLens);
+        NITF_FREE(imageDataLens);
+    }
+    if (numGraphics != 0)
+    {
+        NITF_FREE(graphicSubLens);
+        NITF_FREE(graphicDataLens);
+    }
+    if (numTexts != 0)
+    {
+        NITF_FREE(textSubLens);
+        NITF_FREE(textDataLens);
     }
     if (numDEs != 0)
     {
@@ -2158,80 +2272,1163 @@ NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer,
         NITF_FREE(deDataLens);
     }
 
-    /* Now its time to check if we should be measuring the CLEVEL */
-    if (strncmp(header->NITF_CLEVEL->raw, "00", 2) == 0)
+    return NITF_FAILURE;
+}
+
+
+/* ------------------------------------------------------------------ */
+/*                SINGLE-PASS WRITING                                 */
+/* ------------------------------------------------------------------ */
+
+/*
+ *  A forward-only view of the real output.  Writers that position their
+ *  output themselves (ImageIO does) see an ordinary seekable interface
+ *  whose offsets are file offsets; bytes are passed on as soon as they
+ *  extend the contiguous run already emitted, and anything written ahead
+ *  of that run is held until the gap before it is filled.  Rewriting
+ *  bytes that have already been emitted is an error.
+ */
+typedef struct _ForwardRange
+{
+    nitf_Off start;
+    nitf_Off end;
+} ForwardRange;
+
+typedef struct _ForwardControl
+{
+    nitf_IOInterface *output;
+    nitf_Off emitted;           /* file offset of the next byte to emit */
+    nitf_Off mark;
+    nitf_Off size;
+    char *pending;              /* bytes from emitted onwards */
+    size_t pendingCapacity;
+    ForwardRange *ranges;       /* sorted, disjoint, all past emitted */
+    size_t numRanges;
+    size_t rangeCapacity;
+} ForwardControl;
+
+NITFPRIV(NITF_BOOL) Forward_addRange(ForwardControl *control,
+                                     nitf_Off start, nitf_Off end,
+                                     nitf_Error *error)
+{
+    size_t i = 0;
+    size_t j;
+    size_t merged;
+
+    /* skip everything that ends before this range begins */
+    while (i < control->numRanges && control->ranges[i].end < start)
+        ++i;
+
+    /* absorb everything that overlaps or touches it */
+    j = i;
+    while (j < control->numRanges && control->ranges[j].start <= end)
     {
-        NITF_CLEVEL clevel =
-            nitf_ComplexityLevel_measure(writer->record, error);
+        if (control->ranges[j].start < start)
+            start = control->ranges[j].start;
+        if (control->ranges[j].end > end)
+            end = control->ranges[j].end;
+        ++j;
+    }
+    merged = j - i;
 
-        if (clevel == NITF_CLEVEL_CHECK_FAILED)
-            goto CATCH_ERROR;
+    if (merged == 0)
+    {
+        if (control->numRanges == control->rangeCapacity)
+        {
+            size_t capacity = control->rangeCapacity ?
+                              control->rangeCapacity * 2 : 16;
+            ForwardRange *ranges = (ForwardRange *)
+                NITF_REALLOC(control->ranges, capacity * sizeof(ForwardRange));
+            if (!ranges)
+            {
+                nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                                NITF_CTXT, NITF_ERR_MEMORY);
+                return NITF_FAILURE;
+            }
+            control->ranges = ranges;
+            control->rangeCapacity = capacity;
+        }
+        memmove(&control->ranges[i + 1], &control->ranges[i],
+                (control->numRanges - i) * sizeof(ForwardRange));
+        ++control->numRanges;
+    }
+    else if (merged > 1)
+    {
+        memmove(&control->ranges[i + 1], &control->ranges[j],
+                (control->numRanges - j) * sizeof(ForwardRange));
+        control->numRanges -= merged - 1;
+    }
+    control->ranges[i].start = start;
+    control->ranges[i].end = end;
+    return NITF_SUCCESS;
+}
 
-        nitf_ComplexityLevel_toString(clevel,
-                                      header->NITF_CLEVEL->raw);
+NITFPRIV(NITF_BOOL) Forward_read(NITF_DATA *data, void *buf, size_t size,
+                                 nitf_Error *error)
+{
+    (void)data;
+    (void)buf;
+    (void)size;
+    nitf_Error_init(error, "Single-pass output cannot be read back",
+                    NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+    return NITF_FAILURE;
+}
 
-        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
-                                                   NITF_FHDR_SZ + NITF_FVER_SZ,
-                                                   NITF_SEEK_SET,
-                                                   error)))
-            goto CATCH_ERROR;
+NITFPRIV(NITF_BOOL) Forward_write(NITF_DATA *data, const void *buf,
+                                  size_t size, nitf_Error *error)
+{
+    ForwardControl *control = (ForwardControl *) data;
+    nitf_Off end = control->mark + (nitf_Off) size;
+    size_t needed;
 
+    if (size == 0)
+        return NITF_SUCCESS;
 
-        if (!writeField(writer, header->NITF_CLEVEL->raw, 2, error))
-            goto CATCH_ERROR;
+    if (control->mark < control->emitted)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_WRITING_TO_FILE,
+                         "Single-pass output cannot rewrite offset %lld",
+                         (long long) control->mark);
+        return NITF_FAILURE;
     }
 
-    /* if there wasn't a file datetime set, let's set one automatically */
-    if (nitf_Utils_isBlank(header->NITF_FDT->raw))
+    if (end > control->size)
+        control->size = end;
+
+    /* the common case - nothing is pending, so pass it straight on */
+    if (control->mark == control->emitted && control->numRanges == 0)
     {
-        char *dateFormat = (nitf_Record_getVersion(writer->record) == NITF_VER_20 ?
-                NITF_DATE_FORMAT_20 : NITF_DATE_FORMAT_21);
+        if (!nitf_IOInterface_write(control->output, buf, size, error))
+            return NITF_FAILURE;
+        control->emitted = end;
+        control->mark = end;
+        return NITF_SUCCESS;
+    }
 
-        if (!nitf_Field_setDateTime(header->NITF_FDT, NULL, dateFormat, error))
-            goto CATCH_ERROR;
+    if (end - control->emitted > NITF_SINGLE_PASS_MAX_HELD)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_WRITING_TO_FILE,
+                         "Single-pass output would hold %lld bytes, "
+                         "more than the limit of %lld",
+                         (long long) (end - control->emitted),
+                         (long long) NITF_SINGLE_PASS_MAX_HELD);
+        return NITF_FAILURE;
+    }
 
-        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
-                NITF_FHDR_SZ + NITF_FVER_SZ + NITF_CLEVEL_SZ + NITF_STYPE_SZ + NITF_OSTAID_SZ,
-                NITF_SEEK_SET, error)))
+    needed = (size_t) (end - control->emitted);
+    if (needed > control->pendingCapacity)
+    {
+        size_t capacity = control->pendingCapacity ?
+                          control->pendingCapacity : 4096;
+        char *pending;
+        while (capacity < needed)
+            capacity *= 2;
+        pending = (char *) NITF_REALLOC(control->pending, capacity);
+        if (!pending)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        control->pending = pending;
+        control->pendingCapacity = capacity;
+    }
+    memcpy(control->pending + (control->mark - control->emitted), buf, size);
+    control->mark = end;
+
+    if (!Forward_addRange(control, end - (nitf_Off) size, end, error))
+        return NITF_FAILURE;
+
+    /* emit the contiguous run at the front, if there is one now */
+    if (control->ranges[0].start == control->emitted)
+    {
+        size_t length = (size_t) (control->ranges[0].end - control->emitted);
+        size_t held = control->numRanges > 1 ?
+            (size_t) (control->ranges[control->numRanges - 1].end
+                      - control->emitted) : length;
+
+        if (!nitf_IOInterface_write(control->output, control->pending,
+                                    length, error))
+            return NITF_FAILURE;
+
+        memmove(control->pending, control->pending + length, held - length);
+        control->emitted += (nitf_Off) length;
+        memmove(&control->ranges[0], &control->ranges[1],
+                (control->numRanges - 1) * sizeof(ForwardRange));
+        --control->numRanges;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) Forward_canSeek(NITF_DATA *data, nitf_Error *error)
+{
+    (void)data;
+    (void)error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_Off) Forward_seek(NITF_DATA *data, nitf_Off offset, int whence,
+                                nitf_Error *error)
+{
+    ForwardControl *control = (ForwardControl *) data;
+    nitf_Off base;
+
+    if (whence == NITF_SEEK_SET)
+        base = 0;
+    else if (whence == NITF_SEEK_CUR)
+        base = control->mark;
+    else if (whence == NITF_SEEK_END)
+        base = control->size;
+    else
+    {
+        nitf_Error_init(error, "Invalid/unsupported seek directive",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    if (base + offset < 0)
+    {
+        nitf_Error_init(error, "Invalid offset requested", NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return -1;
+    }
+    control->mark = base + offset;
+    return control->mark;
+}
+
+NITFPRIV(nitf_Off) Forward_tell(NITF_DATA *data, nitf_Error *error)
+{
+    (void)error;
+    return ((ForwardControl *) data)->mark;
+}
+
+NITFPRIV(nitf_Off) Forward_getSize(NITF_DATA *data, nitf_Error *error)
+{
+    (void)error;
+    return ((ForwardControl *) data)->size;
+}
+
+NITFPRIV(int) Forward_getMode(NITF_DATA *data, nitf_Error *error)
+{
+    (void)data;
+    (void)error;
+    return NITF_ACCESS_WRITEONLY;
+}
+
+NITFPRIV(NITF_BOOL) Forward_close(NITF_DATA *data, nitf_Error *error)
+{
+    (void)data;
+    (void)error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) Forward_destruct(NITF_DATA *data)
+{
+    ForwardControl *control = (ForwardControl *) data;
+    if (control)
+    {
+        if (control->pending)
+            NITF_FREE(control->pending);
+        if (control->ranges)
+            NITF_FREE(control->ranges);
+        control->pending = NULL;
+        control->ranges = NULL;
+    }
+}
+
+/*
+ *  Wraps the output, which has already received 'offset' bytes, in a
+ *  forward-only interface positioned at that offset.  The output itself
+ *  is not owned.
+ */
+NITFPRIV(nitf_IOInterface *) Forward_construct(nitf_IOInterface *output,
+                                               nitf_Off offset,
+                                               nitf_Error *error)
+{
+    static nitf_IIOInterface iForward = {
+        &Forward_read,
+        &Forward_write,
+        &Forward_canSeek,
+        &Forward_seek,
+        &Forward_tell,
+        &Forward_getSize,
+        &Forward_getMode,
+        &Forward_close,
+        &Forward_destruct
+    };
+    nitf_IOInterface *impl = NULL;
+    ForwardControl *control = NULL;
+
+    impl = (nitf_IOInterface *) NITF_MALLOC(sizeof(nitf_IOInterface));
+    control = (ForwardControl *) NITF_MALLOC(sizeof(ForwardControl));
+    if (!impl || !control)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        if (impl)
+            NITF_FREE(impl);
+        if (control)
+            NITF_FREE(control);
+        return NULL;
+    }
+    memset(control, 0, sizeof(ForwardControl));
+    control->output = output;
+    control->emitted = offset;
+    control->mark = offset;
+    control->size = offset;
+
+    impl->data = (NITF_DATA *) control;
+    impl->iface = &iForward;
+    return impl;
+}
+
+/*
+ *  Everything the single-pass writer knows about one segment before the
+ *  header goes out: its spooled subheader, and either its spooled data or
+ *  (for uncompressed images) just the length the data is known to have.
+ */
+typedef struct _SegmentStage
+{
+    nitf_IOInterface *subheader;
+    nitf_IOInterface *data;
+    nitf_Off subheaderLen;
+    nitf_Off dataLen;
+} SegmentStage;
+
+/*
+ *  Returns the exact data length of an uncompressed image, or 0 if the
+ *  image is compressed or masked and its length is only known once
+ *  written.  For an uncompressed image, held is set to the most data
+ *  streaming it can hold back: one row of blocks, or the whole image if
+ *  its bands are sequential.
+ */
+NITFPRIV(nitf_Off) knownImageDataLength(nitf_ImageSubheader *subhdr,
+                                        nitf_Off *held,
+                                        nitf_Error *error)
+{
+    nitf_Off blockRowLen;
+    char ic[NITF_IC_SZ + 1];
+    char imode[NITF_IMODE_SZ + 1];
+    nitf_Uint32 nbpp, numBands;
+    nitf_Uint32 numRows, numCols;
+    nitf_Uint32 numRowsPerBlock, numColsPerBlock;
+    nitf_Uint32 numBlocksPerRow, numBlocksPerCol;
+
+    if (!nitf_Field_get(subhdr->NITF_IC, ic, NITF_CONV_STRING,
+                        NITF_IC_SZ + 1, error))
+        return -1;
+    if (strncmp(ic, "NC", 2) != 0)
+        return 0;
+
+    NITF_TRY_GET_UINT32(subhdr->numBitsPerPixel, &nbpp, error);
+    numBands = nitf_ImageSubheader_getBandCount(subhdr, error);
+    if (numBands == NITF_INVALID_BAND_COUNT)
+        goto CATCH_ERROR;
+
+    if (!nitf_ImageSubheader_getBlocking(subhdr, &numRows, &numCols,
+                                         &numRowsPerBlock, &numColsPerBlock,
+                                         &numBlocksPerRow, &numBlocksPerCol,
+                                         imode, error))
+        goto CATCH_ERROR;
+
+    blockRowLen = (nitf_Off) numBlocksPerRow * numColsPerBlock *
+                  numRowsPerBlock * numBands * NITF_NBPP_TO_BYTES(nbpp);
+    *held = (imode[0] == 'S' && numBands > 1) ?
+            blockRowLen * numBlocksPerCol : blockRowLen;
+    return blockRowLen * numBlocksPerCol;
+
+CATCH_ERROR:
+    return -1;
+}
+
+/* Runs a subheader writer against a fresh spool */
+#define NITF_SPOOL_SUBHEADER(stage_, call_) \
+    { \
+        nitf_IOInterface *saved_ = writer->output; \
+        NITF_BOOL ok_; \
+        (stage_)->subheader = nitf_GrowableBufferAdapter_construct(0, error); \
+        if (!(stage_)->subheader) \
+            goto CATCH_ERROR; \
+        writer->output = (stage_)->subheader; \
+        ok_ = (call_); \
+        writer->output = saved_; \
+        if (!ok_) \
+            goto CATCH_ERROR; \
+        (stage_)->subheaderLen = \
+            nitf_IOInterface_getSize((stage_)->subheader, error); \
+    }
+
+/* Runs a segment data writer against a fresh spool */
+#define NITF_SPOOL_DATA(stage_, call_) \
+    { \
+        nitf_IOInterface *saved_ = writer->output; \
+        NITF_BOOL ok_; \
+        (stage_)->data = nitf_GrowableBufferAdapter_construct(0, error); \
+        if (!(stage_)->data) \
+            goto CATCH_ERROR; \
+        writer->output = (stage_)->data; \
+        ok_ = (call_); \
+        writer->output = saved_; \
+        if (!ok_) \
+            goto CATCH_ERROR; \
+        (stage_)->dataLen = nitf_IOInterface_getSize((stage_)->data, error); \
+    }
+
+/* Copies the contents of a spool to the real output */
+NITFPRIV(NITF_BOOL) emitSpool(nitf_Writer *writer, nitf_IOInterface *spool,
+                              nitf_Error *error)
+{
+    size_t size;
+    const char *buf = nitf_GrowableBufferAdapter_getBuffer(spool, &size,
+                                                           error);
+    if (!buf)
+        return NITF_FAILURE;
+    if (size == 0)
+        return NITF_SUCCESS;
+    return nitf_IOInterface_write(writer->output, buf, size, error);
+}
+
+NITFAPI(NITF_BOOL) nitf_Writer_writeSinglePass(nitf_Writer * writer,
+                                               nitf_Error * error)
+{
+    nitf_FileHeader *header = writer->record->header;
+    nitf_IOInterface *output = writer->output;
+    nitf_IOInterface *headerSpool = NULL;
+    nitf_IOInterface *forward = NULL;
+    nitf_Version fver = nitf_Record_getVersion(writer->record);
+    nitf_ListIterator iter;
+    nitf_Uint32 numImgs = 0, numGraphics = 0, numTexts = 0, numDEs = 0;
+    nitf_Uint32 numSegments = 0;
+    nitf_Uint32 hdrLen;
+    nitf_Uint32 i;
+    nitf_Off fileLenOff;
+    nitf_Off fileLen;
+    nitf_Off offset;
+    nitf_Off comratOff;
+    nitf_Off held;
+    nitf_Uint32 userSublen;
+    SegmentStage *stages = NULL;
+    SegmentStage *imageStages, *graphicStages, *textStages, *deStages;
+    nitf_Off *subLens = NULL;
+    nitf_Off *dataLens = NULL;
+    NITF_BOOL rc = NITF_FAILURE;
+
+    NITF_TRY_GET_UINT32(header->numImages, &numImgs, error);
+    NITF_TRY_GET_UINT32(header->numGraphics, &numGraphics, error);
+    NITF_TRY_GET_UINT32(header->numTexts, &numTexts, error);
+    NITF_TRY_GET_UINT32(header->numDataExtensions, &numDEs, error);
+
+    /* one extra of each, so that a record with no segments allocates */
+    numSegments = numImgs + numGraphics + numTexts + numDEs;
+    stages = (SegmentStage *) NITF_MALLOC((numSegments + 1) *
+                                          sizeof(SegmentStage));
+    subLens = (nitf_Off *) NITF_MALLOC(2 * (numSegments + 1) *
+                                       sizeof(nitf_Off));
+    if (!stages || !subLens)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(stages, 0, (numSegments + 1) * sizeof(SegmentStage));
+    dataLens = subLens + numSegments + 1;
+    imageStages = stages;
+    graphicStages = imageStages + numImgs;
+    textStages = graphicStages + numGraphics;
+    deStages = textStages + numTexts;
+
+    /*
+     *  Stage the segments.  Uncompressed image data is the only thing
+     *  whose length is known without writing it, so it alone is left
+     *  to be streamed.  Compressed data is spooled before its subheader
+     *  since the compressor may update COMRAT.
+     */
+    iter = nitf_List_begin(writer->record->images);
+    for (i = 0; i < numImgs; ++i)
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+
+        imageStages[i].dataLen = knownImageDataLength(segment->subheader,
+                                                      &held, error);
+        if (imageStages[i].dataLen < 0)
             goto CATCH_ERROR;
+        if (imageStages[i].dataLen != 0 && held > NITF_SINGLE_PASS_MAX_HELD)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                             "Image %d could hold %lld bytes back while "
+                             "streaming, more than the single-pass limit "
+                             "of %lld", i, (long long) held,
+                             (long long) NITF_SINGLE_PASS_MAX_HELD);
+            goto CATCH_ERROR;
+        }
+        if (imageStages[i].dataLen == 0)
+        {
+            NITF_SPOOL_DATA(&imageStages[i],
+                            writeImage(writer->imageWriters[i],
+                                       writer->output, error));
+        }
+        NITF_SPOOL_SUBHEADER(&imageStages[i],
+                             nitf_Writer_writeImageSubheader(writer,
+                                    segment->subheader, fver,
+                                    &comratOff, error));
+        nitf_ListIterator_increment(&iter);
+    }
 
-        if (!writeField(writer, header->NITF_FDT->raw, NITF_FDT_SZ, error))
+    iter = nitf_List_begin(writer->record->graphics);
+    for (i = 0; i < numGraphics; ++i)
+    {
+        nitf_GraphicSegment *segment =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
+
+        NITF_SPOOL_SUBHEADER(&graphicStages[i],
+                             writeGraphicSubheader(writer, segment->subheader,
+                                                   fver, error));
+        NITF_SPOOL_DATA(&graphicStages[i],
+                        writeGraphic(writer->graphicWriters[i],
+                                     writer->output, error));
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->texts);
+    for (i = 0; i < numTexts; ++i)
+    {
+        nitf_TextSegment *segment =
+            (nitf_TextSegment *) nitf_ListIterator_get(&iter);
+
+        NITF_SPOOL_SUBHEADER(&textStages[i],
+                             writeTextSubheader(writer, segment->subheader,
+                                                fver, error));
+        NITF_SPOOL_DATA(&textStages[i],
+                        writeText(writer->textWriters[i],
+                                  writer->output, error));
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->dataExtensions);
+    for (i = 0; i < numDEs; ++i)
+    {
+        nitf_DESegment *segment =
+            (nitf_DESegment *) nitf_ListIterator_get(&iter);
+
+        NITF_SPOOL_SUBHEADER(&deStages[i],
+                             nitf_Writer_writeDESubheader(writer,
+                                    segment->subheader, &userSublen,
+                                    fver, error));
+        NITF_SPOOL_DATA(&deStages[i],
+                        writeDE(writer, writer->dataExtensionWriters[i],
+                                segment->subheader, writer->output, error));
+        nitf_ListIterator_increment(&iter);
+    }
+
+    /* Now the header can be written and patched in memory */
+    headerSpool = nitf_GrowableBufferAdapter_construct(0, error);
+    if (!headerSpool)
+        goto CATCH_ERROR;
+
+    writer->output = headerSpool;
+    if (!nitf_Writer_writeHeader(writer, &fileLenOff, &hdrLen, error))
+        goto CATCH_ERROR;
+
+    fileLen = hdrLen;
+    for (i = 0; i < numSegments; ++i)
+    {
+        subLens[i] = stages[i].subheaderLen;
+        dataLens[i] = stages[i].dataLen;
+        fileLen += stages[i].subheaderLen + stages[i].dataLen;
+    }
+
+    if (!writeHeaderLengths(writer, fileLenOff, fileLen, hdrLen,
+                            numImgs, subLens, dataLens,
+                            numGraphics, subLens + numImgs,
+                            dataLens + numImgs,
+                            numTexts, subLens + numImgs + numGraphics,
+                            dataLens + numImgs + numGraphics,
+                            numDEs, subLens + numSegments - numDEs,
+                            dataLens + numSegments - numDEs, error))
+        goto CATCH_ERROR;
+
+    /* Finally, emit everything strictly in file order */
+    writer->output = output;
+    if (!emitSpool(writer, headerSpool, error))
+        goto CATCH_ERROR;
+    offset = hdrLen;
+
+    for (i = 0; i < numSegments; ++i)
+    {
+        if (!emitSpool(writer, stages[i].subheader, error))
             goto CATCH_ERROR;
+        offset += stages[i].subheaderLen;
+
+        if (stages[i].data)
+        {
+            if (!emitSpool(writer, stages[i].data, error))
+                goto CATCH_ERROR;
+        }
+        else
+        {
+            ForwardControl *control;
+
+            forward = Forward_construct(output, offset, error);
+            if (!forward)
+                goto CATCH_ERROR;
+            if (!writeImage(writer->imageWriters[i], forward, error))
+                goto CATCH_ERROR;
+
+            control = (ForwardControl *) forward->data;
+            if (control->numRanges != 0 ||
+                control->emitted != offset + stages[i].dataLen)
+            {
+                nitf_Error_initf(error, NITF_CTXT, NITF_ERR_WRITING_TO_FILE,
+                                 "Image %d wrote %lld contiguous bytes, "
+                                 "expected %lld", i,
+                                 (long long) (control->emitted - offset),
+                                 (long long) stages[i].dataLen);
+                goto CATCH_ERROR;
+            }
+            nitf_IOInterface_destruct(&forward);
+        }
+        offset += stages[i].dataLen;
     }
 
+    rc = NITF_SUCCESS;
+
+CATCH_ERROR:
+    writer->output = output;
     nitf_Writer_destructWriters(writer);
 
-    /*  We dont handle anything cool yet  */
+    if (forward)
+        nitf_IOInterface_destruct(&forward);
+    if (headerSpool)
+        nitf_IOInterface_destruct(&headerSpool);
+    for (i = 0; i < numSegments && stages; ++i)
+    {
+        if (stages[i].subheader)
+            nitf_IOInterface_destruct(&stages[i].subheader);
+        if (stages[i].data)
+            nitf_IOInterface_destruct(&stages[i].data);
+    }
+    if (stages)
+        NITF_FREE(stages);
+    if (subLens)
+        NITF_FREE(subLens);
+    return rc;
+}
+
+
+/* ------------------------------------------------------------------ */
+/*                PATCH MODE                                          */
+/* ------------------------------------------------------------------ */
+
+/* Size of the buffer used to move segment data within the file */
+#define NITF_PATCH_BUFFER_SIZE (1024 * 1024)
+
+/*
+ *  Where a segment's data sat in the file before patching.  Only data that
+ *  is kept is recorded; offset is -1 for data that has to be (re)written.
+ */
+typedef struct _PatchRange
+{
+    nitf_Off offset;
+    nitf_Off length;
+} PatchRange;
+
+/*
+ *  Moves length bytes from one offset of the output to another.  The
+ *  chunks are taken in whichever direction never reads bytes that have
+ *  already been overwritten, so the two ranges may overlap.
+ */
+NITFPRIV(NITF_BOOL) moveRange(nitf_IOInterface *io, nitf_Off from,
+                              nitf_Off to, nitf_Off length, char *buf,
+                              nitf_Error *error)
+{
+    nitf_Off done = 0;
+
+    while (done < length)
+    {
+        size_t chunk = (length - done) < NITF_PATCH_BUFFER_SIZE ?
+            (size_t) (length - done) : NITF_PATCH_BUFFER_SIZE;
+        nitf_Off at = to < from ? done : length - done - (nitf_Off) chunk;
+
+        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io, from + at,
+                                                   NITF_SEEK_SET, error)) ||
+            !nitf_IOInterface_read(io, buf, chunk, error) ||
+            !NITF_IO_SUCCESS(nitf_IOInterface_seek(io, to + at,
+                                                   NITF_SEEK_SET, error)) ||
+            !nitf_IOInterface_write(io, buf, chunk, error))
+            return NITF_FAILURE;
+        done += (nitf_Off) chunk;
+    }
     return NITF_SUCCESS;
+}
+
+/*
+ *  Checks that a field of a segment whose data is kept still reads as it
+ *  did in the file.  The fields checked either identify the segment, so a
+ *  reordered or replaced segment is caught, or fix the length and layout
+ *  of its data, which is not rewritten and so could not follow a change.
+ */
+NITFPRIV(NITF_BOOL) keptFieldMatches(const char *type, nitf_Uint32 index,
+                                     const char *name,
+                                     const nitf_Field *original,
+                                     const nitf_Field *patched,
+                                     nitf_Error *error)
+{
+    if (original->length == patched->length &&
+        memcmp(original->raw, patched->raw, original->length) == 0)
+        return NITF_SUCCESS;
+
+    nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                     "The %s in %s segment %u no longer matches the file, "
+                     "so its data cannot be kept", name, type, index);
+    return NITF_FAILURE;
+}
+
+#define NITF_PATCH_CHECK(type_, index_, label_, field_, original_, patched_) \
+    if (!keptFieldMatches(type_, index_, label_, (original_)->field_, \
+                          (patched_)->field_, error)) \
+        goto CATCH_ERROR
+
+/*
+ *  Re-reads the layout of the file being patched, filling in where the
+ *  data of each segment that is already in the file lives.  The ranges are
+ *  in the same order as the stages: images, graphics, texts then DEs.
+ */
+NITFPRIV(NITF_BOOL) readPatchLayout(nitf_Writer *writer, PatchRange *ranges,
+                                    nitf_Uint32 numImgs,
+                                    nitf_Uint32 numGraphics,
+                                    nitf_Uint32 numTexts,
+                                    nitf_Uint32 numDEs,
+                                    nitf_Error *error)
+{
+    nitf_Reader *reader = NULL;
+    nitf_Record *original = NULL;
+    nitf_ListIterator iter;
+    nitf_ListIterator newIter;
+    nitf_Uint32 num;
+    nitf_Uint32 i;
+    PatchRange *range;
+    NITF_BOOL rc = NITF_FAILURE;
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output, 0,
+                                               NITF_SEEK_SET, error)))
+        goto CATCH_ERROR;
+    reader = nitf_Reader_construct(error);
+    if (!reader)
+        goto CATCH_ERROR;
+    original = nitf_Reader_readIO(reader, writer->output, error);
+    if (!original)
+        goto CATCH_ERROR;
+
+    NITF_TRY_GET_UINT32(original->header->numReservedExtensions, &num, error);
+    if (num > 0)
+    {
+        nitf_Error_init(error,
+                        "Files with reserved extension segments cannot be "
+                        "patched", NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        goto CATCH_ERROR;
+    }
+
+    range = ranges;
+    NITF_TRY_GET_UINT32(original->header->numImages, &num, error);
+    if (num > numImgs)
+        goto REMOVED;
+    iter = nitf_List_begin(original->images);
+    newIter = nitf_List_begin(writer->record->images);
+    for (i = 0; i < num; ++i, ++range)
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+        nitf_ImageSubheader *subhdr = segment->subheader;
+        nitf_ImageSubheader *patched =
+            ((nitf_ImageSegment *) nitf_ListIterator_get(&newIter))->subheader;
+
+        NITF_PATCH_CHECK("image", i, "IID1", NITF_IID1, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "NROWS", NITF_NROWS, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "NCOLS", NITF_NCOLS, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "NBPP", NITF_NBPP, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "NBANDS", NITF_NBANDS, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "XBANDS", NITF_XBANDS, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "IMODE", NITF_IMODE, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "IC", NITF_IC, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "NBPR", NITF_NBPR, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "NBPC", NITF_NBPC, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "NPPBH", NITF_NPPBH, subhdr, patched);
+        NITF_PATCH_CHECK("image", i, "NPPBV", NITF_NPPBV, subhdr, patched);
+
+        range->offset = (nitf_Off) segment->imageOffset;
+        range->length = (nitf_Off) (segment->imageEnd - segment->imageOffset);
+        nitf_ListIterator_increment(&iter);
+        nitf_ListIterator_increment(&newIter);
+    }
+    range = ranges + numImgs;
+
+    NITF_TRY_GET_UINT32(original->header->numGraphics, &num, error);
+    if (num > numGraphics)
+        goto REMOVED;
+    iter = nitf_List_begin(original->graphics);
+    newIter = nitf_List_begin(writer->record->graphics);
+    for (i = 0; i < num; ++i, ++range)
+    {
+        nitf_GraphicSegment *segment =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
+        nitf_GraphicSegment *patched =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&newIter);
+
+        NITF_PATCH_CHECK("graphic", i, "SID", NITF_SID, segment->subheader,
+                         patched->subheader);
+        range->offset = (nitf_Off) segment->offset;
+        range->length = (nitf_Off) (segment->end - segment->offset);
+        nitf_ListIterator_increment(&iter);
+        nitf_ListIterator_increment(&newIter);
+    }
+    range = ranges + numImgs + numGraphics;
+
+    NITF_TRY_GET_UINT32(original->header->numTexts, &num, error);
+    if (num > numTexts)
+        goto REMOVED;
+    iter = nitf_List_begin(original->texts);
+    newIter = nitf_List_begin(writer->record->texts);
+    for (i = 0; i < num; ++i, ++range)
+    {
+        nitf_TextSegment *segment =
+            (nitf_TextSegment *) nitf_ListIterator_get(&iter);
+        nitf_TextSegment *patched =
+            (nitf_TextSegment *) nitf_ListIterator_get(&newIter);
+
+        NITF_PATCH_CHECK("text", i, "TEXTID", NITF_TEXTID,
+                         segment->subheader, patched->subheader);
+        range->offset = (nitf_Off) segment->offset;
+        range->length = (nitf_Off) (segment->end - segment->offset);
+        nitf_ListIterator_increment(&iter);
+        nitf_ListIterator_increment(&newIter);
+    }
+    range = ranges + numImgs + numGraphics + numTexts;
+
+    /* TRE_OVERFLOW data is rebuilt from the TREs, so it is never kept */
+    NITF_TRY_GET_UINT32(original->header->numDataExtensions, &num, error);
+    if (num > numDEs)
+        goto REMOVED;
+    iter = nitf_List_begin(original->dataExtensions);
+    newIter = nitf_List_begin(writer->record->dataExtensions);
+    for (i = 0; i < num; ++i, ++range)
+    {
+        nitf_DESegment *segment =
+            (nitf_DESegment *) nitf_ListIterator_get(&iter);
+        nitf_DESegment *patched =
+            (nitf_DESegment *) nitf_ListIterator_get(&newIter);
+        char desid[NITF_DESTAG_SZ + 1];
+
+        NITF_PATCH_CHECK("data extension", i, "DESID", NITF_DESTAG,
+                         segment->subheader, patched->subheader);
+        NITF_PATCH_CHECK("data extension", i, "DESVER", NITF_DESVER,
+                         segment->subheader, patched->subheader);
+        if (!nitf_Field_get(patched->subheader->NITF_DESTAG, desid,
+                            NITF_CONV_STRING, NITF_DESTAG_SZ + 1, error))
+            goto CATCH_ERROR;
+        nitf_Field_trimString(desid);
+        if (strcmp(desid, "TRE_OVERFLOW") != 0 &&
+            strcmp(desid, "Registered Extensions") != 0 &&
+            strcmp(desid, "Controlled Extensions") != 0)
+        {
+            range->offset = (nitf_Off) segment->offset;
+            range->length = (nitf_Off) (segment->end - segment->offset);
+        }
+        nitf_ListIterator_increment(&iter);
+        nitf_ListIterator_increment(&newIter);
+    }
+
+    rc = NITF_SUCCESS;
+    goto CATCH_ERROR;
+
+REMOVED:
+    nitf_Error_init(error, "Segments cannot be removed when patching a file",
+                    NITF_CTXT, NITF_ERR_INVALID_OBJECT);
 
 CATCH_ERROR:
+    if (original)
+        nitf_Record_destruct(&original);
+    if (reader)
+        nitf_Reader_destruct(&reader);
+    return rc;
+}
 
-    nitf_Writer_destructWriters(writer);
+NITFAPI(NITF_BOOL) nitf_Writer_patch(nitf_Writer * writer,
+                                     nitf_Error * error)
+{
+    nitf_FileHeader *header = writer->record->header;
+    nitf_IOInterface *output = writer->output;
+    nitf_IOInterface *headerSpool = NULL;
+    nitf_Version fver = nitf_Record_getVersion(writer->record);
+    nitf_ListIterator iter;
+    nitf_Uint32 numImgs = 0, numGraphics = 0, numTexts = 0, numDEs = 0;
+    nitf_Uint32 numSegments = 0;
+    nitf_Uint32 hdrLen;
+    nitf_Uint32 i;
+    nitf_Off fileLenOff;
+    nitf_Off fileLen;
+    nitf_Off offset;
+    nitf_Off comratOff;
+    nitf_Off size;
+    nitf_Uint32 userSublen;
+    SegmentStage *stages = NULL;
+    SegmentStage *imageStages, *graphicStages, *textStages, *deStages;
+    PatchRange *ranges = NULL;
+    nitf_Off *subLens = NULL;
+    nitf_Off *dataLens = NULL;
+    nitf_Off *dataOffsets = NULL;
+    char *buf = NULL;
+    NITF_BOOL rc = NITF_FAILURE;
+
+    NITF_TRY_GET_UINT32(header->numImages, &numImgs, error);
+    NITF_TRY_GET_UINT32(header->numGraphics, &numGraphics, error);
+    NITF_TRY_GET_UINT32(header->numTexts, &numTexts, error);
+    NITF_TRY_GET_UINT32(header->numDataExtensions, &numDEs, error);
+
+    /* one extra of each, so that a record with no segments allocates */
+    numSegments = numImgs + numGraphics + numTexts + numDEs;
+    stages = (SegmentStage *) NITF_MALLOC((numSegments + 1) *
+                                          sizeof(SegmentStage));
+    ranges = (PatchRange *) NITF_MALLOC((numSegments + 1) *
+                                        sizeof(PatchRange));
+    subLens = (nitf_Off *) NITF_MALLOC(3 * (numSegments + 1) *
+                                       sizeof(nitf_Off));
+    if (!stages || !ranges || !subLens)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(stages, 0, (numSegments + 1) * sizeof(SegmentStage));
+    for (i = 0; i < numSegments; ++i)
+    {
+        ranges[i].offset = -1;
+        ranges[i].length = 0;
+    }
+    dataLens = subLens + numSegments + 1;
+    dataOffsets = dataLens + numSegments + 1;
+    imageStages = stages;
+    graphicStages = imageStages + numImgs;
+    textStages = graphicStages + numGraphics;
+    deStages = textStages + numTexts;
 
-    if (numImgs != 0)
+    if (!readPatchLayout(writer, ranges, numImgs, numGraphics, numTexts,
+                         numDEs, error))
+        goto CATCH_ERROR;
+
+    /*
+     *  Stage every subheader, along with the data of the segments that are
+     *  new to the file.  The data of the others stays where it is.
+     */
+    iter = nitf_List_begin(writer->record->images);
+    for (i = 0; i < numImgs; ++i)
     {
-        NITF_FREE(imageSubLens);
-        NITF_FREE(imageDataLens);
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+
+        if (ranges[i].offset >= 0)
+            imageStages[i].dataLen = ranges[i].length;
+        else
+        {
+            NITF_SPOOL_DATA(&imageStages[i],
+                            writeImage(writer->imageWriters[i],
+                                       writer->output, error));
+        }
+        NITF_SPOOL_SUBHEADER(&imageStages[i],
+                             nitf_Writer_writeImageSubheader(writer,
+                                    segment->subheader, fver,
+                                    &comratOff, error));
+        nitf_ListIterator_increment(&iter);
     }
-    if (numGraphics != 0)
+
+    iter = nitf_List_begin(writer->record->graphics);
+    for (i = 0; i < numGraphics; ++i)
     {
-        NITF_FREE(graphicSubLens);
-        NITF_FREE(graphicDataLens);
+        nitf_GraphicSegment *segment =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
+
+        NITF_SPOOL_SUBHEADER(&graphicStages[i],
+                             writeGraphicSubheader(writer, segment->subheader,
+                                                   fver, error));
+        if (ranges[numImgs + i].offset >= 0)
+            graphicStages[i].dataLen = ranges[numImgs + i].length;
+        else
+        {
+            NITF_SPOOL_DATA(&graphicStages[i],
+                            writeGraphic(writer->graphicWriters[i],
+                                         writer->output, error));
+        }
+        nitf_ListIterator_increment(&iter);
     }
-    if (numTexts != 0)
+
+    iter = nitf_List_begin(writer->record->texts);
+    for (i = 0; i < numTexts; ++i)
     {
-        NITF_FREE(textSubLens);
-        NITF_FREE(textDataLens);
+        nitf_TextSegment *segment =
+            (nitf_TextSegment *) nitf_ListIterator_get(&iter);
+        PatchRange *range = &ranges[numImgs + numGraphics + i];
+
+        NITF_SPOOL_SUBHEADER(&textStages[i],
+                             writeTextSubheader(writer, segment->subheader,
+                                                fver, error));
+        if (range->offset >= 0)
+            textStages[i].dataLen = range->length;
+        else
+        {
+            NITF_SPOOL_DATA(&textStages[i],
+                            writeText(writer->textWriters[i],
+                                      writer->output, error));
+        }
+        nitf_ListIterator_increment(&iter);
     }
-    if (numDEs != 0)
+
+    iter = nitf_List_begin(writer->record->dataExtensions);
+    for (i = 0; i < numDEs; ++i)
     {
-        NITF_FREE(deSubLens);
-        NITF_FREE(deDataLens);
+        nitf_DESegment *segment =
+            (nitf_DESegment *) nitf_ListIterator_get(&iter);
+        PatchRange *range = &ranges[numSegments - numDEs + i];
+
+        NITF_SPOOL_SUBHEADER(&deStages[i],
+                             nitf_Writer_writeDESubheader(writer,
+                                    segment->subheader, &userSublen,
+                                    fver, error));
+        if (range->offset >= 0)
+            deStages[i].dataLen = range->length;
+        else
+        {
+            NITF_SPOOL_DATA(&deStages[i],
+                            writeDE(writer, writer->dataExtensionWriters[i],
+                                    segment->subheader, writer->output,
+                                    error));
+        }
+        nitf_ListIterator_increment(&iter);
     }
 
-    return NITF_FAILURE;
-}
+    headerSpool = nitf_GrowableBufferAdapter_construct(0, error);
+    if (!headerSpool)
+        goto CATCH_ERROR;
+
+    writer->output = headerSpool;
+    if (!nitf_Writer_writeHeader(writer, &fileLenOff, &hdrLen, error))
+        goto CATCH_ERROR;
+
+    fileLen = hdrLen;
+    for (i = 0; i < numSegments; ++i)
+    {
+        subLens[i] = stages[i].subheaderLen;
+        dataLens[i] = stages[i].dataLen;
+        dataOffsets[i] = fileLen + stages[i].subheaderLen;
+        fileLen = dataOffsets[i] + stages[i].dataLen;
+    }
+
+    if (!writeHeaderLengths(writer, fileLenOff, fileLen, hdrLen,
+                            numImgs, subLens, dataLens,
+                            numGraphics, subLens + numImgs,
+                            dataLens + numImgs,
+                            numTexts, subLens + numImgs + numGraphics,
+                            dataLens + numImgs + numGraphics,
+                            numDEs, subLens + numSegments - numDEs,
+                            dataLens + numSegments - numDEs, error))
+        goto CATCH_ERROR;
+    writer->output = output;
 
+    /*
+     *  Shift the kept data to its new home.  Everything that moves towards
+     *  the start of the file goes first, front to back, and then everything
+     *  that moves towards the end, back to front; since the segments keep
+     *  their order, no move ever lands on data that has yet to be moved.
+     *  When no lengths changed nothing moves at all.
+     */
+    for (i = 0; i < numSegments; ++i)
+    {
+        if (ranges[i].offset >= 0 && dataOffsets[i] < ranges[i].offset)
+        {
+            if (!buf && !(buf = (char *) NITF_MALLOC(NITF_PATCH_BUFFER_SIZE)))
+            {
+                nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                                NITF_CTXT, NITF_ERR_MEMORY);
+                goto CATCH_ERROR;
+            }
+            if (!moveRange(output, ranges[i].offset, dataOffsets[i],
+                           ranges[i].length, buf, error))
+                goto CATCH_ERROR;
+        }
+    }
+    for (i = numSegments; i > 0; --i)
+    {
+        if (ranges[i - 1].offset >= 0 &&
+            dataOffsets[i - 1] > ranges[i - 1].offset)
+        {
+            if (!buf && !(buf = (char *) NITF_MALLOC(NITF_PATCH_BUFFER_SIZE)))
+            {
+                nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                                NITF_CTXT, NITF_ERR_MEMORY);
+                goto CATCH_ERROR;
+            }
+            if (!moveRange(output, ranges[i - 1].offset, dataOffsets[i - 1],
+                           ranges[i - 1].length, buf, error))
+                goto CATCH_ERROR;
+        }
+    }
+
+    /* Then drop the metadata and any new data into the gaps */
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(output, 0, NITF_SEEK_SET,
+                                               error)) ||
+        !emitSpool(writer, headerSpool, error))
+        goto CATCH_ERROR;
+
+    for (i = 0; i < numSegments; ++i)
+    {
+        offset = dataOffsets[i] - stages[i].subheaderLen;
+        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(output, offset,
+                                                   NITF_SEEK_SET, error)) ||
+            !emitSpool(writer, stages[i].subheader, error))
+            goto CATCH_ERROR;
+        if (stages[i].data && !emitSpool(writer, stages[i].data, error))
+            goto CATCH_ERROR;
+    }
+
+    size = nitf_IOInterface_getSize(output, error);
+    if (!NITF_IO_SUCCESS(size))
+        goto CATCH_ERROR;
+    if (size > fileLen && !nitf_IOInterface_truncate(output, fileLen, error))
+        goto CATCH_ERROR;
+
+    /* leave the output at the end of the file, as a full write would */
+    offset = nitf_IOInterface_tell(output, error);
+    if (!NITF_IO_SUCCESS(offset))
+        goto CATCH_ERROR;
+    if (offset != fileLen &&
+        !NITF_IO_SUCCESS(nitf_IOInterface_seek(output, fileLen,
+                                               NITF_SEEK_SET, error)))
+        goto CATCH_ERROR;
+
+    rc = NITF_SUCCESS;
+
+CATCH_ERROR:
+    writer->output = output;
+    nitf_Writer_destructWriters(writer);
+
+    if (headerSpool)
+        nitf_IOInterface_destruct(&headerSpool);
+    for (i = 0; i < numSegments && stages; ++i)
+    {
+        if (stages[i].subheader)
+            nitf_IOInterface_destruct(&stages[i].subheader);
+        if (stages[i].data)
+            nitf_IOInterface_destruct(&stages[i].data);
+    }
+    if (stages)
+        NITF_FREE(stages);
+    if (ranges)
+        NITF_FREE(ranges);
+    if (subLens)
+        NITF_FREE(subLens);
+    if (buf)
+        NITF_FREE(buf);
+    return rc;
+}
 
 NITFAPI(NITF_BOOL) nitf_Writer_setImageWriteHandler(nitf_Writer *writer,
         int index, nitf_WriteHandler *writeHandler, nitf_Error * error)
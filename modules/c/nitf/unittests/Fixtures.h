@@ -0,0 +1,220 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __FIXTURES_H__
+#define __FIXTURES_H__
+
+/*
+ *  Small files the tests build, write and read back.  Each test is a
+ *  single source file, so these are defined here, and static so that
+ *  every test gets its own copy.
+ */
+
+#include <import/nitf.h>
+
+/*  Not every test uses every helper  */
+#if defined(__GNUC__)
+#    define FIXTURE static __attribute__((unused))
+#else
+#    define FIXTURE static
+#endif
+
+/* A 2.1 record with its date set, so that writes repeat exactly */
+FIXTURE nitf_Record* newRecord(nitf_Error* error)
+{
+    nitf_Record* record = nitf_Record_construct(NITF_VER_21, error);
+    if (record)
+        nitf_Field_setString(record->header->fileDateTime, "20161019120000",
+                             error);
+    return record;
+}
+
+/* Appends a raw TRE holding data */
+FIXTURE NITF_BOOL addTRE(nitf_Extensions* ext, const char* tag,
+                         const char* data, nitf_Error* error)
+{
+    nitf_TRE* tre = nitf_TRE_construct(tag, NITF_TRE_RAW, error);
+    if (!tre)
+        return NITF_FAILURE;
+    if (!nitf_TRE_setField(tre, NITF_TRE_RAW, (NITF_DATA*)data, strlen(data),
+                           error) ||
+        !nitf_Extensions_appendTRE(ext, tre, error))
+    {
+        nitf_TRE_destruct(&tre);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+/* The first TRE with this tag in the file header */
+FIXTURE nitf_TRE* getTRE(nitf_Record* record, const char* tag)
+{
+    nitf_Error error;
+    nitf_List* list = nitf_Extensions_getTREsByName(
+        record->header->userDefinedSection, tag);
+    return list ? (nitf_TRE*)nitf_List_get(list, 0, &error) : NULL;
+}
+
+/*
+ *  Adds an image of 8-bit integer pixels, MONO with one band or MULTI
+ *  with more
+ */
+FIXTURE nitf_ImageSegment* addImage(nitf_Record* record,
+                                    nitf_Uint32 numRows, nitf_Uint32 numCols,
+                                    nitf_Uint32 blockRows,
+                                    nitf_Uint32 blockCols, const char* imode,
+                                    nitf_Uint32 numBands, nitf_Error* error)
+{
+    nitf_ImageSegment* image = nitf_Record_newImageSegment(record, error);
+    nitf_BandInfo** bands;
+    nitf_Uint32 i;
+
+    if (!image)
+        return NULL;
+    bands = (nitf_BandInfo**)NITF_MALLOC(sizeof(nitf_BandInfo*) * numBands);
+    if (!bands)
+        return NULL;
+    for (i = 0; i < numBands; ++i)
+    {
+        bands[i] = nitf_BandInfo_construct(error);
+        if (!bands[i] ||
+            !nitf_BandInfo_init(bands[i], "M", " ", "N", "   ", 0, 0, NULL,
+                                error))
+            return NULL;
+    }
+    if (!nitf_ImageSubheader_setPixelInformation(
+            image->subheader, "INT", 8, 8, "R",
+            numBands == 1 ? "MONO" : "MULTI",
+            numBands == 1 ? "VIS" : "MS", numBands, bands, error) ||
+        !nitf_ImageSubheader_setBlocking(image->subheader, numRows, numCols,
+                                         blockRows, blockCols, imode, error))
+        return NULL;
+    return image;
+}
+
+/*
+ *  Gives image index of a prepared writer its pixels, one plane of
+ *  rows * columns bytes per band, one after the other
+ */
+FIXTURE nitf_ImageWriter* attachPixels(nitf_Writer* writer, int index,
+                                       const nitf_Uint8* pixels,
+                                       nitf_Error* error)
+{
+    nitf_ImageSegment* image = (nitf_ImageSegment*)nitf_List_get(
+        writer->record->images, index, error);
+    nitf_ImageWriter* imageWriter;
+    nitf_ImageSource* imageSource;
+    nitf_Uint32 numRows, numCols, numBands, i;
+
+    if (!image ||
+        !nitf_Field_get(image->subheader->numRows, &numRows, NITF_CONV_UINT,
+                        sizeof(numRows), error) ||
+        !nitf_Field_get(image->subheader->numCols, &numCols, NITF_CONV_UINT,
+                        sizeof(numCols), error))
+        return NULL;
+    numBands = nitf_ImageSubheader_getBandCount(image->subheader, error);
+
+    imageWriter = nitf_Writer_newImageWriter(writer, index, NULL, error);
+    imageSource = nitf_ImageSource_construct(error);
+    if (!imageWriter || !imageSource)
+        return NULL;
+    for (i = 0; i < numBands; ++i)
+    {
+        nitf_BandSource* band = nitf_MemorySource_construct(
+            pixels + i * numRows * numCols, numRows * numCols, 0, 1, 0,
+            error);
+        if (!band || !nitf_ImageSource_addBand(imageSource, band, error))
+            return NULL;
+    }
+    if (!nitf_ImageWriter_attachSource(imageWriter, imageSource, error))
+        return NULL;
+    return imageWriter;
+}
+
+/* Gives text segment index of a prepared writer its text */
+FIXTURE NITF_BOOL attachText(nitf_Writer* writer, int index,
+                             const char* text, nitf_Error* error)
+{
+    nitf_SegmentWriter* textWriter =
+        nitf_Writer_newTextWriter(writer, index, error);
+    nitf_SegmentSource* textSource;
+
+    if (!textWriter)
+        return NITF_FAILURE;
+    textSource = nitf_SegmentMemorySource_construct(text, strlen(text), 0, 0,
+                                                    0, error);
+    return textSource &&
+           nitf_SegmentWriter_attachSource(textWriter, textSource, error);
+}
+
+/*
+ *  Writes the record to memory, and leaves the buffer at its start.  If
+ *  they are given, pixels are the data of the first image and text that
+ *  of the first text segment.
+ */
+FIXTURE nitf_IOInterface* writeRecord(nitf_Record* record,
+                                      const nitf_Uint8* pixels,
+                                      const char* text, nitf_Error* error)
+{
+    nitf_Writer* writer = nitf_Writer_construct(error);
+    nitf_IOInterface* io = nitf_GrowableBufferAdapter_construct(0, error);
+    NITF_BOOL ok = writer && io &&
+                   nitf_Writer_prepareIO(writer, record, io, error) &&
+                   (!pixels || attachPixels(writer, 0, pixels, error)) &&
+                   (!text || attachText(writer, 0, text, error)) &&
+                   nitf_Writer_write(writer, error);
+
+    if (writer)
+        nitf_Writer_destruct(&writer);
+    if (io && (!ok || !NITF_IO_SUCCESS(nitf_IOInterface_seek(
+                          io, 0, NITF_SEEK_SET, error))))
+        nitf_IOInterface_destruct(&io);
+    return io;
+}
+
+/* Whether the two records write the same bytes */
+FIXTURE NITF_BOOL sameOutput(nitf_Record* first, nitf_Record* second,
+                             nitf_Error* error)
+{
+    nitf_IOInterface* a = writeRecord(first, NULL, NULL, error);
+    nitf_IOInterface* b = writeRecord(second, NULL, NULL, error);
+    char* aData = NULL;
+    char* bData = NULL;
+    size_t aSize = 0;
+    size_t bSize = 0;
+    NITF_BOOL same;
+
+    if (a)
+        aData = nitf_GrowableBufferAdapter_getBuffer(a, &aSize, error);
+    if (b)
+        bData = nitf_GrowableBufferAdapter_getBuffer(b, &bSize, error);
+    same = aData && bData && aSize == bSize &&
+           memcmp(aData, bData, aSize) == 0;
+
+    if (a)
+        nitf_IOInterface_destruct(&a);
+    if (b)
+        nitf_IOInterface_destruct(&b);
+    return same;
+}
+
+#endif
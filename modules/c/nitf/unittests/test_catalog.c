@@ -0,0 +1,351 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#ifdef WIN32
+#   include <direct.h>
+#   define MAKE_DIR(path) _mkdir(path)
+#else
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   define MAKE_DIR(path) mkdir(path, 0777)
+#endif
+
+#define ROOT "test_catalog_dir"
+#define SUB ROOT "/sub"
+#define TRE_DATA "alpha"
+#define SIDE 4
+
+static const char* TAGS[] = { "ZZCATA", NULL };
+static const char* SUFFIXES[] = { ".NTF", NULL };
+
+static void countError(NITF_DATA* user, const char* path,
+                       const nitf_Error* error)
+{
+    (void)path;
+    (void)error;
+    ++*(int*)user;
+}
+
+static NITF_BOOL addImage(nitf_Record* record, NITF_BOOL geo,
+                          NITF_BOOL tre, nitf_Error* error)
+{
+    nitf_ImageSegment* image = nitf_Record_newImageSegment(record, error);
+    nitf_BandInfo** bands;
+    double corners[4][2] = { { 10, 20 }, { 10, 21 }, { 9, 21 }, { 9, 20 } };
+
+    if (!image)
+        return NITF_FAILURE;
+    bands = (nitf_BandInfo**)NITF_MALLOC(sizeof(nitf_BandInfo*));
+    bands[0] = nitf_BandInfo_construct(error);
+    nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 0, 0, NULL, error);
+    nitf_ImageSubheader_setPixelInformation(image->subheader, "INT", 8, 8,
+                                            "R", "MONO", "VIS", 1, bands,
+                                            error);
+    nitf_ImageSubheader_setBlocking(image->subheader, SIDE, SIDE, SIDE, SIDE,
+                                    "B", error);
+    nitf_Field_setString(image->subheader->NITF_IID1, "CATALOGED", error);
+    if (geo && !nitf_ImageSubheader_setCornersFromLatLons(image->subheader,
+                                                          NITF_CORNERS_GEO,
+                                                          corners, error))
+        return NITF_FAILURE;
+    if (tre)
+    {
+        nitf_TRE* t = nitf_TRE_construct(TAGS[0], NITF_TRE_RAW, error);
+        if (!t || !nitf_TRE_setField(t, NITF_TRE_RAW, (NITF_DATA*)TRE_DATA,
+                                     strlen(TRE_DATA), error) ||
+            !nitf_Extensions_appendTRE(image->subheader->extendedSection, t,
+                                       error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+static NITF_BOOL writeFile(const char* path, int numImages,
+                           nitf_Error* error)
+{
+    nitf_Uint8 pixels[SIDE * SIDE] = { 0 };
+    nitf_Record* record = nitf_Record_construct(NITF_VER_21, error);
+    nitf_Writer* writer = NULL;
+    nitf_IOInterface* io = NULL;
+    NITF_BOOL ok = NITF_FAILURE;
+    int i;
+
+    if (!record)
+        return NITF_FAILURE;
+    nitf_Field_setString(record->header->fileDateTime, "20161019120000",
+                         error);
+    for (i = 0; i < numImages; ++i)
+        if (!addImage(record, i == 0, i == 0, error))
+            goto CLEANUP;
+
+    io = nitf_IOHandleAdapter_open(path, NITF_ACCESS_WRITEONLY,
+                                   NITF_CREATE | NITF_TRUNCATE, error);
+    writer = nitf_Writer_construct(error);
+    if (!io || !writer || !nitf_Writer_prepareIO(writer, record, io, error))
+        goto CLEANUP;
+    for (i = 0; i < numImages; ++i)
+    {
+        nitf_ImageWriter* imageWriter =
+            nitf_Writer_newImageWriter(writer, i, NULL, error);
+        nitf_ImageSource* source = nitf_ImageSource_construct(error);
+        nitf_BandSource* band = nitf_MemorySource_construct(
+            pixels, sizeof(pixels), 0, 1, 0, error);
+        if (!imageWriter || !source || !band ||
+            !nitf_ImageSource_addBand(source, band, error) ||
+            !nitf_ImageWriter_attachSource(imageWriter, source, error))
+            goto CLEANUP;
+    }
+    ok = nitf_Writer_write(writer, error);
+
+CLEANUP:
+    if (writer)
+        nitf_Writer_destruct(&writer);
+    if (io)
+    {
+        nitf_IOInterface_close(io, error);
+        nitf_IOInterface_destruct(&io);
+    }
+    nitf_Record_destruct(&record);
+    return ok;
+}
+
+static NITF_BOOL writeBytes(const char* path, const char* data, size_t size,
+                            nitf_Error* error)
+{
+    nitf_IOInterface* io = nitf_IOHandleAdapter_open(
+        path, NITF_ACCESS_WRITEONLY, NITF_CREATE | NITF_TRUNCATE, error);
+    NITF_BOOL ok;
+
+    if (!io)
+        return NITF_FAILURE;
+    ok = nitf_IOInterface_write(io, data, size, error);
+    nitf_IOInterface_close(io, error);
+    nitf_IOInterface_destruct(&io);
+    return ok;
+}
+
+/*
+ *  Two good NITFs with three images between them, only the first image of
+ *  each having corners and a TRE, then one NITF cut short, one file that
+ *  is not a NITF and one that the suffix rules out
+ */
+static NITF_BOOL makeTree(nitf_Error* error)
+{
+    char head[200];
+    nitf_IOInterface* io;
+    NITF_BOOL ok;
+
+    MAKE_DIR(ROOT);
+    MAKE_DIR(SUB);
+    if (!writeFile(ROOT "/a.ntf", 2, error) ||
+        !writeFile(SUB "/b.NTF", 1, error) ||
+        !writeBytes(ROOT "/junk.ntf", "not a NITF", 10, error) ||
+        !writeBytes(SUB "/notes.txt", "NITF notes", 10, error))
+        return NITF_FAILURE;
+
+    io = nitf_IOHandleAdapter_open(ROOT "/a.ntf", NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, error);
+    if (!io)
+        return NITF_FAILURE;
+    ok = nitf_IOInterface_read(io, head, sizeof(head), error);
+    nitf_IOInterface_close(io, error);
+    nitf_IOInterface_destruct(&io);
+    return ok && writeBytes(ROOT "/broken.ntf", head, sizeof(head), error);
+}
+
+static void removeTree(void)
+{
+    remove(ROOT "/a.ntf");
+    remove(ROOT "/junk.ntf");
+    remove(ROOT "/broken.ntf");
+    remove(SUB "/b.NTF");
+    remove(SUB "/notes.txt");
+    remove(SUB);
+    remove(ROOT);
+}
+
+static int countOf(const char* text, size_t size, const char* pattern)
+{
+    size_t length = strlen(pattern);
+    int count = 0;
+    size_t i;
+
+    for (i = 0; i + length <= size; ++i)
+        if (memcmp(text + i, pattern, length) == 0)
+            ++count;
+    return count;
+}
+
+static nitf_Uint32 readUint32(const char* data)
+{
+    nitf_Uint32 value;
+    memcpy(&value, data, sizeof(value));
+    return NITF_NTOHL(value);
+}
+
+TEST_CASE(testCatalogJSON)
+{
+    nitf_Error error;
+    nitf_CatalogOptions options;
+    nitf_CatalogSummary summary;
+    nitf_IOInterface* output;
+    char* text;
+    size_t size;
+    int errors = 0;
+
+    TEST_ASSERT(makeTree(&error));
+    output = nitf_GrowableBufferAdapter_construct(0, &error);
+    TEST_ASSERT(output);
+
+    nitf_CatalogOptions_init(&options);
+    options.numThreads = 2;
+    options.suffixes = SUFFIXES;
+    options.treTags = TAGS;
+    options.onError = countError;
+    options.user = &errors;
+    TEST_ASSERT(nitf_Catalog_scan(ROOT, &options, output, &summary, &error));
+
+    TEST_ASSERT_EQ_INT((int)summary.files, 2);
+    TEST_ASSERT_EQ_INT((int)summary.images, 3);
+    TEST_ASSERT_EQ_INT((int)summary.failures, 1);
+    TEST_ASSERT_EQ_INT(errors, 1);
+
+    text = nitf_GrowableBufferAdapter_getBuffer(output, &size, &error);
+    TEST_ASSERT(text);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "\n"), 3);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "a.ntf\",\"segment\":"), 2);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "\"iid1\":\"CATALOGED\""), 3);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "\"nrows\":4,\"ncols\":4"), 3);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "\"icords\":\"G\""), 2);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "\"corners\":[[10,20],"), 2);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "\"corners\":null"), 1);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "{\"ZZCATA\":\"" TRE_DATA "\"}"),
+                       2);
+    TEST_ASSERT_EQ_INT(countOf(text, size, "{\"ZZCATA\":null}"), 1);
+
+    nitf_IOInterface_destruct(&output);
+    removeTree();
+}
+
+TEST_CASE(testCatalogBinary)
+{
+    nitf_Error error;
+    nitf_CatalogOptions options;
+    nitf_CatalogSummary summary;
+    nitf_IOInterface* output;
+    char* data;
+    size_t size;
+
+    TEST_ASSERT(makeTree(&error));
+    output = nitf_GrowableBufferAdapter_construct(0, &error);
+    TEST_ASSERT(output);
+
+    /* one thread, so all the rows land in one block */
+    nitf_CatalogOptions_init(&options);
+    options.format = NITF_CATALOG_BINARY;
+    options.numThreads = 1;
+    options.suffixes = SUFFIXES;
+    options.treTags = TAGS;
+    TEST_ASSERT(nitf_Catalog_scan(ROOT, &options, output, &summary, &error));
+    TEST_ASSERT_EQ_INT((int)summary.images, 3);
+
+    data = nitf_GrowableBufferAdapter_getBuffer(output, &size, &error);
+    TEST_ASSERT(data);
+    TEST_ASSERT(size > 30);
+    TEST_ASSERT(memcmp(data, "NITFCAT1", 8) == 0);
+    TEST_ASSERT_EQ_INT((int)readUint32(data + 8), 1);
+    TEST_ASSERT_EQ_INT((int)readUint32(data + 12), 6);
+    TEST_ASSERT(memcmp(data + 16, "ZZCATA", 6) == 0);
+    TEST_ASSERT_EQ_INT((int)readUint32(data + 22), 3);
+    TEST_ASSERT_EQ_INT((int)readUint32(data + size - 4), 0);
+
+    nitf_IOInterface_destruct(&output);
+    removeTree();
+}
+
+TEST_CASE(testCatalogFile)
+{
+    nitf_Error error;
+    nitf_CatalogSummary summary;
+    nitf_IOInterface* output;
+
+    TEST_ASSERT(makeTree(&error));
+    output = nitf_GrowableBufferAdapter_construct(0, &error);
+    TEST_ASSERT(output);
+
+    /* a root that is a file is indexed on its own */
+    TEST_ASSERT(nitf_Catalog_scan(ROOT "/a.ntf", NULL, output, &summary,
+                                  &error));
+    TEST_ASSERT_EQ_INT((int)summary.files, 1);
+    TEST_ASSERT_EQ_INT((int)summary.images, 2);
+    TEST_ASSERT_EQ_INT((int)summary.failures, 0);
+
+    nitf_IOInterface_destruct(&output);
+    removeTree();
+}
+
+TEST_CASE(testCatalogSymlinkLoop)
+{
+#ifndef WIN32
+    nitf_Error error;
+    nitf_CatalogOptions options;
+    nitf_CatalogSummary summary;
+    nitf_IOInterface* output;
+
+    /* a link from deep in the tree back up to its root, and a link */
+    /* to a file, which is indexed like any other file              */
+    TEST_ASSERT(makeTree(&error));
+    TEST_ASSERT(symlink("..", SUB "/loop") == 0);
+    TEST_ASSERT(symlink("b.NTF", SUB "/c.ntf") == 0);
+    output = nitf_GrowableBufferAdapter_construct(0, &error);
+    TEST_ASSERT(output);
+
+    nitf_CatalogOptions_init(&options);
+    options.suffixes = SUFFIXES;
+    TEST_ASSERT(nitf_Catalog_scan(ROOT, &options, output, &summary, &error));
+    TEST_ASSERT_EQ_INT((int)summary.files, 3);
+    TEST_ASSERT_EQ_INT((int)summary.images, 4);
+    TEST_ASSERT_EQ_INT((int)summary.failures, 1);
+
+    nitf_IOInterface_destruct(&output);
+    remove(SUB "/loop");
+    remove(SUB "/c.ntf");
+    removeTree();
+#else
+    (void)testName;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testCatalogJSON);
+    CHECK(testCatalogBinary);
+    CHECK(testCatalogFile);
+    CHECK(testCatalogSymlinkLoop);
+    return 0;
+}
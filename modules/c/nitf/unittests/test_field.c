@@ -22,6 +22,7 @@
 
 #include <import/nitf.h>
 #include "Test.h"
+#include "Fixtures.h"
 
 TEST_CASE( testField)
 {
@@ -98,8 +99,198 @@ TEST_CASE( testField)
     TEST_ASSERT_NULL(realField);
 }
 
+TEST_CASE( testNumbers)
+{
+    nitf_Error error;
+    nitf_Int32 int32;
+    nitf_Uint32 uint32;
+    nitf_Int64 int64;
+    nitf_Uint64 uint64;
+    nitf_Field *bcsn = nitf_Field_construct(8, NITF_BCS_N, &error);
+    nitf_Field *bcsa = nitf_Field_construct(6, NITF_BCS_A, &error);
+    nitf_Field *wide = nitf_Field_construct(20, NITF_BCS_N, &error);
+
+    TEST_ASSERT(bcsn);
+    TEST_ASSERT(bcsa);
+    TEST_ASSERT(wide);
+
+    /* Set numbers are padded for the field type */
+    TEST_ASSERT(nitf_Field_setInt32(bcsn, -42, &error));
+    TEST_ASSERT(memcmp(bcsn->raw, "-0000042", 8) == 0);
+    TEST_ASSERT(nitf_Field_get(bcsn, &int32, NITF_CONV_INT, 4, &error));
+    TEST_ASSERT_EQ_INT(int32, -42);
+    TEST_ASSERT(nitf_Field_setUint32(bcsa, 1234, &error));
+    TEST_ASSERT(memcmp(bcsa->raw, "1234  ", 6) == 0);
+    TEST_ASSERT(!nitf_Field_setUint32(bcsa, 1234567, &error));
+
+    /* The extremes */
+    TEST_ASSERT(nitf_Field_setInt64(wide, (nitf_Int64)(~(nitf_Uint64)0 >> 1)
+                                    * -1 - 1, &error));
+    TEST_ASSERT(memcmp(wide->raw, "-9223372036854775808", 20) == 0);
+    TEST_ASSERT(nitf_Field_get(wide, &int64, NITF_CONV_INT, 8, &error));
+    TEST_ASSERT(int64 < 0 && (nitf_Uint64)int64 == (nitf_Uint64)1 << 63);
+    TEST_ASSERT(nitf_Field_setUint64(wide, ~(nitf_Uint64)0, &error));
+    TEST_ASSERT(memcmp(wide->raw, "18446744073709551615", 20) == 0);
+
+    /* Numbers are read as strtol would, up to the first non-digit */
+    TEST_ASSERT(nitf_Field_setRawData(bcsa, " +17 x", 6, &error));
+    TEST_ASSERT(nitf_Field_get(bcsa, &uint32, NITF_CONV_UINT, 4, &error));
+    TEST_ASSERT_EQ_INT((int)uint32, 17);
+    TEST_ASSERT(nitf_Field_setString(bcsa, "12.75", &error));
+    TEST_ASSERT(nitf_Field_get(bcsa, &int32, NITF_CONV_INT, 4, &error));
+    TEST_ASSERT_EQ_INT(int32, 12);
+    TEST_ASSERT(nitf_Field_setString(bcsa, "abc", &error));
+    TEST_ASSERT(nitf_Field_get(bcsa, &int32, NITF_CONV_INT, 4, &error));
+    TEST_ASSERT_EQ_INT(int32, 0);
+
+    /* A kept number is dropped whenever the field is set */
+    TEST_ASSERT(nitf_Field_setRawData(bcsn, "00000007", 8, &error));
+    TEST_ASSERT(nitf_Field_get(bcsn, &uint64, NITF_CONV_UINT, 8, &error));
+    TEST_ASSERT(uint64 == 7);
+    TEST_ASSERT(nitf_Field_setRawData(bcsn, "00000008", 8, &error));
+    TEST_ASSERT(nitf_Field_get(bcsn, &uint64, NITF_CONV_UINT, 8, &error));
+    TEST_ASSERT(uint64 == 8);
+    TEST_ASSERT(nitf_Field_setString(bcsn, "9", &error));
+    TEST_ASSERT(nitf_Field_get(bcsn, &int32, NITF_CONV_INT, 4, &error));
+    TEST_ASSERT_EQ_INT(int32, 9);
+    TEST_ASSERT(nitf_Field_setReal(bcsn, "f", 0, 3.5, &error));
+    TEST_ASSERT(nitf_Field_get(bcsn, &int32, NITF_CONV_INT, 4, &error));
+    TEST_ASSERT_EQ_INT(int32, 3);
+    TEST_ASSERT(nitf_Field_resetLength(bcsn, 4, 0, &error));
+    TEST_ASSERT(nitf_Field_get(bcsn, &int32, NITF_CONV_INT, 4, &error));
+    TEST_ASSERT_EQ_INT(int32, 0);
+
+    nitf_Field_destruct(&bcsn);
+    nitf_Field_destruct(&bcsa);
+    nitf_Field_destruct(&wide);
+}
+
+TEST_CASE( testCharacterSets)
+{
+    nitf_Error error;
+    char str[41];
+    nitf_Field *bcsa = nitf_Field_construct(40, NITF_BCS_A, &error);
+    nitf_Field *bcsn = nitf_Field_construct(12, NITF_BCS_N, &error);
+
+    TEST_ASSERT(bcsa);
+    TEST_ASSERT(bcsn);
+
+    /* Long strings are checked a word at a time, and then the tail */
+    memset(str, '~', 40);
+    str[0] = ' ';
+    str[40] = 0;
+    TEST_ASSERT(nitf_Field_setString(bcsa, str, &error));
+    str[21] = '\x7f';
+    TEST_ASSERT(!nitf_Field_setString(bcsa, str, &error));
+    str[21] = '\x1f';
+    TEST_ASSERT(!nitf_Field_setString(bcsa, str, &error));
+    str[21] = '~';
+    str[39] = '\x80';
+    TEST_ASSERT(!nitf_Field_setString(bcsa, str, &error));
+
+    TEST_ASSERT(nitf_Field_setString(bcsn, "-12.5/--", &error));
+    TEST_ASSERT(nitf_Field_setString(bcsn, "+7", &error));
+    TEST_ASSERT(!nitf_Field_setString(bcsn, "7+", &error));
+    TEST_ASSERT(!nitf_Field_setString(bcsn, "1.2.3", &error));
+    TEST_ASSERT(!nitf_Field_setString(bcsn, "12 ", &error));
+
+    nitf_Field_destruct(&bcsa);
+    nitf_Field_destruct(&bcsn);
+}
+
+static NITF_BOOL readsLikeAtof(const char *str)
+{
+    nitf_Error error;
+    double value;
+    double expected = atof(str);
+
+    return nitf_Field_parseReal64(str, strlen(str), &value, &error) &&
+           memcmp(&value, &expected, sizeof(double)) == 0;
+}
+
+TEST_CASE( testParsing)
+{
+    nitf_Error error;
+    nitf_Field *real = nitf_Field_construct(21, NITF_BCS_A, &error);
+    double value;
+
+    TEST_ASSERT(real);
+
+    /* Runs of eight digits or more */
+    TEST_ASSERT(nitf_Field_parseInt64("123456789012", 12) ==
+                (nitf_Int64)123456 * 1000000 + 789012);
+    TEST_ASSERT(nitf_Field_parseInt64(" -00000000042x", 14) == -42);
+    TEST_ASSERT(nitf_Field_parseInt64("1234567/9", 9) == 1234567);
+    TEST_ASSERT(nitf_Field_parseInt64("99999999999999999999", 20) ==
+                (nitf_Int64)(~(nitf_Uint64)0 >> 1));
+
+    /* Plain decimals are converted in place, the rest by atof */
+    TEST_ASSERT(readsLikeAtof("+1.23456789012345E+01"));
+    TEST_ASSERT(readsLikeAtof("-0.000000000000123456"));
+    TEST_ASSERT(readsLikeAtof("0.1"));
+    TEST_ASSERT(readsLikeAtof("-0"));
+    TEST_ASSERT(readsLikeAtof("  42.5   "));
+    TEST_ASSERT(readsLikeAtof("9007199254740993"));
+    TEST_ASSERT(readsLikeAtof("1.7976931348623157E+308"));
+    TEST_ASSERT(readsLikeAtof("4.9E-324"));
+    TEST_ASSERT(readsLikeAtof("12.5e"));
+    TEST_ASSERT(readsLikeAtof("1.5 x"));
+    TEST_ASSERT(readsLikeAtof("0x1p4"));
+    TEST_ASSERT(readsLikeAtof("."));
+
+    /* The field getter reads the same way */
+    TEST_ASSERT(nitf_Field_setString(real, "+1.23456789012345E+01", &error));
+    TEST_ASSERT(nitf_Field_get(real, &value, NITF_CONV_REAL, sizeof(double),
+                               &error));
+    TEST_ASSERT(value == atof("+1.23456789012345E+01"));
+
+    nitf_Field_destruct(&real);
+}
+
+TEST_CASE( testRawWrites)
+{
+    nitf_Error error;
+    nitf_Field *field = nitf_Field_construct(2, NITF_BCS_N, &error);
+    nitf_Record *record = newRecord(&error);
+    nitf_IOInterface *io;
+    nitf_Uint32 value;
+
+    TEST_ASSERT(field);
+    TEST_ASSERT(nitf_Field_setUint32(field, 5, &error));
+    TEST_ASSERT(nitf_Field_get(field, &value, NITF_CONV_INT, sizeof(value),
+                               &error));
+    TEST_ASSERT_EQ_INT(5, (int)value);
+
+    /* a write into raw is seen by the next read */
+    memcpy(field->raw, "09", 2);
+    TEST_ASSERT(nitf_Field_get(field, &value, NITF_CONV_INT, sizeof(value),
+                               &error));
+    TEST_ASSERT_EQ_INT(9, (int)value);
+    nitf_Field_destruct(&field);
+
+    /* the writer fills in a CLEVEL of 00 in place */
+    TEST_ASSERT(record);
+    TEST_ASSERT(nitf_Field_setUint32(record->header->complianceLevel, 0,
+                                     &error));
+    TEST_ASSERT(nitf_Field_get(record->header->complianceLevel, &value,
+                               NITF_CONV_INT, sizeof(value), &error));
+    TEST_ASSERT_EQ_INT(0, (int)value);
+    io = writeRecord(record, NULL, NULL, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nitf_Field_get(record->header->complianceLevel, &value,
+                               NITF_CONV_INT, sizeof(value), &error));
+    TEST_ASSERT_EQ_INT(3, (int)value);
+
+    nitf_IOInterface_destruct(&io);
+    nitf_Record_destruct(&record);
+}
+
 int main(int argc, char **argv)
 {
     CHECK(testField);
+    CHECK(testNumbers);
+    CHECK(testCharacterSets);
+    CHECK(testParsing);
+    CHECK(testRawWrites);
     return 0;
 }
@@ -0,0 +1,139 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+#define NUM_ROWS 20
+#define NUM_COLS 24
+
+typedef struct _Blocks
+{
+    int seen[4];
+} Blocks;
+
+static void traceBlock(NITF_DATA* data, const nitf_IOAccess* access)
+{
+    Blocks* blocks = (Blocks*)data;
+    if ((access->op == NITF_IO_STATS_READ ||
+         access->op == NITF_IO_STATS_BATCH) && access->block >= 0 &&
+        access->block < 4)
+        blocks->seen[access->block]++;
+}
+
+/* Writes a single-band image in 2x2 blocks to memory */
+static nitf_IOInterface* writeFile(nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+    nitf_IOInterface* io = NULL;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+
+    if (!record)
+        return NULL;
+    memset(pixels, 7, sizeof(pixels));
+    if (addImage(record, NUM_ROWS, NUM_COLS, 16, 16, "B", 1, error))
+        io = writeRecord(record, pixels, NULL, error);
+    nitf_Record_destruct(&record);
+    return io;
+}
+
+TEST_CASE(testReaderTags)
+{
+    nitf_Error error;
+    nitf_IOInterface* file = writeFile(&error);
+    nitf_IOInterface* io;
+    nitf_Reader* reader;
+    nitf_Record* record;
+    nitf_ImageReader* imageReader;
+    nitf_SubWindow* subWindow;
+    nitf_DownSampler* pixelSkip;
+    nitf_Uint32 bandList = 0;
+    nitf_Uint8 buf[NUM_ROWS * NUM_COLS];
+    nitf_Uint8* user = buf;
+    nitf_IOStats stats;
+    Blocks blocks;
+    nitf_Uint64 blockSize;
+    int padded;
+
+    TEST_ASSERT(file);
+    io = nitf_IOStatsAdapter_construct(file, 1, &error);
+    TEST_ASSERT(io);
+    memset(&blocks, 0, sizeof(blocks));
+    TEST_ASSERT(nitf_IOStatsAdapter_setTrace(io, &traceBlock, &blocks,
+                                             &error));
+
+    reader = nitf_Reader_construct(&error);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    subWindow = nitf_SubWindow_construct(&error);
+    pixelSkip = nitf_PixelSkip_construct(1, 1, &error);
+    subWindow->numRows = NUM_ROWS;
+    subWindow->numCols = NUM_COLS;
+    subWindow->bandList = &bandList;
+    subWindow->numBands = 1;
+    nitf_SubWindow_setDownSampler(subWindow, pixelSkip, &error);
+    TEST_ASSERT(nitf_ImageReader_read(imageReader, subWindow, &user, &padded,
+                                      &error));
+    TEST_ASSERT(buf[0] == 7 && buf[sizeof(buf) - 1] == 7);
+
+    /* The parse and the pixels are filed separately */
+    TEST_ASSERT(strcmp(nitf_IOStatsAdapter_getTag(io, 0), "header") == 0);
+    TEST_ASSERT(strcmp(nitf_IOStatsAdapter_getTag(io, 1), "image[0]") == 0);
+    TEST_ASSERT(nitf_IOStatsAdapter_getStats(io, "header", &stats, &error));
+    TEST_ASSERT(stats.ops[NITF_IO_STATS_READ].calls > 0);
+    TEST_ASSERT(nitf_IOStatsAdapter_getStats(io, "image[0]", &stats, &error));
+    TEST_ASSERT(stats.ops[NITF_IO_STATS_READ].calls +
+                stats.ops[NITF_IO_STATS_BATCH].calls > 0);
+
+    /* Reads, batched or not, were traced against their blocks */
+    TEST_ASSERT_EQ_INT(blocks.seen[0] + blocks.seen[1] + blocks.seen[2] +
+                       blocks.seen[3],
+                       (int)(stats.ops[NITF_IO_STATS_READ].calls +
+                             stats.ops[NITF_IO_STATS_BATCH].calls));
+    TEST_ASSERT(blocks.seen[0] > 0 && blocks.seen[1] > 0 &&
+                blocks.seen[2] > 0 && blocks.seen[3] > 0);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_DownSampler_destruct(&pixelSkip);
+    nitf_ImageReader_destruct(&imageReader);
+
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    TEST_ASSERT(nitf_ImageReader_readBlock(imageReader, 3, &blockSize,
+                                           &error));
+    TEST_ASSERT(blocks.seen[3] > 0);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testReaderTags);
+    return 0;
+}
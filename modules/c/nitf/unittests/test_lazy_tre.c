@@ -0,0 +1,158 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+#define FIRST_DATA "first lazy TRE"
+#define SECOND_DATA "second, never touched"
+
+static nitf_IOInterface* writeFile(nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+    nitf_IOInterface* io = NULL;
+
+    if (!record)
+        return NULL;
+    if (addTRE(record->header->userDefinedSection, "ZZLZYA", FIRST_DATA,
+               error) &&
+        addTRE(record->header->userDefinedSection, "ZZLZYB", SECOND_DATA,
+               error))
+        io = writeRecord(record, NULL, NULL, error);
+    nitf_Record_destruct(&record);
+    return io;
+}
+
+TEST_CASE(testLazyFieldAccess)
+{
+    nitf_Error error;
+    nitf_IOInterface* io = writeFile(&error);
+    nitf_Reader* reader;
+    nitf_Record* record;
+    nitf_TRE* tre;
+    nitf_Field* field;
+
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    nitf_Reader_setLazyTREs(reader, 1);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+
+    tre = getTRE(record, "ZZLZYA");
+    TEST_ASSERT(tre);
+    TEST_ASSERT(nitf_LazyTRE_isPending(tre));
+    TEST_ASSERT(nitf_LazyTRE_getOffset(tre) > 0);
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error),
+                       (int)strlen(FIRST_DATA));
+
+    /* the first field access parses it */
+    field = nitf_TRE_getField(tre, NITF_TRE_RAW);
+    TEST_ASSERT(field);
+    TEST_ASSERT(!nitf_LazyTRE_isPending(tre));
+    TEST_ASSERT_EQ_INT(nitf_LazyTRE_getOffset(tre), -1);
+    TEST_ASSERT_EQ_INT((int)field->length, (int)strlen(FIRST_DATA));
+    TEST_ASSERT(memcmp(field->raw, FIRST_DATA, field->length) == 0);
+
+    /* the other one is left alone */
+    TEST_ASSERT(nitf_LazyTRE_isPending(getTRE(record, "ZZLZYB")));
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testLazyRoundTrip)
+{
+    nitf_Error error;
+    nitf_IOInterface* io = writeFile(&error);
+    nitf_IOInterface* copy;
+    nitf_Reader* reader;
+    nitf_Record* record;
+    char* original;
+    char* written;
+    size_t originalSize, writtenSize;
+
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    nitf_Reader_setLazyTREs(reader, 1);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+
+    /* parse one TRE, and write the other straight from its raw bytes */
+    TEST_ASSERT(nitf_TRE_getField(getTRE(record, "ZZLZYA"), NITF_TRE_RAW));
+    copy = writeRecord(record, NULL, NULL, &error);
+    TEST_ASSERT(copy);
+    TEST_ASSERT(nitf_LazyTRE_isPending(getTRE(record, "ZZLZYB")));
+
+    original = nitf_GrowableBufferAdapter_getBuffer(io, &originalSize, &error);
+    written = nitf_GrowableBufferAdapter_getBuffer(copy, &writtenSize, &error);
+    TEST_ASSERT_EQ_INT((int)writtenSize, (int)originalSize);
+    TEST_ASSERT(memcmp(written, original, originalSize) == 0);
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&copy);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testLazyClone)
+{
+    nitf_Error error;
+    nitf_IOInterface* io = writeFile(&error);
+    nitf_Reader* reader;
+    nitf_Record* record;
+    nitf_Record* clone;
+    nitf_TRE* tre;
+    nitf_Field* field;
+
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    nitf_Reader_setLazyTREs(reader, 1);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    clone = nitf_Record_clone(record, &error);
+    TEST_ASSERT(clone);
+
+    /* the clone outlives the record it came from */
+    nitf_Record_destruct(&record);
+    tre = getTRE(clone, "ZZLZYB");
+    TEST_ASSERT(nitf_LazyTRE_isPending(tre));
+    field = nitf_TRE_getField(tre, NITF_TRE_RAW);
+    TEST_ASSERT(field);
+    TEST_ASSERT(memcmp(field->raw, SECOND_DATA, field->length) == 0);
+
+    nitf_Record_destruct(&clone);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testLazyFieldAccess);
+    CHECK(testLazyRoundTrip);
+    CHECK(testLazyClone);
+    return 0;
+}
@@ -0,0 +1,290 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+#define NUM_ROWS 64
+#define NUM_COLS 64
+#define BLOCK_SIZE 16
+#define BLOCKS_PER_ROW (NUM_COLS / BLOCK_SIZE)
+#define NUM_BLOCKS (BLOCKS_PER_ROW * (NUM_ROWS / BLOCK_SIZE))
+#define PAD_VALUE 0
+
+/* Blocks that are nothing but pad, scattered so later blocks move up */
+static int isPadBlock(int block)
+{
+    return block == 1 || block == 5 || block == 6 || block == 10;
+}
+
+static void makePixels(nitf_Uint8* pixels)
+{
+    int row, col;
+    for (row = 0; row < NUM_ROWS; ++row)
+        for (col = 0; col < NUM_COLS; ++col)
+        {
+            int block = (row / BLOCK_SIZE) * BLOCKS_PER_ROW +
+                col / BLOCK_SIZE;
+            pixels[row * NUM_COLS + col] = isPadBlock(block) ?
+                PAD_VALUE : (nitf_Uint8)(1 + (row * 7 + col) % 250);
+        }
+
+    /* a block with some pad in it is still written */
+    pixels[NUM_COLS * (NUM_ROWS - 1)] = PAD_VALUE;
+}
+
+/* Writes the image to memory with the given compression, NC or NM */
+static nitf_IOInterface* writeImage(const char* compression,
+                                    const nitf_Uint8* pixels, int caching,
+                                    nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+    nitf_IOInterface* io = nitf_GrowableBufferAdapter_construct(0, error);
+    nitf_Writer* writer = nitf_Writer_construct(error);
+    nitf_ImageSegment* image;
+    nitf_ImageWriter* imageWriter;
+    nitf_Uint8 pad = PAD_VALUE;
+    NITF_BOOL ok = 0;
+
+    if (!record || !io || !writer)
+        return NULL;
+    image = addImage(record, NUM_ROWS, NUM_COLS, BLOCK_SIZE, BLOCK_SIZE, "B",
+                     1, error);
+    if (image &&
+        nitf_Field_setString(image->subheader->NITF_IC, compression,
+                             error) &&
+        nitf_Writer_prepareIO(writer, record, io, error))
+    {
+        imageWriter = attachPixels(writer, 0, pixels, error);
+        if (imageWriter)
+            nitf_ImageWriter_setWriteCaching(imageWriter, caching);
+        ok = imageWriter &&
+             nitf_ImageWriter_setPadPixel(imageWriter, &pad, 1, error) &&
+             nitf_Writer_write(writer, error) &&
+             NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                                   error));
+    }
+
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+    if (!ok)
+        nitf_IOInterface_destruct(&io);
+    return io;
+}
+
+/* An image write handler that pushes the blocks out last first */
+typedef struct _BackwardsWrite
+{
+    nitf_ImageWriter* imageWriter;
+    const nitf_Uint8* pixels;
+} BackwardsWrite;
+
+static NITF_BOOL BackwardsWrite_write(NITF_DATA* data,
+                                      nitf_IOInterface* output,
+                                      nitf_Error* error)
+{
+    BackwardsWrite* write = (BackwardsWrite*)data;
+    nitf_Uint8 block[BLOCK_SIZE * BLOCK_SIZE];
+    int number, row;
+
+    if (!nitf_ImageWriter_open(write->imageWriter, output, error))
+        return NITF_FAILURE;
+    for (number = NUM_BLOCKS - 1; number >= 0; --number)
+    {
+        const int row0 = (number / BLOCKS_PER_ROW) * BLOCK_SIZE;
+        const int col0 = (number % BLOCKS_PER_ROW) * BLOCK_SIZE;
+        for (row = 0; row < BLOCK_SIZE; ++row)
+            memcpy(block + row * BLOCK_SIZE,
+                   write->pixels + (row0 + row) * NUM_COLS + col0,
+                   BLOCK_SIZE);
+        if (!nitf_ImageWriter_writeBlock(write->imageWriter, number, block,
+                                         error))
+            return NITF_FAILURE;
+    }
+    return nitf_ImageWriter_finish(write->imageWriter, error);
+}
+
+static void BackwardsWrite_destruct(NITF_DATA* data)
+{
+    BackwardsWrite* write = (BackwardsWrite*)data;
+    if (write->imageWriter)
+        nitf_WriteHandler_destruct(&write->imageWriter);
+    NITF_FREE(write);
+}
+
+/* Writes a masked image to memory, pushing its blocks out of order */
+static nitf_IOInterface* writeBackwards(const nitf_Uint8* pixels,
+                                        nitf_Error* error)
+{
+    static nitf_IWriteHandler iBackwards = {
+        &BackwardsWrite_write, &BackwardsWrite_destruct
+    };
+    nitf_Record* record = newRecord(error);
+    nitf_IOInterface* io = nitf_GrowableBufferAdapter_construct(0, error);
+    nitf_Writer* writer = nitf_Writer_construct(error);
+    nitf_WriteHandler* handler = NULL;
+    BackwardsWrite* write = NULL;
+    nitf_ImageSegment* image;
+    NITF_BOOL ok = 0;
+
+    if (!record || !io || !writer)
+        return NULL;
+    image = addImage(record, NUM_ROWS, NUM_COLS, BLOCK_SIZE, BLOCK_SIZE, "B",
+                     1, error);
+    if (image &&
+        nitf_Field_setString(image->subheader->NITF_IC, "NM", error) &&
+        nitf_Writer_prepareIO(writer, record, io, error))
+    {
+        handler = (nitf_WriteHandler*)NITF_MALLOC(sizeof(nitf_WriteHandler));
+        write = (BackwardsWrite*)NITF_MALLOC(sizeof(BackwardsWrite));
+        if (handler && write)
+        {
+            write->pixels = pixels;
+            write->imageWriter =
+                nitf_ImageWriter_construct(image->subheader, NULL, error);
+            handler->iface = &iBackwards;
+            handler->data = write;
+            ok = write->imageWriter &&
+                 nitf_Writer_setImageWriteHandler(writer, 0, handler,
+                                                  error) &&
+                 nitf_Writer_write(writer, error) &&
+                 NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                                       error));
+        }
+    }
+
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+    if (!ok)
+        nitf_IOInterface_destruct(&io);
+    return io;
+}
+
+/* Reads the whole image back */
+static NITF_BOOL readImage(nitf_IOInterface* io, nitf_Uint8* pixels,
+                           nitf_Error* error)
+{
+    nitf_Reader* reader = nitf_Reader_construct(error);
+    nitf_Record* record = NULL;
+    nitf_ImageReader* imageReader = NULL;
+    nitf_SubWindow* subWindow = nitf_SubWindow_construct(error);
+    nitf_Uint32 bandList = 0;
+    int padded;
+    NITF_BOOL ok = 0;
+
+    if (reader && subWindow)
+        record = nitf_Reader_readIO(reader, io, error);
+    if (record)
+        imageReader = nitf_Reader_newImageReader(reader, 0, NULL, error);
+    if (imageReader)
+    {
+        subWindow->numRows = NUM_ROWS;
+        subWindow->numCols = NUM_COLS;
+        subWindow->bandList = &bandList;
+        subWindow->numBands = 1;
+        ok = nitf_ImageReader_read(imageReader, subWindow, &pixels, &padded,
+                                   error);
+        nitf_ImageReader_destruct(&imageReader);
+    }
+
+    if (subWindow)
+        nitf_SubWindow_destruct(&subWindow);
+    if (record)
+        nitf_Record_destruct(&record);
+    if (reader)
+        nitf_Reader_destruct(&reader);
+    return ok;
+}
+
+static void checkMaskedWrite(const char* testName, int caching)
+{
+    nitf_Error error;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    nitf_Uint8 readBack[NUM_ROWS * NUM_COLS];
+    nitf_IOInterface* plain;
+    nitf_IOInterface* masked;
+    nitf_Off plainSize, maskedSize;
+
+    makePixels(pixels);
+    plain = writeImage("NC", pixels, caching, &error);
+    TEST_ASSERT(plain);
+    masked = writeImage("NM", pixels, caching, &error);
+    TEST_ASSERT(masked);
+
+    /* the pad-only blocks were dropped, which outweighs the masks */
+    plainSize = nitf_IOInterface_getSize(plain, &error);
+    maskedSize = nitf_IOInterface_getSize(masked, &error);
+    TEST_ASSERT(maskedSize < plainSize);
+    TEST_ASSERT(plainSize - maskedSize >= 3 * BLOCK_SIZE * BLOCK_SIZE);
+
+    /* and come back as pad, with the blocks after them in place */
+    memset(readBack, 0xff, sizeof(readBack));
+    TEST_ASSERT(readImage(masked, readBack, &error));
+    TEST_ASSERT(memcmp(readBack, pixels, sizeof(pixels)) == 0);
+
+    memset(readBack, 0xff, sizeof(readBack));
+    TEST_ASSERT(readImage(plain, readBack, &error));
+    TEST_ASSERT(memcmp(readBack, pixels, sizeof(pixels)) == 0);
+
+    nitf_IOInterface_destruct(&plain);
+    nitf_IOInterface_destruct(&masked);
+}
+
+TEST_CASE(testMaskedUncached)
+{
+    checkMaskedWrite(testName, 0);
+}
+
+TEST_CASE(testMaskedCached)
+{
+    checkMaskedWrite(testName, 1);
+}
+
+TEST_CASE(testMaskedOutOfOrder)
+{
+    nitf_Error error;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    nitf_Uint8 readBack[NUM_ROWS * NUM_COLS];
+    nitf_IOInterface* masked;
+
+    /* every block still lands where the mask says it is */
+    makePixels(pixels);
+    masked = writeBackwards(pixels, &error);
+    TEST_ASSERT(masked);
+
+    memset(readBack, 0xff, sizeof(readBack));
+    TEST_ASSERT(readImage(masked, readBack, &error));
+    TEST_ASSERT(memcmp(readBack, pixels, sizeof(pixels)) == 0);
+
+    nitf_IOInterface_destruct(&masked);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testMaskedUncached);
+    CHECK(testMaskedCached);
+    CHECK(testMaskedOutOfOrder);
+    return 0;
+}
@@ -0,0 +1,233 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+#define NUM_ROWS 16
+#define NUM_COLS 16
+#define TEXT_DATA "skipped text"
+
+/* An image with two TREs, then a text segment, in memory */
+static nitf_IOInterface* writeFile(nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+    nitf_ImageSegment* image;
+    nitf_TextSegment* text;
+    nitf_IOInterface* io = NULL;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+
+    if (!record)
+        return NULL;
+    memset(pixels, 3, sizeof(pixels));
+    image = addImage(record, NUM_ROWS, NUM_COLS, NUM_ROWS, NUM_COLS, "B", 1,
+                     error);
+    text = nitf_Record_newTextSegment(record, error);
+    if (image && text &&
+        nitf_Field_setString(text->subheader->NITF_TEXTID, "TXT001",
+                             error) &&
+        addTRE(image->subheader->extendedSection, "ZZKEEP", "kept", error) &&
+        addTRE(image->subheader->extendedSection, "ZZDROP", "dropped",
+               error))
+        io = writeRecord(record, pixels, TEXT_DATA, error);
+    nitf_Record_destruct(&record);
+    return io;
+}
+
+static nitf_SkippedItem* findSkipped(nitf_Reader* reader,
+                                     nitf_SkippedType type)
+{
+    nitf_ListIterator iter = nitf_List_begin(reader->skipped);
+    nitf_ListIterator end = nitf_List_end(reader->skipped);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_SkippedItem* item = (nitf_SkippedItem*)nitf_ListIterator_get(&iter);
+        if (item->type == type)
+            return item;
+        nitf_ListIterator_increment(&iter);
+    }
+    return NULL;
+}
+
+TEST_CASE(testParseFilters)
+{
+    const char* denied[] = { "ZZDROP", NULL };
+    nitf_Error error;
+    nitf_IOInterface* io = writeFile(&error);
+    nitf_Reader* reader;
+    nitf_Record* full;
+    nitf_Record* record;
+    nitf_ParseOptions options;
+    nitf_ImageSegment* image;
+    nitf_TextSegment* fullText;
+    nitf_TextSegment* text;
+    nitf_SkippedItem* item;
+    nitf_Uint32 rows;
+
+    TEST_ASSERT(io);
+
+    /* the unfiltered read is the reference */
+    reader = nitf_Reader_construct(&error);
+    full = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(full);
+    TEST_ASSERT(nitf_List_isEmpty(reader->skipped));
+    nitf_Reader_destruct(&reader);
+
+    nitf_ParseOptions_init(&options);
+    options.segments = NITF_PARSE_IMAGES;
+    options.treFilter = NITF_PARSE_TRES_DENY;
+    options.treTags = denied;
+    reader = nitf_Reader_construct(&error);
+    nitf_Reader_setParseOptions(reader, &options);
+    TEST_ASSERT(NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                                      &error)));
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT_EQ_INT(nitf_List_size(reader->skipped), 2);
+
+    /* the image subheader is there, less the denied TRE */
+    image = (nitf_ImageSegment*)nitf_List_get(record->images, 0, &error);
+    NITF_TRY_GET_UINT32(image->subheader->numRows, &rows, &error);
+    TEST_ASSERT_EQ_INT(rows, NUM_ROWS);
+    TEST_ASSERT(nitf_Extensions_exists(image->subheader->extendedSection,
+                                       "ZZKEEP"));
+    TEST_ASSERT(!nitf_Extensions_exists(image->subheader->extendedSection,
+                                        "ZZDROP"));
+
+    /* the text segment is only located */
+    fullText = (nitf_TextSegment*)nitf_List_get(full->texts, 0, &error);
+    text = (nitf_TextSegment*)nitf_List_get(record->texts, 0, &error);
+    TEST_ASSERT_EQ_INT((int)text->offset, (int)fullText->offset);
+    TEST_ASSERT_EQ_INT((int)text->end, (int)fullText->end);
+    TEST_ASSERT(strncmp(text->subheader->NITF_TEXTID->raw, "TXT001", 6) != 0);
+
+    /* and both can be parsed afterward */
+    item = findSkipped(reader, NITF_SKIPPED_TEXT);
+    TEST_ASSERT(item);
+    TEST_ASSERT(nitf_Reader_parseSkipped(reader, item, &error));
+    TEST_ASSERT(strncmp(text->subheader->NITF_TEXTID->raw, "TXT001", 6) == 0);
+
+    item = findSkipped(reader, NITF_SKIPPED_TRE);
+    TEST_ASSERT(item);
+    TEST_ASSERT(strcmp(item->tag, "ZZDROP") == 0);
+    TEST_ASSERT(nitf_Reader_parseSkipped(reader, item, &error));
+    TEST_ASSERT(nitf_Extensions_exists(image->subheader->extendedSection,
+                                       "ZZDROP"));
+    TEST_ASSERT(nitf_List_isEmpty(reader->skipped));
+
+    nitf_Record_destruct(&record);
+    nitf_Record_destruct(&full);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+    return;
+
+CATCH_ERROR:
+    TEST_ASSERT(0);
+}
+
+/* The tags of the TREs in ext, in order */
+static void listTags(nitf_Extensions* ext, char* tags)
+{
+    nitf_ExtensionsIterator iter = nitf_Extensions_begin(ext);
+    nitf_ExtensionsIterator end = nitf_Extensions_end(ext);
+    *tags = 0;
+    while (nitf_ExtensionsIterator_notEqualTo(&iter, &end))
+    {
+        strcat(tags, nitf_ExtensionsIterator_get(&iter)->tag);
+        strcat(tags, " ");
+        nitf_ExtensionsIterator_increment(&iter);
+    }
+}
+
+TEST_CASE(testSkippedTREsKeepTheirPlace)
+{
+    const char* denied[] = { "ZZDROP", NULL };
+    const char* dropped[] = { "one", "two", "three" };
+    nitf_Error error;
+    nitf_Record* original = newRecord(&error);
+    nitf_Extensions* ext;
+    nitf_IOInterface* io;
+    nitf_Reader* reader;
+    nitf_Record* record;
+    nitf_ParseOptions options;
+    nitf_List* list;
+    nitf_Field* field;
+    char tags[64];
+    int i;
+
+    TEST_ASSERT(original);
+    ext = original->header->userDefinedSection;
+    TEST_ASSERT(addTRE(ext, "ZZAAAA", "a", &error));
+    TEST_ASSERT(addTRE(ext, "ZZDROP", dropped[0], &error));
+    TEST_ASSERT(addTRE(ext, "ZZBBBB", "b", &error));
+    TEST_ASSERT(addTRE(ext, "ZZDROP", dropped[1], &error));
+    TEST_ASSERT(addTRE(ext, "ZZDROP", dropped[2], &error));
+    TEST_ASSERT(addTRE(ext, "ZZCCCC", "c", &error));
+    io = writeRecord(original, NULL, NULL, &error);
+    TEST_ASSERT(io);
+
+    nitf_ParseOptions_init(&options);
+    options.treFilter = NITF_PARSE_TRES_DENY;
+    options.treTags = denied;
+    reader = nitf_Reader_construct(&error);
+    nitf_Reader_setParseOptions(reader, &options);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT_EQ_INT(nitf_List_size(reader->skipped), 3);
+
+    /* last one first, so each has to find its place among the others */
+    while (!nitf_List_isEmpty(reader->skipped))
+        TEST_ASSERT(nitf_Reader_parseSkipped(
+                        reader, (nitf_SkippedItem*)reader->skipped->last->data,
+                        &error));
+
+    ext = record->header->userDefinedSection;
+    listTags(ext, tags);
+    TEST_ASSERT_EQ_STR(tags, "ZZAAAA ZZDROP ZZBBBB ZZDROP ZZDROP ZZCCCC ");
+    list = nitf_Extensions_getTREsByName(ext, "ZZDROP");
+    TEST_ASSERT_EQ_INT(nitf_List_size(list), 3);
+    for (i = 0; i < 3; ++i)
+    {
+        nitf_TRE* tre = (nitf_TRE*)nitf_List_get(list, i, &error);
+        field = nitf_TRE_getField(tre, NITF_TRE_RAW);
+        TEST_ASSERT(field);
+        TEST_ASSERT_EQ_INT((int)field->length, (int)strlen(dropped[i]));
+        TEST_ASSERT(memcmp(field->raw, dropped[i], field->length) == 0);
+    }
+    TEST_ASSERT(sameOutput(original, record, &error));
+
+    nitf_Record_destruct(&record);
+    nitf_Record_destruct(&original);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testParseFilters);
+    CHECK(testSkippedTREsKeepTheirPlace);
+    return 0;
+}
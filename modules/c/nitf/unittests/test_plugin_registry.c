@@ -0,0 +1,112 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+
+static const char *ident[] = { NITF_PLUGIN_TRE_KEY, "ZZMEMO", NULL };
+static nitf_TREHandler memoHandler;
+static int numRequests = 0;
+
+static const char** ZZMEMO_init(nitf_Error* error)
+{
+    (void)error;
+    return ident;
+}
+
+static nitf_TREHandler* ZZMEMO_handler(nitf_Error* error)
+{
+    (void)error;
+    ++numRequests;
+    return &memoHandler;
+}
+
+TEST_CASE(testHandlerIsRemembered)
+{
+    nitf_Error error;
+    nitf_PluginRegistry* reg = nitf_PluginRegistry_getInstance(&error);
+    nitf_TREHandler* handler;
+    int bad = 1;
+    int i;
+
+    TEST_ASSERT(reg);
+
+    /* an unknown tag is remembered as unknown */
+    for (i = 0; i < 3; ++i)
+    {
+        handler = nitf_PluginRegistry_retrieveTREHandler(reg, "ZZMEMO",
+                                                         &bad, &error);
+        TEST_ASSERT_NULL(handler);
+        TEST_ASSERT_EQ_INT(bad, 0);
+    }
+
+    /* until a handler is registered for it */
+    TEST_ASSERT(nitf_PluginRegistry_registerTREHandler(ZZMEMO_init,
+                                                       ZZMEMO_handler,
+                                                       &error));
+    TEST_ASSERT_EQ_INT(numRequests, 0);
+
+    for (i = 0; i < 3; ++i)
+    {
+        handler = nitf_PluginRegistry_retrieveTREHandler(reg, "ZZMEMO",
+                                                         &bad, &error);
+        TEST_ASSERT(handler == &memoHandler);
+        TEST_ASSERT_EQ_INT(bad, 0);
+    }
+    TEST_ASSERT_EQ_INT(numRequests, 1);
+    TEST_ASSERT(nitf_PluginRegistry_TREHandlerExists("ZZMEMO"));
+}
+
+TEST_CASE(testUnloadForgetsHandlers)
+{
+    nitf_Error error;
+    nitf_PluginRegistry* reg = nitf_PluginRegistry_getInstance(&error);
+    nitf_TREHandler* handler;
+    int bad = 1;
+    int before;
+
+    TEST_ASSERT(reg);
+    TEST_ASSERT(nitf_PluginRegistry_registerTREHandler(ZZMEMO_init,
+                                                       ZZMEMO_handler,
+                                                       &error));
+    handler = nitf_PluginRegistry_retrieveTREHandler(reg, "ZZMEMO",
+                                                     &bad, &error);
+    TEST_ASSERT(handler == &memoHandler);
+    before = numRequests;
+
+    /* it could have come from an unloaded DLL, so it is asked for again */
+    TEST_ASSERT(nitf_PluginRegistry_unload(reg, &error));
+    handler = nitf_PluginRegistry_retrieveTREHandler(reg, "ZZMEMO",
+                                                     &bad, &error);
+    TEST_ASSERT(handler == &memoHandler);
+    TEST_ASSERT_EQ_INT(bad, 0);
+    TEST_ASSERT_EQ_INT(numRequests, before + 1);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testHandlerIsRemembered);
+    CHECK(testUnloadForgetsHandlers);
+    return 0;
+}
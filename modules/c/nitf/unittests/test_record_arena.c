@@ -0,0 +1,188 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+static nitf_IOInterface* writeFile(nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+    nitf_IOInterface* io = NULL;
+
+    if (!record)
+        return NULL;
+    nitf_Field_setString(record->header->fileTitle, "arena", error);
+    if (addTRE(record->header->userDefinedSection, "ZZARNA", "kept", error) &&
+        addTRE(record->header->userDefinedSection, "ZZARNB", "removed", error))
+        io = writeRecord(record, NULL, NULL, error);
+    nitf_Record_destruct(&record);
+    return io;
+}
+
+/* Reads the file and changes it the same way each time */
+static nitf_Record* readAndChange(nitf_IOInterface* io, NITF_BOOL useArena,
+                                  nitf_Error* error)
+{
+    nitf_Reader* reader = nitf_Reader_construct(error);
+    nitf_Record* record;
+
+    if (!reader ||
+        !NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, error)))
+        return NULL;
+    nitf_Reader_setUseArena(reader, useArena);
+    record = nitf_Reader_readIO(reader, io, error);
+    nitf_Reader_destruct(&reader);
+    if (!record)
+        return NULL;
+
+    nitf_Field_setString(record->header->fileTitle, "changed after reading",
+                         error);
+    nitf_Extensions_removeTREsByName(record->header->userDefinedSection,
+                                     "ZZARNB");
+    if (!addTRE(record->header->userDefinedSection, "ZZARNC", "added", error))
+        nitf_Record_destruct(&record);
+    return record;
+}
+
+TEST_CASE(testReadIntoArena)
+{
+    nitf_Error error;
+    nitf_IOInterface* io = writeFile(&error);
+    nitf_Record* record;
+    nitf_Record* plain;
+    nitf_List* list;
+    nitf_TRE* tre;
+    void* heap;
+
+    TEST_ASSERT(io);
+    record = readAndChange(io, 1, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(record->arena);
+
+    /* the TREs that were read are in the arena, the rest is not */
+    TEST_ASSERT_NULL(nitf_Arena_find(record));
+    TEST_ASSERT_NULL(nitf_Arena_find(record->header));
+    list = nitf_Extensions_getTREsByName(record->header->userDefinedSection,
+                                         "ZZARNA");
+    TEST_ASSERT(list);
+    tre = (nitf_TRE*)nitf_List_get(list, 0, &error);
+    TEST_ASSERT(nitf_Arena_find(tre->priv) == record->arena);
+    TEST_ASSERT(nitf_Arena_find(nitf_TRE_getField(tre, NITF_TRE_RAW)) ==
+                record->arena);
+    list = nitf_Extensions_getTREsByName(record->header->userDefinedSection,
+                                         "ZZARNC");
+    TEST_ASSERT(list);
+    tre = (nitf_TRE*)nitf_List_get(list, 0, &error);
+    TEST_ASSERT_NULL(nitf_Arena_find(tre->priv));
+
+    /* the arena is only used when asked for */
+    heap = NITF_MALLOC(16);
+    TEST_ASSERT(heap);
+    TEST_ASSERT_NULL(nitf_Arena_find(heap));
+    NITF_FREE(heap);
+
+    plain = readAndChange(io, 0, &error);
+    TEST_ASSERT(plain);
+    TEST_ASSERT_NULL(plain->arena);
+    TEST_ASSERT_NULL(nitf_Arena_find(plain->header));
+    TEST_ASSERT(sameOutput(record, plain, &error));
+
+    nitf_Record_destruct(&record);
+    TEST_ASSERT_NULL(record);
+    nitf_Record_destruct(&plain);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testCloneOutlivesArena)
+{
+    nitf_Error error;
+    nitf_IOInterface* io = writeFile(&error);
+    nitf_Record* record;
+    nitf_Record* clone;
+    nitf_Record* plain;
+    nitf_List* list;
+    nitf_TRE* tre;
+
+    TEST_ASSERT(io);
+    record = readAndChange(io, 1, &error);
+    TEST_ASSERT(record);
+    clone = nitf_Record_clone(record, &error);
+    TEST_ASSERT(clone);
+    TEST_ASSERT_NULL(clone->arena);
+    TEST_ASSERT_NULL(nitf_Arena_find(clone->header));
+
+    /* TREs in the arena are copied rather than shared */
+    list = nitf_Extensions_getTREsByName(clone->header->userDefinedSection,
+                                         "ZZARNA");
+    TEST_ASSERT(list);
+    tre = (nitf_TRE*)nitf_List_get(list, 0, &error);
+    TEST_ASSERT(!nitf_SharedTRE_isShared(tre));
+    nitf_Record_destruct(&record);
+
+    plain = readAndChange(io, 0, &error);
+    TEST_ASSERT(plain);
+    TEST_ASSERT(sameOutput(clone, plain, &error));
+
+    nitf_Record_destruct(&clone);
+    nitf_Record_destruct(&plain);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testStatsOutliveArena)
+{
+    nitf_Error error;
+    nitf_IOInterface* file = writeFile(&error);
+    nitf_IOInterface* io;
+    nitf_Reader* reader;
+    nitf_Record* record;
+    nitf_IOStats stats;
+
+    TEST_ASSERT(file);
+    io = nitf_IOStatsAdapter_construct(file, 1, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    nitf_Reader_setUseArena(reader, 1);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(record->arena);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+
+    /* the tags the read filed under belong to the adapter */
+    TEST_ASSERT_EQ_STR(nitf_IOStatsAdapter_getTag(io, 0), "header");
+    TEST_ASSERT(nitf_IOStatsAdapter_getStats(io, "header", &stats, &error));
+    TEST_ASSERT(stats.ops[NITF_IO_STATS_READ].bytes > 0);
+
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testReadIntoArena);
+    CHECK(testCloneOutlivesArena);
+    CHECK(testStatsOutliveArena);
+    return 0;
+}
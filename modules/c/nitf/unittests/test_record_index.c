@@ -0,0 +1,290 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#ifndef WIN32
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#endif
+
+#define FILE_NAME "test_record_index.ntf"
+#define INDEX_NAME "test_record_index.ntf.idx"
+#define COPY_NAME "test_record_index.ntf.tmp"
+#define NUM_ROWS 20
+#define NUM_COLS 24
+
+/* Writes a masked single-band image in 2x2 blocks */
+static NITF_BOOL writeFile(nitf_Error* error)
+{
+    nitf_Record* record = nitf_Record_construct(NITF_VER_21, error);
+    nitf_Writer* writer = nitf_Writer_construct(error);
+    nitf_IOInterface* io = nitf_IOHandleAdapter_open(
+        FILE_NAME, NITF_ACCESS_WRITEONLY, NITF_CREATE | NITF_TRUNCATE, error);
+    nitf_ImageSegment* image = nitf_Record_newImageSegment(record, error);
+    nitf_BandInfo** bands =
+        (nitf_BandInfo**)NITF_MALLOC(sizeof(nitf_BandInfo*));
+    nitf_ImageWriter* imageWriter;
+    nitf_ImageSource* imageSource;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    NITF_BOOL ok = NITF_FAILURE;
+    int i;
+
+    if (!io)
+        return NITF_FAILURE;
+    for (i = 0; i < NUM_ROWS * NUM_COLS; ++i)
+        pixels[i] = (nitf_Uint8)(i * 7);
+    bands[0] = nitf_BandInfo_construct(error);
+    nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 0, 0, NULL, error);
+    nitf_ImageSubheader_setPixelInformation(image->subheader, "INT", 8, 8,
+                                            "R", "MONO", "VIS", 1, bands,
+                                            error);
+    nitf_ImageSubheader_setBlocking(image->subheader, NUM_ROWS, NUM_COLS,
+                                    16, 16, "B", error);
+    nitf_ImageSubheader_setCompression(image->subheader, "NM", "", error);
+
+    if (nitf_Writer_prepareIO(writer, record, io, error))
+    {
+        imageWriter = nitf_Writer_newImageWriter(writer, 0, NULL, error);
+        imageSource = nitf_ImageSource_construct(error);
+        nitf_ImageSource_addBand(imageSource,
+                                 nitf_MemorySource_construct(
+                                     pixels, sizeof(pixels), 0, 1, 0, error),
+                                 error);
+        nitf_ImageWriter_attachSource(imageWriter, imageSource, error);
+        ok = nitf_Writer_write(writer, error);
+    }
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+    nitf_IOInterface_close(io, error);
+    nitf_IOInterface_destruct(&io);
+    return ok;
+}
+
+/*
+ *  Opens the file through an index and makes an image reader, counting the
+ *  reads that making the image reader takes, then checks the pixels
+ */
+static void openImage(const char* testName, NITF_BOOL cached)
+{
+    nitf_Error error;
+    nitf_IOHandle handle;
+    nitf_IOInterface* io;
+    nitf_RecordIndex* index;
+    nitf_Reader* reader;
+    nitf_Record* record;
+    nitf_ImageReader* imageReader;
+    nitf_SubWindow* subWindow;
+    nitf_DownSampler* pixelSkip;
+    nitf_IOStats stats;
+    nitf_Uint32 bandList = 0;
+    nitf_Uint8 buf[NUM_ROWS * NUM_COLS];
+    nitf_Uint8* user = buf;
+    int padded;
+    int i;
+
+    handle = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                                  NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(handle));
+    index = nitf_RecordIndex_load(INDEX_NAME, handle, &error);
+    TEST_ASSERT(index);
+    TEST_ASSERT_EQ_INT((int)index->numImages, cached ? 1 : 0);
+
+    io = nitf_IOStatsAdapter_construct(
+        nitf_IOHandleAdapter_construct(handle, NITF_ACCESS_READONLY, &error),
+        1, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    nitf_Reader_setIndex(reader, index);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+
+    TEST_ASSERT(nitf_IOStatsAdapter_reset(io, &error));
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    TEST_ASSERT(nitf_IOStatsAdapter_getStats(io, NULL, &stats, &error));
+    if (cached)
+    {
+        TEST_ASSERT_EQ_INT((int)stats.ops[NITF_IO_STATS_READ].calls, 0);
+    }
+    else
+    {
+        /* the mask header and masks are read up front */
+        TEST_ASSERT(stats.ops[NITF_IO_STATS_READ].calls > 0);
+        TEST_ASSERT(index->changed);
+    }
+    TEST_ASSERT_EQ_INT((int)index->numImages, 1);
+    TEST_ASSERT(index->images[0].layout);
+    TEST_ASSERT_EQ_INT((int)index->images[0].layout->numBlocks, 4);
+    TEST_ASSERT(index->images[0].layout->blockRecordLength > 0);
+
+    subWindow = nitf_SubWindow_construct(&error);
+    pixelSkip = nitf_PixelSkip_construct(1, 1, &error);
+    subWindow->numRows = NUM_ROWS;
+    subWindow->numCols = NUM_COLS;
+    subWindow->bandList = &bandList;
+    subWindow->numBands = 1;
+    nitf_SubWindow_setDownSampler(subWindow, pixelSkip, &error);
+    TEST_ASSERT(nitf_ImageReader_read(imageReader, subWindow, &user, &padded,
+                                      &error));
+    for (i = 0; i < NUM_ROWS * NUM_COLS; ++i)
+        TEST_ASSERT_EQ_INT(buf[i], (nitf_Uint8)(i * 7));
+
+    TEST_ASSERT(nitf_RecordIndex_save(index, INDEX_NAME, &error));
+    TEST_ASSERT(!index->changed);
+
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_DownSampler_destruct(&pixelSkip);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+    nitf_RecordIndex_destruct(&index);
+    nitf_IOHandle_close(handle);
+}
+
+TEST_CASE(testIndexIsFilledThenUsed)
+{
+    nitf_Error error;
+
+    remove(INDEX_NAME);
+    TEST_ASSERT(writeFile(&error));
+    openImage(testName, 0);
+    openImage(testName, 1);
+    remove(INDEX_NAME);
+    remove(FILE_NAME);
+}
+
+TEST_CASE(testIndexOfAnotherFileIsIgnored)
+{
+    nitf_Error error;
+    nitf_IOHandle handle;
+    nitf_RecordIndex* index;
+
+    remove(INDEX_NAME);
+    TEST_ASSERT(writeFile(&error));
+    openImage(testName, 0);
+
+    /* a different file of the same name gets an empty index */
+    handle = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_WRITEONLY,
+                                  NITF_CREATE | NITF_TRUNCATE, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(handle));
+    TEST_ASSERT(nitf_IOHandle_write(handle, "NITF02.10", 9, &error));
+    nitf_IOHandle_close(handle);
+
+    handle = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                                  NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(handle));
+    index = nitf_RecordIndex_load(INDEX_NAME, handle, &error);
+    TEST_ASSERT(index);
+    TEST_ASSERT_EQ_INT((int)index->numImages, 0);
+    TEST_ASSERT_EQ_INT((int)index->fileSize, 9);
+    nitf_RecordIndex_destruct(&index);
+    nitf_IOHandle_close(handle);
+
+    remove(INDEX_NAME);
+    remove(FILE_NAME);
+}
+
+#ifndef WIN32
+/* Loads the index for the file, returning how many images it knows of */
+static int indexedImages(nitf_Error* error)
+{
+    nitf_IOHandle handle;
+    nitf_RecordIndex* index;
+    int numImages = -1;
+
+    handle = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                                  NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(handle))
+        return -1;
+    index = nitf_RecordIndex_load(INDEX_NAME, handle, error);
+    if (index)
+        numImages = (int)index->numImages;
+    nitf_RecordIndex_destruct(&index);
+    nitf_IOHandle_close(handle);
+    return numImages;
+}
+
+/* Sets the file's modification time to the given second and nanosecond */
+static NITF_BOOL setModified(const char* path, time_t seconds, long nanos)
+{
+    struct timespec times[2];
+
+    times[0].tv_sec = times[1].tv_sec = seconds;
+    times[0].tv_nsec = times[1].tv_nsec = nanos;
+    return utimensat(AT_FDCWD, path, times, 0) == 0;
+}
+#endif
+
+TEST_CASE(testIndexOfChangedFileIsIgnored)
+{
+#ifndef WIN32
+    nitf_Error error;
+    char buf[65536];
+    FILE* in;
+    FILE* out;
+    size_t size;
+
+    remove(INDEX_NAME);
+    TEST_ASSERT(writeFile(&error));
+    TEST_ASSERT(setModified(FILE_NAME, 1000000000, 100));
+    openImage(testName, 0);
+    TEST_ASSERT_EQ_INT(indexedImages(&error), 1);
+
+    /* touched within the same second */
+    TEST_ASSERT(setModified(FILE_NAME, 1000000000, 200));
+    TEST_ASSERT_EQ_INT(indexedImages(&error), 0);
+    openImage(testName, 0);
+    TEST_ASSERT_EQ_INT(indexedImages(&error), 1);
+
+    /* replaced by a copy with the same bytes and the same times */
+    in = fopen(FILE_NAME, "rb");
+    out = fopen(COPY_NAME, "wb");
+    TEST_ASSERT(in && out);
+    size = fread(buf, 1, sizeof(buf), in);
+    TEST_ASSERT(size > 0 && size < sizeof(buf));
+    TEST_ASSERT_EQ_INT((int)fwrite(buf, 1, size, out), (int)size);
+    fclose(in);
+    fclose(out);
+    TEST_ASSERT(setModified(COPY_NAME, 1000000000, 200));
+    TEST_ASSERT(rename(COPY_NAME, FILE_NAME) == 0);
+    TEST_ASSERT_EQ_INT(indexedImages(&error), 0);
+
+    remove(INDEX_NAME);
+    remove(FILE_NAME);
+#else
+    (void)testName;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testIndexIsFilledThenUsed);
+    CHECK(testIndexOfAnotherFileIsIgnored);
+    CHECK(testIndexOfChangedFileIsIgnored);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#define NUM_IMAGES 200
+
+static void setImageId(nitf_ImageSegment* segment, int n, nitf_Error* error)
+{
+    char id[11];
+    NITF_SNPRINTF(id, sizeof(id), "IMAGE%05d", n);
+    nitf_Field_setString(segment->subheader->imageId, id, error);
+}
+
+static int getImageId(nitf_ImageSegment* segment, nitf_Error* error)
+{
+    char id[11];
+    nitf_Field_get(segment->subheader->imageId, id, NITF_CONV_STRING,
+                   sizeof(id), error);
+    return NITF_ATO32(id + 5);
+}
+
+TEST_CASE(testGetSegments)
+{
+    nitf_Error error;
+    nitf_Record* record = nitf_Record_construct(NITF_VER_21, &error);
+    nitf_TextSegment* text;
+    int i;
+
+    TEST_ASSERT(record);
+    for (i = 0; i < NUM_IMAGES; ++i)
+    {
+        nitf_ImageSegment* segment = nitf_Record_newImageSegment(record,
+                                                                 &error);
+        TEST_ASSERT(segment);
+        setImageId(segment, i, &error);
+    }
+    text = nitf_Record_newTextSegment(record, &error);
+    TEST_ASSERT(text);
+
+    for (i = NUM_IMAGES - 1; i >= 0; --i)
+    {
+        nitf_ImageSegment* segment =
+            nitf_Record_getImageSegment(record, (nitf_Uint32) i, &error);
+        TEST_ASSERT(segment);
+        TEST_ASSERT_EQ_INT(getImageId(segment, &error), i);
+    }
+    TEST_ASSERT(nitf_Record_getTextSegment(record, 0, &error) == text);
+
+    TEST_ASSERT_NULL(nitf_Record_getImageSegment(record, NUM_IMAGES, &error));
+    TEST_ASSERT_NULL(nitf_Record_getTextSegment(record, 1, &error));
+    TEST_ASSERT_NULL(nitf_Record_getGraphicSegment(record, 0, &error));
+    TEST_ASSERT_NULL(nitf_Record_getLabelSegment(record, 0, &error));
+    TEST_ASSERT_NULL(nitf_Record_getDataExtensionSegment(record, 0, &error));
+    TEST_ASSERT_NULL(nitf_Record_getReservedExtensionSegment(record, 0,
+                                                             &error));
+
+    /* the accessors follow removals and moves */
+    TEST_ASSERT(nitf_Record_removeImageSegment(record, 10, &error));
+    TEST_ASSERT_EQ_INT(
+        getImageId(nitf_Record_getImageSegment(record, 10, &error), &error),
+        11);
+    TEST_ASSERT(nitf_Record_moveImageSegment(record, 0, 5, &error));
+    TEST_ASSERT_EQ_INT(
+        getImageId(nitf_Record_getImageSegment(record, 0, &error), &error),
+        1);
+    TEST_ASSERT_EQ_INT(
+        getImageId(nitf_Record_getImageSegment(record, 5, &error), &error),
+        0);
+    TEST_ASSERT_NULL(nitf_Record_getImageSegment(record, NUM_IMAGES - 1,
+                                                 &error));
+
+    nitf_Record_destruct(&record);
+}
+
+TEST_CASE(testCloneAndDirectEdits)
+{
+    nitf_Error error;
+    nitf_Record* record = nitf_Record_construct(NITF_VER_21, &error);
+    nitf_Record* clone;
+    nitf_ImageSegment* extra;
+    int i;
+
+    TEST_ASSERT(record);
+    for (i = 0; i < 5; ++i)
+    {
+        nitf_ImageSegment* segment = nitf_Record_newImageSegment(record,
+                                                                 &error);
+        TEST_ASSERT(segment);
+        setImageId(segment, i, &error);
+    }
+
+    /* a clone has its own index, of its own segments */
+    clone = nitf_Record_clone(record, &error);
+    TEST_ASSERT(clone);
+    for (i = 0; i < 5; ++i)
+    {
+        nitf_ImageSegment* segment =
+            nitf_Record_getImageSegment(clone, (nitf_Uint32) i, &error);
+        TEST_ASSERT(segment);
+        TEST_ASSERT(segment !=
+                    nitf_Record_getImageSegment(record, (nitf_Uint32) i,
+                                                &error));
+        TEST_ASSERT_EQ_INT(getImageId(segment, &error), i);
+    }
+    nitf_Record_destruct(&clone);
+
+    /* a list changed behind the record's back is walked instead */
+    extra = nitf_ImageSegment_construct(&error);
+    TEST_ASSERT(extra);
+    setImageId(extra, 99, &error);
+    TEST_ASSERT(nitf_List_pushFront(record->images, extra, &error));
+    TEST_ASSERT(nitf_Record_getImageSegment(record, 0, &error) == extra);
+    TEST_ASSERT_EQ_INT(
+        getImageId(nitf_Record_getImageSegment(record, 5, &error), &error),
+        4);
+    TEST_ASSERT(nitf_List_popFront(record->images) == extra);
+    nitf_ImageSegment_destruct(&extra);
+    TEST_ASSERT_EQ_INT(
+        getImageId(nitf_Record_getImageSegment(record, 4, &error), &error),
+        4);
+
+    nitf_Record_destruct(&record);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testGetSegments);
+    CHECK(testCloneAndDirectEdits);
+    return 0;
+}
@@ -0,0 +1,221 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+#define TEMPLATE_DATA "from the template"
+#define CHANGED_DATA "changed in the product"
+#define HELD_DATA "held then changed"
+#define NUM_CLONES 3
+#define NUM_THREADS 8
+#define CLONES_PER_THREAD 50
+
+/* One thread's share of the clones of a template */
+typedef struct _CloneRun
+{
+    nitf_Record* source;
+    nitf_Record* clones[CLONES_PER_THREAD];
+} CloneRun;
+
+static nitf_Record* makeTemplate(nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+
+    if (!record)
+        return NULL;
+    if (!addTRE(record->header->userDefinedSection, "ZZSHRD", TEMPLATE_DATA,
+                error))
+        nitf_Record_destruct(&record);
+    return record;
+}
+
+static NITF_BOOL hasData(nitf_TRE* tre, const char* data)
+{
+    nitf_Field* field = nitf_TRE_getField(tre, NITF_TRE_RAW);
+    return field && field->length == strlen(data) &&
+           memcmp(field->raw, data, field->length) == 0;
+}
+
+TEST_CASE(testCloneSharesUntilChanged)
+{
+    nitf_Error error;
+    nitf_Record* source = makeTemplate(&error);
+    nitf_Record* clone;
+    nitf_TRE* tre;
+
+    TEST_ASSERT(source);
+    clone = nitf_Record_clone(source, &error);
+    TEST_ASSERT(clone);
+    TEST_ASSERT(nitf_SharedTRE_isShared(getTRE(source, "ZZSHRD")));
+    TEST_ASSERT(nitf_SharedTRE_isShared(getTRE(clone, "ZZSHRD")));
+
+    /* writing does not need a copy */
+    TEST_ASSERT(sameOutput(source, clone, &error));
+    TEST_ASSERT(nitf_SharedTRE_isShared(getTRE(clone, "ZZSHRD")));
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(getTRE(clone, "ZZSHRD"),
+                                               &error),
+                       (int)strlen(TEMPLATE_DATA));
+
+    /* a change to the clone is not seen in the source */
+    tre = getTRE(clone, "ZZSHRD");
+    TEST_ASSERT(nitf_TRE_setField(tre, NITF_TRE_RAW,
+                                  (NITF_DATA*)CHANGED_DATA,
+                                  strlen(CHANGED_DATA), &error));
+    TEST_ASSERT(!nitf_SharedTRE_isShared(tre));
+    TEST_ASSERT(hasData(tre, CHANGED_DATA));
+    TEST_ASSERT(hasData(getTRE(source, "ZZSHRD"), TEMPLATE_DATA));
+    TEST_ASSERT(!nitf_SharedTRE_isShared(getTRE(source, "ZZSHRD")));
+    TEST_ASSERT(!sameOutput(source, clone, &error));
+
+    nitf_Record_destruct(&clone);
+    nitf_Record_destruct(&source);
+}
+
+TEST_CASE(testClonesOutliveTheSource)
+{
+    nitf_Error error;
+    nitf_Record* source = makeTemplate(&error);
+    nitf_Record* clones[NUM_CLONES];
+    int i;
+
+    TEST_ASSERT(source);
+    for (i = 0; i < NUM_CLONES; ++i)
+    {
+        clones[i] = nitf_Record_clone(source, &error);
+        TEST_ASSERT(clones[i]);
+    }
+
+    /* a change to the source is not seen in the clones either */
+    TEST_ASSERT(nitf_TRE_setField(getTRE(source, "ZZSHRD"), NITF_TRE_RAW,
+                                  (NITF_DATA*)CHANGED_DATA,
+                                  strlen(CHANGED_DATA), &error));
+    nitf_Record_destruct(&source);
+
+    TEST_ASSERT(sameOutput(clones[0], clones[1], &error));
+    TEST_ASSERT(hasData(getTRE(clones[0], "ZZSHRD"), TEMPLATE_DATA));
+    TEST_ASSERT(!nitf_SharedTRE_isShared(getTRE(clones[0], "ZZSHRD")));
+    TEST_ASSERT(nitf_SharedTRE_isShared(getTRE(clones[1], "ZZSHRD")));
+
+    /* a clone of a clone shares the same contents */
+    source = nitf_Record_clone(clones[2], &error);
+    TEST_ASSERT(source);
+    TEST_ASSERT(hasData(getTRE(source, "ZZSHRD"), TEMPLATE_DATA));
+
+    for (i = 0; i < NUM_CLONES; ++i)
+    {
+        TEST_ASSERT(hasData(getTRE(clones[i], "ZZSHRD"), TEMPLATE_DATA));
+        nitf_Record_destruct(&clones[i]);
+    }
+    nitf_Record_destruct(&source);
+}
+
+TEST_CASE(testFieldHeldAcrossClone)
+{
+    nitf_Error error;
+    nitf_Record* source = makeTemplate(&error);
+    nitf_Record* clone;
+    nitf_Field* field;
+
+    TEST_ASSERT(source);
+    field = nitf_TRE_getField(getTRE(source, "ZZSHRD"), NITF_TRE_RAW);
+    TEST_ASSERT(field);
+    clone = nitf_Record_clone(source, &error);
+    TEST_ASSERT(clone);
+
+    /* a field handed out before the clone stays the source's alone */
+    TEST_ASSERT(!nitf_SharedTRE_isShared(getTRE(source, "ZZSHRD")));
+    TEST_ASSERT(nitf_Field_setRawData(field, (NITF_DATA*)HELD_DATA,
+                                      strlen(HELD_DATA), &error));
+    TEST_ASSERT(hasData(getTRE(source, "ZZSHRD"), HELD_DATA));
+    TEST_ASSERT(hasData(getTRE(clone, "ZZSHRD"), TEMPLATE_DATA));
+
+    nitf_Record_destruct(&clone);
+    nitf_Record_destruct(&source);
+}
+
+static void cloneMany(NITF_DATA* data)
+{
+    CloneRun* run = (CloneRun*)data;
+    nitf_Error error;
+    int i;
+
+    for (i = 0; i < CLONES_PER_THREAD; ++i)
+        run->clones[i] = nitf_Record_clone(run->source, &error);
+}
+
+TEST_CASE(testConcurrentClones)
+{
+    nitf_Error error;
+    nitf_Record* source = makeTemplate(&error);
+    nitf_Thread threads[NUM_THREADS];
+    CloneRun runs[NUM_THREADS];
+    int started[NUM_THREADS];
+    int i, j;
+
+    /* the first clones race to share the template's contents */
+    TEST_ASSERT(source);
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        runs[i].source = source;
+        started[i] = nitf_Thread_start(&threads[i], cloneMany, &runs[i],
+                                       &error);
+    }
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        if (started[i])
+            nitf_Thread_join(&threads[i]);
+        else
+            cloneMany(&runs[i]);
+    }
+
+    TEST_ASSERT(nitf_SharedTRE_isShared(getTRE(source, "ZZSHRD")));
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        for (j = 0; j < CLONES_PER_THREAD; ++j)
+        {
+            nitf_TRE* tre;
+
+            TEST_ASSERT(runs[i].clones[j]);
+            tre = getTRE(runs[i].clones[j], "ZZSHRD");
+            TEST_ASSERT(nitf_SharedTRE_isShared(tre));
+            TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error),
+                               (int)strlen(TEMPLATE_DATA));
+            nitf_Record_destruct(&runs[i].clones[j]);
+        }
+    }
+    TEST_ASSERT(hasData(getTRE(source, "ZZSHRD"), TEMPLATE_DATA));
+    nitf_Record_destruct(&source);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testCloneSharesUntilChanged);
+    CHECK(testClonesOutliveTheSource);
+    CHECK(testFieldHeldAcrossClone);
+    CHECK(testConcurrentClones);
+    return 0;
+}
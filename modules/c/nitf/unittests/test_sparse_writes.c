@@ -0,0 +1,140 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+#define NUM_ROWS 100
+#define NUM_COLS 120
+#define BLOCK_SIZE 32
+
+/*
+ *  Writes the image through a stats adapter so the bytes that actually
+ *  reached the output can be counted.
+ */
+static nitf_IOInterface* writeImage(const char* imode,
+                                    const nitf_Uint8* pixels,
+                                    int caching, int sparse,
+                                    nitf_Uint64* bytesWritten,
+                                    nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+    nitf_IOInterface* output = nitf_GrowableBufferAdapter_construct(0, error);
+    nitf_IOInterface* io;
+    nitf_Writer* writer;
+    nitf_ImageWriter* imageWriter;
+    nitf_IOStats stats;
+    NITF_BOOL ok;
+
+    /* partial blocks in both directions, so the last blocks carry pad */
+    if (!record || !output ||
+        !addImage(record, NUM_ROWS, NUM_COLS, BLOCK_SIZE, BLOCK_SIZE, imode,
+                  1, error))
+        return NULL;
+    io = nitf_IOStatsAdapter_construct(output, 0, error);
+    writer = nitf_Writer_construct(error);
+    if (!io || !writer || !nitf_Writer_prepareIO(writer, record, io, error))
+        return NULL;
+
+    imageWriter = attachPixels(writer, 0, pixels, error);
+    if (!imageWriter)
+        return NULL;
+    nitf_ImageWriter_setWriteCaching(imageWriter, caching);
+    nitf_ImageWriter_setSparseWrites(imageWriter, sparse);
+
+    ok = nitf_Writer_write(writer, error);
+    nitf_IOStatsAdapter_getStats(io, NULL, &stats, error);
+    *bytesWritten = stats.ops[NITF_IO_STATS_WRITE].bytes;
+
+    nitf_Writer_destruct(&writer);
+    nitf_IOInterface_destruct(&io);
+    nitf_Record_destruct(&record);
+    if (!ok)
+        nitf_IOInterface_destruct(&output);
+    return output;
+}
+
+static void compareWrites(const char* testName, const char* imode,
+                          int caching)
+{
+    nitf_Error error;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    nitf_IOInterface* dense;
+    nitf_IOInterface* sparse;
+    nitf_Uint64 denseBytes, sparseBytes;
+    size_t denseSize, sparseSize;
+    char* denseBuf;
+    char* sparseBuf;
+    int row, col;
+
+    /* only the top left block has data; everything after it is zero */
+    memset(pixels, 0, sizeof(pixels));
+    for (row = 0; row < BLOCK_SIZE; ++row)
+        for (col = 0; col < BLOCK_SIZE; ++col)
+            pixels[row * NUM_COLS + col] = (nitf_Uint8)(1 + row + col);
+
+    dense = writeImage(imode, pixels, caching, 0, &denseBytes, &error);
+    TEST_ASSERT(dense);
+    sparse = writeImage(imode, pixels, caching, 1, &sparseBytes, &error);
+    TEST_ASSERT(sparse);
+
+    denseBuf = nitf_GrowableBufferAdapter_getBuffer(dense, &denseSize, &error);
+    sparseBuf = nitf_GrowableBufferAdapter_getBuffer(sparse, &sparseSize,
+                                                     &error);
+    TEST_ASSERT(denseBuf && sparseBuf);
+    TEST_ASSERT_EQ_INT((int)sparseSize, (int)denseSize);
+    TEST_ASSERT(memcmp(sparseBuf, denseBuf, denseSize) == 0);
+
+    /* at least the empty blocks were skipped, less the final byte */
+    TEST_ASSERT(sparseBytes + (NUM_ROWS * NUM_COLS - BLOCK_SIZE * BLOCK_SIZE)
+                <= denseBytes + 1);
+
+    nitf_IOInterface_destruct(&dense);
+    nitf_IOInterface_destruct(&sparse);
+}
+
+TEST_CASE(testSparseUncached)
+{
+    compareWrites(testName, "B", 0);
+}
+
+TEST_CASE(testSparseCached)
+{
+    compareWrites(testName, "B", 1);
+}
+
+TEST_CASE(testSparseBandSequential)
+{
+    compareWrites(testName, "S", 0);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testSparseUncached);
+    CHECK(testSparseCached);
+    CHECK(testSparseBandSequential);
+    return 0;
+}
@@ -0,0 +1,198 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#define NUM_ROWS 4
+#define NUM_COLS 4
+
+/*
+ *  Writes two images, each with two comments, corners and two bands, the
+ *  first of which has a lookup table, and for 2.1 a graphic.  Everything
+ *  but the variable-length pieces is read back in runs.
+ */
+static nitf_IOInterface* writeFile(nitf_Version version, nitf_Error* error)
+{
+    nitf_Record* record = nitf_Record_construct(version, error);
+    nitf_Writer* writer = nitf_Writer_construct(error);
+    nitf_IOInterface* io = nitf_GrowableBufferAdapter_construct(0, error);
+    double corners[4][2] = { { 1, 2 }, { 1, 3 }, { 2, 3 }, { 2, 2 } };
+    static const char graphic[64];
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    NITF_BOOL ok = NITF_FAILURE;
+    int i, j;
+
+    memset(pixels, 7, sizeof(pixels));
+    for (i = 0; i < 2; i++)
+    {
+        nitf_ImageSegment* image = nitf_Record_newImageSegment(record, error);
+        nitf_BandInfo** bands =
+            (nitf_BandInfo**)NITF_MALLOC(sizeof(nitf_BandInfo*) * 2);
+        nitf_LookupTable* lut = nitf_LookupTable_construct(1, 4, error);
+
+        for (j = 0; j < 4; j++)
+            lut->table[j] = (nitf_Uint8)(j + i);
+        bands[0] = nitf_BandInfo_construct(error);
+        bands[1] = nitf_BandInfo_construct(error);
+        nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 1, 4, lut, error);
+        nitf_BandInfo_init(bands[1], "M", " ", "N", "   ", 0, 0, NULL, error);
+        nitf_ImageSubheader_setPixelInformation(image->subheader, "INT", 8, 8,
+                                                "R", "MONO", "VIS", 2, bands,
+                                                error);
+        nitf_ImageSubheader_setBlocking(image->subheader, NUM_ROWS, NUM_COLS,
+                                        NUM_ROWS, NUM_COLS, "B", error);
+        nitf_ImageSubheader_setCornersFromLatLons(image->subheader,
+                                                  NITF_CORNERS_GEO, corners,
+                                                  error);
+        nitf_ImageSubheader_insertImageComment(image->subheader, "first",
+                                               0, error);
+        nitf_ImageSubheader_insertImageComment(image->subheader, "second",
+                                               1, error);
+        nitf_Field_setString(image->subheader->NITF_IID1,
+                             i ? "IMAGE1" : "IMAGE0", error);
+    }
+    if (version == NITF_VER_21)
+    {
+        nitf_GraphicSegment* segment =
+            nitf_Record_newGraphicSegment(record, error);
+        nitf_Field_setString(segment->subheader->NITF_SID, "GRAPHIC", error);
+    }
+    /* 2.0 has no FBKGC, and ONAME takes its place, as the reader has it */
+    if (version == NITF_VER_20)
+        nitf_Field_resetLength(record->header->NITF_ONAME,
+                               NITF_FBKGC_SZ + NITF_ONAME_SZ, 0, error);
+    nitf_Field_setString(record->header->NITF_ONAME, "originator", error);
+    nitf_Field_setString(record->header->NITF_FTITLE, "runs", error);
+
+    if (nitf_Writer_prepareIO(writer, record, io, error))
+    {
+        ok = NITF_SUCCESS;
+        for (i = 0; i < 2 && ok; i++)
+        {
+            nitf_ImageWriter* imageWriter =
+                nitf_Writer_newImageWriter(writer, i, NULL, error);
+            nitf_ImageSource* imageSource = nitf_ImageSource_construct(error);
+            for (j = 0; j < 2; j++)
+                nitf_ImageSource_addBand(imageSource,
+                                         nitf_MemorySource_construct(
+                                             pixels, sizeof(pixels), 0, 1,
+                                             0, error),
+                                         error);
+            ok = nitf_ImageWriter_attachSource(imageWriter, imageSource,
+                                               error);
+        }
+        if (ok && version == NITF_VER_21)
+        {
+            nitf_SegmentWriter* segmentWriter =
+                nitf_Writer_newGraphicWriter(writer, 0, error);
+            ok = nitf_SegmentWriter_attachSource(
+                     segmentWriter,
+                     nitf_SegmentMemorySource_construct(
+                         graphic, sizeof(graphic), 0, 0, 0, error),
+                     error);
+        }
+        ok = ok && nitf_Writer_write(writer, error);
+    }
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+    if (!ok || !NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                                      error)))
+        nitf_IOInterface_destruct(&io);
+    return io;
+}
+
+static int checkRecord(nitf_Version version)
+{
+    nitf_Error error;
+    nitf_IOInterface* io = writeFile(version, &error);
+    nitf_Reader* reader = nitf_Reader_construct(&error);
+    nitf_Record* record;
+    nitf_Uint32 i;
+    int ok;
+
+    if (!io)
+        return 0;
+    record = nitf_Reader_readIO(reader, io, &error);
+    ok = record != NULL;
+    if (ok)
+    {
+        nitf_FileHeader* header = record->header;
+        ok = nitf_Record_getVersion(record) == version &&
+             strncmp(header->NITF_FTITLE->raw, "runs", 4) == 0 &&
+             strstr(header->NITF_ONAME->raw, "originator") != NULL &&
+             nitf_Record_getNumImages(record, &error) == 2 &&
+             nitf_Record_getNumGraphics(record, &error) ==
+                 (version == NITF_VER_21 ? 1u : 0u);
+        for (i = 0; ok && i < 2; i++)
+        {
+            nitf_ImageSegment* image =
+                nitf_Record_getImageSegment(record, i, &error);
+            nitf_ImageSubheader* subhdr = image->subheader;
+            nitf_Field* comment = (nitf_Field*)nitf_List_get(
+                                      subhdr->imageComments, 1, &error);
+            nitf_BandInfo* band = subhdr->bandInfo[0];
+
+            ok = subhdr->NITF_IID1->raw[5] == (char)('0' + i) &&
+                 subhdr->NITF_ICORDS->raw[0] == 'G' &&
+                 strncmp(subhdr->NITF_IGEOLO->raw, "01", 2) == 0 &&
+                 nitf_List_size(subhdr->imageComments) == 2 &&
+                 strncmp(comment->raw, "second", 6) == 0 &&
+                 strncmp(subhdr->NITF_IC->raw, "NC", 2) == 0 &&
+                 subhdr->NITF_NBANDS->raw[0] == '2' &&
+                 band->lut && band->lut->table[3] == 3 + i &&
+                 subhdr->bandInfo[1]->lut == NULL &&
+                 subhdr->NITF_IMODE->raw[0] == 'B' &&
+                 strncmp(subhdr->NITF_NPPBV->raw, "0004", 4) == 0 &&
+                 strncmp(subhdr->NITF_IMAG->raw, "1.0", 3) == 0;
+        }
+        if (ok && version == NITF_VER_21)
+        {
+            nitf_GraphicSegment* segment =
+                nitf_Record_getGraphicSegment(record, 0, &error);
+            ok = strncmp(segment->subheader->NITF_SID->raw, "GRAPHIC", 7) == 0;
+        }
+        nitf_Record_destruct(&record);
+    }
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+    return ok;
+}
+
+TEST_CASE(testRoundTrip21)
+{
+    TEST_ASSERT(checkRecord(NITF_VER_21));
+}
+
+TEST_CASE(testRoundTrip20)
+{
+    TEST_ASSERT(checkRecord(NITF_VER_20));
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testRoundTrip21);
+    CHECK(testRoundTrip20);
+    return 0;
+}
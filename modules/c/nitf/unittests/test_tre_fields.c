@@ -0,0 +1,282 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <import/nitf.h>
+#include "Test.h"
+
+static nitf_TREDescription fieldDescription[] =
+{
+    {NITF_BCS_N, 3, "Count", "COUNT"},
+    {NITF_LOOP, 0, NULL, "COUNT"},
+        {NITF_BCS_A, 2, "Name", "NAME"},
+        {NITF_BCS_N, 1, "Value", "VALUE"},
+    {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_END, 0, NULL, NULL}
+};
+
+static nitf_TREDescriptionInfo fieldDescriptions[] =
+{
+    {"ZZFLDS", fieldDescription, NITF_TRE_DESC_NO_LENGTH},
+    {NULL, NULL, NITF_TRE_DESC_NO_LENGTH}
+};
+
+static nitf_TREDescriptionSet fieldDescriptionSet = {0, fieldDescriptions};
+
+static nitf_TREHandler fieldHandler;
+
+/* enough loop items to spread the fields over several blocks */
+#define NUM_ITEMS 150
+
+static nitf_TREDescription arrayDescription[] =
+{
+    {NITF_BCS_N, 1, "Rows", "ROWS"},
+    {NITF_LOOP, 0, NULL, "ROWS"},
+        {NITF_BCS_N, 1, "Columns", "COLS"},
+        {NITF_LOOP, 0, NULL, "COLS"},
+            {NITF_BCS_A, 10, "Coefficient", "COEF"},
+        {NITF_ENDLOOP, 0, NULL, NULL},
+        {NITF_BCS_N, 3, "Offset", "OFFSET"},
+    {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_END, 0, NULL, NULL}
+};
+
+static nitf_TREDescriptionInfo arrayDescriptions[] =
+{
+    {"ZZFLDS", arrayDescription, NITF_TRE_DESC_NO_LENGTH},
+    {NULL, NULL, NITF_TRE_DESC_NO_LENGTH}
+};
+
+static nitf_TREDescriptionSet arrayDescriptionSet = {0, arrayDescriptions};
+
+static nitf_TREHandler arrayHandler;
+
+static nitf_TRE* readData(nitf_TREDescriptionSet* set,
+                          nitf_TREHandler* handler, const char* data,
+                          nitf_Error* error)
+{
+    nitf_IOInterface* io;
+    nitf_TRE* tre;
+    NITF_BOOL ok;
+
+    io = nitf_BufferAdapter_construct((char*)data, strlen(data), 0, error);
+    tre = nitf_TRE_createSkeleton("ZZFLDS", error);
+    ok = io && tre;
+    if (ok)
+    {
+        tre->handler = nitf_TREUtils_createBasicHandler(set, handler, error);
+        ok = tre->handler->read(io, (nitf_Uint32)strlen(data), tre, NULL,
+                                error);
+    }
+    if (io)
+        nitf_IOInterface_destruct(&io);
+    if (!ok && tre)
+        nitf_TRE_destruct(&tre);
+    return tre;
+}
+
+static nitf_TRE* readTRE(nitf_Error* error)
+{
+    static char data[3 + NUM_ITEMS * 3 + 1];
+    int i;
+
+    NITF_SNPRINTF(data, sizeof(data), "%03d", NUM_ITEMS);
+    for (i = 0; i < NUM_ITEMS; ++i)
+    {
+        data[3 + i * 3] = (char)('A' + i % 26);
+        data[4 + i * 3] = (char)('A' + i / 26);
+        data[5 + i * 3] = (char)('0' + i % 10);
+    }
+    return readData(&fieldDescriptionSet, &fieldHandler, data, error);
+}
+
+TEST_CASE(testFieldsAreStoredInOrder)
+{
+    nitf_Error error;
+    nitf_TRE* tre = readTRE(&error);
+    nitf_TREPrivateData* priv;
+    nitf_Pair* pair;
+    nitf_List* found;
+
+    TEST_ASSERT(tre);
+    priv = (nitf_TREPrivateData*)tre->priv;
+    TEST_ASSERT_EQ_INT(nitf_TREPrivateData_getNumFields(priv),
+                       1 + NUM_ITEMS * 2);
+
+    pair = nitf_TREPrivateData_getPair(priv, 0);
+    TEST_ASSERT_EQ_STR(pair->key, "COUNT");
+    pair = nitf_TREPrivateData_getPair(priv, 1 + 140 * 2);
+    TEST_ASSERT_EQ_STR(pair->key, "NAME[140]");
+    TEST_ASSERT(pair == nitf_TREPrivateData_find(priv, "NAME[140]"));
+    TEST_ASSERT(pair == nitf_TREPrivateData_findAt(priv, 0, "NAME[140]"));
+    TEST_ASSERT_NULL(nitf_TREPrivateData_find(priv, "NAME[150]"));
+    TEST_ASSERT_NULL(nitf_TREPrivateData_getPair(priv, 1 + NUM_ITEMS * 2));
+
+    /* find reports the fields in description order */
+    found = nitf_TRE_find(tre, "VALUE", &error);
+    TEST_ASSERT(found);
+    TEST_ASSERT_EQ_INT(nitf_List_size(found), NUM_ITEMS);
+    pair = (nitf_Pair*)nitf_List_popFront(found);
+    TEST_ASSERT_EQ_STR(pair->key, "VALUE[0]");
+    pair = (nitf_Pair*)nitf_List_popFront(found);
+    TEST_ASSERT_EQ_STR(pair->key, "VALUE[1]");
+
+    /* the pairs belong to the TRE */
+    while (!nitf_List_isEmpty(found))
+        nitf_List_popFront(found);
+    nitf_List_destruct(&found);
+
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error),
+                       3 + NUM_ITEMS * 3);
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testHashIsAView)
+{
+    nitf_Error error;
+    nitf_TRE* tre = readTRE(&error);
+    nitf_TREPrivateData* priv;
+    nitf_HashTable* hash;
+    nitf_Field* field;
+
+    TEST_ASSERT(tre);
+    priv = (nitf_TREPrivateData*)tre->priv;
+    TEST_ASSERT_NULL(priv->hash);
+
+    hash = nitf_TREPrivateData_getHash(priv, &error);
+    TEST_ASSERT(hash);
+    TEST_ASSERT(hash == nitf_TREPrivateData_getHash(priv, &error));
+    TEST_ASSERT(nitf_HashTable_find(hash, "NAME[7]") ==
+                nitf_TREPrivateData_find(priv, "NAME[7]"));
+
+    /* fields added later show up in the view too */
+    field = nitf_Field_construct(1, NITF_BCS_A, &error);
+    TEST_ASSERT(field);
+    TEST_ASSERT(nitf_TREPrivateData_insert(priv, "EXTRA", field, &error));
+    TEST_ASSERT(nitf_HashTable_find(hash, "EXTRA") ==
+                nitf_TREPrivateData_find(priv, "EXTRA"));
+
+    /* a repeated name still finds the first one */
+    field = nitf_Field_construct(1, NITF_BCS_A, &error);
+    TEST_ASSERT(field);
+    TEST_ASSERT(nitf_TREPrivateData_insert(priv, "COUNT", field, &error));
+    TEST_ASSERT(nitf_TREPrivateData_find(priv, "COUNT") ==
+                nitf_TREPrivateData_getPair(priv, 0));
+    TEST_ASSERT(nitf_HashTable_find(hash, "COUNT") ==
+                nitf_TREPrivateData_getPair(priv, 0));
+
+    TEST_ASSERT(nitf_TREPrivateData_flush(priv, &error));
+    TEST_ASSERT_NULL(priv->hash);
+    TEST_ASSERT_EQ_INT(nitf_TREPrivateData_getNumFields(priv), 0);
+    TEST_ASSERT_NULL(nitf_TREPrivateData_find(priv, "COUNT"));
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testCloneAndSetField)
+{
+    nitf_Error error;
+    nitf_TRE* tre = readTRE(&error);
+    nitf_TRE* clone;
+    nitf_Field* field;
+    char value[3];
+
+    TEST_ASSERT(tre);
+    clone = nitf_TRE_clone(tre, &error);
+    TEST_ASSERT(clone);
+
+    /* setting a field gives the clone its own copy of the fields */
+    TEST_ASSERT(nitf_TRE_setField(clone, "NAME[3]", "ZZ", 2, &error));
+    TEST_ASSERT_EQ_INT(
+        nitf_TREPrivateData_getNumFields((nitf_TREPrivateData*)clone->priv),
+        1 + NUM_ITEMS * 2);
+    field = nitf_TRE_getField(clone, "NAME[3]");
+    TEST_ASSERT(field);
+    memcpy(value, field->raw, 2);
+    value[2] = 0;
+    TEST_ASSERT_EQ_STR(value, "ZZ");
+
+    /* the original is untouched */
+    field = nitf_TRE_getField(tre, "NAME[3]");
+    TEST_ASSERT(field);
+    memcpy(value, field->raw, 2);
+    TEST_ASSERT_EQ_STR(value, "DA");
+
+    nitf_TRE_destruct(&clone);
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testArrays)
+{
+    nitf_Error error;
+    nitf_TRE* tre = readData(&arrayDescriptionSet, &arrayHandler,
+                             "22+1.500E+00-2.250E-010071  3.5e2   -12",
+                             &error);
+    nitf_TRE* clone;
+    double reals[3] = {0, 0, -1};
+    nitf_Int64 ints[2];
+    size_t count;
+
+    TEST_ASSERT(tre);
+
+    /* values come back in description order, across the nested loops */
+    TEST_ASSERT(nitf_TREUtils_getReal64Array(tre, "COEF", reals, 3, &count,
+                                             &error));
+    TEST_ASSERT_EQ_INT((int)count, 3);
+    TEST_ASSERT(reals[0] == 1.5);
+    TEST_ASSERT(reals[1] == -0.225);
+    TEST_ASSERT(reals[2] == 350);
+    TEST_ASSERT(nitf_TREUtils_getInt64Array(tre, "OFFSET", ints, 2, &count,
+                                            &error));
+    TEST_ASSERT_EQ_INT((int)count, 2);
+    TEST_ASSERT(ints[0] == 7);
+    TEST_ASSERT(ints[1] == -12);
+
+    /* the count is the whole loop, even past the room given */
+    reals[1] = reals[2] = -1;
+    TEST_ASSERT(nitf_TREUtils_getReal64Array(tre, "COEF", reals, 1, &count,
+                                             &error));
+    TEST_ASSERT_EQ_INT((int)count, 3);
+    TEST_ASSERT(reals[1] == -1);
+    TEST_ASSERT(nitf_TREUtils_getReal64Array(tre, "NONE", NULL, 0, &count,
+                                             &error));
+    TEST_ASSERT_EQ_INT((int)count, 0);
+
+    /* reading a clone leaves the contents shared */
+    clone = nitf_TRE_clone(tre, &error);
+    TEST_ASSERT(clone);
+    TEST_ASSERT(nitf_TREUtils_getInt64Array(clone, "OFFSET", ints, 2,
+                                            &count, &error));
+    TEST_ASSERT(ints[1] == -12);
+    TEST_ASSERT(nitf_SharedTRE_isShared(clone));
+
+    nitf_TRE_destruct(&clone);
+    nitf_TRE_destruct(&tre);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testFieldsAreStoredInOrder);
+    CHECK(testHashIsAView);
+    CHECK(testCloneAndSetField);
+    CHECK(testArrays);
+    return 0;
+}
@@ -0,0 +1,243 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <import/nitf.h>
+#include <nitf/TREPlan.h>
+#include "Test.h"
+
+static nitf_TREDescription planDescription[] =
+{
+    {NITF_BCS_N, 2, "Count", "COUNT"},
+    {NITF_LOOP, 0, NULL, "COUNT"},
+        {NITF_BCS_A, 3, "Name", "NAME"},
+        {NITF_BCS_N, 1, "Flag", "FLAG"},
+        {NITF_IF, 0, "== 1", "FLAG"},
+            {NITF_BCS_A, 2, "Extra", "EXTRA"},
+        {NITF_ENDIF, 0, NULL, NULL},
+    {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_BCS_A, 4, "Kind", "KIND"},
+    {NITF_IF, 0, "eq ABCD", "KIND"},
+        {NITF_LOOP, 0, NITF_CONST_N, "2"},
+            {NITF_BCS_N, 1, "Digit", "DIGIT"},
+        {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_ENDIF, 0, NULL, NULL},
+    {NITF_LOOP, 0, "- 1", "COUNT"},
+        {NITF_BCS_A, 1, "Tail", "TAIL"},
+    {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_END, 0, NULL, NULL}
+};
+
+static nitf_TREDescriptionInfo planDescriptions[] =
+{
+    {"ZZPLAN", planDescription, NITF_TRE_DESC_NO_LENGTH},
+    {NULL, NULL, NITF_TRE_DESC_NO_LENGTH}
+};
+
+static nitf_TREDescriptionSet planDescriptionSet = {0, planDescriptions};
+
+static nitf_TREDescription lengthDescription[] =
+{
+    {NITF_BCS_N, 1, "Length", "LEN"},
+    {NITF_LOOP, 0, NITF_CONST_N, "2"},
+        {NITF_BCS_N, 1, "Size", "SIZE"},
+        {NITF_BCS_A, NITF_TRE_CONDITIONAL_LENGTH, "Value", "VALUE",
+                "SIZE LEN +"},
+        {NITF_BCS_A, NITF_TRE_CONDITIONAL_LENGTH, "Rest", "REST",
+                "SIZE 1 -"},
+    {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_END, 0, NULL, NULL}
+};
+
+static nitf_TREDescriptionInfo lengthDescriptions[] =
+{
+    {"ZZPLAN", lengthDescription, NITF_TRE_DESC_NO_LENGTH},
+    {NULL, NULL, NITF_TRE_DESC_NO_LENGTH}
+};
+
+static nitf_TREDescriptionSet lengthDescriptionSet = {0, lengthDescriptions};
+
+static nitf_TREHandler planHandler;
+
+static nitf_TRE* readTRE(nitf_TREDescriptionSet* set, const char* data,
+                         nitf_Error* error)
+{
+    nitf_IOInterface* io = nitf_BufferAdapter_construct((char*)data,
+                                                        strlen(data), 0,
+                                                        error);
+    nitf_TRE* tre = nitf_TRE_createSkeleton("ZZPLAN", error);
+    NITF_BOOL ok = io && tre;
+
+    if (ok)
+    {
+        tre->handler = nitf_TREUtils_createBasicHandler(set, &planHandler,
+                                                        error);
+        ok = tre->handler->read(io, (nitf_Uint32)strlen(data), tre, NULL,
+                                error);
+    }
+    if (io)
+        nitf_IOInterface_destruct(&io);
+    if (!ok && tre)
+        nitf_TRE_destruct(&tre);
+    return tre;
+}
+
+static NITF_BOOL hasValue(nitf_TRE* tre, const char* tag, const char* value)
+{
+    nitf_Field* field = nitf_TRE_getField(tre, tag);
+    return field && field->length == strlen(value) &&
+           memcmp(field->raw, value, field->length) == 0;
+}
+
+TEST_CASE(testLoopsAndConditions)
+{
+    nitf_Error error;
+    const char data[] = "03AAA1xxBBB0CCC1yyABCD12tt";
+    nitf_TRE* tre = readTRE(&planDescriptionSet, data, &error);
+
+    TEST_ASSERT(tre);
+    TEST_ASSERT(hasValue(tre, "NAME[1]", "BBB"));
+    TEST_ASSERT(hasValue(tre, "EXTRA[0]", "xx"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "EXTRA[1]"));
+    TEST_ASSERT(hasValue(tre, "EXTRA[2]", "yy"));
+    TEST_ASSERT(hasValue(tre, "DIGIT[1]", "2"));
+    TEST_ASSERT(hasValue(tre, "TAIL[1]", "t"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "TAIL[2]"));
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error),
+                       (int)strlen(data));
+    nitf_TRE_destruct(&tre);
+
+    /* the other way around each condition */
+    tre = readTRE(&planDescriptionSet, "01DDD0WXYZ", &error);
+    TEST_ASSERT(tre);
+    TEST_ASSERT(hasValue(tre, "NAME[0]", "DDD"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "EXTRA[0]"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "DIGIT[0]"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "TAIL[0]"));
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error), 10);
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testConditionalLengths)
+{
+    nitf_Error error;
+    nitf_TRE* tre = readTRE(&lengthDescriptionSet, "12abcd1ef", &error);
+    const nitf_TREPlan* plan;
+
+    TEST_ASSERT(tre);
+    TEST_ASSERT(hasValue(tre, "VALUE[0]", "abc"));
+    TEST_ASSERT(hasValue(tre, "REST[0]", "d"));
+    TEST_ASSERT(hasValue(tre, "VALUE[1]", "ef"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "REST[1]"));
+    nitf_TRE_destruct(&tre);
+
+    /* the expressions were split up front */
+    plan = nitf_TREPlan_get(&planHandler, lengthDescription);
+    TEST_ASSERT(plan);
+    TEST_ASSERT_EQ_INT(plan->steps[3].numTerms, 3);
+    TEST_ASSERT_EQ_INT(plan->steps[3].depth, 2);
+    TEST_ASSERT_EQ_STR(plan->steps[3].terms[1].ref.tag, "LEN");
+    TEST_ASSERT_EQ_INT(plan->steps[4].terms[1].value, 1);
+    TEST_ASSERT_EQ_INT(plan->steps[4].terms[2].op, '-');
+}
+
+TEST_CASE(testPlansAreReused)
+{
+    nitf_Error error;
+    nitf_TREHandler otherHandler;
+    const nitf_TREPlan* plan;
+
+    /* plans are built when the handler is */
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&planDescriptionSet,
+                                                 &planHandler, &error));
+    plan = nitf_TREPlan_get(&planHandler, planDescription);
+    TEST_ASSERT(plan);
+    TEST_ASSERT(plan == nitf_TREPlan_get(&planHandler, planDescription));
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&planDescriptionSet,
+                                                 &planHandler, &error));
+    TEST_ASSERT(plan == nitf_TREPlan_get(&planHandler, planDescription));
+    TEST_ASSERT_NULL(nitf_TREPlan_get(&otherHandler, planDescription));
+
+    TEST_ASSERT_EQ_INT(plan->numItems, 17);
+    TEST_ASSERT_EQ_INT(plan->steps[1].end, 7);
+    TEST_ASSERT_EQ_INT(plan->steps[9].end, 13);
+    TEST_ASSERT_EQ_INT(plan->steps[14].op, '-');
+    TEST_ASSERT_EQ_INT(plan->steps[14].operand, 1);
+}
+
+TEST_CASE(testChangedDescriptionsAreReplanned)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_TREDescription description[] =
+    {
+        {NITF_BCS_A, 3, "Name", "NAME"},
+        {NITF_END, 0, NULL, NULL}
+    };
+    nitf_TREDescriptionInfo infos[] =
+    {
+        {"ZZPLAN", NULL, NITF_TRE_DESC_NO_LENGTH},
+        {NULL, NULL, NITF_TRE_DESC_NO_LENGTH}
+    };
+    nitf_TREDescriptionSet set = {0, NULL};
+    const nitf_TREPlan* plan;
+
+    infos[0].description = description;
+    set.descriptions = infos;
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&set, &handler, &error));
+    plan = nitf_TREPlan_get(&handler, description);
+    TEST_ASSERT(plan);
+    TEST_ASSERT_EQ_INT(plan->steps[0].ref.length, 4);
+
+    /* what a description made at run time may do to its memory */
+    description[0].tag = "LONGNAME";
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&set, &handler, &error));
+    plan = nitf_TREPlan_get(&handler, description);
+    TEST_ASSERT(plan);
+    TEST_ASSERT_EQ_INT(plan->steps[0].ref.length, 8);
+}
+
+TEST_CASE(testUnregisteredDescriptions)
+{
+    nitf_Error error;
+    nitf_TRE* tre;
+
+    /* once the plans are gone, each walk builds its own */
+    nitf_TREPlan_unload();
+    TEST_ASSERT_NULL(nitf_TREPlan_get(&planHandler, planDescription));
+    tre = readTRE(&planDescriptionSet, "01DDD0WXYZ", &error);
+    TEST_ASSERT(tre);
+    nitf_TREPlan_unload();
+    TEST_ASSERT(hasValue(tre, "NAME[0]", "DDD"));
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error), 10);
+    nitf_TRE_destruct(&tre);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testLoopsAndConditions);
+    CHECK(testConditionalLengths);
+    CHECK(testPlansAreReused);
+    CHECK(testChangedDescriptionsAreReplanned);
+    CHECK(testUnregisteredDescriptions);
+    return 0;
+}
@@ -0,0 +1,371 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+#define NUM_ROWS 16
+#define NUM_COLS 16
+#define TEXT_DATA "Left exactly where it was"
+#define NEW_TEXT_DATA "Appended by a patch"
+#define OUT_SIZE 65536
+
+/*
+ *  Writes a file with one image, carrying a comment, and one text segment
+ *  to a buffer big enough to grow into.
+ */
+static nitf_IOInterface* makeFile(const nitf_Uint8* pixels, nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+    nitf_IOInterface* io;
+    nitf_Writer* writer;
+    nitf_ImageSegment* image;
+    NITF_BOOL ok;
+
+    char* buf = (char*)NITF_MALLOC(OUT_SIZE);
+    io = nitf_BufferAdapter_construct(buf, OUT_SIZE, 1, error);
+    if (!record || !io)
+        return NULL;
+
+    image = addImage(record, NUM_ROWS, NUM_COLS, NUM_ROWS, NUM_COLS, "B", 1,
+                     error);
+    if (!image)
+        return NULL;
+    nitf_ImageSubheader_insertImageComment(image->subheader, "Original", 0,
+                                           error);
+    nitf_Record_newTextSegment(record, error);
+
+    writer = nitf_Writer_construct(error);
+    ok = writer && nitf_Writer_prepareIO(writer, record, io, error) &&
+         attachPixels(writer, 0, pixels, error) &&
+         attachText(writer, 0, TEXT_DATA, error) &&
+         nitf_Writer_write(writer, error);
+    if (writer)
+        nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+    if (!ok)
+        nitf_IOInterface_destruct(&io);
+    return io;
+}
+
+static NITF_BOOL dataEquals(nitf_IOInterface* io, nitf_Uint64 offset,
+                            nitf_Uint64 end, const void* expected,
+                            size_t length, nitf_Error* error)
+{
+    char buf[NUM_ROWS * NUM_COLS];
+    if (end - offset != length || length > sizeof(buf))
+        return NITF_FAILURE;
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io, (nitf_Off)offset,
+                                               NITF_SEEK_SET, error)) ||
+        !nitf_IOInterface_read(io, buf, length, error))
+        return NITF_FAILURE;
+    return memcmp(buf, expected, length) == 0;
+}
+
+/*
+ *  Reads the file back and checks that the segment data survived the
+ *  patch untouched.
+ */
+static void checkFile(const char* testName, nitf_IOInterface* io,
+                      const nitf_Uint8* pixels, nitf_Record** record)
+{
+    nitf_Error error;
+    nitf_Reader* reader = nitf_Reader_construct(&error);
+    nitf_ImageSegment* image;
+    nitf_TextSegment* text;
+    nitf_ListIterator iter;
+    nitf_Uint64 fileLen;
+
+    TEST_ASSERT(reader);
+    TEST_ASSERT(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, &error) == 0);
+    *record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(*record);
+    nitf_Reader_destruct(&reader);
+
+    TEST_ASSERT(nitf_Field_get((*record)->header->fileLength, &fileLen,
+                               NITF_CONV_UINT, sizeof(fileLen), &error));
+    TEST_ASSERT_EQ_INT((int)fileLen,
+                       (int)nitf_IOInterface_getSize(io, &error));
+
+    iter = nitf_List_begin((*record)->images);
+    image = (nitf_ImageSegment*)nitf_ListIterator_get(&iter);
+    TEST_ASSERT(dataEquals(io, image->imageOffset, image->imageEnd, pixels,
+                           NUM_ROWS * NUM_COLS, &error));
+
+    iter = nitf_List_begin((*record)->texts);
+    text = (nitf_TextSegment*)nitf_ListIterator_get(&iter);
+    TEST_ASSERT(dataEquals(io, text->offset, text->end, TEXT_DATA,
+                           strlen(TEXT_DATA), &error));
+}
+
+static void makePixels(nitf_Uint8* pixels)
+{
+    size_t i;
+    for (i = 0; i < NUM_ROWS * NUM_COLS; ++i)
+        pixels[i] = (nitf_Uint8)(i * 7);
+}
+
+static nitf_Record* readFile(nitf_IOInterface* io, nitf_Error* error)
+{
+    nitf_Reader* reader;
+    nitf_Record* record;
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, error)))
+        return NULL;
+    reader = nitf_Reader_construct(error);
+    record = reader ? nitf_Reader_readIO(reader, io, error) : NULL;
+    nitf_Reader_destruct(&reader);
+    return record;
+}
+
+static NITF_BOOL patchFile(nitf_Record* record, nitf_IOInterface* io,
+                           nitf_Error* error)
+{
+    nitf_Writer* writer = nitf_Writer_construct(error);
+    NITF_BOOL ok = writer && nitf_Writer_prepareIO(writer, record, io, error) &&
+        nitf_Writer_patch(writer, error);
+    nitf_Writer_destruct(&writer);
+    return ok;
+}
+
+TEST_CASE(testPatchSameLength)
+{
+    nitf_Error error;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    nitf_IOInterface* io;
+    nitf_Record* record;
+    nitf_Off size;
+    char title[NITF_FTITLE_SZ + 1];
+
+    makePixels(pixels);
+    io = makeFile(pixels, &error);
+    TEST_ASSERT(io);
+    size = nitf_IOInterface_getSize(io, &error);
+
+    record = readFile(io, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(nitf_Field_setString(record->header->fileTitle,
+                                     "Patched in place", &error));
+    TEST_ASSERT(patchFile(record, io, &error));
+    nitf_Record_destruct(&record);
+
+    TEST_ASSERT_EQ_INT((int)nitf_IOInterface_getSize(io, &error), (int)size);
+    checkFile(testName, io, pixels, &record);
+    TEST_ASSERT(nitf_Field_get(record->header->fileTitle, title,
+                               NITF_CONV_STRING, sizeof(title), &error));
+    nitf_Field_trimString(title);
+    TEST_ASSERT(strcmp(title, "Patched in place") == 0);
+    nitf_Record_destruct(&record);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testPatchGrow)
+{
+    nitf_Error error;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    nitf_IOInterface* io;
+    nitf_Record* record;
+    nitf_ListIterator iter;
+    nitf_TextSegment* text;
+    nitf_ImageSegment* image;
+    nitf_SegmentWriter* textWriter;
+    nitf_Writer* writer;
+    NITF_BOOL ok;
+    nitf_Uint32 numTexts;
+
+    makePixels(pixels);
+    io = makeFile(pixels, &error);
+    TEST_ASSERT(io);
+
+    /* a longer image subheader moves the image, the new text goes last */
+    record = readFile(io, &error);
+    TEST_ASSERT(record);
+    iter = nitf_List_begin(record->images);
+    image = (nitf_ImageSegment*)nitf_ListIterator_get(&iter);
+    TEST_ASSERT(nitf_ImageSubheader_insertImageComment(image->subheader,
+                                                       "Added", 1,
+                                                       &error) == 1);
+    TEST_ASSERT(nitf_Record_newTextSegment(record, &error));
+
+    writer = nitf_Writer_construct(&error);
+    TEST_ASSERT(writer);
+    TEST_ASSERT(nitf_Writer_prepareIO(writer, record, io, &error));
+    textWriter = nitf_Writer_newTextWriter(writer, 1, &error);
+    nitf_SegmentWriter_attachSource(
+        textWriter,
+        nitf_SegmentMemorySource_construct(NEW_TEXT_DATA,
+                                           strlen(NEW_TEXT_DATA), 0, 0, 0,
+                                           &error),
+        &error);
+    ok = nitf_Writer_patch(writer, &error);
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+    TEST_ASSERT(ok);
+
+    checkFile(testName, io, pixels, &record);
+    TEST_ASSERT(nitf_Field_get(record->header->numTexts, &numTexts,
+                               NITF_CONV_UINT, sizeof(numTexts), &error));
+    TEST_ASSERT_EQ_INT(numTexts, 2);
+    iter = nitf_List_at(record->texts, 1);
+    text = (nitf_TextSegment*)nitf_ListIterator_get(&iter);
+    TEST_ASSERT(dataEquals(io, text->offset, text->end, NEW_TEXT_DATA,
+                           strlen(NEW_TEXT_DATA), &error));
+    nitf_Record_destruct(&record);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testPatchShrink)
+{
+    nitf_Error error;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    nitf_IOInterface* io;
+    nitf_Record* record;
+    nitf_ListIterator iter;
+    nitf_ImageSegment* image;
+    nitf_Off size;
+
+    makePixels(pixels);
+    io = makeFile(pixels, &error);
+    TEST_ASSERT(io);
+    size = nitf_IOInterface_getSize(io, &error);
+
+    record = readFile(io, &error);
+    TEST_ASSERT(record);
+    iter = nitf_List_begin(record->images);
+    image = (nitf_ImageSegment*)nitf_ListIterator_get(&iter);
+    TEST_ASSERT(nitf_ImageSubheader_removeImageComment(image->subheader, 0,
+                                                       &error));
+    TEST_ASSERT(patchFile(record, io, &error));
+    nitf_Record_destruct(&record);
+
+    TEST_ASSERT_EQ_INT((int)nitf_IOInterface_getSize(io, &error),
+                       (int)size - NITF_ICOM_SZ);
+    checkFile(testName, io, pixels, &record);
+    nitf_Record_destruct(&record);
+    nitf_IOInterface_destruct(&io);
+}
+
+/*
+ *  Patches the file with a change that the kept data cannot follow, and
+ *  checks that the patch fails and leaves every byte as it was.
+ */
+static void checkRejected(const char* testName, nitf_Record* record,
+                          nitf_IOInterface* io)
+{
+    nitf_Error error;
+    nitf_Off size = nitf_IOInterface_getSize(io, &error);
+    char* before = (char*)NITF_MALLOC((size_t)size);
+    char* after = (char*)NITF_MALLOC((size_t)size);
+
+    TEST_ASSERT(before && after);
+    TEST_ASSERT(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, &error) == 0);
+    TEST_ASSERT(nitf_IOInterface_read(io, before, (size_t)size, &error));
+
+    TEST_ASSERT(!patchFile(record, io, &error));
+    TEST_ASSERT_EQ_INT(error.level, NITF_ERR_INVALID_OBJECT);
+
+    TEST_ASSERT_EQ_INT((int)nitf_IOInterface_getSize(io, &error), (int)size);
+    TEST_ASSERT(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, &error) == 0);
+    TEST_ASSERT(nitf_IOInterface_read(io, after, (size_t)size, &error));
+    TEST_ASSERT(memcmp(before, after, (size_t)size) == 0);
+    NITF_FREE(before);
+    NITF_FREE(after);
+}
+
+TEST_CASE(testPatchRejectsChangedData)
+{
+    nitf_Error error;
+    nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+    nitf_IOInterface* io;
+    nitf_Record* record;
+    nitf_Writer* writer;
+    nitf_ImageSegment* image;
+    nitf_TextSegment* text;
+    NITF_BOOL ok;
+
+    makePixels(pixels);
+    io = makeFile(pixels, &error);
+    TEST_ASSERT(io);
+
+    /* the kept pixels could not be reshaped to more columns */
+    record = readFile(io, &error);
+    TEST_ASSERT(record);
+    image = nitf_Record_getImageSegment(record, 0, &error);
+    TEST_ASSERT(image);
+    TEST_ASSERT(nitf_Field_setUint32(image->subheader->NITF_NCOLS,
+                                     NUM_COLS * 2, &error));
+    checkRejected(testName, record, io);
+    nitf_Record_destruct(&record);
+
+    /* nor recompressed */
+    record = readFile(io, &error);
+    TEST_ASSERT(record);
+    image = nitf_Record_getImageSegment(record, 0, &error);
+    TEST_ASSERT(image);
+    TEST_ASSERT(nitf_Field_setString(image->subheader->NITF_IC, "C3",
+                                     &error));
+    checkRejected(testName, record, io);
+    nitf_Record_destruct(&record);
+    nitf_IOInterface_destruct(&io);
+
+    /* and two kept texts cannot swap places */
+    record = newRecord(&error);
+    TEST_ASSERT(record);
+    text = nitf_Record_newTextSegment(record, &error);
+    TEST_ASSERT(text);
+    TEST_ASSERT(nitf_Field_setString(text->subheader->NITF_TEXTID, "FIRST",
+                                     &error));
+    text = nitf_Record_newTextSegment(record, &error);
+    TEST_ASSERT(text);
+    TEST_ASSERT(nitf_Field_setString(text->subheader->NITF_TEXTID, "SECOND",
+                                     &error));
+    io = nitf_BufferAdapter_construct((char*)NITF_MALLOC(OUT_SIZE), OUT_SIZE,
+                                      1, &error);
+    TEST_ASSERT(io);
+    writer = nitf_Writer_construct(&error);
+    ok = writer && nitf_Writer_prepareIO(writer, record, io, &error) &&
+         attachText(writer, 0, TEXT_DATA, &error) &&
+         attachText(writer, 1, NEW_TEXT_DATA, &error) &&
+         nitf_Writer_write(writer, &error);
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+    TEST_ASSERT(ok);
+
+    record = readFile(io, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(nitf_Record_moveTextSegment(record, 1, 0, &error));
+    checkRejected(testName, record, io);
+    nitf_Record_destruct(&record);
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testPatchSameLength);
+    CHECK(testPatchGrow);
+    CHECK(testPatchShrink);
+    CHECK(testPatchRejectsChangedData);
+    return 0;
+}
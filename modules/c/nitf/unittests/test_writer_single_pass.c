@@ -0,0 +1,339 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "Fixtures.h"
+
+#ifndef WIN32
+#   include <unistd.h>
+#   include <sys/wait.h>
+#endif
+
+#define NUM_ROWS 20
+#define NUM_COLS 24
+#define NUM_BANDS 3
+/* big enough that a pipe fills and the writer has to wait for the reader */
+#define PIPE_ROWS 256
+#define PIPE_COLS 256
+/* band sequential with more data than single-pass will hold back */
+#define LARGE_ROWS 4800
+#define LARGE_COLS 4800
+#define TEXT_DATA "Written without a single seek"
+#define OUT_SIZE 65536
+
+/*
+ *  A write-only sink that refuses to seek, standing in for a pipe.
+ */
+typedef struct _Sink
+{
+    char buf[OUT_SIZE];
+    size_t size;
+    int seeks;
+} Sink;
+
+static NRT_BOOL Sink_read(NRT_DATA* data, void* buf, size_t size,
+                          nrt_Error* error)
+{
+    (void)data; (void)buf; (void)size;
+    nrt_Error_init(error, "Sink is write-only", NRT_CTXT, NRT_ERR_INVALID_OBJECT);
+    return NRT_FAILURE;
+}
+
+static NRT_BOOL Sink_write(NRT_DATA* data, const void* buf, size_t size,
+                           nrt_Error* error)
+{
+    Sink* sink = (Sink*)data;
+    if (sink->size + size > OUT_SIZE)
+    {
+        nrt_Error_init(error, "Sink is full", NRT_CTXT, NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+    memcpy(sink->buf + sink->size, buf, size);
+    sink->size += size;
+    return NRT_SUCCESS;
+}
+
+static NRT_BOOL Sink_canSeek(NRT_DATA* data, nrt_Error* error)
+{
+    (void)data; (void)error;
+    return NRT_FAILURE;
+}
+
+static nrt_Off Sink_seek(NRT_DATA* data, nrt_Off offset, int whence,
+                         nrt_Error* error)
+{
+    (void)offset; (void)whence;
+    ((Sink*)data)->seeks++;
+    nrt_Error_init(error, "Sink cannot seek", NRT_CTXT, NRT_ERR_INVALID_OBJECT);
+    return -1;
+}
+
+static nrt_Off Sink_tell(NRT_DATA* data, nrt_Error* error)
+{
+    (void)error;
+    return (nrt_Off)((Sink*)data)->size;
+}
+
+static nrt_Off Sink_getSize(NRT_DATA* data, nrt_Error* error)
+{
+    (void)error;
+    return (nrt_Off)((Sink*)data)->size;
+}
+
+static int Sink_getMode(NRT_DATA* data, nrt_Error* error)
+{
+    (void)data; (void)error;
+    return NRT_ACCESS_WRITEONLY;
+}
+
+static NRT_BOOL Sink_close(NRT_DATA* data, nrt_Error* error)
+{
+    (void)data; (void)error;
+    return NRT_SUCCESS;
+}
+
+static void Sink_destruct(NRT_DATA* data)
+{
+    (void)data;
+}
+
+static nrt_IOInterface* Sink_construct(nrt_Error* error)
+{
+    static nrt_IIOInterface iSink = {
+        &Sink_read, &Sink_write, &Sink_canSeek, &Sink_seek, &Sink_tell,
+        &Sink_getSize, &Sink_getMode, &Sink_close, &Sink_destruct
+    };
+    nrt_IOInterface* io = (nrt_IOInterface*)NRT_MALLOC(sizeof(nrt_IOInterface));
+    Sink* sink = (Sink*)NRT_MALLOC(sizeof(Sink));
+    if (!io || !sink)
+    {
+        nrt_Error_init(error, "Out of memory", NRT_CTXT, NRT_ERR_MEMORY);
+        return NULL;
+    }
+    memset(sink, 0, sizeof(Sink));
+    io->data = sink;
+    io->iface = &iSink;
+    return io;
+}
+
+static nitf_Record* makeRecord(const char* imode, nitf_Uint32 numRows,
+                               nitf_Uint32 numCols, nitf_Error* error)
+{
+    nitf_Record* record = newRecord(error);
+
+    if (!record)
+        return NULL;
+    if (!addImage(record, numRows, numCols, 16, 16, imode, NUM_BANDS,
+                  error) ||
+        !nitf_Record_newTextSegment(record, error))
+        nitf_Record_destruct(&record);
+    return record;
+}
+
+static NITF_BOOL writeTo(nitf_Record* record, nitf_IOInterface* io,
+                         const nitf_Uint8* pixels, NITF_BOOL singlePass,
+                         nitf_Error* error)
+{
+    nitf_Writer* writer = nitf_Writer_construct(error);
+    NITF_BOOL ok;
+
+    if (!writer)
+        return NITF_FAILURE;
+    ok = nitf_Writer_prepareIO(writer, record, io, error) &&
+         attachPixels(writer, 0, pixels, error) &&
+         attachText(writer, 0, TEXT_DATA, error) &&
+         (singlePass ? nitf_Writer_writeSinglePass(writer, error) :
+                       nitf_Writer_write(writer, error));
+    nitf_Writer_destruct(&writer);
+    return ok;
+}
+
+static void compareWrites(const char* testName, const char* imode)
+{
+    nitf_Error error;
+    nitf_Record* record;
+    nitf_IOInterface* sink;
+    nitf_IOInterface* file;
+    char* expected;
+    nitf_Uint8 pixels[NUM_BANDS * NUM_ROWS * NUM_COLS];
+    nitf_Off expectedSize;
+    Sink* sunk;
+    size_t i;
+
+    for (i = 0; i < sizeof(pixels); ++i)
+        pixels[i] = (nitf_Uint8)(i * 7);
+
+    /* the ordinary seek-and-patch write is the reference */
+    expected = (char*)NITF_MALLOC(OUT_SIZE);
+    TEST_ASSERT(expected);
+    file = nitf_BufferAdapter_construct(expected, OUT_SIZE, 1, &error);
+    TEST_ASSERT(file);
+    record = makeRecord(imode, NUM_ROWS, NUM_COLS, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(writeTo(record, file, pixels, 0, &error));
+    expectedSize = nitf_IOInterface_getSize(file, &error);
+    nitf_Record_destruct(&record);
+
+    sink = Sink_construct(&error);
+    TEST_ASSERT(sink);
+    record = makeRecord(imode, NUM_ROWS, NUM_COLS, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(writeTo(record, sink, pixels, 1, &error));
+    nitf_Record_destruct(&record);
+
+    sunk = (Sink*)sink->data;
+    TEST_ASSERT_EQ_INT(sunk->seeks, 0);
+    TEST_ASSERT_EQ_INT(sunk->size, expectedSize);
+    TEST_ASSERT(memcmp(sunk->buf, expected, sunk->size) == 0);
+
+    nitf_IOInterface_destruct(&sink);
+    nitf_IOInterface_destruct(&file);
+}
+
+TEST_CASE(testSinglePassBandInterleavedByBlock)
+{
+    /* 2x2 blocks, with a partial block in each direction */
+    compareWrites(testName, "B");
+}
+
+TEST_CASE(testSinglePassBandSequential)
+{
+    /* band sequential data is produced out of file order */
+    compareWrites(testName, "S");
+}
+
+TEST_CASE(testSinglePassThroughPipe)
+{
+#ifndef WIN32
+    nitf_Error error;
+    nitf_Record* record;
+    nitf_IOInterface* reference;
+    nitf_Uint8* pixels;
+    const char* expected;
+    char* received;
+    size_t expectedSize;
+    size_t size = 0;
+    ssize_t got;
+    int fds[2];
+    int status;
+    pid_t child;
+    size_t i;
+
+    pixels = (nitf_Uint8*)NITF_MALLOC(NUM_BANDS * PIPE_ROWS * PIPE_COLS);
+    TEST_ASSERT(pixels);
+    for (i = 0; i < NUM_BANDS * PIPE_ROWS * PIPE_COLS; ++i)
+        pixels[i] = (nitf_Uint8)(i * 13);
+
+    reference = nitf_GrowableBufferAdapter_construct(0, &error);
+    TEST_ASSERT(reference);
+    record = makeRecord("P", PIPE_ROWS, PIPE_COLS, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(writeTo(record, reference, pixels, 0, &error));
+    nitf_Record_destruct(&record);
+    expected = nitf_GrowableBufferAdapter_getBuffer(reference, &expectedSize,
+                                                    &error);
+    TEST_ASSERT(expected);
+
+    /* the child writes into the pipe, which cannot seek at all */
+    TEST_ASSERT(pipe(fds) == 0);
+    child = fork();
+    TEST_ASSERT(child >= 0);
+    if (child == 0)
+    {
+        nitf_IOInterface* output;
+        NITF_BOOL ok;
+
+        close(fds[0]);
+        output = nitf_IOHandleAdapter_construct(fds[1],
+                                                NITF_ACCESS_WRITEONLY,
+                                                &error);
+        record = makeRecord("P", PIPE_ROWS, PIPE_COLS, &error);
+        ok = output && record &&
+             writeTo(record, output, pixels, 1, &error);
+        if (!ok)
+            nitf_Error_print(&error, stderr, "single-pass write to a pipe");
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+
+    /* read one byte more than expected, to catch anything extra */
+    received = (char*)NITF_MALLOC(expectedSize + 1);
+    TEST_ASSERT(received);
+    while (size <= expectedSize &&
+           (got = read(fds[0], received + size,
+                       expectedSize + 1 - size)) > 0)
+        size += (size_t)got;
+    close(fds[0]);
+
+    TEST_ASSERT(waitpid(child, &status, 0) == child);
+    TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    TEST_ASSERT_EQ_INT(size, expectedSize);
+    TEST_ASSERT(memcmp(received, expected, size) == 0);
+
+    NITF_FREE(received);
+    NITF_FREE(pixels);
+    nitf_IOInterface_destruct(&reference);
+#else
+    (void)testName;
+#endif
+}
+
+TEST_CASE(testSinglePassRejectsLargeHold)
+{
+    nitf_Error error;
+    nitf_Record* record;
+    nitf_Writer* writer;
+    nitf_IOInterface* sink;
+
+    /*
+     *  The first band's rows go out as they come, but the other bands'
+     *  would all have to be held until it is done.  That is refused
+     *  before a byte is written, so no pixels are needed.
+     */
+    record = makeRecord("S", LARGE_ROWS, LARGE_COLS, &error);
+    TEST_ASSERT(record);
+    sink = Sink_construct(&error);
+    TEST_ASSERT(sink);
+    writer = nitf_Writer_construct(&error);
+    TEST_ASSERT(writer);
+    TEST_ASSERT(nitf_Writer_prepareIO(writer, record, sink, &error));
+    TEST_ASSERT(attachText(writer, 0, TEXT_DATA, &error));
+    TEST_ASSERT(!nitf_Writer_writeSinglePass(writer, &error));
+    TEST_ASSERT_EQ_INT(error.level, NITF_ERR_INVALID_OBJECT);
+    TEST_ASSERT_EQ_INT(((Sink*)sink->data)->size, 0);
+
+    nitf_Writer_destruct(&writer);
+    nitf_IOInterface_destruct(&sink);
+    nitf_Record_destruct(&record);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testSinglePassBandInterleavedByBlock);
+    CHECK(testSinglePassBandSequential);
+    CHECK(testSinglePassThroughPipe);
+    CHECK(testSinglePassRejectsLargeHold);
+    return 0;
+}
@@ -23,6 +23,7 @@
 #ifndef __IMPORT_NRT_H__
 #define __IMPORT_NRT_H__
 
+#include "nrt/Arena.h"
 #include "nrt/DateTime.h"
 #include "nrt/Debug.h"
 #include "nrt/Defines.h"
@@ -33,6 +34,7 @@
 #include "nrt/IntStack.h"
 #include "nrt/IOHandle.h"
 #include "nrt/IOInterface.h"
+#include "nrt/IOStats.h"
 #include "nrt/List.h"
 #include "nrt/Memory.h"
 #include "nrt/Pair.h"
@@ -0,0 +1,90 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program;
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NRT_ARENA_H__
+#define __NRT_ARENA_H__
+
+#include "nrt/System.h"
+
+NRT_CXX_GUARD
+
+/*!
+ *  \struct nrt_Arena
+ *  \brief  Memory that is handed out in pieces and given back all at once
+ *
+ *  An arena takes large chunks from the allocator and hands out pieces of
+ *  them.  Nothing is given back until the arena is destroyed, which
+ *  releases all of it in one step, so it suits a set of objects that live
+ *  and die together, like the metadata of a record.
+ *
+ *  Memory only comes from an arena when it is asked for with
+ *  nrt_Arena_malloc.  NRT_FREE of arena memory does nothing, and
+ *  NRT_REALLOC of it copies to the allocator, so objects allocated in an
+ *  arena can be destroyed and changed like any others.  An arena is not
+ *  locked, so only one thread may allocate from it at a time.
+ */
+typedef struct _NRT_Arena nrt_Arena;
+
+/*!
+ *  Constructs an empty arena
+ *
+ *  \param chunkSize The size of the first chunk, or 0 for a default.
+ *  Later chunks are larger.
+ *  \param error An error to populate on failure
+ *  \return The arena, or NULL on failure
+ */
+NRTAPI(nrt_Arena *) nrt_Arena_construct(size_t chunkSize, nrt_Error * error);
+
+/*!
+ *  Releases everything allocated from the arena, and the arena, and NULL
+ *  sets it.
+ */
+NRTAPI(void) nrt_Arena_destruct(nrt_Arena ** arena);
+
+/*!
+ *  Allocates size bytes from the arena
+ *
+ *  \return The memory, or NULL if the allocator had none
+ */
+NRTAPI(void *) nrt_Arena_malloc(nrt_Arena * arena, size_t size);
+
+/*!
+ *  Returns the arena that ptr was allocated from, or NULL if it did not
+ *  come from an arena.  It takes no lock, so NRT_FREE and NRT_REALLOC
+ *  can ask it about every pointer.
+ */
+NRTAPI(nrt_Arena *) nrt_Arena_find(const void *ptr);
+
+/*!
+ *  Returns the number of bytes the arena has taken from the allocator
+ */
+NRTAPI(size_t) nrt_Arena_getSize(const nrt_Arena * arena);
+
+/*!
+ *  Returns the size that was asked for when ptr was allocated from an
+ *  arena.  For nrt_Memory_realloc.
+ */
+NRTPROT(size_t) nrt_Arena_getAllocationSize(const void *ptr);
+
+NRT_CXX_ENDGUARD
+
+#endif
@@ -33,6 +33,34 @@
 #endif
 
 NRT_CXX_GUARD
+
+/*!
+ *  \struct nrt_IORequest
+ *  \brief One read of a batch: size bytes from offset in the file into buf
+ */
+typedef struct _nrt_IORequest
+{
+    nrt_Off offset;
+    void *buf;
+    size_t size;
+} nrt_IORequest;
+
+/*!
+ *  \struct nrt_FileStamp
+ *  \brief What tells one version of a file from another
+ *
+ *  Times are in nanoseconds since the epoch, at whatever precision the
+ *  file system keeps.  On Windows, the device is the volume serial number,
+ *  the inode the file index and the change time the creation time.
+ */
+typedef struct _nrt_FileStamp
+{
+    nrt_Uint64 device;          /*!< The device holding the file */
+    nrt_Uint64 inode;           /*!< The file's number on the device */
+    nrt_Int64 modified;         /*!< When the contents last changed */
+    nrt_Int64 changed;          /*!< When the file's status last changed */
+} nrt_FileStamp;
+
 /*!
  *  Create an IO handle.  If the file is set to create,
  *  the permissions will be built into the create:
@@ -120,6 +148,71 @@ NRTAPI(nrt_Off) nrt_IOHandle_tell(nrt_IOHandle handle, nrt_Error * error);
  */
 NRTAPI(nrt_Off) nrt_IOHandle_getSize(nrt_IOHandle handle, nrt_Error * error);
 
+/*!
+ *  Get the stamp of the file behind a handle: where it lives and when it
+ *  last changed.  A file rewritten in place gets a new modification time,
+ *  and one replaced by another under the same name a new inode.
+ *
+ *  \param handle The handle to look at
+ *  \param stamp  Filled in with the stamp
+ *  \param error  A populated error if something goes wrong
+ *  \return NRT_SUCCESS or NRT_FAILURE
+ */
+NRTAPI(NRT_BOOL) nrt_IOHandle_getStamp(nrt_IOHandle handle,
+                                       nrt_FileStamp * stamp,
+                                       nrt_Error * error);
+
+/*!
+ *  Copy bytes from the current position of one handle to the current
+ *  position of another, inside the kernel (copy_file_range, then sendfile)
+ *  where the platform offers it.  Both handles are advanced by the amount
+ *  copied.  This stops early, without an error, when the kernel cannot do
+ *  the copy for these handles, so the caller must finish any remainder
+ *  itself (nrt_IOInterface_copy does this).
+ *
+ *  \param input  The handle to copy from
+ *  \param output The handle to copy to
+ *  \param size   The number of bytes to copy
+ *  \param error  Populated on failure
+ *  \return The number of bytes copied, testable with NRT_IO_SUCCESS()
+ */
+NRTAPI(nrt_Off) nrt_IOHandle_copy(nrt_IOHandle input, nrt_IOHandle output,
+                                  nrt_Uint64 size, nrt_Error * error);
+
+/*!
+ *  Read a batch of requests, each at its own offset, and wait for all of
+ *  them to complete.  Many reads are kept in flight at once: through
+ *  io_uring on Linux kernels that allow it, and otherwise on a small pool
+ *  of threads each issuing positional reads.  Each calling thread sets up
+ *  its ring on its first batch and keeps it until it exits, while the pool
+ *  is shared by the whole process.  A child process sets up its own on its
+ *  first batch after fork.  The requests may complete in any order, and
+ *  the handle's file position is left where it was.
+ *  Reading past the end of the file is an error.
+ *
+ *  \param handle      The handle to read from
+ *  \param requests    The reads to perform
+ *  \param numRequests The number of requests
+ *  \param error       Populated on failure
+ *  \return NRT_SUCCESS or NRT_FAILURE
+ */
+NRTAPI(NRT_BOOL) nrt_IOHandle_readBatch(nrt_IOHandle handle,
+                                        const nrt_IORequest *requests,
+                                        size_t numRequests,
+                                        nrt_Error * error);
+
+/*!
+ *  Set the size of the file behind a handle, discarding anything past the
+ *  new size (or zero-filling up to it).  The file position is unchanged.
+ *
+ *  \param handle The handle to resize
+ *  \param size   The new size of the file
+ *  \param error  Populated on failure
+ *  \return NRT_SUCCESS or NRT_FAILURE
+ */
+NRTAPI(NRT_BOOL) nrt_IOHandle_truncate(nrt_IOHandle handle, nrt_Off size,
+                                       nrt_Error * error);
+
 /*!
  *  Close the IO handle.
  *
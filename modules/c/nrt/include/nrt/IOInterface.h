@@ -104,6 +104,40 @@ NRTAPI(int) nrt_IOInterface_getMode(nrt_IOInterface * io, nrt_Error * error);
  */
 NRTAPI(NRT_BOOL) nrt_IOInterface_close(nrt_IOInterface * io, nrt_Error * error);
 
+/**
+ * Copies size bytes from the current position of the input to the current
+ * position of the output, advancing both.  Between two file handles the
+ * copy is done in the kernel where the platform supports it (see
+ * nrt_IOHandle_copy).  When either end is a buffer adapter the data goes
+ * straight to or from its memory, and otherwise it is staged through a
+ * buffer of up to 1 MB.
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_copy(nrt_IOInterface * input,
+                                      nrt_IOInterface * output,
+                                      nrt_Uint64 size,
+                                      nrt_Error * error);
+
+/**
+ * Reads a batch of requests, each at its own offset, and waits for them
+ * all.  File handles keep many reads in flight at once (see
+ * nrt_IOHandle_readBatch), buffer adapters copy straight from memory, and
+ * any other interface is read one request at a time with seek and read.
+ * The current position afterwards is unspecified.
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_readBatch(nrt_IOInterface * io,
+                                           const nrt_IORequest * requests,
+                                           size_t numRequests,
+                                           nrt_Error * error);
+
+/**
+ * Cuts the output down to (or extends it to) size bytes.  This is only
+ * possible for IO handle and buffer adapters; anything else fails with
+ * NRT_ERR_INVALID_OBJECT.  A buffer adapter cannot grow past its buffer.
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_truncate(nrt_IOInterface * io,
+                                          nrt_Off size,
+                                          nrt_Error * error);
+
 /**
  * Destroys the interface and cleans up any owned resources
  */
@@ -131,5 +165,56 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
                                                       NRT_BOOL ownBuf,
                                                       nrt_Error * error);
 
+/**
+ * Creates an IOInterface over memory that it owns and grows as needed, for
+ * output whose size is not known up front.  Writes may land anywhere,
+ * including past the end, in which case the gap reads back as zeros, so
+ * the writer can seek back and patch lengths as it does with a file.  The
+ * allocation doubles as it fills, starting at capacity bytes (or a small
+ * default if capacity is 0).
+ */
+NRTAPI(nrt_IOInterface *) nrt_GrowableBufferAdapter_construct(size_t capacity,
+                                                              nrt_Error *
+                                                              error);
+
+/**
+ * Returns the bytes written to a growable buffer adapter so far, and their
+ * count in size.  The adapter still owns them, and the pointer is good only
+ * until its next write or truncate.
+ *
+ * \return The buffer, or NULL if io is not a growable buffer adapter
+ */
+NRTAPI(char *) nrt_GrowableBufferAdapter_getBuffer(nrt_IOInterface * io,
+                                                   size_t * size,
+                                                   nrt_Error * error);
+
+/**
+ * Hands the bytes written to a growable buffer adapter over to the caller,
+ * without copying them, and leaves the adapter empty.  The buffer must be
+ * released with NRT_FREE.
+ *
+ * \return The buffer, or NULL if io is not a growable buffer adapter
+ */
+NRTAPI(char *) nrt_GrowableBufferAdapter_release(nrt_IOInterface * io,
+                                                 size_t * size,
+                                                 nrt_Error * error);
+
+/**
+ * Creates an IOInterface that reads another one through a buffer of
+ * bufferSize bytes, so that many small reads cost one read of the wrapped
+ * interface.  Seeks only move the position, and a read served from bytes
+ * already buffered never touches the wrapped interface.  Writes go
+ * straight through.  Reads are only buffered when the wrapped interface
+ * reports its size; otherwise they are passed on as they are.
+ *
+ * The wrapped interface is left wherever the buffering needed it, so seek
+ * it to nrt_IOInterface_tell of the adapter before using it directly.  If
+ * adopt is true, destroying the adapter destroys the wrapped interface.
+ */
+NRTAPI(nrt_IOInterface *) nrt_BufferedAdapter_construct(nrt_IOInterface * io,
+                                                        size_t bufferSize,
+                                                        NRT_BOOL adopt,
+                                                        nrt_Error * error);
+
 NRT_CXX_ENDGUARD
 #endif
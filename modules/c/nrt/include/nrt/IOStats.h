@@ -0,0 +1,183 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NRT_IO_STATS_H__
+#define __NRT_IO_STATS_H__
+
+#include "nrt/IOInterface.h"
+
+NRT_CXX_GUARD
+
+/*!
+ *  Number of buckets in each histogram.  Bucket 0 counts zeros, and bucket
+ *  i counts values in [2^(i-1), 2^i); the last bucket also takes anything
+ *  larger.
+ */
+#define NRT_IO_STATS_BUCKETS (32)
+
+/*!
+ *  The operations that are measured.  Reads made through
+ *  nrt_IOInterface_readBatch are counted as batches, not as reads.
+ */
+typedef enum _nrt_IOStatsOp
+{
+    NRT_IO_STATS_READ = 0,
+    NRT_IO_STATS_WRITE,
+    NRT_IO_STATS_SEEK,
+    NRT_IO_STATS_BATCH,
+    NRT_IO_STATS_NUM_OPS
+} nrt_IOStatsOp;
+
+/*!
+ *  \struct nrt_IOOpStats
+ *  \brief Counters for one kind of operation
+ *
+ *  For seeks, bytes and sizes measure the distance moved rather than data
+ *  transferred, so a run of zero-distance seeks shows up in bucket 0.  For
+ *  batches, sizes has one entry per request and latencies one per batch.
+ */
+typedef struct _nrt_IOOpStats
+{
+    nrt_Uint64 calls;
+    nrt_Uint64 failures;
+    nrt_Uint64 bytes;
+    nrt_Uint64 nanos;
+    nrt_Uint64 maxNanos;
+    nrt_Uint64 sizes[NRT_IO_STATS_BUCKETS];
+    nrt_Uint64 latencies[NRT_IO_STATS_BUCKETS]; /* in microseconds */
+} nrt_IOOpStats;
+
+/*!
+ *  \struct nrt_IOStats
+ *  \brief Counters for every kind of operation, indexed by nrt_IOStatsOp
+ */
+typedef struct _nrt_IOStats
+{
+    nrt_IOOpStats ops[NRT_IO_STATS_NUM_OPS];
+} nrt_IOStats;
+
+/*!
+ *  \struct nrt_IOAccess
+ *  \brief One access, as passed to a trace callback
+ */
+typedef struct _nrt_IOAccess
+{
+    nrt_IOStatsOp op;
+    nrt_Off offset;     /* Where the access started, or -1 if unknown */
+    nrt_Uint64 size;    /* Bytes transferred, or distance sought */
+    nrt_Uint64 nanos;
+    NRT_BOOL ok;
+    const char *tag;    /* The current tag, or NULL */
+    nrt_Int64 block;    /* The current block, or -1 */
+} nrt_IOAccess;
+
+typedef void (*NRT_IO_STATS_TRACE) (NRT_DATA *, const nrt_IOAccess *);
+
+/*!
+ *  Creates an IOInterface that passes everything on to io and measures it:
+ *  call counts, failures, bytes, seek distances, and histograms of sizes
+ *  and latencies for each kind of operation.  Totals are kept for the
+ *  whole life of the adapter, and separately for each tag set with
+ *  nrt_IOStatsAdapter_setTag.  The counters are not synchronized, so the
+ *  adapter must not be used from two threads at once.
+ *
+ *  If adopt is true, destroying the adapter destroys io.
+ */
+NRTAPI(nrt_IOInterface *) nrt_IOStatsAdapter_construct(nrt_IOInterface * io,
+                                                       NRT_BOOL adopt,
+                                                       nrt_Error * error);
+
+/*!
+ *  Returns the interface a stats adapter wraps, or NULL if io is not a
+ *  stats adapter.
+ */
+NRTAPI(nrt_IOInterface *) nrt_IOStatsAdapter_getWrapped(nrt_IOInterface * io);
+
+/*!
+ *  Attributes the accesses that follow to tag as well as to the totals,
+ *  until the tag is changed or cleared with NULL.  The Reader tags header
+ *  parsing with "header", and image readers tag their reads with
+ *  "image[N]".  Does nothing if io is not a stats adapter, so callers can
+ *  tag unconditionally.
+ */
+NRTAPI(void) nrt_IOStatsAdapter_setTag(nrt_IOInterface * io,
+                                       const char *tag);
+
+/*!
+ *  Records the block the accesses that follow belong to, for the trace
+ *  callback; -1 clears it.  ImageIO sets this as it reads each block.  Does
+ *  nothing if io is not a stats adapter.
+ */
+NRTAPI(void) nrt_IOStatsAdapter_setBlock(nrt_IOInterface * io,
+                                         nrt_Int64 block);
+
+/*!
+ *  Calls trace with every access as it completes, or stops if trace is
+ *  NULL.
+ */
+NRTAPI(NRT_BOOL) nrt_IOStatsAdapter_setTrace(nrt_IOInterface * io,
+                                             NRT_IO_STATS_TRACE trace,
+                                             NRT_DATA * user,
+                                             nrt_Error * error);
+
+/*!
+ *  Fills in stats with the totals, or with the counters for tag if it is
+ *  not NULL.  A tag that has not been used yet has all zero counters.
+ */
+NRTAPI(NRT_BOOL) nrt_IOStatsAdapter_getStats(nrt_IOInterface * io,
+                                             const char *tag,
+                                             nrt_IOStats * stats,
+                                             nrt_Error * error);
+
+/*!
+ *  Returns the index-th tag that has been used, in the order they were
+ *  first set, or NULL past the last one.
+ */
+NRTAPI(const char *) nrt_IOStatsAdapter_getTag(nrt_IOInterface * io,
+                                               size_t index);
+
+/*!
+ *  Zeroes every counter, and forgets the tags.
+ */
+NRTAPI(NRT_BOOL) nrt_IOStatsAdapter_reset(nrt_IOInterface * io,
+                                          nrt_Error * error);
+
+/*!
+ *  Returns the totals and the per-tag counters as a JSON object, with
+ *  trailing empty histogram buckets left off.  The string must be freed
+ *  with NRT_FREE.
+ */
+NRTAPI(char *) nrt_IOStatsAdapter_toJSON(nrt_IOInterface * io,
+                                         nrt_Error * error);
+
+/*!
+ *  Passes a batch of reads on to the wrapped interface, so that it keeps
+ *  its fast path, and counts it.  Used by nrt_IOInterface_readBatch.
+ */
+NRTPROT(NRT_BOOL) nrt_IOStatsAdapter_readBatch(nrt_IOInterface * io,
+                                               const nrt_IORequest *
+                                               requests,
+                                               size_t numRequests,
+                                               nrt_Error * error);
+
+NRT_CXX_ENDGUARD
+#endif
@@ -27,18 +27,74 @@
  *  \file
  *  Memory is a very simple allocation tracker.  When NRT_DEBUG
  *  is on, NRT_MALLOC and NRT_FREE to book-keeping.  When it is not,
- *  they turn into malloc() and free()
+ *  they go to nrt_Memory_malloc() and nrt_Memory_free(), which hand the
+ *  request to the current nrt_Allocator (malloc() and free() unless
+ *  one has been set).
  */
 
+#include "nrt/Defines.h"
+#include "nrt/Types.h"
+
+NRT_CXX_GUARD
+
+/*!
+ *  \struct nrt_Allocator
+ *  \brief  Where NRT_MALLOC, NRT_REALLOC and NRT_FREE get their memory
+ *
+ *  The functions get the allocator's data as their first argument.  They
+ *  have to be safe to call from any thread that uses the library.
+ */
+typedef struct _NRT_Allocator
+{
+    void *(*allocate) (void *data, size_t size);
+    void *(*reallocate) (void *data, void *ptr, size_t size);
+    void (*release) (void *data, void *ptr);
+    void *data;
+} nrt_Allocator;
+
+/*!
+ *  Sets the allocator used from now on.  The allocator is copied.  Memory
+ *  has to be freed by the allocator it came from, so this should be called
+ *  before anything is allocated, or after everything has been freed.
+ *
+ *  \param allocator The allocator, or NULL for malloc(), realloc()
+ *  and free()
+ */
+NRTAPI(void) nrt_Memory_setAllocator(const nrt_Allocator * allocator);
+
+/*!
+ *  Returns the allocator in use
+ */
+NRTAPI(const nrt_Allocator *) nrt_Memory_getAllocator(void);
+
+/*!
+ *  Allocates size bytes from the allocator
+ */
+NRTAPI(void *) nrt_Memory_malloc(size_t size);
+
+/*!
+ *  Resizes memory from nrt_Memory_malloc.  Memory from an nrt_Arena is
+ *  copied to a new allocation from the allocator.
+ */
+NRTAPI(void *) nrt_Memory_realloc(void *ptr, size_t size);
+
+/*!
+ *  Frees memory from nrt_Memory_malloc.  Memory from an nrt_Arena is left
+ *  alone until the arena is destroyed.
+ */
+NRTAPI(void) nrt_Memory_free(void *ptr);
+
+NRT_CXX_ENDGUARD
+
 #ifdef NRT_DEBUG
 #   include "nrt/Debug.h"
 #   define NRT_MALLOC(P)  nrt_Debug_malloc(__FILE__, __LINE__, P)
 #   define NRT_REALLOC(P, S) nrt_Debug_realloc(__FILE__, __LINE__, P, S)
 #   define NRT_FREE(P)    nrt_Debug_free(__FILE__, __LINE__, P)
 #else
-#   define NRT_MALLOC  malloc
-#   define NRT_REALLOC realloc
-#   define NRT_FREE    free
+#   define NRT_MALLOC  nrt_Memory_malloc
+#   define NRT_REALLOC nrt_Memory_realloc
+#   define NRT_FREE    nrt_Memory_free
 #endif
 
 #endif
@@ -26,24 +26,46 @@
 #include "nrt/Defines.h"
 #include "nrt/Types.h"
 #include "nrt/Memory.h"
+#include "nrt/Error.h"
 
 NRT_CXX_GUARD
 #if defined(WIN32)
 typedef LPCRITICAL_SECTION nrt_Mutex;
+typedef HANDLE nrt_Thread;
 #elif defined(__sgi)
 #   include <sys/atomic_ops.h>
 #   define NRT_MUTEX_INIT 0
 typedef int nrt_Mutex;
+typedef int nrt_Thread;
 #else
 #   include <pthread.h>
 #   define NRT_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
 typedef pthread_mutex_t nrt_Mutex;
+typedef pthread_t nrt_Thread;
 #endif
 
+/*!
+ *  The function a thread runs
+ */
+typedef void (*NRT_THREAD_RUN) (NRT_DATA * data);
+
 NRTPROT(void) nrt_Mutex_lock(nrt_Mutex * m);
 NRTPROT(void) nrt_Mutex_unlock(nrt_Mutex * m);
 NRTPROT(void) nrt_Mutex_init(nrt_Mutex * m);
 NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m);
 
+/*!
+ *  Starts a thread running run(data).  Each started thread must be
+ *  joined.  Fails where threads are not supported, so callers should be
+ *  ready to do the work themselves.
+ */
+NRTPROT(NRT_BOOL) nrt_Thread_start(nrt_Thread * thread, NRT_THREAD_RUN run,
+                                   NRT_DATA * data, nrt_Error * error);
+
+/*!
+ *  Waits for a started thread to finish.
+ */
+NRTPROT(void) nrt_Thread_join(nrt_Thread * thread);
+
 NRT_CXX_ENDGUARD
 #endif
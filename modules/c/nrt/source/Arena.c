@@ -0,0 +1,324 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program;
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nrt/Arena.h"
+
+/*  The default size of the first chunk, and the size later ones stop   */
+/*  growing at                                                          */
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+#define ARENA_MAX_CHUNK (1024 * 1024)
+
+/*  Each allocation is aligned to this, and follows this many bytes     */
+/*  holding the size that was asked for                                 */
+#define ARENA_ALIGN 16
+#define ARENA_ALIGN_UP(P) \
+    ((char *) (((size_t) (P) + ARENA_ALIGN - 1) & \
+               ~(size_t) (ARENA_ALIGN - 1)))
+
+/*
+ *  Chunks start on a page boundary and cover whole pages, and a map from
+ *  each page to its arena lets NRT_FREE tell arena memory from the
+ *  allocator's without a lock.  The map has three levels of 4096 entries
+ *  each, which covers 48 bit addresses.
+ */
+#define ARENA_PAGE_SHIFT 12
+#define ARENA_PAGE ((size_t) 1 << ARENA_PAGE_SHIFT)
+#define ARENA_MAP_SHIFT 12
+#define ARENA_MAP_SIZE ((size_t) 1 << ARENA_MAP_SHIFT)
+#define ARENA_MAP_MASK (ARENA_MAP_SIZE - 1)
+
+/*
+ *  The map is read without the lock, so its entries are published with
+ *  release stores and read with acquire loads
+ */
+#if defined(__GNUC__)
+#   define ARENA_LOAD(X) __atomic_load_n(&(X), __ATOMIC_ACQUIRE)
+#   define ARENA_STORE(X, V) __atomic_store_n(&(X), (V), __ATOMIC_RELEASE)
+#else
+#   define ARENA_LOAD(X) (X)
+#   define ARENA_STORE(X, V) ((X) = (V))
+#endif
+
+typedef struct _ArenaLeaf
+{
+    nrt_Arena * volatile arenas[ARENA_MAP_SIZE];
+} ArenaLeaf;
+
+typedef struct _ArenaNode
+{
+    ArenaLeaf * volatile leaves[ARENA_MAP_SIZE];
+} ArenaNode;
+
+/*  Tables are added under the mutex below, and never removed  */
+static ArenaNode * volatile pageMap[ARENA_MAP_SIZE];
+
+/*
+ *  The start of each chunk, which links it to the arena's others
+ */
+typedef struct _ArenaChunk
+{
+    struct _ArenaChunk *next;
+    void *raw;                  /* What the allocator handed out */
+    size_t size;                /* The pages the chunk covers */
+} ArenaChunk;
+
+#define ARENA_CHUNK_HEADER \
+    ((sizeof(ArenaChunk) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+struct _NRT_Arena
+{
+    ArenaChunk *chunks;         /* The arena's chunks, newest first */
+    char *next;                 /* Where the next allocation goes */
+    char *limit;                /* The end of the chunk next points into */
+    size_t chunkSize;           /* The size of the next chunk */
+    size_t size;                /* Bytes taken from the allocator */
+};
+
+#ifndef WIN32
+    static nrt_Mutex  __ArenaLock = NRT_MUTEX_INIT;
+#   define GET_MUTEX() &__ArenaLock
+#else
+    static nrt_Mutex __ArenaLock = NULL;
+    static long __ArenaInitLock = 0;
+
+NRTPRIV(nrt_Mutex*) GET_MUTEX()
+{
+    if (__ArenaLock == NULL)
+    {
+        while (InterlockedExchange(&__ArenaInitLock, 1) == 1)
+            /* loop, another thread own the lock */ ;
+        if (__ArenaLock == NULL)
+            nrt_Mutex_init(&__ArenaLock);
+        InterlockedExchange(&__ArenaInitLock, 0);
+    }
+    return &__ArenaLock;
+}
+#endif
+
+
+/*
+ *  Returns the map entry for the page ptr is in, or NULL if the map has
+ *  no table for it.  With create set, which needs the lock, the missing
+ *  tables are added.  They live as long as the process, so they come
+ *  straight from calloc rather than from the allocator.
+ */
+NRTPRIV(nrt_Arena * volatile *) mapEntry(const void *ptr, NRT_BOOL create)
+{
+    size_t page = (size_t) ptr >> ARENA_PAGE_SHIFT;
+    size_t top = page >> (2 * ARENA_MAP_SHIFT);
+    ArenaNode *node;
+    ArenaLeaf *leaf;
+
+    if (top >= ARENA_MAP_SIZE)
+        return NULL;
+
+    node = ARENA_LOAD(pageMap[top]);
+    if (!node)
+    {
+        if (!create)
+            return NULL;
+        node = (ArenaNode *) calloc(1, sizeof(ArenaNode));
+        if (!node)
+            return NULL;
+        ARENA_STORE(pageMap[top], node);
+    }
+
+    leaf = ARENA_LOAD(node->leaves[(page >> ARENA_MAP_SHIFT) &
+                                   ARENA_MAP_MASK]);
+    if (!leaf)
+    {
+        if (!create)
+            return NULL;
+        leaf = (ArenaLeaf *) calloc(1, sizeof(ArenaLeaf));
+        if (!leaf)
+            return NULL;
+        ARENA_STORE(node->leaves[(page >> ARENA_MAP_SHIFT) & ARENA_MAP_MASK],
+                    leaf);
+    }
+    return &leaf->arenas[page & ARENA_MAP_MASK];
+}
+
+/*
+ *  Points the map entries of the chunk's pages at arena, or clears them
+ *  when arena is NULL
+ */
+NRTPRIV(NRT_BOOL) mapChunk(ArenaChunk *chunk, nrt_Arena *arena)
+{
+    char *page;
+    char *end = (char *) chunk + chunk->size;
+    NRT_BOOL ok = NRT_SUCCESS;
+
+    nrt_Mutex_lock(GET_MUTEX());
+
+    /* make sure every table is there before any entry is set */
+    for (page = (char *) chunk; ok && page < end; page += ARENA_PAGE)
+        ok = mapEntry(page, arena != NULL) != NULL || !arena;
+
+    for (page = (char *) chunk; ok && page < end; page += ARENA_PAGE)
+    {
+        nrt_Arena * volatile *entry = mapEntry(page, 0);
+        if (entry)
+            ARENA_STORE(*entry, arena);
+    }
+
+    nrt_Mutex_unlock(GET_MUTEX());
+    return ok;
+}
+
+/*
+ *  Takes a chunk from the allocator that has room for size bytes after
+ *  its header, and maps it to the arena
+ */
+NRTPRIV(char *) addChunk(nrt_Arena *arena, size_t size)
+{
+    const nrt_Allocator *allocator = nrt_Memory_getAllocator();
+    size_t pages = (ARENA_CHUNK_HEADER + size + ARENA_PAGE - 1) &
+        ~(ARENA_PAGE - 1);
+    char *raw;
+    ArenaChunk *chunk;
+
+    /* one more page to line the chunk up with a page */
+    raw = (char *) allocator->allocate(allocator->data, pages + ARENA_PAGE);
+    if (!raw)
+        return NULL;
+
+    chunk = (ArenaChunk *) (((size_t) raw + ARENA_PAGE - 1) &
+                            ~(ARENA_PAGE - 1));
+    chunk->raw = raw;
+    chunk->size = pages;
+    if (!mapChunk(chunk, arena))
+    {
+        allocator->release(allocator->data, raw);
+        return NULL;
+    }
+
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->size += pages + ARENA_PAGE;
+    return (char *) chunk + ARENA_CHUNK_HEADER;
+}
+
+
+NRTAPI(nrt_Arena *) nrt_Arena_construct(size_t chunkSize, nrt_Error * error)
+{
+    const nrt_Allocator *allocator = nrt_Memory_getAllocator();
+    nrt_Arena *arena =
+        (nrt_Arena *) allocator->allocate(allocator->data, sizeof(nrt_Arena));
+    if (!arena)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NULL;
+    }
+
+    arena->chunks = NULL;
+    arena->next = NULL;
+    arena->limit = NULL;
+    arena->chunkSize = chunkSize ? chunkSize : ARENA_DEFAULT_CHUNK;
+    if (arena->chunkSize < 16 * ARENA_ALIGN)
+        arena->chunkSize = 16 * ARENA_ALIGN;
+    arena->size = 0;
+    return arena;
+}
+
+
+NRTAPI(void) nrt_Arena_destruct(nrt_Arena ** arena)
+{
+    if (*arena)
+    {
+        const nrt_Allocator *allocator = nrt_Memory_getAllocator();
+        ArenaChunk *chunk = (*arena)->chunks;
+
+        /* the pages are unmapped before the allocator can hand them out */
+        while (chunk)
+        {
+            ArenaChunk *next = chunk->next;
+            mapChunk(chunk, NULL);
+            allocator->release(allocator->data, chunk->raw);
+            chunk = next;
+        }
+        allocator->release(allocator->data, *arena);
+        *arena = NULL;
+    }
+}
+
+
+NRTAPI(void *) nrt_Arena_malloc(nrt_Arena * arena, size_t size)
+{
+    size_t needed = ARENA_ALIGN +
+        ((size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1));
+    char *p = arena->next ? ARENA_ALIGN_UP(arena->next) : NULL;
+
+    if (!p || p > arena->limit || needed > (size_t) (arena->limit - p))
+    {
+        char *chunk;
+
+        /* big ones get a chunk of their own, and the current one stays */
+        if (needed > arena->chunkSize / 4)
+        {
+            chunk = addChunk(arena, needed);
+            if (!chunk)
+                return NULL;
+            p = ARENA_ALIGN_UP(chunk);
+            *(size_t *) p = size;
+            return p + ARENA_ALIGN;
+        }
+
+        chunk = addChunk(arena, arena->chunkSize);
+        if (!chunk)
+            return NULL;
+        arena->next = chunk;
+        arena->limit = chunk + arena->chunkSize;
+        if (arena->chunkSize < ARENA_MAX_CHUNK)
+            arena->chunkSize *= 2;
+        p = ARENA_ALIGN_UP(chunk);
+    }
+
+    *(size_t *) p = size;
+    arena->next = p + needed;
+    return p + ARENA_ALIGN;
+}
+
+
+NRTAPI(nrt_Arena *) nrt_Arena_find(const void *ptr)
+{
+    nrt_Arena * volatile *entry;
+
+    if (!ptr)
+        return NULL;
+
+    /* only reads the map, so it takes no lock */
+    entry = mapEntry(ptr, 0);
+    return entry ? ARENA_LOAD(*entry) : NULL;
+}
+
+
+NRTAPI(size_t) nrt_Arena_getSize(const nrt_Arena * arena)
+{
+    return arena->size;
+}
+
+
+NRTPROT(size_t) nrt_Arena_getAllocationSize(const void *ptr)
+{
+    return *(const size_t *) ((const char *) ptr - ARENA_ALIGN);
+}
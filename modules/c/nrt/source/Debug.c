@@ -21,6 +21,7 @@
  */
 
 #include "nrt/Debug.h"
+#include "nrt/Memory.h"
 
 #ifdef NRT_DEBUG
 
@@ -48,7 +49,7 @@ NRTPROT(void *) nrt_Debug_malloc(const char *file, int line, size_t sz)
 
     fprintf(f, "REQUEST: malloc\t[%d]\n", sz);
 
-    p = malloc(sz);
+    p = nrt_Memory_malloc(sz);
     fprintf(f, "\tMALLOC\t%p\t%d\t%s\t%d\n", p, sz, file, line);
 
     fclose(f);
@@ -73,7 +74,7 @@ NRTPROT(void *) nrt_Debug_realloc(const char *file, int line, void *ptr,
     assert(f);
 
     fprintf(f, "REQUEST: realloc\t[%p]\t[%d]\n", ptr, sz);
-    p = realloc(ptr, sz);
+    p = nrt_Memory_realloc(ptr, sz);
     fprintf(f, "\tREALLOC\t%p\t%p\t%d\t%s\t%d\n", p, ptr, sz, file, line);
 
     fclose(f);
@@ -97,7 +98,7 @@ NRTPROT(void) nrt_Debug_free(const char *file, int line, void *ptr)
 
     fprintf(f, "REQUEST: free\t[%p]\n", ptr);
 
-    free(ptr);
+    nrt_Memory_free(ptr);
 
     fprintf(f, "\tFREE\t%s\t%d\n", file, line);
 
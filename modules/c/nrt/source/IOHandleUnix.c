@@ -22,8 +22,26 @@
 
 #ifndef WIN32
 
+/* copy_file_range() is only declared for GNU sources */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "nrt/IOHandle.h"
 
+#ifdef HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+/* Largest single request handed to the kernel copy calls */
+#define NRT_IO_KERNEL_COPY_MAX ((size_t)1 << 30)
+
 NRTAPI(nrt_IOHandle) nrt_IOHandle_create(const char *fname,
                                          nrt_AccessFlags access,
                                          nrt_CreationFlags creation,
@@ -155,6 +173,675 @@ NRTAPI(nrt_Off) nrt_IOHandle_getSize(nrt_IOHandle handle, nrt_Error * error)
     return buf.st_size;
 }
 
+/* A time from struct stat in nanoseconds; which is m or c */
+#ifdef __APPLE__
+#define NRT_STAT_TIME(buf, which) \
+    ((nrt_Int64) (buf).st_##which##timespec.tv_sec * 1000000000 + \
+     (buf).st_##which##timespec.tv_nsec)
+#else
+#define NRT_STAT_TIME(buf, which) \
+    ((nrt_Int64) (buf).st_##which##tim.tv_sec * 1000000000 + \
+     (buf).st_##which##tim.tv_nsec)
+#endif
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_getStamp(nrt_IOHandle handle,
+                                       nrt_FileStamp * stamp,
+                                       nrt_Error * error)
+{
+    struct stat buf;
+    if (fstat(handle, &buf) == -1)
+    {
+        nrt_Error_init(error, strerror(errno), NRT_CTXT, NRT_ERR_STAT_FILE);
+        return NRT_FAILURE;
+    }
+    stamp->device = (nrt_Uint64) buf.st_dev;
+    stamp->inode = (nrt_Uint64) buf.st_ino;
+    stamp->modified = NRT_STAT_TIME(buf, m);
+    stamp->changed = NRT_STAT_TIME(buf, c);
+    return NRT_SUCCESS;
+}
+
+/*
+ *  True if the errno from a kernel copy means that this kind of copy is not
+ *  possible between these handles, rather than that the I/O failed
+ */
+NRTPRIV(NRT_BOOL) kernelCopyUnsupported(int err)
+{
+    return err == ENOSYS || err == EXDEV || err == EINVAL || err == EBADF
+#ifdef EOPNOTSUPP
+        || err == EOPNOTSUPP
+#endif
+        ;
+}
+
+NRTAPI(nrt_Off) nrt_IOHandle_copy(nrt_IOHandle input, nrt_IOHandle output,
+                                  nrt_Uint64 size, nrt_Error * error)
+{
+    nrt_Uint64 copied = 0;
+#if defined(HAVE_COPY_FILE_RANGE) || defined(HAVE_SENDFILE)
+    ssize_t bytesThisCopy;
+    size_t request;
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+    while (copied < size)
+    {
+        request = (size - copied) > NRT_IO_KERNEL_COPY_MAX ?
+            NRT_IO_KERNEL_COPY_MAX : (size_t)(size - copied);
+        bytesThisCopy = copy_file_range(input, NULL, output, NULL, request, 0);
+        if (bytesThisCopy > 0)
+            copied += (nrt_Uint64)bytesThisCopy;
+        else if (bytesThisCopy == 0 || kernelCopyUnsupported(errno))
+            break;
+        else if (errno != EINTR && errno != EAGAIN)
+            goto CATCH_ERROR;
+    }
+#endif
+
+#ifdef HAVE_SENDFILE
+    while (copied < size)
+    {
+        request = (size - copied) > NRT_IO_KERNEL_COPY_MAX ?
+            NRT_IO_KERNEL_COPY_MAX : (size_t)(size - copied);
+        bytesThisCopy = sendfile(output, input, NULL, request);
+        if (bytesThisCopy > 0)
+            copied += (nrt_Uint64)bytesThisCopy;
+        else if (bytesThisCopy == 0 || kernelCopyUnsupported(errno))
+            break;
+        else if (errno != EINTR && errno != EAGAIN)
+            goto CATCH_ERROR;
+    }
+#endif
+
+#if !defined(HAVE_COPY_FILE_RANGE) && !defined(HAVE_SENDFILE)
+    /* Silence compiler warnings about unused variables */
+    (void)input;
+    (void)output;
+    (void)size;
+    (void)error;
+#endif
+    return (nrt_Off)copied;
+
+#if defined(HAVE_COPY_FILE_RANGE) || defined(HAVE_SENDFILE)
+    CATCH_ERROR:
+    nrt_Error_init(error, strerror(errno), NRT_CTXT, NRT_ERR_WRITING_TO_FILE);
+    return -1;
+#endif
+}
+
+/*
+ *  Reads all of one request with pread, which leaves the file position
+ *  alone.  Returns 0 on success, an errno value on failure, or -1 on a
+ *  read past the end of the file.
+ */
+NRTPRIV(int) preadFully(int fd, char *buf, size_t size, nrt_Off offset)
+{
+    while (size > 0)
+    {
+        ssize_t bytesRead = pread(fd, buf, size, offset);
+        if (bytesRead > 0)
+        {
+            buf += bytesRead;
+            size -= (size_t)bytesRead;
+            offset += bytesRead;
+        }
+        else if (bytesRead == 0)
+            return -1;
+        else if (errno != EINTR && errno != EAGAIN)
+            return errno;
+    }
+    return 0;
+}
+
+NRTPRIV(NRT_BOOL) batchReadFailed(int err, nrt_Error * error)
+{
+    if (err == -1)
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
+    else
+        nrt_Error_init(error, strerror(err), NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
+    return NRT_FAILURE;
+}
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(__NR_io_uring_setup)
+#define NRT_IO_HAVE_URING
+#endif
+
+/* Number of threads, counting the caller, used for a batch without io_uring */
+#define NRT_IO_BATCH_THREADS 8
+
+typedef struct _BatchControl
+{
+    int fd;
+    const nrt_IORequest *requests;
+    size_t numRequests;
+    size_t next;
+    int err;
+    nrt_Mutex lock;
+    struct _BatchControl *nextJob;  /* The next job posted to the pool */
+    size_t helpers;                 /* Pool workers on the job */
+    NRT_BOOL drained;               /* No requests are left to hand out */
+} BatchControl;
+
+#ifdef NRT_IO_HAVE_URING
+
+/* Number of reads kept in flight through io_uring */
+#define NRT_IO_URING_DEPTH 64
+
+/* Largest single read handed to io_uring; the rest is read with pread */
+#define NRT_IO_URING_READ_MAX ((size_t)1 << 30)
+
+/*
+ *  An io_uring and its mappings
+ */
+typedef struct _BatchRing
+{
+    int fd;                     /* The ring, or -1 */
+    char *sq;
+    char *cq;
+    size_t sqSize;
+    size_t cqSize;
+    struct io_uring_sqe *sqes;
+    unsigned sqEntries;
+    unsigned *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    struct io_uring_cqe *cqes;
+} BatchRing;
+
+NRTPRIV(void) ringClose(BatchRing *ring)
+{
+    if (ring->sqes)
+        munmap(ring->sqes, ring->sqEntries * sizeof(struct io_uring_sqe));
+    if (ring->cq && ring->cq != ring->sq)
+        munmap(ring->cq, ring->cqSize);
+    if (ring->sq)
+        munmap(ring->sq, ring->sqSize);
+    if (ring->fd >= 0)
+        close(ring->fd);
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+/*
+ *  Sets up the ring.  Fails when io_uring cannot be used here (old kernel,
+ *  or forbidden by a seccomp policy).
+ */
+NRTPRIV(NRT_BOOL) ringOpen(BatchRing *ring)
+{
+    struct io_uring_params params;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, NRT_IO_URING_DEPTH, &params);
+    if (ring->fd < 0)
+    {
+        ring->fd = -1;
+        return NRT_FAILURE;
+    }
+
+    ring->sqEntries = params.sq_entries;
+    ring->sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqSize = params.cq_off.cqes +
+        params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cqSize > ring->sqSize)
+            ring->sqSize = ring->cqSize;
+        ring->cqSize = ring->sqSize;
+    }
+
+    ring->sq = (char *)mmap(NULL, ring->sqSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->fd,
+                            IORING_OFF_SQ_RING);
+    if (ring->sq == MAP_FAILED)
+    {
+        ring->sq = NULL;
+        goto CATCH_ERROR;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cq = ring->sq;
+    else
+    {
+        ring->cq = (char *)mmap(NULL, ring->cqSize, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, ring->fd,
+                                IORING_OFF_CQ_RING);
+        if (ring->cq == MAP_FAILED)
+        {
+            ring->cq = NULL;
+            goto CATCH_ERROR;
+        }
+    }
+    ring->sqes = (struct io_uring_sqe *)mmap(NULL,
+        params.sq_entries * sizeof(struct io_uring_sqe),
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+        IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        ring->sqes = NULL;
+        goto CATCH_ERROR;
+    }
+
+    ring->sqTail = (unsigned *)(ring->sq + params.sq_off.tail);
+    ring->sqMask = (unsigned *)(ring->sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned *)(ring->sq + params.sq_off.array);
+    ring->cqHead = (unsigned *)(ring->cq + params.cq_off.head);
+    ring->cqTail = (unsigned *)(ring->cq + params.cq_off.tail);
+    ring->cqMask = (unsigned *)(ring->cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(ring->cq + params.cq_off.cqes);
+    return NRT_SUCCESS;
+
+CATCH_ERROR:
+    ringClose(ring);
+    return NRT_FAILURE;
+}
+
+/*
+ *  Runs the batch through the ring.  Returns 1 on success, 0 on failure
+ *  with *err set, and -1 when the kernel turns the reads down, in which
+ *  case nothing useful has been read and the caller should fall back.
+ *  Nothing is left queued or in flight when this returns, so the ring can
+ *  be used again.
+ */
+NRTPRIV(int) uringReadBatch(BatchRing *ring, int fd,
+                            const nrt_IORequest *requests,
+                            size_t numRequests, int *err)
+{
+    size_t next = 0;
+    size_t completed = 0;
+    unsigned inFlight = 0;
+    unsigned pending = 0;
+    NRT_BOOL unsupported = 0;
+
+    *err = 0;
+    for (;;)
+    {
+        unsigned tail = *ring->sqTail;
+        unsigned head;
+        int submitted;
+        NRT_BOOL stopping = unsupported || *err != 0;
+
+        /* Top the ring up, unless we are only waiting for it to drain */
+        while (!stopping && next < numRequests &&
+               inFlight + pending < ring->sqEntries)
+        {
+            unsigned index = tail & *ring->sqMask;
+            struct io_uring_sqe *sqe = &ring->sqes[index];
+            size_t size = requests[next].size < NRT_IO_URING_READ_MAX ?
+                requests[next].size : NRT_IO_URING_READ_MAX;
+
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = fd;
+            sqe->off = (unsigned long long)requests[next].offset;
+            sqe->addr = (unsigned long long)(size_t)requests[next].buf;
+            sqe->len = (unsigned)size;
+            sqe->user_data = next;
+            ring->sqArray[index] = index;
+            ++tail;
+            ++next;
+            ++pending;
+        }
+
+        /* Take back what the kernel has not picked up, or the next batch */
+        /* would submit it */
+        if (stopping && pending > 0)
+        {
+            tail -= pending;
+            pending = 0;
+        }
+        __atomic_store_n(ring->sqTail, tail, __ATOMIC_RELEASE);
+
+        /* Buffers must not be given back while the kernel still owns them */
+        if (inFlight == 0 && pending == 0)
+            break;
+
+        submitted = (int)syscall(__NR_io_uring_enter, ring->fd, pending, 1,
+                                 IORING_ENTER_GETEVENTS, NULL, 0);
+        if (submitted < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            if (completed == 0 && inFlight == 0)
+                unsupported = 1;
+            else if (*err == 0)
+                *err = errno;
+            continue;
+        }
+        pending -= (unsigned)submitted;
+        inFlight += (unsigned)submitted;
+
+        head = *ring->cqHead;
+        while (head != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE))
+        {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cqMask];
+            const nrt_IORequest *request = &requests[cqe->user_data];
+            int result = cqe->res;
+
+            if (result == -EINVAL || result == -EOPNOTSUPP)
+                /* The kernel does not know IORING_OP_READ */
+                unsupported = 1;
+            else if (result < 0)
+            {
+                if (*err == 0)
+                    *err = -result;
+            }
+            else if ((size_t)result < request->size && *err == 0)
+            {
+                /* Short read, or a very large one; finish it directly */
+                *err = preadFully(fd, (char *)request->buf + result,
+                                  request->size - (size_t)result,
+                                  request->offset + result);
+            }
+            ++head;
+            ++completed;
+            --inFlight;
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    if (*err != 0)
+        return 0;
+    return unsupported ? -1 : 1;
+}
+#endif
+
+/*
+ *  The workers shared by every thread that reads a batch without a ring.
+ *  There are at most NRT_IO_BATCH_THREADS - 1 of them in the process,
+ *  started the first time they are needed.  Each helps with the oldest job
+ *  that still has requests to hand out, so batches from several threads are
+ *  worked on together rather than each thread having a pool of its own.
+ */
+typedef struct _BatchPool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* Signaled when a job is posted */
+    pthread_cond_t done;        /* Signaled when a worker leaves a job */
+    pthread_t workers[NRT_IO_BATCH_THREADS - 1];
+    size_t numWorkers;
+    NRT_BOOL workersStarted;
+    BatchControl *jobs;         /* Jobs posted and not yet taken back */
+} BatchPool;
+
+static BatchPool batchPool = { PTHREAD_MUTEX_INITIALIZER,
+                               PTHREAD_COND_INITIALIZER,
+                               PTHREAD_COND_INITIALIZER };
+static pthread_once_t batchOnce = PTHREAD_ONCE_INIT;
+
+#ifdef NRT_IO_HAVE_URING
+/*
+ *  A thread's ring, set up on its first batch and closed when it exits
+ */
+typedef struct _BatchContext
+{
+    BatchRing ring;
+    NRT_BOOL ringTried;         /* The ring was set up, or could not be */
+} BatchContext;
+
+static pthread_key_t batchKey;
+static NRT_BOOL batchKeyCreated = 0;
+#endif
+
+/* Each worker takes the next outstanding request until there are none */
+NRTPRIV(void) batchWork(BatchControl *control)
+{
+    for (;;)
+    {
+        const nrt_IORequest *request = NULL;
+        int err;
+
+        nrt_Mutex_lock(&control->lock);
+        if (control->err == 0 && control->next < control->numRequests)
+            request = &control->requests[control->next++];
+        nrt_Mutex_unlock(&control->lock);
+        if (!request)
+            break;
+
+        err = preadFully(control->fd, (char *)request->buf, request->size,
+                         request->offset);
+        if (err != 0)
+        {
+            nrt_Mutex_lock(&control->lock);
+            if (control->err == 0)
+                control->err = err;
+            nrt_Mutex_unlock(&control->lock);
+        }
+    }
+}
+
+/* Returns the oldest job with requests left to hand out; locked by caller */
+NRTPRIV(BatchControl *) nextJob(void)
+{
+    BatchControl *job;
+
+    for (job = batchPool.jobs; job; job = job->nextJob)
+        if (!job->drained)
+            return job;
+    return NULL;
+}
+
+/* A pooled worker helps with whatever jobs are posted, for good */
+NRTPRIV(void *) batchWorker(void *data)
+{
+    (void)data;
+    pthread_mutex_lock(&batchPool.lock);
+    for (;;)
+    {
+        BatchControl *job;
+
+        while ((job = nextJob()) == NULL)
+            pthread_cond_wait(&batchPool.wake, &batchPool.lock);
+        ++job->helpers;
+        pthread_mutex_unlock(&batchPool.lock);
+
+        batchWork(job);
+
+        pthread_mutex_lock(&batchPool.lock);
+        job->drained = 1;
+        if (--job->helpers == 0)
+            pthread_cond_broadcast(&batchPool.done);
+    }
+    return NULL;
+}
+
+/*
+ *  Keeps the pool consistent across fork.  Only the forking thread goes on
+ *  in the child, so the workers, their jobs and the thread's ring, whose
+ *  kernel state the child would share with the parent, are all forgotten
+ *  there and set up again on the child's first batch.
+ */
+NRTPRIV(void) batchForkPrepare(void)
+{
+    pthread_mutex_lock(&batchPool.lock);
+}
+
+NRTPRIV(void) batchForkParent(void)
+{
+    pthread_mutex_unlock(&batchPool.lock);
+}
+
+NRTPRIV(void) batchForkChild(void)
+{
+#ifdef NRT_IO_HAVE_URING
+    BatchContext *context = batchKeyCreated ?
+        (BatchContext *)pthread_getspecific(batchKey) : NULL;
+    if (context)
+    {
+        ringClose(&context->ring);
+        context->ringTried = 0;
+    }
+#endif
+    pthread_mutex_init(&batchPool.lock, NULL);
+    pthread_cond_init(&batchPool.wake, NULL);
+    pthread_cond_init(&batchPool.done, NULL);
+    batchPool.numWorkers = 0;
+    batchPool.workersStarted = 0;
+    batchPool.jobs = NULL;
+}
+
+#ifdef NRT_IO_HAVE_URING
+NRTPRIV(void) batchContextDestruct(void *data)
+{
+    BatchContext *context = (BatchContext *)data;
+
+    ringClose(&context->ring);
+    free(context);
+}
+#endif
+
+NRTPRIV(void) batchInit(void)
+{
+#ifdef NRT_IO_HAVE_URING
+    batchKeyCreated =
+        pthread_key_create(&batchKey, &batchContextDestruct) == 0;
+#endif
+    pthread_atfork(&batchForkPrepare, &batchForkParent, &batchForkChild);
+}
+
+#ifdef NRT_IO_HAVE_URING
+/*
+ *  Returns this thread's context, or NULL if it cannot have one.  It
+ *  lives as long as the thread, not as any arena or allocator, so it comes
+ *  straight from calloc.
+ */
+NRTPRIV(BatchContext *) getBatchContext(void)
+{
+    BatchContext *context;
+
+    if (!batchKeyCreated)
+        return NULL;
+
+    context = (BatchContext *)pthread_getspecific(batchKey);
+    if (context)
+        return context;
+
+    context = (BatchContext *)calloc(1, sizeof(BatchContext));
+    if (!context)
+        return NULL;
+    context->ring.fd = -1;
+    if (pthread_setspecific(batchKey, context) != 0)
+    {
+        batchContextDestruct(context);
+        return NULL;
+    }
+    return context;
+}
+#endif
+
+/* Runs the job on the shared pool, with the caller working too */
+NRTPRIV(void) poolRun(BatchControl *control)
+{
+    BatchControl **link;
+
+    control->helpers = 0;
+    control->drained = 0;
+
+    pthread_mutex_lock(&batchPool.lock);
+
+    /* A thread that fails to start costs nothing but its share */
+    if (!batchPool.workersStarted)
+    {
+        while (batchPool.numWorkers < NRT_IO_BATCH_THREADS - 1 &&
+               pthread_create(&batchPool.workers[batchPool.numWorkers],
+                              NULL, &batchWorker, NULL) == 0)
+        {
+            pthread_detach(batchPool.workers[batchPool.numWorkers]);
+            ++batchPool.numWorkers;
+        }
+        batchPool.workersStarted = 1;
+    }
+
+    control->nextJob = NULL;
+    for (link = &batchPool.jobs; *link; link = &(*link)->nextJob)
+        ;
+    *link = control;
+    pthread_cond_broadcast(&batchPool.wake);
+    pthread_mutex_unlock(&batchPool.lock);
+
+    batchWork(control);
+
+    /* Take the job back once no worker is still reading into its buffers */
+    pthread_mutex_lock(&batchPool.lock);
+    control->drained = 1;
+    while (control->helpers > 0)
+        pthread_cond_wait(&batchPool.done, &batchPool.lock);
+    for (link = &batchPool.jobs; *link != control; link = &(*link)->nextJob)
+        ;
+    *link = control->nextJob;
+    pthread_mutex_unlock(&batchPool.lock);
+}
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_readBatch(nrt_IOHandle handle,
+                                        const nrt_IORequest *requests,
+                                        size_t numRequests,
+                                        nrt_Error * error)
+{
+#ifdef NRT_IO_HAVE_URING
+    BatchContext *context;
+#endif
+    BatchControl control;
+
+    if (numRequests == 0)
+        return NRT_SUCCESS;
+
+    if (numRequests == 1)
+    {
+        int err = preadFully(handle, (char *)requests[0].buf,
+                             requests[0].size, requests[0].offset);
+        return err == 0 ? NRT_SUCCESS : batchReadFailed(err, error);
+    }
+
+    pthread_once(&batchOnce, &batchInit);
+
+#ifdef NRT_IO_HAVE_URING
+    context = getBatchContext();
+    if (context && !context->ringTried)
+    {
+        context->ringTried = 1;
+        ringOpen(&context->ring);
+    }
+    if (context && context->ring.fd >= 0)
+    {
+        int err;
+        int rc = uringReadBatch(&context->ring, handle, requests,
+                                numRequests, &err);
+        if (rc == 1)
+            return NRT_SUCCESS;
+        if (rc == 0)
+            return batchReadFailed(err, error);
+
+        /* Turned down once, it will be again */
+        ringClose(&context->ring);
+    }
+#endif
+
+    control.fd = handle;
+    control.requests = requests;
+    control.numRequests = numRequests;
+    control.next = 0;
+    control.err = 0;
+    nrt_Mutex_init(&control.lock);
+
+    poolRun(&control);
+
+    nrt_Mutex_delete(&control.lock);
+    return control.err == 0 ? NRT_SUCCESS :
+        batchReadFailed(control.err, error);
+}
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_truncate(nrt_IOHandle handle, nrt_Off size,
+                                       nrt_Error * error)
+{
+    if (ftruncate(handle, size) != 0)
+    {
+        nrt_Error_init(error, strerror(errno), NRT_CTXT,
+                       NRT_ERR_WRITING_TO_FILE);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
 NRTAPI(void) nrt_IOHandle_close(nrt_IOHandle handle)
 {
     close(handle);
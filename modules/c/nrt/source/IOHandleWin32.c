@@ -175,6 +175,95 @@ NRTAPI(nrt_Off) nrt_IOHandle_getSize(nrt_IOHandle handle, nrt_Error * error)
     return (nrt_Off)((off << 32) + ret);
 }
 
+/* A FILETIME, which counts 100ns ticks from 1601, in ns from the epoch */
+NRTPRIV(nrt_Int64) fileTimeToNanoseconds(const FILETIME * time)
+{
+    nrt_Uint64 ticks = ((nrt_Uint64)time->dwHighDateTime << 32) +
+        time->dwLowDateTime;
+    return ((nrt_Int64)ticks - NRT_INT64(116444736000000000)) * 100;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_getStamp(nrt_IOHandle handle,
+                                       nrt_FileStamp * stamp,
+                                       nrt_Error * error)
+{
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(handle, &info))
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_STAT_FILE,
+                        "GetFileInformationByHandle failed with error [%d]",
+                        GetLastError());
+        return NRT_FAILURE;
+    }
+
+    stamp->device = info.dwVolumeSerialNumber;
+    stamp->inode = ((nrt_Uint64)info.nFileIndexHigh << 32) +
+        info.nFileIndexLow;
+    stamp->modified = fileTimeToNanoseconds(&info.ftLastWriteTime);
+    stamp->changed = fileTimeToNanoseconds(&info.ftCreationTime);
+    return NRT_SUCCESS;
+}
+
+NRTAPI(nrt_Off) nrt_IOHandle_copy(nrt_IOHandle input, nrt_IOHandle output,
+                                  nrt_Uint64 size, nrt_Error * error)
+{
+    /* There is no kernel side copy between arbitrary handles here */
+    (void)input;
+    (void)output;
+    (void)size;
+    (void)error;
+    return 0;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_readBatch(nrt_IOHandle handle,
+                                        const nrt_IORequest *requests,
+                                        size_t numRequests,
+                                        nrt_Error * error)
+{
+    /*
+     * Handles are not opened for overlapped I/O, so the requests are read
+     * one at a time, keeping the file position as it was
+     */
+    size_t i;
+    nrt_Off position = nrt_IOHandle_tell(handle, error);
+    if (!NRT_IO_SUCCESS(position))
+        return NRT_FAILURE;
+
+    for (i = 0; i < numRequests; ++i)
+    {
+        if (!NRT_IO_SUCCESS(nrt_IOHandle_seek(handle, requests[i].offset,
+                                              FILE_BEGIN, error)) ||
+            !nrt_IOHandle_read(handle, requests[i].buf, requests[i].size,
+                               error))
+            return NRT_FAILURE;
+    }
+    return NRT_IO_SUCCESS(nrt_IOHandle_seek(handle, position, FILE_BEGIN,
+                                            error));
+}
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_truncate(nrt_IOHandle handle, nrt_Off size,
+                                       nrt_Error * error)
+{
+    LARGE_INTEGER largeInt;
+    LARGE_INTEGER position;
+
+    /* SetEndOfFile works at the file pointer, so put it back afterwards */
+    largeInt.QuadPart = 0;
+    if (!SetFilePointerEx(handle, largeInt, &position, FILE_CURRENT))
+        goto CATCH_ERROR;
+    largeInt.QuadPart = size;
+    if (!SetFilePointerEx(handle, largeInt, NULL, FILE_BEGIN) ||
+        !SetEndOfFile(handle) ||
+        !SetFilePointerEx(handle, position, NULL, FILE_BEGIN))
+        goto CATCH_ERROR;
+    return NRT_SUCCESS;
+
+CATCH_ERROR:
+    nrt_Error_initf(error, NRT_CTXT, NRT_ERR_WRITING_TO_FILE,
+                    "SetEndOfFile failed with error [%d]", GetLastError());
+    return NRT_FAILURE;
+}
+
 NRTAPI(void) nrt_IOHandle_close(nrt_IOHandle handle)
 {
     CloseHandle(handle);
@@ -22,6 +22,7 @@
 
 
 #include "nrt/IOInterface.h"
+#include "nrt/IOStats.h"
 
 NRT_CXX_GUARD typedef struct _IOHandleControl
 {
@@ -38,6 +39,30 @@ typedef struct _BufferIOControl
     NRT_BOOL ownBuf;
 } BufferIOControl;
 
+typedef struct _GrowableBufferIOControl
+{
+    char *buf;
+    size_t capacity;
+    size_t size;
+    size_t mark;
+} GrowableBufferIOControl;
+
+typedef struct _BufferedIOControl
+{
+    nrt_IOInterface *io;
+    char *buf;
+    size_t capacity;
+    size_t bufSize;
+    nrt_Off bufStart;
+    nrt_Off position;
+    nrt_Off ioPosition;
+    nrt_Off fileSize;
+    NRT_BOOL adopt;
+} BufferedIOControl;
+
+/* Size of the staging buffer used by nrt_IOInterface_copy */
+#define NRT_IO_COPY_BUFFER_SIZE (1024 * 1024)
+
 NRTAPI(NRT_BOOL) nrt_IOInterface_read(nrt_IOInterface * io, void* buf,
                                       size_t size, nrt_Error * error)
 {
@@ -98,7 +123,7 @@ NRTAPI(void) nrt_IOInterface_destruct(nrt_IOInterface ** io)
             if ((*io)->data)
             {
                 (*io)->iface->destruct((*io)->data);
-                free((*io)->data);
+                NRT_FREE((*io)->data);
                 (*io)->data = NULL;
             }
             (*io)->iface = NULL;
@@ -447,5 +472,794 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
     }
 }
 
+/* Smallest allocation made by a growable buffer adapter */
+#define NRT_GROWABLE_BUFFER_MIN_CAPACITY (4096)
+
+/*
+ *  Makes room for at least needed bytes, doubling the capacity so that a
+ *  long run of appends costs a logarithmic number of reallocations.
+ */
+NRTPRIV(NRT_BOOL) GrowableBufferAdapter_reserve(GrowableBufferIOControl *
+                                                control, size_t needed,
+                                                nrt_Error * error)
+{
+    size_t capacity;
+    char *buf;
+
+    if (needed <= control->capacity && control->buf)
+        return NRT_SUCCESS;
+
+    capacity = control->capacity ? control->capacity :
+        NRT_GROWABLE_BUFFER_MIN_CAPACITY;
+    while (capacity < needed)
+    {
+        if (capacity > ((size_t) -1) / 2)
+        {
+            capacity = needed;
+            break;
+        }
+        capacity *= 2;
+    }
+
+    buf = (char *) NRT_REALLOC(control->buf, capacity);
+    if (!buf)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+    control->buf = buf;
+    control->capacity = capacity;
+    return NRT_SUCCESS;
+}
+
+/*
+ *  Makes [mark, mark + size) writable, zero-filling any gap left by a seek
+ *  past the end, and extends the size to cover it.
+ */
+NRTPRIV(char *) GrowableBufferAdapter_extend(GrowableBufferIOControl * control,
+                                             size_t size, nrt_Error * error)
+{
+    char *dest;
+
+    if (size > ((size_t) -1) - control->mark)
+    {
+        nrt_Error_init(error, "Invalid size requested", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NULL;
+    }
+    if (!GrowableBufferAdapter_reserve(control, control->mark + size, error))
+        return NULL;
+
+    if (control->mark > control->size)
+        memset(control->buf + control->size, 0,
+               control->mark - control->size);
+
+    dest = control->buf + control->mark;
+    control->mark += size;
+    if (control->mark > control->size)
+        control->size = control->mark;
+    return dest;
+}
+
+NRTPRIV(NRT_BOOL) GrowableBufferAdapter_read(NRT_DATA * data, void *buf,
+                                             size_t size, nrt_Error * error)
+{
+    GrowableBufferIOControl *control = (GrowableBufferIOControl *) data;
+
+    if (control->mark > control->size || size > control->size - control->mark)
+    {
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+
+    if (size > 0)
+    {
+        memcpy(buf, control->buf + control->mark, size);
+        control->mark += size;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) GrowableBufferAdapter_write(NRT_DATA * data, const void *buf,
+                                              size_t size, nrt_Error * error)
+{
+    GrowableBufferIOControl *control = (GrowableBufferIOControl *) data;
+    char *dest;
+
+    if (size == 0)
+        return NRT_SUCCESS;
+
+    dest = GrowableBufferAdapter_extend(control, size, error);
+    if (!dest)
+        return NRT_FAILURE;
+    memcpy(dest, buf, size);
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) GrowableBufferAdapter_canSeek(NRT_DATA * data,
+                                                nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(nrt_Off) GrowableBufferAdapter_seek(NRT_DATA * data, nrt_Off offset,
+                                            int whence, nrt_Error * error)
+{
+    GrowableBufferIOControl *control = (GrowableBufferIOControl *) data;
+    nrt_Off base;
+
+    if (whence == NRT_SEEK_SET)
+        base = 0;
+    else if (whence == NRT_SEEK_CUR)
+        base = (nrt_Off) control->mark;
+    else if (whence == NRT_SEEK_END)
+        base = (nrt_Off) control->size;
+    else
+    {
+        nrt_Error_init(error, "Invalid/unsupported seek directive", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return -1;
+    }
+
+    /* Seeking past the end is allowed; a write there zero-fills the gap */
+    if (base + offset < 0)
+    {
+        nrt_Error_init(error, "Invalid offset requested", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return -1;
+    }
+    control->mark = (size_t) (base + offset);
+    return (nrt_Off) control->mark;
+}
+
+NRTPRIV(nrt_Off) GrowableBufferAdapter_tell(NRT_DATA * data,
+                                            nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return (nrt_Off) ((GrowableBufferIOControl *) data)->mark;
+}
+
+NRTPRIV(nrt_Off) GrowableBufferAdapter_getSize(NRT_DATA * data,
+                                               nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return (nrt_Off) ((GrowableBufferIOControl *) data)->size;
+}
+
+NRTPRIV(int) GrowableBufferAdapter_getMode(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_ACCESS_READWRITE;
+}
+
+NRTPRIV(NRT_BOOL) GrowableBufferAdapter_close(NRT_DATA * data,
+                                              nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    /* nothing */
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(void) GrowableBufferAdapter_destruct(NRT_DATA * data)
+{
+    GrowableBufferIOControl *control = (GrowableBufferIOControl *) data;
+    if (control && control->buf)
+    {
+        NRT_FREE(control->buf);
+        control->buf = NULL;
+    }
+}
+
+NRTAPI(nrt_IOInterface *) nrt_GrowableBufferAdapter_construct(size_t capacity,
+                                                              nrt_Error *
+                                                              error)
+{
+    static nrt_IIOInterface growableInterface = {
+        &GrowableBufferAdapter_read,
+        &GrowableBufferAdapter_write,
+        &GrowableBufferAdapter_canSeek,
+        &GrowableBufferAdapter_seek,
+        &GrowableBufferAdapter_tell,
+        &GrowableBufferAdapter_getSize,
+        &GrowableBufferAdapter_getMode,
+        &GrowableBufferAdapter_close,
+        &GrowableBufferAdapter_destruct
+    };
+    nrt_IOInterface *impl = NULL;
+    GrowableBufferIOControl *control = NULL;
+
+    impl = (nrt_IOInterface *) NRT_MALLOC(sizeof(nrt_IOInterface));
+    if (!impl)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(impl, 0, sizeof(nrt_IOInterface));
+
+    control = (GrowableBufferIOControl *)
+        NRT_MALLOC(sizeof(GrowableBufferIOControl));
+    if (!control)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(control, 0, sizeof(GrowableBufferIOControl));
+
+    impl->data = (NRT_DATA *) control;
+    impl->iface = &growableInterface;
+
+    if (capacity > 0 &&
+        !GrowableBufferAdapter_reserve(control, capacity, error))
+        goto CATCH_ERROR;
+    return impl;
+
+    CATCH_ERROR:
+    {
+        if (impl)
+            nrt_IOInterface_destruct(&impl);
+        return NULL;
+    }
+}
+
+NRTAPI(char *) nrt_GrowableBufferAdapter_getBuffer(nrt_IOInterface * io,
+                                                   size_t * size,
+                                                   nrt_Error * error)
+{
+    GrowableBufferIOControl *control;
+
+    if (io->iface->write != &GrowableBufferAdapter_write)
+    {
+        nrt_Error_init(error, "Not a growable buffer IO interface", NRT_CTXT,
+                       NRT_ERR_INVALID_OBJECT);
+        return NULL;
+    }
+
+    control = (GrowableBufferIOControl *) io->data;
+    if (!GrowableBufferAdapter_reserve(control, 1, error))
+        return NULL;
+    *size = control->size;
+    return control->buf;
+}
+
+NRTAPI(char *) nrt_GrowableBufferAdapter_release(nrt_IOInterface * io,
+                                                 size_t * size,
+                                                 nrt_Error * error)
+{
+    GrowableBufferIOControl *control;
+    char *buf = nrt_GrowableBufferAdapter_getBuffer(io, size, error);
+
+    if (!buf)
+        return NULL;
+
+    control = (GrowableBufferIOControl *) io->data;
+    control->buf = NULL;
+    control->capacity = 0;
+    control->size = 0;
+    control->mark = 0;
+    return buf;
+}
+
+/* Moves the wrapped interface to the logical position, if it is not there */
+NRTPRIV(NRT_BOOL) BufferedAdapter_sync(BufferedIOControl * control,
+                                       nrt_Error * error)
+{
+    if (control->ioPosition != control->position)
+    {
+        if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(control->io,
+                                                 control->position,
+                                                 NRT_SEEK_SET, error)))
+            return NRT_FAILURE;
+        control->ioPosition = control->position;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) BufferedAdapter_read(NRT_DATA * data, void *buf,
+                                       size_t size, nrt_Error * error)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+    char *out = (char *) buf;
+
+    while (size > 0)
+    {
+        nrt_Off fill;
+
+        /* Serve whatever we can from the buffer */
+        if (control->position >= control->bufStart &&
+            control->position < control->bufStart +
+                                (nrt_Off) control->bufSize)
+        {
+            size_t start = (size_t) (control->position - control->bufStart);
+            size_t bytes = control->bufSize - start;
+            if (bytes > size)
+                bytes = size;
+            memcpy(out, control->buf + start, bytes);
+            out += bytes;
+            size -= bytes;
+            control->position += (nrt_Off) bytes;
+            continue;
+        }
+
+        if (control->fileSize < 0)
+        {
+            /* A size we cannot get is treated as nothing to buffer */
+            control->fileSize = nrt_IOInterface_getSize(control->io, error);
+            if (!NRT_IO_SUCCESS(control->fileSize))
+                control->fileSize = 0;
+        }
+
+        /*
+         * Refill, unless the read is big enough to go straight through or
+         * the size is unknown (and so is how much a refill could take)
+         */
+        fill = control->fileSize - control->position;
+        if (fill > (nrt_Off) control->capacity)
+            fill = (nrt_Off) control->capacity;
+        if (size >= control->capacity || fill < (nrt_Off) size)
+        {
+            if (!BufferedAdapter_sync(control, error) ||
+                !nrt_IOInterface_read(control->io, out, size, error))
+            {
+                control->ioPosition = -1;
+                return NRT_FAILURE;
+            }
+            control->position += (nrt_Off) size;
+            control->ioPosition = control->position;
+            return NRT_SUCCESS;
+        }
+
+        control->bufSize = 0;
+        if (!BufferedAdapter_sync(control, error) ||
+            !nrt_IOInterface_read(control->io, control->buf, (size_t) fill,
+                                  error))
+        {
+            control->ioPosition = -1;
+            return NRT_FAILURE;
+        }
+        control->bufStart = control->position;
+        control->bufSize = (size_t) fill;
+        control->ioPosition = control->position + fill;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) BufferedAdapter_write(NRT_DATA * data, const void *buf,
+                                        size_t size, nrt_Error * error)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+
+    /* The buffered bytes may be stale now, and so may the size */
+    control->bufSize = 0;
+    control->fileSize = -1;
+    if (!BufferedAdapter_sync(control, error) ||
+        !nrt_IOInterface_write(control->io, buf, size, error))
+    {
+        control->ioPosition = -1;
+        return NRT_FAILURE;
+    }
+    control->position += (nrt_Off) size;
+    control->ioPosition = control->position;
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) BufferedAdapter_canSeek(NRT_DATA * data,
+                                          nrt_Error * error)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+    return nrt_IOInterface_canSeek(control->io, error);
+}
+
+NRTPRIV(nrt_Off) BufferedAdapter_seek(NRT_DATA * data, nrt_Off offset,
+                                      int whence, nrt_Error * error)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+    nrt_Off position;
+
+    if (whence == NRT_SEEK_SET)
+        position = offset;
+    else if (whence == NRT_SEEK_CUR)
+        position = control->position + offset;
+    else
+    {
+        nrt_Off size = nrt_IOInterface_getSize(control->io, error);
+        if (!NRT_IO_SUCCESS(size))
+            return size;
+        position = size + offset;
+    }
+
+    if (position < 0)
+    {
+        nrt_Error_init(error, "Invalid offset requested", NRT_CTXT,
+                       NRT_ERR_SEEKING_IN_FILE);
+        return -1;
+    }
+    control->position = position;
+    return position;
+}
+
+NRTPRIV(nrt_Off) BufferedAdapter_tell(NRT_DATA * data, nrt_Error * error)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return control->position;
+}
+
+NRTPRIV(nrt_Off) BufferedAdapter_getSize(NRT_DATA * data, nrt_Error * error)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+    return nrt_IOInterface_getSize(control->io, error);
+}
+
+NRTPRIV(int) BufferedAdapter_getMode(NRT_DATA * data, nrt_Error * error)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+    return nrt_IOInterface_getMode(control->io, error);
+}
+
+NRTPRIV(NRT_BOOL) BufferedAdapter_close(NRT_DATA * data, nrt_Error * error)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+    control->bufSize = 0;
+    return nrt_IOInterface_close(control->io, error);
+}
+
+NRTPRIV(void) BufferedAdapter_destruct(NRT_DATA * data)
+{
+    BufferedIOControl *control = (BufferedIOControl *) data;
+    if (control)
+    {
+        if (control->adopt && control->io)
+            nrt_IOInterface_destruct(&control->io);
+        if (control->buf)
+            NRT_FREE(control->buf);
+    }
+}
+
+NRTAPI(nrt_IOInterface *) nrt_BufferedAdapter_construct(nrt_IOInterface * io,
+                                                        size_t bufferSize,
+                                                        NRT_BOOL adopt,
+                                                        nrt_Error * error)
+{
+    static nrt_IIOInterface bufferedInterface = {
+        &BufferedAdapter_read,
+        &BufferedAdapter_write,
+        &BufferedAdapter_canSeek,
+        &BufferedAdapter_seek,
+        &BufferedAdapter_tell,
+        &BufferedAdapter_getSize,
+        &BufferedAdapter_getMode,
+        &BufferedAdapter_close,
+        &BufferedAdapter_destruct
+    };
+    nrt_IOInterface *impl = NULL;
+    BufferedIOControl *control = NULL;
+    nrt_Off position;
+
+    position = nrt_IOInterface_tell(io, error);
+    if (!NRT_IO_SUCCESS(position))
+        return NULL;
+
+    impl = (nrt_IOInterface *) NRT_MALLOC(sizeof(nrt_IOInterface));
+    if (!impl)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(impl, 0, sizeof(nrt_IOInterface));
+
+    control = (BufferedIOControl *) NRT_MALLOC(sizeof(BufferedIOControl));
+    if (!control)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(control, 0, sizeof(BufferedIOControl));
+    impl->data = (NRT_DATA *) control;
+    impl->iface = &bufferedInterface;
+
+    control->buf = (char *) NRT_MALLOC(bufferSize ? bufferSize : 1);
+    if (!control->buf)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    control->capacity = bufferSize;
+    control->position = position;
+    control->ioPosition = position;
+    control->fileSize = -1;
+    control->io = io;
+    control->adopt = adopt;
+    return impl;
+
+    CATCH_ERROR:
+    {
+        if (impl)
+            nrt_IOInterface_destruct(&impl);
+        return NULL;
+    }
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_copy(nrt_IOInterface * input,
+                                      nrt_IOInterface * output,
+                                      nrt_Uint64 size,
+                                      nrt_Error * error)
+{
+    char *buf = NULL;
+    size_t bufSize;
+    size_t bytesThisPass;
+
+    /* Both ends are files, so let the kernel move what it can */
+    if (input->iface->read == &IOHandleAdapter_read &&
+        output->iface->write == &IOHandleAdapter_write)
+    {
+        nrt_Off copied = nrt_IOHandle_copy(
+            ((IOHandleControl *) input->data)->handle,
+            ((IOHandleControl *) output->data)->handle,
+            size, error);
+        if (!NRT_IO_SUCCESS(copied))
+            return NRT_FAILURE;
+        size -= (nrt_Uint64) copied;
+    }
+
+    if (size == 0)
+        return NRT_SUCCESS;
+
+    /* If either end is already in memory, copy straight to or from it */
+    if (input->iface->read == &BufferAdapter_read)
+    {
+        BufferIOControl *control = (BufferIOControl *) input->data;
+        if (size > control->size - control->mark)
+        {
+            nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NRT_FAILURE;
+        }
+        if (!nrt_IOInterface_write(output, control->buf + control->mark,
+                                   (size_t) size, error))
+            return NRT_FAILURE;
+        control->mark += (size_t) size;
+        return NRT_SUCCESS;
+    }
+
+    if (output->iface->write == &BufferAdapter_write)
+    {
+        BufferIOControl *control = (BufferIOControl *) output->data;
+        if (size > control->size - control->mark)
+        {
+            nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NRT_FAILURE;
+        }
+        if (!nrt_IOInterface_read(input, control->buf + control->mark,
+                                  (size_t) size, error))
+            return NRT_FAILURE;
+        control->mark += (size_t) size;
+        if (control->mark > control->bytesWritten)
+            control->bytesWritten = control->mark;
+        return NRT_SUCCESS;
+    }
+
+    if (input->iface->read == &GrowableBufferAdapter_read)
+    {
+        GrowableBufferIOControl *control =
+            (GrowableBufferIOControl *) input->data;
+        if (control->mark > control->size ||
+            size > control->size - control->mark)
+        {
+            nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NRT_FAILURE;
+        }
+        if (!nrt_IOInterface_write(output, control->buf + control->mark,
+                                   (size_t) size, error))
+            return NRT_FAILURE;
+        control->mark += (size_t) size;
+        return NRT_SUCCESS;
+    }
+
+    if (output->iface->write == &GrowableBufferAdapter_write)
+    {
+        GrowableBufferIOControl *control =
+            (GrowableBufferIOControl *) output->data;
+        size_t oldSize = control->size;
+        size_t oldMark = control->mark;
+        char *dest;
+        if (size > (nrt_Uint64) ((size_t) -1))
+        {
+            nrt_Error_init(error, "Invalid size requested", NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NRT_FAILURE;
+        }
+        dest = GrowableBufferAdapter_extend(control, (size_t) size, error);
+        if (!dest)
+            return NRT_FAILURE;
+        if (!nrt_IOInterface_read(input, dest, (size_t) size, error))
+        {
+            control->size = oldSize;
+            control->mark = oldMark;
+            return NRT_FAILURE;
+        }
+        return NRT_SUCCESS;
+    }
+
+    bufSize = size < NRT_IO_COPY_BUFFER_SIZE ? (size_t) size :
+        NRT_IO_COPY_BUFFER_SIZE;
+    buf = (char *) NRT_MALLOC(bufSize);
+    if (!buf)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+
+    while (size > 0)
+    {
+        bytesThisPass = size < bufSize ? (size_t) size : bufSize;
+        if (!nrt_IOInterface_read(input, buf, bytesThisPass, error) ||
+            !nrt_IOInterface_write(output, buf, bytesThisPass, error))
+        {
+            NRT_FREE(buf);
+            return NRT_FAILURE;
+        }
+        size -= bytesThisPass;
+    }
+
+    NRT_FREE(buf);
+    return NRT_SUCCESS;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_readBatch(nrt_IOInterface * io,
+                                           const nrt_IORequest * requests,
+                                           size_t numRequests,
+                                           nrt_Error * error)
+{
+    size_t i;
+
+    if (nrt_IOStatsAdapter_getWrapped(io))
+        return nrt_IOStatsAdapter_readBatch(io, requests, numRequests, error);
+
+    if (io->iface->read == &IOHandleAdapter_read)
+        return nrt_IOHandle_readBatch(((IOHandleControl *) io->data)->handle,
+                                      requests, numRequests, error);
+
+    if (io->iface->read == &BufferAdapter_read)
+    {
+        BufferIOControl *control = (BufferIOControl *) io->data;
+        for (i = 0; i < numRequests; ++i)
+        {
+            if (requests[i].offset < 0 ||
+                (size_t) requests[i].offset > control->size ||
+                requests[i].size > control->size -
+                    (size_t) requests[i].offset)
+            {
+                nrt_Error_init(error, "Invalid size requested - EOF",
+                               NRT_CTXT, NRT_ERR_MEMORY);
+                return NRT_FAILURE;
+            }
+            memcpy(requests[i].buf, control->buf + requests[i].offset,
+                   requests[i].size);
+        }
+        return NRT_SUCCESS;
+    }
+
+    if (io->iface->read == &GrowableBufferAdapter_read)
+    {
+        GrowableBufferIOControl *control =
+            (GrowableBufferIOControl *) io->data;
+        for (i = 0; i < numRequests; ++i)
+        {
+            if (requests[i].offset < 0 ||
+                (size_t) requests[i].offset > control->size ||
+                requests[i].size > control->size -
+                    (size_t) requests[i].offset)
+            {
+                nrt_Error_init(error, "Invalid size requested - EOF",
+                               NRT_CTXT, NRT_ERR_MEMORY);
+                return NRT_FAILURE;
+            }
+            memcpy(requests[i].buf, control->buf + requests[i].offset,
+                   requests[i].size);
+        }
+        return NRT_SUCCESS;
+    }
+
+    for (i = 0; i < numRequests; ++i)
+    {
+        if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(io, requests[i].offset,
+                                                 NRT_SEEK_SET, error)) ||
+            !nrt_IOInterface_read(io, requests[i].buf, requests[i].size,
+                                  error))
+            return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_truncate(nrt_IOInterface * io,
+                                          nrt_Off size,
+                                          nrt_Error * error)
+{
+    if (io->iface->write == &IOHandleAdapter_write)
+        return nrt_IOHandle_truncate(((IOHandleControl *) io->data)->handle,
+                                     size, error);
+
+    if (io->iface->write == &BufferAdapter_write)
+    {
+        BufferIOControl *control = (BufferIOControl *) io->data;
+        if (size < 0 || (size_t) size > control->size)
+        {
+            nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NRT_FAILURE;
+        }
+        if ((size_t) size > control->bytesWritten)
+            memset(control->buf + control->bytesWritten, 0,
+                   (size_t) size - control->bytesWritten);
+        control->bytesWritten = (size_t) size;
+        if (control->mark > control->bytesWritten)
+            control->mark = control->bytesWritten;
+        return NRT_SUCCESS;
+    }
+
+    if (io->iface->write == &GrowableBufferAdapter_write)
+    {
+        GrowableBufferIOControl *control =
+            (GrowableBufferIOControl *) io->data;
+        size_t mark = control->mark;
+        if (size < 0)
+        {
+            nrt_Error_init(error, "Invalid size requested", NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NRT_FAILURE;
+        }
+        if ((size_t) size > control->size)
+        {
+            /* Growing is a zero-length write at the new end */
+            control->mark = (size_t) size;
+            if (!GrowableBufferAdapter_extend(control, 0, error))
+            {
+                control->mark = mark;
+                return NRT_FAILURE;
+            }
+            control->mark = mark;
+        }
+        control->size = (size_t) size;
+        if (control->mark > control->size)
+            control->mark = control->size;
+        return NRT_SUCCESS;
+    }
+
+    if (nrt_IOStatsAdapter_getWrapped(io))
+        return nrt_IOInterface_truncate(nrt_IOStatsAdapter_getWrapped(io),
+                                        size, error);
+
+    nrt_Error_init(error, "This IO interface cannot be truncated", NRT_CTXT,
+                   NRT_ERR_INVALID_OBJECT);
+    return NRT_FAILURE;
+}
+
 NRT_CXX_ENDGUARD
 
@@ -0,0 +1,602 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nrt/nrt_config.h"
+#include "nrt/IOStats.h"
+
+#if defined(WIN32)
+#   include <windows.h>
+#elif defined(HAVE_CLOCK_GETTIME)
+#   include <time.h>
+#else
+#   include "nrt/Utils.h"
+#endif
+
+NRT_CXX_GUARD
+
+typedef struct _IOStatsTag
+{
+    char *name;
+    nrt_IOStats stats;
+} IOStatsTag;
+
+typedef struct _IOStatsControl
+{
+    nrt_IOInterface *io;
+    NRT_BOOL adopt;
+    nrt_Off position;
+    nrt_IOStats total;
+    IOStatsTag *tags;
+    size_t numTags;
+    size_t tagCapacity;
+    int current;
+    nrt_Int64 block;
+    NRT_IO_STATS_TRACE trace;
+    NRT_DATA *traceData;
+} IOStatsControl;
+
+static const char *const IOStats_opNames[NRT_IO_STATS_NUM_OPS] = {
+    "read", "write", "seek", "batch"
+};
+
+/* A monotonic clock, in nanoseconds */
+NRTPRIV(nrt_Uint64) IOStats_now(void)
+{
+#if defined(WIN32)
+    LARGE_INTEGER now;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    return (nrt_Uint64) ((double) now.QuadPart * 1.0e9 /
+                         (double) frequency.QuadPart);
+#elif defined(HAVE_CLOCK_GETTIME)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (nrt_Uint64) now.tv_sec * 1000000000 + (nrt_Uint64) now.tv_nsec;
+#else
+    return (nrt_Uint64) (nrt_Utils_getCurrentTimeMillis() * 1.0e6);
+#endif
+}
+
+NRTPRIV(int) IOStats_bucket(nrt_Uint64 value)
+{
+    int bucket = 0;
+    while (value && bucket < NRT_IO_STATS_BUCKETS - 1)
+    {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+NRTPRIV(void) IOStats_add(nrt_IOOpStats * stats, nrt_Uint64 size,
+                          nrt_Uint64 nanos, NRT_BOOL ok)
+{
+    stats->calls++;
+    if (!ok)
+        stats->failures++;
+    stats->bytes += size;
+    stats->nanos += nanos;
+    if (nanos > stats->maxNanos)
+        stats->maxNanos = nanos;
+    stats->latencies[IOStats_bucket(nanos / 1000)]++;
+}
+
+/* Counts one access in the totals and the current tag, and traces it */
+NRTPRIV(void) IOStats_record(IOStatsControl * control, nrt_IOStatsOp op,
+                             nrt_Off offset, nrt_Uint64 size,
+                             nrt_Uint64 start, NRT_BOOL ok)
+{
+    nrt_IOAccess access;
+
+    access.op = op;
+    access.offset = offset;
+    access.size = size;
+    access.nanos = IOStats_now() - start;
+    access.ok = ok;
+    access.tag = control->current < 0 ? NULL :
+        control->tags[control->current].name;
+    access.block = control->block;
+
+    IOStats_add(&control->total.ops[op], size, access.nanos, ok);
+    if (control->current >= 0)
+        IOStats_add(&control->tags[control->current].stats.ops[op], size,
+                    access.nanos, ok);
+
+    /* Batches count the size of each request themselves */
+    if (op != NRT_IO_STATS_BATCH)
+    {
+        control->total.ops[op].sizes[IOStats_bucket(size)]++;
+        if (control->current >= 0)
+            control->tags[control->current].stats.ops[op]
+                .sizes[IOStats_bucket(size)]++;
+    }
+    if (control->trace)
+        (*control->trace) (control->traceData, &access);
+}
+
+NRTPRIV(NRT_BOOL) IOStatsAdapter_read(NRT_DATA * data, void *buf, size_t size,
+                                      nrt_Error * error)
+{
+    IOStatsControl *control = (IOStatsControl *) data;
+    nrt_Off offset = control->position;
+    nrt_Uint64 start = IOStats_now();
+    NRT_BOOL ok = nrt_IOInterface_read(control->io, buf, size, error);
+
+    if (ok && control->position >= 0)
+        control->position += (nrt_Off) size;
+    else if (!ok)
+        control->position = -1;
+    IOStats_record(control, NRT_IO_STATS_READ, offset, size, start, ok);
+    return ok;
+}
+
+NRTPRIV(NRT_BOOL) IOStatsAdapter_write(NRT_DATA * data, const void *buf,
+                                       size_t size, nrt_Error * error)
+{
+    IOStatsControl *control = (IOStatsControl *) data;
+    nrt_Off offset = control->position;
+    nrt_Uint64 start = IOStats_now();
+    NRT_BOOL ok = nrt_IOInterface_write(control->io, buf, size, error);
+
+    if (ok && control->position >= 0)
+        control->position += (nrt_Off) size;
+    else if (!ok)
+        control->position = -1;
+    IOStats_record(control, NRT_IO_STATS_WRITE, offset, size, start, ok);
+    return ok;
+}
+
+NRTPRIV(NRT_BOOL) IOStatsAdapter_canSeek(NRT_DATA * data, nrt_Error * error)
+{
+    return nrt_IOInterface_canSeek(((IOStatsControl *) data)->io, error);
+}
+
+NRTPRIV(nrt_Off) IOStatsAdapter_seek(NRT_DATA * data, nrt_Off offset,
+                                     int whence, nrt_Error * error)
+{
+    IOStatsControl *control = (IOStatsControl *) data;
+    nrt_Off from = control->position;
+    nrt_Uint64 start = IOStats_now();
+    nrt_Off to = nrt_IOInterface_seek(control->io, offset, whence, error);
+    nrt_Uint64 distance = 0;
+
+    if (NRT_IO_SUCCESS(to) && from >= 0)
+        distance = (nrt_Uint64) (to > from ? to - from : from - to);
+    control->position = NRT_IO_SUCCESS(to) ? to : -1;
+    IOStats_record(control, NRT_IO_STATS_SEEK, from, distance, start,
+                   NRT_IO_SUCCESS(to));
+    return to;
+}
+
+NRTPRIV(nrt_Off) IOStatsAdapter_tell(NRT_DATA * data, nrt_Error * error)
+{
+    return nrt_IOInterface_tell(((IOStatsControl *) data)->io, error);
+}
+
+NRTPRIV(nrt_Off) IOStatsAdapter_getSize(NRT_DATA * data, nrt_Error * error)
+{
+    return nrt_IOInterface_getSize(((IOStatsControl *) data)->io, error);
+}
+
+NRTPRIV(int) IOStatsAdapter_getMode(NRT_DATA * data, nrt_Error * error)
+{
+    return nrt_IOInterface_getMode(((IOStatsControl *) data)->io, error);
+}
+
+NRTPRIV(NRT_BOOL) IOStatsAdapter_close(NRT_DATA * data, nrt_Error * error)
+{
+    return nrt_IOInterface_close(((IOStatsControl *) data)->io, error);
+}
+
+NRTPRIV(void) IOStatsAdapter_clearTags(IOStatsControl * control)
+{
+    size_t i;
+    for (i = 0; i < control->numTags; ++i)
+        NRT_FREE(control->tags[i].name);
+    control->numTags = 0;
+    control->current = -1;
+}
+
+NRTPRIV(void) IOStatsAdapter_destruct(NRT_DATA * data)
+{
+    IOStatsControl *control = (IOStatsControl *) data;
+    if (control)
+    {
+        IOStatsAdapter_clearTags(control);
+        if (control->tags)
+            NRT_FREE(control->tags);
+        if (control->adopt && control->io)
+            nrt_IOInterface_destruct(&control->io);
+    }
+}
+
+NRTAPI(nrt_IOInterface *) nrt_IOStatsAdapter_construct(nrt_IOInterface * io,
+                                                       NRT_BOOL adopt,
+                                                       nrt_Error * error)
+{
+    static nrt_IIOInterface statsInterface = {
+        &IOStatsAdapter_read,
+        &IOStatsAdapter_write,
+        &IOStatsAdapter_canSeek,
+        &IOStatsAdapter_seek,
+        &IOStatsAdapter_tell,
+        &IOStatsAdapter_getSize,
+        &IOStatsAdapter_getMode,
+        &IOStatsAdapter_close,
+        &IOStatsAdapter_destruct
+    };
+    nrt_IOInterface *impl = NULL;
+    IOStatsControl *control = NULL;
+    nrt_Error ignored;
+
+    impl = (nrt_IOInterface *) NRT_MALLOC(sizeof(nrt_IOInterface));
+    if (!impl)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(impl, 0, sizeof(nrt_IOInterface));
+
+    control = (IOStatsControl *) NRT_MALLOC(sizeof(IOStatsControl));
+    if (!control)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(control, 0, sizeof(IOStatsControl));
+    control->io = io;
+    control->adopt = adopt;
+    control->current = -1;
+    control->block = -1;
+
+    /* Seek distances are measured from here; an unknown start just
+       leaves the first seek unmeasured */
+    control->position = nrt_IOInterface_tell(io, &ignored);
+    if (!NRT_IO_SUCCESS(control->position))
+        control->position = -1;
+
+    impl->data = (NRT_DATA *) control;
+    impl->iface = &statsInterface;
+    return impl;
+
+    CATCH_ERROR:
+    {
+        if (impl)
+            NRT_FREE(impl);
+        return NULL;
+    }
+}
+
+NRTAPI(nrt_IOInterface *) nrt_IOStatsAdapter_getWrapped(nrt_IOInterface * io)
+{
+    if (!io || io->iface->read != &IOStatsAdapter_read)
+        return NULL;
+    return ((IOStatsControl *) io->data)->io;
+}
+
+NRTAPI(void) nrt_IOStatsAdapter_setTag(nrt_IOInterface * io, const char *tag)
+{
+    IOStatsControl *control;
+    size_t i;
+
+    if (!io || io->iface->read != &IOStatsAdapter_read)
+        return;
+
+    control = (IOStatsControl *) io->data;
+    control->current = -1;
+    if (!tag)
+        return;
+
+    for (i = 0; i < control->numTags; ++i)
+    {
+        if (strcmp(control->tags[i].name, tag) == 0)
+        {
+            control->current = (int) i;
+            return;
+        }
+    }
+
+    /* A tag that cannot be stored is simply not tracked */
+    if (control->numTags == control->tagCapacity)
+    {
+        size_t capacity = control->tagCapacity ? control->tagCapacity * 2 : 8;
+        IOStatsTag *tags = (IOStatsTag *) NRT_REALLOC(control->tags,
+                                                      capacity *
+                                                      sizeof(IOStatsTag));
+        if (!tags)
+            return;
+        control->tags = tags;
+        control->tagCapacity = capacity;
+    }
+    control->tags[control->numTags].name =
+        (char *) NRT_MALLOC(strlen(tag) + 1);
+    if (!control->tags[control->numTags].name)
+        return;
+    strcpy(control->tags[control->numTags].name, tag);
+    memset(&control->tags[control->numTags].stats, 0, sizeof(nrt_IOStats));
+    control->current = (int) control->numTags++;
+}
+
+NRTAPI(void) nrt_IOStatsAdapter_setBlock(nrt_IOInterface * io,
+                                         nrt_Int64 block)
+{
+    if (io && io->iface->read == &IOStatsAdapter_read)
+        ((IOStatsControl *) io->data)->block = block;
+}
+
+/* Returns the control of a stats adapter, or NULL with error set */
+NRTPRIV(IOStatsControl *) IOStats_getControl(nrt_IOInterface * io,
+                                             nrt_Error * error)
+{
+    if (!io || io->iface->read != &IOStatsAdapter_read)
+    {
+        nrt_Error_init(error, "Not an IO stats adapter", NRT_CTXT,
+                       NRT_ERR_INVALID_OBJECT);
+        return NULL;
+    }
+    return (IOStatsControl *) io->data;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOStatsAdapter_setTrace(nrt_IOInterface * io,
+                                             NRT_IO_STATS_TRACE trace,
+                                             NRT_DATA * user,
+                                             nrt_Error * error)
+{
+    IOStatsControl *control = IOStats_getControl(io, error);
+    if (!control)
+        return NRT_FAILURE;
+    control->trace = trace;
+    control->traceData = user;
+    return NRT_SUCCESS;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOStatsAdapter_getStats(nrt_IOInterface * io,
+                                             const char *tag,
+                                             nrt_IOStats * stats,
+                                             nrt_Error * error)
+{
+    IOStatsControl *control = IOStats_getControl(io, error);
+    size_t i;
+
+    if (!control)
+        return NRT_FAILURE;
+
+    if (!tag)
+    {
+        *stats = control->total;
+        return NRT_SUCCESS;
+    }
+
+    memset(stats, 0, sizeof(nrt_IOStats));
+    for (i = 0; i < control->numTags; ++i)
+    {
+        if (strcmp(control->tags[i].name, tag) == 0)
+        {
+            *stats = control->tags[i].stats;
+            break;
+        }
+    }
+    return NRT_SUCCESS;
+}
+
+NRTAPI(const char *) nrt_IOStatsAdapter_getTag(nrt_IOInterface * io,
+                                               size_t index)
+{
+    IOStatsControl *control;
+
+    if (!io || io->iface->read != &IOStatsAdapter_read)
+        return NULL;
+    control = (IOStatsControl *) io->data;
+    return index < control->numTags ? control->tags[index].name : NULL;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOStatsAdapter_reset(nrt_IOInterface * io,
+                                          nrt_Error * error)
+{
+    IOStatsControl *control = IOStats_getControl(io, error);
+    if (!control)
+        return NRT_FAILURE;
+    IOStatsAdapter_clearTags(control);
+    memset(&control->total, 0, sizeof(nrt_IOStats));
+    return NRT_SUCCESS;
+}
+
+NRTPROT(NRT_BOOL) nrt_IOStatsAdapter_readBatch(nrt_IOInterface * io,
+                                               const nrt_IORequest *
+                                               requests,
+                                               size_t numRequests,
+                                               nrt_Error * error)
+{
+    IOStatsControl *control = IOStats_getControl(io, error);
+    nrt_IOOpStats *tagStats;
+    nrt_Uint64 start;
+    nrt_Uint64 bytes = 0;
+    NRT_BOOL ok;
+    nrt_Off offset;
+    size_t i;
+
+    if (!control)
+        return NRT_FAILURE;
+
+    start = IOStats_now();
+    ok = nrt_IOInterface_readBatch(control->io, requests, numRequests, error);
+
+    /* The batch moves the wrapped position somewhere unknown */
+    control->position = -1;
+
+    /* One call and one latency for the batch, but one size per request */
+    tagStats = control->current < 0 ? NULL :
+        &control->tags[control->current].stats.ops[NRT_IO_STATS_BATCH];
+    offset = numRequests > 0 ? requests[0].offset : -1;
+    for (i = 0; i < numRequests; ++i)
+    {
+        int bucket = IOStats_bucket((nrt_Uint64) requests[i].size);
+        bytes += (nrt_Uint64) requests[i].size;
+        control->total.ops[NRT_IO_STATS_BATCH].sizes[bucket]++;
+        if (tagStats)
+            tagStats->sizes[bucket]++;
+    }
+    IOStats_record(control, NRT_IO_STATS_BATCH, offset, bytes, start, ok);
+    return ok;
+}
+
+/* ------------------------------------------------------------------ */
+/*                JSON                                                */
+/* ------------------------------------------------------------------ */
+
+NRTPRIV(NRT_BOOL) IOStats_print(nrt_IOInterface * out, nrt_Error * error,
+                                const char *format, ...)
+{
+    char buf[128];
+    va_list args;
+    int length;
+
+    va_start(args, format);
+    length = NRT_VSNPRINTF(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (length < 0 || (size_t) length >= sizeof(buf))
+    {
+        nrt_Error_init(error, "JSON value does not fit its buffer", NRT_CTXT,
+                       NRT_ERR_INVALID_PARAMETER);
+        return NRT_FAILURE;
+    }
+    return nrt_IOInterface_write(out, buf, (size_t) length, error);
+}
+
+NRTPRIV(NRT_BOOL) IOStats_printString(nrt_IOInterface * out,
+                                      const char *value, nrt_Error * error)
+{
+    if (!nrt_IOInterface_write(out, "\"", 1, error))
+        return NRT_FAILURE;
+    for (; *value; ++value)
+    {
+        unsigned char c = (unsigned char) *value;
+        NRT_BOOL ok;
+        if (c == '"' || c == '\\')
+            ok = IOStats_print(out, error, "\\%c", c);
+        else if (c < 0x20)
+            ok = IOStats_print(out, error, "\\u%04x", c);
+        else
+            ok = nrt_IOInterface_write(out, value, 1, error);
+        if (!ok)
+            return NRT_FAILURE;
+    }
+    return nrt_IOInterface_write(out, "\"", 1, error);
+}
+
+NRTPRIV(NRT_BOOL) IOStats_printHistogram(nrt_IOInterface * out,
+                                         const char *name,
+                                         const nrt_Uint64 * buckets,
+                                         nrt_Error * error)
+{
+    int used = NRT_IO_STATS_BUCKETS;
+    int i;
+
+    while (used > 0 && buckets[used - 1] == 0)
+        --used;
+    if (!IOStats_print(out, error, ", \"%s\": [", name))
+        return NRT_FAILURE;
+    for (i = 0; i < used; ++i)
+    {
+        if (!IOStats_print(out, error, i ? ", %llu" : "%llu",
+                           (unsigned long long) buckets[i]))
+            return NRT_FAILURE;
+    }
+    return nrt_IOInterface_write(out, "]", 1, error);
+}
+
+NRTPRIV(NRT_BOOL) IOStats_printStats(nrt_IOInterface * out,
+                                     const nrt_IOStats * stats,
+                                     nrt_Error * error)
+{
+    int op;
+
+    if (!nrt_IOInterface_write(out, "{", 1, error))
+        return NRT_FAILURE;
+    for (op = 0; op < NRT_IO_STATS_NUM_OPS; ++op)
+    {
+        const nrt_IOOpStats *opStats = &stats->ops[op];
+        if (!IOStats_print(out, error,
+                           "%s\"%s\": {\"calls\": %llu, \"failures\": %llu, "
+                           "\"%s\": %llu, \"seconds\": %.9f, "
+                           "\"maxSeconds\": %.9f",
+                           op ? ", " : "", IOStats_opNames[op],
+                           (unsigned long long) opStats->calls,
+                           (unsigned long long) opStats->failures,
+                           op == NRT_IO_STATS_SEEK ? "distance" : "bytes",
+                           (unsigned long long) opStats->bytes,
+                           opStats->nanos * 1.0e-9,
+                           opStats->maxNanos * 1.0e-9) ||
+            !IOStats_printHistogram(out, "sizes", opStats->sizes, error) ||
+            !IOStats_printHistogram(out, "latencyMicros",
+                                    opStats->latencies, error) ||
+            !nrt_IOInterface_write(out, "}", 1, error))
+            return NRT_FAILURE;
+    }
+    return nrt_IOInterface_write(out, "}", 1, error);
+}
+
+NRTAPI(char *) nrt_IOStatsAdapter_toJSON(nrt_IOInterface * io,
+                                         nrt_Error * error)
+{
+    IOStatsControl *control = IOStats_getControl(io, error);
+    nrt_IOInterface *out = NULL;
+    char *json = NULL;
+    size_t size;
+    size_t i;
+
+    if (!control)
+        return NULL;
+
+    out = nrt_GrowableBufferAdapter_construct(0, error);
+    if (!out)
+        return NULL;
+
+    if (!nrt_IOInterface_write(out, "{\"total\": ", 10, error) ||
+        !IOStats_printStats(out, &control->total, error) ||
+        !nrt_IOInterface_write(out, ", \"tags\": {", 11, error))
+        goto CATCH_ERROR;
+    for (i = 0; i < control->numTags; ++i)
+    {
+        if ((i && !nrt_IOInterface_write(out, ", ", 2, error)) ||
+            !IOStats_printString(out, control->tags[i].name, error) ||
+            !nrt_IOInterface_write(out, ": ", 2, error) ||
+            !IOStats_printStats(out, &control->tags[i].stats, error))
+            goto CATCH_ERROR;
+    }
+    /* The terminating NUL goes in too */
+    if (!nrt_IOInterface_write(out, "}}", 3, error))
+        goto CATCH_ERROR;
+
+    json = nrt_GrowableBufferAdapter_release(out, &size, error);
+
+    CATCH_ERROR:
+    {
+        nrt_IOInterface_destruct(&out);
+        return json;
+    }
+}
+
+NRT_CXX_ENDGUARD
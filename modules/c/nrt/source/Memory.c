@@ -0,0 +1,95 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program;
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nrt/Arena.h"
+
+NRTPRIV(void *) defaultAllocate(void *data, size_t size)
+{
+    (void) data;
+    return malloc(size);
+}
+
+NRTPRIV(void *) defaultReallocate(void *data, void *ptr, size_t size)
+{
+    (void) data;
+    return realloc(ptr, size);
+}
+
+NRTPRIV(void) defaultRelease(void *data, void *ptr)
+{
+    (void) data;
+    free(ptr);
+}
+
+static const nrt_Allocator defaultAllocator =
+{
+    defaultAllocate,
+    defaultReallocate,
+    defaultRelease,
+    NULL
+};
+
+static nrt_Allocator currentAllocator =
+{
+    defaultAllocate,
+    defaultReallocate,
+    defaultRelease,
+    NULL
+};
+
+NRTAPI(void) nrt_Memory_setAllocator(const nrt_Allocator * allocator)
+{
+    currentAllocator = allocator ? *allocator : defaultAllocator;
+}
+
+NRTAPI(const nrt_Allocator *) nrt_Memory_getAllocator(void)
+{
+    return &currentAllocator;
+}
+
+NRTAPI(void *) nrt_Memory_malloc(size_t size)
+{
+    return currentAllocator.allocate(currentAllocator.data, size);
+}
+
+NRTAPI(void *) nrt_Memory_realloc(void *ptr, size_t size)
+{
+    if (ptr && nrt_Arena_find(ptr))
+    {
+        /* arena memory cannot grow, so it moves to the allocator */
+        size_t oldSize = nrt_Arena_getAllocationSize(ptr);
+        void *moved = nrt_Memory_malloc(size);
+        if (moved)
+            memcpy(moved, ptr, oldSize < size ? oldSize : size);
+        return moved;
+    }
+    if (!ptr)
+        return nrt_Memory_malloc(size);
+    return currentAllocator.reallocate(currentAllocator.data, ptr, size);
+}
+
+NRTAPI(void) nrt_Memory_free(void *ptr)
+{
+    /* arena memory goes back when its arena is destroyed */
+    if (ptr && !nrt_Arena_find(ptr))
+        currentAllocator.release(currentAllocator.data, ptr);
+}
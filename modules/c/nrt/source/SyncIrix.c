@@ -47,6 +47,20 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
 {
     nrt_Debug_flogf(stdout, "***Destroy Mutex*** [sgi] (empty)\n");
 }
+
+NRTPROT(NRT_BOOL) nrt_Thread_start(nrt_Thread * thread, NRT_THREAD_RUN run,
+                                   NRT_DATA * data, nrt_Error * error)
+{
+    (void)thread; (void)run; (void)data;
+    nrt_Error_init(error, "Threads are not supported", NRT_CTXT,
+                   NRT_ERR_UNK);
+    return NRT_FAILURE;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * thread)
+{
+    (void)thread;
+}
 #endif
 
 NRT_CXX_ENDGUARD
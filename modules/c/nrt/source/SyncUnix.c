@@ -52,6 +52,50 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
         nrt_Debug_flogf(stdout, "***Destroyed Mutex***\n");
     }
 }
+
+typedef struct _ThreadStart
+{
+    NRT_THREAD_RUN run;
+    NRT_DATA *data;
+} ThreadStart;
+
+NRTPRIV(void *) Thread_main(void *arg)
+{
+    ThreadStart start = *(ThreadStart *) arg;
+    NRT_FREE(arg);
+    start.run(start.data);
+    return NULL;
+}
+
+NRTPROT(NRT_BOOL) nrt_Thread_start(nrt_Thread * thread, NRT_THREAD_RUN run,
+                                   NRT_DATA * data, nrt_Error * error)
+{
+    int rc;
+    ThreadStart *start = (ThreadStart *) NRT_MALLOC(sizeof(ThreadStart));
+    if (!start)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+    start->run = run;
+    start->data = data;
+
+    rc = pthread_create(thread, NULL, Thread_main, start);
+    if (rc != 0)
+    {
+        NRT_FREE(start);
+        nrt_Error_init(error, NRT_STRERROR(rc), NRT_CTXT,
+                       NRT_ERR_UNK);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * thread)
+{
+    pthread_join(*thread, NULL);
+}
 #endif
 
 NRT_CXX_ENDGUARD
@@ -62,6 +62,50 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
         NRT_FREE(lpCriticalSection);
     }
 }
+
+typedef struct _ThreadStart
+{
+    NRT_THREAD_RUN run;
+    NRT_DATA *data;
+} ThreadStart;
+
+NRTPRIV(DWORD WINAPI) Thread_main(LPVOID arg)
+{
+    ThreadStart start = *(ThreadStart *) arg;
+    NRT_FREE(arg);
+    start.run(start.data);
+    return 0;
+}
+
+NRTPROT(NRT_BOOL) nrt_Thread_start(nrt_Thread * thread, NRT_THREAD_RUN run,
+                                   NRT_DATA * data, nrt_Error * error)
+{
+    ThreadStart *start = (ThreadStart *) NRT_MALLOC(sizeof(ThreadStart));
+    if (!start)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+    start->run = run;
+    start->data = data;
+
+    *thread = CreateThread(NULL, 0, Thread_main, start, 0, NULL);
+    if (*thread == NULL)
+    {
+        NRT_FREE(start);
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_UNK);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * thread)
+{
+    WaitForSingleObject(*thread, INFINITE);
+    CloseHandle(*thread);
+}
 #endif
 
 NRT_CXX_ENDGUARD
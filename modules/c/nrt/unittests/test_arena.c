@@ -0,0 +1,160 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+TEST_CASE(testAllocate)
+{
+    nrt_Error e;
+    nrt_Arena *arena = nrt_Arena_construct(1024, &e);
+    char *pieces[100];
+    char *big;
+    int i;
+
+    TEST_ASSERT(arena);
+    for (i = 0; i < 100; ++i)
+    {
+        pieces[i] = (char *) nrt_Arena_malloc(arena, i + 1);
+        TEST_ASSERT(pieces[i]);
+        TEST_ASSERT_EQ_INT(0, (int) ((size_t) pieces[i] % sizeof(double)));
+        memset(pieces[i], i, i + 1);
+    }
+
+    /* bigger than a chunk */
+    big = (char *) nrt_Arena_malloc(arena, 10000);
+    TEST_ASSERT(big);
+    memset(big, 0xff, 10000);
+
+    for (i = 0; i < 100; ++i)
+    {
+        TEST_ASSERT(nrt_Arena_find(pieces[i]) == arena);
+        TEST_ASSERT_EQ_INT(i, pieces[i][i]);
+    }
+    TEST_ASSERT(nrt_Arena_find(big + 9999) == arena);
+    TEST_ASSERT(nrt_Arena_getSize(arena) >= 10000 + 5050);
+
+    nrt_Arena_destruct(&arena);
+    TEST_ASSERT_NULL(arena);
+}
+
+TEST_CASE(testFreeAndRealloc)
+{
+    nrt_Error e;
+    nrt_Arena *arena = nrt_Arena_construct(0, &e);
+    char *heap = (char *) NRT_MALLOC(8);
+    char *inArena;
+    char *moved;
+
+    TEST_ASSERT(arena);
+    TEST_ASSERT(heap);
+    TEST_ASSERT_NULL(nrt_Arena_find(heap));
+
+    inArena = (char *) nrt_Arena_malloc(arena, 6);
+    TEST_ASSERT(nrt_Arena_find(inArena) == arena);
+    strcpy(inArena, "NITRO");
+
+    /* freeing arena memory leaves it for the arena */
+    NRT_FREE(inArena);
+    TEST_ASSERT(strcmp(inArena, "NITRO") == 0);
+
+    /* arena memory is copied out when it grows, and keeps what it had */
+    moved = (char *) NRT_REALLOC(inArena, 100);
+    TEST_ASSERT_NULL(nrt_Arena_find(moved));
+    TEST_ASSERT(strcmp(moved, "NITRO") == 0);
+    NRT_FREE(moved);
+
+    /* memory from the allocator never lands in the arena */
+    heap = (char *) NRT_REALLOC(heap, 16);
+    TEST_ASSERT_NULL(nrt_Arena_find(heap));
+    NRT_FREE(heap);
+
+    nrt_Arena_destruct(&arena);
+}
+
+static int allocations = 0;
+static int releases = 0;
+
+static void *countingAllocate(void *data, size_t size)
+{
+    (void) data;
+    ++allocations;
+    return malloc(size);
+}
+
+static void *countingReallocate(void *data, void *ptr, size_t size)
+{
+    (void) data;
+    if (!ptr)
+        ++allocations;
+    return realloc(ptr, size);
+}
+
+static void countingRelease(void *data, void *ptr)
+{
+    (void) data;
+    ++releases;
+    free(ptr);
+}
+
+TEST_CASE(testAllocator)
+{
+    nrt_Error e;
+    nrt_Allocator allocator;
+    nrt_Arena *arena;
+    void *p;
+    int i;
+
+    allocator.allocate = countingAllocate;
+    allocator.reallocate = countingReallocate;
+    allocator.release = countingRelease;
+    allocator.data = NULL;
+    nrt_Memory_setAllocator(&allocator);
+
+    p = NRT_MALLOC(10);
+    TEST_ASSERT(p);
+    NRT_FREE(p);
+    TEST_ASSERT_EQ_INT(1, allocations);
+    TEST_ASSERT_EQ_INT(1, releases);
+
+    /* an arena takes its chunks from the allocator too */
+    arena = nrt_Arena_construct(0, &e);
+    TEST_ASSERT(arena);
+    for (i = 0; i < 1000; ++i)
+        NRT_FREE(nrt_Arena_malloc(arena, 16));
+    TEST_ASSERT(allocations < 10);
+    nrt_Arena_destruct(&arena);
+    TEST_ASSERT_EQ_INT(allocations, releases);
+
+    nrt_Memory_setAllocator(NULL);
+    TEST_ASSERT(nrt_Memory_getAllocator()->allocate != countingAllocate);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testAllocate);
+    CHECK(testFreeAndRealloc);
+    CHECK(testAllocator);
+    return 0;
+}
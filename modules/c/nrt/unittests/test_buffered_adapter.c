@@ -0,0 +1,148 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program;
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+#define DATA_SIZE 100000
+#define BUFFER_SIZE 4096
+#define BUFFERED_FILE "test_buffered_adapter.tmp"
+
+static char* makeData(void)
+{
+    char* data = (char*)NRT_MALLOC(DATA_SIZE);
+    size_t ii;
+    for (ii = 0; ii < DATA_SIZE; ++ii)
+        data[ii] = (char)(ii * 31 + ii / 251);
+    return data;
+}
+
+static nrt_IOInterface* makeFile(const char* data, nrt_Error* error)
+{
+    nrt_IOInterface* io = nrt_IOHandleAdapter_open(BUFFERED_FILE,
+                                                   NRT_ACCESS_READWRITE,
+                                                   NRT_CREATE, error);
+    if (!io || !nrt_IOInterface_write(io, data, DATA_SIZE, error) ||
+        !NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 0, NRT_SEEK_SET, error)))
+        return NULL;
+    return io;
+}
+
+TEST_CASE(testBufferedReads)
+{
+    nrt_Error error;
+    char* data = makeData();
+    char out[3 * BUFFER_SIZE];
+    nrt_IOInterface* io = makeFile(data, &error);
+    nrt_IOInterface* buffered;
+    size_t sizes[] = { 1, 7, 80, BUFFER_SIZE - 3, 2, 3 * BUFFER_SIZE, 25 };
+    size_t ii;
+    nrt_Off offset = 0;
+
+    TEST_ASSERT(io);
+    buffered = nrt_BufferedAdapter_construct(io, BUFFER_SIZE, 1, &error);
+    TEST_ASSERT(buffered);
+
+    /* Small, straddling and oversized reads, in order */
+    for (ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ++ii)
+    {
+        TEST_ASSERT(nrt_IOInterface_read(buffered, out, sizes[ii], &error));
+        TEST_ASSERT(memcmp(out, data + offset, sizes[ii]) == 0);
+        offset += (nrt_Off)sizes[ii];
+        TEST_ASSERT_EQ_INT((int)nrt_IOInterface_tell(buffered, &error),
+                           (int)offset);
+    }
+
+    /* Backwards within the buffer, then far away, then relative */
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_seek(buffered, offset - 10,
+                                                 NRT_SEEK_SET, &error),
+                       (int)offset - 10);
+    TEST_ASSERT(nrt_IOInterface_read(buffered, out, 10, &error));
+    TEST_ASSERT(memcmp(out, data + offset - 10, 10) == 0);
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(buffered, 77777,
+                                                    NRT_SEEK_SET, &error)));
+    TEST_ASSERT(nrt_IOInterface_read(buffered, out, 100, &error));
+    TEST_ASSERT(memcmp(out, data + 77777, 100) == 0);
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(buffered, -1000,
+                                                    NRT_SEEK_CUR, &error)));
+    TEST_ASSERT(nrt_IOInterface_read(buffered, out, 100, &error));
+    TEST_ASSERT(memcmp(out, data + 76877, 100) == 0);
+
+    /* The tail of the file is shorter than the buffer */
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(buffered, -50,
+                                                    NRT_SEEK_END, &error)));
+    TEST_ASSERT(nrt_IOInterface_read(buffered, out, 50, &error));
+    TEST_ASSERT(memcmp(out, data + DATA_SIZE - 50, 50) == 0);
+    TEST_ASSERT(!nrt_IOInterface_read(buffered, out, 1, &error));
+
+    nrt_IOInterface_close(buffered, &error);
+    nrt_IOInterface_destruct(&buffered);
+    remove(BUFFERED_FILE);
+    NRT_FREE(data);
+}
+
+TEST_CASE(testBufferedWrites)
+{
+    nrt_Error error;
+    char* data = makeData();
+    char out[100];
+    nrt_IOInterface* io = makeFile(data, &error);
+    nrt_IOInterface* buffered;
+
+    TEST_ASSERT(io);
+    buffered = nrt_BufferedAdapter_construct(io, BUFFER_SIZE, 0, &error);
+    TEST_ASSERT(buffered);
+
+    /* A write over buffered bytes is seen by the next read */
+    TEST_ASSERT(nrt_IOInterface_read(buffered, out, 100, &error));
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(buffered, 20,
+                                                    NRT_SEEK_SET, &error)));
+    TEST_ASSERT(nrt_IOInterface_write(buffered, "NITF", 4, &error));
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_tell(buffered, &error), 24);
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(buffered, 0,
+                                                    NRT_SEEK_SET, &error)));
+    TEST_ASSERT(nrt_IOInterface_read(buffered, out, 100, &error));
+    TEST_ASSERT(memcmp(out, data, 20) == 0);
+    TEST_ASSERT(memcmp(out + 20, "NITF", 4) == 0);
+    TEST_ASSERT(memcmp(out + 24, data + 24, 76) == 0);
+
+    /* Not adopted, so the file is still ours to use */
+    nrt_IOInterface_destruct(&buffered);
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 20, NRT_SEEK_SET,
+                                                    &error)));
+    TEST_ASSERT(nrt_IOInterface_read(io, out, 4, &error));
+    TEST_ASSERT(memcmp(out, "NITF", 4) == 0);
+
+    nrt_IOInterface_close(io, &error);
+    nrt_IOInterface_destruct(&io);
+    remove(BUFFERED_FILE);
+    NRT_FREE(data);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testBufferedReads);
+    CHECK(testBufferedWrites);
+    return 0;
+}
@@ -0,0 +1,139 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program;
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+TEST_CASE(testGrowingWrites)
+{
+    nrt_Error error;
+    nrt_IOInterface* io = nrt_GrowableBufferAdapter_construct(0, &error);
+    char chunk[1000];
+    char out[1000];
+    size_t size;
+    size_t ii;
+    const char* buf;
+
+    TEST_ASSERT(io);
+    for (ii = 0; ii < sizeof(chunk); ++ii)
+        chunk[ii] = (char)ii;
+
+    /* Well past the default capacity */
+    for (ii = 0; ii < 100; ++ii)
+        TEST_ASSERT(nrt_IOInterface_write(io, chunk, sizeof(chunk), &error));
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_getSize(io, &error), 100000);
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_tell(io, &error), 100000);
+
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 54321, NRT_SEEK_SET,
+                                                    &error)));
+    TEST_ASSERT(nrt_IOInterface_read(io, out, sizeof(out), &error));
+    TEST_ASSERT(memcmp(out, chunk + 321, sizeof(chunk) - 321) == 0);
+    TEST_ASSERT(!nrt_IOInterface_read(io, out, 100000, &error));
+
+    buf = nrt_GrowableBufferAdapter_getBuffer(io, &size, &error);
+    TEST_ASSERT(buf);
+    TEST_ASSERT_EQ_INT((int)size, 100000);
+    TEST_ASSERT(memcmp(buf + 99000, chunk, sizeof(chunk)) == 0);
+
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testPatchingWrites)
+{
+    nrt_Error error;
+    nrt_IOInterface* io = nrt_GrowableBufferAdapter_construct(16, &error);
+    size_t size;
+    char* buf;
+
+    TEST_ASSERT(io);
+
+    /* Leave a hole for a length, write past the end, then go back */
+    TEST_ASSERT(nrt_IOInterface_write(io, "NITF", 4, &error));
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 6, NRT_SEEK_CUR,
+                                                    &error)));
+    TEST_ASSERT(nrt_IOInterface_write(io, "DATA", 4, &error));
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 4, NRT_SEEK_SET,
+                                                    &error)));
+    TEST_ASSERT(nrt_IOInterface_write(io, "000014", 6, &error));
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 0, NRT_SEEK_END,
+                                                    &error)));
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_tell(io, &error), 14);
+
+    /* A gap left by seeking past the end reads back as zeros */
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 20, NRT_SEEK_SET,
+                                                    &error)));
+    TEST_ASSERT(nrt_IOInterface_write(io, "!", 1, &error));
+    TEST_ASSERT(nrt_IOInterface_truncate(io, 24, &error));
+
+    buf = nrt_GrowableBufferAdapter_release(io, &size, &error);
+    TEST_ASSERT(buf);
+    TEST_ASSERT_EQ_INT((int)size, 24);
+    TEST_ASSERT(memcmp(buf, "NITF000014DATA\0\0\0\0\0\0!\0\0", 24) == 0);
+    NRT_FREE(buf);
+
+    /* Releasing leaves the adapter empty but usable */
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_getSize(io, &error), 0);
+    TEST_ASSERT(nrt_IOInterface_write(io, "NITF", 4, &error));
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_getSize(io, &error), 4);
+
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testCopyIntoGrowable)
+{
+    nrt_Error error;
+    char data[5000];
+    nrt_IOInterface* input;
+    nrt_IOInterface* output = nrt_GrowableBufferAdapter_construct(0, &error);
+    size_t size;
+    size_t ii;
+    const char* buf;
+
+    for (ii = 0; ii < sizeof(data); ++ii)
+        data[ii] = (char)(ii * 13);
+    input = nrt_BufferAdapter_construct(data, sizeof(data), 0, &error);
+    TEST_ASSERT(input);
+    TEST_ASSERT(output);
+
+    TEST_ASSERT(nrt_IOInterface_write(output, "hdr", 3, &error));
+    TEST_ASSERT(nrt_IOInterface_copy(input, output, sizeof(data), &error));
+    buf = nrt_GrowableBufferAdapter_getBuffer(output, &size, &error);
+    TEST_ASSERT(buf);
+    TEST_ASSERT_EQ_INT((int)size, 3 + (int)sizeof(data));
+    TEST_ASSERT(memcmp(buf + 3, data, sizeof(data)) == 0);
+
+    /* Only growable buffers can hand out their memory */
+    TEST_ASSERT(!nrt_GrowableBufferAdapter_release(input, &size, &error));
+
+    nrt_IOInterface_destruct(&input);
+    nrt_IOInterface_destruct(&output);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testGrowingWrites);
+    CHECK(testPatchingWrites);
+    CHECK(testCopyIntoGrowable);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program;
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+#define DATA_SIZE 300000
+#define SKIP 1234
+#define IN_FILE "test_io_copy_in.tmp"
+#define OUT_FILE "test_io_copy_out.tmp"
+
+static char* makeData(void)
+{
+    char* data = (char*)NRT_MALLOC(DATA_SIZE);
+    size_t ii;
+    for (ii = 0; ii < DATA_SIZE; ++ii)
+        data[ii] = (char)(ii * 31 + ii / 251);
+    return data;
+}
+
+static nrt_IOInterface* makeInputFile(const char* data, nrt_Error* error)
+{
+    nrt_IOInterface* io = nrt_IOHandleAdapter_open(IN_FILE,
+                                                   NRT_ACCESS_WRITEONLY,
+                                                   NRT_CREATE, error);
+    if (!io || !nrt_IOInterface_write(io, data, DATA_SIZE, error))
+        return NULL;
+    nrt_IOInterface_close(io, error);
+    nrt_IOInterface_destruct(&io);
+
+    return nrt_IOHandleAdapter_open(IN_FILE, NRT_ACCESS_READONLY,
+                                    NRT_OPEN_EXISTING, error);
+}
+
+static nrt_IOInterface* makeOutputFile(nrt_Error* error)
+{
+    /* Start empty, whatever an earlier test left behind */
+    remove(OUT_FILE);
+    return nrt_IOHandleAdapter_open(OUT_FILE, NRT_ACCESS_READWRITE,
+                                    NRT_CREATE, error);
+}
+
+TEST_CASE(testCopyFileToFile)
+{
+    nrt_Error error;
+    char* data = makeData();
+    char* copy = (char*)NRT_MALLOC(DATA_SIZE);
+    nrt_IOInterface* input = makeInputFile(data, &error);
+    nrt_IOInterface* output = makeOutputFile(&error);
+    TEST_ASSERT(input);
+    TEST_ASSERT(output);
+
+    /* Copy from the middle of the input, after something already written */
+    TEST_ASSERT(nrt_IOInterface_write(output, "NITF", 4, &error));
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(input, SKIP, NRT_SEEK_SET,
+                                                    &error)));
+    TEST_ASSERT(nrt_IOInterface_copy(input, output, DATA_SIZE - SKIP,
+                                     &error));
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_tell(input, &error), DATA_SIZE);
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_tell(output, &error),
+                       DATA_SIZE - SKIP + 4);
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_getSize(output, &error),
+                       DATA_SIZE - SKIP + 4);
+
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(output, 4, NRT_SEEK_SET,
+                                                    &error)));
+    TEST_ASSERT(nrt_IOInterface_read(output, copy, DATA_SIZE - SKIP, &error));
+    TEST_ASSERT(memcmp(copy, data + SKIP, DATA_SIZE - SKIP) == 0);
+
+    nrt_IOInterface_close(input, &error);
+    nrt_IOInterface_close(output, &error);
+    nrt_IOInterface_destruct(&input);
+    nrt_IOInterface_destruct(&output);
+    NRT_FREE(copy);
+    NRT_FREE(data);
+}
+
+TEST_CASE(testCopyThroughMemory)
+{
+    nrt_Error error;
+    char* data = makeData();
+    char* copy = (char*)NRT_MALLOC(DATA_SIZE);
+    nrt_IOInterface* input = makeInputFile(data, &error);
+    nrt_IOInterface* buffer = nrt_BufferAdapter_construct(copy, DATA_SIZE, 1,
+                                                          &error);
+    nrt_IOInterface* output = makeOutputFile(&error);
+    TEST_ASSERT(input);
+    TEST_ASSERT(buffer);
+    TEST_ASSERT(output);
+
+    /* File into memory, then memory back out to a file */
+    TEST_ASSERT(nrt_IOInterface_copy(input, buffer, DATA_SIZE, &error));
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_getSize(buffer, &error),
+                       DATA_SIZE);
+    TEST_ASSERT(memcmp(copy, data, DATA_SIZE) == 0);
+
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(buffer, SKIP, NRT_SEEK_SET,
+                                                    &error)));
+    TEST_ASSERT(nrt_IOInterface_copy(buffer, output, DATA_SIZE - SKIP,
+                                     &error));
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_tell(buffer, &error), DATA_SIZE);
+    TEST_ASSERT_EQ_INT((int)nrt_IOInterface_getSize(output, &error),
+                       DATA_SIZE - SKIP);
+
+    /* Asking for more than the buffer holds fails */
+    TEST_ASSERT(!nrt_IOInterface_copy(buffer, output, 1, &error));
+
+    nrt_IOInterface_close(input, &error);
+    nrt_IOInterface_close(output, &error);
+    nrt_IOInterface_destruct(&input);
+    nrt_IOInterface_destruct(&output);
+    nrt_IOInterface_destruct(&buffer);
+    NRT_FREE(data);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testCopyFileToFile);
+    CHECK(testCopyThroughMemory);
+    remove(IN_FILE);
+    remove(OUT_FILE);
+    return 0;
+}
@@ -0,0 +1,316 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program;
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+#ifndef WIN32
+#   include <unistd.h>
+#   include <sys/resource.h>
+#   include <sys/wait.h>
+#endif
+
+#define DATA_SIZE 300000
+#define NUM_REQUESTS 200
+#define REQUEST_SIZE 1000
+#define BATCH_FILE "test_io_read_batch.tmp"
+#define NUM_READERS 6
+
+static char* makeData(void)
+{
+    char* data = (char*)NRT_MALLOC(DATA_SIZE);
+    size_t ii;
+    for (ii = 0; ii < DATA_SIZE; ++ii)
+        data[ii] = (char)(ii * 31 + ii / 251);
+    return data;
+}
+
+/* Scattered, overlapping and out of order, as block reads can be */
+static void makeRequests(nrt_IORequest* requests, char* out)
+{
+    size_t ii;
+    for (ii = 0; ii < NUM_REQUESTS; ++ii)
+    {
+        requests[ii].offset = (nrt_Off)((ii * 7919) % (DATA_SIZE -
+                                                      REQUEST_SIZE));
+        requests[ii].buf = out + ii * REQUEST_SIZE;
+        requests[ii].size = REQUEST_SIZE - ii;
+    }
+}
+
+static void checkRequests(const char* testName, const nrt_IORequest* requests,
+                          const char* data)
+{
+    size_t ii;
+    for (ii = 0; ii < NUM_REQUESTS; ++ii)
+        TEST_ASSERT(memcmp(requests[ii].buf, data + requests[ii].offset,
+                           requests[ii].size) == 0);
+}
+
+TEST_CASE(testReadBatchFromFile)
+{
+    nrt_Error error;
+    char* data = makeData();
+    char* out = (char*)NRT_MALLOC(NUM_REQUESTS * REQUEST_SIZE);
+    nrt_IORequest requests[NUM_REQUESTS];
+    nrt_IOInterface* io = nrt_IOHandleAdapter_open(BATCH_FILE,
+                                                   NRT_ACCESS_READWRITE,
+                                                   NRT_CREATE, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nrt_IOInterface_write(io, data, DATA_SIZE, &error));
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 10, NRT_SEEK_SET,
+                                                    &error)));
+
+    makeRequests(requests, out);
+    TEST_ASSERT(nrt_IOInterface_readBatch(io, requests, NUM_REQUESTS,
+                                          &error));
+    checkRequests(testName, requests, data);
+
+    /* A read past the end fails rather than coming back short */
+    requests[NUM_REQUESTS / 2].offset = DATA_SIZE - 10;
+    TEST_ASSERT(!nrt_IOInterface_readBatch(io, requests, NUM_REQUESTS,
+                                           &error));
+
+    /* and leaves nothing behind to upset the next batch */
+    memset(out, 0, NUM_REQUESTS * REQUEST_SIZE);
+    makeRequests(requests, out);
+    TEST_ASSERT(nrt_IOInterface_readBatch(io, requests, NUM_REQUESTS,
+                                          &error));
+    checkRequests(testName, requests, data);
+
+    nrt_IOInterface_close(io, &error);
+    nrt_IOInterface_destruct(&io);
+    remove(BATCH_FILE);
+    NRT_FREE(data);
+    NRT_FREE(out);
+}
+
+TEST_CASE(testReadBatchFromBuffer)
+{
+    nrt_Error error;
+    char* data = makeData();
+    char* out = (char*)NRT_MALLOC(NUM_REQUESTS * REQUEST_SIZE);
+    nrt_IORequest requests[NUM_REQUESTS];
+    nrt_IOInterface* io = nrt_BufferAdapter_construct(data, DATA_SIZE, 0,
+                                                      &error);
+    TEST_ASSERT(io);
+
+    makeRequests(requests, out);
+    TEST_ASSERT(nrt_IOInterface_readBatch(io, requests, NUM_REQUESTS,
+                                          &error));
+    checkRequests(testName, requests, data);
+
+    requests[0].offset = DATA_SIZE - 10;
+    TEST_ASSERT(!nrt_IOInterface_readBatch(io, requests, NUM_REQUESTS,
+                                           &error));
+
+    nrt_IOInterface_destruct(&io);
+    NRT_FREE(data);
+    NRT_FREE(out);
+}
+
+/* Reads one batch into fresh buffers, returning whether it came back right */
+static NRT_BOOL readBatchOnce(nrt_IOInterface* io, const char* data)
+{
+    nrt_Error error;
+    char* out = (char*)NRT_MALLOC(NUM_REQUESTS * REQUEST_SIZE);
+    nrt_IORequest requests[NUM_REQUESTS];
+    NRT_BOOL ok;
+    size_t ii;
+
+    if (!out)
+        return 0;
+    makeRequests(requests, out);
+    ok = nrt_IOInterface_readBatch(io, requests, NUM_REQUESTS, &error);
+    for (ii = 0; ok && ii < NUM_REQUESTS; ++ii)
+        ok = memcmp(requests[ii].buf, data + requests[ii].offset,
+                    requests[ii].size) == 0;
+    NRT_FREE(out);
+    return ok;
+}
+
+typedef struct _Reader
+{
+    nrt_IOInterface* io;
+    const char* data;
+    NRT_BOOL ok;
+} Reader;
+
+static void readMany(NRT_DATA* data)
+{
+    Reader* reader = (Reader*)data;
+    int ii;
+
+    reader->ok = 1;
+    for (ii = 0; ii < 20 && reader->ok; ++ii)
+        reader->ok = readBatchOnce(reader->io, reader->data);
+}
+
+/* Several threads reading batches at once, returning whether all came back */
+static NRT_BOOL readConcurrently(nrt_IOInterface* io, const char* data)
+{
+    nrt_Error error;
+    nrt_Thread threads[NUM_READERS];
+    Reader readers[NUM_READERS];
+    NRT_BOOL ok = 1;
+    int ii;
+
+    for (ii = 0; ii < NUM_READERS; ++ii)
+    {
+        readers[ii].io = io;
+        readers[ii].data = data;
+        if (!nrt_Thread_start(&threads[ii], &readMany, &readers[ii], &error))
+            readMany(&readers[ii]);
+    }
+    for (ii = 0; ii < NUM_READERS; ++ii)
+    {
+        nrt_Thread_join(&threads[ii]);
+        ok = ok && readers[ii].ok;
+    }
+    return ok;
+}
+
+#ifndef WIN32
+/*
+ *  Reads a batch in a child process, which must not wait on the parent's
+ *  workers or share its ring.  A child that hangs is killed by the alarm.
+ */
+static NRT_BOOL readAfterFork(nrt_IOInterface* io, const char* data)
+{
+    int status = 0;
+    pid_t child = fork();
+
+    if (child < 0)
+        return 0;
+    if (child == 0)
+    {
+        alarm(20);
+        _exit(readBatchOnce(io, data) && readConcurrently(io, data) ? 0 : 1);
+    }
+    return waitpid(child, &status, 0) == child && WIFEXITED(status) &&
+           WEXITSTATUS(status) == 0;
+}
+
+/* Reads a batch, then forks and reads again in the child */
+static void readThenFork(NRT_DATA* data)
+{
+    Reader* reader = (Reader*)data;
+
+    reader->ok = readBatchOnce(reader->io, reader->data) &&
+                 readConcurrently(reader->io, reader->data) &&
+                 readAfterFork(reader->io, reader->data);
+}
+
+/*
+ *  Runs the fork test without a ring, where the batches go to the pool.
+ *  The ring needs a descriptor of its own, so with no more to be had the
+ *  pool is used instead.  The test runs on a new thread, which has no
+ *  ring from before the limit.
+ */
+static int readOnPoolAfterFork(nrt_IOInterface* io, const char* data)
+{
+    nrt_Error error;
+    nrt_Thread thread;
+    Reader reader;
+    struct rlimit limit;
+    int fd;
+
+    alarm(40);
+    fd = dup(0);
+    if (fd < 0)
+        return 1;
+    close(fd);
+    limit.rlim_cur = limit.rlim_max = (rlim_t)fd;
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return 1;
+
+    reader.io = io;
+    reader.data = data;
+    if (!nrt_Thread_start(&thread, &readThenFork, &reader, &error))
+        return 1;
+    nrt_Thread_join(&thread);
+    return reader.ok ? 0 : 1;
+}
+#endif
+
+TEST_CASE(testReadBatchConcurrently)
+{
+    nrt_Error error;
+    char* data = makeData();
+    nrt_IOInterface* io = nrt_IOHandleAdapter_open(BATCH_FILE,
+                                                   NRT_ACCESS_READWRITE,
+                                                   NRT_CREATE, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nrt_IOInterface_write(io, data, DATA_SIZE, &error));
+    TEST_ASSERT(readConcurrently(io, data));
+
+    nrt_IOInterface_close(io, &error);
+    nrt_IOInterface_destruct(&io);
+    remove(BATCH_FILE);
+    NRT_FREE(data);
+}
+
+TEST_CASE(testReadBatchAfterFork)
+{
+#ifndef WIN32
+    nrt_Error error;
+    char* data = makeData();
+    int status = 0;
+    pid_t child;
+    nrt_IOInterface* io = nrt_IOHandleAdapter_open(BATCH_FILE,
+                                                   NRT_ACCESS_READWRITE,
+                                                   NRT_CREATE, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nrt_IOInterface_write(io, data, DATA_SIZE, &error));
+
+    /* with whatever this process reads batches with set up first */
+    TEST_ASSERT(readBatchOnce(io, data));
+    TEST_ASSERT(readAfterFork(io, data));
+    TEST_ASSERT(readBatchOnce(io, data));
+
+    /* and again where the pool has to do the reading */
+    child = fork();
+    TEST_ASSERT(child >= 0);
+    if (child == 0)
+        _exit(readOnPoolAfterFork(io, data));
+    TEST_ASSERT(waitpid(child, &status, 0) == child);
+    TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    nrt_IOInterface_close(io, &error);
+    nrt_IOInterface_destruct(&io);
+    remove(BATCH_FILE);
+    NRT_FREE(data);
+#else
+    (void)testName;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testReadBatchFromFile);
+    CHECK(testReadBatchFromBuffer);
+    CHECK(testReadBatchConcurrently);
+    CHECK(testReadBatchAfterFork);
+    return 0;
+}
@@ -0,0 +1,177 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program;
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+typedef struct _Trace
+{
+    int accesses;
+    nrt_Int64 lastBlock;
+    nrt_Off lastOffset;
+} Trace;
+
+static void traceAccess(NRT_DATA* data, const nrt_IOAccess* access)
+{
+    Trace* trace = (Trace*)data;
+    trace->accesses++;
+    trace->lastBlock = access->block;
+    trace->lastOffset = access->offset;
+}
+
+static char data[10000];
+
+static nrt_IOInterface* makeAdapter(nrt_Error* error)
+{
+    nrt_IOInterface* buffer = nrt_BufferAdapter_construct(data, sizeof(data),
+                                                          0, error);
+    return buffer ? nrt_IOStatsAdapter_construct(buffer, 1, error) : NULL;
+}
+
+TEST_CASE(testCounters)
+{
+    nrt_Error error;
+    nrt_IOInterface* io = makeAdapter(&error);
+    nrt_IOStats stats;
+    char buf[1000];
+
+    TEST_ASSERT(io);
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 10, &error));
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 1000, &error));
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 5010, NRT_SEEK_SET,
+                                                    &error)));
+    TEST_ASSERT(NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 0, NRT_SEEK_CUR,
+                                                    &error)));
+    TEST_ASSERT(!nrt_IOInterface_read(io, buf, 6000, &error));
+    TEST_ASSERT(nrt_IOInterface_write(io, buf, 8, &error));
+
+    TEST_ASSERT(nrt_IOStatsAdapter_getStats(io, NULL, &stats, &error));
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].calls, 3);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].failures, 1);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].bytes, 7010);
+    /* 10 is in [8, 16), 1000 in [512, 1024) and 6000 in [4096, 8192) */
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].sizes[4], 1);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].sizes[10], 1);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].sizes[13], 1);
+
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_SEEK].calls, 2);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_SEEK].bytes, 4000);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_SEEK].sizes[0], 1);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_WRITE].bytes, 8);
+
+    TEST_ASSERT(nrt_IOStatsAdapter_reset(io, &error));
+    TEST_ASSERT(nrt_IOStatsAdapter_getStats(io, NULL, &stats, &error));
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].calls, 0);
+
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testTagsAndTrace)
+{
+    nrt_Error error;
+    nrt_IOInterface* io = makeAdapter(&error);
+    nrt_IOStats stats;
+    nrt_IORequest requests[2];
+    char buf[100];
+    Trace trace;
+
+    TEST_ASSERT(io);
+    memset(&trace, 0, sizeof(trace));
+    TEST_ASSERT(nrt_IOStatsAdapter_setTrace(io, &traceAccess, &trace,
+                                            &error));
+
+    nrt_IOStatsAdapter_setTag(io, "header");
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 50, &error));
+    nrt_IOStatsAdapter_setTag(io, "image[0]");
+    nrt_IOStatsAdapter_setBlock(io, 7);
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 20, &error));
+    TEST_ASSERT_EQ_INT((int)trace.lastBlock, 7);
+    TEST_ASSERT_EQ_INT((int)trace.lastOffset, 50);
+
+    /* Batches are counted once, with a size for each request */
+    requests[0].offset = 100;
+    requests[0].buf = buf;
+    requests[0].size = 30;
+    requests[1].offset = 2000;
+    requests[1].buf = buf + 30;
+    requests[1].size = 40;
+    TEST_ASSERT(nrt_IOInterface_readBatch(io, requests, 2, &error));
+    nrt_IOStatsAdapter_setTag(io, NULL);
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 5, &error));
+    TEST_ASSERT_EQ_INT(trace.accesses, 4);
+
+    TEST_ASSERT(nrt_IOStatsAdapter_getStats(io, "image[0]", &stats, &error));
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].calls, 1);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_BATCH].calls, 1);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_BATCH].bytes, 70);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_BATCH].sizes[5], 1);
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_BATCH].sizes[6], 1);
+    TEST_ASSERT(nrt_IOStatsAdapter_getStats(io, "header", &stats, &error));
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].bytes, 50);
+    TEST_ASSERT(nrt_IOStatsAdapter_getStats(io, NULL, &stats, &error));
+    TEST_ASSERT_EQ_INT((int)stats.ops[NRT_IO_STATS_READ].calls, 3);
+
+    TEST_ASSERT(strcmp(nrt_IOStatsAdapter_getTag(io, 0), "header") == 0);
+    TEST_ASSERT(strcmp(nrt_IOStatsAdapter_getTag(io, 1), "image[0]") == 0);
+    TEST_ASSERT(nrt_IOStatsAdapter_getTag(io, 2) == NULL);
+
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testJSON)
+{
+    nrt_Error error;
+    nrt_IOInterface* io = makeAdapter(&error);
+    char buf[16];
+    char* json;
+
+    TEST_ASSERT(io);
+    nrt_IOStatsAdapter_setTag(io, "say \"hi\"");
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 16, &error));
+
+    json = nrt_IOStatsAdapter_toJSON(io, &error);
+    TEST_ASSERT(json);
+    TEST_ASSERT(strncmp(json, "{\"total\": {\"read\": {\"calls\": 1, "
+                        "\"failures\": 0, \"bytes\": 16, ", 56) == 0);
+    TEST_ASSERT(strstr(json, "\"sizes\": [0, 0, 0, 0, 0, 1]"));
+    TEST_ASSERT(strstr(json, "\"seek\": {\"calls\": 0, \"failures\": 0, "
+                       "\"distance\": 0"));
+    TEST_ASSERT(strstr(json, "\"tags\": {\"say \\\"hi\\\"\": {\"read\""));
+    TEST_ASSERT(strcmp(json + strlen(json) - 2, "}}") == 0);
+    NRT_FREE(json);
+
+    /* Only stats adapters have stats */
+    TEST_ASSERT(!nrt_IOStatsAdapter_toJSON(
+                    nrt_IOStatsAdapter_getWrapped(io), &error));
+
+    nrt_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    CHECK(testCounters);
+    CHECK(testTagsAndTrace);
+    CHECK(testJSON);
+    return 0;
+}
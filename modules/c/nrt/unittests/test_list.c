@@ -171,6 +171,58 @@ TEST_CASE(testIterateRemove)
     TEST_ASSERT_NULL(l);
 }
 
+TEST_CASE(testPositionalAccess)
+{
+    static const char *values[] = { "0", "1", "2", "3", "4", "5" };
+    nrt_Error e;
+    nrt_List *l = nrt_List_construct(&e);
+    nrt_ListIterator it;
+    int i;
+
+    TEST_ASSERT(l);
+    for (i = 0; i < 5; ++i)
+        TEST_ASSERT(nrt_List_pushBack(l, (NRT_DATA *) values[i], &e));
+
+    TEST_ASSERT(nrt_List_get(l, 4, &e) == values[4]);
+    TEST_ASSERT(nrt_List_pushBack(l, (NRT_DATA *) values[5], &e));
+    TEST_ASSERT_EQ_INT(6, nrt_List_size(l));
+    for (i = 0; i < 6; ++i)
+    {
+        it = nrt_List_at(l, i);
+        TEST_ASSERT(nrt_ListIterator_get(&it) == values[i]);
+    }
+    TEST_ASSERT_NULL(nrt_List_get(l, 6, &e));
+    it = nrt_List_at(l, 6);
+    TEST_ASSERT_NULL(it.current);
+
+    /* removing from the middle shifts everything after it */
+    it = nrt_List_at(l, 2);
+    TEST_ASSERT(nrt_List_remove(l, &it) == values[2]);
+    TEST_ASSERT_EQ_INT(5, nrt_List_size(l));
+    TEST_ASSERT(nrt_List_get(l, 2, &e) == values[3]);
+
+    /* and so do inserting and the front of the list */
+    it = nrt_List_at(l, 2);
+    TEST_ASSERT(nrt_List_insert(l, it, (NRT_DATA *) values[2], &e));
+    TEST_ASSERT(nrt_List_popFront(l) == values[0]);
+    TEST_ASSERT(nrt_List_popBack(l) == values[5]);
+    TEST_ASSERT_EQ_INT(4, nrt_List_size(l));
+    for (i = 0; i < 4; ++i)
+        TEST_ASSERT(nrt_List_get(l, i, &e) == values[i + 1]);
+
+    TEST_ASSERT(nrt_List_move(l, 0, 3, &e));
+    TEST_ASSERT(nrt_List_get(l, 0, &e) == values[2]);
+    TEST_ASSERT(nrt_List_get(l, 3, &e) == values[1]);
+
+    /* the list does not own the strings */
+    while (!nrt_List_isEmpty(l))
+        nrt_List_popBack(l);
+    TEST_ASSERT_EQ_INT(0, nrt_List_size(l));
+    TEST_ASSERT_NULL(nrt_List_get(l, 0, &e));
+    nrt_List_destruct(&l);
+    TEST_ASSERT_NULL(l);
+}
+
 int main(int argc, char **argv)
 {
     CHECK(testCreate);
@@ -178,5 +230,6 @@ int main(int argc, char **argv)
     CHECK(testClone);
     CHECK(testIterate);
     CHECK(testIterateRemove);
+    CHECK(testPositionalAccess);
     return 0;
 }